@@ -39,6 +39,15 @@ typedef struct {
 	 */
 	atomic64_t tlb_gen;
 
+	/*
+	 * Highest tlb_gen for which a remote shootdown is in flight, and
+	 * highest tlb_gen up to which a completed shootdown brought every
+	 * CPU running this mm. Concurrent shootdowns covered by another
+	 * one skip sending their own IPIs, see flush_tlb_coalesce().
+	 */
+	atomic64_t tlb_gen_flushing;
+	atomic64_t tlb_gen_flushed;
+
 	unsigned long next_trim_cpumask;
 
 #ifdef CONFIG_MODIFY_LDT_SYSCALL
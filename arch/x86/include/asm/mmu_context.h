@@ -156,6 +156,8 @@ static inline int init_new_context(struct task_struct *tsk,
 
 	mm->context.ctx_id = atomic64_inc_return(&last_mm_ctx_id);
 	atomic64_set(&mm->context.tlb_gen, 0);
+	atomic64_set(&mm->context.tlb_gen_flushing, 0);
+	atomic64_set(&mm->context.tlb_gen_flushed, 0);
 	mm->context.next_trim_cpumask = jiffies + HZ;
 
 #ifdef CONFIG_X86_INTEL_MEMORY_PROTECTION_KEYS
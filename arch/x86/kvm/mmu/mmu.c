@@ -1440,9 +1440,12 @@ void kvm_arch_mmu_enable_log_dirty_pt_masked(struct kvm *kvm,
 
 		kvm_mmu_slot_gfn_write_protect(kvm, slot, start, PG_LEVEL_2M);
 
-		/* Cross two large pages? */
-		if (ALIGN(start << PAGE_SHIFT, PMD_SIZE) !=
-		    ALIGN(end << PAGE_SHIFT, PMD_SIZE))
+		/*
+		 * Cross two large pages?  Compare the huge pages themselves,
+		 * rounding up gets it wrong if either gfn is 2M aligned.
+		 */
+		if (gfn_round_for_level(start, PG_LEVEL_2M) !=
+		    gfn_round_for_level(end, PG_LEVEL_2M))
 			kvm_mmu_slot_gfn_write_protect(kvm, slot, end,
 						       PG_LEVEL_2M);
 	}
@@ -4895,6 +4898,7 @@ long kvm_arch_vcpu_pre_fault_memory(struct kvm_vcpu *vcpu,
 				    struct kvm_pre_fault_memory *range)
 {
 	u64 error_code = PFERR_GUEST_FINAL_MASK;
+	struct kvm_memory_slot *slot;
 	u8 level = PG_LEVEL_4K;
 	u64 direct_bits;
 	u64 end;
@@ -4916,16 +4920,33 @@ long kvm_arch_vcpu_pre_fault_memory(struct kvm_vcpu *vcpu,
 
 	direct_bits = 0;
 	if (kvm_arch_has_private_mem(vcpu->kvm) &&
-	    kvm_mem_is_private(vcpu->kvm, gpa_to_gfn(range->gpa)))
+	    kvm_mem_is_private(vcpu->kvm, gpa_to_gfn(range->gpa))) {
 		error_code |= PFERR_PRIVATE_ACCESS;
-	else
+	} else {
 		direct_bits = gfn_to_gpa(kvm_gfn_direct_bits(vcpu->kvm));
 
+		/*
+		 * A read fault on anonymous memory that was never touched maps
+		 * the zero page, and the guest's first write faults again.
+		 * Fault in writable memory for write, unless its slot is dirty
+		 * logged: pre-faulting must not make pages dirty.
+		 */
+		slot = kvm_vcpu_gfn_to_memslot(vcpu, gpa_to_gfn(range->gpa));
+		if (slot && !(slot->flags & KVM_MEM_READONLY) &&
+		    !kvm_slot_dirty_track_enabled(slot))
+			error_code |= PFERR_WRITE_MASK;
+	}
+
 	/*
 	 * Shadow paging uses GVA for kvm page fault, so restrict to
 	 * two-dimensional paging.
 	 */
 	r = kvm_tdp_map_page(vcpu, range->gpa | direct_bits, error_code, &level);
+	if (r == -EFAULT && (error_code & PFERR_WRITE_MASK)) {
+		/* The host mapping may be read-only, settle for reading */
+		error_code &= ~PFERR_WRITE_MASK;
+		r = kvm_tdp_map_page(vcpu, range->gpa | direct_bits, error_code, &level);
+	}
 	if (r < 0)
 		return r;
 
@@ -1425,6 +1425,57 @@ static void put_flush_tlb_info(void)
 #endif
 }
 
+static void atomic64_set_max(atomic64_t *v, s64 val)
+{
+	s64 old = atomic64_read(v);
+
+	do {
+		if (old >= val)
+			return;
+	} while (!atomic64_try_cmpxchg(v, &old, val));
+}
+
+/*
+ * Concurrent shootdowns of the same mm, e.g. from many threads doing
+ * madvise(MADV_DONTNEED), each bump tlb_gen and send their own IPIs. But a
+ * shootdown for generation G leaves every CPU running the mm at a tlb_gen
+ * of at least G (CPUs that are lazy or load the mm later catch up in
+ * switch_mm_irqs_off()), which covers every flush with a generation <= G.
+ *
+ * So if a shootdown for a generation at least as new as ours is already in
+ * flight, wait for it to complete instead of sending IPIs. Our own CPU is
+ * running the mm and gets flushed by it too. Flushes that freed page
+ * tables must reach lazy CPUs as well and are never coalesced.
+ *
+ * This relies on the tlb_gen tracking of native_flush_tlb_multi().
+ */
+static bool flush_tlb_coalesce(struct flush_tlb_info *info)
+{
+	struct mm_struct *mm = info->mm;
+	u64 covering;
+
+	if (info->freed_tables || mm_in_asid_transition(mm))
+		return false;
+
+#ifdef CONFIG_PARAVIRT
+	/* Hypervisor flushes may only cover the range they were given */
+	if (pv_ops.mmu.flush_tlb_multi != native_flush_tlb_multi)
+		return false;
+#endif
+
+	covering = atomic64_read(&mm->context.tlb_gen_flushing);
+	if (covering < info->new_tlb_gen)
+		return false;
+
+	while (atomic64_read_acquire(&mm->context.tlb_gen_flushed) <
+	       info->new_tlb_gen)
+		cpu_relax();
+
+	trace_tlb_flush_coalesced(info->new_tlb_gen, covering,
+				  cpumask_weight(mm_cpumask(mm)) - 1);
+	return true;
+}
+
 void flush_tlb_mm_range(struct mm_struct *mm, unsigned long start,
 				unsigned long end, unsigned int stride_shift,
 				bool freed_tables)
@@ -1447,9 +1498,13 @@ void flush_tlb_mm_range(struct mm_struct *mm, unsigned long start,
 	if (mm_global_asid(mm)) {
 		broadcast_tlb_flush(info);
 	} else if (cpumask_any_but(mm_cpumask(mm), cpu) < nr_cpu_ids) {
-		info->trim_cpumask = should_trim_cpumask(mm);
-		flush_tlb_multi(mm_cpumask(mm), info);
-		consider_global_asid(mm);
+		if (!flush_tlb_coalesce(info)) {
+			atomic64_set_max(&mm->context.tlb_gen_flushing, new_tlb_gen);
+			info->trim_cpumask = should_trim_cpumask(mm);
+			flush_tlb_multi(mm_cpumask(mm), info);
+			atomic64_set_max(&mm->context.tlb_gen_flushed, new_tlb_gen);
+			consider_global_asid(mm);
+		}
 	} else if (mm == this_cpu_read(cpu_tlbstate.loaded_mm)) {
 		lockdep_assert_irqs_enabled();
 		local_irq_disable();
@@ -489,7 +489,13 @@ struct ioc_gq {
 	u32				last_inuse;
 	s64				saved_margin;
 
-	sector_t			cursor;		/* to detect randio */
+	/*
+	 * `cursor`, `vtime` and `done_vtime` are written by every IO issued
+	 * or completed in this iocg, from whichever CPU it happens on.  They
+	 * get a cacheline of their own so that the weights and hweight cache
+	 * which the issue path reads stay shared.
+	 */
+	sector_t			cursor ____cacheline_aligned_in_smp;	/* to detect randio */
 
 	/*
 	 * `vtime` is this iocg's vtime cursor which progresses as IOs are
@@ -503,7 +509,8 @@ struct ioc_gq {
 	 */
 	atomic64_t			vtime;
 	atomic64_t			done_vtime;
-	u64				abs_vdebt;
+
+	u64				abs_vdebt ____cacheline_aligned_in_smp;
 
 	/* current delay in effect and when it started */
 	u64				delay;
@@ -1224,6 +1231,38 @@ static void current_hweight(struct ioc_gq *iocg, u32 *hw_activep, u32 *hw_inusep
 		*hw_inusep = iocg->hweight_inuse;
 }
 
+/**
+ * blkcg_iocost_share - share of a device iocost currently grants a cgroup
+ * @disk: the device
+ * @css: blkcg css of the cgroup
+ *
+ * Used by dirty throttling to size the write bandwidth of a cgroup wb by
+ * what the block layer will actually let it issue.
+ *
+ * Return: the hierarchical active weight of @css on @disk in units of
+ * 1/WEIGHT_ONE of the device, or 0 if iocost is not enabled on @disk or
+ * @css is not active on it.
+ */
+u32 blkcg_iocost_share(struct gendisk *disk, struct cgroup_subsys_state *css)
+{
+	struct rq_qos *rqos;
+	struct blkcg_gq *blkg;
+	struct ioc_gq *iocg;
+	u32 hwa = 0;
+
+	rcu_read_lock();
+	rqos = rq_qos_id(disk->queue, RQ_QOS_COST);
+	if (!rqos || !rqos_to_ioc(rqos)->enabled)
+		goto out;
+	blkg = blkg_lookup(css_to_blkcg(css), disk->queue);
+	iocg = blkg ? blkg_to_iocg(blkg) : NULL;
+	if (iocg && !list_empty(&iocg->active_list))
+		current_hweight(iocg, &hwa, NULL);
+out:
+	rcu_read_unlock();
+	return hwa;
+}
+
 /*
  * Calculate the hweight_inuse @iocg would get with max @inuse assuming all the
  * other weights stay unchanged.
@@ -481,6 +481,24 @@ static int hctx_dispatch_busy_show(void *data, struct seq_file *m)
 	return 0;
 }
 
+static int hctx_remote_completions_show(void *data, struct seq_file *m)
+{
+	struct blk_mq_hw_ctx *hctx = data;
+	unsigned long ipis = 0, coalesced = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct blk_mq_remote_stats *stats;
+
+		stats = per_cpu_ptr(hctx->remote_stats, cpu);
+		ipis += data_race(stats->ipis);
+		coalesced += data_race(stats->coalesced);
+	}
+	seq_printf(m, "ipis %lu\n", ipis);
+	seq_printf(m, "coalesced %lu\n", coalesced);
+	return 0;
+}
+
 #define CTX_RQ_SEQ_OPS(name, type)					\
 static void *ctx_##name##_rq_list_start(struct seq_file *m, loff_t *pos) \
 	__acquires(&ctx->lock)						\
@@ -595,6 +613,7 @@ static const struct blk_mq_debugfs_attr blk_mq_debugfs_hctx_attrs[] = {
 	{"sched_tags_bitmap", 0400, hctx_sched_tags_bitmap_show},
 	{"active", 0400, hctx_active_show},
 	{"dispatch_busy", 0400, hctx_dispatch_busy_show},
+	{"remote_completions", 0400, hctx_remote_completions_show},
 	{"type", 0400, hctx_type_show},
 	{},
 };
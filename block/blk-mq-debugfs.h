@@ -4,6 +4,7 @@
 
 #ifdef CONFIG_BLK_DEBUG_FS
 
+#include <linux/blk-mq.h>
 #include <linux/seq_file.h>
 
 struct blk_mq_hw_ctx;
@@ -35,7 +36,41 @@ void blk_mq_debugfs_unregister_sched_hctx(struct blk_mq_hw_ctx *hctx);
 
 void blk_mq_debugfs_register_rqos(struct rq_qos *rqos);
 void blk_mq_debugfs_unregister_rqos(struct rq_qos *rqos);
+
+struct blk_mq_remote_stats {
+	/* Remote completions that had to send an IPI to the submitting CPU */
+	unsigned long ipis;
+	/* Remote completions queued behind an IPI already in flight */
+	unsigned long coalesced;
+};
+
+static inline int blk_mq_debugfs_alloc_hctx_stats(struct blk_mq_hw_ctx *hctx,
+						  gfp_t gfp)
+{
+	hctx->remote_stats = alloc_percpu_gfp(struct blk_mq_remote_stats, gfp);
+	return hctx->remote_stats ? 0 : -ENOMEM;
+}
+
+static inline void blk_mq_debugfs_free_hctx_stats(struct blk_mq_hw_ctx *hctx)
+{
+	free_percpu(hctx->remote_stats);
+}
+
+#define blk_mq_debugfs_inc(hctx, field)	\
+	this_cpu_inc((hctx)->remote_stats->field)
 #else
+static inline int blk_mq_debugfs_alloc_hctx_stats(struct blk_mq_hw_ctx *hctx,
+						  gfp_t gfp)
+{
+	return 0;
+}
+
+static inline void blk_mq_debugfs_free_hctx_stats(struct blk_mq_hw_ctx *hctx)
+{
+}
+
+#define blk_mq_debugfs_inc(hctx, field)	do { } while (0)
+
 static inline void blk_mq_debugfs_register(struct request_queue *q)
 {
 }
@@ -804,12 +804,66 @@ void blk_mq_free_request(struct request *rq)
 }
 EXPORT_SYMBOL_GPL(blk_mq_free_request);
 
+#define TAG_COMP_BATCH		32
+
+static inline void blk_mq_flush_tag_batch(struct blk_mq_hw_ctx *hctx,
+					  int *tag_array, int nr_tags)
+{
+	struct request_queue *q = hctx->queue;
+
+	blk_mq_sub_active_requests(hctx, nr_tags);
+
+	blk_mq_put_tags(hctx->tags, tag_array, nr_tags);
+	percpu_ref_put_many(&q->q_usage_counter, nr_tags);
+}
+
+/*
+ * Requests left in the plug cache were never issued.  Unless they hold a
+ * scheduler tag, hand their driver tags and queue references back in batches
+ * like blk_mq_end_request_batch() does, instead of one sbitmap clear and
+ * percpu_ref put per request.
+ */
 void blk_mq_free_plug_rqs(struct blk_plug *plug)
 {
+	int tags[TAG_COMP_BATCH], nr_tags = 0;
+	struct blk_mq_hw_ctx *cur_hctx = NULL;
 	struct request *rq;
 
-	while ((rq = rq_list_pop(&plug->cached_rqs)) != NULL)
-		blk_mq_free_request(rq);
+	while ((rq = rq_list_pop(&plug->cached_rqs)) != NULL) {
+		if (rq->internal_tag != BLK_MQ_NO_TAG ||
+		    rq->tag == BLK_MQ_NO_TAG) {
+			blk_mq_free_request(rq);
+			continue;
+		}
+
+		blk_mq_finish_request(rq);
+		if (unlikely(laptop_mode && !blk_rq_is_passthrough(rq)))
+			laptop_io_completion(rq->q->disk->bdi);
+		rq_qos_done(rq->q, rq);
+
+		WRITE_ONCE(rq->state, MQ_RQ_IDLE);
+		if (!req_ref_put_and_test(rq))
+			continue;
+
+		blk_crypto_free_request(rq);
+		blk_pm_mark_last_busy(rq);
+
+		if (nr_tags == TAG_COMP_BATCH || cur_hctx != rq->mq_hctx) {
+			if (cur_hctx) {
+				blk_mq_flush_tag_batch(cur_hctx, tags, nr_tags);
+				blk_mq_sched_restart(cur_hctx);
+			}
+			nr_tags = 0;
+			cur_hctx = rq->mq_hctx;
+		}
+		tags[nr_tags++] = rq->tag;
+		rq->mq_hctx = NULL;
+	}
+
+	if (nr_tags) {
+		blk_mq_flush_tag_batch(cur_hctx, tags, nr_tags);
+		blk_mq_sched_restart(cur_hctx);
+	}
 }
 
 void blk_dump_rq_flags(struct request *rq, char *msg)
@@ -1152,19 +1206,6 @@ void blk_mq_end_request(struct request *rq, blk_status_t error)
 }
 EXPORT_SYMBOL(blk_mq_end_request);
 
-#define TAG_COMP_BATCH		32
-
-static inline void blk_mq_flush_tag_batch(struct blk_mq_hw_ctx *hctx,
-					  int *tag_array, int nr_tags)
-{
-	struct request_queue *q = hctx->queue;
-
-	blk_mq_sub_active_requests(hctx, nr_tags);
-
-	blk_mq_put_tags(hctx->tags, tag_array, nr_tags);
-	percpu_ref_put_many(&q->q_usage_counter, nr_tags);
-}
-
 void blk_mq_end_request_batch(struct io_comp_batch *iob)
 {
 	int tags[TAG_COMP_BATCH], nr_tags = 0;
@@ -1267,13 +1308,23 @@ static inline bool blk_mq_complete_need_ipi(struct request *rq)
 	return cpu_online(rq->mq_ctx->cpu);
 }
 
+/*
+ * Only the completion that finds the target CPU's list empty sends the IPI,
+ * all others ride along and are completed by the same BLOCK_SOFTIRQ run.
+ */
 static void blk_mq_complete_send_ipi(struct request *rq)
 {
+	/* @rq may be completed and freed as soon as it is on the list */
+	struct blk_mq_hw_ctx *hctx = rq->mq_hctx;
 	unsigned int cpu;
 
 	cpu = rq->mq_ctx->cpu;
-	if (llist_add(&rq->ipi_list, &per_cpu(blk_cpu_done, cpu)))
+	if (llist_add(&rq->ipi_list, &per_cpu(blk_cpu_done, cpu))) {
 		smp_call_function_single_async(cpu, &per_cpu(blk_cpu_csd, cpu));
+		blk_mq_debugfs_inc(hctx, ipis);
+	} else {
+		blk_mq_debugfs_inc(hctx, coalesced);
+	}
 }
 
 static void blk_mq_raise_softirq(struct request *rq)
@@ -4038,10 +4089,15 @@ blk_mq_alloc_hctx(struct request_queue *q, struct blk_mq_tag_set *set,
 	if (!hctx->fq)
 		goto free_bitmap;
 
+	if (blk_mq_debugfs_alloc_hctx_stats(hctx, gfp))
+		goto free_fq;
+
 	blk_mq_hctx_kobj_init(hctx);
 
 	return hctx;
 
+ free_fq:
+	blk_free_flush_queue(hctx->fq);
  free_bitmap:
 	sbitmap_free(&hctx->ctx_map);
  free_ctxs:
@@ -102,6 +102,15 @@ struct deadline_data {
 	int prio_aging_expire;
 
 	spinlock_t lock;
+
+	/*
+	 * Requests are staged here by dd_insert_requests() and only sorted
+	 * into per_prio[] by the dispatcher, so that submitters don't contend
+	 * on @lock with each other and with dispatch.
+	 */
+	spinlock_t insert_lock ____cacheline_aligned_in_smp;
+	struct list_head at_head;
+	struct list_head at_tail;
 };
 
 /* Maps an I/O priority class to a deadline scheduler priority. */
@@ -451,6 +460,9 @@ static struct request *dd_dispatch_prio_aged_requests(struct deadline_data *dd,
 	return NULL;
 }
 
+static void dd_insert_staged_requests(struct deadline_data *dd,
+				      struct list_head *free);
+
 /*
  * Called from blk_mq_run_hw_queue() -> __blk_mq_sched_dispatch_requests().
  *
@@ -465,8 +477,10 @@ static struct request *dd_dispatch_request(struct blk_mq_hw_ctx *hctx)
 	const unsigned long now = jiffies;
 	struct request *rq;
 	enum dd_prio prio;
+	LIST_HEAD(free);
 
 	spin_lock(&dd->lock);
+	dd_insert_staged_requests(dd, &free);
 	rq = dd_dispatch_prio_aged_requests(dd, now);
 	if (rq)
 		goto unlock;
@@ -484,6 +498,7 @@ static struct request *dd_dispatch_request(struct blk_mq_hw_ctx *hctx)
 unlock:
 	spin_unlock(&dd->lock);
 
+	blk_mq_free_requests(&free);
 	return rq;
 }
 
@@ -544,6 +559,9 @@ static void dd_exit_sched(struct elevator_queue *e)
 	struct deadline_data *dd = e->elevator_data;
 	enum dd_prio prio;
 
+	WARN_ON_ONCE(!list_empty(&dd->at_head));
+	WARN_ON_ONCE(!list_empty(&dd->at_tail));
+
 	for (prio = 0; prio <= DD_PRIO_MAX; prio++) {
 		struct dd_per_prio *per_prio = &dd->per_prio[prio];
 		const struct io_stats_per_prio *stats = &per_prio->stats;
@@ -602,6 +620,9 @@ static int dd_init_sched(struct request_queue *q, struct elevator_type *e)
 	dd->fifo_batch = fifo_batch;
 	dd->prio_aging_expire = prio_aging_expire;
 	spin_lock_init(&dd->lock);
+	spin_lock_init(&dd->insert_lock);
+	INIT_LIST_HEAD(&dd->at_head);
+	INIT_LIST_HEAD(&dd->at_tail);
 
 	/* We dispatch from request queue wide instead of hw queue */
 	blk_queue_flag_set(QUEUE_FLAG_SQ_SCHED, q);
@@ -655,14 +676,18 @@ static bool dd_bio_merge(struct request_queue *q, struct bio *bio,
 {
 	struct deadline_data *dd = q->elevator->elevator_data;
 	struct request *free = NULL;
+	LIST_HEAD(free_list);
 	bool ret;
 
 	spin_lock(&dd->lock);
+	/* Staged requests are merge candidates too */
+	dd_insert_staged_requests(dd, &free_list);
 	ret = blk_mq_sched_try_merge(q, bio, nr_segs, &free);
 	spin_unlock(&dd->lock);
 
 	if (free)
 		blk_mq_free_request(free);
+	blk_mq_free_requests(&free_list);
 
 	return ret;
 }
@@ -714,6 +739,41 @@ static void dd_insert_request(struct blk_mq_hw_ctx *hctx, struct request *rq,
 	}
 }
 
+/*
+ * Move the requests staged by dd_insert_requests() into the sort and FIFO
+ * lists. Called with dd->lock held by the dispatcher, and by dd_bio_merge()
+ * so that bios can be merged into requests that are still staged.
+ */
+static void dd_insert_staged_requests(struct deadline_data *dd,
+				      struct list_head *free)
+{
+	LIST_HEAD(at_head);
+	LIST_HEAD(at_tail);
+	struct request *rq;
+
+	lockdep_assert_held(&dd->lock);
+
+	if (list_empty_careful(&dd->at_head) && list_empty_careful(&dd->at_tail))
+		return;
+
+	spin_lock(&dd->insert_lock);
+	list_splice_init(&dd->at_head, &at_head);
+	list_splice_init(&dd->at_tail, &at_tail);
+	spin_unlock(&dd->insert_lock);
+
+	while (!list_empty(&at_head)) {
+		rq = list_first_entry(&at_head, struct request, queuelist);
+		list_del_init(&rq->queuelist);
+		dd_insert_request(rq->mq_hctx, rq, BLK_MQ_INSERT_AT_HEAD, free);
+	}
+
+	while (!list_empty(&at_tail)) {
+		rq = list_first_entry(&at_tail, struct request, queuelist);
+		list_del_init(&rq->queuelist);
+		dd_insert_request(rq->mq_hctx, rq, 0, free);
+	}
+}
+
 /*
  * Called from blk_mq_insert_request() or blk_mq_dispatch_list().
  */
@@ -723,19 +783,18 @@ static void dd_insert_requests(struct blk_mq_hw_ctx *hctx,
 {
 	struct request_queue *q = hctx->queue;
 	struct deadline_data *dd = q->elevator->elevator_data;
-	LIST_HEAD(free);
-
-	spin_lock(&dd->lock);
-	while (!list_empty(list)) {
-		struct request *rq;
 
-		rq = list_first_entry(list, struct request, queuelist);
-		list_del_init(&rq->queuelist);
-		dd_insert_request(hctx, rq, flags, &free);
-	}
-	spin_unlock(&dd->lock);
-
-	blk_mq_free_requests(&free);
+	/*
+	 * Staging keeps arrival order, dd_insert_request() then puts head
+	 * insertions onto the dispatch list in the same order as it would
+	 * have done here.
+	 */
+	spin_lock(&dd->insert_lock);
+	if (flags & BLK_MQ_INSERT_AT_HEAD)
+		list_splice_tail_init(list, &dd->at_head);
+	else
+		list_splice_tail_init(list, &dd->at_tail);
+	spin_unlock(&dd->insert_lock);
 }
 
 /* Callback from inside blk_mq_rq_ctx_init(). */
@@ -772,6 +831,10 @@ static bool dd_has_work(struct blk_mq_hw_ctx *hctx)
 	struct deadline_data *dd = hctx->queue->elevator->elevator_data;
 	enum dd_prio prio;
 
+	if (!list_empty_careful(&dd->at_head) ||
+	    !list_empty_careful(&dd->at_tail))
+		return true;
+
 	for (prio = 0; prio <= DD_PRIO_MAX; prio++)
 		if (dd_has_work_for_prio(&dd->per_prio[prio]))
 			return true;
@@ -173,6 +173,37 @@ int crypto_shash_finup(struct shash_desc *restrict desc, const u8 *data,
 }
 EXPORT_SYMBOL_GPL(crypto_shash_finup);
 
+int crypto_shash_finup_mb(struct shash_desc *desc, const u8 * const data[],
+			  unsigned int len, u8 * const outs[],
+			  unsigned int num_msgs)
+{
+	struct crypto_shash *tfm = desc->tfm;
+	struct shash_alg *alg = crypto_shash_alg(tfm);
+	SHASH_DESC_ON_STACK(tmp, tfm);
+	unsigned int i;
+	int err;
+
+	if (WARN_ON_ONCE(!num_msgs))
+		return -EINVAL;
+
+	if (alg->finup_mb && num_msgs > 1 && num_msgs <= alg->mb_max_msgs)
+		return alg->finup_mb(desc, data, len, outs, num_msgs);
+
+	/* Hash the messages one by one, each from a copy of the state. */
+	tmp->tfm = tfm;
+	for (i = 0; i < num_msgs - 1; i++) {
+		memcpy(tmp, desc, sizeof(*desc) + crypto_shash_descsize(tfm));
+		err = crypto_shash_finup(tmp, data[i], len, outs[i]);
+		if (err)
+			goto out;
+	}
+	err = crypto_shash_finup(desc, data[i], len, outs[i]);
+out:
+	shash_desc_zero(tmp);
+	return err;
+}
+EXPORT_SYMBOL_GPL(crypto_shash_finup_mb);
+
 static int shash_default_digest(struct shash_desc *desc, const u8 *data,
 				unsigned int len, u8 *out)
 {
@@ -467,6 +498,9 @@ static int shash_prepare_alg(struct shash_alg *alg)
 	if ((alg->export && !alg->import) || (alg->import && !alg->export))
 		return -EINVAL;
 
+	if (alg->finup_mb && alg->mb_max_msgs < 2)
+		return -EINVAL;
+
 	err = hash_prepare_alg(&alg->halg);
 	if (err)
 		return err;
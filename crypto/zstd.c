@@ -16,6 +16,12 @@
 
 
 #define ZSTD_DEF_LEVEL	3
+/*
+ * Size the contexts for inputs of up to 256k, zswap only ever compresses
+ * single pages.  Larger inputs still work, with a smaller window.
+ */
+#define ZSTD_MAX_WINDOWLOG	18
+#define ZSTD_MAX_SIZE		BIT(ZSTD_MAX_WINDOWLOG)
 
 struct zstd_ctx {
 	zstd_cctx *cctx;
@@ -26,7 +32,7 @@ struct zstd_ctx {
 
 static zstd_parameters zstd_params(void)
 {
-	return zstd_get_params(ZSTD_DEF_LEVEL, 0);
+	return zstd_get_params(ZSTD_DEF_LEVEL, ZSTD_MAX_SIZE);
 }
 
 static int zstd_comp_init(struct zstd_ctx *ctx)
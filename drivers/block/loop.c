@@ -79,6 +79,7 @@ struct loop_device {
 struct loop_cmd {
 	struct list_head list_entry;
 	bool use_aio; /* use AIO interface to handle I/O */
+	bool nowait_failed; /* IOCB_NOWAIT submission hit -EAGAIN */
 	atomic_t ref; /* only for aio */
 	long ret;
 	struct kiocb iocb;
@@ -276,6 +277,13 @@ static void lo_complete_rq(struct request *rq)
 	struct loop_cmd *cmd = blk_mq_rq_to_pdu(rq);
 	blk_status_t ret = BLK_STS_OK;
 
+	/* The backing file would have blocked, retry from the worker */
+	if (unlikely(cmd->nowait_failed)) {
+		cmd->ret = 0;
+		blk_mq_requeue_request(rq, true);
+		return;
+	}
+
 	if (cmd->ret < 0 || cmd->ret == blk_rq_bytes(rq) ||
 	    req_op(rq) != REQ_OP_READ) {
 		if (cmd->ret < 0)
@@ -323,12 +331,19 @@ static void lo_rw_aio_complete(struct kiocb *iocb, long ret)
 {
 	struct loop_cmd *cmd = container_of(iocb, struct loop_cmd, iocb);
 
+	if (unlikely(ret == -EAGAIN && (iocb->ki_flags & IOCB_NOWAIT)))
+		cmd->nowait_failed = true;
 	cmd->ret = ret;
 	lo_rw_aio_do_completion(cmd);
 }
 
+/*
+ * With @nowait the I/O is issued with IOCB_NOWAIT from ->queue_rq(), and
+ * -EAGAIN is returned without completing the request if the backing file
+ * would have to block.
+ */
 static int lo_rw_aio(struct loop_device *lo, struct loop_cmd *cmd,
-		     loff_t pos, int rw)
+		     loff_t pos, int rw, bool nowait)
 {
 	struct iov_iter iter;
 	struct req_iterator rq_iter;
@@ -347,9 +362,9 @@ static int lo_rw_aio(struct loop_device *lo, struct loop_cmd *cmd,
 	if (rq->bio != rq->biotail) {
 
 		bvec = kmalloc_array(nr_bvec, sizeof(struct bio_vec),
-				     GFP_NOIO);
+				     nowait ? GFP_NOWAIT : GFP_NOIO);
 		if (!bvec)
-			return -EIO;
+			return nowait ? -EAGAIN : -EIO;
 		cmd->bvec = bvec;
 
 		/*
@@ -384,17 +399,38 @@ static int lo_rw_aio(struct loop_device *lo, struct loop_cmd *cmd,
 	if (cmd->use_aio) {
 		cmd->iocb.ki_complete = lo_rw_aio_complete;
 		cmd->iocb.ki_flags = IOCB_DIRECT;
+		if (nowait)
+			cmd->iocb.ki_flags |= IOCB_NOWAIT;
 	} else {
 		cmd->iocb.ki_complete = NULL;
 		cmd->iocb.ki_flags = 0;
 	}
 
 	if (rw == ITER_SOURCE) {
-		kiocb_start_write(&cmd->iocb);
+		struct super_block *sb = file_inode(file)->i_sb;
+
+		if (!nowait) {
+			kiocb_start_write(&cmd->iocb);
+		} else if (sb_start_write_trylock(sb)) {
+			__sb_writers_release(sb, SB_FREEZE_WRITE);
+		} else {
+			/* Don't wait for a frozen backing fs in ->queue_rq() */
+			kfree(cmd->bvec);
+			cmd->bvec = NULL;
+			return -EAGAIN;
+		}
 		ret = file->f_op->write_iter(&cmd->iocb, &iter);
 	} else
 		ret = file->f_op->read_iter(&cmd->iocb, &iter);
 
+	if (nowait && ret == -EAGAIN) {
+		if (rw == ITER_SOURCE)
+			kiocb_end_write(&cmd->iocb);
+		kfree(cmd->bvec);
+		cmd->bvec = NULL;
+		return -EAGAIN;
+	}
+
 	lo_rw_aio_do_completion(cmd);
 
 	if (ret != -EIOCBQUEUED)
@@ -422,9 +458,9 @@ static int do_req_filebacked(struct loop_device *lo, struct request *rq)
 	case REQ_OP_DISCARD:
 		return lo_fallocate(lo, rq, pos, FALLOC_FL_PUNCH_HOLE);
 	case REQ_OP_WRITE:
-		return lo_rw_aio(lo, cmd, pos, ITER_SOURCE);
+		return lo_rw_aio(lo, cmd, pos, ITER_SOURCE, false);
 	case REQ_OP_READ:
-		return lo_rw_aio(lo, cmd, pos, ITER_DEST);
+		return lo_rw_aio(lo, cmd, pos, ITER_DEST, false);
 	default:
 		WARN_ON_ONCE(1);
 		return -EIO;
@@ -1811,10 +1847,84 @@ static const struct kernel_param_ops loop_hw_qdepth_param_ops = {
 device_param_cb(hw_queue_depth, &loop_hw_qdepth_param_ops, &hw_queue_depth, 0444);
 MODULE_PARM_DESC(hw_queue_depth, "Queue depth for each hardware queue. Default: " __stringify(LOOP_DEFAULT_HW_Q_DEPTH));
 
+static int nr_hw_queues = 1;
+
+static int loop_set_nr_hw_queues(const char *s, const struct kernel_param *p)
+{
+	int nr, ret;
+
+	ret = kstrtoint(s, 0, &nr);
+	if (ret < 0)
+		return ret;
+	if (nr < 1)
+		return -EINVAL;
+	nr_hw_queues = nr;
+	return 0;
+}
+
+static const struct kernel_param_ops loop_nr_hw_queues_param_ops = {
+	.set	= loop_set_nr_hw_queues,
+	.get	= param_get_int,
+};
+
+device_param_cb(nr_hw_queues, &loop_nr_hw_queues_param_ops, &nr_hw_queues, 0444);
+MODULE_PARM_DESC(nr_hw_queues, "Number of hardware queues of each device. Default: 1");
+
+/*
+ * Inline submission makes ->queue_rq() blocking, which the tag set has to
+ * know about when it is allocated, before any backing file is bound.
+ */
+static bool nowait_dio;
+module_param(nowait_dio, bool, 0444);
+MODULE_PARM_DESC(nowait_dio, "Issue direct I/O to the backing file from the submitter with IOCB_NOWAIT. Default: false");
+
 MODULE_DESCRIPTION("Loopback device support");
 MODULE_LICENSE("GPL");
 MODULE_ALIAS_BLOCKDEV_MAJOR(LOOP_MAJOR);
 
+/*
+ * Direct I/O to a backing file that supports IOCB_NOWAIT is issued right
+ * away from the submitting context, provided the I/O would be charged to
+ * the same cgroup by the worker.  Only if the backing file would block is
+ * the command handed to the worker.
+ */
+static bool loop_try_nowait(struct loop_device *lo, struct loop_cmd *cmd)
+{
+	struct request *rq = blk_mq_rq_from_pdu(cmd);
+	loff_t pos = ((loff_t) blk_rq_pos(rq) << 9) + lo->lo_offset;
+	unsigned int noio_flags;
+	bool nowait_failed = cmd->nowait_failed;
+	int ret;
+
+	cmd->nowait_failed = false;
+	if (!(lo->tag_set.flags & BLK_MQ_F_BLOCKING))
+		return false;
+	if (!cmd->use_aio || nowait_failed ||
+	    !(lo->lo_backing_file->f_mode & FMODE_NOWAIT))
+		return false;
+	if (req_op(rq) != REQ_OP_READ &&
+	    (req_op(rq) != REQ_OP_WRITE || (lo->lo_flags & LO_FLAGS_READ_ONLY)))
+		return false;
+#ifdef CONFIG_BLK_CGROUP
+	if (cmd->blkcg_css) {
+		bool same_css;
+
+		rcu_read_lock();
+		same_css = cmd->blkcg_css == task_css(current, io_cgrp_id);
+		rcu_read_unlock();
+		if (!same_css)
+			return false;
+	}
+#endif
+
+	noio_flags = memalloc_noio_save();
+	ret = lo_rw_aio(lo, cmd, pos, req_op(rq) == REQ_OP_WRITE ?
+			ITER_SOURCE : ITER_DEST, true);
+	memalloc_noio_restore(noio_flags);
+
+	return ret != -EAGAIN;
+}
+
 static blk_status_t loop_queue_rq(struct blk_mq_hw_ctx *hctx,
 		const struct blk_mq_queue_data *bd)
 {
@@ -1842,16 +1952,16 @@ static blk_status_t loop_queue_rq(struct blk_mq_hw_ctx *hctx,
 	cmd->blkcg_css = NULL;
 	cmd->memcg_css = NULL;
 #ifdef CONFIG_BLK_CGROUP
-	if (rq->bio) {
+	if (rq->bio)
 		cmd->blkcg_css = bio_blkcg_css(rq->bio);
-#ifdef CONFIG_MEMCG
-		if (cmd->blkcg_css) {
-			cmd->memcg_css =
-				cgroup_get_e_css(cmd->blkcg_css->cgroup,
-						&memory_cgrp_subsys);
-		}
 #endif
-	}
+	if (loop_try_nowait(lo, cmd))
+		return BLK_STS_OK;
+
+#if defined(CONFIG_BLK_CGROUP) && defined(CONFIG_MEMCG)
+	if (cmd->blkcg_css)
+		cmd->memcg_css = cgroup_get_e_css(cmd->blkcg_css->cgroup,
+						  &memory_cgrp_subsys);
 #endif
 	loop_queue_work(lo, cmd);
 
@@ -1998,11 +2108,14 @@ static int loop_add(int i)
 	i = err;
 
 	lo->tag_set.ops = &loop_mq_ops;
-	lo->tag_set.nr_hw_queues = 1;
+	lo->tag_set.nr_hw_queues = min_t(unsigned int, nr_hw_queues, nr_cpu_ids);
 	lo->tag_set.queue_depth = hw_queue_depth;
 	lo->tag_set.numa_node = NUMA_NO_NODE;
 	lo->tag_set.cmd_size = sizeof(struct loop_cmd);
 	lo->tag_set.flags = BLK_MQ_F_STACKING | BLK_MQ_F_NO_SCHED_BY_DEFAULT;
+	/* ->queue_rq() may issue I/O to the backing file directly */
+	if (nowait_dio)
+		lo->tag_set.flags |= BLK_MQ_F_BLOCKING;
 	lo->tag_set.driver_data = lo;
 
 	err = blk_mq_alloc_tag_set(&lo->tag_set);
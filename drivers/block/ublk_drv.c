@@ -184,6 +184,12 @@ struct ublk_queue {
 	unsigned short nr_io_ready;	/* how many ios setup */
 	spinlock_t		cancel_lock;
 	struct ublk_device *dev;
+
+	/* requests collected by ->queue_rq() until bd->last or ->commit_rqs() */
+	spinlock_t		batch_lock;
+	struct rq_list		batch;
+	struct ublk_io		*batch_io;
+
 	struct ublk_io ios[];
 };
 
@@ -1310,24 +1316,6 @@ static void ublk_dispatch_req(struct ublk_queue *ubq,
 		ublk_complete_io_cmd(io, req, UBLK_IO_RES_OK, issue_flags);
 }
 
-static void ublk_cmd_tw_cb(struct io_uring_cmd *cmd,
-			   unsigned int issue_flags)
-{
-	struct ublk_uring_cmd_pdu *pdu = ublk_get_uring_cmd_pdu(cmd);
-	struct ublk_queue *ubq = pdu->ubq;
-
-	ublk_dispatch_req(ubq, pdu->req, issue_flags);
-}
-
-static void ublk_queue_cmd(struct ublk_queue *ubq, struct request *rq)
-{
-	struct io_uring_cmd *cmd = ubq->ios[rq->tag].cmd;
-	struct ublk_uring_cmd_pdu *pdu = ublk_get_uring_cmd_pdu(cmd);
-
-	pdu->req = rq;
-	io_uring_cmd_complete_in_task(cmd, ublk_cmd_tw_cb);
-}
-
 static void ublk_cmd_list_tw_cb(struct io_uring_cmd *cmd,
 		unsigned int issue_flags)
 {
@@ -1398,6 +1386,52 @@ static blk_status_t ublk_prep_req(struct ublk_queue *ubq, struct request *rq,
 	return BLK_STS_OK;
 }
 
+static inline bool ublk_belong_to_same_batch(const struct ublk_io *io,
+					     const struct ublk_io *io2)
+{
+	return (io_uring_cmd_ctx_handle(io->cmd) ==
+		io_uring_cmd_ctx_handle(io2->cmd)) &&
+		(io->task == io2->task);
+}
+
+/* Called with ubq->batch_lock held */
+static void ublk_flush_batch(struct ublk_queue *ubq)
+{
+	if (!rq_list_empty(&ubq->batch))
+		ublk_queue_cmd_list(ubq->batch_io, &ubq->batch);
+	ubq->batch_io = NULL;
+}
+
+/*
+ * Requests dispatched one by one through ->queue_rq(), e.g. by an I/O
+ * scheduler, are handed to the ublk server in one task work run per
+ * dispatch round instead of one per request, the same way ->queue_rqs()
+ * does for plugged requests.
+ */
+static void ublk_queue_cmd_batch(struct ublk_queue *ubq, struct request *rq,
+				 bool last)
+{
+	struct ublk_io *io = &ubq->ios[rq->tag];
+
+	spin_lock(&ubq->batch_lock);
+	if (ubq->batch_io && !ublk_belong_to_same_batch(ubq->batch_io, io))
+		ublk_flush_batch(ubq);
+	ubq->batch_io = io;
+	rq_list_add_tail(&ubq->batch, rq);
+	if (last)
+		ublk_flush_batch(ubq);
+	spin_unlock(&ubq->batch_lock);
+}
+
+static void ublk_commit_rqs(struct blk_mq_hw_ctx *hctx)
+{
+	struct ublk_queue *ubq = hctx->driver_data;
+
+	spin_lock(&ubq->batch_lock);
+	ublk_flush_batch(ubq);
+	spin_unlock(&ubq->batch_lock);
+}
+
 static blk_status_t ublk_queue_rq(struct blk_mq_hw_ctx *hctx,
 		const struct blk_mq_queue_data *bd)
 {
@@ -1419,18 +1453,10 @@ static blk_status_t ublk_queue_rq(struct blk_mq_hw_ctx *hctx,
 		return BLK_STS_OK;
 	}
 
-	ublk_queue_cmd(ubq, rq);
+	ublk_queue_cmd_batch(ubq, rq, bd->last);
 	return BLK_STS_OK;
 }
 
-static inline bool ublk_belong_to_same_batch(const struct ublk_io *io,
-					     const struct ublk_io *io2)
-{
-	return (io_uring_cmd_ctx_handle(io->cmd) ==
-		io_uring_cmd_ctx_handle(io2->cmd)) &&
-		(io->task == io2->task);
-}
-
 static void ublk_queue_rqs(struct rq_list *rqlist)
 {
 	struct rq_list requeue_list = { };
@@ -1472,6 +1498,7 @@ static int ublk_init_hctx(struct blk_mq_hw_ctx *hctx, void *driver_data,
 static const struct blk_mq_ops ublk_mq_ops = {
 	.queue_rq       = ublk_queue_rq,
 	.queue_rqs      = ublk_queue_rqs,
+	.commit_rqs	= ublk_commit_rqs,
 	.init_hctx	= ublk_init_hctx,
 	.timeout	= ublk_timeout,
 };
@@ -2489,6 +2516,7 @@ static int ublk_init_queue(struct ublk_device *ub, int q_id)
 	int size;
 
 	spin_lock_init(&ubq->cancel_lock);
+	spin_lock_init(&ubq->batch_lock);
 	ubq->flags = ub->dev_info.flags;
 	ubq->q_id = q_id;
 	ubq->q_depth = ub->dev_info.queue_depth;
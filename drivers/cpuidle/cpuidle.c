@@ -357,7 +357,13 @@ noinstr int cpuidle_enter_state(struct cpuidle_device *dev,
 int cpuidle_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 		   bool *stop_tick)
 {
-	return cpuidle_curr_governor->select(drv, dev, stop_tick);
+	int index = cpuidle_curr_governor->select(drv, dev, stop_tick);
+
+	if (trace_cpu_idle_select_enabled())
+		trace_cpu_idle_select(dev->cpu, index, *stop_tick,
+				      cpuidle_governor_latency_req(dev->cpu));
+
+	return index;
 }
 
 /**
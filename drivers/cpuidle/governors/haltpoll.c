@@ -40,6 +40,33 @@ module_param(guest_halt_poll_grow_start, uint, 0644);
 static bool guest_halt_poll_allow_shrink __read_mostly = true;
 module_param(guest_halt_poll_allow_shrink, bool, 0644);
 
+/* The poll window that just expired was already extended for a timer */
+static DEFINE_PER_CPU(bool, haltpoll_timer_repoll);
+
+/*
+ * A timer that expires within the poll window is a wakeup that is known to
+ * come, so polling for it is cheaper than a halt and the exits around it.
+ * Interrupts and IPIs cannot be predicted this way.
+ *
+ * tick_nohz_get_sleep_length() is what menu and teo call on every idle
+ * entry, but haltpoll otherwise avoids it. Look the timer up at most once
+ * per halt decision: if the extra window expires as well, halt.
+ */
+static bool haltpoll_timer_due(struct cpuidle_device *dev)
+{
+	ktime_t delta_tick;
+
+	if (__this_cpu_read(haltpoll_timer_repoll)) {
+		__this_cpu_write(haltpoll_timer_repoll, false);
+		return false;
+	}
+	if (ktime_to_ns(tick_nohz_get_sleep_length(&delta_tick)) >=
+	    dev->poll_limit_ns)
+		return false;
+	__this_cpu_write(haltpoll_timer_repoll, true);
+	return true;
+}
+
 /**
  * haltpoll_select - selects the next idle state to enter
  * @drv: cpuidle driver containing state data
@@ -62,9 +89,14 @@ static int haltpoll_select(struct cpuidle_driver *drv,
 
 	/* Last state was poll? */
 	if (dev->last_state_idx == 0) {
-		/* Halt if no event occurred on poll window */
-		if (dev->poll_time_limit == true)
+		/*
+		 * Halt if no event occurred on poll window, unless a timer
+		 * is due within the next one.
+		 */
+		if (dev->poll_time_limit == true && !haltpoll_timer_due(dev))
 			return 1;
+		if (dev->poll_time_limit == false)
+			__this_cpu_write(haltpoll_timer_repoll, false);
 
 		*stop_tick = false;
 		/* Otherwise, poll again */
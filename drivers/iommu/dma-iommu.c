@@ -1736,7 +1736,12 @@ unsigned long iommu_dma_get_merge_boundary(struct device *dev)
 
 size_t iommu_dma_opt_mapping_size(void)
 {
-	return iova_rcache_range();
+	/*
+	 * SCSI and ATA hosts size their requests from this hint. Keep it at
+	 * the 32 page ranges it has always reported rather than following
+	 * the IOVA caches up to iova_rcache_range().
+	 */
+	return min(iova_rcache_range(), PAGE_SIZE << 5);
 }
 
 size_t iommu_dma_max_mapping_size(struct device *dev)
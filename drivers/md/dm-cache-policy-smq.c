@@ -14,6 +14,7 @@
 #include <linux/jiffies.h>
 #include <linux/module.h>
 #include <linux/mutex.h>
+#include <linux/percpu.h>
 #include <linux/vmalloc.h>
 #include <linux/math64.h>
 
@@ -830,6 +831,12 @@ struct smq_policy {
 	struct stats hotspot_stats;
 	struct stats cache_stats;
 
+	/*
+	 * Hits served by lookup_hit_lockless(), folded into cache_stats
+	 * under the lock before it is read.
+	 */
+	struct stats __percpu *lockless_stats;
+
 	/*
 	 * Keeps track of time, incremented by the core.  We use this to
 	 * avoid attributing multiple hits within the same tick.
@@ -1017,6 +1024,32 @@ static void requeue(struct smq_policy *mq, struct entry *e)
 	}
 }
 
+/*
+ * The per-cpu counters are updated without the lock, an increment racing
+ * with the fold may be lost.  Like the rest of the stats they are only a
+ * heuristic.
+ */
+static void fold_lockless_stats(struct smq_policy *mq)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct stats *s = per_cpu_ptr(mq->lockless_stats, cpu);
+
+		mq->cache_stats.hits += data_race(s->hits);
+		mq->cache_stats.misses += data_race(s->misses);
+		data_race(s->hits = s->misses = 0u);
+	}
+}
+
+static void reset_lockless_stats(struct smq_policy *mq)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		stats_reset(per_cpu_ptr(mq->lockless_stats, cpu));
+}
+
 static unsigned int default_promote_level(struct smq_policy *mq)
 {
 	/*
@@ -1039,9 +1072,12 @@ static unsigned int default_promote_level(struct smq_policy *mq)
 		1, 1, 1, 2, 4, 6, 7, 8, 7, 6, 4, 4, 3, 3, 2, 2, 1
 	};
 
-	unsigned int hits = mq->cache_stats.hits;
-	unsigned int misses = mq->cache_stats.misses;
-	unsigned int index = safe_div(hits << 4u, hits + misses);
+	unsigned int hits, misses, index;
+
+	fold_lockless_stats(mq);
+	hits = mq->cache_stats.hits;
+	misses = mq->cache_stats.misses;
+	index = safe_div(hits << 4u, hits + misses);
 	return table[index];
 }
 
@@ -1120,6 +1156,7 @@ static void end_cache_period(struct smq_policy *mq)
 		q_redistribute(&mq->dirty);
 		q_redistribute(&mq->clean);
 		stats_reset(&mq->cache_stats);
+		reset_lockless_stats(mq);
 
 		mq->next_cache_period = jiffies + CACHE_UPDATE_PERIOD;
 	}
@@ -1367,6 +1404,7 @@ static void smq_destroy(struct dm_cache_policy *p)
 	h_exit(&mq->table);
 	free_bitset(mq->hotspot_hit_bits);
 	free_bitset(mq->cache_hit_bits);
+	free_percpu(mq->lockless_stats);
 	space_exit(&mq->es);
 	kfree(mq);
 }
@@ -1408,6 +1446,50 @@ static int __lookup(struct smq_policy *mq, dm_oblock_t oblock, dm_cblock_t *cblo
 	}
 }
 
+/*
+ * Bound on the hash chain walk without the lock; a chain being relinked
+ * under us could otherwise be followed for a long time.
+ */
+#define LOCKLESS_CHAIN_MAX 32u
+
+/*
+ * A hit on an entry that has already been requeued this period (its bit
+ * in cache_hit_bits is set) changes nothing but the hit statistics, so it
+ * is served without the policy lock.  The caller holds the bio prison cell
+ * of the origin block shared, so the mapping of oblock itself cannot change
+ * under us; the walk may only miss an entry if its chain is being changed,
+ * in which case the locked lookup is done as usual.  Entries are never
+ * freed, only recycled, so following a stale link is harmless.  The hit
+ * is accounted in the per-cpu lockless_stats.
+ */
+static bool lookup_hit_lockless(struct smq_policy *mq, dm_oblock_t oblock,
+				dm_cblock_t *cblock)
+{
+	struct smq_hash_table *ht = &mq->table;
+	unsigned int h = hash_64(from_oblock(oblock), ht->hash_bits);
+	unsigned int idx = READ_ONCE(ht->buckets[h]);
+	unsigned int n;
+	struct entry *e;
+
+	for (n = 0; idx != INDEXER_NULL && n < LOCKLESS_CHAIN_MAX; n++) {
+		e = __get_entry(ht->es, idx);
+		if (data_race(e->oblock) == oblock && data_race(e->allocated)) {
+			*cblock = infer_cblock(mq, e);
+			if (!test_bit(from_cblock(*cblock), mq->cache_hit_bits))
+				return false;
+
+			if (data_race(e->level) >= mq->cache_stats.hit_threshold)
+				this_cpu_inc(mq->lockless_stats->hits);
+			else
+				this_cpu_inc(mq->lockless_stats->misses);
+			return true;
+		}
+		idx = data_race(e->hash_next);
+	}
+
+	return false;
+}
+
 static int smq_lookup(struct dm_cache_policy *p, dm_oblock_t oblock, dm_cblock_t *cblock,
 		      int data_dir, bool fast_copy,
 		      bool *background_work)
@@ -1416,6 +1498,11 @@ static int smq_lookup(struct dm_cache_policy *p, dm_oblock_t oblock, dm_cblock_t
 	unsigned long flags;
 	struct smq_policy *mq = to_smq_policy(p);
 
+	if (lookup_hit_lockless(mq, oblock, cblock)) {
+		*background_work = false;
+		return 0;
+	}
+
 	spin_lock_irqsave(&mq->lock, flags);
 	r = __lookup(mq, oblock, cblock,
 		     data_dir, fast_copy,
@@ -1435,6 +1522,9 @@ static int smq_lookup_with_work(struct dm_cache_policy *p,
 	unsigned long flags;
 	struct smq_policy *mq = to_smq_policy(p);
 
+	if (lookup_hit_lockless(mq, oblock, cblock))
+		return 0;
+
 	spin_lock_irqsave(&mq->lock, flags);
 	r = __lookup(mq, oblock, cblock, data_dir, fast_copy, work, &background_queued);
 	spin_unlock_irqrestore(&mq->lock, flags);
@@ -1800,6 +1890,10 @@ __smq_create(dm_cblock_t cache_size, sector_t origin_size, sector_t cache_block_
 	stats_init(&mq->hotspot_stats, NR_HOTSPOT_LEVELS);
 	stats_init(&mq->cache_stats, NR_CACHE_LEVELS);
 
+	mq->lockless_stats = alloc_percpu(struct stats);
+	if (!mq->lockless_stats)
+		goto bad_lockless_stats;
+
 	if (h_init(&mq->table, &mq->es, from_cblock(cache_size)))
 		goto bad_alloc_table;
 
@@ -1826,6 +1920,8 @@ __smq_create(dm_cblock_t cache_size, sector_t origin_size, sector_t cache_block_
 bad_alloc_hotspot_table:
 	h_exit(&mq->table);
 bad_alloc_table:
+	free_percpu(mq->lockless_stats);
+bad_lockless_stats:
 	free_bitset(mq->cache_hit_bits);
 bad_cache_hit_bits:
 	free_bitset(mq->hotspot_hit_bits);
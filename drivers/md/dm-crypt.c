@@ -1568,6 +1568,11 @@ static void crypt_free_req(struct crypt_config *cc, void *req, struct bio *base_
 
 /*
  * Encrypt / decrypt data from one bio to another one (can be the same one)
+ *
+ * Each encryption sector is a request of its own: the skcipher API takes a
+ * single IV per request, so sectors with per-sector IVs (e.g. xts-plain64)
+ * cannot share one.  Setups wanting fewer requests should use a larger
+ * sector_size.
  */
 static blk_status_t crypt_convert(struct crypt_config *cc,
 			 struct convert_context *ctx, bool atomic, bool reset_pending)
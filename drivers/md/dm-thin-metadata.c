@@ -11,8 +11,10 @@
 #include "persistent-data/dm-space-map-disk.h"
 #include "persistent-data/dm-transaction-manager.h"
 
+#include <linux/hash.h>
 #include <linux/list.h>
 #include <linux/device-mapper.h>
+#include <linux/seqlock.h>
 #include <linux/workqueue.h>
 
 /*
@@ -183,6 +185,11 @@ struct dm_pool_metadata {
 	struct dm_btree_info details_info;
 
 	struct rw_semaphore root_lock;
+	/*
+	 * Odd while root_lock is held for write, lets lookups check their
+	 * cached mappings without taking root_lock.
+	 */
+	seqcount_t mapping_seq;
 	uint32_t time;
 	dm_block_t root;
 	dm_block_t details_root;
@@ -228,6 +235,20 @@ struct dm_pool_metadata {
 	__u8 metadata_space_map_root[SPACE_MAP_ROOT_SIZE];
 };
 
+/*
+ * A small direct mapped cache of the mappings most recently looked up in
+ * a thin device.  An entry is only valid while pmd->mapping_seq still has
+ * the value it was filled at, so any metadata change drops every entry.
+ */
+#define MAPPING_CACHE_BITS 6
+
+struct mapping_cache_entry {
+	unsigned int seq;	/* odd while being filled, 0 if never filled */
+	unsigned int mapping_seq;
+	dm_block_t block;
+	__le64 value;
+};
+
 struct dm_thin_device {
 	struct list_head list;
 	struct dm_pool_metadata *pmd;
@@ -240,6 +261,8 @@ struct dm_thin_device {
 	uint64_t transaction_id;
 	uint32_t creation_time;
 	uint32_t snapshotted_time;
+
+	struct mapping_cache_entry mapping_cache[1 << MAPPING_CACHE_BITS];
 };
 
 /*
@@ -420,6 +443,7 @@ static inline void pmd_write_lock_in_core(struct dm_pool_metadata *pmd)
 	__acquires(pmd->root_lock)
 {
 	down_write(&pmd->root_lock);
+	raw_write_seqcount_begin(&pmd->mapping_seq);
 }
 
 static inline void pmd_write_lock(struct dm_pool_metadata *pmd)
@@ -432,6 +456,7 @@ static inline void pmd_write_lock(struct dm_pool_metadata *pmd)
 static inline void pmd_write_unlock(struct dm_pool_metadata *pmd)
 	__releases(pmd->root_lock)
 {
+	raw_write_seqcount_end(&pmd->mapping_seq);
 	up_write(&pmd->root_lock);
 }
 
@@ -964,6 +989,7 @@ struct dm_pool_metadata *dm_pool_metadata_open(struct block_device *bdev,
 	}
 
 	init_rwsem(&pmd->root_lock);
+	seqcount_init(&pmd->mapping_seq);
 	pmd->time = 0;
 	INIT_LIST_HEAD(&pmd->thin_devices);
 	pmd->fail_io = false;
@@ -1077,7 +1103,7 @@ static int __open_device(struct dm_pool_metadata *pmd,
 		details_le.snapshotted_time = cpu_to_le32(pmd->time);
 	}
 
-	*td = kmalloc(sizeof(**td), GFP_NOIO);
+	*td = kzalloc(sizeof(**td), GFP_NOIO);
 	if (!*td)
 		return -ENOMEM;
 
@@ -1543,6 +1569,64 @@ static void unpack_lookup_result(struct dm_thin_device *td, __le64 value,
 	result->shared = __snapshotted_since(td, exception_time);
 }
 
+/*
+ * Called with root_lock held for read, so nobody changes mapping_seq.
+ * Concurrent readers filling the same entry are serialised by claiming it
+ * with an odd entry sequence; the loser just does not fill it.
+ */
+static void __mapping_cache_fill(struct dm_thin_device *td, dm_block_t block,
+				 __le64 value)
+{
+	struct mapping_cache_entry *ce =
+		&td->mapping_cache[hash_64(block, MAPPING_CACHE_BITS)];
+	unsigned int seq = READ_ONCE(ce->seq);
+
+	if ((seq & 1) || cmpxchg(&ce->seq, seq, seq + 1) != seq)
+		return;
+
+	WRITE_ONCE(ce->mapping_seq, raw_read_seqcount(&td->pmd->mapping_seq));
+	WRITE_ONCE(ce->block, block);
+	WRITE_ONCE(ce->value, value);
+	smp_store_release(&ce->seq, seq + 2);
+}
+
+/*
+ * Look a mapping up in the cache without taking root_lock.  Fails if the
+ * entry is for another block, is being filled, or metadata changed since
+ * it was filled or is being changed right now.
+ */
+static bool mapping_cache_lookup(struct dm_thin_device *td, dm_block_t block,
+				 struct dm_thin_lookup_result *result)
+{
+	struct dm_pool_metadata *pmd = td->pmd;
+	struct mapping_cache_entry *ce =
+		&td->mapping_cache[hash_64(block, MAPPING_CACHE_BITS)];
+	unsigned int seq, ce_seq, ce_mapping_seq;
+	dm_block_t ce_block;
+	__le64 value;
+
+	seq = raw_read_seqcount(&pmd->mapping_seq);
+	if (seq & 1)
+		return false;
+
+	ce_seq = smp_load_acquire(&ce->seq);
+	if (!ce_seq || (ce_seq & 1))
+		return false;
+
+	ce_mapping_seq = READ_ONCE(ce->mapping_seq);
+	ce_block = READ_ONCE(ce->block);
+	value = READ_ONCE(ce->value);
+	unpack_lookup_result(td, value, result);
+
+	smp_rmb();
+	if (READ_ONCE(ce->seq) != ce_seq)
+		return false;
+	if (ce_mapping_seq != seq || ce_block != block)
+		return false;
+
+	return !read_seqcount_retry(&pmd->mapping_seq, seq);
+}
+
 static int __find_block(struct dm_thin_device *td, dm_block_t block,
 			int can_issue_io, struct dm_thin_lookup_result *result)
 {
@@ -1558,8 +1642,10 @@ static int __find_block(struct dm_thin_device *td, dm_block_t block,
 		info = &pmd->nb_info;
 
 	r = dm_btree_lookup(info, pmd->root, keys, &value);
-	if (!r)
+	if (!r) {
 		unpack_lookup_result(td, value, result);
+		__mapping_cache_fill(td, block, value);
+	}
 
 	return r;
 }
@@ -1570,6 +1656,9 @@ int dm_thin_find_block(struct dm_thin_device *td, dm_block_t block,
 	int r;
 	struct dm_pool_metadata *pmd = td->pmd;
 
+	if (mapping_cache_lookup(td, block, result))
+		return 0;
+
 	down_read(&pmd->root_lock);
 	if (pmd->fail_io) {
 		up_read(&pmd->root_lock);
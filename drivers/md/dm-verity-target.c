@@ -440,6 +440,59 @@ int verity_hash_for_block(struct dm_verity *v, struct dm_verity_io *io,
 	return r;
 }
 
+/*
+ * Consecutive data blocks mostly take their digests from the same level 0
+ * hash block.  Once that hash block is verified it is kept in *cached, so
+ * the digests of the following blocks are copied out of it without
+ * another dm-bufio lookup.  The caller releases *cached.
+ */
+static int verity_hash_for_block_cached(struct dm_verity *v,
+					struct dm_verity_io *io, sector_t block,
+					u8 *digest, bool *is_zero,
+					struct dm_buffer **cached,
+					sector_t *cached_block)
+{
+	struct buffer_aux *aux;
+	struct dm_buffer *buf;
+	sector_t hash_block;
+	unsigned int offset;
+	u8 *data;
+	int r;
+
+	if (unlikely(!v->levels))
+		return verity_hash_for_block(v, io, block, digest, is_zero);
+
+	verity_hash_at_level(v, block, 0, &hash_block, &offset);
+	if (*cached && *cached_block == hash_block) {
+		data = dm_bufio_get_block_data(*cached);
+		memcpy(digest, data + offset, v->digest_size);
+		*is_zero = v->zero_digest &&
+			   !memcmp(v->zero_digest, digest, v->digest_size);
+		return 0;
+	}
+
+	if (*cached) {
+		dm_bufio_release(*cached);
+		*cached = NULL;
+	}
+
+	r = verity_hash_for_block(v, io, block, digest, is_zero);
+	if (unlikely(r))
+		return r;
+
+	data = dm_bufio_get(v->bufio, hash_block, &buf);
+	if (IS_ERR_OR_NULL(data))
+		return 0;
+	aux = dm_bufio_get_aux_data(buf);
+	if (!aux->hash_verified) {
+		dm_bufio_release(buf);
+		return 0;
+	}
+	*cached = buf;
+	*cached_block = hash_block;
+	return 0;
+}
+
 static noinline int verity_recheck(struct dm_verity *v, struct dm_verity_io *io,
 				   sector_t cur_block, u8 *dest)
 {
@@ -526,7 +579,10 @@ static int verity_verify_io(struct dm_verity_io *io)
 	struct bvec_iter iter_copy;
 	struct bvec_iter *iter;
 	struct bio *bio = dm_bio_from_per_bio_data(io, v->ti->per_io_data_size);
+	struct dm_buffer *hash_buf = NULL;
+	sector_t hash_block = 0;
 	unsigned int b;
+	int r = 0;
 
 	if (static_branch_unlikely(&use_bh_wq_enabled) && io->in_bh) {
 		/*
@@ -540,7 +596,6 @@ static int verity_verify_io(struct dm_verity_io *io)
 
 	for (b = 0; b < io->n_blocks;
 	     b++, bio_advance_iter(bio, iter, block_size)) {
-		int r;
 		sector_t cur_block = io->block + b;
 		bool is_zero;
 		struct bio_vec bv;
@@ -550,11 +605,12 @@ static int verity_verify_io(struct dm_verity_io *io)
 		    likely(test_bit(cur_block, v->validated_blocks)))
 			continue;
 
-		r = verity_hash_for_block(v, io, cur_block,
-					  verity_io_want_digest(v, io),
-					  &is_zero);
+		r = verity_hash_for_block_cached(v, io, cur_block,
+						 verity_io_want_digest(v, io),
+						 &is_zero, &hash_buf,
+						 &hash_block);
 		if (unlikely(r < 0))
-			return r;
+			goto out;
 
 		bv = bio_iter_iovec(bio, *iter);
 		if (unlikely(bv.bv_len < block_size)) {
@@ -565,7 +621,8 @@ static int verity_verify_io(struct dm_verity_io *io)
 			 * data block size to be greater than PAGE_SIZE.
 			 */
 			DMERR_LIMIT("unaligned io (data block spans pages)");
-			return -EIO;
+			r = -EIO;
+			goto out;
 		}
 
 		data = bvec_kmap_local(&bv);
@@ -584,7 +641,7 @@ static int verity_verify_io(struct dm_verity_io *io)
 				verity_io_real_digest(v, io), !io->in_bh);
 		if (unlikely(r < 0)) {
 			kunmap_local(data);
-			return r;
+			goto out;
 		}
 
 		if (likely(memcmp(verity_io_real_digest(v, io),
@@ -598,10 +655,13 @@ static int verity_verify_io(struct dm_verity_io *io)
 						     data);
 		kunmap_local(data);
 		if (unlikely(r))
-			return r;
+			goto out;
 	}
-
-	return 0;
+	r = 0;
+out:
+	if (hash_buf)
+		dm_bufio_release(hash_buf);
+	return r;
 }
 
 /*
@@ -426,7 +426,7 @@ static inline void remove_hash(struct stripe_head *sh)
 	pr_debug("remove_hash(), stripe %llu\n",
 		(unsigned long long)sh->sector);
 
-	hlist_del_init(&sh->hash);
+	hlist_del_init_rcu(&sh->hash);
 }
 
 static inline void insert_hash(struct r5conf *conf, struct stripe_head *sh)
@@ -436,7 +436,7 @@ static inline void insert_hash(struct r5conf *conf, struct stripe_head *sh)
 	pr_debug("insert_hash(), stripe %llu\n",
 		(unsigned long long)sh->sector);
 
-	hlist_add_head(&sh->hash, hp);
+	hlist_add_head_rcu(&sh->hash, hp);
 }
 
 /* find an idle stripe, make sure it is unhashed, and return it. */
@@ -671,6 +671,47 @@ static struct stripe_head *find_get_stripe(struct r5conf *conf,
 	return sh;
 }
 
+/*
+ * Look up an active stripe without taking the hash lock.  Stripe heads
+ * are SLAB_TYPESAFE_BY_RCU, so a stripe found on the hash chain may have
+ * been recycled for another sector; it is only used if it still matches
+ * once a reference is held.  Stripes with a zero reference count sit on
+ * an inactive or handle list and are left to the locked lookup.
+ */
+static struct stripe_head *find_get_stripe_lockless(struct r5conf *conf,
+		sector_t sector, unsigned int flags)
+{
+	struct stripe_head *sh;
+	short generation;
+
+	if ((flags & R5_GAS_PREVIOUS) ||
+	    READ_ONCE(conf->reshape_progress) != MaxSector)
+		return NULL;
+
+	generation = READ_ONCE(conf->generation);
+	rcu_read_lock();
+	hlist_for_each_entry_rcu(sh, stripe_hash(conf, sector), hash) {
+		if (READ_ONCE(sh->sector) != sector ||
+		    READ_ONCE(sh->generation) != generation)
+			continue;
+		if (!atomic_inc_not_zero(&sh->count))
+			break;
+		rcu_read_unlock();
+
+		if (READ_ONCE(sh->sector) != sector ||
+		    READ_ONCE(sh->generation) != generation ||
+		    hlist_unhashed(&sh->hash) ||
+		    (!(flags & R5_GAS_NOQUIESCE) && READ_ONCE(conf->quiesce))) {
+			raid5_release_stripe(sh);
+			return NULL;
+		}
+		return sh;
+	}
+	rcu_read_unlock();
+
+	return NULL;
+}
+
 /*
  * Need to check if array has failed when deciding whether to:
  *  - start an array
@@ -810,6 +851,12 @@ struct stripe_head *raid5_get_active_stripe(struct r5conf *conf,
 
 	pr_debug("get_stripe, sector %llu\n", (unsigned long long)sector);
 
+	if (!conf->quiesce || (flags & R5_GAS_NOQUIESCE)) {
+		sh = find_get_stripe_lockless(conf, sector, flags);
+		if (sh)
+			return sh;
+	}
+
 	spin_lock_irq(conf->hash_locks + hash);
 
 	for (;;) {
@@ -841,6 +888,12 @@ struct stripe_head *raid5_get_active_stripe(struct r5conf *conf,
 			if (sh) {
 				r5c_check_stripe_cache_usage(conf);
 				init_stripe(sh, sector, previous);
+				/*
+				 * Pairs with atomic_inc_not_zero() in
+				 * find_get_stripe_lockless(), which must not
+				 * see the old sector once the count is raised.
+				 */
+				smp_mb__before_atomic();
 				atomic_inc(&sh->count);
 				break;
 			}
@@ -2415,7 +2468,7 @@ static int grow_stripes(struct r5conf *conf, int num)
 	conf->active_name = 0;
 	sc = kmem_cache_create(conf->cache_name[conf->active_name],
 			       struct_size_t(struct stripe_head, dev, devs),
-			       0, 0, NULL);
+			       0, SLAB_TYPESAFE_BY_RCU, NULL);
 	if (!sc)
 		return 1;
 	conf->slab_cache = sc;
@@ -2539,7 +2592,7 @@ static int resize_stripes(struct r5conf *conf, int newsize)
 	/* Step 1 */
 	sc = kmem_cache_create(conf->cache_name[1-conf->active_name],
 			       struct_size_t(struct stripe_head, dev, newsize),
-			       0, 0, NULL);
+			       0, SLAB_TYPESAFE_BY_RCU, NULL);
 	if (!sc)
 		return -ENOMEM;
 
@@ -55,6 +55,7 @@
 #include <linux/ctype.h>
 #include <linux/inet.h>
 #include <linux/bitops.h>
+#include <linux/log2.h>
 #include <linux/io.h>
 #include <asm/dma.h>
 #include <linux/uaccess.h>
@@ -5277,6 +5278,18 @@ int bond_update_slave_arr(struct bonding *bond, struct slave *skipslave)
 	return ret;
 }
 
+/* Pick the usable slave for @hash, @count being the non-zero number of
+ * slaves in @slaves. Bonds usually have a power of two number of slaves,
+ * which does not need the division.
+ */
+static struct slave *bond_slave_by_hash(struct bond_up_slave *slaves,
+					unsigned int count, u32 hash)
+{
+	if (is_power_of_2(count))
+		return slaves->arr[hash & (count - 1)];
+	return slaves->arr[hash % count];
+}
+
 static struct slave *bond_xmit_3ad_xor_slave_get(struct bonding *bond,
 						 struct sk_buff *skb,
 						 struct bond_up_slave *slaves)
@@ -5290,7 +5303,7 @@ static struct slave *bond_xmit_3ad_xor_slave_get(struct bonding *bond,
 	if (unlikely(!count))
 		return NULL;
 
-	slave = slaves->arr[hash % count];
+	slave = bond_slave_by_hash(slaves, count, hash);
 	return slave;
 }
 
@@ -5307,7 +5320,7 @@ static struct slave *bond_xdp_xmit_3ad_xor_slave_get(struct bonding *bond,
 	if (unlikely(!count))
 		return NULL;
 
-	return slaves->arr[hash % count];
+	return bond_slave_by_hash(slaves, count, hash);
 }
 
 /* Use this Xmit function for 3AD as well as XOR modes. The current
@@ -5523,7 +5536,7 @@ static struct net_device *__bond_sk_get_lower_dev(struct bonding *bond,
 		return NULL;
 
 	hash = bond_sk_hash_l34(sk);
-	slave = slaves->arr[hash % count];
+	slave = bond_slave_by_hash(slaves, count, hash);
 
 	return slave->dev;
 }
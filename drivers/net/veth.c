@@ -904,18 +904,35 @@ static int veth_xdp_rcv(struct veth_rq *rq, int budget,
 	int queue_idx = rq->xdp_rxq.queue_index;
 	struct netdev_queue *peer_txq;
 	struct net_device *peer_dev;
-	int i, done = 0, n_xdpf = 0;
+	int i, n = 0, done = 0, n_xdpf = 0;
+	void *ptrs[VETH_XDP_BATCH];
 	void *xdpf[VETH_XDP_BATCH];
 
 	/* NAPI functions as RCU section */
 	peer_dev = rcu_dereference_check(priv->peer, rcu_read_lock_bh_held());
 	peer_txq = peer_dev ? netdev_get_tx_queue(peer_dev, queue_idx) : NULL;
 
-	for (i = 0; i < budget; i++) {
-		void *ptr = __ptr_ring_consume(&rq->xdp_ring);
+	for (i = 0; done < budget; i++, done++) {
+		void *ptr;
 
-		if (!ptr)
-			break;
+		/* Frames and skbs were just written by the peer's CPU. Take
+		 * them off the ring a batch at a time so that their cache
+		 * misses overlap instead of being paid one after another.
+		 */
+		if (i == n) {
+			int j;
+
+			n = __ptr_ring_consume_batched(&rq->xdp_ring, ptrs,
+						       min(budget - done,
+							   VETH_XDP_BATCH));
+			if (!n)
+				break;
+			for (j = 0; j < n; j++)
+				prefetch(veth_is_xdp_frame(ptrs[j]) ?
+					 veth_ptr_to_xdp(ptrs[j]) : ptrs[j]);
+			i = 0;
+		}
+		ptr = ptrs[i];
 
 		if (veth_is_xdp_frame(ptr)) {
 			/* ndo_xdp_xmit */
@@ -945,7 +962,6 @@ static int veth_xdp_rcv(struct veth_rq *rq, int budget,
 					napi_gro_receive(&rq->xdp_napi, skb);
 			}
 		}
-		done++;
 	}
 
 	if (n_xdpf)
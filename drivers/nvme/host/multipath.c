@@ -69,8 +69,17 @@ static const char *nvme_iopolicy_names[] = {
 	[NVME_IOPOLICY_NUMA]	= "numa",
 	[NVME_IOPOLICY_RR]	= "round-robin",
 	[NVME_IOPOLICY_QD]      = "queue-depth",
+	[NVME_IOPOLICY_ST]      = "service-time",
 };
 
+/*
+ * The service-time policy weighs each path's in-flight I/O by an EWMA of its
+ * completion latency.  A path that has seen no completion for this long has
+ * its estimate forgotten, so that a path which recovered gets probed again.
+ */
+#define NVME_ST_EWMA_SHIFT	3
+#define NVME_ST_STALE		HZ
+
 static int iopolicy = NVME_IOPOLICY_NUMA;
 
 static int nvme_set_iopolicy(const char *val, const struct kernel_param *kp)
@@ -83,6 +92,8 @@ static int nvme_set_iopolicy(const char *val, const struct kernel_param *kp)
 		iopolicy = NVME_IOPOLICY_RR;
 	else if (!strncmp(val, "queue-depth", 11))
 		iopolicy = NVME_IOPOLICY_QD;
+	else if (!strncmp(val, "service-time", 12))
+		iopolicy = NVME_IOPOLICY_ST;
 	else
 		return -EINVAL;
 
@@ -97,7 +108,7 @@ static int nvme_get_iopolicy(char *buf, const struct kernel_param *kp)
 module_param_call(iopolicy, nvme_set_iopolicy, nvme_get_iopolicy,
 	&iopolicy, 0644);
 MODULE_PARM_DESC(iopolicy,
-	"Default multipath I/O policy; 'numa' (default), 'round-robin' or 'queue-depth'");
+	"Default multipath I/O policy; 'numa' (default), 'round-robin', 'queue-depth' or 'service-time'");
 
 void nvme_mpath_default_iopolicy(struct nvme_subsystem *subsys)
 {
@@ -181,11 +192,16 @@ void nvme_mpath_start_request(struct request *rq)
 {
 	struct nvme_ns *ns = rq->q->queuedata;
 	struct gendisk *disk = ns->head->disk;
+	int policy = READ_ONCE(ns->head->subsys->iopolicy);
 
-	if (READ_ONCE(ns->head->subsys->iopolicy) == NVME_IOPOLICY_QD) {
+	if (policy == NVME_IOPOLICY_QD || policy == NVME_IOPOLICY_ST) {
 		atomic_inc(&ns->ctrl->nr_active);
 		nvme_req(rq)->flags |= NVME_MPATH_CNT_ACTIVE;
 	}
+	if (policy == NVME_IOPOLICY_ST) {
+		nvme_req(rq)->issue_time_ns = ktime_get_ns();
+		nvme_req(rq)->flags |= NVME_MPATH_SERVICE_TIME;
+	}
 
 	if (!blk_queue_io_stat(disk->queue) || blk_rq_is_passthrough(rq))
 		return;
@@ -203,6 +219,19 @@ void nvme_mpath_end_request(struct request *rq)
 	if (nvme_req(rq)->flags & NVME_MPATH_CNT_ACTIVE)
 		atomic_dec_if_positive(&ns->ctrl->nr_active);
 
+	if (nvme_req(rq)->flags & NVME_MPATH_SERVICE_TIME) {
+		u64 lat = ktime_get_ns() - nvme_req(rq)->issue_time_ns;
+		u64 ewma = READ_ONCE(ns->service_time_ns);
+
+		/* racing updates may lose a sample, which is fine for an average */
+		if (ewma)
+			ewma += ((s64)lat - (s64)ewma) >> NVME_ST_EWMA_SHIFT;
+		else
+			ewma = lat;
+		WRITE_ONCE(ns->service_time_ns, ewma);
+		WRITE_ONCE(ns->service_time_stamp, jiffies);
+	}
+
 	if (!(nvme_req(rq)->flags & NVME_MPATH_IO_STATS))
 		return;
 	bdev_end_io_acct(ns->head->disk->part0, req_op(rq),
@@ -442,6 +471,65 @@ static struct nvme_ns *nvme_queue_depth_path(struct nvme_ns_head *head)
 	return best_opt ? best_opt : best_nonopt;
 }
 
+/*
+ * Estimate when a new I/O on @ns would complete: the I/O already in flight on
+ * the controller plus this one, each taking the path's average service time,
+ * scaled by the NUMA distance to the controller.
+ */
+static u64 nvme_service_time_estimate(struct nvme_ns *ns, int node)
+{
+	unsigned int depth = atomic_read(&ns->ctrl->nr_active);
+	u64 st = READ_ONCE(ns->service_time_ns);
+
+	if (!st || (!depth &&
+		    time_after(jiffies, READ_ONCE(ns->service_time_stamp) +
+					NVME_ST_STALE)))
+		return 0;
+
+	st *= depth + 1;
+	if (ns->ctrl->numa_node != NUMA_NO_NODE)
+		st = div_u64(st * node_distance(node, ns->ctrl->numa_node),
+			     LOCAL_DISTANCE);
+	return st;
+}
+
+static struct nvme_ns *nvme_service_time_path(struct nvme_ns_head *head)
+{
+	struct nvme_ns *best_opt = NULL, *best_nonopt = NULL, *ns;
+	u64 min_opt = U64_MAX, min_nonopt = U64_MAX, est;
+	int node = numa_node_id();
+
+	list_for_each_entry_srcu(ns, &head->list, siblings,
+				 srcu_read_lock_held(&head->srcu)) {
+		if (nvme_path_is_disabled(ns))
+			continue;
+
+		est = nvme_service_time_estimate(ns, node);
+
+		switch (ns->ana_state) {
+		case NVME_ANA_OPTIMIZED:
+			if (est < min_opt) {
+				min_opt = est;
+				best_opt = ns;
+			}
+			break;
+		case NVME_ANA_NONOPTIMIZED:
+			if (est < min_nonopt) {
+				min_nonopt = est;
+				best_nonopt = ns;
+			}
+			break;
+		default:
+			break;
+		}
+
+		if (min_opt == 0)
+			return best_opt;
+	}
+
+	return best_opt ? best_opt : best_nonopt;
+}
+
 static inline bool nvme_path_is_optimized(struct nvme_ns *ns)
 {
 	return nvme_ctrl_state(ns->ctrl) == NVME_CTRL_LIVE &&
@@ -466,6 +554,8 @@ inline struct nvme_ns *nvme_find_path(struct nvme_ns_head *head)
 	switch (READ_ONCE(head->subsys->iopolicy)) {
 	case NVME_IOPOLICY_QD:
 		return nvme_queue_depth_path(head);
+	case NVME_IOPOLICY_ST:
+		return nvme_service_time_path(head);
 	case NVME_IOPOLICY_RR:
 		return nvme_round_robin_path(head);
 	default:
@@ -1089,13 +1179,26 @@ static ssize_t queue_depth_show(struct device *dev,
 {
 	struct nvme_ns *ns = nvme_get_ns_from_dev(dev);
 
-	if (ns->head->subsys->iopolicy != NVME_IOPOLICY_QD)
+	if (ns->head->subsys->iopolicy != NVME_IOPOLICY_QD &&
+	    ns->head->subsys->iopolicy != NVME_IOPOLICY_ST)
 		return 0;
 
 	return sysfs_emit(buf, "%d\n", atomic_read(&ns->ctrl->nr_active));
 }
 DEVICE_ATTR_RO(queue_depth);
 
+static ssize_t service_time_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct nvme_ns *ns = nvme_get_ns_from_dev(dev);
+
+	if (ns->head->subsys->iopolicy != NVME_IOPOLICY_ST)
+		return 0;
+
+	return sysfs_emit(buf, "%llu\n", READ_ONCE(ns->service_time_ns));
+}
+DEVICE_ATTR_RO(service_time);
+
 static ssize_t numa_nodes_show(struct device *dev, struct device_attribute *attr,
 		char *buf)
 {
@@ -193,6 +193,7 @@ struct nvme_request {
 	u16			status;
 #ifdef CONFIG_NVME_MULTIPATH
 	unsigned long		start_time;
+	u64			issue_time_ns;	/* for the service-time policy */
 #endif
 	struct nvme_ctrl	*ctrl;
 };
@@ -207,6 +208,7 @@ enum {
 	NVME_REQ_USERCMD		= (1 << 1),
 	NVME_MPATH_IO_STATS		= (1 << 2),
 	NVME_MPATH_CNT_ACTIVE		= (1 << 3),
+	NVME_MPATH_SERVICE_TIME		= (1 << 4),
 };
 
 static inline struct nvme_request *nvme_req(struct request *req)
@@ -421,6 +423,7 @@ enum nvme_iopolicy {
 	NVME_IOPOLICY_NUMA,
 	NVME_IOPOLICY_RR,
 	NVME_IOPOLICY_QD,
+	NVME_IOPOLICY_ST,
 };
 
 struct nvme_subsystem {
@@ -534,6 +537,9 @@ struct nvme_ns {
 #ifdef CONFIG_NVME_MULTIPATH
 	enum nvme_ana_state ana_state;
 	u32 ana_grpid;
+	/* service-time policy: completion latency EWMA and when last updated */
+	u64 service_time_ns;
+	unsigned long service_time_stamp;
 #endif
 	struct list_head siblings;
 	struct kref kref;
@@ -992,6 +998,7 @@ extern struct device_attribute dev_attr_ana_grpid;
 extern struct device_attribute dev_attr_ana_state;
 extern struct device_attribute dev_attr_queue_depth;
 extern struct device_attribute dev_attr_numa_nodes;
+extern struct device_attribute dev_attr_service_time;
 extern struct device_attribute dev_attr_delayed_removal_secs;
 extern struct device_attribute subsys_attr_iopolicy;
 
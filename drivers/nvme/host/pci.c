@@ -643,6 +643,17 @@ static void nvme_unmap_data(struct nvme_dev *dev, struct nvme_queue *nvmeq,
 	struct nvme_iod *iod = blk_mq_rq_to_pdu(req);
 
 	if (iod->dma_len) {
+		/*
+		 * With a PRP list first_dma points to the list, the data
+		 * mapping itself is in PRP1.
+		 */
+		if (iod->nr_descriptors) {
+			dma_unmap_page(dev->dev,
+				       le64_to_cpu(iod->cmd.common.dptr.prp1),
+				       iod->dma_len, rq_dma_dir(req));
+			nvme_free_descriptors(nvmeq, req);
+			return;
+		}
 		dma_unmap_page(dev->dev, iod->first_dma, iod->dma_len,
 			       rq_dma_dir(req));
 		return;
@@ -828,6 +839,75 @@ static blk_status_t nvme_setup_prp_simple(struct nvme_dev *dev,
 	return BLK_STS_OK;
 }
 
+/*
+ * A single segment too large for nvme_setup_prp_simple(), e.g. from a huge
+ * page backed registered buffer, on a controller that doesn't use SGLs.  The
+ * segment is DMA contiguous, so the PRP list can be filled in directly without
+ * going through a scatterlist.
+ */
+static blk_status_t nvme_setup_prp_single(struct nvme_dev *dev,
+		struct nvme_queue *nvmeq, struct request *req,
+		struct nvme_rw_command *cmnd, struct bio_vec *bv)
+{
+	struct nvme_iod *iod = blk_mq_rq_to_pdu(req);
+	dma_addr_t data_dma, dma_addr, prp_dma;
+	unsigned int offset;
+	__le64 *prp_list;
+	int length, i;
+
+	data_dma = dma_map_bvec(dev->dev, bv, rq_dma_dir(req), 0);
+	if (dma_mapping_error(dev->dev, data_dma))
+		return BLK_STS_RESOURCE;
+	iod->dma_len = bv->bv_len;
+	cmnd->dptr.prp1 = cpu_to_le64(data_dma);
+
+	offset = data_dma & (NVME_CTRL_PAGE_SIZE - 1);
+	dma_addr = data_dma + (NVME_CTRL_PAGE_SIZE - offset);
+	length = bv->bv_len - (NVME_CTRL_PAGE_SIZE - offset);
+
+	if (DIV_ROUND_UP(length, NVME_CTRL_PAGE_SIZE) <=
+	    NVME_SMALL_POOL_SIZE / sizeof(__le64))
+		iod->flags |= IOD_SMALL_DESCRIPTOR;
+
+	prp_list = dma_pool_alloc(nvme_dma_pool(nvmeq, iod), GFP_ATOMIC,
+			&prp_dma);
+	if (!prp_list)
+		goto out_unmap;
+	iod->descriptors[iod->nr_descriptors++] = prp_list;
+	iod->first_dma = prp_dma;
+	i = 0;
+	for (;;) {
+		if (i == NVME_CTRL_PAGE_SIZE >> 3) {
+			__le64 *old_prp_list = prp_list;
+
+			prp_list = dma_pool_alloc(nvmeq->descriptor_pools.large,
+					GFP_ATOMIC, &prp_dma);
+			if (!prp_list)
+				goto out_free_prps;
+			iod->descriptors[iod->nr_descriptors++] = prp_list;
+			prp_list[0] = old_prp_list[i - 1];
+			old_prp_list[i - 1] = cpu_to_le64(prp_dma);
+			i = 1;
+		}
+		prp_list[i++] = cpu_to_le64(dma_addr);
+		dma_addr += NVME_CTRL_PAGE_SIZE;
+		length -= NVME_CTRL_PAGE_SIZE;
+		if (length <= 0)
+			break;
+	}
+
+	cmnd->dptr.prp2 = cpu_to_le64(iod->first_dma);
+	return BLK_STS_OK;
+
+out_free_prps:
+	nvme_free_descriptors(nvmeq, req);
+	iod->nr_descriptors = 0;
+out_unmap:
+	dma_unmap_page(dev->dev, data_dma, bv->bv_len, rq_dma_dir(req));
+	iod->dma_len = 0;
+	return BLK_STS_RESOURCE;
+}
+
 static blk_status_t nvme_setup_sgl_simple(struct nvme_dev *dev,
 		struct request *req, struct nvme_rw_command *cmnd,
 		struct bio_vec *bv)
@@ -868,6 +948,10 @@ static blk_status_t nvme_map_data(struct nvme_dev *dev, struct request *req,
 			    nvme_ctrl_sgl_supported(&dev->ctrl))
 				return nvme_setup_sgl_simple(dev, req,
 							     &cmnd->rw, &bv);
+
+			if (!nvme_pci_use_sgls(dev, req, 1))
+				return nvme_setup_prp_single(dev, nvmeq, req,
+							     &cmnd->rw, &bv);
 		}
 	}
 
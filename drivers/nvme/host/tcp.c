@@ -43,6 +43,14 @@ static bool wq_unbound;
 module_param(wq_unbound, bool, 0644);
 MODULE_PARM_DESC(wq_unbound, "Use unbound workqueue for nvme-tcp IO context (default false)");
 
+/*
+ * Run a queue's io_work on the CPU that receives its packets, so that
+ * receive processing and the PDU handling in io_work share caches.
+ */
+static bool io_cpu_follow_rx;
+module_param(io_cpu_follow_rx, bool, 0644);
+MODULE_PARM_DESC(io_cpu_follow_rx, "Bind nvme-tcp IO context to the socket's receive CPU (default false)");
+
 /*
  * TLS handshake timeout
  */
@@ -1621,6 +1629,21 @@ static bool nvme_tcp_poll_queue(struct nvme_tcp_queue *queue)
 			  ctrl->io_queues[HCTX_TYPE_POLL];
 }
 
+/*
+ * With io_cpu_follow_rx, use the CPU the connection's packets are steered to.
+ * The connect exchange has been received by the time this is called, so the
+ * socket knows it.
+ */
+static int nvme_tcp_rx_cpu(struct nvme_tcp_queue *queue)
+{
+	int cpu = READ_ONCE(queue->sock->sk->sk_incoming_cpu);
+
+	if (!io_cpu_follow_rx || cpu < 0 || cpu >= nr_cpu_ids ||
+	    !cpu_online(cpu))
+		return WORK_CPU_UNBOUND;
+	return cpu;
+}
+
 /*
  * Track the number of queues assigned to each cpu using a global per-cpu
  * counter and select the least used cpu from the mq_map. Our goal is to spread
@@ -1651,8 +1674,11 @@ static void nvme_tcp_set_queue_io_cpu(struct nvme_tcp_queue *queue)
 	if (WARN_ON(!mq_map))
 		goto out;
 
+	io_cpu = nvme_tcp_rx_cpu(queue);
+	if (io_cpu != WORK_CPU_UNBOUND)
+		goto set;
+
 	/* Search for the least used cpu from the mq_map */
-	io_cpu = WORK_CPU_UNBOUND;
 	for_each_online_cpu(cpu) {
 		int num_queues = atomic_read(&nvme_tcp_cpu_queues[cpu]);
 
@@ -1663,6 +1689,7 @@ static void nvme_tcp_set_queue_io_cpu(struct nvme_tcp_queue *queue)
 			min_queues = num_queues;
 		}
 	}
+set:
 	if (io_cpu != WORK_CPU_UNBOUND) {
 		queue->io_cpu = io_cpu;
 		atomic_inc(&nvme_tcp_cpu_queues[io_cpu]);
@@ -1395,13 +1395,21 @@ static void nvmet_tcp_io_work(struct work_struct *w)
 {
 	struct nvmet_tcp_queue *queue =
 		container_of(w, struct nvmet_tcp_queue, io_work);
+	struct blk_plug plug;
 	bool pending;
 	int ret, ops = 0;
 
 	do {
 		pending = false;
 
+		/*
+		 * Commands received in one pass are executed from here, so a
+		 * plug lets the block layer batch the bios of all of them
+		 * rather than flushing each command's on its own.
+		 */
+		blk_start_plug(&plug);
 		ret = nvmet_tcp_try_recv(queue, NVMET_TCP_RECV_BUDGET, &ops);
+		blk_finish_plug(&plug);
 		if (ret > 0)
 			pending = true;
 		else if (ret < 0)
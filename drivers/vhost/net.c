@@ -118,6 +118,8 @@ struct vhost_net_virtqueue {
 	int done_idx;
 	/* Number of XDP frames batched */
 	int batched_xdp;
+	/* Used entries were added without signalling the guest */
+	bool signal_pending;
 	/* an array of userspace buffers info */
 	struct ubuf_info_msgzc *ubuf_info;
 	/* Reference counting for outstanding ubufs.
@@ -306,6 +308,7 @@ static void vhost_net_vq_reset(struct vhost_net *n)
 
 	for (i = 0; i < VHOST_NET_VQ_MAX; i++) {
 		n->vqs[i].done_idx = 0;
+		n->vqs[i].signal_pending = false;
 		n->vqs[i].upend_idx = 0;
 		n->vqs[i].ubufs = NULL;
 		n->vqs[i].vhost_hlen = 0;
@@ -449,22 +452,36 @@ static int vhost_net_enable_vq(struct vhost_net *n,
 	return vhost_poll_start(poll, sock->file);
 }
 
-static void vhost_net_signal_used(struct vhost_net_virtqueue *nvq)
+static void vhost_net_add_used(struct vhost_net_virtqueue *nvq)
 {
 	struct vhost_virtqueue *vq = &nvq->vq;
-	struct vhost_dev *dev = vq->dev;
 
 	if (!nvq->done_idx)
 		return;
 
-	vhost_add_used_and_signal_n(dev, vq, vq->heads, nvq->done_idx);
+	vhost_add_used_n(vq, vq->heads, nvq->done_idx);
 	nvq->done_idx = 0;
+	nvq->signal_pending = true;
+}
+
+static void vhost_net_signal_used(struct vhost_net_virtqueue *nvq)
+{
+	struct vhost_virtqueue *vq = &nvq->vq;
+	struct vhost_dev *dev = vq->dev;
+
+	if (!nvq->done_idx && !nvq->signal_pending)
+		return;
+
+	vhost_net_add_used(nvq);
+	vhost_signal(dev, vq);
+	nvq->signal_pending = false;
 }
 
 static void vhost_tx_batch(struct vhost_net *net,
 			   struct vhost_net_virtqueue *nvq,
 			   struct socket *sock,
-			   struct msghdr *msghdr)
+			   struct msghdr *msghdr,
+			   bool signal)
 {
 	struct tun_msg_ctl ctl = {
 		.type = TUN_MSG_PTR,
@@ -494,7 +511,10 @@ static void vhost_tx_batch(struct vhost_net *net,
 	}
 
 signal_used:
-	vhost_net_signal_used(nvq);
+	if (signal)
+		vhost_net_signal_used(nvq);
+	else
+		vhost_net_add_used(nvq);
 	nvq->batched_xdp = 0;
 }
 
@@ -588,7 +608,7 @@ static int vhost_net_tx_get_vq_desc(struct vhost_net *net,
 		if (!vhost_sock_zcopy(vhost_vq_get_backend(tvq)))
 			vhost_tx_batch(net, tnvq,
 				       vhost_vq_get_backend(tvq),
-				       msghdr);
+				       msghdr, true);
 
 		vhost_net_busy_poll(net, rvq, tvq, busyloop_intr, false);
 
@@ -759,8 +779,12 @@ static void handle_tx_copy(struct vhost_net *net, struct socket *sock)
 
 	do {
 		busyloop_intr = false;
+		/* Hand the buffers back but leave signalling the guest to
+		 * the end of the loop, one completion interrupt covers all
+		 * batches of this run.
+		 */
 		if (nvq->done_idx == VHOST_NET_BATCH)
-			vhost_tx_batch(net, nvq, sock, &msg);
+			vhost_tx_batch(net, nvq, sock, &msg, false);
 
 		head = get_tx_bufs(net, nvq, &msg, &out, &in, &len,
 				   &busyloop_intr);
@@ -786,7 +810,7 @@ static void handle_tx_copy(struct vhost_net *net, struct socket *sock)
 			if (!err) {
 				goto done;
 			} else if (unlikely(err != -ENOSPC)) {
-				vhost_tx_batch(net, nvq, sock, &msg);
+				vhost_tx_batch(net, nvq, sock, &msg, true);
 				vhost_discard_vq_desc(vq, 1);
 				vhost_net_enable_vq(net, vq);
 				break;
@@ -796,7 +820,7 @@ static void handle_tx_copy(struct vhost_net *net, struct socket *sock)
 			 * packet path but let's flush batched
 			 * packets.
 			 */
-			vhost_tx_batch(net, nvq, sock, &msg);
+			vhost_tx_batch(net, nvq, sock, &msg, false);
 			msg.msg_control = NULL;
 		} else {
 			if (tx_can_batch(vq, total_len))
@@ -823,7 +847,7 @@ static void handle_tx_copy(struct vhost_net *net, struct socket *sock)
 	} while (likely(!vhost_exceeds_weight(vq, ++sent_pkts, total_len)));
 
 	/* Kicks are still disabled, dispatch any remaining batched msgs. */
-	vhost_tx_batch(net, nvq, sock, &msg);
+	vhost_tx_batch(net, nvq, sock, &msg, true);
 
 	if (unlikely(busyloop_intr))
 		/* If interrupted while doing busy polling, requeue the
@@ -1324,6 +1348,7 @@ static int vhost_net_open(struct inode *inode, struct file *f)
 		n->vqs[i].upend_idx = 0;
 		n->vqs[i].done_idx = 0;
 		n->vqs[i].batched_xdp = 0;
+		n->vqs[i].signal_pending = false;
 		n->vqs[i].vhost_hlen = 0;
 		n->vqs[i].sock_hlen = 0;
 		n->vqs[i].rx_ring = NULL;
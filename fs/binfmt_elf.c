@@ -391,6 +391,27 @@ static unsigned long elf_map(struct file *filep, unsigned long addr,
 	return(map_addr);
 }
 
+/*
+ * Upper bound, in KiB, of the text of each executable segment that is
+ * populated at exec time instead of being faulted in page by page.
+ */
+static unsigned int prefault_kb;
+module_param(prefault_kb, uint, 0644);
+MODULE_PARM_DESC(prefault_kb, "KiB of executable segment text to populate at exec (0 = off)");
+
+static void elf_prefault_text(unsigned long map_addr,
+			      const struct elf_phdr *eppnt, int prot)
+{
+	unsigned long len = (unsigned long)READ_ONCE(prefault_kb) << 10;
+
+	/* Writable segments would be COW-copied, leave them to faults */
+	if (!len || !eppnt->p_filesz || (prot & (PROT_EXEC | PROT_WRITE)) != PROT_EXEC)
+		return;
+
+	len = min(len, ELF_PAGEALIGN(eppnt->p_filesz + ELF_PAGEOFFSET(eppnt->p_vaddr)));
+	mm_populate(ELF_PAGESTART(map_addr), len);
+}
+
 /*
  * Map "eppnt->p_filesz" bytes from "filep" offset "eppnt->p_offset"
  * into memory at "addr". Memory from "p_filesz" through "p_memsz"
@@ -677,6 +698,7 @@ static unsigned long load_elf_interp(struct elfhdr *interp_elf_ex,
 			error = map_addr;
 			if (BAD_ADDR(map_addr))
 				goto out;
+			elf_prefault_text(map_addr, eppnt, elf_prot);
 
 			if (!load_addr_set &&
 			    interp_elf_ex->e_type == ET_DYN) {
@@ -1177,6 +1199,7 @@ static int load_elf_binary(struct linux_binprm *bprm)
 				PTR_ERR((void*)error) : -EINVAL;
 			goto out_free_dentry;
 		}
+		elf_prefault_text(error, elf_ppnt, elf_prot);
 
 		if (first_pt_load) {
 			first_pt_load = 0;
@@ -2862,6 +2862,7 @@ void btrfs_init_fs_info(struct btrfs_fs_info *fs_info)
 	btrfs_init_balance(fs_info);
 	btrfs_init_async_reclaim_work(fs_info);
 	btrfs_init_extent_map_shrinker_work(fs_info);
+	INIT_WORK(&fs_info->delayed_refs_work, btrfs_async_run_delayed_refs);
 
 	rwlock_init(&fs_info->block_group_cache_lock);
 	fs_info->block_group_cache_tree = RB_ROOT_CACHED;
@@ -4333,6 +4334,7 @@ void __cold close_ctree(struct btrfs_fs_info *fs_info)
 	cancel_work_sync(&fs_info->async_data_reclaim_work);
 	cancel_work_sync(&fs_info->preempt_reclaim_work);
 	cancel_work_sync(&fs_info->em_shrinker_work);
+	cancel_work_sync(&fs_info->delayed_refs_work);
 
 	/*
 	 * Run delayed iputs again because an async reclaim worker may have
@@ -420,6 +420,8 @@ struct btrfs_commit_stats {
 	u64 last_commit_dur;
 	/* The total commit duration in ns */
 	u64 total_commit_dur;
+	/* Commits that still had delayed refs to run when they started */
+	u64 delayed_ref_commits;
 };
 
 struct btrfs_fs_info {
@@ -795,6 +797,9 @@ struct btrfs_fs_info {
 	struct work_struct async_data_reclaim_work;
 	struct work_struct preempt_reclaim_work;
 
+	/* Runs delayed refs in the background when too many are queued */
+	struct work_struct delayed_refs_work;
+
 	/* Reclaim partially filled block groups in the background */
 	struct work_struct reclaim_bgs_work;
 	/* Protected by unused_bgs_lock. */
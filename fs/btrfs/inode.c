@@ -1580,6 +1580,20 @@ static noinline void submit_compressed_extents(struct btrfs_work *work, bool do_
 		cond_wake_up_nomb(&fs_info->async_submit_wait);
 }
 
+/*
+ * Each async chunk compresses its range BTRFS_MAX_UNCOMPRESSED bytes at a
+ * time in one worker. Spread ranges that would only fill a few 512K chunks
+ * over more, smaller chunks, so that they are compressed by as many of the
+ * delalloc workers as possible instead of one.
+ */
+static u64 async_chunk_size(const struct btrfs_fs_info *fs_info, u64 len)
+{
+	u64 size = DIV_ROUND_UP_ULL(len, max(READ_ONCE(fs_info->thread_pool_size), 1U));
+
+	return clamp_t(u64, round_up(size, BTRFS_MAX_UNCOMPRESSED),
+		       BTRFS_MAX_UNCOMPRESSED, SZ_512K);
+}
+
 static bool run_delalloc_compressed(struct btrfs_inode *inode,
 				    struct folio *locked_folio, u64 start,
 				    u64 end, struct writeback_control *wbc)
@@ -1589,7 +1603,8 @@ static bool run_delalloc_compressed(struct btrfs_inode *inode,
 	struct async_cow *ctx;
 	struct async_chunk *async_chunk;
 	unsigned long nr_pages;
-	u64 num_chunks = DIV_ROUND_UP(end - start, SZ_512K);
+	const u64 chunk_size = async_chunk_size(fs_info, end + 1 - start);
+	u64 num_chunks = DIV_ROUND_UP_ULL(end - start, chunk_size);
 	int i;
 	unsigned nofs_flag;
 	const blk_opf_t write_flags = wbc_to_write_flags(wbc);
@@ -1606,7 +1621,7 @@ static bool run_delalloc_compressed(struct btrfs_inode *inode,
 	atomic_set(&ctx->num_chunks, num_chunks);
 
 	for (i = 0; i < num_chunks; i++) {
-		u64 cur_end = min(end, start + SZ_512K - 1);
+		u64 cur_end = min(end, start + chunk_size - 1);
 
 		/*
 		 * igrab is called higher up in the call chain, take only the
@@ -58,6 +58,13 @@ struct scrub_ctx;
 
 #define SCRUB_TOTAL_STRIPES		(SCRUB_GROUPS_PER_SCTX * SCRUB_STRIPES_PER_GROUP)
 
+/*
+ * The stripes are used as a ring. Once all slots are queued only the oldest
+ * half is waited for and recycled, so the other half keeps the device busy
+ * while the first one is verified, repaired and written back.
+ */
+#define SCRUB_FLUSH_STRIPES		(SCRUB_TOTAL_STRIPES / 2)
+
 /*
  * The following value times PAGE_SIZE needs to be large enough to match the
  * largest node/leaf/sector size that shall be supported.
@@ -198,6 +205,9 @@ struct scrub_ctx {
 	struct btrfs_path	extent_path;
 	struct btrfs_path	csum_path;
 	int			first_free;
+	/* Slot of the oldest queued stripe, always at a group boundary */
+	int			first_stripe;
+	/* Number of queued stripes, starting at @first_stripe */
 	int			cur_stripe;
 	atomic_t		cancel_req;
 	int			readonly;
@@ -1208,7 +1218,7 @@ static void scrub_stripe_read_repair_worker(struct work_struct *work)
 		      stripe->nr_sectors);
 	if (!sctx->readonly && !bitmap_empty(&repaired, stripe->nr_sectors)) {
 		if (btrfs_is_zoned(fs_info)) {
-			btrfs_repair_one_zone(fs_info, sctx->stripes[0].bg->start);
+			btrfs_repair_one_zone(fs_info, stripe->bg->start);
 		} else {
 			scrub_write_sectors(sctx, stripe, repaired, false);
 			wait_scrub_stripe_io(stripe);
@@ -1924,7 +1934,7 @@ static void submit_initial_group_read(struct scrub_ctx *sctx,
 	ASSERT(first_slot < SCRUB_TOTAL_STRIPES);
 	ASSERT(first_slot + nr_stripes <= SCRUB_TOTAL_STRIPES);
 
-	scrub_throttle_dev_io(sctx, sctx->stripes[0].dev,
+	scrub_throttle_dev_io(sctx, sctx->stripes[first_slot].dev,
 			      btrfs_stripe_nr_to_offset(nr_stripes));
 	blk_start_plug(&plug);
 	for (int i = 0; i < nr_stripes; i++) {
@@ -1937,27 +1947,22 @@ static void submit_initial_group_read(struct scrub_ctx *sctx,
 	blk_finish_plug(&plug);
 }
 
-static int flush_scrub_stripes(struct scrub_ctx *sctx)
+static struct scrub_stripe *scrub_queued_stripe(struct scrub_ctx *sctx, int nr)
+{
+	return &sctx->stripes[(sctx->first_stripe + nr) % SCRUB_TOTAL_STRIPES];
+}
+
+/* Wait for the oldest @nr_stripes queued stripes and recycle their slots. */
+static int flush_queued_stripes(struct scrub_ctx *sctx, int nr_stripes)
 {
 	struct btrfs_fs_info *fs_info = sctx->fs_info;
 	struct scrub_stripe *stripe;
-	const int nr_stripes = sctx->cur_stripe;
 	int ret = 0;
 
-	if (!nr_stripes)
-		return 0;
-
-	ASSERT(test_bit(SCRUB_STRIPE_FLAG_INITIALIZED, &sctx->stripes[0].state));
-
-	/* Submit the stripes which are populated but not submitted. */
-	if (nr_stripes % SCRUB_STRIPES_PER_GROUP) {
-		const int first_slot = round_down(nr_stripes, SCRUB_STRIPES_PER_GROUP);
-
-		submit_initial_group_read(sctx, first_slot, nr_stripes - first_slot);
-	}
+	ASSERT(nr_stripes <= sctx->cur_stripe);
 
 	for (int i = 0; i < nr_stripes; i++) {
-		stripe = &sctx->stripes[i];
+		stripe = scrub_queued_stripe(sctx, i);
 
 		wait_event(stripe->repair_wait,
 			   test_bit(SCRUB_STRIPE_FLAG_REPAIR_DONE, &stripe->state));
@@ -1970,7 +1975,7 @@ static int flush_scrub_stripes(struct scrub_ctx *sctx)
 		 * metadata, we should immediately abort.
 		 */
 		for (int i = 0; i < nr_stripes; i++) {
-			if (stripe_has_metadata_error(&sctx->stripes[i])) {
+			if (stripe_has_metadata_error(scrub_queued_stripe(sctx, i))) {
 				ret = -EIO;
 				goto out;
 			}
@@ -1980,7 +1985,7 @@ static int flush_scrub_stripes(struct scrub_ctx *sctx)
 			unsigned long has_extent;
 			unsigned long error;
 
-			stripe = &sctx->stripes[i];
+			stripe = scrub_queued_stripe(sctx, i);
 
 			ASSERT(stripe->dev == fs_info->dev_replace.srcdev);
 
@@ -1993,7 +1998,7 @@ static int flush_scrub_stripes(struct scrub_ctx *sctx)
 
 	/* Wait for the above writebacks to finish. */
 	for (int i = 0; i < nr_stripes; i++) {
-		stripe = &sctx->stripes[i];
+		stripe = scrub_queued_stripe(sctx, i);
 
 		wait_scrub_stripe_io(stripe);
 		spin_lock(&sctx->stat_lock);
@@ -2002,10 +2007,45 @@ static int flush_scrub_stripes(struct scrub_ctx *sctx)
 		scrub_reset_stripe(stripe);
 	}
 out:
-	sctx->cur_stripe = 0;
+	sctx->cur_stripe -= nr_stripes;
+	/*
+	 * Only the oldest half is recycled while stripes are still queued,
+	 * which keeps @first_stripe group aligned. A full drain can leave it
+	 * anywhere, so start over from slot 0.
+	 */
+	if (sctx->cur_stripe)
+		sctx->first_stripe = (sctx->first_stripe + nr_stripes) % SCRUB_TOTAL_STRIPES;
+	else
+		sctx->first_stripe = 0;
 	return ret;
 }
 
+static int flush_scrub_stripes(struct scrub_ctx *sctx)
+{
+	const int nr_stripes = sctx->cur_stripe;
+
+	if (!nr_stripes)
+		return 0;
+
+	ASSERT(test_bit(SCRUB_STRIPE_FLAG_INITIALIZED,
+			&scrub_queued_stripe(sctx, 0)->state));
+
+	/*
+	 * Submit the stripes which are populated but not submitted. Groups
+	 * never wrap around the ring as @first_stripe is group aligned.
+	 */
+	if (nr_stripes % SCRUB_STRIPES_PER_GROUP) {
+		const int first_slot = (sctx->first_stripe +
+					round_down(nr_stripes, SCRUB_STRIPES_PER_GROUP)) %
+				       SCRUB_TOTAL_STRIPES;
+
+		submit_initial_group_read(sctx, first_slot,
+					  nr_stripes % SCRUB_STRIPES_PER_GROUP);
+	}
+
+	return flush_queued_stripes(sctx, nr_stripes);
+}
+
 static void raid56_scrub_wait_endio(struct bio *bio)
 {
 	complete(bio->bi_private);
@@ -2021,14 +2061,14 @@ static int queue_scrub_stripe(struct scrub_ctx *sctx, struct btrfs_block_group *
 
 	/*
 	 * There should always be one slot left, as caller filling the last
-	 * slot should flush them all.
+	 * slot should flush the oldest half.
 	 */
 	ASSERT(sctx->cur_stripe < SCRUB_TOTAL_STRIPES);
 
 	/* @found_logical_ret must be specified. */
 	ASSERT(found_logical_ret);
 
-	stripe = &sctx->stripes[sctx->cur_stripe];
+	stripe = scrub_queued_stripe(sctx, sctx->cur_stripe);
 	scrub_reset_stripe(stripe);
 	ret = scrub_find_fill_first_stripe(bg, &sctx->extent_path,
 					   &sctx->csum_path, dev, physical,
@@ -2041,14 +2081,17 @@ static int queue_scrub_stripe(struct scrub_ctx *sctx, struct btrfs_block_group *
 
 	/* We filled one group, submit it. */
 	if (sctx->cur_stripe % SCRUB_STRIPES_PER_GROUP == 0) {
-		const int first_slot = sctx->cur_stripe - SCRUB_STRIPES_PER_GROUP;
+		const int first_slot = stripe - sctx->stripes + 1 - SCRUB_STRIPES_PER_GROUP;
 
 		submit_initial_group_read(sctx, first_slot, SCRUB_STRIPES_PER_GROUP);
 	}
 
-	/* Last slot used, flush them all. */
+	/*
+	 * Last slot used, recycle the oldest half while the rest is still
+	 * being read.
+	 */
 	if (sctx->cur_stripe == SCRUB_TOTAL_STRIPES)
-		return flush_scrub_stripes(sctx);
+		return flush_queued_stripes(sctx, SCRUB_FLUSH_STRIPES);
 	return 0;
 }
 
@@ -1143,11 +1143,13 @@ static ssize_t btrfs_commit_stats_show(struct kobject *kobj,
 		"commits %llu\n"
 		"last_commit_ms %llu\n"
 		"max_commit_ms %llu\n"
-		"total_commit_ms %llu\n",
+		"total_commit_ms %llu\n"
+		"delayed_ref_commits %llu\n",
 		fs_info->commit_stats.commit_count,
 		div_u64(fs_info->commit_stats.last_commit_dur, NSEC_PER_MSEC),
 		div_u64(fs_info->commit_stats.max_commit_dur, NSEC_PER_MSEC),
-		div_u64(fs_info->commit_stats.total_commit_dur, NSEC_PER_MSEC));
+		div_u64(fs_info->commit_stats.total_commit_dur, NSEC_PER_MSEC),
+		fs_info->commit_stats.delayed_ref_commits);
 }
 
 static ssize_t btrfs_commit_stats_store(struct kobject *kobj,
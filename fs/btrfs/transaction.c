@@ -1052,6 +1052,50 @@ static void btrfs_trans_release_metadata(struct btrfs_trans_handle *trans)
 	trans->delayed_refs_bytes_reserved = 0;
 }
 
+/*
+ * Number of ready delayed ref heads above which ending a transaction handle
+ * kicks the background worker, and the number of heads it runs per pass.
+ */
+#define BTRFS_DELAYED_REFS_ASYNC_HEADS		4096
+#define BTRFS_DELAYED_REFS_ASYNC_BATCH		1024
+
+/*
+ * Keep the backlog of delayed refs of the running transaction bounded, so
+ * that the commit does not have to run them all in one go while every new
+ * transaction waits for it.
+ */
+void btrfs_async_run_delayed_refs(struct work_struct *work)
+{
+	struct btrfs_fs_info *fs_info = container_of(work, struct btrfs_fs_info,
+						     delayed_refs_work);
+	struct btrfs_trans_handle *trans;
+
+	trans = btrfs_join_transaction_nostart(fs_info->tree_root);
+	if (IS_ERR(trans))
+		return;
+
+	/* The commit runs what is left itself, don't contend with it */
+	if (trans->transaction->state < TRANS_STATE_COMMIT_START &&
+	    !test_bit(BTRFS_DELAYED_REFS_FLUSHING,
+		      &trans->transaction->delayed_refs.flags))
+		btrfs_run_delayed_refs(trans,
+			btrfs_calc_delayed_ref_bytes(fs_info,
+						     BTRFS_DELAYED_REFS_ASYNC_BATCH));
+	btrfs_end_transaction(trans);
+}
+
+static void btrfs_kick_delayed_refs(struct btrfs_fs_info *fs_info,
+				    struct btrfs_transaction *cur_trans)
+{
+	if (READ_ONCE(cur_trans->delayed_refs.num_heads_ready) <
+	    BTRFS_DELAYED_REFS_ASYNC_HEADS)
+		return;
+	if (READ_ONCE(cur_trans->state) >= TRANS_STATE_COMMIT_START ||
+	    btrfs_fs_closing(fs_info))
+		return;
+	queue_work(system_unbound_wq, &fs_info->delayed_refs_work);
+}
+
 static int __btrfs_end_transaction(struct btrfs_trans_handle *trans,
 				   int throttle)
 {
@@ -1085,6 +1129,7 @@ static int __btrfs_end_transaction(struct btrfs_trans_handle *trans,
 	btrfs_lockdep_release(info, btrfs_trans_num_extwriters);
 	btrfs_lockdep_release(info, btrfs_trans_num_writers);
 
+	btrfs_kick_delayed_refs(info, cur_trans);
 	btrfs_put_transaction(cur_trans);
 
 	if (current->journal_info == trans)
@@ -2201,6 +2246,8 @@ int btrfs_commit_transaction(struct btrfs_trans_handle *trans)
 	 */
 	if (!test_and_set_bit(BTRFS_DELAYED_REFS_FLUSHING,
 			      &cur_trans->delayed_refs.flags)) {
+		if (READ_ONCE(cur_trans->delayed_refs.num_heads_ready))
+			fs_info->commit_stats.delayed_ref_commits++;
 		/*
 		 * Make a pass through all the delayed refs we have so far.
 		 * Any running threads may add more while we are here.
@@ -782,6 +782,9 @@ static int cachefiles_daemon_bind(struct cachefiles_cache *cache, char *args)
 	if (IS_ENABLED(CONFIG_CACHEFILES_ONDEMAND)) {
 		if (!strcmp(args, "ondemand")) {
 			set_bit(CACHEFILES_ONDEMAND_MODE, &cache->flags);
+		} else if (!strcmp(args, "ondemand batch")) {
+			set_bit(CACHEFILES_ONDEMAND_MODE, &cache->flags);
+			set_bit(CACHEFILES_ONDEMAND_BATCH, &cache->flags);
 		} else if (*args) {
 			pr_err("Invalid argument to the 'bind' command\n");
 			return -EINVAL;
@@ -410,8 +410,8 @@ static inline bool cachefiles_ondemand_finish_req(struct cachefiles_req *req,
 	return true;
 }
 
-ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
-					char __user *_buffer, size_t buflen)
+static ssize_t cachefiles_ondemand_read_one(struct cachefiles_cache *cache,
+					    char __user *_buffer, size_t buflen)
 {
 	struct cachefiles_req *req;
 	struct cachefiles_msg *msg;
@@ -479,6 +479,45 @@ ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
 	return ret ? ret : n;
 }
 
+/*
+ * Hand out pending requests to the daemon.  Normally that's one per read, but
+ * if the cache was bound with "ondemand batch", as many requests as fit are
+ * packed into the buffer, each starting with its cachefiles_msg header and
+ * taking up msg->len bytes, zero padded to a multiple of 8 so that the next
+ * header is naturally aligned.
+ */
+ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
+					char __user *_buffer, size_t buflen)
+{
+	ssize_t copied = 0, n, pad;
+
+	if (!test_bit(CACHEFILES_ONDEMAND_BATCH, &cache->flags))
+		return cachefiles_ondemand_read_one(cache, _buffer, buflen);
+
+	while (copied < buflen) {
+		n = cachefiles_ondemand_read_one(cache, _buffer + copied,
+						 buflen - copied);
+		if (n <= 0) {
+			/* The requests already copied were taken off the queue */
+			if (copied)
+				break;
+			return n;
+		}
+		copied += n;
+
+		pad = ALIGN(n, 8) - n;
+		if (pad) {
+			/* No room for the padding, nor for another request */
+			if (buflen - copied < pad ||
+			    clear_user(_buffer + copied, pad))
+				break;
+			copied += pad;
+		}
+		cond_resched();
+	}
+	return copied;
+}
+
 typedef int (*init_req_fn)(struct cachefiles_req *req, void *private);
 
 static int cachefiles_ondemand_send_req(struct cachefiles_object *object,
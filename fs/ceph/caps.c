@@ -411,6 +411,33 @@ void ceph_put_cap(struct ceph_mds_client *mdsc, struct ceph_cap *cap)
 	spin_unlock(&mdsc->caps_list_lock);
 }
 
+/*
+ * Like ceph_put_cap(), for a list of caps linked through ->session_caps, so
+ * that releasing a whole batch takes caps_list_lock once.
+ */
+void ceph_put_caps(struct ceph_mds_client *mdsc, struct list_head *caps)
+{
+	struct ceph_cap *cap, *next;
+
+	spin_lock(&mdsc->caps_list_lock);
+	list_for_each_entry_safe(cap, next, caps, session_caps) {
+		list_del(&cap->session_caps);
+		mdsc->caps_use_count--;
+		if (mdsc->caps_avail_count >= mdsc->caps_reserve_count +
+					      mdsc->caps_min_count) {
+			mdsc->caps_total_count--;
+			kmem_cache_free(ceph_cap_cachep, cap);
+		} else {
+			mdsc->caps_avail_count++;
+			list_add(&cap->caps_item, &mdsc->caps_list);
+		}
+	}
+
+	BUG_ON(mdsc->caps_total_count != mdsc->caps_use_count +
+	       mdsc->caps_reserve_count + mdsc->caps_avail_count);
+	spin_unlock(&mdsc->caps_list_lock);
+}
+
 void ceph_reservation_status(struct ceph_fs_client *fsc,
 			     int *total, int *avail, int *used, int *reserved,
 			     int *min)
@@ -248,6 +248,36 @@ static int metrics_caps_show(struct seq_file *s, void *p)
 	return 0;
 }
 
+static int metrics_cap_releases_show(struct seq_file *s, void *p)
+{
+	struct ceph_fs_client *fsc = s->private;
+	struct ceph_mds_client *mdsc = fsc->mdsc;
+	int i;
+
+	seq_printf(s, "mds   pending     msgs            caps            max_delay(ms)\n");
+	seq_printf(s, "---------------------------------------------------------------\n");
+
+	mutex_lock(&mdsc->mutex);
+	for (i = 0; i < mdsc->max_sessions; i++) {
+		struct ceph_mds_session *session;
+
+		session = __ceph_lookup_mds_session(mdsc, i);
+		if (!session)
+			continue;
+		mutex_unlock(&mdsc->mutex);
+		seq_printf(s, "%-6d%-12d%-16llu%-16llu%u\n", session->s_mds,
+			   READ_ONCE(session->s_num_cap_releases),
+			   READ_ONCE(session->s_cap_release_msgs),
+			   READ_ONCE(session->s_cap_release_caps),
+			   jiffies_to_msecs(READ_ONCE(session->s_cap_release_max_delay)));
+		ceph_put_mds_session(session);
+		mutex_lock(&mdsc->mutex);
+	}
+	mutex_unlock(&mdsc->mutex);
+
+	return 0;
+}
+
 static int caps_show_cb(struct inode *inode, int mds, void *p)
 {
 	struct ceph_inode_info *ci = ceph_inode(inode);
@@ -371,6 +401,7 @@ DEFINE_SHOW_ATTRIBUTE(metrics_file);
 DEFINE_SHOW_ATTRIBUTE(metrics_latency);
 DEFINE_SHOW_ATTRIBUTE(metrics_size);
 DEFINE_SHOW_ATTRIBUTE(metrics_caps);
+DEFINE_SHOW_ATTRIBUTE(metrics_cap_releases);
 
 
 /*
@@ -470,6 +501,8 @@ void ceph_fs_debugfs_init(struct ceph_fs_client *fsc)
 			    &metrics_size_fops);
 	debugfs_create_file("caps", 0400, fsc->debugfs_metrics_dir, fsc,
 			    &metrics_caps_fops);
+	debugfs_create_file("cap_releases", 0400, fsc->debugfs_metrics_dir, fsc,
+			    &metrics_cap_releases_fops);
 	doutc(fsc->client, "done\n");
 }
 
@@ -2314,6 +2314,8 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 	struct ceph_osd_client *osdc = &mdsc->fsc->client->osdc;
 	struct ceph_cap *cap;
 	LIST_HEAD(tmp_list);
+	LIST_HEAD(done_list);
+	unsigned long queued;
 	int num_cap_releases;
 	__le32	barrier, *cap_barrier;
 
@@ -2326,8 +2328,13 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 	list_splice_init(&session->s_cap_releases, &tmp_list);
 	num_cap_releases = session->s_num_cap_releases;
 	session->s_num_cap_releases = 0;
+	queued = session->s_cap_release_queued;
 	spin_unlock(&session->s_cap_lock);
 
+	if (num_cap_releases)
+		session->s_cap_release_max_delay =
+			max(session->s_cap_release_max_delay, jiffies - queued);
+
 	while (!list_empty(&tmp_list)) {
 		if (!msg) {
 			msg = ceph_msg_new(CEPH_MSG_CLIENT_CAPRELEASE,
@@ -2344,7 +2351,7 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 
 		cap = list_first_entry(&tmp_list, struct ceph_cap,
 					session_caps);
-		list_del(&cap->session_caps);
+		list_move_tail(&cap->session_caps, &done_list);
 		num_cap_releases--;
 
 		head = msg->front.iov_base;
@@ -2357,8 +2364,6 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 		item->issue_seq = cpu_to_le32(cap->issue_seq);
 		msg->front.iov_len += sizeof(*item);
 
-		ceph_put_cap(mdsc, cap);
-
 		if (le32_to_cpu(head->num) == CEPH_CAPS_PER_RELEASE) {
 			// Append cap_barrier field
 			cap_barrier = msg->front.iov_base + msg->front.iov_len;
@@ -2369,6 +2374,9 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 			doutc(cl, "mds%d %p\n", session->s_mds, msg);
 			ceph_con_send(&session->s_con, msg);
 			msg = NULL;
+			session->s_cap_release_msgs++;
+			session->s_cap_release_caps += CEPH_CAPS_PER_RELEASE;
+			ceph_put_caps(mdsc, &done_list);
 		}
 	}
 
@@ -2387,7 +2395,10 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 
 		msg->hdr.front_len = cpu_to_le32(msg->front.iov_len);
 		doutc(cl, "mds%d %p\n", session->s_mds, msg);
+		session->s_cap_release_msgs++;
+		session->s_cap_release_caps += get_unaligned_le32(&head->num);
 		ceph_con_send(&session->s_con, msg);
+		ceph_put_caps(mdsc, &done_list);
 	}
 	return;
 out_err:
@@ -2396,6 +2407,7 @@ static void ceph_send_cap_releases(struct ceph_mds_client *mdsc,
 	spin_lock(&session->s_cap_lock);
 	list_splice(&tmp_list, &session->s_cap_releases);
 	session->s_num_cap_releases += num_cap_releases;
+	session->s_cap_release_queued = queued;
 	spin_unlock(&session->s_cap_lock);
 }
 
@@ -2435,6 +2447,8 @@ void ceph_flush_session_cap_releases(struct ceph_mds_client *mdsc,
 void __ceph_queue_cap_release(struct ceph_mds_session *session,
 			      struct ceph_cap *cap)
 {
+	if (!session->s_num_cap_releases)
+		session->s_cap_release_queued = jiffies;
 	list_add_tail(&cap->session_caps, &session->s_cap_releases);
 	session->s_num_cap_releases++;
 
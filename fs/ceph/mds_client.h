@@ -237,8 +237,14 @@ struct ceph_mds_session {
 	int		  s_cap_reconnect;
 	int		  s_readonly;
 	struct list_head  s_cap_releases; /* waiting cap_release messages */
+	unsigned long     s_cap_release_queued; /* when the oldest was queued */
 	struct work_struct s_cap_release_work;
 
+	/* cap release statistics, protected by s_mutex */
+	u64               s_cap_release_msgs;
+	u64               s_cap_release_caps;
+	unsigned long     s_cap_release_max_delay; /* in jiffies */
+
 	/* See ceph_inode_info->i_dirty_item. */
 	struct list_head  s_cap_dirty;	      /* inodes w/ dirty caps */
 
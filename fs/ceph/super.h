@@ -1228,6 +1228,8 @@ extern void ceph_remove_cap(struct ceph_mds_client *mdsc, struct ceph_cap *cap,
 extern void __ceph_remove_caps(struct ceph_inode_info *ci);
 extern void ceph_put_cap(struct ceph_mds_client *mdsc,
 			 struct ceph_cap *cap);
+extern void ceph_put_caps(struct ceph_mds_client *mdsc,
+			  struct list_head *caps);
 extern int ceph_is_any_caps(struct inode *inode);
 
 extern int ceph_write_inode(struct inode *inode, struct writeback_control *wbc);
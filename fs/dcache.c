@@ -88,6 +88,12 @@ EXPORT_SYMBOL(rename_lock);
 
 static struct kmem_cache *dentry_cache __ro_after_init;
 
+/*
+ * Batches the RCU-delayed frees of dentries without an external name, so
+ * that a dcache shrink costs one RCU callback per page of dentries.
+ */
+static struct kmem_rcu_arena *dentry_rcu_arena __ro_after_init;
+
 const struct qstr empty_name = QSTR_INIT("", 0);
 EXPORT_SYMBOL(empty_name);
 const struct qstr slash_name = QSTR_INIT("/", 1);
@@ -438,6 +444,8 @@ static void dentry_free(struct dentry *dentry)
 	/* if dentry was never visible to RCU, immediate free is OK */
 	if (dentry->d_flags & DCACHE_NORCU)
 		__d_free(&dentry->d_u.d_rcu);
+	else if (dentry_rcu_arena)
+		kmem_rcu_arena_free(dentry_rcu_arena, dentry, &dentry->d_u.d_rcu);
 	else
 		call_rcu(&dentry->d_u.d_rcu, __d_free);
 }
@@ -1921,6 +1929,7 @@ static void __d_instantiate(struct dentry *dentry, struct inode *inode)
 	raw_write_seqcount_end(&dentry->d_seq);
 	fsnotify_update_flags(dentry);
 	spin_unlock(&dentry->d_lock);
+	dir_bloom_add(dentry);
 }
 
 /**
@@ -2685,6 +2694,7 @@ static inline void __d_add(struct dentry *dentry, struct inode *inode)
 		__d_set_inode_and_type(dentry, inode, add_flags);
 		raw_write_seqcount_end(&dentry->d_seq);
 		fsnotify_update_flags(dentry);
+		dir_bloom_add(dentry);
 	}
 	__d_rehash(dentry);
 	if (dir)
@@ -2849,6 +2859,9 @@ static void __d_move(struct dentry *dentry, struct dentry *target,
 	__d_rehash(dentry);
 	fsnotify_update_flags(dentry);
 	fscrypt_handle_d_move(dentry);
+	dir_bloom_add(dentry);
+	if (exchange)
+		dir_bloom_add(target);
 
 	write_seqcount_end(&target->d_seq);
 	write_seqcount_end(&dentry->d_seq);
@@ -3193,6 +3206,7 @@ static void __init dcache_init(void)
 	dentry_cache = KMEM_CACHE_USERCOPY(dentry,
 		SLAB_RECLAIM_ACCOUNT|SLAB_PANIC|SLAB_ACCOUNT,
 		d_shortname.string);
+	dentry_rcu_arena = kmem_rcu_arena_create(dentry_cache);
 
 	/* Hash may have been set up in dcache_init_early */
 	if (!hashdist)
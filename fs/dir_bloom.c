@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Per-directory bloom filters of child names.
+ *
+ * The first lookup miss in an eligible directory reads the whole
+ * directory once and records the hash of every name in a bloom filter
+ * hung off the directory inode. Every name that later appears in the
+ * directory passes through d_instantiate(), d_add() or d_move(), which
+ * add it to the filter as well. From then on a lookup_fast() miss whose
+ * name is not in the filter is answered with -ENOENT without calling
+ * ->lookup() and without allocating a negative dentry.
+ *
+ * The filter is only correct if readdir lists every name ->lookup()
+ * can find and the dcache sees every new name, so it is restricted to
+ * block device backed filesystems without custom name hashing,
+ * comparison or revalidation.
+ */
+#include <linux/dcache.h>
+#include <linux/file.h>
+#include <linux/fs.h>
+#include <linux/hash.h>
+#include <linux/log2.h>
+#include <linux/rcupdate.h>
+#include <linux/slab.h>
+#include <linux/stringhash.h>
+#include <linux/sysctl.h>
+
+#include "internal.h"
+
+#define DIR_BLOOM_HASHES	3
+
+/* Filters are sized for at least this many entries... */
+#define DIR_BLOOM_MIN_ENTRIES	64U
+/* ...or one per this many bytes of directory size */
+#define DIR_BLOOM_ENTRY_BYTES	16
+
+/* The directory is not eligible, do not try again for this inode */
+#define DIR_BLOOM_NONE		((struct dir_bloom *)1UL)
+/* A filter is being read from the directory */
+#define DIR_BLOOM_BUILDING	((struct dir_bloom *)2UL)
+/* A name appeared while the filter was being read, discard the build */
+#define DIR_BLOOM_RACED		((struct dir_bloom *)3UL)
+
+struct dir_bloom {
+	struct rcu_head		rcu;
+	/* The parent dentry the name hashes are salted with */
+	const struct dentry	*salt;
+	unsigned int		shift;	/* log2 of the number of bits */
+	unsigned long		map[];
+};
+
+/* Whether @bloom is a published filter rather than one of the markers */
+static bool dir_bloom_live(const struct dir_bloom *bloom)
+{
+	return (unsigned long)bloom > (unsigned long)DIR_BLOOM_RACED;
+}
+
+/* Largest directory a filter is built for, 0 disables the filters */
+static unsigned int sysctl_dir_bloom_max_entries;
+static const unsigned int dir_bloom_entries_limit = 1U << 20;
+
+static const struct ctl_table fs_dir_bloom_sysctls[] = {
+	{
+		.procname	= "dir_bloom_max_entries",
+		.data		= &sysctl_dir_bloom_max_entries,
+		.maxlen		= sizeof(sysctl_dir_bloom_max_entries),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec_minmax,
+		.extra2		= (void *)&dir_bloom_entries_limit,
+	},
+};
+
+static int __init init_fs_dir_bloom_sysctls(void)
+{
+	register_sysctl_init("fs", fs_dir_bloom_sysctls);
+	return 0;
+}
+fs_initcall(init_fs_dir_bloom_sysctls);
+
+static bool dir_bloom_eligible(const struct dentry *dir)
+{
+	const struct inode *inode = d_inode(dir);
+
+	if (!(dir->d_sb->s_type->fs_flags & FS_REQUIRES_DEV))
+		return false;
+	if (dir->d_flags & (DCACHE_OP_HASH | DCACHE_OP_COMPARE |
+			    DCACHE_OP_REVALIDATE | DCACHE_OP_WEAK_REVALIDATE))
+		return false;
+	return !IS_CASEFOLDED(inode) && !IS_ENCRYPTED(inode);
+}
+
+static void dir_bloom_set(struct dir_bloom *bloom, u32 hash)
+{
+	u32 h2 = hash_32(hash, 32) | 1;
+	int i;
+
+	for (i = 0; i < DIR_BLOOM_HASHES; i++, hash += h2)
+		set_bit(hash & ((1U << bloom->shift) - 1), bloom->map);
+}
+
+static bool dir_bloom_test(const struct dir_bloom *bloom, u32 hash)
+{
+	u32 h2 = hash_32(hash, 32) | 1;
+	int i;
+
+	for (i = 0; i < DIR_BLOOM_HASHES; i++, hash += h2)
+		if (!test_bit(hash & ((1U << bloom->shift) - 1), bloom->map))
+			return false;
+	return true;
+}
+
+static void dir_bloom_drop(struct inode *dir)
+{
+	struct dir_bloom *bloom = xchg(&dir->i_dir_bloom, DIR_BLOOM_NONE);
+
+	if (dir_bloom_live(bloom))
+		kvfree_rcu(bloom, rcu);
+}
+
+/**
+ * dir_bloom_absent - check whether a name is known not to exist
+ * @dir: the directory dentry that was searched
+ * @name: the hashed name lookup_fast() did not find
+ *
+ * Return: true if @name certainly does not exist in @dir.
+ */
+bool dir_bloom_absent(const struct dentry *dir, const struct qstr *name)
+{
+	struct dir_bloom *bloom;
+	bool absent = false;
+
+	rcu_read_lock();
+	bloom = READ_ONCE(d_inode(dir)->i_dir_bloom);
+	if (dir_bloom_live(bloom) && bloom->salt == dir)
+		absent = !dir_bloom_test(bloom, name->hash);
+	rcu_read_unlock();
+
+	return absent;
+}
+
+/**
+ * dir_bloom_add - record a name that appeared in its parent directory
+ * @dentry: the dentry that was instantiated or moved
+ */
+void dir_bloom_add(struct dentry *dentry)
+{
+	struct dentry *parent = dentry->d_parent;
+	struct dir_bloom *bloom;
+
+	if (IS_ROOT(dentry) || !d_inode(parent))
+		return;
+
+	rcu_read_lock();
+	bloom = READ_ONCE(d_inode(parent)->i_dir_bloom);
+	if (bloom == DIR_BLOOM_BUILDING) {
+		/* readdir may already be past the name, invalidate the build */
+		cmpxchg(&d_inode(parent)->i_dir_bloom, DIR_BLOOM_BUILDING,
+			DIR_BLOOM_RACED);
+	} else if (dir_bloom_live(bloom)) {
+		/* A name added through another alias would be hashed differently */
+		if (unlikely(bloom->salt != parent))
+			dir_bloom_drop(d_inode(parent));
+		else
+			dir_bloom_set(bloom, dentry->d_name.hash);
+	}
+	rcu_read_unlock();
+}
+
+struct dir_bloom_ctx {
+	struct dir_context	ctx;
+	struct dir_bloom	*bloom;
+	unsigned int		nr;
+	unsigned int		max;
+};
+
+static bool dir_bloom_actor(struct dir_context *ctx, const char *name, int len,
+			    loff_t offset, u64 ino, unsigned int d_type)
+{
+	struct dir_bloom_ctx *bc = container_of(ctx, struct dir_bloom_ctx, ctx);
+
+	if (++bc->nr > bc->max)
+		return false;
+	dir_bloom_set(bc->bloom, full_name_hash(bc->bloom->salt, name, len));
+	return true;
+}
+
+/* About eight bits per name keeps false positives near 3% */
+static struct dir_bloom *dir_bloom_alloc(const struct dentry *salt,
+					 unsigned int nr)
+{
+	unsigned int shift = max_t(unsigned int, order_base_2(nr) + 3,
+				   ilog2(BITS_PER_LONG));
+	struct dir_bloom *bloom;
+
+	bloom = kvzalloc(struct_size(bloom, map, BIT(shift) / BITS_PER_LONG),
+			 GFP_KERNEL);
+	if (bloom) {
+		bloom->salt = salt;
+		bloom->shift = shift;
+	}
+	return bloom;
+}
+
+static int dir_bloom_read(const struct path *path, struct dir_bloom_ctx *bc)
+{
+	struct inode *inode = d_inode(path->dentry);
+	struct file *file;
+	int err = -ENOTDIR;
+
+	/* An internal readdir, don't report it to fsnotify watchers */
+	file = dentry_open_nonotify(path, O_RDONLY | O_DIRECTORY | O_NOATIME,
+				    current_cred());
+	if (IS_ERR(file))
+		return PTR_ERR(file);
+	if (file->f_op->iterate_shared) {
+		inode_lock_shared(inode);
+		err = -ENOENT;
+		if (!IS_DEADDIR(inode)) {
+			bc->nr = 0;
+			bc->ctx.pos = 0;
+			err = file->f_op->iterate_shared(file, &bc->ctx);
+		}
+		inode_unlock_shared(inode);
+	}
+	fput(file);
+	return err;
+}
+
+/**
+ * dir_bloom_build - build the filter of a directory after a lookup miss
+ * @path: the directory
+ *
+ * Called without locks held after ->lookup() returned a negative dentry.
+ * The filter is filled privately and only published once the whole
+ * directory has been read. Meanwhile the inode carries DIR_BLOOM_BUILDING,
+ * and a name appearing in the directory turns that into DIR_BLOOM_RACED so
+ * that the build, which may have missed it, is discarded.
+ *
+ * The filter is sized from the directory size, assuming at least
+ * DIR_BLOOM_ENTRY_BYTES per entry. If that guessed too few entries it is
+ * rebuilt once for the number actually read.
+ */
+void dir_bloom_build(const struct path *path)
+{
+	struct inode *inode = d_inode(path->dentry);
+	unsigned int max = READ_ONCE(sysctl_dir_bloom_max_entries);
+	struct dir_bloom_ctx bc = {
+		.ctx.actor	= dir_bloom_actor,
+		.max		= max,
+	};
+	struct dir_bloom *bloom;
+	unsigned int nr;
+	bool resized = false;
+
+	if (!max || READ_ONCE(inode->i_dir_bloom))
+		return;
+	if (!dir_bloom_eligible(path->dentry)) {
+		cmpxchg(&inode->i_dir_bloom, NULL, DIR_BLOOM_NONE);
+		return;
+	}
+	/* Someone else is building it, or it was dropped meanwhile */
+	if (cmpxchg(&inode->i_dir_bloom, NULL, DIR_BLOOM_BUILDING))
+		return;
+
+	nr = clamp_t(loff_t, i_size_read(inode) / DIR_BLOOM_ENTRY_BYTES,
+		     min(DIR_BLOOM_MIN_ENTRIES, max), max);
+	for (;;) {
+		bloom = dir_bloom_alloc(path->dentry, nr);
+		if (!bloom)
+			goto fail;
+		bc.bloom = bloom;
+		if (dir_bloom_read(path, &bc) || bc.nr > max)
+			goto fail;
+		if (resized || bc.nr <= BIT(bloom->shift - 3))
+			break;
+		kvfree(bloom);
+		resized = true;
+		nr = bc.nr;
+	}
+
+	/*
+	 * cmpxchg() is fully ordered, so like rcu_assign_pointer() it makes
+	 * the filled filter visible before the pointer to it. It fails if a
+	 * name appeared or the filter was dropped meanwhile.
+	 */
+	if (cmpxchg(&inode->i_dir_bloom, DIR_BLOOM_BUILDING, bloom) ==
+	    DIR_BLOOM_BUILDING)
+		return;
+	kvfree(bloom);
+	/* Let a later miss retry after a racing creation */
+	cmpxchg(&inode->i_dir_bloom, DIR_BLOOM_RACED, NULL);
+	return;
+fail:
+	kvfree(bloom);
+	cmpxchg(&inode->i_dir_bloom, DIR_BLOOM_BUILDING, DIR_BLOOM_NONE);
+	cmpxchg(&inode->i_dir_bloom, DIR_BLOOM_RACED, DIR_BLOOM_NONE);
+}
+
+void dir_bloom_free(struct inode *inode)
+{
+	struct dir_bloom *bloom = inode->i_dir_bloom;
+
+	if (dir_bloom_live(bloom))
+		kvfree_rcu(bloom, rcu);
+	inode->i_dir_bloom = NULL;
+}
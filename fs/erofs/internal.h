@@ -63,6 +63,8 @@ struct erofs_mount_opts {
 	unsigned int sync_decompress;
 	/* threshold for decompression synchronously */
 	unsigned int max_sync_decompress_pages;
+	/* max workers a background decompression batch is spread across */
+	unsigned int decompress_workers;
 	unsigned int mount_opt;
 };
 
@@ -123,6 +125,9 @@ struct erofs_sb_info {
 	struct inode *managed_cache;
 
 	struct erofs_sb_lz4_info lz4;
+
+	/* highest number of workers one decompression batch was split into */
+	unsigned int decompress_parallelism;
 #endif	/* CONFIG_EROFS_FS_ZIP */
 	struct inode *packed_inode;
 	struct erofs_dev_context *devs;
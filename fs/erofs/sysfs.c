@@ -60,6 +60,8 @@ static struct erofs_attr erofs_attr_##_name = {			\
 
 #ifdef CONFIG_EROFS_FS_ZIP
 EROFS_ATTR_RW_UI(sync_decompress, erofs_mount_opts);
+EROFS_ATTR_RW_UI(decompress_workers, erofs_mount_opts);
+EROFS_RO_ATTR(decompress_parallelism, pointer_ui, erofs_sb_info);
 EROFS_ATTR_FUNC(drop_caches, 0200);
 #endif
 #ifdef CONFIG_EROFS_FS_ZIP_ACCEL
@@ -69,6 +71,8 @@ EROFS_ATTR_FUNC(accel, 0644);
 static struct attribute *erofs_sb_attrs[] = {
 #ifdef CONFIG_EROFS_FS_ZIP
 	ATTR_LIST(sync_decompress),
+	ATTR_LIST(decompress_workers),
+	ATTR_LIST(decompress_parallelism),
 	ATTR_LIST(drop_caches),
 #endif
 	NULL,
@@ -1411,10 +1411,8 @@ static int z_erofs_decompress_queue(const struct z_erofs_decompressqueue *io,
 	return err;
 }
 
-static void z_erofs_decompressqueue_work(struct work_struct *work)
+static void z_erofs_decompress_bgq(struct z_erofs_decompressqueue *bgq)
 {
-	struct z_erofs_decompressqueue *bgq =
-		container_of(work, struct z_erofs_decompressqueue, u.work);
 	struct page *pagepool = NULL;
 
 	DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_TAIL);
@@ -1423,6 +1421,76 @@ static void z_erofs_decompressqueue_work(struct work_struct *work)
 	kvfree(bgq);
 }
 
+static void z_erofs_decompress_split_work(struct work_struct *work)
+{
+	z_erofs_decompress_bgq(container_of(work,
+			struct z_erofs_decompressqueue, u.work));
+}
+
+/* minimum number of pclusters handed to each extra decompression worker */
+#define Z_EROFS_SPLIT_MIN_PCLUSTERS	4
+#define Z_EROFS_MAX_DECOMPRESS_WORKERS	16
+
+/*
+ * Pclusters of a queue are independent of each other, so a large readahead
+ * batch is cut into up to `decompress_workers' chains and all but the first
+ * are handed to the unbound workqueue, which runs them on other CPUs of the
+ * local node while the current context decompresses the first chain.
+ */
+static void z_erofs_split_decompress_queue(struct z_erofs_decompressqueue *io)
+{
+	struct erofs_sb_info *const sbi = EROFS_SB(io->sb);
+	struct z_erofs_pcluster *cut[Z_EROFS_MAX_DECOMPRESS_WORKERS];
+	unsigned int nr = 0, parts, per_part, queued = 0, i;
+	struct z_erofs_pcluster *pcl;
+
+	for (pcl = io->head; pcl != Z_EROFS_PCLUSTER_TAIL; pcl = pcl->next)
+		++nr;
+
+	parts = min3(READ_ONCE(sbi->opt.decompress_workers),
+		     nr / Z_EROFS_SPLIT_MIN_PCLUSTERS, num_online_cpus());
+	parts = min(parts, Z_EROFS_MAX_DECOMPRESS_WORKERS);
+	if (parts <= 1)
+		return;
+	per_part = DIV_ROUND_UP(nr, parts);
+
+	/* find the last pcluster of every chain but the final one */
+	parts = 0;
+	pcl = io->head;
+	for (i = 1; i < nr; i++, pcl = pcl->next)
+		if (!(i % per_part))
+			cut[parts++] = pcl;
+
+	/* queue from the end so that no queued chain is cut afterwards */
+	for (i = parts; i; i--) {
+		struct z_erofs_decompressqueue *q;
+
+		q = kvzalloc(sizeof(*q), GFP_NOIO | __GFP_NOWARN);
+		if (!q)
+			continue;
+		q->sb = io->sb;
+		q->eio = io->eio;
+		q->head = cut[i - 1]->next;
+		INIT_WORK(&q->u.work, z_erofs_decompress_split_work);
+		WRITE_ONCE(cut[i - 1]->next, Z_EROFS_PCLUSTER_TAIL);
+		queue_work(z_erofs_workqueue, &q->u.work);
+		++queued;
+	}
+
+	if (queued + 1 > READ_ONCE(sbi->decompress_parallelism))
+		WRITE_ONCE(sbi->decompress_parallelism, queued + 1);
+}
+
+static void z_erofs_decompressqueue_work(struct work_struct *work)
+{
+	struct z_erofs_decompressqueue *bgq =
+		container_of(work, struct z_erofs_decompressqueue, u.work);
+
+	DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_TAIL);
+	z_erofs_split_decompress_queue(bgq);
+	z_erofs_decompress_bgq(bgq);
+}
+
 #ifdef CONFIG_EROFS_FS_PCPU_KTHREAD
 static void z_erofs_decompressqueue_kthread_work(struct kthread_work *work)
 {
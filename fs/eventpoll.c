@@ -80,6 +80,15 @@
  * Events that require holding "epnested_mutex" are very rare, while for
  * normal operations the epoll private "ep->mtx" will guarantee
  * a better scalability.
+ *
+ * An epoll fd created with EPOLL_SHARDED splits the ready list, together
+ * with its lock and ovflist, into one shard per CPU (up to EP_MAX_SHARDS).
+ * Each item is queued on its home shard only, and the event transfer loop
+ * of a shard runs under the shard mutex instead of ep->mtx, so waiters
+ * harvesting different shards do not serialise. Removal and modification
+ * of an item additionally take the shard mutex of the item, nested inside
+ * ep->mtx. Waiters are queued under ep->wq.lock in that mode, not under a
+ * ready list lock, and the wakeup side uses wq_has_sleeper().
  */
 
 /* Epoll private bits inside the event mask */
@@ -99,6 +108,9 @@
 
 #define EP_ITEM_COST (sizeof(struct epitem) + sizeof(struct eppoll_entry))
 
+/* Maximum number of ready list shards of an EPOLL_SHARDED instance */
+#define EP_MAX_SHARDS 64
+
 struct epoll_filefd {
 	struct file *file;
 	int fd;
@@ -155,6 +167,9 @@ struct epitem {
 	 */
 	bool dying;
 
+	/* Index of the ready list shard this item is queued on */
+	u8 shard;
+
 	/* List containing poll wait queues */
 	struct eppoll_entry *pwqlist;
 
@@ -171,6 +186,25 @@ struct epitem {
 	struct epoll_event event;
 };
 
+/* A ready list, there is one per eventpoll unless it is sharded */
+struct ep_shard {
+	/* Serialises the event transfer loops of a sharded eventpoll */
+	struct mutex mtx;
+
+	/* Lock which protects rdllist and ovflist */
+	rwlock_t lock;
+
+	/* List of ready file descriptors */
+	struct list_head rdllist;
+
+	/*
+	 * This is a single linked list that chains all the "struct epitem" that
+	 * happened while transferring ready events to userspace w/out
+	 * holding ->lock.
+	 */
+	struct epitem *ovflist;
+} ____cacheline_aligned_in_smp;
+
 /*
  * This structure is stored inside the "private_data" member of the file
  * structure and represents the main data structure for the eventpoll
@@ -191,21 +225,12 @@ struct eventpoll {
 	/* Wait queue used by file->poll() */
 	wait_queue_head_t poll_wait;
 
-	/* List of ready file descriptors */
-	struct list_head rdllist;
-
-	/* Lock which protects rdllist and ovflist */
-	rwlock_t lock;
-
 	/* RB tree root used to store monitored fd structs */
 	struct rb_root_cached rbr;
 
-	/*
-	 * This is a single linked list that chains all the "struct epitem" that
-	 * happened while transferring ready events to userspace w/out
-	 * holding ->lock.
-	 */
-	struct epitem *ovflist;
+	/* Ready list shards, points to shard0 unless created with EPOLL_SHARDED */
+	struct ep_shard *shards;
+	unsigned int nr_shards;
 
 	/* wakeup_source used when ep_send_events or __ep_eventpoll_poll is running */
 	struct wakeup_source *ws;
@@ -239,6 +264,8 @@ struct eventpoll {
 	/* tracks wakeup nests for lockdep validation */
 	u8 nests;
 #endif
+
+	struct ep_shard shard0;
 };
 
 /* Wrapper struct used by poll queueing */
@@ -378,6 +405,73 @@ static inline struct epitem *ep_item_from_wait(wait_queue_entry_t *p)
 	return container_of(p, struct eppoll_entry, wait)->base;
 }
 
+static inline bool ep_sharded(struct eventpoll *ep)
+{
+	return ep->nr_shards > 1;
+}
+
+static inline struct ep_shard *ep_item_shard(const struct epitem *epi)
+{
+	return &epi->ep->shards[epi->shard];
+}
+
+static inline bool ep_shard_events_available(struct ep_shard *sh)
+{
+	return !list_empty_careful(&sh->rdllist) ||
+		READ_ONCE(sh->ovflist) != EP_UNACTIVE_PTR;
+}
+
+/*
+ * Waiters of a sharded eventpoll are not serialised against the ready
+ * list lock, pair with the barrier in ep_poll() instead.
+ */
+static inline bool ep_has_waiters(struct eventpoll *ep)
+{
+	if (ep_sharded(ep))
+		return wq_has_sleeper(&ep->wq);
+	return waitqueue_active(&ep->wq);
+}
+
+/* The mutex held across the event transfer loop of @sh */
+static inline struct mutex *ep_scan_mutex(struct eventpoll *ep,
+					  struct ep_shard *sh)
+{
+	return ep_sharded(ep) ? &sh->mtx : &ep->mtx;
+}
+
+/*
+ * Excludes the event transfer loop of the shard of @epi, which does not
+ * hold ep->mtx on a sharded eventpoll. Called with ep->mtx held.
+ */
+static inline void ep_item_lock(struct eventpoll *ep, struct epitem *epi)
+{
+	if (ep_sharded(ep))
+		mutex_lock(&ep_item_shard(epi)->mtx);
+}
+
+static inline void ep_item_unlock(struct eventpoll *ep, struct epitem *epi)
+{
+	if (ep_sharded(ep))
+		mutex_unlock(&ep_item_shard(epi)->mtx);
+}
+
+/* The lock ep_poll() waiters are added to and removed from ep->wq under */
+static inline void ep_wait_lock_irq(struct eventpoll *ep)
+{
+	if (ep_sharded(ep))
+		spin_lock_irq(&ep->wq.lock);
+	else
+		write_lock_irq(&ep->shard0.lock);
+}
+
+static inline void ep_wait_unlock_irq(struct eventpoll *ep)
+{
+	if (ep_sharded(ep))
+		spin_unlock_irq(&ep->wq.lock);
+	else
+		write_unlock_irq(&ep->shard0.lock);
+}
+
 /**
  * ep_events_available - Checks if ready events might be available.
  *
@@ -388,8 +482,13 @@ static inline struct epitem *ep_item_from_wait(wait_queue_entry_t *p)
  */
 static inline int ep_events_available(struct eventpoll *ep)
 {
-	return !list_empty_careful(&ep->rdllist) ||
-		READ_ONCE(ep->ovflist) != EP_UNACTIVE_PTR;
+	unsigned int i;
+
+	for (i = 0; i < ep->nr_shards; i++) {
+		if (ep_shard_events_available(&ep->shards[i]))
+			return 1;
+	}
+	return 0;
 }
 
 #ifdef CONFIG_NET_RX_BUSY_POLL
@@ -692,10 +791,11 @@ static void ep_unregister_pollwait(struct eventpoll *ep, struct epitem *epi)
 	}
 }
 
-/* call only when ep->mtx is held */
+/* call only when ep->mtx, or the shard mutex of a sharded ep, is held */
 static inline struct wakeup_source *ep_wakeup_source(struct epitem *epi)
 {
-	return rcu_dereference_check(epi->ws, lockdep_is_held(&epi->ep->mtx));
+	return rcu_dereference_check(epi->ws, lockdep_is_held(&epi->ep->mtx) ||
+				     lockdep_is_held(&ep_item_shard(epi)->mtx));
 }
 
 /* call only when ep->mtx is held */
@@ -726,38 +826,38 @@ static inline void ep_pm_stay_awake_rcu(struct epitem *epi)
 
 
 /*
- * ep->mutex needs to be held because we could be hit by
- * eventpoll_release_file() and epoll_ctl().
+ * ep->mutex (the shard mutex for a sharded ep) needs to be held because
+ * we could be hit by eventpoll_release_file() and epoll_ctl().
  */
-static void ep_start_scan(struct eventpoll *ep, struct list_head *txlist)
+static void ep_start_scan(struct ep_shard *sh, struct list_head *txlist)
 {
 	/*
 	 * Steal the ready list, and re-init the original one to the
-	 * empty list. Also, set ep->ovflist to NULL so that events
+	 * empty list. Also, set sh->ovflist to NULL so that events
 	 * happening while looping w/out locks, are not lost. We cannot
-	 * have the poll callback to queue directly on ep->rdllist,
+	 * have the poll callback to queue directly on sh->rdllist,
 	 * because we want the "sproc" callback to be able to do it
 	 * in a lockless way.
 	 */
 	lockdep_assert_irqs_enabled();
-	write_lock_irq(&ep->lock);
-	list_splice_init(&ep->rdllist, txlist);
-	WRITE_ONCE(ep->ovflist, NULL);
-	write_unlock_irq(&ep->lock);
+	write_lock_irq(&sh->lock);
+	list_splice_init(&sh->rdllist, txlist);
+	WRITE_ONCE(sh->ovflist, NULL);
+	write_unlock_irq(&sh->lock);
 }
 
-static void ep_done_scan(struct eventpoll *ep,
+static void ep_done_scan(struct eventpoll *ep, struct ep_shard *sh,
 			 struct list_head *txlist)
 {
 	struct epitem *epi, *nepi;
 
-	write_lock_irq(&ep->lock);
+	write_lock_irq(&sh->lock);
 	/*
 	 * During the time we spent inside the "sproc" callback, some
 	 * other events might have been queued by the poll callback.
 	 * We re-insert them inside the main ready-list here.
 	 */
-	for (nepi = READ_ONCE(ep->ovflist); (epi = nepi) != NULL;
+	for (nepi = READ_ONCE(sh->ovflist); (epi = nepi) != NULL;
 	     nepi = epi->next, epi->next = EP_UNACTIVE_PTR) {
 		/*
 		 * We need to check if the item is already in the list.
@@ -770,29 +870,29 @@ static void ep_done_scan(struct eventpoll *ep,
 			 * ->ovflist is LIFO, so we have to reverse it in order
 			 * to keep in FIFO.
 			 */
-			list_add(&epi->rdllink, &ep->rdllist);
+			list_add(&epi->rdllink, &sh->rdllist);
 			ep_pm_stay_awake(epi);
 		}
 	}
 	/*
-	 * We need to set back ep->ovflist to EP_UNACTIVE_PTR, so that after
+	 * We need to set back sh->ovflist to EP_UNACTIVE_PTR, so that after
 	 * releasing the lock, events will be queued in the normal way inside
-	 * ep->rdllist.
+	 * sh->rdllist.
 	 */
-	WRITE_ONCE(ep->ovflist, EP_UNACTIVE_PTR);
+	WRITE_ONCE(sh->ovflist, EP_UNACTIVE_PTR);
 
 	/*
 	 * Quickly re-inject items left on "txlist".
 	 */
-	list_splice(txlist, &ep->rdllist);
+	list_splice(txlist, &sh->rdllist);
 	__pm_relax(ep->ws);
 
-	if (!list_empty(&ep->rdllist)) {
-		if (waitqueue_active(&ep->wq))
+	if (!list_empty(&sh->rdllist)) {
+		if (ep_has_waiters(ep))
 			wake_up(&ep->wq);
 	}
 
-	write_unlock_irq(&ep->lock);
+	write_unlock_irq(&sh->lock);
 }
 
 static void ep_get(struct eventpoll *ep)
@@ -814,8 +914,14 @@ static bool ep_refcount_dec_and_test(struct eventpoll *ep)
 
 static void ep_free(struct eventpoll *ep)
 {
+	unsigned int i;
+
 	ep_resume_napi_irqs(ep);
 	mutex_destroy(&ep->mtx);
+	for (i = 0; i < ep->nr_shards; i++)
+		mutex_destroy(&ep->shards[i].mtx);
+	if (ep->shards != &ep->shard0)
+		kfree(ep->shards);
 	free_uid(ep->user);
 	wakeup_source_unregister(ep->ws);
 	kfree(ep);
@@ -832,11 +938,14 @@ static void ep_free(struct eventpoll *ep)
 static bool __ep_remove(struct eventpoll *ep, struct epitem *epi, bool force)
 {
 	struct file *file = epi->ffd.file;
+	struct ep_shard *sh = ep_item_shard(epi);
 	struct epitems_head *to_free;
 	struct hlist_head *head;
 
 	lockdep_assert_irqs_enabled();
 
+	ep_item_lock(ep, epi);
+
 	/*
 	 * Removes poll wait queue hooks.
 	 */
@@ -846,6 +955,7 @@ static bool __ep_remove(struct eventpoll *ep, struct epitem *epi, bool force)
 	spin_lock(&file->f_lock);
 	if (epi->dying && !force) {
 		spin_unlock(&file->f_lock);
+		ep_item_unlock(ep, epi);
 		return false;
 	}
 
@@ -867,12 +977,13 @@ static bool __ep_remove(struct eventpoll *ep, struct epitem *epi, bool force)
 
 	rb_erase_cached(&epi->rbn, &ep->rbr);
 
-	write_lock_irq(&ep->lock);
+	write_lock_irq(&sh->lock);
 	if (ep_is_linked(epi))
 		list_del_init(&epi->rdllink);
-	write_unlock_irq(&ep->lock);
+	write_unlock_irq(&sh->lock);
 
 	wakeup_source_unregister(ep_wakeup_source(epi));
+	ep_item_unlock(ep, epi);
 	/*
 	 * At this point it is safe to free the eventpoll item. Use the union
 	 * field epi->rcu, since we are trying to minimize the size of
@@ -969,9 +1080,9 @@ static int ep_eventpoll_release(struct inode *inode, struct file *file)
 
 static __poll_t ep_item_poll(const struct epitem *epi, poll_table *pt, int depth);
 
-static __poll_t __ep_eventpoll_poll(struct file *file, poll_table *wait, int depth)
+static __poll_t ep_shard_poll(struct eventpoll *ep, struct ep_shard *sh,
+			      int depth)
 {
-	struct eventpoll *ep = file->private_data;
 	LIST_HEAD(txlist);
 	struct epitem *epi, *tmp;
 	poll_table pt;
@@ -979,15 +1090,8 @@ static __poll_t __ep_eventpoll_poll(struct file *file, poll_table *wait, int dep
 
 	init_poll_funcptr(&pt, NULL);
 
-	/* Insert inside our poll wait queue */
-	poll_wait(file, &ep->poll_wait, wait);
-
-	/*
-	 * Proceed to find out if wanted events are really available inside
-	 * the ready list.
-	 */
-	mutex_lock_nested(&ep->mtx, depth);
-	ep_start_scan(ep, &txlist);
+	mutex_lock_nested(ep_scan_mutex(ep, sh), depth);
+	ep_start_scan(sh, &txlist);
 	list_for_each_entry_safe(epi, tmp, &txlist, rdllink) {
 		if (ep_item_poll(epi, &pt, depth + 1)) {
 			res = EPOLLIN | EPOLLRDNORM;
@@ -1002,8 +1106,27 @@ static __poll_t __ep_eventpoll_poll(struct file *file, poll_table *wait, int dep
 			list_del_init(&epi->rdllink);
 		}
 	}
-	ep_done_scan(ep, &txlist);
-	mutex_unlock(&ep->mtx);
+	ep_done_scan(ep, sh, &txlist);
+	mutex_unlock(ep_scan_mutex(ep, sh));
+	return res;
+}
+
+static __poll_t __ep_eventpoll_poll(struct file *file, poll_table *wait, int depth)
+{
+	struct eventpoll *ep = file->private_data;
+	__poll_t res = 0;
+	unsigned int i;
+
+	/* Insert inside our poll wait queue */
+	poll_wait(file, &ep->poll_wait, wait);
+
+	/*
+	 * Proceed to find out if wanted events are really available inside
+	 * the ready lists.
+	 */
+	for (i = 0; i < ep->nr_shards && !res; i++)
+		res = ep_shard_poll(ep, &ep->shards[i], depth);
+
 	return res;
 }
 
@@ -1015,7 +1138,8 @@ static __poll_t __ep_eventpoll_poll(struct file *file, poll_table *wait, int dep
  * been free'd and then gotten re-allocated to something else (since
  * files are not RCU-delayed, they are SLAB_TYPESAFE_BY_RCU).
  *
- * But for epoll, users hold the ep->mtx mutex, and as such any file in
+ * But for epoll, users hold the ep->mtx mutex (or, for a sharded ep, the
+ * shard mutex which __ep_remove() also takes), and as such any file in
  * the process of being free'd will block in eventpoll_release_file()
  * and thus the underlying file allocation will not be free'd, and the
  * file re-use cannot happen.
@@ -1142,21 +1266,41 @@ void eventpoll_release_file(struct file *file)
 	spin_unlock(&file->f_lock);
 }
 
-static int ep_alloc(struct eventpoll **pep)
+static void ep_shard_init(struct ep_shard *sh)
 {
+	mutex_init(&sh->mtx);
+	rwlock_init(&sh->lock);
+	INIT_LIST_HEAD(&sh->rdllist);
+	sh->ovflist = EP_UNACTIVE_PTR;
+}
+
+static int ep_alloc(struct eventpoll **pep, bool sharded)
+{
+	unsigned int i, nr = sharded ? min(nr_cpu_ids, EP_MAX_SHARDS) : 1;
 	struct eventpoll *ep;
 
 	ep = kzalloc(sizeof(*ep), GFP_KERNEL);
 	if (unlikely(!ep))
 		return -ENOMEM;
 
+	ep->shards = &ep->shard0;
+	if (nr > 1) {
+		ep->shards = kcalloc(nr, sizeof(*ep->shards), GFP_KERNEL);
+		if (unlikely(!ep->shards)) {
+			kfree(ep);
+			return -ENOMEM;
+		}
+	} else {
+		nr = 1;
+	}
+	ep->nr_shards = nr;
+	for (i = 0; i < nr; i++)
+		ep_shard_init(&ep->shards[i]);
+
 	mutex_init(&ep->mtx);
-	rwlock_init(&ep->lock);
 	init_waitqueue_head(&ep->wq);
 	init_waitqueue_head(&ep->poll_wait);
-	INIT_LIST_HEAD(&ep->rdllist);
 	ep->rbr = RB_ROOT_CACHED;
-	ep->ovflist = EP_UNACTIVE_PTR;
 	ep->user = get_current_user();
 	refcount_set(&ep->refcount, 1);
 
@@ -1292,14 +1436,14 @@ static inline bool list_add_tail_lockless(struct list_head *new,
 }
 
 /*
- * Chains a new epi entry to the tail of the ep->ovflist in a lockless way,
+ * Chains a new epi entry to the tail of the sh->ovflist in a lockless way,
  * i.e. multiple CPUs are allowed to call this function concurrently.
  *
  * Return: %false if epi element has been already chained, %true otherwise.
  */
 static inline bool chain_epi_lockless(struct epitem *epi)
 {
-	struct eventpoll *ep = epi->ep;
+	struct ep_shard *sh = ep_item_shard(epi);
 
 	/* Fast preliminary check */
 	if (epi->next != EP_UNACTIVE_PTR)
@@ -1310,7 +1454,7 @@ static inline bool chain_epi_lockless(struct epitem *epi)
 		return false;
 
 	/* Atomically exchange tail */
-	epi->next = xchg(&ep->ovflist, epi);
+	epi->next = xchg(&sh->ovflist, epi);
 
 	return true;
 }
@@ -1324,7 +1468,9 @@ static inline bool chain_epi_lockless(struct epitem *epi)
  * events from another file descriptor, thus all modifications to ->rdllist
  * or ->ovflist are lockless.  Read lock is paired with the write lock from
  * ep_start/done_scan(), which stops all list modifications and guarantees
- * that lists state is seen correctly.
+ * that lists state is seen correctly.  Only the lock of the home shard of
+ * @epi is taken, so callbacks for items on different shards of a sharded
+ * eventpoll do not even share a cache line.
  *
  * Another thing worth to mention is that ep_poll_callback() can be called
  * concurrently for the same @epi from different CPUs if poll table was inited
@@ -1338,11 +1484,12 @@ static int ep_poll_callback(wait_queue_entry_t *wait, unsigned mode, int sync, v
 	int pwake = 0;
 	struct epitem *epi = ep_item_from_wait(wait);
 	struct eventpoll *ep = epi->ep;
+	struct ep_shard *sh = ep_item_shard(epi);
 	__poll_t pollflags = key_to_poll(key);
 	unsigned long flags;
 	int ewake = 0;
 
-	read_lock_irqsave(&ep->lock, flags);
+	read_lock_irqsave(&sh->lock, flags);
 
 	ep_set_busy_poll_napi_id(epi);
 
@@ -1368,14 +1515,14 @@ static int ep_poll_callback(wait_queue_entry_t *wait, unsigned mode, int sync, v
 	 * If we are transferring events to userspace, we can hold no locks
 	 * (because we're accessing user memory, and because of linux f_op->poll()
 	 * semantics). All the events that happen during that period of time are
-	 * chained in ep->ovflist and requeued later on.
+	 * chained in sh->ovflist and requeued later on.
 	 */
-	if (READ_ONCE(ep->ovflist) != EP_UNACTIVE_PTR) {
+	if (READ_ONCE(sh->ovflist) != EP_UNACTIVE_PTR) {
 		if (chain_epi_lockless(epi))
 			ep_pm_stay_awake_rcu(epi);
 	} else if (!ep_is_linked(epi)) {
 		/* In the usual case, add event to ready list. */
-		if (list_add_tail_lockless(&epi->rdllink, &ep->rdllist))
+		if (list_add_tail_lockless(&epi->rdllink, &sh->rdllist))
 			ep_pm_stay_awake_rcu(epi);
 	}
 
@@ -1383,7 +1530,7 @@ static int ep_poll_callback(wait_queue_entry_t *wait, unsigned mode, int sync, v
 	 * Wake up ( if active ) both the eventpoll wait list and the ->poll()
 	 * wait list.
 	 */
-	if (waitqueue_active(&ep->wq)) {
+	if (ep_has_waiters(ep)) {
 		if ((epi->event.events & EPOLLEXCLUSIVE) &&
 					!(pollflags & POLLFREE)) {
 			switch (pollflags & EPOLLINOUT_BITS) {
@@ -1409,7 +1556,7 @@ static int ep_poll_callback(wait_queue_entry_t *wait, unsigned mode, int sync, v
 		pwake++;
 
 out_unlock:
-	read_unlock_irqrestore(&ep->lock, flags);
+	read_unlock_irqrestore(&sh->lock, flags);
 
 	/* We have to call this outside the lock */
 	if (pwake)
@@ -1677,6 +1824,8 @@ static int ep_insert(struct eventpoll *ep, const struct epoll_event *event,
 	ep_set_ffd(&epi->ffd, tfile, fd);
 	epi->event = *event;
 	epi->next = EP_UNACTIVE_PTR;
+	/* Queue events on the shard of the inserting CPU */
+	epi->shard = raw_smp_processor_id() % ep->nr_shards;
 
 	if (tep)
 		mutex_lock_nested(&tep->mtx, 1);
@@ -1744,24 +1893,26 @@ static int ep_insert(struct eventpoll *ep, const struct epoll_event *event,
 	}
 
 	/* We have to drop the new item inside our item list to keep track of it */
-	write_lock_irq(&ep->lock);
+	ep_item_lock(ep, epi);
+	write_lock_irq(&ep_item_shard(epi)->lock);
 
 	/* record NAPI ID of new item if present */
 	ep_set_busy_poll_napi_id(epi);
 
 	/* If the file is already "ready" we drop it inside the ready list */
 	if (revents && !ep_is_linked(epi)) {
-		list_add_tail(&epi->rdllink, &ep->rdllist);
+		list_add_tail(&epi->rdllink, &ep_item_shard(epi)->rdllist);
 		ep_pm_stay_awake(epi);
 
 		/* Notify waiting tasks that events are available */
-		if (waitqueue_active(&ep->wq))
+		if (ep_has_waiters(ep))
 			wake_up(&ep->wq);
 		if (waitqueue_active(&ep->poll_wait))
 			pwake++;
 	}
 
-	write_unlock_irq(&ep->lock);
+	write_unlock_irq(&ep_item_shard(epi)->lock);
+	ep_item_unlock(ep, epi);
 
 	/* We have to call this outside the lock */
 	if (pwake)
@@ -1777,6 +1928,7 @@ static int ep_insert(struct eventpoll *ep, const struct epoll_event *event,
 static int ep_modify(struct eventpoll *ep, struct epitem *epi,
 		     const struct epoll_event *event)
 {
+	struct ep_shard *sh = ep_item_shard(epi);
 	int pwake = 0;
 	poll_table pt;
 
@@ -1784,6 +1936,8 @@ static int ep_modify(struct eventpoll *ep, struct epitem *epi,
 
 	init_poll_funcptr(&pt, NULL);
 
+	ep_item_lock(ep, epi);
+
 	/*
 	 * Set the new event interest mask before calling f_op->poll();
 	 * otherwise we might miss an event that happens between the
@@ -1825,19 +1979,20 @@ static int ep_modify(struct eventpoll *ep, struct epitem *epi,
 	 * list, push it inside.
 	 */
 	if (ep_item_poll(epi, &pt, 1)) {
-		write_lock_irq(&ep->lock);
+		write_lock_irq(&sh->lock);
 		if (!ep_is_linked(epi)) {
-			list_add_tail(&epi->rdllink, &ep->rdllist);
+			list_add_tail(&epi->rdllink, &sh->rdllist);
 			ep_pm_stay_awake(epi);
 
 			/* Notify waiting tasks that events are available */
-			if (waitqueue_active(&ep->wq))
+			if (ep_has_waiters(ep))
 				wake_up(&ep->wq);
 			if (waitqueue_active(&ep->poll_wait))
 				pwake++;
 		}
-		write_unlock_irq(&ep->lock);
+		write_unlock_irq(&sh->lock);
 	}
+	ep_item_unlock(ep, epi);
 
 	/* We have to call this outside the lock */
 	if (pwake)
@@ -1846,30 +2001,23 @@ static int ep_modify(struct eventpoll *ep, struct epitem *epi,
 	return 0;
 }
 
-static int ep_send_events(struct eventpoll *ep,
-			  struct epoll_event __user *events, int maxevents)
+static int ep_send_shard_events(struct eventpoll *ep, struct ep_shard *sh,
+				struct epoll_event __user *events, int maxevents)
 {
 	struct epitem *epi, *tmp;
 	LIST_HEAD(txlist);
 	poll_table pt;
 	int res = 0;
 
-	/*
-	 * Always short-circuit for fatal signals to allow threads to make a
-	 * timely exit without the chance of finding more events available and
-	 * fetching repeatedly.
-	 */
-	if (fatal_signal_pending(current))
-		return -EINTR;
-
 	init_poll_funcptr(&pt, NULL);
 
-	mutex_lock(&ep->mtx);
-	ep_start_scan(ep, &txlist);
+	mutex_lock(ep_scan_mutex(ep, sh));
+	ep_start_scan(sh, &txlist);
 
 	/*
 	 * We can loop without lock because we are passed a task private list.
-	 * Items cannot vanish during the loop we are holding ep->mtx.
+	 * Items cannot vanish during the loop we are holding ep->mtx (or the
+	 * shard mutex, which removal takes as well).
 	 */
 	list_for_each_entry_safe(epi, tmp, &txlist, rdllink) {
 		struct wakeup_source *ws;
@@ -1923,17 +2071,57 @@ static int ep_send_events(struct eventpoll *ep,
 			 * the ready list, so that the next call to
 			 * epoll_wait() will check again the events
 			 * availability. At this point, no one can insert
-			 * into ep->rdllist besides us. The epoll_ctl()
+			 * into sh->rdllist besides us. The epoll_ctl()
 			 * callers are locked out by
 			 * ep_send_events() holding "mtx" and the
-			 * poll callback will queue them in ep->ovflist.
+			 * poll callback will queue them in sh->ovflist.
 			 */
-			list_add_tail(&epi->rdllink, &ep->rdllist);
+			list_add_tail(&epi->rdllink, &sh->rdllist);
 			ep_pm_stay_awake(epi);
 		}
 	}
-	ep_done_scan(ep, &txlist);
-	mutex_unlock(&ep->mtx);
+	ep_done_scan(ep, sh, &txlist);
+	mutex_unlock(ep_scan_mutex(ep, sh));
+
+	return res;
+}
+
+static int ep_send_events(struct eventpoll *ep,
+			  struct epoll_event __user *events, int maxevents)
+{
+	unsigned int i, start;
+	struct ep_shard *sh;
+	int res = 0, n;
+
+	/*
+	 * Always short-circuit for fatal signals to allow threads to make a
+	 * timely exit without the chance of finding more events available and
+	 * fetching repeatedly.
+	 */
+	if (fatal_signal_pending(current))
+		return -EINTR;
+
+	if (!ep_sharded(ep))
+		return ep_send_shard_events(ep, &ep->shard0, events, maxevents);
+
+	/*
+	 * Harvest the shard of the local CPU first, the items queued there
+	 * were mostly added and are mostly signalled from this CPU.
+	 */
+	start = raw_smp_processor_id() % ep->nr_shards;
+	for (i = 0; i < ep->nr_shards && res < maxevents; i++) {
+		sh = &ep->shards[(start + i) % ep->nr_shards];
+		if (!ep_shard_events_available(sh))
+			continue;
+
+		n = ep_send_shard_events(ep, sh, events + res, maxevents - res);
+		if (n < 0) {
+			if (!res)
+				res = n;
+			break;
+		}
+		res += n;
+	}
 
 	return res;
 }
@@ -2088,26 +2276,41 @@ static int ep_poll(struct eventpoll *ep, struct epoll_event __user *events,
 		init_wait(&wait);
 		wait.func = ep_autoremove_wake_function;
 
-		write_lock_irq(&ep->lock);
-		/*
-		 * Barrierless variant, waitqueue_active() is called under
-		 * the same lock on wakeup ep_poll_callback() side, so it
-		 * is safe to avoid an explicit barrier.
-		 */
-		__set_current_state(TASK_INTERRUPTIBLE);
-
-		/*
-		 * Do the final check under the lock. ep_start/done_scan()
-		 * plays with two lists (->rdllist and ->ovflist) and there
-		 * is always a race when both lists are empty for short
-		 * period of time although events are pending, so lock is
-		 * important.
-		 */
-		eavail = ep_events_available(ep);
-		if (!eavail)
+		if (ep_sharded(ep)) {
+			/*
+			 * There is no single ready list lock to check all
+			 * ready lists under. Queue first, and pair the
+			 * barrier of set_current_state() with the one in
+			 * ep_has_waiters() on the wakeup side.
+			 */
+			spin_lock_irq(&ep->wq.lock);
 			__add_wait_queue_exclusive(&ep->wq, &wait);
+			set_current_state(TASK_INTERRUPTIBLE);
+			spin_unlock_irq(&ep->wq.lock);
+
+			eavail = ep_events_available(ep);
+		} else {
+			write_lock_irq(&ep->shard0.lock);
+			/*
+			 * Barrierless variant, waitqueue_active() is called
+			 * under the same lock on wakeup ep_poll_callback()
+			 * side, so it is safe to avoid an explicit barrier.
+			 */
+			__set_current_state(TASK_INTERRUPTIBLE);
 
-		write_unlock_irq(&ep->lock);
+			/*
+			 * Do the final check under the lock.
+			 * ep_start/done_scan() plays with two lists (->rdllist
+			 * and ->ovflist) and there is always a race when both
+			 * lists are empty for short period of time although
+			 * events are pending, so lock is important.
+			 */
+			eavail = ep_events_available(ep);
+			if (!eavail)
+				__add_wait_queue_exclusive(&ep->wq, &wait);
+
+			write_unlock_irq(&ep->shard0.lock);
+		}
 
 		if (!eavail)
 			timed_out = !ep_schedule_timeout(to) ||
@@ -2123,7 +2326,7 @@ static int ep_poll(struct eventpoll *ep, struct epoll_event __user *events,
 		eavail = 1;
 
 		if (!list_empty_careful(&wait.entry)) {
-			write_lock_irq(&ep->lock);
+			ep_wait_lock_irq(ep);
 			/*
 			 * If the thread timed out and is not on the wait queue,
 			 * it means that the thread was woken up after its
@@ -2134,7 +2337,7 @@ static int ep_poll(struct eventpoll *ep, struct epoll_event __user *events,
 			if (timed_out)
 				eavail = list_empty(&wait.entry);
 			__remove_wait_queue(&ep->wq, &wait);
-			write_unlock_irq(&ep->lock);
+			ep_wait_unlock_irq(ep);
 		}
 	}
 }
@@ -2228,13 +2431,14 @@ static int do_epoll_create(int flags)
 
 	/* Check the EPOLL_* constant for consistency.  */
 	BUILD_BUG_ON(EPOLL_CLOEXEC != O_CLOEXEC);
+	BUILD_BUG_ON(EPOLL_SHARDED & EPOLL_CLOEXEC);
 
-	if (flags & ~EPOLL_CLOEXEC)
+	if (flags & ~(EPOLL_CLOEXEC | EPOLL_SHARDED))
 		return -EINVAL;
 	/*
 	 * Create the internal data structure ("struct eventpoll").
 	 */
-	error = ep_alloc(&ep);
+	error = ep_alloc(&ep, flags & EPOLL_SHARDED);
 	if (error < 0)
 		return error;
 	/*
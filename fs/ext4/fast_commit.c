@@ -1177,6 +1177,7 @@ static void ext4_fc_update_stats(struct super_block *sb, int status,
 				 stats->s_fc_avg_commit_time * 3) / 4;
 		else
 			stats->s_fc_avg_commit_time = commit_time;
+		stats->s_fc_last_commit_end = ktime_get();
 	} else if (status == EXT4_FC_STATUS_FAILED ||
 		   status == EXT4_FC_STATUS_INELIGIBLE) {
 		if (status == EXT4_FC_STATUS_FAILED)
@@ -1189,28 +1190,66 @@ static void ext4_fc_update_stats(struct super_block *sb, int status,
 }
 
 /*
- * The main commit entry point. Performs a fast commit for transaction
- * commit_tid if needed. If it's not possible to perform a fast commit
- * due to various reasons, we fall back to full commit. Returns 0
- * on success, error otherwise.
+ * Give other fsync callers a chance to queue their inodes before we start
+ * a fast commit, so that a burst of fsyncs shares one fast commit and the
+ * cache flush that comes with it. This follows the sync handle batching
+ * of jbd2_journal_stop(): if the last fast commit ended less than an
+ * average commit time ago, sleep for that long, bounded by the journal's
+ * min_batch_time and max_batch_time. A single task issuing fsyncs back
+ * to back never waits, and max_batch_time=0 disables the batching.
  */
-int ext4_fc_commit(journal_t *journal, tid_t commit_tid)
+static void ext4_fc_batch_wait(journal_t *journal, struct ext4_sb_info *sbi,
+			       tid_t commit_tid, int subtid)
+{
+	struct ext4_fc_stats *stats = &sbi->s_fc_stats;
+	pid_t pid = current->pid;
+	u64 commit_time, idle_time;
+	ktime_t expires;
+
+	if (!journal->j_max_batch_time ||
+	    READ_ONCE(stats->s_fc_last_committer) == pid)
+		return;
+	/* Nothing to wait for if a commit has already covered us */
+	if (!tid_gt(commit_tid, READ_ONCE(journal->j_commit_sequence)) ||
+	    atomic_read(&sbi->s_fc_subtid) > subtid)
+		return;
+	WRITE_ONCE(stats->s_fc_last_committer, pid);
+
+	commit_time = READ_ONCE(stats->s_fc_avg_commit_time);
+	commit_time = max_t(u64, commit_time, 1000 * journal->j_min_batch_time);
+	commit_time = min_t(u64, commit_time, 1000 * journal->j_max_batch_time);
+	idle_time = ktime_to_ns(ktime_sub(ktime_get(),
+					  READ_ONCE(stats->s_fc_last_commit_end)));
+	if (idle_time >= commit_time)
+		return;
+
+	expires = ktime_add_ns(ktime_get(), commit_time);
+	set_current_state(TASK_UNINTERRUPTIBLE);
+	schedule_hrtimeout(&expires, HRTIMER_MODE_ABS);
+}
+
+static void ext4_fc_account_latency(struct super_block *sb, ktime_t start_time)
+{
+	struct ext4_fc_stats *stats = &EXT4_SB(sb)->s_fc_stats;
+	u64 us = ktime_us_delta(ktime_get(), start_time);
+
+	atomic_long_inc(&stats->fc_lat_hist[min_t(unsigned int, fls64(us),
+						  EXT4_FC_LAT_BUCKETS - 1)]);
+}
+
+static int __ext4_fc_commit(journal_t *journal, tid_t commit_tid,
+			    ktime_t start_time)
 {
 	struct super_block *sb = journal->j_private;
 	struct ext4_sb_info *sbi = EXT4_SB(sb);
 	int nblks = 0, ret, bsize = journal->j_blocksize;
 	int subtid = atomic_read(&sbi->s_fc_subtid);
 	int status = EXT4_FC_STATUS_OK, fc_bufs_before = 0;
-	ktime_t start_time, commit_time;
+	ktime_t commit_time;
 	int old_ioprio, journal_ioprio;
 
-	if (!test_opt2(sb, JOURNAL_FAST_COMMIT))
-		return jbd2_complete_transaction(journal, commit_tid);
-
-	trace_ext4_fc_commit_start(sb, commit_tid);
-
-	start_time = ktime_get();
 	old_ioprio = get_current_ioprio();
+	ext4_fc_batch_wait(journal, sbi, commit_tid, subtid);
 
 restart_fc:
 	ret = jbd2_fc_begin_commit(journal, commit_tid);
@@ -1280,6 +1319,29 @@ int ext4_fc_commit(journal_t *journal, tid_t commit_tid)
 	return ret;
 }
 
+/*
+ * The main commit entry point. Performs a fast commit for transaction
+ * commit_tid if needed. If it's not possible to perform a fast commit
+ * due to various reasons, we fall back to full commit. Returns 0
+ * on success, error otherwise.
+ */
+int ext4_fc_commit(journal_t *journal, tid_t commit_tid)
+{
+	struct super_block *sb = journal->j_private;
+	ktime_t start_time;
+	int ret;
+
+	if (!test_opt2(sb, JOURNAL_FAST_COMMIT))
+		return jbd2_complete_transaction(journal, commit_tid);
+
+	trace_ext4_fc_commit_start(sb, commit_tid);
+
+	start_time = ktime_get();
+	ret = __ext4_fc_commit(journal, commit_tid, start_time);
+	ext4_fc_account_latency(sb, start_time);
+	return ret;
+}
+
 /*
  * Fast commit cleanup routine. This is called after every fast commit and
  * full commit. full is true if we are called after a full commit.
@@ -2322,6 +2384,13 @@ int ext4_fc_info_show(struct seq_file *seq, void *v)
 	for (i = 0; i < EXT4_FC_REASON_MAX; i++)
 		seq_printf(seq, "\"%s\":\t%d\n", fc_ineligible_reasons[i],
 			stats->fc_ineligible_reason_count[i]);
+	seq_puts(seq, "Commit latency:\n");
+	for (i = 0; i < EXT4_FC_LAT_BUCKETS - 1; i++)
+		seq_printf(seq, "<%luus:\t%ld\n", 1UL << i,
+			   atomic_long_read(&stats->fc_lat_hist[i]));
+	/* the last bucket holds everything the one before didn't */
+	seq_printf(seq, ">=%luus:\t%ld\n", 1UL << (i - 1),
+		   atomic_long_read(&stats->fc_lat_hist[i]));
 
 	return 0;
 }
@@ -114,6 +114,13 @@ struct ext4_fc_dentry_update {
 	struct list_head fcd_dilist;
 };
 
+/*
+ * Bucket i counts fast commit calls that took less than 2^i us, and at least
+ * 2^(i - 1) us. The last one counts all that took 2^(EXT4_FC_LAT_BUCKETS - 2)
+ * us or more.
+ */
+#define EXT4_FC_LAT_BUCKETS	16
+
 struct ext4_fc_stats {
 	unsigned int fc_ineligible_reason_count[EXT4_FC_REASON_MAX];
 	unsigned long fc_num_commits;
@@ -121,7 +128,10 @@ struct ext4_fc_stats {
 	unsigned long fc_failed_commits;
 	unsigned long fc_skipped_commits;
 	unsigned long fc_numblks;
+	atomic_long_t fc_lat_hist[EXT4_FC_LAT_BUCKETS];
 	u64 s_fc_avg_commit_time;
+	ktime_t s_fc_last_commit_end;
+	pid_t s_fc_last_committer;
 };
 
 #define EXT4_FC_REPLAY_REALLOC_INCREMENT	4
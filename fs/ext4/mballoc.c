@@ -2130,6 +2130,18 @@ static int mb_mark_used(struct ext4_buddy *e4b, struct ext4_free_extent *ex)
 	return ret;
 }
 
+/*
+ * Stream allocations of a file always use the same goal slot, so a
+ * sequential writer keeps appending to its own area of the filesystem.
+ */
+static ext4_group_t *ext4_mb_stream_goal(struct ext4_allocation_context *ac)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(ac->ac_sb);
+
+	return &sbi->s_mb_last_groups[ac->ac_inode->i_ino %
+				       sbi->s_mb_nr_global_goals];
+}
+
 /*
  * Must be called under group lock!
  */
@@ -2167,10 +2179,11 @@ static void ext4_mb_use_best_found(struct ext4_allocation_context *ac,
 	folio_get(ac->ac_buddy_folio);
 	/* store last allocated for subsequent stream allocation */
 	if (ac->ac_flags & EXT4_MB_STREAM_ALLOC) {
-		spin_lock(&sbi->s_md_lock);
-		sbi->s_mb_last_group = ac->ac_f_ex.fe_group;
-		sbi->s_mb_last_start = ac->ac_f_ex.fe_start;
-		spin_unlock(&sbi->s_md_lock);
+		ext4_group_t *goal = ext4_mb_stream_goal(ac);
+
+		if (sbi->s_mb_stats && ac->ac_f_ex.fe_group == READ_ONCE(*goal))
+			atomic_inc(&sbi->s_bal_stream_goals);
+		WRITE_ONCE(*goal, ac->ac_f_ex.fe_group);
 	}
 	/*
 	 * As we've just preallocated more space than
@@ -2844,11 +2857,11 @@ ext4_mb_regular_allocator(struct ext4_allocation_context *ac)
 
 	/* if stream allocation is enabled, use global goal */
 	if (ac->ac_flags & EXT4_MB_STREAM_ALLOC) {
-		/* TBD: may be hot point */
-		spin_lock(&sbi->s_md_lock);
-		ac->ac_g_ex.fe_group = sbi->s_mb_last_group;
-		ac->ac_g_ex.fe_start = sbi->s_mb_last_start;
-		spin_unlock(&sbi->s_md_lock);
+		ext4_group_t goal = READ_ONCE(*ext4_mb_stream_goal(ac));
+
+		/* Racy against resize, a stale goal only costs a longer scan */
+		if (goal < ngroups)
+			ac->ac_g_ex.fe_group = goal;
 	}
 
 	/*
@@ -3184,6 +3197,9 @@ int ext4_seq_mb_stats_show(struct seq_file *seq, void *offset)
 	seq_printf(seq, "\t\tlen_goal_hits: %u\n",
 		   atomic_read(&sbi->s_bal_len_goals));
 	seq_printf(seq, "\t\t2^n_hits: %u\n", atomic_read(&sbi->s_bal_2orders));
+	seq_printf(seq, "\t\tstream_goal_hits: %u/%u\n",
+		   atomic_read(&sbi->s_bal_stream_goals),
+		   sbi->s_mb_nr_global_goals);
 	seq_printf(seq, "\t\tbreaks: %u\n", atomic_read(&sbi->s_bal_breaks));
 	seq_printf(seq, "\t\tlost: %u\n", atomic_read(&sbi->s_mb_lost_chunks));
 	seq_printf(seq, "\tbuddies_generated: %u/%u\n",
@@ -3592,6 +3608,7 @@ int ext4_mb_init(struct super_block *sb)
 	unsigned i, j;
 	unsigned offset, offset_incr;
 	unsigned max;
+	ext4_group_t ngroups;
 	int ret;
 
 	i = MB_NUM_ORDERS(sb) * sizeof(*sbi->s_mb_offsets);
@@ -3667,6 +3684,24 @@ int ext4_mb_init(struct super_block *sb)
 		rwlock_init(&sbi->s_mb_largest_free_orders_locks[i]);
 	}
 
+	/*
+	 * Spread the stream allocation goals over the filesystem so that
+	 * writers hashed to different slots start out in different groups
+	 * and only meet once their part of the filesystem is full.
+	 */
+	ngroups = ext4_get_groups_count(sb);
+	sbi->s_mb_nr_global_goals = umin(num_possible_cpus(),
+					 DIV_ROUND_UP(ngroups, 4));
+	sbi->s_mb_last_groups = kmalloc_array(sbi->s_mb_nr_global_goals,
+					      sizeof(ext4_group_t), GFP_KERNEL);
+	if (!sbi->s_mb_last_groups) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < sbi->s_mb_nr_global_goals; i++)
+		sbi->s_mb_last_groups[i] = div_u64((u64)ngroups * i,
+						   sbi->s_mb_nr_global_goals);
+
 	spin_lock_init(&sbi->s_md_lock);
 	sbi->s_mb_free_pending = 0;
 	INIT_LIST_HEAD(&sbi->s_freed_data_list[0]);
@@ -3738,6 +3773,8 @@ int ext4_mb_init(struct super_block *sb)
 	free_percpu(sbi->s_locality_groups);
 	sbi->s_locality_groups = NULL;
 out:
+	kfree(sbi->s_mb_last_groups);
+	sbi->s_mb_last_groups = NULL;
 	kfree(sbi->s_mb_avg_fragment_size);
 	kfree(sbi->s_mb_avg_fragment_size_locks);
 	kfree(sbi->s_mb_largest_free_orders);
@@ -3808,6 +3845,7 @@ void ext4_mb_release(struct super_block *sb)
 		kvfree(group_info);
 		rcu_read_unlock();
 	}
+	kfree(sbi->s_mb_last_groups);
 	kfree(sbi->s_mb_avg_fragment_size);
 	kfree(sbi->s_mb_avg_fragment_size_locks);
 	kfree(sbi->s_mb_largest_free_orders);
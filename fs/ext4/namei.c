@@ -35,6 +35,7 @@
 #include <linux/buffer_head.h>
 #include <linux/bio.h>
 #include <linux/iversion.h>
+#include <linux/list_lru.h>
 #include <linux/unicode.h>
 #include "ext4.h"
 #include "ext4_jbd2.h"
@@ -515,6 +516,8 @@ static inline int ext4_handle_dirty_dx_node(handle_t *handle,
 					    struct inode *inode,
 					    struct buffer_head *bh)
 {
+	/* Every change to the index goes through here */
+	ext4_dx_cache_drop(inode);
 	ext4_dx_csum_set(inode, (struct ext4_dir_entry *)bh->b_data);
 	return ext4_handle_dirty_metadata(handle, inode, bh);
 }
@@ -955,6 +958,218 @@ static void dx_release(struct dx_frame *frames)
 	}
 }
 
+/*
+ * In-memory copy of the leaf level of a directory index.
+ *
+ * A lookup in a large indexed directory reads and checks the root and
+ * every interior index block on its way to a leaf. Directories of at
+ * least s_dx_cache_min_blocks blocks instead keep the start hash and
+ * block of all their leaves in hash order, built on the first lookup,
+ * so that a lookup is a binary search followed by reading the leaf.
+ * Lookups and index updates are serialised by i_rwsem; the caches are
+ * freed by RCU so the shrinker can reclaim them at any time.
+ */
+#define EXT4_DX_CACHE_MAX_LEAVES	(1U << 20)
+
+/* Longest run of leaves sharing a hash that a cached lookup follows */
+#define EXT4_DX_CACHE_CHAIN		8
+
+struct ext4_dx_cache_leaf {
+	u32		hash;
+	ext4_lblk_t	block;
+};
+
+struct ext4_dx_cache {
+	struct rcu_head			rcu;
+	struct list_head		lru;
+	struct inode			*dir;
+	bool				referenced;
+	u8				hash_version;
+	unsigned int			nr;
+	struct ext4_dx_cache_leaf	*leaves;
+};
+
+static struct list_lru ext4_dx_cache_lru;
+static struct shrinker *ext4_dx_cache_shrinker;
+
+static void ext4_dx_cache_free(struct ext4_dx_cache *c)
+{
+	kvfree(c->leaves);
+	kfree(c);
+}
+
+static void ext4_dx_cache_free_rcu(struct rcu_head *rcu)
+{
+	ext4_dx_cache_free(container_of(rcu, struct ext4_dx_cache, rcu));
+}
+
+void ext4_dx_cache_drop(struct inode *dir)
+{
+	struct ext4_inode_info *ei = EXT4_I(dir);
+	struct ext4_dx_cache *c;
+
+	if (!rcu_access_pointer(ei->i_dx_cache))
+		return;
+	c = unrcu_pointer(xchg(&ei->i_dx_cache, NULL));
+	if (!c)
+		return;
+	list_lru_del_obj(&ext4_dx_cache_lru, &c->lru);
+	call_rcu(&c->rcu, ext4_dx_cache_free_rcu);
+}
+
+static int ext4_dx_cache_fill(struct inode *dir, struct ext4_dx_cache *c,
+			      struct dx_entry *entries, unsigned int limit,
+			      u32 first_hash, unsigned int levels,
+			      ext4_lblk_t nblocks)
+{
+	unsigned int count = dx_get_count(entries);
+	struct buffer_head *bh;
+	unsigned int i;
+	int err;
+
+	if (dx_get_limit(entries) != limit || !count || count > limit)
+		return -EFSCORRUPTED;
+
+	for (i = 0; i < count; i++) {
+		u32 hash = i ? dx_get_hash(entries + i) : first_hash;
+		ext4_lblk_t block = dx_get_block(entries + i);
+
+		if (block >= nblocks)
+			return -EFSCORRUPTED;
+		if (!levels) {
+			if (c->nr >= nblocks ||
+			    (c->nr && hash < c->leaves[c->nr - 1].hash))
+				return -EFSCORRUPTED;
+			c->leaves[c->nr].hash = hash;
+			c->leaves[c->nr].block = block;
+			c->nr++;
+			continue;
+		}
+
+		bh = ext4_read_dirblock(dir, block, INDEX);
+		if (IS_ERR(bh))
+			return PTR_ERR(bh);
+		err = ext4_dx_cache_fill(dir, c,
+					 ((struct dx_node *)bh->b_data)->entries,
+					 dx_node_limit(dir), hash, levels - 1,
+					 nblocks);
+		brelse(bh);
+		if (err)
+			return err;
+	}
+	return 0;
+}
+
+/*
+ * Called after dx_probe() accepted the index of @dir, with @hash_version
+ * as it computed it.
+ */
+static void ext4_dx_cache_build(struct inode *dir, u8 hash_version)
+{
+	unsigned int min_blocks = READ_ONCE(EXT4_SB(dir->i_sb)->s_dx_cache_min_blocks);
+	ext4_lblk_t nblocks = dir->i_size >> dir->i_sb->s_blocksize_bits;
+	struct ext4_dx_cache *c;
+	struct buffer_head *bh;
+	struct dx_root *root;
+	int err;
+
+	if (!min_blocks || nblocks < min_blocks ||
+	    nblocks > EXT4_DX_CACHE_MAX_LEAVES ||
+	    rcu_access_pointer(EXT4_I(dir)->i_dx_cache))
+		return;
+
+	c = kzalloc(sizeof(*c), GFP_KERNEL);
+	if (!c)
+		return;
+	c->leaves = kvmalloc_array(nblocks, sizeof(*c->leaves), GFP_KERNEL);
+	if (!c->leaves)
+		goto out_free;
+	c->dir = dir;
+	c->hash_version = hash_version;
+	INIT_LIST_HEAD(&c->lru);
+
+	bh = ext4_read_dirblock(dir, 0, INDEX);
+	if (IS_ERR(bh))
+		goto out_free;
+	root = (struct dx_root *)bh->b_data;
+	err = ext4_dx_cache_fill(dir, c,
+				 (struct dx_entry *)(((char *)&root->info) +
+						     root->info.info_length),
+				 dx_root_limit(dir, root->info.info_length), 0,
+				 root->info.indirect_levels, nblocks);
+	brelse(bh);
+	if (err)
+		goto out_free;
+
+	if (cmpxchg(&EXT4_I(dir)->i_dx_cache, NULL, RCU_INITIALIZER(c)))
+		goto out_free;
+	list_lru_add_obj(&ext4_dx_cache_lru, &c->lru);
+	return;
+out_free:
+	ext4_dx_cache_free(c);
+}
+
+static enum lru_status ext4_dx_cache_isolate(struct list_head *item,
+					     struct list_lru_one *lru,
+					     void *arg)
+{
+	struct ext4_dx_cache *c = container_of(item, struct ext4_dx_cache, lru);
+
+	if (READ_ONCE(c->referenced)) {
+		WRITE_ONCE(c->referenced, false);
+		return LRU_ROTATE;
+	}
+	/* ext4_dx_cache_drop() got there first and will unlink it */
+	if (unrcu_pointer(cmpxchg(&EXT4_I(c->dir)->i_dx_cache,
+				  RCU_INITIALIZER(c), NULL)) != c)
+		return LRU_SKIP;
+
+	list_lru_isolate(lru, item);
+	call_rcu(&c->rcu, ext4_dx_cache_free_rcu);
+	return LRU_REMOVED;
+}
+
+static unsigned long ext4_dx_cache_count(struct shrinker *shrink,
+					 struct shrink_control *sc)
+{
+	return list_lru_shrink_count(&ext4_dx_cache_lru, sc);
+}
+
+static unsigned long ext4_dx_cache_scan(struct shrinker *shrink,
+					struct shrink_control *sc)
+{
+	return list_lru_shrink_walk(&ext4_dx_cache_lru, sc,
+				    ext4_dx_cache_isolate, NULL);
+}
+
+int __init ext4_init_dx_cache(void)
+{
+	int err;
+
+	err = list_lru_init(&ext4_dx_cache_lru);
+	if (err)
+		return err;
+
+	ext4_dx_cache_shrinker = shrinker_alloc(SHRINKER_NUMA_AWARE,
+						"ext4-dx-cache");
+	if (!ext4_dx_cache_shrinker) {
+		list_lru_destroy(&ext4_dx_cache_lru);
+		return -ENOMEM;
+	}
+	ext4_dx_cache_shrinker->count_objects = ext4_dx_cache_count;
+	ext4_dx_cache_shrinker->scan_objects = ext4_dx_cache_scan;
+	shrinker_register(ext4_dx_cache_shrinker);
+	return 0;
+}
+
+void ext4_exit_dx_cache(void)
+{
+	shrinker_free(ext4_dx_cache_shrinker);
+	/* Wait for the caches freed by the last evicted directories */
+	rcu_barrier();
+	list_lru_destroy(&ext4_dx_cache_lru);
+}
+
 /*
  * This function increments the frame pointer to search the next leaf
  * block, and reads in the necessary intervening nodes if the search
@@ -1706,6 +1921,87 @@ static struct buffer_head *ext4_lookup_entry(struct inode *dir,
 	return bh;
 }
 
+/*
+ * Look @fname up through the cached index of @dir. Returns
+ * ERR_PTR(-EAGAIN) if there is no cache or the lookup has to walk the
+ * index blocks, otherwise the same as ext4_dx_find_entry().
+ */
+static struct buffer_head *ext4_dx_cache_find_entry(struct inode *dir,
+			struct ext4_filename *fname,
+			struct ext4_dir_entry_2 **res_dir)
+{
+	ext4_lblk_t blocks[EXT4_DX_CACHE_CHAIN];
+	struct dx_hash_info *hinfo = &fname->hinfo;
+	struct ext4_dx_cache *c;
+	struct buffer_head *bh;
+	unsigned int lo, hi, nr = 0, i;
+	int ret;
+
+	rcu_read_lock();
+	c = rcu_dereference(EXT4_I(dir)->i_dx_cache);
+	if (c)
+		hinfo->hash_version = c->hash_version;
+	rcu_read_unlock();
+	if (!c)
+		return ERR_PTR(-EAGAIN);
+
+	hinfo->seed = EXT4_SB(dir->i_sb)->s_hash_seed;
+	/* hash is already computed for encrypted casefolded directory */
+	if (fname_name(fname) && !(IS_ENCRYPTED(dir) && IS_CASEFOLDED(dir))) {
+		ret = ext4fs_dirhash(dir, fname_name(fname), fname_len(fname),
+				     hinfo);
+		if (ret < 0)
+			return ERR_PTR(ret);
+	}
+
+	rcu_read_lock();
+	c = rcu_dereference(EXT4_I(dir)->i_dx_cache);
+	if (!c)
+		goto out_again;
+
+	/* Last leaf starting at or below the hash, as dx_probe() */
+	lo = 1;
+	hi = c->nr;
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2;
+
+		if (c->leaves[mid].hash > hinfo->hash)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	/* And the following ones continuing it, as ext4_htree_next_block() */
+	for (i = lo - 1; i < c->nr; i++) {
+		if (i >= lo && (c->leaves[i].hash & ~1) != hinfo->hash)
+			break;
+		if (nr == EXT4_DX_CACHE_CHAIN)
+			goto out_again;
+		blocks[nr++] = c->leaves[i].block;
+	}
+	if (!READ_ONCE(c->referenced))
+		WRITE_ONCE(c->referenced, true);
+	rcu_read_unlock();
+
+	for (i = 0; i < nr; i++) {
+		bh = ext4_read_dirblock(dir, blocks[i], DIRENT_HTREE);
+		if (IS_ERR(bh))
+			return bh;
+		ret = search_dirblock(bh, dir, fname,
+				      blocks[i] << EXT4_BLOCK_SIZE_BITS(dir->i_sb),
+				      res_dir);
+		if (ret == 1)
+			return bh;
+		brelse(bh);
+		if (ret < 0)
+			return ERR_PTR(ERR_BAD_DX_DIR);
+	}
+	return NULL;
+
+out_again:
+	rcu_read_unlock();
+	return ERR_PTR(-EAGAIN);
+}
+
 static struct buffer_head * ext4_dx_find_entry(struct inode *dir,
 			struct ext4_filename *fname,
 			struct ext4_dir_entry_2 **res_dir)
@@ -1719,6 +2015,10 @@ static struct buffer_head * ext4_dx_find_entry(struct inode *dir,
 #ifdef CONFIG_FS_ENCRYPTION
 	*res_dir = NULL;
 #endif
+	bh = ext4_dx_cache_find_entry(dir, fname, res_dir);
+	if (bh != ERR_PTR(-EAGAIN))
+		return bh;
+
 	frame = dx_probe(fname, dir, NULL, frames);
 	if (IS_ERR(frame))
 		return ERR_CAST(frame);
@@ -1756,6 +2056,8 @@ static struct buffer_head * ext4_dx_find_entry(struct inode *dir,
 	dxtrace(printk(KERN_DEBUG "%s not found\n", fname->usr_fname->name));
 success:
 	dx_release(frames);
+	if (!IS_ERR(bh))
+		ext4_dx_cache_build(dir, fname->hinfo.hash_version);
 	return bh;
 }
 
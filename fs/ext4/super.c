@@ -1387,6 +1387,7 @@ static struct inode *ext4_alloc_inode(struct super_block *sb)
 
 	inode_set_iversion(&ei->vfs_inode, 1);
 	ei->i_flags = 0;
+	RCU_INIT_POINTER(ei->i_dx_cache, NULL);
 	spin_lock_init(&ei->i_raw_lock);
 	ei->i_prealloc_node = RB_ROOT;
 	atomic_set(&ei->i_prealloc_active, 0);
@@ -1498,6 +1499,7 @@ static void destroy_inodecache(void)
 void ext4_clear_inode(struct inode *inode)
 {
 	ext4_fc_del(inode);
+	ext4_dx_cache_drop(inode);
 	invalidate_inode_buffers(inode);
 	clear_inode(inode);
 	ext4_discard_preallocations(inode);
@@ -7449,6 +7451,10 @@ static int __init ext4_init_fs(void)
 	if (err)
 		goto out05;
 
+	err = ext4_init_dx_cache();
+	if (err)
+		goto out04;
+
 	register_as_ext3();
 	register_as_ext2();
 	err = register_filesystem(&ext4_fs_type);
@@ -7459,6 +7465,8 @@ static int __init ext4_init_fs(void)
 out:
 	unregister_as_ext2();
 	unregister_as_ext3();
+	ext4_exit_dx_cache();
+out04:
 	ext4_fc_destroy_dentry_cache();
 out05:
 	destroy_inodecache();
@@ -7486,6 +7494,7 @@ static void __exit ext4_exit_fs(void)
 	unregister_as_ext2();
 	unregister_as_ext3();
 	unregister_filesystem(&ext4_fs_type);
+	ext4_exit_dx_cache();
 	ext4_fc_destroy_dentry_cache();
 	destroy_inodecache();
 	ext4_exit_mballoc();
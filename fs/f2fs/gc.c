@@ -1713,6 +1713,45 @@ static int __get_victim(struct f2fs_sb_info *sbi, unsigned int *victim,
 	return ret;
 }
 
+/*
+ * Issue the NAT readahead of the next victim data segment while the current
+ * one is being migrated, so that the first phase of gc_data_segment() does not
+ * start from a cold NAT cache for every segment of a large section.
+ */
+static void gc_ra_next_data_segment(struct f2fs_sb_info *sbi,
+				unsigned int segno)
+{
+	struct f2fs_summary_block *sum;
+	struct f2fs_summary *entry;
+	struct folio *sum_folio;
+	unsigned int usable_blks_in_seg;
+	int off;
+
+	if (get_valid_blocks(sbi, segno, false) == 0)
+		return;
+
+	sum_folio = filemap_get_folio(META_MAPPING(sbi), GET_SUM_BLOCK(sbi, segno));
+	if (IS_ERR(sum_folio))
+		return;
+	if (!folio_test_uptodate(sum_folio))
+		goto out;
+
+	sum = folio_address(sum_folio);
+	if (GET_SUM_TYPE((&sum->footer)) != SUM_TYPE_DATA)
+		goto out;
+
+	usable_blks_in_seg = f2fs_usable_blks_in_seg(sbi, segno);
+	entry = sum->entries;
+	for (off = 0; off < usable_blks_in_seg; off++, entry++) {
+		if (check_valid_map(sbi, segno, off) == 0)
+			continue;
+		f2fs_ra_meta_pages(sbi, NAT_BLOCK_OFFSET(le32_to_cpu(entry->nid)),
+					1, META_NAT, true);
+	}
+out:
+	folio_put(sum_folio);
+}
+
 static int do_garbage_collect(struct f2fs_sb_info *sbi,
 				unsigned int start_segno,
 				struct gc_inode_list *gc_list, int gc_type,
@@ -1816,13 +1855,18 @@ static int do_garbage_collect(struct f2fs_sb_info *sbi,
 		 *   - down_read(sentry_lock)     - change_curseg()
 		 *                                  - lock_page(sum_page)
 		 */
-		if (type == SUM_TYPE_NODE)
+		if (type == SUM_TYPE_NODE) {
 			submitted += gc_node_segment(sbi, sum->entries, segno,
 								gc_type);
-		else
+		} else {
+			if (segno + 1 < end_segno &&
+			    !(gc_type == BG_GC && __is_large_section(sbi) &&
+			      migrated + 1 >= sbi->migration_granularity))
+				gc_ra_next_data_segment(sbi, segno + 1);
 			submitted += gc_data_segment(sbi, sum->entries, gc_list,
 							segno, gc_type,
 							force_migrate);
+		}
 
 		stat_inc_gc_seg_count(sbi, data_type, gc_type);
 		sbi->gc_reclaimed_segs[sbi->gc_mode]++;
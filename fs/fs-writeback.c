@@ -1875,9 +1875,10 @@ static long writeback_chunk_size(struct bdi_writeback *wb,
  * unlock and relock that for each inode it ends up doing
  * IO for.
  */
-static long writeback_sb_inodes(struct super_block *sb,
-				struct bdi_writeback *wb,
-				struct wb_writeback_work *work)
+static long writeback_sb_inodes_list(struct super_block *sb,
+				     struct bdi_writeback *wb,
+				     struct wb_writeback_work *work,
+				     struct list_head *io)
 {
 	struct writeback_control wbc = {
 		.sync_mode		= work->sync_mode,
@@ -1898,8 +1899,8 @@ static long writeback_sb_inodes(struct super_block *sb,
 		dirtied_before = jiffies -
 			msecs_to_jiffies(dirty_expire_interval * 10);
 
-	while (!list_empty(&wb->b_io)) {
-		struct inode *inode = wb_inode(wb->b_io.prev);
+	while (!list_empty(io)) {
+		struct inode *inode = wb_inode(io->prev);
 		struct bdi_writeback *tmp_wb;
 		long wrote;
 
@@ -2025,6 +2026,153 @@ static long writeback_sb_inodes(struct super_block *sb,
 	return total_wrote;
 }
 
+/*
+ * Parallel writeback of one superblock.
+ *
+ * The inodes of @sb queued at the tail of b_io are dealt out to up to
+ * bdi->wb_workers private lists, by the superblock's ->writeback_shard()
+ * hint or by inode number, and each list is written back by the loop of
+ * writeback_sb_inodes() on its own. The caller's worker takes part, and
+ * also runs the shards of helpers that did not get to start, so progress
+ * never depends on more than the one bdi_wq worker already running.
+ * Whatever the shards leave unwritten is put back at the tail of b_io.
+ */
+struct wb_shard {
+	struct work_struct	work;
+	struct wb_parallel	*wp;
+	struct list_head	io;
+	struct wb_writeback_work wb_work;	/* private nr_pages budget */
+	long			wrote;
+};
+
+struct wb_parallel {
+	struct super_block	*sb;
+	struct bdi_writeback	*wb;
+	atomic_t		next;
+	unsigned int		nr;
+	struct wb_shard		shards[];
+};
+
+/* Only split batches with a few inodes per worker */
+#define WB_SHARD_MIN_INODES	4
+
+static unsigned int wb_inode_shard(struct inode *inode, unsigned int nr)
+{
+	const struct super_operations *sop = inode->i_sb->s_op;
+	unsigned long key;
+
+	key = sop->writeback_shard ? sop->writeback_shard(inode) : inode->i_ino;
+	return key % nr;
+}
+
+static void wb_parallel_run(struct wb_parallel *wp)
+{
+	struct blk_plug plug;
+	unsigned int i;
+
+	blk_start_plug(&plug);
+	while ((i = atomic_inc_return(&wp->next) - 1) < wp->nr) {
+		struct wb_shard *shard = &wp->shards[i];
+
+		spin_lock(&wp->wb->list_lock);
+		shard->wrote = writeback_sb_inodes_list(wp->sb, wp->wb,
+							&shard->wb_work,
+							&shard->io);
+		spin_unlock(&wp->wb->list_lock);
+	}
+	blk_finish_plug(&plug);
+}
+
+static void wb_shard_workfn(struct work_struct *work)
+{
+	wb_parallel_run(container_of(work, struct wb_shard, work)->wp);
+}
+
+static long writeback_sb_inodes_parallel(struct super_block *sb,
+					 struct bdi_writeback *wb,
+					 struct wb_writeback_work *work,
+					 unsigned int nr)
+{
+	long share = max(work->nr_pages / nr, 1L);
+	unsigned int i, nr_inodes = 0;
+	struct wb_parallel *wp;
+	struct inode *inode;
+	long wrote = 0;
+
+	list_for_each_entry_reverse(inode, &wb->b_io, i_io_list) {
+		if (inode->i_sb != sb ||
+		    ++nr_inodes >= nr * WB_SHARD_MIN_INODES)
+			break;
+	}
+	if (nr_inodes < nr * WB_SHARD_MIN_INODES)
+		return -EAGAIN;
+
+	/* We hold wb->list_lock, and writeback must not recurse into reclaim */
+	wp = kzalloc(struct_size(wp, shards, nr), GFP_NOWAIT | __GFP_NOWARN);
+	if (!wp)
+		return -ENOMEM;
+	wp->sb = sb;
+	wp->wb = wb;
+	wp->nr = nr;
+	for (i = 0; i < nr; i++) {
+		INIT_LIST_HEAD(&wp->shards[i].io);
+		wp->shards[i].wp = wp;
+		wp->shards[i].wb_work = *work;
+		wp->shards[i].wb_work.nr_pages = share;
+	}
+
+	/* list_move() to the head keeps the b_io order within each shard */
+	while (!list_empty(&wb->b_io)) {
+		inode = wb_inode(wb->b_io.prev);
+		if (inode->i_sb != sb)
+			break;
+		list_move(&inode->i_io_list,
+			  &wp->shards[wb_inode_shard(inode, nr)].io);
+	}
+
+	spin_unlock(&wb->list_lock);
+	for (i = 1; i < nr; i++) {
+		INIT_WORK(&wp->shards[i].work, wb_shard_workfn);
+		queue_work(bdi_wq, &wp->shards[i].work);
+	}
+	wb_parallel_run(wp);
+	/* Helpers still queued have no shard left to run */
+	for (i = 1; i < nr; i++)
+		cancel_work_sync(&wp->shards[i].work);
+	spin_lock(&wb->list_lock);
+
+	for (i = 0; i < nr; i++) {
+		struct wb_shard *shard = &wp->shards[i];
+
+		wrote += shard->wrote;
+		work->nr_pages -= share - shard->wb_work.nr_pages;
+		list_splice_tail(&shard->io, &wb->b_io);
+	}
+	/* Inodes removed meanwhile may have made the wb look clean */
+	if (!list_empty(&wb->b_io))
+		wb_io_lists_populated(wb);
+	kfree(wp);
+
+	return wrote;
+}
+
+static long writeback_sb_inodes(struct super_block *sb,
+				struct bdi_writeback *wb,
+				struct wb_writeback_work *work)
+{
+	unsigned int nr = min_t(unsigned int, READ_ONCE(wb->bdi->wb_workers),
+				BDI_MAX_WB_WORKERS);
+
+	/* WB_SYNC_ALL waits on I_SYNC inodes, keep that to a single worker */
+	if (nr > 1 && work->sync_mode == WB_SYNC_NONE) {
+		long wrote = writeback_sb_inodes_parallel(sb, wb, work, nr);
+
+		if (wrote >= 0)
+			return wrote;
+	}
+	return writeback_sb_inodes_list(sb, wb, work, &wb->b_io);
+}
+
 static long __writeback_inodes_wb(struct bdi_writeback *wb,
 				  struct wb_writeback_work *work)
 {
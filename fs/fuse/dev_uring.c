@@ -10,12 +10,19 @@
 
 #include <linux/fs.h>
 #include <linux/io_uring/cmd.h>
+#include <linux/mm.h>
+#include <linux/sched/mm.h>
 
 static bool __read_mostly enable_uring;
 module_param(enable_uring, bool, 0644);
 MODULE_PARM_DESC(enable_uring,
 		 "Enable userspace communication through io-uring");
 
+static bool __read_mostly pin_uring_payload;
+module_param(pin_uring_payload, bool, 0644);
+MODULE_PARM_DESC(pin_uring_payload,
+		 "Pin io-uring payload buffers when ring entries are registered");
+
 #define FUSE_URING_IOV_SEGS 2 /* header and payload */
 
 
@@ -183,6 +190,21 @@ bool fuse_uring_request_expired(struct fuse_conn *fc)
 	return false;
 }
 
+static void fuse_uring_unpin_payload(struct fuse_ring_ent *ent)
+{
+	unsigned int i;
+
+	if (!ent->payload_bvec)
+		return;
+
+	for (i = 0; i < ent->payload_nr_pages; i++)
+		unpin_user_page(ent->payload_bvec[i].bv_page);
+	account_locked_vm(ent->payload_mm, ent->payload_nr_pages, false);
+	mmdrop(ent->payload_mm);
+	kvfree(ent->payload_bvec);
+	ent->payload_bvec = NULL;
+}
+
 void fuse_uring_destruct(struct fuse_conn *fc)
 {
 	struct fuse_ring *ring = fc->ring;
@@ -206,6 +228,7 @@ void fuse_uring_destruct(struct fuse_conn *fc)
 		list_for_each_entry_safe(ent, next, &queue->ent_released,
 					 list) {
 			list_del_init(&ent->list);
+			fuse_uring_unpin_payload(ent);
 			kfree(ent);
 		}
 
@@ -573,6 +596,23 @@ static int fuse_uring_out_header_has_err(struct fuse_out_header *oh,
 	return err;
 }
 
+/*
+ * Set up the iterator over the payload buffer of an entry. Pinned payloads
+ * avoid walking and faulting the server's page tables for every request.
+ */
+static int fuse_uring_payload_iter(struct fuse_ring *ring,
+				   struct fuse_ring_ent *ent, int dir,
+				   struct iov_iter *iter)
+{
+	if (ent->payload_bvec) {
+		iov_iter_bvec(iter, dir, ent->payload_bvec,
+			      ent->payload_nr_pages, ring->max_payload_sz);
+		return 0;
+	}
+
+	return import_ubuf(dir, ent->payload, ring->max_payload_sz, iter);
+}
+
 static int fuse_uring_copy_from_ring(struct fuse_ring *ring,
 				     struct fuse_req *req,
 				     struct fuse_ring_ent *ent)
@@ -588,8 +628,7 @@ static int fuse_uring_copy_from_ring(struct fuse_ring *ring,
 	if (err)
 		return -EFAULT;
 
-	err = import_ubuf(ITER_SOURCE, ent->payload, ring->max_payload_sz,
-			  &iter);
+	err = fuse_uring_payload_iter(ring, ent, ITER_SOURCE, &iter);
 	if (err)
 		return err;
 
@@ -617,7 +656,7 @@ static int fuse_uring_args_to_ring(struct fuse_ring *ring, struct fuse_req *req,
 		.commit_id = req->in.h.unique,
 	};
 
-	err = import_ubuf(ITER_DEST, ent->payload, ring->max_payload_sz, &iter);
+	err = fuse_uring_payload_iter(ring, ent, ITER_DEST, &iter);
 	if (err) {
 		pr_info_ratelimited("fuse: Import of user buffer failed\n");
 		return err;
@@ -1026,6 +1065,60 @@ static int fuse_uring_get_iovec_from_sqe(const struct io_uring_sqe *sqe,
 	return 0;
 }
 
+/*
+ * Pin the payload buffer of a new entry for its lifetime, accounted against
+ * RLIMIT_MEMLOCK like io_uring fixed buffers. As with those, the server must
+ * not replace the memory behind a registered payload buffer. Failure is not
+ * fatal, the payload is then copied through the user address.
+ */
+static void fuse_uring_pin_payload(struct fuse_ring_ent *ent, size_t size)
+{
+	unsigned long addr = (unsigned long)ent->payload;
+	unsigned int nr_pages, off, i;
+	struct page **pages;
+	struct bio_vec *bvec;
+	int pinned;
+
+	off = offset_in_page(addr);
+	nr_pages = DIV_ROUND_UP(off + size, PAGE_SIZE);
+
+	bvec = kvmalloc_array(nr_pages, sizeof(*bvec), GFP_KERNEL_ACCOUNT);
+	pages = kvmalloc_array(nr_pages, sizeof(*pages), GFP_KERNEL);
+	if (!bvec || !pages)
+		goto out_free;
+
+	if (account_locked_vm(current->mm, nr_pages, true))
+		goto out_free;
+
+	pinned = pin_user_pages_fast(addr & PAGE_MASK, nr_pages,
+				     FOLL_WRITE | FOLL_LONGTERM, pages);
+	if (pinned != nr_pages) {
+		if (pinned > 0)
+			unpin_user_pages(pages, pinned);
+		account_locked_vm(current->mm, nr_pages, false);
+		goto out_free;
+	}
+
+	for (i = 0; i < nr_pages; i++) {
+		unsigned int len = min_t(size_t, size, PAGE_SIZE - off);
+
+		bvec_set_page(&bvec[i], pages[i], len, off);
+		size -= len;
+		off = 0;
+	}
+	kvfree(pages);
+
+	mmgrab(current->mm);
+	ent->payload_mm = current->mm;
+	ent->payload_nr_pages = nr_pages;
+	ent->payload_bvec = bvec;
+	return;
+
+out_free:
+	kvfree(pages);
+	kvfree(bvec);
+}
+
 static struct fuse_ring_ent *
 fuse_uring_create_ring_ent(struct io_uring_cmd *cmd,
 			   struct fuse_ring_queue *queue)
@@ -1066,6 +1159,8 @@ fuse_uring_create_ring_ent(struct io_uring_cmd *cmd,
 	ent->queue = queue;
 	ent->headers = iov[0].iov_base;
 	ent->payload = iov[1].iov_base;
+	if (READ_ONCE(pin_uring_payload))
+		fuse_uring_pin_payload(ent, ring->max_payload_sz);
 
 	atomic_inc(&ring->queue_refs);
 	return ent;
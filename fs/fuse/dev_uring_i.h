@@ -42,6 +42,14 @@ struct fuse_ring_ent {
 	struct fuse_uring_req_header __user *headers;
 	void __user *payload;
 
+	/*
+	 * payload pages pinned at registration, NULL if pinning failed and
+	 * the payload is accessed through the user address instead
+	 */
+	struct bio_vec *payload_bvec;
+	unsigned int payload_nr_pages;
+	struct mm_struct *payload_mm;
+
 	/* the ring queue that owns the request */
 	struct fuse_ring_queue *queue;
 
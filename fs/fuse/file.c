@@ -2360,13 +2360,13 @@ static int fuse_file_mmap(struct file *file, struct vm_area_struct *vma)
 
 	/*
 	 * If inode is in passthrough io mode, because it has some file open
-	 * in passthrough mode, either mmap to backing file or fail mmap,
-	 * because mixing cached mmap and passthrough io mode is not allowed.
+	 * in passthrough mode, mmap to backing file, because mixing cached
+	 * mmap and passthrough io mode is not allowed.
 	 */
 	if (fuse_file_passthrough(ff))
 		return fuse_passthrough_mmap(file, vma);
 	else if (fuse_inode_backing(get_fuse_inode(inode)))
-		return -ENODEV;
+		return fuse_inode_passthrough_mmap(file, vma);
 
 	/*
 	 * FOPEN_DIRECT_IO handling is special compared to O_DIRECT,
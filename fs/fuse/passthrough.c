@@ -144,6 +144,46 @@ ssize_t fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma)
 	return backing_file_mmap(backing_file, vma, &ctx);
 }
 
+/*
+ * Map the backing file of the inode for a file that was opened without
+ * FOPEN_PASSTHROUGH before the inode entered passthrough mode. IO on such a
+ * file (FOPEN_DIRECT_IO) goes to the server, but mapping it must not use the
+ * fuse inode page cache, so map a private backing file of the same path,
+ * just like mmap of a FOPEN_PASSTHROUGH | FOPEN_DIRECT_IO file does.
+ */
+int fuse_inode_passthrough_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct fuse_inode *fi = get_fuse_inode(file_inode(file));
+	struct backing_file_ctx ctx = {
+		.accessed = fuse_file_accessed,
+	};
+	struct file *backing_file;
+	struct fuse_backing *fb;
+	int err;
+
+	rcu_read_lock();
+	fb = fuse_backing_get(fuse_inode_backing(fi));
+	rcu_read_unlock();
+	if (!fb)
+		return -ENODEV;
+
+	backing_file = backing_file_open(&file->f_path, file->f_flags,
+					 &fb->file->f_path, fb->cred);
+	err = PTR_ERR(backing_file);
+	if (!IS_ERR(backing_file)) {
+		pr_debug("%s: backing_file=0x%p, start=%lu, end=%lu\n", __func__,
+			 backing_file, vma->vm_start, vma->vm_end);
+
+		ctx.cred = fb->cred;
+		err = backing_file_mmap(backing_file, vma, &ctx);
+		/* the vma holds its own reference on success */
+		fput(backing_file);
+	}
+	fuse_backing_put(fb);
+
+	return err;
+}
+
 struct fuse_backing *fuse_backing_get(struct fuse_backing *fb)
 {
 	if (fb && refcount_inc_not_zero(&fb->count))
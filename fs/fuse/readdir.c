@@ -12,6 +12,7 @@
 #include <linux/posix_acl.h>
 #include <linux/pagemap.h>
 #include <linux/highmem.h>
+#include <linux/dirent.h>
 
 static bool fuse_use_readdirplus(struct inode *dir, struct dir_context *ctx)
 {
@@ -331,6 +332,26 @@ static int parse_dirplusfile(char *buf, size_t nbytes, struct file *file,
 	return 0;
 }
 
+/*
+ * Size a READDIR(PLUS) reply to hold about as many entries as the caller's
+ * getdents buffer of @count bytes. Each name takes a linux_dirent64 there,
+ * but a fuse_dirent or a much larger fuse_direntplus in the reply. Count
+ * with one byte names, for which the caller takes the most entries; entries
+ * the caller has no room for are still linked into the dcache by
+ * parse_dirplusfile() and serve the lookups that usually follow.
+ */
+static size_t fuse_readdir_bufsize(size_t count, bool plus)
+{
+	struct fuse_direntplus direntplus = { .dirent.namelen = 1 };
+	size_t nr;
+
+	nr = count / ALIGN(offsetof(struct linux_dirent64, d_name) + 2,
+			   sizeof(u64));
+	if (plus)
+		return nr * FUSE_DIRENTPLUS_SIZE(&direntplus);
+	return nr * FUSE_DIRENT_SIZE(&direntplus.dirent);
+}
+
 static int fuse_readdir_uncached(struct file *file, struct dir_context *ctx)
 {
 	int plus;
@@ -341,17 +362,20 @@ static int fuse_readdir_uncached(struct file *file, struct dir_context *ctx)
 	struct fuse_io_args ia = {};
 	struct fuse_args *args = &ia.ap.args;
 	void *buf;
-	size_t bufsize = clamp((unsigned int) ctx->count, PAGE_SIZE, fc->max_pages << PAGE_SHIFT);
+	size_t bufsize;
 	u64 attr_version = 0, evict_ctr = 0;
 	bool locked;
 
+	plus = fuse_use_readdirplus(inode, ctx);
+	bufsize = clamp_t(size_t, fuse_readdir_bufsize(ctx->count, plus),
+			  PAGE_SIZE, fc->max_pages << PAGE_SHIFT);
+
 	buf = kvmalloc(bufsize, GFP_KERNEL);
 	if (!buf)
 		return -ENOMEM;
 
 	args->out_args[0].value = buf;
 
-	plus = fuse_use_readdirplus(inode, ctx);
 	if (plus) {
 		attr_version = fuse_get_attr_version(fm->fc);
 		evict_ctr = fuse_get_evict_ctr(fm->fc);
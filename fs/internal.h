@@ -228,6 +228,25 @@ extern struct dentry *__d_lookup_rcu(const struct dentry *parent,
 				const struct qstr *name, unsigned *seq);
 extern void d_genocide(struct dentry *);
 
+/*
+ * dir_bloom.c
+ */
+#ifdef CONFIG_DIR_BLOOM
+bool dir_bloom_absent(const struct dentry *dir, const struct qstr *name);
+void dir_bloom_add(struct dentry *dentry);
+void dir_bloom_build(const struct path *path);
+void dir_bloom_free(struct inode *inode);
+#else
+static inline bool dir_bloom_absent(const struct dentry *dir,
+				    const struct qstr *name)
+{
+	return false;
+}
+static inline void dir_bloom_add(struct dentry *dentry) { }
+static inline void dir_bloom_build(const struct path *path) { }
+static inline void dir_bloom_free(struct inode *inode) { }
+#endif
+
 /*
  * pipe.c
  */
@@ -253,6 +272,9 @@ int do_statx(int dfd, struct filename *filename, unsigned int flags,
 	     unsigned int mask, struct statx __user *buffer);
 int do_statx_fd(int fd, unsigned int flags, unsigned int mask,
 		struct statx __user *buffer);
+int vfs_statx_path(struct path *path, int flags, struct kstat *stat,
+		   u32 request_mask);
+int cp_statx(const struct kstat *stat, struct statx __user *buffer);
 
 /*
  * fs/splice.c:
@@ -16,6 +16,7 @@
 #include <linux/bio.h>
 #include <linux/sched/signal.h>
 #include <linux/migrate.h>
+#include <linux/sizes.h>
 #include "internal.h"
 #include "trace.h"
 
@@ -935,6 +936,124 @@ static bool iomap_write_end(struct iomap_iter *iter, size_t len, size_t copied,
 	return __iomap_write_end(iter->inode, pos, len, copied, folio);
 }
 
+/* Upper bound of data locked in the page cache by one batched write */
+#define IOMAP_WRITE_BATCH_BYTES	SZ_1M
+
+static bool iomap_write_can_batch(const struct iomap_iter *iter)
+{
+	const struct iomap_folio_ops *folio_ops = iter->iomap.folio_ops;
+	const struct iomap *srcmap = iomap_iter_srcmap(iter);
+
+	if (srcmap->type == IOMAP_INLINE || (srcmap->flags & IOMAP_F_BUFFER_HEAD))
+		return false;
+	return !folio_ops || (!folio_ops->get_folio && !folio_ops->put_folio);
+}
+
+/*
+ * Write a run of folios that the write covers entirely: look them all up
+ * and lock them, check the mapping once, copy the data in one pass over
+ * @i, then update the inode size once and release the folios together.
+ * Folios that are entirely overwritten need no reads and no per-block
+ * state, so none of the per-folio work of iomap_write_begin() applies.
+ *
+ * Returns the number of bytes written, 0 if the write has to continue one
+ * folio at a time. Sets @short_copy if copying from @i came up short.
+ */
+static size_t iomap_write_batch(struct iomap_iter *iter, struct iov_iter *i,
+		size_t chunk, bool *short_copy)
+{
+	const struct iomap_folio_ops *folio_ops = iter->iomap.folio_ops;
+	struct inode *inode = iter->inode;
+	struct address_space *mapping = inode->i_mapping;
+	loff_t start = iter->pos, pos = start, end;
+	size_t len = min_t(u64, iov_iter_count(i), iomap_length(iter));
+	struct folio_batch fbatch;
+	loff_t old_size = -1;
+	u64 written = 0;
+	unsigned int n;
+
+	len = min(len, max_t(size_t, chunk, IOMAP_WRITE_BATCH_BYTES));
+	/* See the comment about faulting in source pages in the caller */
+	len -= fault_in_iov_iter_readable(i, len);
+	end = start + len;
+
+	folio_batch_init(&fbatch);
+	while (pos < end && folio_batch_space(&fbatch)) {
+		size_t flen = min_t(loff_t, end - pos,
+				    chunk - (pos & (chunk - 1)));
+		struct folio *folio;
+
+		if (!mapping_large_folio_support(mapping))
+			flen = min_t(size_t, flen, PAGE_SIZE - offset_in_page(pos));
+		folio = iomap_get_folio(iter, pos, flen);
+		if (IS_ERR(folio))
+			break;
+		if (folio_pos(folio) != pos ||
+		    folio_pos(folio) + folio_size(folio) > end) {
+			folio_unlock(folio);
+			folio_put(folio);
+			break;
+		}
+		folio_batch_add(&fbatch, folio);
+		pos += folio_size(folio);
+	}
+	if (!folio_batch_count(&fbatch))
+		return 0;
+	end = pos;
+
+	/*
+	 * The mapping is revalidated with all folios locked, which covers
+	 * each of them as iomap_write_begin() does for a single folio.
+	 */
+	if (folio_ops && folio_ops->iomap_valid &&
+	    !folio_ops->iomap_valid(inode, &iter->iomap)) {
+		iter->iomap.flags |= IOMAP_F_STALE;
+		goto out_release;
+	}
+
+	for (n = 0; n < folio_batch_count(&fbatch); n++) {
+		struct folio *folio = fbatch.folios[n];
+		size_t fsize = folio_size(folio);
+		size_t copied;
+
+		if (mapping_writably_mapped(mapping))
+			flush_dcache_folio(folio);
+		copied = copy_folio_from_iter_atomic(folio, 0, fsize, i);
+		if (!__iomap_write_end(inode, start + written, fsize, copied,
+				       folio)) {
+			iov_iter_revert(i, copied);
+			*short_copy = true;
+			break;
+		}
+		written += copied;
+		if (copied < fsize) {
+			*short_copy = true;
+			break;
+		}
+	}
+
+	old_size = inode->i_size;
+	if (start + written > old_size) {
+		i_size_write(inode, start + written);
+		iter->iomap.flags |= IOMAP_F_SIZE_CHANGED;
+	}
+
+out_release:
+	for (n = 0; n < folio_batch_count(&fbatch); n++)
+		folio_unlock(fbatch.folios[n]);
+	folio_batch_release(&fbatch);
+
+	if (old_size < 0)
+		return 0;
+	if (old_size < start)
+		pagecache_isize_extended(inode, old_size, start);
+	if (*short_copy)
+		iomap_write_failed(inode, start + written, end - start - written);
+	if (written)
+		iomap_iter_advance(iter, &written);
+	return written;
+}
+
 static int iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 {
 	ssize_t total_written = 0;
@@ -942,6 +1061,7 @@ static int iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 	struct address_space *mapping = iter->inode->i_mapping;
 	size_t chunk = mapping_max_folio_size(mapping);
 	unsigned int bdp_flags = (iter->flags & IOMAP_NOWAIT) ? BDP_ASYNC : 0;
+	bool batch = iomap_write_can_batch(iter);
 
 	do {
 		struct folio *folio;
@@ -950,16 +1070,46 @@ static int iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 		u64 bytes;		/* Bytes to write to folio */
 		size_t copied;		/* Bytes copied from user */
 		u64 written;		/* Bytes have been written */
+		bool balanced = false;	/* Dirty pages already balanced */
 		loff_t pos;
 
+		if (batch) {
+			bool short_copy = false;
+
+			/* iomap_write_begin() checks this for single folios */
+			if (fatal_signal_pending(current)) {
+				status = -EINTR;
+				break;
+			}
+			status = balance_dirty_pages_ratelimited_flags(mapping,
+								       bdp_flags);
+			if (unlikely(status))
+				break;
+			balanced = true;
+			written = iomap_write_batch(iter, i, chunk, &short_copy);
+			if (iter->iomap.flags & IOMAP_F_STALE)
+				break;
+			/* Let the single folio path deal with short copies */
+			if (short_copy)
+				batch = false;
+			if (written) {
+				total_written += written;
+				cond_resched();
+				continue;
+			}
+		}
+
 		bytes = iov_iter_count(i);
 retry:
 		offset = iter->pos & (chunk - 1);
 		bytes = min(chunk - offset, bytes);
-		status = balance_dirty_pages_ratelimited_flags(mapping,
-							       bdp_flags);
-		if (unlikely(status))
-			break;
+		if (!balanced) {
+			status = balance_dirty_pages_ratelimited_flags(mapping,
+								       bdp_flags);
+			if (unlikely(status))
+				break;
+		}
+		balanced = false;
 
 		if (bytes > iomap_length(iter))
 			bytes = iomap_length(iter);
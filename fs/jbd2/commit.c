@@ -177,6 +177,29 @@ static int journal_wait_on_commit_record(journal_t *journal,
 	return ret;
 }
 
+static void journal_fs_flush_end_io(struct bio *bio)
+{
+	complete(bio->bi_private);
+}
+
+/*
+ * Start a cache flush of the filesystem device of an external journal.
+ * The flush only has to be complete before the commit record is written,
+ * so it can run while we wait for the log blocks of the transaction.
+ */
+static struct bio *journal_submit_fs_flush(journal_t *journal,
+					   struct completion *done)
+{
+	struct bio *bio;
+
+	bio = bio_alloc(journal->j_fs_dev, 0, REQ_OP_WRITE | REQ_PREFLUSH,
+			GFP_NOFS);
+	bio->bi_private = done;
+	bio->bi_end_io = journal_fs_flush_end_io;
+	submit_bio(bio);
+	return bio;
+}
+
 /* Send all the data buffers related to an inode */
 int jbd2_submit_inode_data(journal_t *journal, struct jbd2_inode *jinode)
 {
@@ -368,6 +391,8 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	struct buffer_head *cbh = NULL; /* For transactional checksums */
 	__u32 crc32_sum = ~0;
 	struct blk_plug plug;
+	DECLARE_COMPLETION_ONSTACK(fs_flush_done);
+	struct bio *fs_flush = NULL;
 	/* Tail of the journal */
 	unsigned long first_block;
 	tid_t first_tid;
@@ -771,11 +796,18 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	 * If the journal is not located on the file system device,
 	 * then we must flush the file system device before we issue
 	 * the commit record and update the journal tail sequence.
+	 * Without async commit the commit record is only written once
+	 * the log blocks are done, so let the flush overlap with them.
 	 */
 	if ((commit_transaction->t_need_data_flush || update_tail) &&
 	    (journal->j_fs_dev != journal->j_dev) &&
-	    (journal->j_flags & JBD2_BARRIER))
-		blkdev_issue_flush(journal->j_fs_dev);
+	    (journal->j_flags & JBD2_BARRIER)) {
+		if (jbd2_has_feature_async_commit(journal))
+			blkdev_issue_flush(journal->j_fs_dev);
+		else
+			fs_flush = journal_submit_fs_flush(journal,
+							   &fs_flush_done);
+	}
 
 	/* Done it all: now write the commit record asynchronously. */
 	if (jbd2_has_feature_async_commit(journal)) {
@@ -871,6 +903,11 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	commit_transaction->t_state = T_COMMIT_JFLUSH;
 	write_unlock(&journal->j_state_lock);
 
+	if (fs_flush) {
+		wait_for_completion_io(&fs_flush_done);
+		bio_put(fs_flush);
+	}
+
 	if (!jbd2_has_feature_async_commit(journal)) {
 		err = journal_submit_commit_record(journal, commit_transaction,
 						&cbh, crc32_sum);
@@ -61,6 +61,7 @@
 #include <linux/rcupdate.h>
 #include <linux/pid_namespace.h>
 #include <linux/hashtable.h>
+#include <linux/interval_tree_generic.h>
 #include <linux/percpu.h>
 #include <linux/sysctl.h>
 
@@ -191,6 +192,7 @@ locks_get_lock_context(struct inode *inode, int type)
 	INIT_LIST_HEAD(&ctx->flc_flock);
 	INIT_LIST_HEAD(&ctx->flc_posix);
 	INIT_LIST_HEAD(&ctx->flc_lease);
+	ctx->flc_posix_tree = RB_ROOT_CACHED;
 
 	/*
 	 * Assign the pointer if it's not already assigned. If it is, then
@@ -616,6 +618,17 @@ static struct file_lease *lease_alloc(struct file *filp, int type)
 	return fl;
 }
 
+/*
+ * POSIX locks are also kept in an interval tree, so that conflicts and
+ * the locks of an owner that a request affects are found without walking
+ * all locks of the file.
+ */
+#define posix_lock_start(fl)	((fl)->fl_start)
+#define posix_lock_last(fl)	((fl)->fl_end)
+
+INTERVAL_TREE_DEFINE(struct file_lock, fl_rb, loff_t, fl_subtree_last,
+		     posix_lock_start, posix_lock_last, static, posix_lock_tree)
+
 /* Check if two locks overlap each other.
  */
 static inline int locks_overlap(struct file_lock *fl1, struct file_lock *fl2)
@@ -880,6 +893,30 @@ locks_delete_lock_ctx(struct file_lock_core *fl, struct list_head *dispose)
 		locks_free_lock(file_lock(fl));
 }
 
+static void posix_insert_lock(struct file_lock_context *ctx,
+			      struct file_lock *fl)
+{
+	locks_insert_lock_ctx(&fl->c, &ctx->flc_posix);
+	posix_lock_tree_insert(fl, &ctx->flc_posix_tree);
+}
+
+static void posix_delete_lock(struct file_lock_context *ctx,
+			      struct file_lock *fl, struct list_head *dispose)
+{
+	posix_lock_tree_remove(fl, &ctx->flc_posix_tree);
+	locks_delete_lock_ctx(&fl->c, dispose);
+}
+
+/* Change the range of an applied lock */
+static void posix_set_lock_range(struct file_lock_context *ctx,
+				 struct file_lock *fl, loff_t start, loff_t end)
+{
+	posix_lock_tree_remove(fl, &ctx->flc_posix_tree);
+	fl->fl_start = start;
+	fl->fl_end = end;
+	posix_lock_tree_insert(fl, &ctx->flc_posix_tree);
+}
+
 /* Determine if lock sys_fl blocks lock caller_fl. Common functionality
  * checks for shared/exclusive status of overlapping locks.
  */
@@ -965,7 +1002,9 @@ posix_test_lock(struct file *filp, struct file_lock *fl)
 
 retry:
 	spin_lock(&ctx->flc_lock);
-	list_for_each_entry(cfl, &ctx->flc_posix, c.flc_list) {
+	for (cfl = posix_lock_tree_iter_first(&ctx->flc_posix_tree,
+					      fl->fl_start, fl->fl_end);
+	     cfl; cfl = posix_lock_tree_iter_next(cfl, fl->fl_start, fl->fl_end)) {
 		if (!posix_test_locks_conflict(fl, cfl))
 			continue;
 		if (cfl->fl_lmops && cfl->fl_lmops->lm_lock_expirable
@@ -1143,6 +1182,16 @@ static int flock_lock_inode(struct inode *inode, struct file_lock *request)
 	return error;
 }
 
+/* The next lock from @fl on that has the same owner as @request */
+static struct file_lock *posix_owner_lock(struct file_lock *fl,
+					  struct file_lock *request,
+					  loff_t first, loff_t last)
+{
+	while (fl && !posix_same_owner(&request->c, &fl->c))
+		fl = posix_lock_tree_iter_next(fl, first, last);
+	return fl;
+}
+
 static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 			    struct file_lock *conflock)
 {
@@ -1157,6 +1206,7 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 	LIST_HEAD(dispose);
 	void *owner;
 	void (*func)(void);
+	loff_t first, last, start, end;
 
 	ctx = locks_get_lock_context(inode, request->c.flc_type);
 	if (!ctx)
@@ -1179,12 +1229,16 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 	percpu_down_read(&file_rwsem);
 	spin_lock(&ctx->flc_lock);
 	/*
-	 * New lock request. Walk all POSIX locks and look for conflicts. If
-	 * there are any, either return error or put the request on the
-	 * blocker's list of waiters and the global blocked_hash.
+	 * New lock request. Walk the POSIX locks overlapping it and look for
+	 * conflicts. If there are any, either return error or put the request
+	 * on the blocker's list of waiters and the global blocked_hash.
 	 */
 	if (request->c.flc_type != F_UNLCK) {
-		list_for_each_entry(fl, &ctx->flc_posix, c.flc_list) {
+		for (fl = posix_lock_tree_iter_first(&ctx->flc_posix_tree,
+						     request->fl_start,
+						     request->fl_end);
+		     fl; fl = posix_lock_tree_iter_next(fl, request->fl_start,
+							request->fl_end)) {
 			if (!posix_locks_conflict(&request->c, &fl->c))
 				continue;
 			if (fl->fl_lmops && fl->fl_lmops->lm_lock_expirable
@@ -1229,16 +1283,21 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 	if (request->c.flc_flags & FL_ACCESS)
 		goto out;
 
-	/* Find the first old lock with the same owner as the new lock */
-	list_for_each_entry(fl, &ctx->flc_posix, c.flc_list) {
-		if (posix_same_owner(&request->c, &fl->c))
-			break;
-	}
-
-	/* Process locks with this owner. */
-	list_for_each_entry_safe_from(fl, tmp, &ctx->flc_posix, c.flc_list) {
-		if (!posix_same_owner(&request->c, &fl->c))
-			break;
+	/*
+	 * Process the locks with this owner that overlap or are adjacent to
+	 * the new lock, in order of their start address. The locks of one
+	 * owner never overlap each other, so these are the only ones the new
+	 * lock can affect. Merging only ever grows the new lock over ranges
+	 * of this owner's locks, so the search range stays valid.
+	 */
+	first = request->fl_start - 1;
+	last = request->fl_end == OFFSET_MAX ? OFFSET_MAX : request->fl_end + 1;
+	fl = posix_owner_lock(posix_lock_tree_iter_first(&ctx->flc_posix_tree,
+							 first, last),
+			      request, first, last);
+	for (; fl; fl = tmp) {
+		tmp = posix_owner_lock(posix_lock_tree_iter_next(fl, first, last),
+				       request, first, last);
 
 		/* Detect adjacent or overlapping regions (if same lock type) */
 		if (request->c.flc_type == fl->c.flc_type) {
@@ -1248,8 +1307,8 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 			 */
 			if (fl->fl_end < request->fl_start - 1)
 				continue;
-			/* If the next lock in the list has entirely bigger
-			 * addresses than the new one, insert the lock here.
+			/* If the next lock has entirely bigger addresses
+			 * than the new one, we are done.
 			 */
 			if (fl->fl_start - 1 > request->fl_end)
 				break;
@@ -1259,18 +1318,16 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 			 * lock yielding from the lower start address of both
 			 * locks to the higher end address.
 			 */
-			if (fl->fl_start > request->fl_start)
-				fl->fl_start = request->fl_start;
-			else
-				request->fl_start = fl->fl_start;
-			if (fl->fl_end < request->fl_end)
-				fl->fl_end = request->fl_end;
-			else
-				request->fl_end = fl->fl_end;
+			start = min(fl->fl_start, request->fl_start);
+			end = max(fl->fl_end, request->fl_end);
 			if (added) {
-				locks_delete_lock_ctx(&fl->c, &dispose);
+				posix_delete_lock(ctx, fl, &dispose);
+				posix_set_lock_range(ctx, request, start, end);
 				continue;
 			}
+			request->fl_start = start;
+			request->fl_end = end;
+			posix_set_lock_range(ctx, fl, start, end);
 			request = fl;
 			added = true;
 		} else {
@@ -1285,8 +1342,8 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 				added = true;
 			if (fl->fl_start < request->fl_start)
 				left = fl;
-			/* If the next lock in the list has a higher end
-			 * address than the new one, insert the new one here.
+			/* If the next lock has a higher end address than
+			 * the new one, it is the last one affected.
 			 */
 			if (fl->fl_end > request->fl_end) {
 				right = fl;
@@ -1297,7 +1354,7 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 				 * one (This may happen several times).
 				 */
 				if (added) {
-					locks_delete_lock_ctx(&fl->c, &dispose);
+					posix_delete_lock(ctx, fl, &dispose);
 					continue;
 				}
 				/*
@@ -1314,9 +1371,8 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 				locks_move_blocks(new_fl, request);
 				request = new_fl;
 				new_fl = NULL;
-				locks_insert_lock_ctx(&request->c,
-						      &fl->c.flc_list);
-				locks_delete_lock_ctx(&fl->c, &dispose);
+				posix_insert_lock(ctx, request);
+				posix_delete_lock(ctx, fl, &dispose);
 				added = true;
 			}
 		}
@@ -1345,8 +1401,7 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 		}
 		locks_copy_lock(new_fl, request);
 		locks_move_blocks(new_fl, request);
-		locks_insert_lock_ctx(&new_fl->c, &fl->c.flc_list);
-		fl = new_fl;
+		posix_insert_lock(ctx, new_fl);
 		new_fl = NULL;
 	}
 	if (right) {
@@ -1357,13 +1412,15 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 			left = new_fl2;
 			new_fl2 = NULL;
 			locks_copy_lock(left, right);
-			locks_insert_lock_ctx(&left->c, &fl->c.flc_list);
+			posix_insert_lock(ctx, left);
 		}
-		right->fl_start = request->fl_end + 1;
+		posix_set_lock_range(ctx, right, request->fl_end + 1,
+				     right->fl_end);
 		locks_wake_up_blocks(&right->c);
 	}
 	if (left) {
-		left->fl_end = request->fl_start - 1;
+		posix_set_lock_range(ctx, left, left->fl_start,
+				     request->fl_start - 1);
 		locks_wake_up_blocks(&left->c);
 	}
  out:
@@ -1390,7 +1447,7 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
  *
  * Add a POSIX style lock to a file.
  * We merge adjacent & overlapping locks whenever possible.
- * POSIX locks are sorted by owner task, then by starting address
+ * POSIX locks are indexed by range in an interval tree
  *
  * Note that if called with an FL_EXISTS argument, the caller may determine
  * whether or not a lock was successfully freed by testing the return
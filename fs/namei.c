@@ -2135,9 +2135,13 @@ static const char *walk_component(struct nameidata *nd, int flags)
 	if (IS_ERR(dentry))
 		return ERR_CAST(dentry);
 	if (unlikely(!dentry)) {
+		if (dir_bloom_absent(nd->path.dentry, &nd->last))
+			return ERR_PTR(-ENOENT);
 		dentry = lookup_slow(&nd->last, nd->path.dentry, nd->flags);
 		if (IS_ERR(dentry))
 			return ERR_CAST(dentry);
+		if (d_is_negative(dentry))
+			dir_bloom_build(&nd->path);
 	}
 	if (!(flags & WALK_MORE) && nd->depth)
 		put_link(nd);
@@ -41,7 +41,7 @@ static void netfs_clear_unread(struct netfs_io_subrequest *subreq)
  */
 static void netfs_unlock_read_folio(struct netfs_io_request *rreq,
 				    struct folio_queue *folioq,
-				    int slot)
+				    int slot, bool copy_to_cache)
 {
 	struct netfs_folio *finfo;
 	struct folio *folio = folioq_folio(folioq, slot);
@@ -65,7 +65,7 @@ static void netfs_unlock_read_folio(struct netfs_io_request *rreq,
 			kfree(finfo);
 		}
 
-		if (test_bit(NETFS_RREQ_FOLIO_COPY_TO_CACHE, &rreq->flags)) {
+		if (copy_to_cache) {
 			if (!WARN_ON_ONCE(folio_get_private(folio) != NULL)) {
 				trace_netfs_folio(folio, netfs_folio_trace_copy_to_cache);
 				folio_attach_private(folio, NETFS_FOLIO_COPY_TO_CACHE);
@@ -78,7 +78,7 @@ static void netfs_unlock_read_folio(struct netfs_io_request *rreq,
 		folioq_clear(folioq, slot);
 	} else {
 		// TODO: Use of PG_private_2 is deprecated.
-		if (test_bit(NETFS_RREQ_FOLIO_COPY_TO_CACHE, &rreq->flags))
+		if (copy_to_cache)
 			netfs_pgpriv2_copy_to_cache(rreq, folio);
 	}
 
@@ -95,7 +95,9 @@ static void netfs_unlock_read_folio(struct netfs_io_request *rreq,
 }
 
 /*
- * Unlock any folios we've finished with.
+ * Unlock any folios we've finished with.  The copy-to-cache note covers every
+ * folio collected in this pass, so it's sampled once rather than being set and
+ * cleared in rreq->flags around each folio.
  */
 static void netfs_read_unlock_folios(struct netfs_io_request *rreq,
 				     unsigned int *notes)
@@ -103,6 +105,7 @@ static void netfs_read_unlock_folios(struct netfs_io_request *rreq,
 	struct folio_queue *folioq = rreq->buffer.tail;
 	unsigned long long collected_to = rreq->collected_to;
 	unsigned int slot = rreq->buffer.first_tail_slot;
+	bool copy_to_cache = *notes & COPY_TO_CACHE;
 
 	if (rreq->cleaned_to >= rreq->collected_to)
 		return;
@@ -124,9 +127,6 @@ static void netfs_read_unlock_folios(struct netfs_io_request *rreq,
 		unsigned int order;
 		size_t fsize;
 
-		if (*notes & COPY_TO_CACHE)
-			set_bit(NETFS_RREQ_FOLIO_COPY_TO_CACHE, &rreq->flags);
-
 		folio = folioq_folio(folioq, slot);
 		if (WARN_ONCE(!folio_test_locked(folio),
 			      "R=%08x: folio %lx is not locked\n",
@@ -145,12 +145,10 @@ static void netfs_read_unlock_folios(struct netfs_io_request *rreq,
 		if (collected_to < fend)
 			break;
 
-		netfs_unlock_read_folio(rreq, folioq, slot);
+		netfs_unlock_read_folio(rreq, folioq, slot, copy_to_cache);
 		WRITE_ONCE(rreq->cleaned_to, fpos + fsize);
 		*notes |= MADE_PROGRESS;
 
-		clear_bit(NETFS_RREQ_FOLIO_COPY_TO_CACHE, &rreq->flags);
-
 		/* Clean up the head folioq.  If we clear an entire folioq, then
 		 * we can get rid of it provided it's not also the tail folioq
 		 * being filled by the issuer.
@@ -32,6 +32,8 @@ enum {
 	NFSD_STATS_PAYLOAD_MISSES,
 	/* amount of memory (in bytes) currently consumed by the DRC */
 	NFSD_STATS_DRC_MEM_USAGE,
+	/* number of entries currently in the DRC */
+	NFSD_STATS_DRC_ENTRIES,
 	NFSD_STATS_RC_HITS,		/* repcache hits */
 	NFSD_STATS_RC_MISSES,		/* repcache misses */
 	NFSD_STATS_RC_NOCACHE,		/* uncached reqs */
@@ -173,9 +175,6 @@ struct nfsd_net {
 	 * these statistics to be completely accurate.
 	 */
 
-	/* total number of entries */
-	atomic_t                 num_drc_entries;
-
 	/* Per-netns stats counters */
 	struct percpu_counter    counter[NFSD_STATS_COUNTERS_NUM];
 
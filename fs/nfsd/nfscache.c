@@ -141,7 +141,7 @@ nfsd_cacherep_unlink_locked(struct nfsd_net *nn, struct nfsd_drc_bucket *b,
 	if (rp->c_state != RC_UNUSED) {
 		rb_erase(&rp->c_node, &b->rb_head);
 		list_del(&rp->c_lru);
-		atomic_dec(&nn->num_drc_entries);
+		nfsd_stats_drc_entries_dec(nn);
 		nfsd_stats_drc_mem_usage_sub(nn, sizeof(*rp));
 	}
 }
@@ -181,7 +181,7 @@ int nfsd_reply_cache_init(struct nfsd_net *nn)
 	unsigned int i;
 
 	nn->max_drc_entries = nfsd_cache_size_limit();
-	atomic_set(&nn->num_drc_entries, 0);
+	percpu_counter_set(&nn->counter[NFSD_STATS_DRC_ENTRIES], 0);
 	hashsize = nfsd_hashsize(nn->max_drc_entries);
 	nn->maskbits = ilog2(hashsize);
 
@@ -279,7 +279,7 @@ nfsd_prune_bucket_locked(struct nfsd_net *nn, struct nfsd_drc_bucket *b,
 		if (rp->c_state == RC_INPROG)
 			continue;
 
-		if (atomic_read(&nn->num_drc_entries) <= nn->max_drc_entries &&
+		if (nfsd_stats_drc_entries(nn) <= nn->max_drc_entries &&
 		    time_before(expiry, rp->c_timestamp))
 			break;
 
@@ -306,7 +306,7 @@ nfsd_reply_cache_count(struct shrinker *shrink, struct shrink_control *sc)
 {
 	struct nfsd_net *nn = shrink->private_data;
 
-	return atomic_read(&nn->num_drc_entries);
+	return nfsd_stats_drc_entries(nn);
 }
 
 /**
@@ -443,15 +443,21 @@ nfsd_cache_insert(struct nfsd_drc_bucket *b, struct nfsd_cacherep *key,
 	rb_link_node(&key->c_node, parent, p);
 	rb_insert_color(&key->c_node, &b->rb_head);
 out:
-	/* tally hash chain length stats */
-	if (entries > nn->longest_chain) {
-		nn->longest_chain = entries;
-		nn->longest_chain_cachesize = atomic_read(&nn->num_drc_entries);
-	} else if (entries == nn->longest_chain) {
-		/* prefer to keep the smallest cachesize possible here */
-		nn->longest_chain_cachesize = min_t(unsigned int,
-				nn->longest_chain_cachesize,
-				atomic_read(&nn->num_drc_entries));
+	/*
+	 * Tally hash chain length stats. These are shared by all buckets, so
+	 * only write them when they change to keep the cacheline from
+	 * bouncing between CPUs on every lookup.
+	 */
+	if (entries >= READ_ONCE(nn->longest_chain)) {
+		unsigned int cachesize = nfsd_stats_drc_entries(nn);
+
+		if (entries > nn->longest_chain) {
+			nn->longest_chain = entries;
+			nn->longest_chain_cachesize = cachesize;
+		} else if (cachesize < nn->longest_chain_cachesize) {
+			/* prefer to keep the smallest cachesize possible here */
+			nn->longest_chain_cachesize = cachesize;
+		}
 	}
 
 	lru_put_end(b, ret);
@@ -515,7 +521,7 @@ int nfsd_cache_lookup(struct svc_rqst *rqstp, unsigned int start,
 	nfsd_cacherep_dispose(&dispose);
 
 	nfsd_stats_rc_misses_inc(nn);
-	atomic_inc(&nn->num_drc_entries);
+	nfsd_stats_drc_entries_inc(nn);
 	nfsd_stats_drc_mem_usage_add(nn, sizeof(*rp));
 	goto out;
 
@@ -660,8 +666,8 @@ int nfsd_reply_cache_stats_show(struct seq_file *m, void *v)
 					  nfsd_net_id);
 
 	seq_printf(m, "max entries:           %u\n", nn->max_drc_entries);
-	seq_printf(m, "num entries:           %u\n",
-		   atomic_read(&nn->num_drc_entries));
+	seq_printf(m, "num entries:           %lld\n",
+		   percpu_counter_sum_positive(&nn->counter[NFSD_STATS_DRC_ENTRIES]));
 	seq_printf(m, "hash buckets:          %u\n", 1 << nn->maskbits);
 	seq_printf(m, "mem usage:             %lld\n",
 		   percpu_counter_sum_positive(&nn->counter[NFSD_STATS_DRC_MEM_USAGE]));
@@ -67,6 +67,25 @@ static inline void nfsd_stats_drc_mem_usage_sub(struct nfsd_net *nn, s64 amount)
 	percpu_counter_sub(&nn->counter[NFSD_STATS_DRC_MEM_USAGE], amount);
 }
 
+static inline void nfsd_stats_drc_entries_inc(struct nfsd_net *nn)
+{
+	percpu_counter_inc(&nn->counter[NFSD_STATS_DRC_ENTRIES]);
+}
+
+static inline void nfsd_stats_drc_entries_dec(struct nfsd_net *nn)
+{
+	percpu_counter_dec(&nn->counter[NFSD_STATS_DRC_ENTRIES]);
+}
+
+/*
+ * Approximate, but cheap enough for the request path. The error is bounded
+ * by the percpu batch size, which is negligible against the cache size.
+ */
+static inline unsigned int nfsd_stats_drc_entries(struct nfsd_net *nn)
+{
+	return percpu_counter_read_positive(&nn->counter[NFSD_STATS_DRC_ENTRIES]);
+}
+
 #ifdef CONFIG_NFSD_V4
 static inline void nfsd_stats_wdeleg_getattr_inc(struct nfsd_net *nn)
 {
@@ -974,23 +974,25 @@ nfsd_splice_actor(struct pipe_inode_info *pipe, struct pipe_buffer *buf,
 {
 	struct svc_rqst *rqstp = sd->u.data;
 	struct page *page = buf->page;	// may be a compound one
-	unsigned offset = buf->offset;
+	unsigned offset = buf->offset;	// may be beyond the first page
 	struct page *last_page;
 
 	last_page = page + (offset + sd->len - 1) / PAGE_SIZE;
-	for (page += offset / PAGE_SIZE; page <= last_page; page++) {
-		/*
-		 * Skip page replacement when extending the contents of the
-		 * current page.  But note that we may get two zero_pages in a
-		 * row from shmem.
-		 */
-		if (page == *(rqstp->rq_next_page - 1) &&
-		    offset_in_page(rqstp->rq_res.page_base +
-				   rqstp->rq_res.page_len))
-			continue;
-		if (unlikely(!svc_rqst_replace_page(rqstp, page)))
-			return -EIO;
-	}
+	page += offset / PAGE_SIZE;
+	/*
+	 * Skip page replacement when extending the contents of the
+	 * current page.  But note that we may get two zero_pages in a
+	 * row from shmem.
+	 */
+	if (page == *(rqstp->rq_next_page - 1) &&
+	    offset_in_page(rqstp->rq_res.page_base +
+			   rqstp->rq_res.page_len))
+		page++;
+	/* The remaining pages all belong to the folio of the pipe buffer */
+	if (page <= last_page &&
+	    unlikely(!svc_rqst_replace_pages(rqstp, page,
+					     last_page - page + 1)))
+		return -EIO;
 	if (rqstp->rq_res.page_len == 0)	// first call
 		rqstp->rq_res.page_base = offset % PAGE_SIZE;
 	rqstp->rq_res.page_len += sd->len;
@@ -1053,6 +1055,8 @@ __be32 nfsd_splice_read(struct svc_rqst *rqstp, struct svc_fh *fhp,
 		.total_len	= *count,
 		.pos		= offset,
 		.u.data		= rqstp,
+		/* nfsd_splice_actor() maps every page of a buffer */
+		.large_bufs	= true,
 	};
 	ssize_t host_err;
 
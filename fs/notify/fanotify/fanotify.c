@@ -996,6 +996,8 @@ static int fanotify_handle_event(struct fsnotify_group *group, u32 mask,
 		fsnotify_destroy_event(group, fsn_event);
 
 		ret = 0;
+	} else if (group->fanotify_data.ring) {
+		fanotify_ring_queued(group);
 	} else if (fanotify_is_perm_event(mask)) {
 		ret = fanotify_get_response(group, FANOTIFY_PERM(event),
 					    iter_info);
@@ -1009,6 +1011,7 @@ static int fanotify_handle_event(struct fsnotify_group *group, u32 mask,
 
 static void fanotify_free_group_priv(struct fsnotify_group *group)
 {
+	fanotify_ring_free(group);
 	put_user_ns(group->user_ns);
 	kfree(group->fanotify_data.merge_hash);
 	if (group->fanotify_data.ucounts)
@@ -550,3 +550,6 @@ static inline u32 fanotify_get_response_errno(int res)
 {
 	return (res >> FAN_ERRNO_SHIFT) & FAN_ERRNO_MASK;
 }
+
+void fanotify_ring_queued(struct fsnotify_group *group);
+void fanotify_ring_free(struct fsnotify_group *group);
@@ -19,6 +19,10 @@
 #include <linux/memcontrol.h>
 #include <linux/statfs.h>
 #include <linux/exportfs.h>
+#include <linux/pid_namespace.h>
+#include <linux/sizes.h>
+#include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 
 #include <asm/ioctls.h>
 
@@ -30,6 +34,9 @@
 #define FANOTIFY_OLD_DEFAULT_MAX_MARKS	8192
 #define FANOTIFY_DEFAULT_MAX_GROUPS	128
 #define FANOTIFY_DEFAULT_FEE_POOL_SIZE	32
+#define FANOTIFY_DEFAULT_RING_PAGES	256
+/* Ring positions are 32 bit, so keep the data area well below 4G */
+#define FANOTIFY_MAX_RING_PAGES		(SZ_1G >> PAGE_SHIFT)
 
 /*
  * Legacy fanotify marks limits (8192) is per group and we introduced a tunable
@@ -50,6 +57,7 @@
 
 /* configurable via /proc/sys/fs/fanotify/ */
 static int fanotify_max_queued_events __read_mostly;
+static unsigned int fanotify_ring_pages __read_mostly = FANOTIFY_DEFAULT_RING_PAGES;
 
 #ifdef CONFIG_SYSCTL
 
@@ -57,6 +65,7 @@ static int fanotify_max_queued_events __read_mostly;
 
 static long ft_zero = 0;
 static long ft_int_max = INT_MAX;
+static unsigned int ft_ring_pages_max = FANOTIFY_MAX_RING_PAGES;
 
 static const struct ctl_table fanotify_table[] = {
 	{
@@ -85,6 +94,15 @@ static const struct ctl_table fanotify_table[] = {
 		.proc_handler	= proc_dointvec_minmax,
 		.extra1		= SYSCTL_ZERO
 	},
+	{
+		.procname	= "ring_pages",
+		.data		= &fanotify_ring_pages,
+		.maxlen		= sizeof(unsigned int),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec_minmax,
+		.extra1		= SYSCTL_ONE,
+		.extra2		= &ft_ring_pages_max,
+	},
 };
 
 static void __init fanotify_sysctls_init(void)
@@ -594,6 +612,61 @@ static size_t copy_range_info_to_user(struct fanotify_event *event,
 	return info_len;
 }
 
+static int fanotify_dir_fid_info_type(struct fanotify_event *event,
+				      struct fanotify_info *info)
+{
+	/* FAN_RENAME uses special info types */
+	if (event->mask & FAN_RENAME)
+		return FAN_EVENT_INFO_TYPE_OLD_DFID_NAME;
+
+	return info->name_len ? FAN_EVENT_INFO_TYPE_DFID_NAME :
+				FAN_EVENT_INFO_TYPE_DFID;
+}
+
+/*
+ * Info type of the object fid record. @info_type is the type of the
+ * preceding dir fid record, if any. Sets @dot if the name "." is to be
+ * reported with the object fid.
+ */
+static int fanotify_object_fid_info_type(struct fanotify_event *event,
+					 unsigned int fid_mode, int info_type,
+					 bool *dot)
+{
+	*dot = false;
+
+	if (fid_mode == FAN_REPORT_FID || info_type) {
+		/*
+		 * With only group flag FAN_REPORT_FID only type FID is
+		 * reported. Second info record type is always FID.
+		 */
+		return FAN_EVENT_INFO_TYPE_FID;
+	} else if ((fid_mode & FAN_REPORT_NAME) &&
+		   (event->mask & FAN_ONDIR)) {
+		/*
+		 * With group flag FAN_REPORT_NAME, if name was not
+		 * recorded in an event on a directory, report the name
+		 * "." with info type DFID_NAME.
+		 */
+		*dot = true;
+		return FAN_EVENT_INFO_TYPE_DFID_NAME;
+	} else if ((event->mask & ALL_FSNOTIFY_DIRENT_EVENTS) ||
+		   (event->mask & FAN_ONDIR)) {
+		/*
+		 * With group flag FAN_REPORT_DIR_FID, a single info
+		 * record has type DFID for directory entry modification
+		 * event and for event on a directory.
+		 */
+		return FAN_EVENT_INFO_TYPE_DFID;
+	}
+	/*
+	 * With group flags FAN_REPORT_DIR_FID|FAN_REPORT_FID,
+	 * a single info record has type FID for event on a
+	 * non-directory, when there is no directory to report.
+	 * For example, on FAN_DELETE_SELF event.
+	 */
+	return FAN_EVENT_INFO_TYPE_FID;
+}
+
 static int copy_info_records_to_user(struct fanotify_event *event,
 				     struct fanotify_info *info,
 				     unsigned int info_mode, int pidfd,
@@ -610,13 +683,7 @@ static int copy_info_records_to_user(struct fanotify_event *event,
 	 * 3. (optional) child fid
 	 */
 	if (fanotify_event_has_dir_fh(event)) {
-		info_type = info->name_len ? FAN_EVENT_INFO_TYPE_DFID_NAME :
-					     FAN_EVENT_INFO_TYPE_DFID;
-
-		/* FAN_RENAME uses special info types */
-		if (event->mask & FAN_RENAME)
-			info_type = FAN_EVENT_INFO_TYPE_OLD_DFID_NAME;
-
+		info_type = fanotify_dir_fid_info_type(event, info);
 		ret = copy_fid_info_to_user(fanotify_event_fsid(event),
 					    fanotify_info_dir_fh(info),
 					    info_type,
@@ -647,46 +714,13 @@ static int copy_info_records_to_user(struct fanotify_event *event,
 	}
 
 	if (fanotify_event_has_object_fh(event)) {
-		const char *dot = NULL;
-		int dot_len = 0;
-
-		if (fid_mode == FAN_REPORT_FID || info_type) {
-			/*
-			 * With only group flag FAN_REPORT_FID only type FID is
-			 * reported. Second info record type is always FID.
-			 */
-			info_type = FAN_EVENT_INFO_TYPE_FID;
-		} else if ((fid_mode & FAN_REPORT_NAME) &&
-			   (event->mask & FAN_ONDIR)) {
-			/*
-			 * With group flag FAN_REPORT_NAME, if name was not
-			 * recorded in an event on a directory, report the name
-			 * "." with info type DFID_NAME.
-			 */
-			info_type = FAN_EVENT_INFO_TYPE_DFID_NAME;
-			dot = ".";
-			dot_len = 1;
-		} else if ((event->mask & ALL_FSNOTIFY_DIRENT_EVENTS) ||
-			   (event->mask & FAN_ONDIR)) {
-			/*
-			 * With group flag FAN_REPORT_DIR_FID, a single info
-			 * record has type DFID for directory entry modification
-			 * event and for event on a directory.
-			 */
-			info_type = FAN_EVENT_INFO_TYPE_DFID;
-		} else {
-			/*
-			 * With group flags FAN_REPORT_DIR_FID|FAN_REPORT_FID,
-			 * a single info record has type FID for event on a
-			 * non-directory, when there is no directory to report.
-			 * For example, on FAN_DELETE_SELF event.
-			 */
-			info_type = FAN_EVENT_INFO_TYPE_FID;
-		}
+		bool dot;
 
+		info_type = fanotify_object_fid_info_type(event, fid_mode,
+							  info_type, &dot);
 		ret = copy_fid_info_to_user(fanotify_event_fsid(event),
 					    fanotify_event_object_fh(event),
-					    info_type, dot, dot_len,
+					    info_type, dot ? "." : NULL, dot,
 					    buf, count);
 		if (ret < 0)
 			return ret;
@@ -877,13 +911,296 @@ static ssize_t copy_event_to_user(struct fsnotify_group *group,
 	return ret;
 }
 
+/*
+ * FAN_RING_BUFFER groups queue events in the notification queue as usual,
+ * where new events are merged into queued events of the same object. The
+ * queue is moved into the ring FANOTIFY_RING_DELAY after it became
+ * non-empty or whenever the listener polls, so events arriving close
+ * together are merged before user space sees them.
+ */
+#define FANOTIFY_RING_DELAY	1
+/* Retry interval while the consumer has not made room in the ring */
+#define FANOTIFY_RING_RETRY	msecs_to_jiffies(10)
+
+struct fanotify_ring {
+	struct fsnotify_group	*group;
+	/* pid namespace of the listener for reporting event->pid */
+	struct pid_namespace	*pid_ns;
+	struct delayed_work	flush_work;
+	struct fanotify_ring_header *consumer;
+	struct fanotify_ring_header *producer;
+	void			*data;
+	u32			mask;
+	void			*vaddr;
+	struct page		**pages;
+	unsigned int		nr_pages;
+};
+
+static size_t fanotify_ring_fill_fid(void *buf, __kernel_fsid_t *fsid,
+				     struct fanotify_fh *fh, int info_type,
+				     const char *name, size_t name_len)
+{
+	struct fanotify_event_info_fid *info = buf;
+	struct file_handle *handle = (struct file_handle *)info->handle;
+	size_t fh_len = fh->len;
+
+	info->hdr.info_type = info_type;
+	info->hdr.len = fanotify_fid_info_len(fh_len, name_len);
+	info->fsid = *fsid;
+	handle->handle_type = fh_len ? fh->type : FILEID_INVALID;
+	handle->handle_bytes = fh_len;
+	memcpy(handle->f_handle, fanotify_fh_buf(fh), fh_len);
+	/* The terminating null and the padding are already zero */
+	if (name_len)
+		memcpy(handle->f_handle + fh_len, name, name_len);
+
+	return info->hdr.len;
+}
+
+/* Same format as copy_event_to_user(), @buf is zeroed */
+static void fanotify_ring_fill_event(struct fanotify_ring *ring,
+				     struct fanotify_event *event,
+				     void *buf, size_t len)
+{
+	struct fsnotify_group *group = ring->group;
+	struct fanotify_event_metadata *metadata = buf;
+	struct fanotify_info *info = fanotify_event_info(event);
+	unsigned int fid_mode = FAN_GROUP_FLAG(group, FANOTIFY_FID_BITS);
+	void *start = buf;
+	int info_type = 0;
+
+	metadata->event_len = len;
+	metadata->metadata_len = FAN_EVENT_METADATA_LEN;
+	metadata->vers = FANOTIFY_METADATA_VERSION;
+	metadata->mask = event->mask & FANOTIFY_OUTGOING_EVENTS;
+	metadata->fd = FAN_NOFD;
+	metadata->pid = pid_nr_ns(event->pid, ring->pid_ns);
+	buf += FAN_EVENT_METADATA_LEN;
+
+	if (fanotify_event_has_dir_fh(event)) {
+		info_type = fanotify_dir_fid_info_type(event, info);
+		buf += fanotify_ring_fill_fid(buf, fanotify_event_fsid(event),
+					      fanotify_info_dir_fh(info),
+					      info_type,
+					      fanotify_info_name(info),
+					      info->name_len);
+	}
+
+	if (fanotify_event_has_dir2_fh(event)) {
+		info_type = FAN_EVENT_INFO_TYPE_NEW_DFID_NAME;
+		buf += fanotify_ring_fill_fid(buf, fanotify_event_fsid(event),
+					      fanotify_info_dir2_fh(info),
+					      info_type,
+					      fanotify_info_name2(info),
+					      info->name2_len);
+	}
+
+	if (fanotify_event_has_object_fh(event)) {
+		bool dot;
+
+		info_type = fanotify_object_fid_info_type(event, fid_mode,
+							  info_type, &dot);
+		buf += fanotify_ring_fill_fid(buf, fanotify_event_fsid(event),
+					      fanotify_event_object_fh(event),
+					      info_type, dot ? "." : NULL, dot);
+	}
+
+	if (fanotify_is_error_event(event->mask)) {
+		struct fanotify_event_info_error *err = buf;
+
+		err->hdr.info_type = FAN_EVENT_INFO_TYPE_ERROR;
+		err->hdr.len = FANOTIFY_ERROR_INFO_LEN;
+		err->error = FANOTIFY_EE(event)->error;
+		err->error_count = FANOTIFY_EE(event)->err_count;
+		buf += FANOTIFY_ERROR_INFO_LEN;
+	}
+
+	WARN_ON_ONCE(buf - start != len);
+}
+
+/*
+ * Move queued events into the ring while there is room for them.
+ * Returns true if events are left in the notification queue.
+ */
+static bool fanotify_ring_flush(struct fanotify_ring *ring)
+{
+	struct fsnotify_group *group = ring->group;
+	unsigned int info_mode = FAN_GROUP_FLAG(group, FANOTIFY_INFO_MODES);
+	struct fsnotify_event *fsn_event, *next;
+	u32 size = ring->mask + 1;
+	u32 cons, prod, start;
+	LIST_HEAD(done);
+	bool pending;
+
+	spin_lock(&group->notification_lock);
+	/* Written by user space, so only used to bound the free space */
+	cons = smp_load_acquire(&ring->consumer->pos);
+	prod = start = ring->producer->pos;
+	while ((fsn_event = fsnotify_peek_first_event(group))) {
+		struct fanotify_event *event = FANOTIFY_E(fsn_event);
+		size_t len = fanotify_event_len(info_mode, event);
+		u32 rlen = round_up(len, FAN_RING_ALIGN);
+		void *buf = ring->data + (prod & ring->mask);
+
+		if (prod - cons > size || rlen > size - (prod - cons))
+			break;
+
+		fsnotify_remove_first_event(group);
+		if (fanotify_is_hashed_event(event->mask))
+			fanotify_unhash_event(group, event);
+
+		memset(buf, 0, rlen);
+		fanotify_ring_fill_event(ring, event, buf, len);
+		prod += rlen;
+		list_add_tail(&fsn_event->list, &done);
+	}
+	/* Pairs with the consumer's load-acquire of producer_pos */
+	if (prod != start)
+		smp_store_release(&ring->producer->pos, prod);
+	pending = !fsnotify_notify_queue_is_empty(group);
+	spin_unlock(&group->notification_lock);
+
+	list_for_each_entry_safe(fsn_event, next, &done, list) {
+		list_del_init(&fsn_event->list);
+		fsnotify_destroy_event(group, fsn_event);
+	}
+	if (prod != start)
+		wake_up(&group->notification_waitq);
+
+	return pending;
+}
+
+static void fanotify_ring_workfn(struct work_struct *work)
+{
+	struct fanotify_ring *ring = container_of(to_delayed_work(work),
+						  struct fanotify_ring,
+						  flush_work);
+
+	if (fanotify_ring_flush(ring))
+		queue_delayed_work(system_unbound_wq, &ring->flush_work,
+				   FANOTIFY_RING_RETRY);
+}
+
+/* Called after an event was queued on a FAN_RING_BUFFER group */
+void fanotify_ring_queued(struct fsnotify_group *group)
+{
+	queue_delayed_work(system_unbound_wq,
+			   &group->fanotify_data.ring->flush_work,
+			   FANOTIFY_RING_DELAY);
+}
+
+static int fanotify_ring_alloc(struct fsnotify_group *group)
+{
+	unsigned int nr_data = roundup_pow_of_two(READ_ONCE(fanotify_ring_pages));
+	struct fanotify_ring *ring;
+	unsigned int i;
+
+	ring = kzalloc(sizeof(*ring), GFP_KERNEL_ACCOUNT);
+	if (!ring)
+		return -ENOMEM;
+
+	/* The data pages are mapped twice so that records never wrap */
+	ring->nr_pages = FAN_RING_PRODUCER_PGOFF + 1 + nr_data;
+	ring->pages = kvcalloc(ring->nr_pages + nr_data, sizeof(*ring->pages),
+			       GFP_KERNEL_ACCOUNT);
+	if (!ring->pages)
+		goto out_free;
+	for (i = 0; i < ring->nr_pages; i++) {
+		ring->pages[i] = alloc_page(GFP_KERNEL_ACCOUNT | __GFP_ZERO |
+					    __GFP_NOWARN);
+		if (!ring->pages[i])
+			goto out_free;
+	}
+	for (i = 0; i < nr_data; i++)
+		ring->pages[ring->nr_pages + i] = ring->pages[ring->nr_pages - nr_data + i];
+
+	ring->vaddr = vmap(ring->pages, ring->nr_pages + nr_data,
+			   VM_MAP | VM_USERMAP, PAGE_KERNEL);
+	if (!ring->vaddr)
+		goto out_free;
+
+	ring->consumer = ring->vaddr + FAN_RING_CONSUMER_PGOFF * PAGE_SIZE;
+	ring->producer = ring->vaddr + FAN_RING_PRODUCER_PGOFF * PAGE_SIZE;
+	ring->data = ring->vaddr + (FAN_RING_PRODUCER_PGOFF + 1) * PAGE_SIZE;
+	ring->mask = nr_data * PAGE_SIZE - 1;
+	ring->consumer->data_size = ring->mask + 1;
+	ring->producer->data_size = ring->mask + 1;
+
+	ring->group = group;
+	ring->pid_ns = get_pid_ns(task_active_pid_ns(current));
+	INIT_DELAYED_WORK(&ring->flush_work, fanotify_ring_workfn);
+	group->fanotify_data.ring = ring;
+	return 0;
+
+out_free:
+	for (i = 0; ring->pages && i < ring->nr_pages && ring->pages[i]; i++)
+		__free_page(ring->pages[i]);
+	kvfree(ring->pages);
+	kfree(ring);
+	return -ENOMEM;
+}
+
+/*
+ * Called when the group is freed, after all event handlers are done.
+ * Pages that are still mapped by user space stay around until unmapped.
+ */
+void fanotify_ring_free(struct fsnotify_group *group)
+{
+	struct fanotify_ring *ring = group->fanotify_data.ring;
+	unsigned int i;
+
+	if (!ring)
+		return;
+
+	cancel_delayed_work_sync(&ring->flush_work);
+	vunmap(ring->vaddr);
+	for (i = 0; i < ring->nr_pages; i++)
+		__free_page(ring->pages[i]);
+	kvfree(ring->pages);
+	put_pid_ns(ring->pid_ns);
+	kfree(ring);
+}
+
+static int fanotify_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct fsnotify_group *group = file->private_data;
+	struct fanotify_ring *ring = group->fanotify_data.ring;
+
+	if (!ring)
+		return -ENODEV;
+	if (!(vma->vm_flags & VM_SHARED))
+		return -EINVAL;
+
+	if (vma->vm_flags & VM_WRITE) {
+		/* Only the consumer position may be written by user space */
+		if (vma->vm_pgoff != FAN_RING_CONSUMER_PGOFF ||
+		    vma_pages(vma) != 1)
+			return -EPERM;
+	} else {
+		vm_flags_clear(vma, VM_MAYWRITE);
+	}
+
+	/* remap_vmalloc_range() checks size and offset constraints */
+	return remap_vmalloc_range(vma, ring->vaddr, vma->vm_pgoff);
+}
+
 /* intofiy userspace file descriptor functions */
 static __poll_t fanotify_poll(struct file *file, poll_table *wait)
 {
 	struct fsnotify_group *group = file->private_data;
+	struct fanotify_ring *ring = group->fanotify_data.ring;
 	__poll_t ret = 0;
 
 	poll_wait(file, &group->notification_waitq, wait);
+	if (ring) {
+		/* Do not make a listener that is waiting wait for the merge delay */
+		fanotify_ring_flush(ring);
+		if (smp_load_acquire(&ring->producer->pos) !=
+		    READ_ONCE(ring->consumer->pos))
+			ret = EPOLLIN | EPOLLRDNORM;
+		return ret;
+	}
+
 	spin_lock(&group->notification_lock);
 	if (!fsnotify_notify_queue_is_empty(group))
 		ret = EPOLLIN | EPOLLRDNORM;
@@ -906,6 +1223,10 @@ static ssize_t fanotify_read(struct file *file, char __user *buf,
 
 	pr_debug("%s: group=%p\n", __func__, group);
 
+	/* Events of a ring buffer group are only delivered through the ring */
+	if (group->fanotify_data.ring)
+		return -EINVAL;
+
 	add_wait_queue(&group->notification_waitq, &wait);
 	while (1) {
 		/*
@@ -1085,6 +1406,7 @@ static const struct file_operations fanotify_fops = {
 	.poll		= fanotify_poll,
 	.read		= fanotify_read,
 	.write		= fanotify_write,
+	.mmap		= fanotify_mmap,
 	.fasync		= NULL,
 	.release	= fanotify_release,
 	.unlocked_ioctl	= fanotify_ioctl,
@@ -1552,6 +1874,14 @@ SYSCALL_DEFINE2(fanotify_init, unsigned int, flags, unsigned int, event_f_flags)
 			return -EINVAL;
 	}
 
+	/*
+	 * Events are written to the ring from the kernel, there is no reader
+	 * to install file descriptors for, so report file handles instead.
+	 */
+	if ((flags & FAN_RING_BUFFER) &&
+	    (!fid_mode || (flags & FAN_REPORT_PIDFD)))
+		return -EINVAL;
+
 	if (event_f_flags & ~FANOTIFY_INIT_ALL_EVENT_F_BITS)
 		return -EINVAL;
 
@@ -1620,6 +1950,12 @@ SYSCALL_DEFINE2(fanotify_init, unsigned int, flags, unsigned int, event_f_flags)
 		goto out_destroy_group;
 	}
 
+	if (flags & FAN_RING_BUFFER) {
+		fd = fanotify_ring_alloc(group);
+		if (fd)
+			goto out_destroy_group;
+	}
+
 	if (force_o_largefile())
 		event_f_flags |= O_LARGEFILE;
 	group->fanotify_data.f_flags = event_f_flags;
@@ -2105,7 +2441,7 @@ static int __init fanotify_user_setup(void)
 				     FANOTIFY_DEFAULT_MAX_USER_MARKS);
 
 	BUILD_BUG_ON(FANOTIFY_INIT_FLAGS & FANOTIFY_INTERNAL_GROUP_FLAGS);
-	BUILD_BUG_ON(HWEIGHT32(FANOTIFY_INIT_FLAGS) != 14);
+	BUILD_BUG_ON(HWEIGHT32(FANOTIFY_INIT_FLAGS) != 15);
 	BUILD_BUG_ON(HWEIGHT32(FANOTIFY_MARK_FLAGS) != 11);
 
 	fanotify_mark_cache = KMEM_CACHE(fanotify_mark,
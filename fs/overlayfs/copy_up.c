@@ -269,6 +269,7 @@ static int ovl_copy_up_file(struct ovl_fs *ofs, struct dentry *dentry,
 	loff_t data_pos = -1;
 	loff_t hole_len;
 	bool skip_hole = false;
+	bool try_copy_range = true;
 	int error = 0;
 
 	ovl_path_lowerdata(dentry, &datapath);
@@ -346,6 +347,25 @@ static int ovl_copy_up_file(struct ovl_fs *ofs, struct dentry *dentry,
 		if (error)
 			break;
 
+		/*
+		 * The whole file clone above fails if any part of the range
+		 * cannot be shared, and filesystems like nfs, cifs or fuse
+		 * can copy without moving the data through the page cache.
+		 * Let ->copy_file_range() or a partial clone handle each chunk
+		 * and only splice once the filesystems cannot do that.
+		 */
+		if (try_copy_range) {
+			bytes = vfs_copy_file_range(old_file, old_pos, new_file,
+						    new_pos, this_len, 0);
+			if (bytes > 0) {
+				old_pos += bytes;
+				new_pos += bytes;
+				len -= bytes;
+				continue;
+			}
+			try_copy_range = false;
+		}
+
 		bytes = do_splice_direct(old_file, &old_pos,
 					 new_file, &new_pos,
 					 this_len, SPLICE_F_MOVE);
@@ -14,6 +14,9 @@
 #include <linux/proc_ns.h>
 #include <linux/pseudo_fs.h>
 #include <linux/ptrace.h>
+#include <linux/sched/cputime.h>
+#include <linux/sched/mm.h>
+#include <linux/sched/signal.h>
 #include <linux/seq_file.h>
 #include <uapi/linux/pidfd.h>
 #include <linux/ipc_namespace.h>
@@ -379,6 +382,167 @@ static long pidfd_info(struct file *file, unsigned int cmd, unsigned long arg)
 	return copy_struct_to_user(uinfo, usize, &kinfo, sizeof(kinfo), NULL);
 }
 
+static void pidfs_fill_cpu_stats(struct task_struct *task, struct pidfd_stats *st)
+{
+	struct signal_struct *sig = task->signal;
+	unsigned long min_flt, maj_flt, nvcsw, nivcsw, flags;
+	unsigned int seq = 1;
+	struct task_struct *t;
+	u64 utime, stime;
+
+	do {
+		seq++; /* 2 on the 1st/lockless path, otherwise odd */
+		flags = read_seqbegin_or_lock_irqsave(&sig->stats_lock, &seq);
+
+		min_flt = sig->min_flt;
+		maj_flt = sig->maj_flt;
+		nvcsw = sig->nvcsw;
+		nivcsw = sig->nivcsw;
+
+		rcu_read_lock();
+		__for_each_thread(sig, t) {
+			min_flt += t->min_flt;
+			maj_flt += t->maj_flt;
+			nvcsw += t->nvcsw;
+			nivcsw += t->nivcsw;
+		}
+		rcu_read_unlock();
+	} while (need_seqretry(&sig->stats_lock, seq));
+	done_seqretry_irqrestore(&sig->stats_lock, seq, flags);
+
+	thread_group_cputime_adjusted(task, &utime, &stime);
+
+	st->utime = utime;
+	st->stime = stime;
+	st->start_boottime = timens_add_boottime_ns(task->start_boottime);
+	st->min_flt = min_flt;
+	st->maj_flt = maj_flt;
+	st->nvcsw = nvcsw;
+	st->nivcsw = nivcsw;
+	st->mask |= PIDFD_STATS_CPU;
+}
+
+static void pidfs_fill_mem_stats(struct task_struct *task, struct pidfd_stats *st)
+{
+	struct mm_struct *mm = get_task_mm(task);
+
+	/* Kernel threads and zombies have no address space to report */
+	if (!mm)
+		return;
+
+	st->vsize = (u64)READ_ONCE(mm->total_vm) << PAGE_SHIFT;
+	st->rss_anon = (u64)get_mm_counter(mm, MM_ANONPAGES) << PAGE_SHIFT;
+	st->rss_file = (u64)get_mm_counter(mm, MM_FILEPAGES) << PAGE_SHIFT;
+	st->rss_shmem = (u64)get_mm_counter(mm, MM_SHMEMPAGES) << PAGE_SHIFT;
+	st->swap = (u64)get_mm_counter(mm, MM_SWAPENTS) << PAGE_SHIFT;
+	st->mask |= PIDFD_STATS_MEM;
+	mmput(mm);
+}
+
+static void pidfs_fill_stats(struct pid_namespace *ns, pid_t nr, __u64 mask,
+			     struct pidfd_stats *st)
+{
+	struct task_struct *task;
+
+	rcu_read_lock();
+	task = find_task_by_pid_ns(nr, ns);
+	if (task)
+		get_task_struct(task);
+	rcu_read_unlock();
+	if (!task)
+		return;
+
+	/*
+	 * Same rule as the pidfd info and /proc/<pid> files that hold these
+	 * counters: tasks the caller may not inspect look like they don't
+	 * exist, rather than leaking through a batch query.
+	 */
+	if (!ptrace_may_access(task, PTRACE_MODE_READ_FSCREDS))
+		goto out;
+
+	st->pid = task_pid_nr_ns(task, ns);
+	st->tgid = task_tgid_nr_ns(task, ns);
+	st->ppid = task_ppid_nr_ns(task, ns);
+	/* Reaped while we were looking */
+	if (!st->pid || !st->tgid)
+		goto out;
+	st->mask |= PIDFD_STATS_PID;
+
+	if (mask & PIDFD_STATS_SCHED) {
+		st->state = task_state_to_char(task);
+		st->nr_threads = get_nr_threads(task);
+		st->nice = task_nice(task);
+		st->processor = task_cpu(task);
+		st->mask |= PIDFD_STATS_SCHED;
+	}
+	if (mask & PIDFD_STATS_CPU)
+		pidfs_fill_cpu_stats(task, st);
+	if (mask & PIDFD_STATS_MEM)
+		pidfs_fill_mem_stats(task, st);
+out:
+	put_task_struct(task);
+}
+
+/*
+ * Report the /proc/<pid>/stat style counters of a batch of processes in
+ * one call, without formatting them as text.  The pidfd only selects the
+ * pid namespace the pids are resolved in, which must be visible from the
+ * caller's, so a monitoring agent can use the pidfd of a container's init
+ * to query the processes of that container by their pids in it.
+ */
+static long pidfd_stats(struct file *file, unsigned int cmd, unsigned long arg)
+{
+	struct pidfd_stats_query __user *uquery = (struct pidfd_stats_query __user *)arg;
+	struct pid *pid = pidfd_pid(file);
+	size_t usize = _IOC_SIZE(cmd);
+	struct pidfd_stats_query kquery;
+	struct pid_namespace *ns;
+	void __user *ustats;
+	u32 __user *upids;
+	unsigned int i;
+	int ret;
+
+	if (!uquery)
+		return -EINVAL;
+	if (usize < PIDFD_STATS_QUERY_SIZE_VER0)
+		return -EINVAL; /* First version, no smaller struct possible */
+
+	ret = copy_struct_from_user(&kquery, sizeof(kquery), uquery, usize);
+	if (ret)
+		return ret;
+	if (kquery.stats_size < PIDFD_STATS_SIZE_VER0)
+		return -EINVAL;
+	if (kquery.nr > PIDFD_STATS_MAX_BATCH)
+		return -E2BIG;
+
+	if (!pid_in_current_pidns(pid))
+		return -ESRCH;
+	ns = ns_of_pid(pid);
+
+	upids = u64_to_user_ptr(kquery.pids);
+	ustats = u64_to_user_ptr(kquery.stats);
+	for (i = 0; i < kquery.nr; i++) {
+		struct pidfd_stats kstats = {};
+		u32 nr;
+
+		if (get_user(nr, upids + i))
+			return -EFAULT;
+		if (nr && nr <= INT_MAX)
+			pidfs_fill_stats(ns, nr, kquery.mask, &kstats);
+		else
+			kstats.pid = nr;
+
+		ret = copy_struct_to_user(ustats + (size_t)i * kquery.stats_size,
+					  kquery.stats_size, &kstats,
+					  sizeof(kstats), NULL);
+		if (ret)
+			return ret;
+		cond_resched();
+	}
+
+	return 0;
+}
+
 static bool pidfs_ioctl_valid(unsigned int cmd)
 {
 	switch (cmd) {
@@ -405,6 +569,8 @@ static bool pidfs_ioctl_valid(unsigned int cmd)
 		 * This is not perfect but will catch most cases.
 		 */
 		return (_IOC_TYPE(cmd) == _IOC_TYPE(PIDFD_GET_INFO));
+	case _IOC_NR(PIDFD_GET_STATS):
+		return (_IOC_TYPE(cmd) == _IOC_TYPE(PIDFD_GET_STATS));
 	}
 
 	return false;
@@ -431,6 +597,8 @@ static long pidfd_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 	/* Extensible IOCTL that does not open namespace FDs, take a shortcut */
 	if (_IOC_NR(cmd) == _IOC_NR(PIDFD_GET_INFO))
 		return pidfd_info(file, cmd, arg);
+	if (_IOC_NR(cmd) == _IOC_NR(PIDFD_GET_STATS))
+		return pidfd_stats(file, cmd, arg);
 
 	task = get_pid_task(pidfd_pid(file), PIDTYPE_PID);
 	if (!task)
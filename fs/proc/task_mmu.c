@@ -180,11 +180,25 @@ static void *m_start(struct seq_file *m, loff_t *ppos)
 
 static void *m_next(struct seq_file *m, void *v, loff_t *ppos)
 {
+	struct proc_maps_private *priv = m->private;
+
 	if (*ppos == -2UL) {
 		*ppos = -1UL;
 		return NULL;
 	}
-	return proc_get_vma(m->private, ppos);
+
+	/*
+	 * Walking a large address space can take a while, let a waiting
+	 * writer in and carry on from the end of the vma just shown.
+	 */
+	if (mmap_lock_is_contended(priv->mm)) {
+		unsigned long last_end = ((struct vm_area_struct *)v)->vm_end;
+
+		mmap_read_unlock(priv->mm);
+		mmap_read_lock(priv->mm);
+		vma_iter_init(&priv->iter, priv->mm, last_end);
+	}
+	return proc_get_vma(priv, ppos);
 }
 
 static void m_stop(struct seq_file *m, void *v)
@@ -2089,7 +2103,8 @@ static int pagemap_release(struct inode *inode, struct file *file)
 				 PAGE_IS_SWAPPED | PAGE_IS_PFNZERO |	\
 				 PAGE_IS_HUGE | PAGE_IS_SOFT_DIRTY |	\
 				 PAGE_IS_GUARD)
-#define PM_SCAN_FLAGS		(PM_SCAN_WP_MATCHING | PM_SCAN_CHECK_WPASYNC)
+#define PM_SCAN_FLAGS		(PM_SCAN_WP_MATCHING | PM_SCAN_CHECK_WPASYNC | \
+				 PM_SCAN_SUMMARIZE_PMD)
 
 struct pagemap_scan_private {
 	struct pm_scan_arg arg;
@@ -2495,6 +2510,31 @@ static int pagemap_scan_pmd_entry(pmd_t *pmd, unsigned long start,
 
 	arch_enter_lazy_mmu_mode();
 
+	/*
+	 * Summarize the whole page table in one region: working set
+	 * estimation on large heaps needs neither the per-page output nor
+	 * the copying of it.
+	 */
+	if (p->arg.flags & PM_SCAN_SUMMARIZE_PMD) {
+		unsigned long categories = 0;
+		bool found = false;
+
+		for (addr = start; addr != end; pte++, addr += PAGE_SIZE) {
+			unsigned long page_categories = p->cur_vma_category |
+				pagemap_page_category(p, vma, addr, ptep_get(pte));
+
+			if (!pagemap_scan_is_interesting_page(page_categories, p))
+				continue;
+			categories |= page_categories;
+			found = true;
+		}
+		if (found) {
+			addr = end;
+			ret = pagemap_scan_output(categories, p, start, &addr);
+		}
+		goto flush_and_return;
+	}
+
 	if ((p->arg.flags & PM_SCAN_WP_MATCHING) && !p->vec_out) {
 		/* Fast path for performing exclusive WP */
 		for (addr = start; addr != end; pte++, addr += PAGE_SIZE) {
@@ -2674,6 +2714,10 @@ static int pagemap_scan_get_args(struct pm_scan_arg *arg,
 	/* Validate requested features */
 	if (arg->flags & ~PM_SCAN_FLAGS)
 		return -EINVAL;
+	/* Summaries don't tell which pages to write protect */
+	if ((arg->flags & PM_SCAN_SUMMARIZE_PMD) &&
+	    (arg->flags & PM_SCAN_WP_MATCHING))
+		return -EINVAL;
 	if ((arg->category_inverted | arg->category_mask |
 	     arg->category_anyof_mask | arg->return_mask) & ~PM_SCAN_CATEGORIES)
 		return -EINVAL;
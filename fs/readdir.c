@@ -21,6 +21,10 @@
 #include <linux/unistd.h>
 #include <linux/compat.h>
 #include <linux/uaccess.h>
+#include <linux/namei.h>
+#include <linux/slab.h>
+
+#include "internal.h"
 
 /*
  * Some filesystems were never converted to '->iterate_shared()'
@@ -423,6 +427,202 @@ SYSCALL_DEFINE3(getdents64, unsigned int, fd,
 	return error;
 }
 
+/*
+ * getdents_statx() cannot stat the entries from inside the actor, which
+ * runs with the directory locked, so the names are collected into a
+ * kernel page first and looked up once iterate_dir() has returned. The
+ * lookups start in the dcache, a cold entry costs one ->lookup() of a
+ * single component rather than a full path walk.
+ */
+struct statx_dirent {
+	u64		ino;
+	loff_t		off;
+	unsigned short	namlen;
+	unsigned char	type;
+	char		name[];
+};
+
+struct getdents_statx_callback {
+	struct dir_context ctx;
+	void *buf;
+	unsigned int used;	/* Bytes of buf in use */
+	unsigned int nr;	/* Entries in buf */
+	unsigned int room;	/* Bytes left in the user buffer */
+	bool full;		/* Stopped because buf is full */
+	int error;
+};
+
+static bool filldir_statx(struct dir_context *ctx, const char *name, int namlen,
+			  loff_t offset, u64 ino, unsigned int d_type)
+{
+	struct getdents_statx_callback *buf =
+		container_of(ctx, struct getdents_statx_callback, ctx);
+	unsigned int reclen = ALIGN(offsetof(struct dirent_statx, d_name) +
+				    namlen + 1, sizeof(u64));
+	unsigned int size = ALIGN(offsetof(struct statx_dirent, name) + namlen,
+				  sizeof(u64));
+	struct statx_dirent *ent;
+
+	buf->error = verify_dirent_name(name, namlen);
+	if (unlikely(buf->error))
+		return false;
+	buf->error = -EINVAL;	/* only used if we fail.. */
+	if (reclen > buf->room)
+		return false;
+	if (size > PAGE_SIZE - buf->used) {
+		buf->full = true;
+		return false;
+	}
+	if (!(d_type & FILLDIR_FLAG_NOINTR) && buf->nr && signal_pending(current))
+		return false;
+
+	ent = buf->buf + buf->used;
+	ent->ino = ino;
+	ent->off = offset;
+	ent->namlen = namlen;
+	ent->type = d_type & S_DT_MASK;
+	memcpy(ent->name, name, namlen);
+
+	buf->used += size;
+	buf->room -= reclen;
+	buf->nr++;
+	return true;
+}
+
+static int statx_dirent_getattr(struct file *dir, const struct statx_dirent *ent,
+				u32 mask, int flags, struct kstat *stat)
+{
+	struct dentry *dentry;
+	struct path path;
+	int error;
+
+	if (is_dot_dotdot(ent->name, ent->namlen)) {
+		/* ".." may be the parent of a mount root, leave it to userspace */
+		if (ent->namlen == 2)
+			return -ENOENT;
+		path = dir->f_path;
+		path_get(&path);
+	} else {
+		dentry = lookup_one_positive_unlocked(file_mnt_idmap(dir),
+				&QSTR_LEN(ent->name, ent->namlen),
+				dir->f_path.dentry);
+		if (IS_ERR(dentry))
+			return PTR_ERR(dentry);
+		path.mnt = mntget(dir->f_path.mnt);
+		path.dentry = dentry;
+		/* Report what fstatat() would, i.e. the root of a mount on it */
+		error = follow_down(&path, 0);
+		if (error) {
+			path_put(&path);
+			return error;
+		}
+	}
+
+	error = vfs_statx_path(&path, flags | AT_SYMLINK_NOFOLLOW, stat, mask);
+	path_put(&path);
+	return error;
+}
+
+static int statx_dirent_emit(struct file *dir, const struct statx_dirent *ent,
+			     loff_t next, u32 mask, int flags,
+			     struct dirent_statx __user *dirent)
+{
+	unsigned int reclen = ALIGN(offsetof(struct dirent_statx, d_name) +
+				    ent->namlen + 1, sizeof(u64));
+	struct dirent_statx hdr = {
+		.d_ino		= ent->ino,
+		.d_off		= next,
+		.d_reclen	= reclen,
+		.d_type		= ent->type,
+	};
+	struct kstat stat;
+
+	if (copy_to_user(dirent, &hdr, offsetof(struct dirent_statx, d_stx)) ||
+	    copy_to_user(dirent->d_name, ent->name, ent->namlen) ||
+	    put_user(0, dirent->d_name + ent->namlen))
+		return -EFAULT;
+
+	if (statx_dirent_getattr(dir, ent, mask, flags, &stat))
+		return clear_user(&dirent->d_stx, sizeof(dirent->d_stx)) ?
+			-EFAULT : 0;
+	return cp_statx(&stat, &dirent->d_stx);
+}
+
+/**
+ * sys_getdents_statx - read directory entries together with their attributes
+ * @fd: the directory
+ * @dirent: the result buffer, filled with struct dirent_statx records
+ * @count: size of the result buffer
+ * @mask: STATX_xxx flags indicating the attributes wanted, as for statx()
+ * @flags: AT_STATX_SYNC_TYPE flags, as for statx()
+ *
+ * Equivalent to getdents64() followed by statx(fd, name, AT_SYMLINK_NOFOLLOW)
+ * on every entry, without a system call and a path walk per entry.
+ *
+ * Return: the number of bytes written, 0 at the end of the directory.
+ */
+SYSCALL_DEFINE5(getdents_statx, unsigned int, fd,
+		struct dirent_statx __user *, dirent, unsigned int, count,
+		unsigned int, mask, unsigned int, flags)
+{
+	CLASS(fd_pos, f)(fd);
+	struct getdents_statx_callback buf = {
+		.ctx.actor = filldir_statx,
+		.room = count,
+	};
+	void __user *pos = dirent;
+	int error;
+
+	if (fd_empty(f))
+		return -EBADF;
+	if (flags & ~AT_STATX_SYNC_TYPE)
+		return -EINVAL;
+	if ((flags & AT_STATX_SYNC_TYPE) == AT_STATX_SYNC_TYPE)
+		return -EINVAL;
+	if (mask & STATX__RESERVED)
+		return -EINVAL;
+	/* STATX_CHANGE_COOKIE is kernel-only for now */
+	mask &= ~STATX_CHANGE_COOKIE;
+
+	buf.buf = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	if (!buf.buf)
+		return -ENOMEM;
+
+	do {
+		struct statx_dirent *ent, *next;
+		unsigned int i;
+
+		buf.used = buf.nr = 0;
+		buf.full = false;
+		error = iterate_dir(fd_file(f), &buf.ctx);
+		if (error >= 0)
+			error = buf.error;
+		if (!buf.nr)
+			break;
+
+		/* The last entry continues where the directory position is now */
+		for (i = 0, ent = buf.buf; i < buf.nr; i++, ent = next) {
+			next = (void *)ent + ALIGN(offsetof(struct statx_dirent, name) +
+						   ent->namlen, sizeof(u64));
+			error = statx_dirent_emit(fd_file(f), ent,
+					i + 1 < buf.nr ? next->off : buf.ctx.pos,
+					mask, flags, pos);
+			if (error) {
+				/* Hand the unreported entries out again next time */
+				fd_file(f)->f_pos = ent->off;
+				goto out;
+			}
+			pos += ALIGN(offsetof(struct dirent_statx, d_name) +
+				     ent->namlen + 1, sizeof(u64));
+		}
+	} while (buf.full && !fatal_signal_pending(current));
+out:
+	kfree(buf.buf);
+	if (pos != (void __user *)dirent)
+		return pos - (void __user *)dirent;
+	return error;
+}
+
 #ifdef CONFIG_COMPAT
 struct compat_old_linux_dirent {
 	compat_ulong_t	d_ino;
@@ -961,9 +961,17 @@ static ssize_t do_splice_read(struct file *in, loff_t *ppos,
 	if (!len)
 		return 0;
 
-	/* Don't try to read more the pipe has space for. */
+	/*
+	 * Don't try to read more the pipe has space for. A buffer may hold a
+	 * whole large folio if the pipe allows it, filemap_splice_read() stops
+	 * early once the pipe is full of smaller ones.
+	 */
 	p_space = pipe->max_usage - pipe_buf_usage(pipe);
-	len = min_t(size_t, len, p_space << PAGE_SHIFT);
+	if (pipe->large_bufs)
+		len = min_t(size_t, len,
+			    (size_t)p_space << (PAGE_SHIFT + MAX_PAGECACHE_ORDER));
+	else
+		len = min_t(size_t, len, p_space << PAGE_SHIFT);
 
 	if (unlikely(len > MAX_RW_COUNT))
 		len = MAX_RW_COUNT;
@@ -1075,6 +1083,7 @@ ssize_t splice_direct_to_actor(struct file *in, struct splice_desc *sd,
 	sd->flags |= SPLICE_F_MORE;
 
 	WARN_ON_ONCE(!pipe_is_empty(pipe));
+	pipe->large_bufs = sd->large_bufs;
 
 	while (len) {
 		size_t read_len;
@@ -1117,6 +1126,7 @@ ssize_t splice_direct_to_actor(struct file *in, struct splice_desc *sd,
 
 done:
 	pipe->tail = pipe->head = 0;
+	pipe->large_bufs = false;
 	file_accessed(in);
 	return bytes;
 
@@ -1176,6 +1186,22 @@ static void direct_file_splice_eof(struct splice_desc *sd)
 		file->f_op->splice_eof(file);
 }
 
+/*
+ * These turn every pipe buffer into a bvec and hand it on, so a buffer
+ * may span several pages of a folio. Other ->splice_write() methods may
+ * still expect a buffer to stay within its page.
+ */
+static bool splice_write_takes_large_bufs(struct file *out)
+{
+	if (out->f_op->splice_write == iter_file_splice_write)
+		return true;
+#ifdef CONFIG_NET
+	if (out->f_op->splice_write == splice_to_socket)
+		return true;
+#endif
+	return false;
+}
+
 static ssize_t do_splice_direct_actor(struct file *in, loff_t *ppos,
 				      struct file *out, loff_t *opos,
 				      size_t len, unsigned int flags,
@@ -1189,6 +1215,7 @@ static ssize_t do_splice_direct_actor(struct file *in, loff_t *ppos,
 		.u.file		= out,
 		.splice_eof	= direct_file_splice_eof,
 		.opos		= opos,
+		.large_bufs	= splice_write_takes_large_bufs(out),
 	};
 	ssize_t ret;
 
@@ -293,8 +293,8 @@ static int statx_lookup_flags(int flags)
 	return lookup_flags;
 }
 
-static int vfs_statx_path(struct path *path, int flags, struct kstat *stat,
-			  u32 request_mask)
+int vfs_statx_path(struct path *path, int flags, struct kstat *stat,
+		   u32 request_mask)
 {
 	int error = vfs_getattr(path, stat, request_mask, flags);
 	if (error)
@@ -704,7 +704,7 @@ SYSCALL_DEFINE4(fstatat64, int, dfd, const char __user *, filename,
 }
 #endif /* __ARCH_WANT_STAT64 || __ARCH_WANT_COMPAT_STAT64 */
 
-static noinline_for_stack int
+noinline_for_stack int
 cp_statx(const struct kstat *stat, struct statx __user *buffer)
 {
 	struct statx tmp;
@@ -217,6 +217,14 @@ static int timerfd_setup(struct timerfd_ctx *ctx, int flags,
 				alarm_start(&ctx->t.alarm, texp);
 			else
 				alarm_start_relative(&ctx->t.alarm, texp);
+		} else if (flags & TFD_TIMER_SLACK) {
+			/*
+			 * Share the expiry interrupt with other timers within
+			 * the caller's timer slack. Periodic re-arming keeps
+			 * the slack, as hrtimer_forward() moves both ends.
+			 */
+			hrtimer_start_coalesced(&ctx->t.tmr, texp,
+						current->timer_slack_ns, htmode);
 		} else {
 			hrtimer_start(&ctx->t.tmr, texp, htmode);
 		}
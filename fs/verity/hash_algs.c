@@ -197,6 +197,49 @@ int fsverity_hash_block(const struct merkle_tree_params *params,
 	return err;
 }
 
+/**
+ * fsverity_hash_blocks() - hash several data or hash blocks
+ * @params: the Merkle tree's parameters
+ * @inode: inode for which the hashing is being done
+ * @data: virtual addresses of the buffers containing the blocks to hash
+ * @outs: output digests, size 'params->digest_size' bytes each
+ * @num_blocks: number of blocks to hash
+ *
+ * Like fsverity_hash_block(), but lets the hash algorithm interleave the
+ * blocks if it supports that.
+ *
+ * Return: 0 on success, -errno on failure
+ */
+int fsverity_hash_blocks(const struct merkle_tree_params *params,
+			 const struct inode *inode, const void * const data[],
+			 u8 * const outs[], unsigned int num_blocks)
+{
+	SHASH_DESC_ON_STACK(desc, params->hash_alg->tfm);
+	int err;
+
+	desc->tfm = params->hash_alg->tfm;
+
+	if (params->hashstate) {
+		err = crypto_shash_import(desc, params->hashstate);
+		if (err) {
+			fsverity_err(inode,
+				     "Error %d importing hash state", err);
+			return err;
+		}
+	} else {
+		err = crypto_shash_init(desc);
+		if (err) {
+			fsverity_err(inode, "Error %d initializing hash", err);
+			return err;
+		}
+	}
+	err = crypto_shash_finup_mb(desc, (const u8 * const *)data,
+				    params->block_size, outs, num_blocks);
+	if (err)
+		fsverity_err(inode, "Error %d computing block hashes", err);
+	return err;
+}
+
 /**
  * fsverity_hash_buffer() - hash some data
  * @alg: the hash algorithm to use
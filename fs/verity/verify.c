@@ -79,7 +79,8 @@ static bool is_hash_block_verified(struct fsverity_info *vi, struct page *hpage,
 }
 
 /*
- * Verify a single data block against the file's Merkle tree.
+ * Verify a single data block against the file's Merkle tree.  The caller has
+ * already hashed the block into @data_hash.
  *
  * In principle, we need to verify the entire path to the root node.  However,
  * for efficiency the filesystem may cache the hash blocks.  Therefore we need
@@ -90,7 +91,8 @@ static bool is_hash_block_verified(struct fsverity_info *vi, struct page *hpage,
  */
 static bool
 verify_data_block(struct inode *inode, struct fsverity_info *vi,
-		  const void *data, u64 data_pos, unsigned long max_ra_pages)
+		  const void *data, const u8 *data_hash, u64 data_pos,
+		  unsigned long max_ra_pages)
 {
 	const struct merkle_tree_params *params = &vi->tree_params;
 	const unsigned int hsize = params->digest_size;
@@ -115,8 +117,12 @@ verify_data_block(struct inode *inode, struct fsverity_info *vi,
 	 */
 	u64 hidx = data_pos >> params->log_blocksize;
 
-	/* Up to 1 + FS_VERITY_MAX_LEVELS pages may be mapped at once */
-	BUILD_BUG_ON(1 + FS_VERITY_MAX_LEVELS > KM_MAX_IDX);
+	/*
+	 * Up to FS_VERITY_MAX_PENDING_BLOCKS + FS_VERITY_MAX_LEVELS pages may
+	 * be mapped at once
+	 */
+	BUILD_BUG_ON(FS_VERITY_MAX_PENDING_BLOCKS + FS_VERITY_MAX_LEVELS >
+		     KM_MAX_IDX);
 
 	if (unlikely(data_pos >= inode->i_size)) {
 		/*
@@ -222,10 +228,10 @@ verify_data_block(struct inode *inode, struct fsverity_info *vi,
 	}
 
 	/* Finally, verify the data block. */
-	if (fsverity_hash_block(params, inode, data, real_hash) != 0)
-		goto error;
-	if (memcmp(want_hash, real_hash, hsize) != 0)
+	if (memcmp(want_hash, data_hash, hsize) != 0) {
+		memcpy(real_hash, data_hash, hsize);
 		goto corrupted;
+	}
 	return true;
 
 corrupted:
@@ -250,6 +256,9 @@ verify_data_blocks(struct folio *data_folio, size_t len, size_t offset,
 	struct fsverity_info *vi = inode->i_verity_info;
 	const unsigned int block_size = vi->tree_params.block_size;
 	u64 pos = (u64)data_folio->index << PAGE_SHIFT;
+	const void *data[FS_VERITY_MAX_PENDING_BLOCKS];
+	u8 hashes[FS_VERITY_MAX_PENDING_BLOCKS][FS_VERITY_MAX_DIGEST_SIZE];
+	u8 *outs[FS_VERITY_MAX_PENDING_BLOCKS];
 
 	if (WARN_ON_ONCE(len <= 0 || !IS_ALIGNED(len | offset, block_size)))
 		return false;
@@ -257,17 +266,29 @@ verify_data_blocks(struct folio *data_folio, size_t len, size_t offset,
 			 folio_test_uptodate(data_folio)))
 		return false;
 	do {
-		void *data;
+		unsigned int i, n;
 		bool valid;
 
-		data = kmap_local_folio(data_folio, offset);
-		valid = verify_data_block(inode, vi, data, pos + offset,
-					  max_ra_pages);
-		kunmap_local(data);
+		/* Hash a few blocks at once, the algorithm may interleave them */
+		n = min_t(size_t, len / block_size,
+			  FS_VERITY_MAX_PENDING_BLOCKS);
+		for (i = 0; i < n; i++) {
+			data[i] = kmap_local_folio(data_folio,
+						   offset + i * block_size);
+			outs[i] = hashes[i];
+		}
+		valid = fsverity_hash_blocks(&vi->tree_params, inode, data,
+					     outs, n) == 0;
+		for (i = 0; valid && i < n; i++)
+			valid = verify_data_block(inode, vi, data[i], hashes[i],
+						  pos + offset + i * block_size,
+						  max_ra_pages);
+		while (n--)
+			kunmap_local(data[n]);
 		if (!valid)
 			return false;
-		offset += block_size;
-		len -= block_size;
+		offset += i * block_size;
+		len -= i * block_size;
 	} while (len);
 	return true;
 }
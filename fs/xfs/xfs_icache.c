@@ -1950,6 +1950,75 @@ xfs_inodegc_inactivate(
 
 }
 
+static void
+xfs_inodegc_inactivate_one(
+	struct xfs_inodegc	*gc,
+	struct xfs_inode	*ip)
+{
+	int			error;
+
+	xfs_iflags_set(ip, XFS_INACTIVATING);
+	error = xfs_inodegc_inactivate(ip);
+	if (error && !gc->error)
+		gc->error = error;
+}
+
+static int
+xfs_inodegc_ino_cmp(
+	const void		*a,
+	const void		*b)
+{
+	const struct xfs_inode	*ip1 = *(const struct xfs_inode **)a;
+	const struct xfs_inode	*ip2 = *(const struct xfs_inode **)b;
+
+	return cmp_int(ip1->i_ino, ip2->i_ino);
+}
+
+/*
+ * Inactivate the queued inodes in inode number order. The queue is LIFO
+ * and interleaves inodes from all over the filesystem, whereas a bulk
+ * unlink tends to free whole inode clusters and the extents of neighbouring
+ * files. Processing them sorted keeps each AG's AGI, AGF, inode cluster
+ * buffers and btree blocks hot across consecutive transactions instead of
+ * bouncing between AGs for every inode.
+ *
+ * Returns false if the batch could not be allocated, in which case the
+ * caller falls back to the queue order.
+ */
+static bool
+xfs_inodegc_inactivate_sorted(
+	struct xfs_inodegc	*gc,
+	struct llist_node	*node,
+	unsigned int		nr)
+{
+	struct xfs_mount	*mp = gc->mp;
+	struct xfs_inode	**batch;
+	struct xfs_inode	*ip;
+	unsigned int		nr_ags = 0;
+	unsigned int		i = 0;
+
+	batch = kmalloc_array(nr, sizeof(*batch), GFP_KERNEL | __GFP_NOWARN);
+	if (!batch)
+		return false;
+
+	llist_for_each_entry(ip, node, i_gclist)
+		batch[i++] = ip;
+	xfs_sort(batch, nr, sizeof(*batch), xfs_inodegc_ino_cmp);
+
+	for (i = 0; i < nr; i++) {
+		if (i == 0 || XFS_INO_TO_AGNO(mp, batch[i]->i_ino) !=
+			      XFS_INO_TO_AGNO(mp, batch[i - 1]->i_ino))
+			nr_ags++;
+	}
+	trace_xfs_inodegc_batch(mp, nr, nr_ags);
+
+	for (i = 0; i < nr; i++)
+		xfs_inodegc_inactivate_one(gc, batch[i]);
+
+	kfree(batch);
+	return true;
+}
+
 void
 xfs_inodegc_worker(
 	struct work_struct	*work)
@@ -1960,6 +2029,7 @@ xfs_inodegc_worker(
 	struct xfs_inode	*ip, *n;
 	struct xfs_mount	*mp = gc->mp;
 	unsigned int		nofs_flag;
+	unsigned int		nr = 0;
 
 	/*
 	 * Clear the cpu mask bit and ensure that we have seen the latest
@@ -1986,13 +2056,12 @@ xfs_inodegc_worker(
 	trace_xfs_inodegc_worker(mp, READ_ONCE(gc->shrinker_hits));
 
 	WRITE_ONCE(gc->shrinker_hits, 0);
-	llist_for_each_entry_safe(ip, n, node, i_gclist) {
-		int	error;
 
-		xfs_iflags_set(ip, XFS_INACTIVATING);
-		error = xfs_inodegc_inactivate(ip);
-		if (error && !gc->error)
-			gc->error = error;
+	llist_for_each_entry(ip, node, i_gclist)
+		nr++;
+	if (nr == 1 || !xfs_inodegc_inactivate_sorted(gc, node, nr)) {
+		llist_for_each_entry_safe(ip, n, node, i_gclist)
+			xfs_inodegc_inactivate_one(gc, ip);
 	}
 
 	memalloc_nofs_restore(nofs_flag);
@@ -1220,14 +1220,21 @@ xlog_cil_order_cmp(
  * If a log item is marked with a whiteout, we do not need to write it to the
  * journal and so we just move them to the whiteout list for the caller to
  * dispose of appropriately.
+ *
+ * Returns true if the chain still needs sorting. Commits from a single CPU
+ * that do not relog items already arrive in order, so the sort can often be
+ * skipped for large checkpoints.
  */
-static void
+static bool
 xlog_cil_build_lv_chain(
 	struct xfs_cil_ctx	*ctx,
 	struct list_head	*whiteouts,
 	uint32_t		*num_iovecs,
 	uint32_t		*num_bytes)
 {
+	uint32_t		last_order_id = 0;
+	bool			need_sort = false;
+
 	while (!list_empty(&ctx->log_items)) {
 		struct xfs_log_item	*item;
 		struct xfs_log_vec	*lv;
@@ -1243,6 +1250,9 @@ xlog_cil_build_lv_chain(
 
 		lv = item->li_lv;
 		lv->lv_order_id = item->li_order_id;
+		if (lv->lv_order_id < last_order_id)
+			need_sort = true;
+		last_order_id = lv->lv_order_id;
 
 		/* we don't write ordered log vectors */
 		if (lv->lv_buf_len != XFS_LOG_VEC_ORDERED)
@@ -1254,6 +1264,7 @@ xlog_cil_build_lv_chain(
 		item->li_order_id = 0;
 		item->li_lv = NULL;
 	}
+	return need_sort;
 }
 
 static void
@@ -1306,6 +1317,7 @@ xlog_cil_push_work(
 	struct xfs_log_vec	lvhdr = {};
 	xfs_csn_t		push_seq;
 	bool			push_commit_stable;
+	bool			need_sort;
 	LIST_HEAD		(whiteouts);
 	struct xlog_ticket	*ticket;
 
@@ -1378,7 +1390,8 @@ xlog_cil_push_work(
 	list_add(&ctx->committing, &cil->xc_committing);
 	spin_unlock(&cil->xc_push_lock);
 
-	xlog_cil_build_lv_chain(ctx, &whiteouts, &num_iovecs, &num_bytes);
+	need_sort = xlog_cil_build_lv_chain(ctx, &whiteouts, &num_iovecs,
+					    &num_bytes);
 
 	/*
 	 * Switch the contexts so we can drop the context lock and move out
@@ -1415,7 +1428,8 @@ xlog_cil_push_work(
 	 * This ensures we always have the transaction headers at the start
 	 * of the chain.
 	 */
-	list_sort(NULL, &ctx->lv_chain, xlog_cil_order_cmp);
+	if (need_sort)
+		list_sort(NULL, &ctx->lv_chain, xlog_cil_order_cmp);
 
 	/*
 	 * Build a checkpoint transaction header and write it to the log to
@@ -730,6 +730,20 @@ xfs_fs_dirty_inode(
 	xfs_trans_commit(tp);
 }
 
+/*
+ * Inodes in different AGs write to different parts of the device and
+ * rarely contend on the same AG locks, so hand them to different
+ * writeback workers.
+ */
+static unsigned long
+xfs_fs_writeback_shard(
+	struct inode			*inode)
+{
+	struct xfs_inode		*ip = XFS_I(inode);
+
+	return XFS_INO_TO_AGNO(ip->i_mount, ip->i_ino);
+}
+
 /*
  * Slab object creation initialisation for the XFS inode.
  * This covers only the idempotent fields in the XFS inode;
@@ -1298,6 +1312,7 @@ static const struct super_operations xfs_super_operations = {
 	.alloc_inode		= xfs_fs_alloc_inode,
 	.destroy_inode		= xfs_fs_destroy_inode,
 	.dirty_inode		= xfs_fs_dirty_inode,
+	.writeback_shard	= xfs_fs_writeback_shard,
 	.drop_inode		= xfs_fs_drop_inode,
 	.evict_inode		= xfs_fs_evict_inode,
 	.put_super		= xfs_fs_put_super,
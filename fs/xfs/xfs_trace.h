@@ -518,6 +518,25 @@ TRACE_EVENT(xfs_inodegc_worker,
 		  __entry->shrinker_hits)
 );
 
+TRACE_EVENT(xfs_inodegc_batch,
+	TP_PROTO(struct xfs_mount *mp, unsigned int nr_inodes,
+		 unsigned int nr_ags),
+	TP_ARGS(mp, nr_inodes, nr_ags),
+	TP_STRUCT__entry(
+		__field(dev_t, dev)
+		__field(unsigned int, nr_inodes)
+		__field(unsigned int, nr_ags)
+	),
+	TP_fast_assign(
+		__entry->dev = mp->m_super->s_dev;
+		__entry->nr_inodes = nr_inodes;
+		__entry->nr_ags = nr_ags;
+	),
+	TP_printk("dev %d:%d inodes %u ags %u",
+		  MAJOR(__entry->dev), MINOR(__entry->dev),
+		  __entry->nr_inodes, __entry->nr_ags)
+);
+
 DECLARE_EVENT_CLASS(xfs_fs_class,
 	TP_PROTO(struct xfs_mount *mp, void *caller_ip),
 	TP_ARGS(mp, caller_ip),
@@ -215,6 +215,9 @@ struct shash_desc {
  * @import: see struct ahash_alg
  * @export_core: see struct ahash_alg
  * @import_core: see struct ahash_alg
+ * @finup_mb: Finish hashing @num_msgs messages of equal length from the same
+ *	      starting state, interleaving them.  Optional, only called with
+ *	      2 to @mb_max_msgs messages.  See crypto_shash_finup_mb().
  * @setkey: see struct ahash_alg
  * @init_tfm: Initialize the cryptographic transformation object.
  *	      This function is called only once at the instantiation
@@ -228,6 +231,7 @@ struct shash_desc {
  *	      This is a counterpart to @init_tfm, used to remove
  *	      various changes set in @init_tfm.
  * @clone_tfm: Copy transform into new object, may allocate memory.
+ * @mb_max_msgs: Maximum number of messages @finup_mb takes at once.
  * @descsize: Size of the operational state for the message digest. This state
  * 	      size is the memory size that needs to be allocated for
  *	      shash_desc.__ctx
@@ -247,12 +251,16 @@ struct shash_alg {
 	int (*import)(struct shash_desc *desc, const void *in);
 	int (*export_core)(struct shash_desc *desc, void *out);
 	int (*import_core)(struct shash_desc *desc, const void *in);
+	int (*finup_mb)(struct shash_desc *desc, const u8 * const data[],
+			unsigned int len, u8 * const outs[],
+			unsigned int num_msgs);
 	int (*setkey)(struct crypto_shash *tfm, const u8 *key,
 		      unsigned int keylen);
 	int (*init_tfm)(struct crypto_shash *tfm);
 	void (*exit_tfm)(struct crypto_shash *tfm);
 	int (*clone_tfm)(struct crypto_shash *dst, struct crypto_shash *src);
 
+	unsigned int mb_max_msgs;
 	unsigned int descsize;
 
 	union {
@@ -976,6 +984,28 @@ int crypto_shash_init(struct shash_desc *desc);
 int crypto_shash_finup(struct shash_desc *desc, const u8 *data,
 		       unsigned int len, u8 *out);
 
+/**
+ * crypto_shash_finup_mb() - calculate message digests of multiple buffers
+ * @desc: operational state handle that is already initialized, the same
+ *	  starting state is used for every message
+ * @data: the data of each message
+ * @len: the length of each message, all messages must have the same length
+ * @outs: the output buffer for each message's digest
+ * @num_msgs: the number of messages, at least 1
+ *
+ * Finish hashing several independent messages from the state in @desc, like
+ * calling crypto_shash_finup() on a copy of @desc for each of them.  An
+ * algorithm may interleave the messages for better throughput, otherwise
+ * they are hashed one after the other.  @desc is left in an undefined state.
+ *
+ * Context: Softirq or process context.
+ * Return: 0 if the message digests were created successfully; < 0 if an
+ *	   error occurred
+ */
+int crypto_shash_finup_mb(struct shash_desc *desc, const u8 * const data[],
+			  unsigned int len, u8 * const outs[],
+			  unsigned int num_msgs);
+
 /**
  * crypto_shash_update() - add data to message digest for processing
  * @desc: operational state handle that is already initialized
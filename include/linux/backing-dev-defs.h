@@ -160,6 +160,9 @@ struct bdi_writeback {
 #endif
 };
 
+/* Upper limit of backing_dev_info->wb_workers */
+#define BDI_MAX_WB_WORKERS	16
+
 struct backing_dev_info {
 	u64 id;
 	struct rb_node rb_node; /* keyed by ->id */
@@ -171,6 +174,8 @@ struct backing_dev_info {
 	unsigned int capabilities; /* Device capabilities */
 	unsigned int min_ratio;
 	unsigned int max_ratio, max_prop_frac;
+	/* Workers sharing the writeback of one superblock's inodes */
+	unsigned int wb_workers;
 
 	/*
 	 * Sum of avg_write_bw of wbs with dirty inodes.  > 0 if there are
@@ -45,6 +45,16 @@ static inline struct cgroup_subsys_state *bio_blkcg_css(struct bio *bio)
 }
 #endif	/* CONFIG_BLK_CGROUP */
 
+#ifdef CONFIG_BLK_CGROUP_IOCOST
+u32 blkcg_iocost_share(struct gendisk *disk, struct cgroup_subsys_state *css);
+#else
+static inline u32 blkcg_iocost_share(struct gendisk *disk,
+				     struct cgroup_subsys_state *css)
+{
+	return 0;
+}
+#endif
+
 int blkcg_set_fc_appid(char *app_id, u64 cgrp_id, size_t app_id_len);
 char *blkcg_get_fc_appid(struct bio *bio);
 
@@ -435,6 +435,11 @@ struct blk_mq_hw_ctx {
 	struct dentry		*debugfs_dir;
 	/** @sched_debugfs_dir:	debugfs directory for the scheduler. */
 	struct dentry		*sched_debugfs_dir;
+	/**
+	 * @remote_stats: Per completing CPU counts of remote completions,
+	 * see struct blk_mq_remote_stats.
+	 */
+	struct blk_mq_remote_stats __percpu *remote_stats;
 #endif
 
 	/**
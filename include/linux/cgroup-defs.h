@@ -822,6 +822,8 @@ struct cgroup_subsys {
 
 	spinlock_t rstat_ss_lock;
 	raw_spinlock_t __percpu *rstat_ss_cpu_lock;
+	/* CPU being flushed under rstat_ss_lock, -1 if none */
+	int rstat_flush_cpu;
 };
 
 extern struct percpu_rw_semaphore cgroup_threadgroup_rwsem;
@@ -18,6 +18,12 @@
 #define DAMON_MIN_REGION	PAGE_SIZE
 /* Max priority score for DAMON-based operation schemes */
 #define DAMOS_MAX_SCORE		(99)
+/* Number of buckets of the per-region access frequency histogram */
+#define DAMON_ACCESS_HIST_BUCKETS	8
+/* Max count of a histogram bucket, beyond which all buckets are halved */
+#define DAMON_ACCESS_HIST_MAX		256
+/* Max number of workers sharing the access sampling of a context */
+#define DAMON_MAX_SAMPLE_WORKERS	16
 
 /* Get a random number in [l, r) */
 static inline unsigned long damon_rand(unsigned long l, unsigned long r)
@@ -54,6 +60,7 @@ struct damon_size_range {
  *			each sampling interval.
  * @list:		List head for siblings.
  * @age:		Age of this region.
+ * @access_hist:	Histogram of @nr_accesses over aggregation intervals.
  *
  * @nr_accesses is reset to zero for every &damon_attrs->aggr_interval and be
  * increased for every &damon_attrs->sample_interval if an access to the region
@@ -72,6 +79,13 @@ struct damon_size_range {
  * to zero again if the access frequency is significantly changed.  If two
  * regions are merged into a new region, both @nr_accesses and @age of the new
  * region are set as region size-weighted average of those of the two regions.
+ *
+ * @access_hist counts the aggregation intervals by the @nr_accesses the
+ * region ended them with.  Bucket i stands for @nr_accesses of [i, i + 1) /
+ * %DAMON_ACCESS_HIST_BUCKETS of &damon_attrs->aggr_samples.  When a bucket
+ * reaches %DAMON_ACCESS_HIST_MAX, all buckets are halved, so that recent
+ * intervals weigh more.  Like @age, the histogram of merged regions is the
+ * region size-weighted average of those of the two regions.
  */
 struct damon_region {
 	struct damon_addr_range ar;
@@ -81,6 +95,7 @@ struct damon_region {
 	struct list_head list;
 
 	unsigned int age;
+	unsigned int access_hist[DAMON_ACCESS_HIST_BUCKETS];
 /* private: Internal value for age calculation. */
 	unsigned int last_nr_accesses;
 };
@@ -688,6 +703,8 @@ struct damon_intervals_goal {
  *				regions.
  * @max_nr_regions:		The maximum number of adaptive monitoring
  *				regions.
+ * @nr_sample_workers:		The number of workers sharing the access
+ *				sampling.
  *
  * For each @sample_interval, DAMON checks whether each region is accessed or
  * not during the last @sample_interval.  If such access is found, DAMON
@@ -698,6 +715,11 @@ struct damon_intervals_goal {
  * and applies the changes for each @ops_update_interval.  All time intervals
  * are in micro-seconds.  Please refer to &struct damon_operations and &struct
  * damon_callback for more detail.
+ *
+ * If @nr_sample_workers is larger than one, operations that support it (the
+ * physical address space one) fan each access sampling out over that many
+ * workers, splitting the regions by the NUMA node they start on.  Zero is
+ * treated as one, which keeps the sampling in the kdamond.
  */
 struct damon_attrs {
 	unsigned long sample_interval;
@@ -706,6 +728,7 @@ struct damon_attrs {
 	struct damon_intervals_goal intervals_goal;
 	unsigned long min_nr_regions;
 	unsigned long max_nr_regions;
+	unsigned int nr_sample_workers;
 /* private: internal use only */
 	/*
 	 * @aggr_interval to @sample_interval ratio.
@@ -774,6 +797,8 @@ struct damon_ctx {
 	struct completion kdamond_started;
 	/* for scheme quotas prioritization */
 	unsigned long *regions_score_histogram;
+	/* for the access sampling fan-out of the operations set */
+	void *sample_workers;
 
 	struct damon_call_control *call_control;
 	struct mutex call_control_lock;
@@ -113,6 +113,9 @@ struct file_lock {
 	struct file_lock_core c;
 	loff_t fl_start;
 	loff_t fl_end;
+	/* POSIX locks: node in file_lock_context->flc_posix_tree */
+	struct rb_node fl_rb;
+	loff_t fl_subtree_last;
 
 	const struct file_lock_operations *fl_ops;	/* Callbacks for filesystems */
 	const struct lock_manager_operations *fl_lmops;	/* Callbacks for lockmanagers */
@@ -144,6 +147,8 @@ struct file_lock_context {
 	struct list_head	flc_flock;
 	struct list_head	flc_posix;
 	struct list_head	flc_lease;
+	/* flc_posix indexed by range */
+	struct rb_root_cached	flc_posix_tree;
 };
 
 #ifdef CONFIG_FILE_LOCKING
@@ -273,6 +273,8 @@ struct fsnotify_group {
 			int f_flags; /* event_f_flags from fanotify_init() */
 			struct ucounts *ucounts;
 			mempool_t error_events_pool;
+			/* Only set for FAN_RING_BUFFER groups */
+			struct fanotify_ring *ring;
 		} fanotify_data;
 #endif /* CONFIG_FANOTIFY */
 	};
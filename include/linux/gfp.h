@@ -240,6 +240,11 @@ unsigned long alloc_pages_bulk_mempolicy_noprof(gfp_t gfp,
 #define  alloc_pages_bulk_mempolicy(...)				\
 	alloc_hooks(alloc_pages_bulk_mempolicy_noprof(__VA_ARGS__))
 
+unsigned long alloc_folios_bulk_noprof(gfp_t gfp, unsigned int order,
+				int preferred_nid, nodemask_t *nodemask,
+				int nr_folios, struct folio **folio_array);
+#define alloc_folios_bulk(...)			alloc_hooks(alloc_folios_bulk_noprof(__VA_ARGS__))
+
 /* Bulk allocate order-0 pages */
 #define alloc_pages_bulk(_gfp, _nr_pages, _page_array)		\
 	__alloc_pages_bulk(_gfp, numa_mem_id(), NULL, _nr_pages, _page_array)
@@ -320,6 +325,8 @@ struct folio *folio_alloc_mpol_noprof(gfp_t gfp, unsigned int order,
 		struct mempolicy *mpol, pgoff_t ilx, int nid);
 struct folio *vma_alloc_folio_noprof(gfp_t gfp, int order, struct vm_area_struct *vma,
 		unsigned long addr);
+unsigned long alloc_folios_bulk_mempolicy_noprof(gfp_t gfp, unsigned int order,
+		unsigned long nr_folios, struct folio **folio_array);
 #else
 static inline struct page *alloc_pages_noprof(gfp_t gfp_mask, unsigned int order)
 {
@@ -336,12 +343,21 @@ static inline struct folio *folio_alloc_mpol_noprof(gfp_t gfp, unsigned int orde
 }
 #define vma_alloc_folio_noprof(gfp, order, vma, addr)		\
 	folio_alloc_noprof(gfp, order)
+static inline unsigned long alloc_folios_bulk_mempolicy_noprof(gfp_t gfp,
+		unsigned int order, unsigned long nr_folios,
+		struct folio **folio_array)
+{
+	return alloc_folios_bulk_noprof(gfp, order, numa_node_id(), NULL,
+					nr_folios, folio_array);
+}
 #endif
 
 #define alloc_pages(...)			alloc_hooks(alloc_pages_noprof(__VA_ARGS__))
 #define folio_alloc(...)			alloc_hooks(folio_alloc_noprof(__VA_ARGS__))
 #define folio_alloc_mpol(...)			alloc_hooks(folio_alloc_mpol_noprof(__VA_ARGS__))
 #define vma_alloc_folio(...)			alloc_hooks(vma_alloc_folio_noprof(__VA_ARGS__))
+#define alloc_folios_bulk_mempolicy(...)			\
+	alloc_hooks(alloc_folios_bulk_mempolicy_noprof(__VA_ARGS__))
 
 #define alloc_page(gfp_mask) alloc_pages(gfp_mask, 0)
 
@@ -282,6 +282,8 @@ struct io_ring_ctx {
 		struct io_uring_sqe	*sq_sqes;
 		unsigned		cached_sq_head;
 		unsigned		sq_entries;
+		/* SQEs submitted by the SQPOLL thread, for fdinfo */
+		u64			sq_submitted;
 
 		/*
 		 * Fixed resources fast path, should be accessed only under
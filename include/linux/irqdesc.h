@@ -117,6 +117,11 @@ struct irq_desc {
 #ifdef CONFIG_HARDIRQS_SW_RESEND
 	struct hlist_node	resend_node;
 #endif
+#ifdef CONFIG_IRQ_BALANCE
+	unsigned int		balance_count;	/* Count at the last balance pass */
+	unsigned int		balance_cpu;	/* Target CPU + 1 of the last move */
+	unsigned long		balance_moved;	/* jiffies of the last move */
+#endif
 } ____cacheline_internodealigned_in_smp;
 
 #ifdef CONFIG_SPARSE_IRQ
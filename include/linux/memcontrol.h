@@ -281,6 +281,10 @@ struct mem_cgroup {
 	struct lru_gen_mm_list mm_list;
 #endif
 
+	/* result of the last memory.reclaim request, read back from it */
+	struct lru_gen_reclaim_ctl reclaim_report;
+	spinlock_t reclaim_report_lock;
+
 #ifdef CONFIG_MEMCG_V1
 	/* Legacy consumer-oriented counters */
 	struct page_counter kmem;		/* v1 only */
@@ -356,6 +360,18 @@ enum objext_flags {
 
 #define OBJEXTS_FLAGS_MASK (__NR_OBJEXTS_FLAGS - 1)
 
+/*
+ * Pages charged to a memcg up front, so that a run of folios inserted by
+ * one operation (e.g. a readahead window) pays for the page_counter update
+ * once. See mem_cgroup_charge_batch_start().
+ */
+struct mem_cgroup_charge_batch {
+#ifdef CONFIG_MEMCG
+	struct mem_cgroup *memcg;
+	unsigned int nr_pages;	/* charged but not yet committed */
+#endif
+};
+
 #ifdef CONFIG_MEMCG
 
 static inline bool folio_memcg_kmem(struct folio *folio);
@@ -654,6 +670,31 @@ static inline int mem_cgroup_charge(struct folio *folio, struct mm_struct *mm,
 
 int mem_cgroup_charge_hugetlb(struct folio* folio, gfp_t gfp);
 
+void mem_cgroup_charge_batch_start(struct mem_cgroup_charge_batch *batch,
+				   struct mm_struct *mm, unsigned int nr_pages);
+int __mem_cgroup_charge_batch(struct mem_cgroup_charge_batch *batch,
+			      struct folio *folio, gfp_t gfp);
+void mem_cgroup_charge_batch_end(struct mem_cgroup_charge_batch *batch);
+
+/**
+ * mem_cgroup_charge_batch - Charge a folio against a charge batch.
+ * @batch: Batch started with mem_cgroup_charge_batch_start().
+ * @folio: Folio to charge.
+ * @gfp: Reclaim mode, used if the batch does not cover @folio.
+ *
+ * Like mem_cgroup_charge(), but the charge is taken from the pages
+ * pre-charged to @batch while they last.
+ *
+ * Return: 0 on success. Otherwise, an error code is returned.
+ */
+static inline int mem_cgroup_charge_batch(struct mem_cgroup_charge_batch *batch,
+					  struct folio *folio, gfp_t gfp)
+{
+	if (mem_cgroup_disabled())
+		return 0;
+	return __mem_cgroup_charge_batch(batch, folio, gfp);
+}
+
 int mem_cgroup_swapin_charge_folio(struct folio *folio, struct mm_struct *mm,
 				  gfp_t gfp, swp_entry_t entry);
 
@@ -1147,6 +1188,23 @@ static inline int mem_cgroup_charge_hugetlb(struct folio* folio, gfp_t gfp)
         return 0;
 }
 
+static inline void
+mem_cgroup_charge_batch_start(struct mem_cgroup_charge_batch *batch,
+			      struct mm_struct *mm, unsigned int nr_pages)
+{
+}
+
+static inline int mem_cgroup_charge_batch(struct mem_cgroup_charge_batch *batch,
+					  struct folio *folio, gfp_t gfp)
+{
+	return 0;
+}
+
+static inline void
+mem_cgroup_charge_batch_end(struct mem_cgroup_charge_batch *batch)
+{
+}
+
 static inline int mem_cgroup_swapin_charge_folio(struct folio *folio,
 			struct mm_struct *mm, gfp_t gfp, swp_entry_t entry)
 {
@@ -37,6 +37,8 @@ struct access_coordinate;
 
 #ifdef CONFIG_NUMA
 extern bool numa_demotion_enabled;
+extern bool numa_promotion_async;
+extern unsigned int numa_promotion_async_rate_limit;
 extern struct memory_dev_type *default_dram_type;
 extern nodemask_t default_dram_nodes;
 struct memory_dev_type *alloc_memory_type(int adistance);
@@ -76,6 +78,8 @@ static inline bool node_is_toptier(int node)
 #else
 
 #define numa_demotion_enabled	false
+#define numa_promotion_async	false
+#define numa_promotion_async_rate_limit	0
 #define default_dram_type	NULL
 #define default_dram_nodes	NODE_MASK_NONE
 /*
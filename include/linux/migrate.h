@@ -145,6 +145,14 @@ const struct movable_operations *page_movable_ops(struct page *page)
 int migrate_misplaced_folio_prepare(struct folio *folio,
 		struct vm_area_struct *vma, int node);
 int migrate_misplaced_folio(struct folio *folio, int node);
+bool migrate_misplaced_can_batch(struct folio *folio);
+void migrate_misplaced_folio_queue(struct folio *folio, int node);
+void migrate_misplaced_flush(struct callback_head *work);
+void migrate_misplaced_tick(struct task_struct *p);
+bool migrate_promote_can_queue(struct folio *folio, int node);
+unsigned long migrate_promote_folio_list(struct list_head *folios, int node);
+void __meminit kpromoted_run(int nid);
+void __meminit kpromoted_stop(int nid);
 #else
 static inline int migrate_misplaced_folio_prepare(struct folio *folio,
 		struct vm_area_struct *vma, int node)
@@ -155,6 +163,28 @@ static inline int migrate_misplaced_folio(struct folio *folio, int node)
 {
 	return -EAGAIN; /* can't migrate now */
 }
+static inline bool migrate_misplaced_can_batch(struct folio *folio)
+{
+	return false;
+}
+static inline void migrate_misplaced_folio_queue(struct folio *folio, int node)
+{
+}
+static inline bool migrate_promote_can_queue(struct folio *folio, int node)
+{
+	return false;
+}
+static inline unsigned long migrate_promote_folio_list(struct list_head *folios,
+						       int node)
+{
+	return 0;
+}
+static inline void kpromoted_run(int nid)
+{
+}
+static inline void kpromoted_stop(int nid)
+{
+}
 #endif /* CONFIG_NUMA_BALANCING */
 
 #ifdef CONFIG_MIGRATION
@@ -1082,6 +1082,10 @@ struct mm_struct {
 		unsigned long exec_vm;	   /* VM_EXEC & ~VM_WRITE & ~VM_STACK */
 		unsigned long stack_vm;	   /* VM_STACK */
 		unsigned long def_flags;
+		/* Pages mapped per anonymous write fault, see PR_SET_ANON_FAULT_AROUND */
+		unsigned int anon_fault_around_pages;
+		/* Threads copying page tables on fork, see PR_SET_FORK_COPY_THREADS */
+		unsigned int fork_copy_threads;
 
 		/**
 		 * @write_protect_seq: Locked when any thread is write
@@ -241,6 +241,10 @@ enum node_stat_item {
 	NR_HUGETLB,
 #endif
 	NR_BALLOON_PAGES,
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+	KHUGEPAGED_COLLAPSED,	/* collapses by this node's khugepaged */
+	KHUGEPAGED_FULL_SCANS,	/* full scans by this node's khugepaged */
+#endif
 	NR_VM_NODE_STAT_ITEMS
 };
 
@@ -432,6 +436,21 @@ enum lruvec_flags {
 struct lruvec;
 struct page_vma_mapped_walk;
 
+/*
+ * Constraints and results of a proactive reclaim request, see memory.reclaim.
+ * The generation constraints are only honoured by the multi-gen LRU.
+ */
+struct lru_gen_reclaim_ctl {
+	/* only evict generations at least this old, in jiffies */
+	unsigned long min_age;
+	/* pages reclaimed in total */
+	unsigned long nr_total;
+	/* pages reclaimed by generation, counted from the youngest one */
+	unsigned long nr_reclaimed[MAX_NR_GENS];
+	/* CPU time spent on the request, in nanoseconds */
+	u64 cpu_ns;
+};
+
 #ifdef CONFIG_LRU_GEN
 
 enum {
@@ -1463,6 +1482,12 @@ typedef struct pglist_data {
 	 * threshold adjustment period
 	 */
 	unsigned long nbp_th_nr_cand;
+	/* kpromoted: folios from slower tiers queued for promotion here */
+	struct task_struct *kpromoted;	/* Protected by kpromoted_lock */
+	wait_queue_head_t kpromoted_wait;
+	spinlock_t kpromoted_lock;
+	struct list_head kpromoted_list;
+	unsigned long kpromoted_nr;	/* pages on kpromoted_list */
 #endif
 	/* Fields commonly accessed by the page reclaim scanner */
 
@@ -392,6 +392,8 @@ struct mod_kallsyms {
 	unsigned int num_symtab;
 	char *strtab;
 	char *typetab;
+	unsigned long *name_filter;
+	unsigned int name_filter_bits;
 };
 
 #ifdef CONFIG_LIVEPATCH
@@ -352,6 +352,9 @@ struct gro_list {
  * @rx_list: list of pending ``GRO_NORMAL`` skbs
  * @rx_count: cached current length of @rx_list
  * @cached_napi_id: napi_struct::napi_id cached for hotpath, 0 for standalone
+ * @held: packets that started a new aggregate in @hash
+ * @merged: packets merged into an aggregate held in @hash
+ * @evicted: aggregates flushed early because their bucket was full
  */
 struct gro_node {
 	unsigned long		bitmask;
@@ -359,6 +362,9 @@ struct gro_node {
 	struct list_head	rx_list;
 	u32			rx_count;
 	u32			cached_napi_id;
+	u64			held;
+	u64			merged;
+	u64			evicted;
 };
 
 /*
@@ -367,6 +373,7 @@ struct gro_node {
 struct napi_config {
 	u64 gro_flush_timeout;
 	u64 irq_suspend_timeout;
+	u64 threaded_poll_timeout;
 	u32 defer_hard_irqs;
 	cpumask_t affinity_mask;
 	unsigned int napi_id;
@@ -402,6 +409,7 @@ struct napi_struct {
 	struct task_struct	*thread;
 	unsigned long		gro_flush_timeout;
 	unsigned long		irq_suspend_timeout;
+	unsigned long		threaded_poll_timeout;
 	u32			defer_hard_irqs;
 	/* control-path-only fields follow */
 	u32			napi_id;
@@ -3467,6 +3475,12 @@ struct softnet_data {
 #endif
 
 	unsigned int		received_rps;
+#ifdef CONFIG_RPS
+	unsigned int		rfs_hit;	/* steered by the flow table */
+	unsigned int		rfs_miss;	/* no sock flow table match */
+	unsigned int		rfs_migrated;	/* flow moved to another CPU */
+	unsigned int		rfs_held;	/* move delayed by rps_sticky_ms */
+#endif
 	bool			in_net_rx_action;
 	bool			in_napi_threaded_poll;
 
@@ -17,6 +17,7 @@
 #include <linux/hugetlb_inline.h>
 
 struct folio_batch;
+struct mem_cgroup_charge_batch;
 
 unsigned long invalidate_mapping_pages(struct address_space *mapping,
 					pgoff_t start, pgoff_t end);
@@ -647,15 +648,26 @@ static inline void *detach_page_private(struct page *page)
 
 #ifdef CONFIG_NUMA
 struct folio *filemap_alloc_folio_noprof(gfp_t gfp, unsigned int order);
+unsigned long filemap_alloc_folios_bulk_noprof(gfp_t gfp, unsigned int order,
+		unsigned long nr_folios, struct folio **folio_array);
 #else
 static inline struct folio *filemap_alloc_folio_noprof(gfp_t gfp, unsigned int order)
 {
 	return folio_alloc_noprof(gfp, order);
 }
+static inline unsigned long filemap_alloc_folios_bulk_noprof(gfp_t gfp,
+		unsigned int order, unsigned long nr_folios,
+		struct folio **folio_array)
+{
+	return alloc_folios_bulk_mempolicy_noprof(gfp, order, nr_folios,
+						  folio_array);
+}
 #endif
 
 #define filemap_alloc_folio(...)				\
 	alloc_hooks(filemap_alloc_folio_noprof(__VA_ARGS__))
+#define filemap_alloc_folios_bulk(...)				\
+	alloc_hooks(filemap_alloc_folios_bulk_noprof(__VA_ARGS__))
 
 static inline struct page *__page_cache_alloc(gfp_t gfp)
 {
@@ -1239,6 +1251,8 @@ int add_to_page_cache_lru(struct page *page, struct address_space *mapping,
 		pgoff_t index, gfp_t gfp);
 int filemap_add_folio(struct address_space *mapping, struct folio *folio,
 		pgoff_t index, gfp_t gfp);
+int filemap_add_folio_batch(struct address_space *mapping, struct folio *folio,
+		pgoff_t index, gfp_t gfp, struct mem_cgroup_charge_batch *batch);
 void filemap_remove_folio(struct folio *folio);
 void __filemap_remove_folio(struct folio *folio, void *shadow);
 void replace_page_cache_folio(struct folio *old, struct folio *new);
@@ -77,6 +77,7 @@ union pipe_index {
  *	@r_counter: reader counter
  *	@w_counter: writer counter
  *	@poll_usage: is this pipe used for epoll, which has crazy wakeups?
+ *	@large_bufs: splice may queue buffers spanning a whole large folio
  *	@fasync_readers: reader side fasync
  *	@fasync_writers: writer side fasync
  *	@bufs: the circular array of pipe buffers
@@ -105,6 +106,7 @@ struct pipe_inode_info {
 	unsigned int r_counter;
 	unsigned int w_counter;
 	bool poll_usage;
+	bool large_bufs;
 #ifdef CONFIG_WATCH_QUEUE
 	bool note_loss;
 #endif
@@ -2,8 +2,8 @@
 #ifndef _LINUX_PSI_TYPES_H
 #define _LINUX_PSI_TYPES_H
 
+#include <linux/hrtimer.h>
 #include <linux/kthread.h>
-#include <linux/seqlock.h>
 #include <linux/types.h>
 #include <linux/kref.h>
 #include <linux/wait.h>
@@ -84,11 +84,8 @@ enum psi_aggregators {
 struct psi_group_cpu {
 	/* 1st cacheline updated by the scheduler */
 
-	/* Aggregator needs to know of concurrent changes */
-	seqcount_t seq ____cacheline_aligned_in_smp;
-
 	/* States of the tasks belonging to this group */
-	unsigned int tasks[NR_PSI_TASK_COUNTS];
+	unsigned int tasks[NR_PSI_TASK_COUNTS] ____cacheline_aligned_in_smp;
 
 	/* Aggregate pressure state derived from the tasks */
 	u32 state_mask;
@@ -187,7 +184,7 @@ struct psi_group {
 
 	/* Monitor RT polling work control */
 	struct task_struct __rcu *rtpoll_task;
-	struct timer_list rtpoll_timer;
+	struct hrtimer rtpoll_timer;
 	wait_queue_head_t rtpoll_wait;
 	atomic_t rtpoll_wakeup;
 	atomic_t rtpoll_scheduled;
@@ -140,6 +140,8 @@ struct ring_buffer_event *ring_buffer_lock_reserve(struct trace_buffer *buffer,
 int ring_buffer_unlock_commit(struct trace_buffer *buffer);
 int ring_buffer_write(struct trace_buffer *buffer,
 		      unsigned long length, void *data);
+int ring_buffer_write_batch(struct trace_buffer *buffer, unsigned int nr,
+			    unsigned long length, const void *data);
 
 void ring_buffer_nest_start(struct trace_buffer *buffer);
 void ring_buffer_nest_end(struct trace_buffer *buffer);
@@ -556,6 +556,8 @@ struct sched_statistics {
 	u64				nr_wakeups_remote;
 	u64				nr_wakeups_affine;
 	u64				nr_wakeups_affine_attempts;
+	u64				nr_wakeups_cache_affine;
+	u64				nr_wakeups_cache_affine_attempts;
 	u64				nr_wakeups_passive;
 	u64				nr_wakeups_idle;
 
@@ -568,7 +570,14 @@ struct sched_statistics {
 struct sched_entity {
 	/* For load-balancing: */
 	struct load_weight		load;
-	struct rb_node			run_node;
+	union {
+		struct rb_node		run_node;
+		/* CONFIG_SCHED_EEVDF_BUCKETS with sched_rq_index=buckets: */
+		struct {
+			struct list_head	bucket_node;
+			unsigned int		bucket;
+		};
+	};
 	u64				deadline;
 	u64				min_vruntime;
 	u64				min_slice;
@@ -844,6 +853,9 @@ struct task_struct {
 	unsigned int			wakee_flips;
 	unsigned long			wakee_flip_decay_ts;
 	struct task_struct		*last_wakee;
+	/* Consecutive wakeups by last_waker, see WA_CACHE: */
+	struct task_struct		*last_waker;
+	unsigned int			waker_hits;
 
 	/*
 	 * recent_used_cpu is initially set as the last CPU used by a task
@@ -1401,6 +1413,16 @@ struct task_struct {
 	unsigned long			numa_faults_locality[3];
 
 	unsigned long			numa_pages_migrated;
+
+	/*
+	 * Misplaced folios isolated by hinting faults, waiting to be
+	 * migrated together to numa_migrate_nid.
+	 */
+	struct list_head		numa_migrate_list;
+	unsigned int			numa_migrate_nr;
+	int				numa_migrate_nid;
+	unsigned long			numa_migrate_stamp;
+	struct callback_head		numa_migrate_work;
 #endif /* CONFIG_NUMA_BALANCING */
 
 #ifdef CONFIG_RSEQ
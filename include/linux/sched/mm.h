@@ -145,6 +145,13 @@ extern void mmput(struct mm_struct *);
  * be called from the atomic context as well
  */
 void mmput_async(struct mm_struct *);
+/* mmput() from exit, may defer the teardown of large address spaces */
+void mmput_exit(struct mm_struct *);
+#else
+static inline void mmput_exit(struct mm_struct *mm)
+{
+	mmput(mm);
+}
 #endif
 
 /* Grab a reference to a task's mm, if it is not already going away */
@@ -105,6 +105,12 @@ struct sched_domain {
 	u64 max_newidle_lb_cost;
 	unsigned long last_decay_max_lb_cost;
 
+	/* sched_balance_newidle() history */
+	unsigned int newidle_call;	/* decayed nr of newidle balances */
+	unsigned int newidle_success;	/* ... that pulled a task */
+	unsigned int newidle_ratio;	/* success per 1024 calls */
+	unsigned int nr_newidle_skipped; /* consecutive skips */
+
 #ifdef CONFIG_SCHEDSTATS
 	/* sched_balance_rq() stats */
 	unsigned int lb_count[CPU_MAX_IDLE_TYPES];
@@ -119,6 +125,9 @@ struct sched_domain {
 	unsigned int lb_nobusyg[CPU_MAX_IDLE_TYPES];
 	unsigned int lb_nobusyq[CPU_MAX_IDLE_TYPES];
 
+	/* sched_balance_newidle() stats */
+	unsigned int lb_newidle_skipped;
+
 	/* Active load balancing */
 	unsigned int alb_count;
 	unsigned int alb_failed;
@@ -1097,6 +1097,14 @@ void kvfree_rcu_barrier(void);
 void kfree_rcu_scheduler_running(void);
 #endif
 
+struct kmem_rcu_arena;
+
+struct kmem_rcu_arena *kmem_rcu_arena_create(struct kmem_cache *s);
+void kmem_rcu_arena_free(struct kmem_rcu_arena *arena, void *obj,
+			 struct rcu_head *head);
+void kmem_rcu_arena_flush(struct kmem_rcu_arena *arena);
+void kmem_rcu_arena_destroy(struct kmem_rcu_arena *arena);
+
 /**
  * kmalloc_size_roundup - Report allocation bucket size for the given size
  *
@@ -43,6 +43,7 @@ struct splice_desc {
 	loff_t *opos;			/* sendfile: output position */
 	size_t num_spliced;		/* number of bytes already spliced */
 	bool need_wakeup;		/* need to wake up writer */
+	bool large_bufs;		/* actor takes multi-page buffers */
 };
 
 struct partial_page {
@@ -439,6 +439,8 @@ struct svc_serv *svc_create(struct svc_program *, unsigned int,
 			    int (*threadfn)(void *data));
 bool		   svc_rqst_replace_page(struct svc_rqst *rqstp,
 					 struct page *page);
+bool		   svc_rqst_replace_pages(struct svc_rqst *rqstp,
+					  struct page *page, unsigned int nr);
 void		   svc_rqst_release_pages(struct svc_rqst *rqstp);
 void		   svc_exit_thread(struct svc_rqst *);
 struct svc_serv *  svc_create_pooled(struct svc_program *prog,
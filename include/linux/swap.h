@@ -291,6 +291,16 @@ struct swap_sequential_cluster {
 	unsigned int next[SWAP_NR_ORDERS]; /* Likely next allocation offset */
 };
 
+/*
+ * Free clusters for non-rotational devices are taken off the free list in
+ * batches and cached per CPU. Slots are claimed with xchg(), so any CPU can
+ * take them.
+ */
+#define SWAP_CLUSTER_CACHE_NR	8
+struct swap_cluster_cache {
+	unsigned int idx[SWAP_CLUSTER_CACHE_NR]; /* Cached cluster indexes */
+};
+
 /*
  * The in-memory structure used to track swap areas.
  */
@@ -315,6 +325,7 @@ struct swap_info_struct {
 	atomic_long_t inuse_pages;	/* number of those currently in use */
 	struct swap_sequential_cluster *global_cluster; /* Use one global cluster for rotating device */
 	spinlock_t global_cluster_lock;	/* Serialize usage of global cluster */
+	struct swap_cluster_cache __percpu *cluster_cache; /* Per-CPU free clusters for SSD */
 	struct rb_root swap_extent_root;/* root of the swap extent rbtree */
 	struct block_device *bdev;	/* swap device or bdev of swap file */
 	struct file *swap_file;		/* seldom referenced */
@@ -423,6 +434,12 @@ extern unsigned long try_to_free_mem_cgroup_pages(struct mem_cgroup *memcg,
 						  gfp_t gfp_mask,
 						  unsigned int reclaim_options,
 						  int *swappiness);
+extern unsigned long try_to_free_mem_cgroup_pages_gen(struct mem_cgroup *memcg,
+						  unsigned long nr_pages,
+						  gfp_t gfp_mask,
+						  unsigned int reclaim_options,
+						  int *swappiness,
+						  struct lru_gen_reclaim_ctl *ctl);
 extern unsigned long mem_cgroup_shrink_node(struct mem_cgroup *mem,
 						gfp_t gfp_mask, bool noswap,
 						pg_data_t *pgdat,
@@ -47,6 +47,7 @@ struct stat64;
 struct statfs;
 struct statfs64;
 struct statx;
+struct dirent_statx;
 struct sysinfo;
 struct timespec;
 struct __kernel_old_timeval;
@@ -467,6 +468,10 @@ asmlinkage long sys_quotactl_fd(unsigned int fd, unsigned int cmd, qid_t id,
 asmlinkage long sys_getdents64(unsigned int fd,
 				struct linux_dirent64 __user *dirent,
 				unsigned int count);
+asmlinkage long sys_getdents_statx(unsigned int fd,
+				   struct dirent_statx __user *dirent,
+				   unsigned int count, unsigned int mask,
+				   unsigned int flags);
 asmlinkage long sys_llseek(unsigned int fd, unsigned long offset_high,
 			unsigned long offset_low, loff_t __user *result,
 			unsigned int whence);
@@ -574,6 +579,9 @@ asmlinkage long sys_futex_waitv(struct futex_waitv __user *waiters,
 
 asmlinkage long sys_futex_wake(void __user *uaddr, unsigned long mask, int nr, unsigned int flags);
 
+asmlinkage long sys_futex_wakev(struct futex_waitv __user *wakers,
+				unsigned int nr_futexes, unsigned int flags);
+
 asmlinkage long sys_futex_wait(void __user *uaddr, unsigned long val, unsigned long mask,
 			       unsigned int flags, struct __kernel_timespec __user *timespec,
 			       clockid_t clockid);
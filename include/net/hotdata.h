@@ -29,8 +29,10 @@ struct net_hotdata {
 #ifdef CONFIG_RPS
 	struct rps_sock_flow_table __rcu *rps_sock_flow_table;
 	u32			rps_cpu_mask;
+	int			rps_sticky_jiffies;
 #endif
 	int			gro_normal_batch;
+	int			gro_bucket_skbs;
 	int			netdev_budget;
 	int			netdev_budget_usecs;
 	int			tstamp_prequeue;
@@ -79,6 +79,7 @@ struct netns_ipv6 {
 	spinlock_t		fib6_gc_lock;
 	atomic_t		ip6_rt_gc_expire;
 	unsigned long		ip6_rt_last_gc;
+	unsigned int		rt6_nr_exceptions; /* under rt6_exception_lock */
 	unsigned char		flowlabel_has_excl;
 #ifdef CONFIG_IPV6_MULTIPLE_TABLES
 	bool			fib6_has_custom_rules;
@@ -32,6 +32,7 @@ struct rps_dev_flow {
 	u16		cpu;
 	u16		filter;
 	unsigned int	last_qtail;
+	u32		last_switch;	/* jiffies when cpu was last changed */
 };
 #define RPS_NO_FILTER 0xffff
 
@@ -328,6 +328,7 @@ int tcp_v4_err(struct sk_buff *skb, u32);
 void tcp_shutdown(struct sock *sk, int how);
 
 int tcp_v4_early_demux(struct sk_buff *skb);
+void tcp_v4_early_demux_prefetch(const struct sk_buff *skb);
 int tcp_v4_rcv(struct sk_buff *skb);
 
 void tcp_remove_empty_skb(struct sock *sk);
@@ -62,6 +62,32 @@ TRACE_EVENT(cpu_idle_miss,
 		(unsigned long)__entry->state, (__entry->below)?"below":"above")
 );
 
+TRACE_EVENT(cpu_idle_select,
+
+	TP_PROTO(unsigned int cpu_id, unsigned int state, bool stop_tick,
+		 s64 latency_req),
+
+	TP_ARGS(cpu_id, state, stop_tick, latency_req),
+
+	TP_STRUCT__entry(
+		__field(u32,		cpu_id)
+		__field(u32,		state)
+		__field(bool,		stop_tick)
+		__field(s64,		latency_req)
+	),
+
+	TP_fast_assign(
+		__entry->cpu_id = cpu_id;
+		__entry->state = state;
+		__entry->stop_tick = stop_tick;
+		__entry->latency_req = latency_req;
+	),
+
+	TP_printk("cpu_id=%lu state=%lu stop_tick=%d latency_req=%lld",
+		(unsigned long)__entry->cpu_id, (unsigned long)__entry->state,
+		__entry->stop_tick, __entry->latency_req)
+);
+
 DECLARE_EVENT_CLASS(psci_domain_idle,
 
 	TP_PROTO(unsigned int cpu_id, unsigned int state, bool s2idle),
@@ -56,6 +56,27 @@ TRACE_EVENT(tlb_flush,
 		__entry->reason)
 );
 
+TRACE_EVENT(tlb_flush_coalesced,
+
+	TP_PROTO(u64 tlb_gen, u64 covering_gen, unsigned int ipis),
+	TP_ARGS(tlb_gen, covering_gen, ipis),
+
+	TP_STRUCT__entry(
+		__field(u64,		tlb_gen)
+		__field(u64,		covering_gen)
+		__field(unsigned int,	ipis)
+	),
+
+	TP_fast_assign(
+		__entry->tlb_gen	= tlb_gen;
+		__entry->covering_gen	= covering_gen;
+		__entry->ipis		= ipis;
+	),
+
+	TP_printk("tlb_gen:%llu covered by:%llu ipis avoided:%u",
+		__entry->tlb_gen, __entry->covering_gen, __entry->ipis)
+);
+
 #endif /* _TRACE_TLB_H */
 
 /* This part must be outside protection */
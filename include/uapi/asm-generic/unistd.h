@@ -851,9 +851,13 @@ __SYSCALL(__NR_listxattrat, sys_listxattrat)
 __SYSCALL(__NR_removexattrat, sys_removexattrat)
 #define __NR_open_tree_attr 467
 __SYSCALL(__NR_open_tree_attr, sys_open_tree_attr)
+#define __NR_futex_wakev 468
+__SYSCALL(__NR_futex_wakev, sys_futex_wakev)
+#define __NR_getdents_statx 469
+__SYSCALL(__NR_getdents_statx, sys_getdents_statx)
 
 #undef __NR_syscalls
-#define __NR_syscalls 468
+#define __NR_syscalls 470
 
 /*
  * 32 bit systems traditionally used different
@@ -21,6 +21,8 @@
 
 /* Flags for epoll_create1.  */
 #define EPOLL_CLOEXEC O_CLOEXEC
+/* Split the ready list per CPU, for many threads waiting on one instance */
+#define EPOLL_SHARDED 0x1
 
 /* Valid opcodes to issue to sys_epoll_ctl() */
 #define EPOLL_CTL_ADD 1
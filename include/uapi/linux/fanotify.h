@@ -68,12 +68,38 @@
 #define FAN_REPORT_FD_ERROR	0x00002000	/* event->fd can report error */
 #define FAN_REPORT_MNT		0x00004000	/* Report mount events */
 
+/* Deliver events through an mmap()ed ring buffer instead of read() */
+#define FAN_RING_BUFFER		0x00008000
+
 /* Convenience macro - FAN_REPORT_NAME requires FAN_REPORT_DIR_FID */
 #define FAN_REPORT_DFID_NAME	(FAN_REPORT_DIR_FID | FAN_REPORT_NAME)
 /* Convenience macro - FAN_REPORT_TARGET_FID requires all other FID flags */
 #define FAN_REPORT_DFID_NAME_TARGET (FAN_REPORT_DFID_NAME | \
 				     FAN_REPORT_FID | FAN_REPORT_TARGET_FID)
 
+/*
+ * Layout of the FAN_RING_BUFFER mapping of the fanotify fd. The page at
+ * FAN_RING_CONSUMER_PGOFF holds the consumer position and is the only
+ * page that may be mapped writable. The page at FAN_RING_PRODUCER_PGOFF
+ * holds the producer position and is followed by the data area, which is
+ * mapped twice in a row so that a record never wraps. Both pages report
+ * the size of the data area, a power of two.
+ *
+ * Each record is an event as read() would return it, starting at an
+ * offset that is a multiple of FAN_RING_ALIGN. The consumer reads records
+ * from consumer_pos to producer_pos modulo data_size and then stores the
+ * position after the last record it has consumed, rounded up to
+ * FAN_RING_ALIGN, in consumer_pos. Events never carry file descriptors.
+ */
+#define FAN_RING_CONSUMER_PGOFF	0
+#define FAN_RING_PRODUCER_PGOFF	1
+#define FAN_RING_ALIGN		8
+
+struct fanotify_ring_header {
+	__u32 pos;
+	__u32 data_size;
+};
+
 /* Deprecated - do not use this in programs and do not add new flags here! */
 #define FAN_ALL_INIT_FLAGS	(FAN_CLOEXEC | FAN_NONBLOCK | \
 				 FAN_ALL_CLASS_BITS | FAN_UNLIMITED_QUEUE |\
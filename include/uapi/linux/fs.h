@@ -378,6 +378,8 @@ struct page_region {
 /* Flags for PAGEMAP_SCAN ioctl */
 #define PM_SCAN_WP_MATCHING	(1 << 0)	/* Write protect the pages matched. */
 #define PM_SCAN_CHECK_WPASYNC	(1 << 1)	/* Abort the scan when a non-WP-enabled page is found. */
+#define PM_SCAN_SUMMARIZE_PMD	(1 << 2)	/* Report page tables as one region each, with the union of the
+						 * categories of their matching pages. */
 
 /*
  * struct pm_scan_arg - Pagemap ioctl argument
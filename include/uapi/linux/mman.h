@@ -48,6 +48,17 @@ struct cachestat_range {
 	__u64 len;
 };
 
+/* process_madvise() flags */
+#define PMADV_RANGES	0x01	/* vec is an array of struct madvise_range */
+
+/* An address range and the advice to apply to it, for PMADV_RANGES */
+struct madvise_range {
+	__u64 start;
+	__u64 len;
+	__s32 advice;
+	__u32 __reserved;	/* must be 0 */
+};
+
 struct cachestat {
 	__u64 nr_cache;
 	__u64 nr_dirty;
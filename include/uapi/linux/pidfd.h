@@ -110,6 +110,63 @@ struct pidfd_info {
 	__u32 __spare1;
 };
 
+/* Flags for pidfd_stats. */
+#define PIDFD_STATS_PID		(1UL << 0) /* Always returned for live processes */
+#define PIDFD_STATS_SCHED	(1UL << 1) /* state, nr_threads, nice, processor */
+#define PIDFD_STATS_CPU		(1UL << 2) /* times, faults and context switches */
+#define PIDFD_STATS_MEM		(1UL << 3) /* address space and rss counters */
+
+#define PIDFD_STATS_SIZE_VER0		136 /* sizeof first published struct */
+#define PIDFD_STATS_QUERY_SIZE_VER0	32  /* sizeof first published struct */
+
+/* Maximum number of pids in one PIDFD_GET_STATS call. */
+#define PIDFD_STATS_MAX_BATCH		1024
+
+/*
+ * Binary, thread group wide counterparts of the hot fields of
+ * /proc/<pid>/stat and /proc/<pid>/status.  Times are in nanoseconds and
+ * memory sizes in bytes.  A record whose @mask is zero refers to a pid
+ * that did not exist when it was looked up, or to a process the caller
+ * is not allowed to inspect (PTRACE_MODE_READ_FSCREDS).
+ */
+struct pidfd_stats {
+	__u64 mask;
+	__u32 pid;
+	__u32 tgid;
+	__u32 ppid;
+	__u32 state;		/* as the state letter of /proc/<pid>/stat */
+	__u32 nr_threads;
+	__s32 nice;
+	__u32 processor;
+	__u32 __spare0;
+	__u64 utime;
+	__u64 stime;
+	__u64 start_boottime;
+	__u64 min_flt;
+	__u64 maj_flt;
+	__u64 nvcsw;
+	__u64 nivcsw;
+	__u64 vsize;
+	__u64 rss_anon;
+	__u64 rss_file;
+	__u64 rss_shmem;
+	__u64 swap;
+};
+
+/*
+ * Argument of PIDFD_GET_STATS.  The @nr pids in the array at @pids are
+ * looked up in the pid namespace of the process the pidfd refers to, and
+ * one record of @stats_size bytes is written for each of them to the
+ * array at @stats, restricted to the fields selected in @mask.
+ */
+struct pidfd_stats_query {
+	__u64 mask;
+	__u64 pids;		/* __u32 array */
+	__u64 stats;		/* struct pidfd_stats array */
+	__u32 nr;
+	__u32 stats_size;
+};
+
 #define PIDFS_IOCTL_MAGIC 0xFF
 
 #define PIDFD_GET_CGROUP_NAMESPACE            _IO(PIDFS_IOCTL_MAGIC, 1)
@@ -123,5 +180,6 @@ struct pidfd_info {
 #define PIDFD_GET_USER_NAMESPACE              _IO(PIDFS_IOCTL_MAGIC, 9)
 #define PIDFD_GET_UTS_NAMESPACE               _IO(PIDFS_IOCTL_MAGIC, 10)
 #define PIDFD_GET_INFO                        _IOWR(PIDFS_IOCTL_MAGIC, 11, struct pidfd_info)
+#define PIDFD_GET_STATS                       _IOW(PIDFS_IOCTL_MAGIC, 12, struct pidfd_stats_query)
 
 #endif /* _UAPI_LINUX_PIDFD_H */
@@ -371,4 +371,19 @@ struct prctl_mm_map {
 # define PR_FUTEX_HASH_GET_SLOTS	2
 # define PR_FUTEX_HASH_GET_IMMUTABLE	3
 
+/*
+ * Anonymous fault-around: on a write fault to anonymous memory, also map
+ * zeroed pages for the rest of an aligned window of arg2 pages (a power of
+ * two, at most one page table). 0 or 1 disables it.
+ */
+#define PR_SET_ANON_FAULT_AROUND	79
+#define PR_GET_ANON_FAULT_AROUND	80
+
+/*
+ * Copy the page tables of a large address space on fork() with up to
+ * arg2 threads, including the forking task. 0 or 1 copies serially.
+ */
+#define PR_SET_FORK_COPY_THREADS	81
+#define PR_GET_FORK_COPY_THREADS	82
+
 #endif /* _LINUX_PRCTL_H */
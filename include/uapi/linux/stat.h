@@ -192,6 +192,22 @@ struct statx {
 	/* 0x100 */
 };
 
+/*
+ * Record returned by getdents_statx(): the directory entry as getdents64()
+ * would return it, followed by the attributes of the file it names. An
+ * entry that could not be stat'ed (it went away, or it is "..") has a zero
+ * d_stx.stx_mask.
+ */
+struct dirent_statx {
+	__u64	d_ino;
+	__s64	d_off;		/* Offset of the next entry */
+	__u16	d_reclen;	/* Length of this record */
+	__u8	d_type;
+	__u8	__spare[5];
+	struct statx d_stx;
+	char	d_name[];
+};
+
 /*
  * Flags to be stx_mask
  *
@@ -1198,6 +1198,47 @@ static bool __init_or_module initcall_blacklisted(initcall_t fn)
 #endif
 __setup("initcall_blacklist=", initcall_blacklist);
 
+/* The slowest initcalls of the boot, reported at the end of do_initcalls() */
+#define INITCALL_SLOWEST_NR	10
+
+static struct {
+	initcall_t fn;
+	s64 usecs;
+} initcall_slowest[INITCALL_SLOWEST_NR];
+static DEFINE_SPINLOCK(initcall_slowest_lock);
+
+static __init_or_module void initcall_record_slowest(initcall_t fn, s64 usecs)
+{
+	int i;
+
+	if (system_state >= SYSTEM_FREEING_INITMEM)
+		return;
+
+	spin_lock(&initcall_slowest_lock);
+	for (i = INITCALL_SLOWEST_NR - 1; i >= 0; i--) {
+		if (initcall_slowest[i].usecs >= usecs)
+			break;
+		if (i < INITCALL_SLOWEST_NR - 1)
+			initcall_slowest[i + 1] = initcall_slowest[i];
+		initcall_slowest[i].fn = fn;
+		initcall_slowest[i].usecs = usecs;
+	}
+	spin_unlock(&initcall_slowest_lock);
+}
+
+static void __init initcall_report_slowest(void)
+{
+	int i;
+
+	if (!initcall_debug)
+		return;
+
+	printk(KERN_DEBUG "slowest initcalls:\n");
+	for (i = 0; i < INITCALL_SLOWEST_NR && initcall_slowest[i].fn; i++)
+		printk(KERN_DEBUG "  %pS %lld usecs\n", initcall_slowest[i].fn,
+		       initcall_slowest[i].usecs);
+}
+
 static __init_or_module void
 trace_initcall_start_cb(void *data, initcall_t fn)
 {
@@ -1211,10 +1252,13 @@ static __init_or_module void
 trace_initcall_finish_cb(void *data, initcall_t fn, int ret)
 {
 	ktime_t rettime, *calltime = data;
+	s64 usecs;
 
 	rettime = ktime_get();
+	usecs = ktime_us_delta(rettime, *calltime);
 	printk(KERN_DEBUG "initcall %pS returned %d after %lld usecs\n",
-		 fn, ret, (unsigned long long)ktime_us_delta(rettime, *calltime));
+		 fn, ret, (unsigned long long)usecs);
+	initcall_record_slowest(fn, usecs);
 }
 
 static __init_or_module void
@@ -1353,6 +1397,7 @@ static void __init do_initcalls(void)
 	}
 
 	kfree(command_line);
+	initcall_report_slowest();
 }
 
 /*
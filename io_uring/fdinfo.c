@@ -6,6 +6,7 @@
 #include <linux/proc_fs.h>
 #include <linux/seq_file.h>
 #include <linux/io_uring.h>
+#include <linux/netdevice.h>
 
 #include <uapi/linux/io_uring.h>
 
@@ -14,6 +15,7 @@
 #include "fdinfo.h"
 #include "cancel.h"
 #include "rsrc.h"
+#include "zcrx.h"
 
 #ifdef CONFIG_NET_RX_BUSY_POLL
 static __cold void common_tracking_show_fdinfo(struct io_ring_ctx *ctx,
@@ -55,6 +57,35 @@ static inline void napi_show_fdinfo(struct io_ring_ctx *ctx,
 }
 #endif
 
+#ifdef CONFIG_IO_URING_ZCRX
+static __cold void zcrx_show_fdinfo(struct io_ring_ctx *ctx,
+				    struct seq_file *m)
+{
+	struct io_zcrx_ifq *ifq;
+	unsigned long id;
+	int ifindex;
+
+	xa_for_each(&ctx->zcrx_ctxs, id, ifq) {
+		spin_lock(&ifq->lock);
+		ifindex = ifq->netdev ? ifq->netdev->ifindex : 0;
+		spin_unlock(&ifq->lock);
+
+		seq_printf(m, "Zcrx%lu:\tifindex=%d rxq=%u rq_entries=%u\n", id,
+			   ifindex, ifq->if_rxq, ifq->rq_entries);
+		seq_printf(m, "  refilled=%llu rq_invalid=%llu alloc_slow=%llu copied=%llu\n",
+			   data_race(ifq->stat_refilled),
+			   data_race(ifq->stat_rq_invalid),
+			   data_race(ifq->stat_alloc_slow),
+			   data_race(ifq->stat_copied));
+	}
+}
+#else
+static inline void zcrx_show_fdinfo(struct io_ring_ctx *ctx,
+				    struct seq_file *m)
+{
+}
+#endif
+
 static void __io_uring_show_fdinfo(struct io_ring_ctx *ctx, struct seq_file *m)
 {
 	struct io_overflow_cqe *ocqe;
@@ -168,6 +199,8 @@ static void __io_uring_show_fdinfo(struct io_ring_ctx *ctx, struct seq_file *m)
 	seq_printf(m, "SqThreadCpu:\t%d\n", sq_cpu);
 	seq_printf(m, "SqTotalTime:\t%llu\n", sq_total_time);
 	seq_printf(m, "SqWorkTime:\t%llu\n", sq_work_time);
+	if (ctx->flags & IORING_SETUP_SQPOLL)
+		seq_printf(m, "SqSubmitted:\t%llu\n", ctx->sq_submitted);
 	seq_printf(m, "UserFiles:\t%u\n", ctx->file_table.data.nr);
 	for (i = 0; i < ctx->file_table.data.nr; i++) {
 		struct file *f = NULL;
@@ -213,6 +246,7 @@ static void __io_uring_show_fdinfo(struct io_ring_ctx *ctx, struct seq_file *m)
 	}
 	spin_unlock(&ctx->completion_lock);
 	napi_show_fdinfo(ctx, m);
+	zcrx_show_fdinfo(ctx, m);
 }
 
 /*
@@ -17,6 +17,7 @@
 #include <linux/task_work.h>
 #include <linux/audit.h>
 #include <linux/mmu_context.h>
+#include <linux/sysctl.h>
 #include <uapi/linux/io_uring.h>
 
 #include "io-wq.h"
@@ -26,6 +27,15 @@
 #define WORKER_IDLE_TIMEOUT	(5 * HZ)
 #define WORKER_INIT_LIMIT	3
 
+/*
+ * System wide limit of bounded workers across all io-wq instances, 0 means
+ * no limit. Every instance may always start its first bounded worker, so
+ * rings can't stall on each other, but further workers are only created
+ * while the total is below the limit.
+ */
+static unsigned int sysctl_io_wq_max_bound_workers;
+static atomic_t io_wq_bound_workers = ATOMIC_INIT(0);
+
 enum {
 	IO_WORKER_F_UP		= 0,	/* up and active */
 	IO_WORKER_F_RUNNING	= 1,	/* account as running */
@@ -227,6 +237,23 @@ static bool io_task_worker_match(struct callback_head *cb, void *data)
 	return worker == data;
 }
 
+static bool io_wq_is_bound(struct io_wq *wq, struct io_wq_acct *acct)
+{
+	return acct == &wq->acct[IO_WQ_ACCT_BOUND];
+}
+
+/* Called with acct->workers_lock held */
+static bool io_wq_may_add_worker(struct io_wq *wq, struct io_wq_acct *acct)
+{
+	unsigned int max = READ_ONCE(sysctl_io_wq_max_bound_workers);
+
+	if (acct->nr_workers >= acct->max_workers)
+		return false;
+	if (!max || !acct->nr_workers || !io_wq_is_bound(wq, acct))
+		return true;
+	return atomic_read(&io_wq_bound_workers) < max;
+}
+
 static void io_worker_exit(struct io_worker *worker)
 {
 	struct io_wq *wq = worker->wq;
@@ -249,6 +276,8 @@ static void io_worker_exit(struct io_worker *worker)
 		hlist_nulls_del_rcu(&worker->nulls_node);
 	list_del_rcu(&worker->all_list);
 	raw_spin_unlock(&acct->workers_lock);
+	if (io_wq_is_bound(wq, acct))
+		atomic_dec(&io_wq_bound_workers);
 	io_wq_dec_running(worker);
 	/*
 	 * this worker is a goner, clear ->worker_private to avoid any
@@ -328,7 +357,7 @@ static bool io_wq_create_worker(struct io_wq *wq, struct io_wq_acct *acct)
 		pr_warn_once("io-wq is not configured for unbound workers");
 
 	raw_spin_lock(&acct->workers_lock);
-	if (acct->nr_workers >= acct->max_workers) {
+	if (!io_wq_may_add_worker(wq, acct)) {
 		raw_spin_unlock(&acct->workers_lock);
 		return true;
 	}
@@ -359,7 +388,7 @@ static void create_worker_cb(struct callback_head *cb)
 	acct = worker->acct;
 	raw_spin_lock(&acct->workers_lock);
 
-	if (acct->nr_workers < acct->max_workers) {
+	if (io_wq_may_add_worker(wq, acct)) {
 		acct->nr_workers++;
 		do_create = true;
 	}
@@ -775,6 +804,8 @@ static void io_init_new_worker(struct io_wq *wq, struct io_wq_acct *acct, struct
 	tsk->worker_private = worker;
 	worker->task = tsk;
 	set_cpus_allowed_ptr(tsk, wq->cpu_mask);
+	if (io_wq_is_bound(wq, acct))
+		atomic_inc(&io_wq_bound_workers);
 
 	raw_spin_lock(&acct->workers_lock);
 	hlist_nulls_add_head_rcu(&worker->nulls_node, &acct->free_list);
@@ -1458,6 +1489,16 @@ int io_wq_max_workers(struct io_wq *wq, int *new_count)
 	return 0;
 }
 
+static const struct ctl_table io_wq_sysctls[] = {
+	{
+		.procname	= "io_uring_max_bound_workers",
+		.data		= &sysctl_io_wq_max_bound_workers,
+		.maxlen		= sizeof(sysctl_io_wq_max_bound_workers),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec,
+	},
+};
+
 static __init int io_wq_init(void)
 {
 	int ret;
@@ -1467,6 +1508,7 @@ static __init int io_wq_init(void)
 	if (ret < 0)
 		return ret;
 	io_wq_online = ret;
+	register_sysctl_init("kernel", io_wq_sysctls);
 	return 0;
 }
 subsys_initcall(io_wq_init);
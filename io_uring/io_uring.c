@@ -149,6 +149,7 @@ static bool io_uring_try_cancel_requests(struct io_ring_ctx *ctx,
 
 static void io_queue_sqe(struct io_kiocb *req);
 static void __io_req_caches_free(struct io_ring_ctx *ctx);
+static void __io_flush_completions(struct io_ring_ctx *ctx, bool post);
 
 static __read_mostly DEFINE_STATIC_KEY_FALSE(io_key_has_sqarray);
 
@@ -884,10 +885,13 @@ bool io_req_post_cqe(struct io_kiocb *req, s32 res, u32 cflags)
 	/*
 	 * If multishot has already posted deferred completions, ensure that
 	 * those are flushed first before posting this one. If not, CQEs
-	 * could get reordered.
+	 * could get reordered. With DEFER_TASKRUN only the task running this
+	 * task_work waits on the CQ, so the CQEs are just filled in here and
+	 * the tail is published once by the flush cq_flush asks for below,
+	 * rather than bouncing the CQ tail for every multishot CQE.
 	 */
 	if (!wq_list_empty(&ctx->submit_state.compl_reqs))
-		__io_submit_flush_completions(ctx);
+		__io_flush_completions(ctx, !ctx->task_complete);
 
 	lockdep_assert(!io_wq_current_is_worker());
 	lockdep_assert_held(&ctx->uring_lock);
@@ -1453,7 +1457,7 @@ static void io_free_batch_list(struct io_ring_ctx *ctx,
 	} while (node);
 }
 
-void __io_submit_flush_completions(struct io_ring_ctx *ctx)
+static void __io_flush_completions(struct io_ring_ctx *ctx, bool post)
 	__must_hold(&ctx->uring_lock)
 {
 	struct io_submit_state *state = &ctx->submit_state;
@@ -1477,7 +1481,8 @@ void __io_submit_flush_completions(struct io_ring_ctx *ctx)
 				io_cqe_overflow_locked(ctx, &req->cqe, &req->big_cqe);
 		}
 	}
-	__io_cq_unlock_post(ctx);
+	if (post)
+		__io_cq_unlock_post(ctx);
 
 	if (!wq_list_empty(&state->compl_reqs)) {
 		io_free_batch_list(ctx, state->compl_reqs.first);
@@ -1490,6 +1495,12 @@ void __io_submit_flush_completions(struct io_ring_ctx *ctx)
 	ctx->submit_state.cq_flush = false;
 }
 
+void __io_submit_flush_completions(struct io_ring_ctx *ctx)
+	__must_hold(&ctx->uring_lock)
+{
+	__io_flush_completions(ctx, true);
+}
+
 static unsigned io_cqring_events(struct io_ring_ctx *ctx)
 {
 	/* See comment at the top of this file */
@@ -1272,7 +1272,8 @@ void io_send_zc_cleanup(struct io_kiocb *req)
 }
 
 #define IO_ZC_FLAGS_COMMON (IORING_RECVSEND_POLL_FIRST | IORING_RECVSEND_FIXED_BUF)
-#define IO_ZC_FLAGS_VALID  (IO_ZC_FLAGS_COMMON | IORING_SEND_ZC_REPORT_USAGE)
+#define IO_ZC_FLAGS_VALID  (IO_ZC_FLAGS_COMMON | IORING_SEND_ZC_REPORT_USAGE | \
+			    IORING_RECVSEND_BUNDLE)
 
 int io_send_zc_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 {
@@ -1315,6 +1316,19 @@ int io_send_zc_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 	zc->len = READ_ONCE(sqe->len);
 	zc->msg_flags = READ_ONCE(sqe->msg_flags) | MSG_NOSIGNAL | MSG_ZEROCOPY;
 	req->buf_index = READ_ONCE(sqe->buf_index);
+	/*
+	 * Provided buffers are selected at issue time. A bundle maps as many
+	 * of them as are queued, up to ->len, into a single send; unlike a
+	 * plain send bundle it completes after that one send, as the notif
+	 * CQE already relies on IORING_CQE_F_MORE.
+	 */
+	if (req->flags & REQ_F_BUFFER_SELECT) {
+		if (zc->flags & IORING_RECVSEND_FIXED_BUF)
+			return -EINVAL;
+		zc->buf_group = req->buf_index;
+	} else if (zc->flags & IORING_RECVSEND_BUNDLE) {
+		return -EINVAL;
+	}
 	if (zc->msg_flags & MSG_DONTWAIT)
 		req->flags |= REQ_F_NOWAIT;
 
@@ -1337,6 +1351,8 @@ int io_send_zc_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 
 	if (!(zc->flags & IORING_RECVSEND_FIXED_BUF)) {
 		iomsg->msg.sg_from_iter = io_sg_from_iter_iovec;
+		if (req->flags & REQ_F_BUFFER_SELECT)
+			return 0;
 		return io_notif_account_mem(zc->notif, iomsg->msg.msg_iter.count);
 	}
 	iomsg->msg.sg_from_iter = io_sg_from_iter;
@@ -1411,7 +1427,7 @@ int io_send_zc(struct io_kiocb *req, unsigned int issue_flags)
 	struct io_sr_msg *zc = io_kiocb_to_cmd(req, struct io_sr_msg);
 	struct io_async_msghdr *kmsg = req->async_data;
 	struct socket *sock;
-	unsigned msg_flags;
+	unsigned msg_flags, cflags;
 	int ret, min_ret = 0;
 
 	sock = sock_from_file(req->file);
@@ -1430,6 +1446,17 @@ int io_send_zc(struct io_kiocb *req, unsigned int issue_flags)
 		if (unlikely(ret))
 			return ret;
 	}
+	if (io_do_buffer_select(req)) {
+		ret = io_send_select_buffer(req, issue_flags, kmsg);
+		if (unlikely(ret))
+			return ret;
+		/* a retry selects again, but the notif is only charged once */
+		if (!io_notif_to_data(zc->notif)->account_pages) {
+			ret = io_notif_account_mem(zc->notif, zc->len);
+			if (unlikely(ret))
+				return ret;
+		}
+	}
 
 	msg_flags = zc->msg_flags;
 	if (issue_flags & IO_URING_F_NONBLOCK)
@@ -1463,6 +1490,11 @@ int io_send_zc(struct io_kiocb *req, unsigned int issue_flags)
 	else if (zc->done_io)
 		ret = zc->done_io;
 
+	if (zc->flags & IORING_RECVSEND_BUNDLE)
+		cflags = io_put_kbufs(req, ret, io_bundle_nbufs(kmsg, ret), issue_flags);
+	else
+		cflags = io_put_kbuf(req, ret, issue_flags);
+
 	/*
 	 * If we're in io-wq we can't rely on tw ordering guarantees, defer
 	 * flushing notif to io_send_zc_cleanup()
@@ -1472,7 +1504,7 @@ int io_send_zc(struct io_kiocb *req, unsigned int issue_flags)
 		zc->notif = NULL;
 		io_req_msg_cleanup(req, 0);
 	}
-	io_req_set_res(req, ret, IORING_CQE_F_MORE);
+	io_req_set_res(req, ret, cflags | IORING_CQE_F_MORE);
 	return IOU_COMPLETE;
 }
 
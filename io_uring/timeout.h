@@ -6,6 +6,7 @@ struct io_timeout_data {
 	struct timespec64		ts;
 	enum hrtimer_mode		mode;
 	u32				flags;
+	u64				slack;
 };
 
 __cold void io_flush_timeouts(struct io_ring_ctx *ctx);
@@ -283,15 +283,22 @@ static int io_zcrx_map_area(struct io_zcrx_ifq *ifq, struct io_zcrx_area *area)
 	return 0;
 }
 
+static bool io_zcrx_need_sync(const struct page_pool *pool)
+{
+#if defined(CONFIG_HAS_DMA) && defined(CONFIG_DMA_NEED_SYNC)
+	return dma_dev_need_sync(pool->p.dev);
+#else
+	return false;
+#endif
+}
+
+/* Callers check io_zcrx_need_sync() once per batch */
 static void io_zcrx_sync_for_device(const struct page_pool *pool,
 				    struct net_iov *niov)
 {
 #if defined(CONFIG_HAS_DMA) && defined(CONFIG_DMA_NEED_SYNC)
 	dma_addr_t dma_addr;
 
-	if (!dma_dev_need_sync(pool->p.dev))
-		return;
-
 	dma_addr = page_pool_get_dma_addr_netmem(net_iov_to_netmem(niov));
 	__dma_sync_single_for_device(pool->p.dev, dma_addr + pool->p.offset,
 				     PAGE_SIZE, pool->p.dma_dir);
@@ -740,7 +747,9 @@ static void io_zcrx_ring_refill(struct page_pool *pp,
 				struct io_zcrx_ifq *ifq)
 {
 	unsigned int mask = ifq->rq_entries - 1;
-	unsigned int entries;
+	unsigned int entries, invalid = 0;
+	unsigned int cached = pp->alloc.count;
+	bool need_sync = io_zcrx_need_sync(pp);
 	netmem_ref netmem;
 
 	spin_lock_bh(&ifq->rq_lock);
@@ -761,17 +770,23 @@ static void io_zcrx_ring_refill(struct page_pool *pp,
 		area_idx = rqe->off >> IORING_ZCRX_AREA_SHIFT;
 		niov_idx = (rqe->off & ~IORING_ZCRX_AREA_MASK) >> PAGE_SHIFT;
 
-		if (unlikely(rqe->__pad || area_idx))
+		if (unlikely(rqe->__pad || area_idx)) {
+			invalid++;
 			continue;
+		}
 		area = ifq->area;
 
-		if (unlikely(niov_idx >= area->nia.num_niovs))
+		if (unlikely(niov_idx >= area->nia.num_niovs)) {
+			invalid++;
 			continue;
+		}
 		niov_idx = array_index_nospec(niov_idx, area->nia.num_niovs);
 
 		niov = &area->nia.niovs[niov_idx];
-		if (!io_zcrx_put_niov_uref(niov))
+		if (!io_zcrx_put_niov_uref(niov)) {
+			invalid++;
 			continue;
+		}
 
 		netmem = net_iov_to_netmem(niov);
 		if (page_pool_unref_netmem(netmem, 1) != 0)
@@ -782,17 +797,26 @@ static void io_zcrx_ring_refill(struct page_pool *pp,
 			continue;
 		}
 
-		io_zcrx_sync_for_device(pp, niov);
+		if (need_sync)
+			io_zcrx_sync_for_device(pp, niov);
 		net_mp_netmem_place_in_cache(pp, netmem);
 	} while (--entries);
 
 	smp_store_release(&ifq->rq_ring->head, ifq->cached_rq_head);
+	ifq->stat_refilled += pp->alloc.count - cached;
+	ifq->stat_rq_invalid += invalid;
 	spin_unlock_bh(&ifq->rq_lock);
 }
 
 static void io_zcrx_refill_slow(struct page_pool *pp, struct io_zcrx_ifq *ifq)
 {
 	struct io_zcrx_area *area = ifq->area;
+	bool need_sync = io_zcrx_need_sync(pp);
+	unsigned int cached = pp->alloc.count;
+
+	/* Don't bounce the freelist lock when there is nothing to take */
+	if (!data_race(area->free_count))
+		return;
 
 	spin_lock_bh(&area->freelist_lock);
 	while (area->free_count && pp->alloc.count < PP_ALLOC_CACHE_REFILL) {
@@ -800,9 +824,11 @@ static void io_zcrx_refill_slow(struct page_pool *pp, struct io_zcrx_ifq *ifq)
 		netmem_ref netmem = net_iov_to_netmem(niov);
 
 		net_mp_niov_set_page_pool(pp, niov);
-		io_zcrx_sync_for_device(pp, niov);
+		if (need_sync)
+			io_zcrx_sync_for_device(pp, niov);
 		net_mp_netmem_place_in_cache(pp, netmem);
 	}
+	ifq->stat_alloc_slow += pp->alloc.count - cached;
 	spin_unlock_bh(&area->freelist_lock);
 }
 
@@ -990,6 +1016,7 @@ static ssize_t io_zcrx_copy_chunk(struct io_kiocb *req, struct io_zcrx_ifq *ifq,
 		copied += copy_size;
 	}
 
+	ifq->stat_copied += copied;
 	return copied ? copied : ret;
 }
 
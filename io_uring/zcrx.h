@@ -54,6 +54,12 @@ struct io_zcrx_ifq {
 	spinlock_t			lock;
 	struct mutex			dma_lock;
 	struct io_mapped_region		region;
+
+	/* statistics reported in fdinfo */
+	u64				stat_refilled;	/* under rq_lock */
+	u64				stat_rq_invalid; /* under rq_lock */
+	u64				stat_alloc_slow; /* under freelist_lock */
+	u64				stat_copied;	/* bytes, from the issuer */
 };
 
 #if defined(CONFIG_IO_URING_ZCRX)
@@ -455,12 +455,22 @@ void __bpf_local_storage_insert_cache(struct bpf_local_storage *local_storage,
 {
 	unsigned long flags;
 
+	/* With more maps than cache slots, maps sharing a slot keep
+	 * evicting each other. Storage shared between CPUs (e.g. of a
+	 * cgroup) would then see every lookup take the lock below. The
+	 * cache is only a hint, so leave it alone when another CPU holds
+	 * the lock or already cached this selem.
+	 */
+	if (rcu_access_pointer(local_storage->cache[smap->cache_idx]) == SDATA(selem))
+		return;
+
 	/* spinlock is needed to avoid racing with the
 	 * parallel delete.  Otherwise, publishing an already
 	 * deleted sdata to the cache will become a use-after-free
 	 * problem in the next bpf_local_storage_lookup().
 	 */
-	raw_spin_lock_irqsave(&local_storage->lock, flags);
+	if (!raw_spin_trylock_irqsave(&local_storage->lock, flags))
+		return;
 	if (selem_linked_to_storage(selem))
 		rcu_assign_pointer(local_storage->cache[smap->cache_idx], SDATA(selem));
 	raw_spin_unlock_irqrestore(&local_storage->lock, flags);
@@ -474,6 +474,17 @@ static struct bpf_lru_node *bpf_common_lru_pop_free(struct bpf_lru *lru,
 	do {
 		steal_loc_l = per_cpu_ptr(clru->local_list, steal);
 
+		/* Once the nodes sit in local lists every update of a
+		 * full map ends up here. Skip CPUs that have nothing to
+		 * steal without bouncing their lock, a racing refill is
+		 * only seen next time.
+		 */
+		if (list_empty(local_free_list(steal_loc_l)) &&
+		    list_empty(local_pending_list(steal_loc_l))) {
+			steal = get_next_cpu(steal);
+			continue;
+		}
+
 		raw_spin_lock_irqsave(&steal_loc_l->lock, flags);
 
 		node = __local_list_pop_free(steal_loc_l);
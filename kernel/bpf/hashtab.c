@@ -16,6 +16,7 @@
 #include "bpf_lru_list.h"
 #include "map_in_map.h"
 #include <linux/bpf_mem_alloc.h>
+#include <linux/unaligned.h>
 #include <asm/rqspinlock.h>
 
 #define HTAB_CREATE_FLAG_MASK						\
@@ -613,6 +614,29 @@ static inline struct hlist_nulls_head *select_bucket(struct bpf_htab *htab, u32
 	return &__select_bucket(htab, hash)->head;
 }
 
+/* Keys are compared on every hash match, usually a few words long.
+ * Compare them inline a word at a time instead of calling memcmp(),
+ * the element key is 8 byte aligned but the caller's key may not be.
+ */
+static __always_inline bool htab_key_equal(const struct htab_elem *l,
+					   const void *key, u32 key_size)
+{
+	const char *k = key;
+	u32 off = 0;
+
+	for (; off + sizeof(u64) <= key_size; off += sizeof(u64))
+		if (*(const u64 *)(l->key + off) != get_unaligned((const u64 *)(k + off)))
+			return false;
+
+	if (off + sizeof(u32) <= key_size) {
+		if (*(const u32 *)(l->key + off) != get_unaligned((const u32 *)(k + off)))
+			return false;
+		off += sizeof(u32);
+	}
+
+	return off == key_size || !memcmp(l->key + off, k + off, key_size - off);
+}
+
 /* this lookup function can only be called with bucket lock taken */
 static struct htab_elem *lookup_elem_raw(struct hlist_nulls_head *head, u32 hash,
 					 void *key, u32 key_size)
@@ -621,7 +645,7 @@ static struct htab_elem *lookup_elem_raw(struct hlist_nulls_head *head, u32 hash
 	struct htab_elem *l;
 
 	hlist_nulls_for_each_entry_rcu(l, n, head, hash_node)
-		if (l->hash == hash && !memcmp(&l->key, key, key_size))
+		if (l->hash == hash && htab_key_equal(l, key, key_size))
 			return l;
 
 	return NULL;
@@ -640,7 +664,7 @@ static struct htab_elem *lookup_nulls_elem_raw(struct hlist_nulls_head *head,
 
 again:
 	hlist_nulls_for_each_entry_rcu(l, n, head, hash_node)
-		if (l->hash == hash && !memcmp(&l->key, key, key_size))
+		if (l->hash == hash && htab_key_equal(l, key, key_size))
 			return l;
 
 	if (unlikely(get_nulls_value(n) != (hash & (n_buckets - 1))))
@@ -417,6 +417,13 @@ static void *__bpf_ringbuf_reserve(struct bpf_ringbuf *rb, u64 size)
 
 	cons_pos = smp_load_acquire(&rb->consumer_pos);
 
+	/* producer_pos only grows, so a record that does not fit now will
+	 * not fit under the lock either. Producers of a full ring give up
+	 * here instead of queueing on the lock just to fail.
+	 */
+	if (READ_ONCE(rb->producer_pos) + len - cons_pos > rb->mask)
+		return NULL;
+
 	if (raw_res_spin_lock_irqsave(&rb->spinlock, flags))
 		return NULL;
 
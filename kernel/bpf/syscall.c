@@ -387,11 +387,19 @@ static void *__bpf_map_area_alloc(u64 size, int numa_node, bool mmapable)
 		BUG_ON(!PAGE_ALIGNED(size));
 		align = SHMLBA;
 		flags = VM_USERMAP;
-	} else if (size <= (PAGE_SIZE << PAGE_ALLOC_COSTLY_ORDER)) {
-		area = kmalloc_node(size, gfp | GFP_USER | __GFP_NORETRY,
-				    numa_node);
-		if (area != NULL)
-			return area;
+	} else {
+		if (size <= (PAGE_SIZE << PAGE_ALLOC_COSTLY_ORDER)) {
+			area = kmalloc_node(size, gfp | GFP_USER | __GFP_NORETRY,
+					    numa_node);
+			if (area != NULL)
+				return area;
+		}
+		/*
+		 * Like kvmalloc(), let large maps be backed by PMD mappings:
+		 * hash and array maps are looked up all over their area, and
+		 * nobody plays protection games with it.
+		 */
+		flags = VM_ALLOW_HUGE_VMAP;
 	}
 
 	return __vmalloc_node_range(size, align, VMALLOC_START, VMALLOC_END,
@@ -576,21 +584,20 @@ static bool can_alloc_pages(void)
 		!IS_ENABLED(CONFIG_PREEMPT_RT);
 }
 
+#define BPF_MAP_PAGE_GFP	(GFP_KERNEL | __GFP_ZERO | __GFP_ACCOUNT | __GFP_NOWARN)
+
 static struct page *__bpf_alloc_page(int nid)
 {
 	if (!can_alloc_pages())
 		return alloc_pages_nolock(nid, 0);
 
-	return alloc_pages_node(nid,
-				GFP_KERNEL | __GFP_ZERO | __GFP_ACCOUNT
-				| __GFP_NOWARN,
-				0);
+	return alloc_pages_node(nid, BPF_MAP_PAGE_GFP, 0);
 }
 
 int bpf_map_alloc_pages(const struct bpf_map *map, int nid,
 			unsigned long nr_pages, struct page **pages)
 {
-	unsigned long i, j;
+	unsigned long i = 0, j;
 	struct page *pg;
 	int ret = 0;
 #ifdef CONFIG_MEMCG
@@ -599,7 +606,13 @@ int bpf_map_alloc_pages(const struct bpf_map *map, int nid,
 	memcg = bpf_map_get_memcg(map);
 	old_memcg = set_active_memcg(memcg);
 #endif
-	for (i = 0; i < nr_pages; i++) {
+	if (nr_pages > 1 && can_alloc_pages()) {
+		/* alloc_pages_bulk() only fills in NULL entries */
+		memset(pages, 0, nr_pages * sizeof(*pages));
+		i = alloc_pages_bulk_node(BPF_MAP_PAGE_GFP, nid, nr_pages, pages);
+	}
+
+	for (; i < nr_pages; i++) {
 		pg = __bpf_alloc_page(nid);
 
 		if (pg) {
@@ -20,8 +20,8 @@ const struct bpf_verifier_ops bpf_extension_verifier_ops = {
 const struct bpf_prog_ops bpf_extension_prog_ops = {
 };
 
-/* btf_vmlinux has ~22k attachable functions. 1k htab is enough. */
-#define TRAMPOLINE_HASH_BITS 10
+/* btf_vmlinux has ~22k attachable functions. 4k htab is enough. */
+#define TRAMPOLINE_HASH_BITS 12
 #define TRAMPOLINE_TABLE_SIZE (1 << TRAMPOLINE_HASH_BITS)
 
 static struct hlist_head trampoline_table[TRAMPOLINE_TABLE_SIZE];
@@ -135,43 +135,80 @@ void bpf_image_ksym_del(struct bpf_ksym *ksym)
 			   PAGE_SIZE, true, ksym->name);
 }
 
-static struct bpf_trampoline *bpf_trampoline_lookup(u64 key)
+static struct bpf_trampoline *__bpf_trampoline_find(struct hlist_head *head,
+						     u64 key)
 {
 	struct bpf_trampoline *tr;
-	struct hlist_head *head;
-	int i;
 
-	mutex_lock(&trampoline_mutex);
-	head = &trampoline_table[hash_64(key, TRAMPOLINE_HASH_BITS)];
+	lockdep_assert_held(&trampoline_mutex);
+
 	hlist_for_each_entry(tr, head, hlist) {
 		if (tr->key == key) {
 			refcount_inc(&tr->refcnt);
-			goto out;
+			return tr;
 		}
 	}
-	tr = kzalloc(sizeof(*tr), GFP_KERNEL);
-	if (!tr)
-		goto out;
+	return NULL;
+}
+
+static void bpf_trampoline_free(struct bpf_trampoline *tr)
+{
+	if (tr->fops) {
+		ftrace_free_filter(tr->fops);
+		kfree(tr->fops);
+	}
+	kfree(tr);
+}
+
+static struct bpf_trampoline *bpf_trampoline_lookup(u64 key)
+{
+	struct bpf_trampoline *tr, *new;
+	struct hlist_head *head;
+	int i;
+
+	head = &trampoline_table[hash_64(key, TRAMPOLINE_HASH_BITS)];
+
+	mutex_lock(&trampoline_mutex);
+	tr = __bpf_trampoline_find(head, key);
+	mutex_unlock(&trampoline_mutex);
+	if (tr)
+		return tr;
+
+	/*
+	 * Attaching to many functions creates many trampolines, don't hold
+	 * trampoline_mutex over the allocations.
+	 */
+	new = kzalloc(sizeof(*new), GFP_KERNEL);
+	if (!new)
+		return NULL;
 #ifdef CONFIG_DYNAMIC_FTRACE_WITH_DIRECT_CALLS
-	tr->fops = kzalloc(sizeof(struct ftrace_ops), GFP_KERNEL);
-	if (!tr->fops) {
-		kfree(tr);
-		tr = NULL;
-		goto out;
+	new->fops = kzalloc(sizeof(struct ftrace_ops), GFP_KERNEL);
+	if (!new->fops) {
+		kfree(new);
+		return NULL;
 	}
-	tr->fops->private = tr;
-	tr->fops->ops_func = bpf_tramp_ftrace_ops_func;
+	new->fops->private = new;
+	new->fops->ops_func = bpf_tramp_ftrace_ops_func;
 #endif
 
-	tr->key = key;
-	INIT_HLIST_NODE(&tr->hlist);
-	hlist_add_head(&tr->hlist, head);
-	refcount_set(&tr->refcnt, 1);
-	mutex_init(&tr->mutex);
+	new->key = key;
+	INIT_HLIST_NODE(&new->hlist);
+	refcount_set(&new->refcnt, 1);
+	mutex_init(&new->mutex);
 	for (i = 0; i < BPF_TRAMP_MAX; i++)
-		INIT_HLIST_HEAD(&tr->progs_hlist[i]);
-out:
+		INIT_HLIST_HEAD(&new->progs_hlist[i]);
+
+	mutex_lock(&trampoline_mutex);
+	tr = __bpf_trampoline_find(head, key);
+	if (!tr) {
+		hlist_add_head(&new->hlist, head);
+		tr = new;
+		new = NULL;
+	}
 	mutex_unlock(&trampoline_mutex);
+
+	if (new)
+		bpf_trampoline_free(new);
 	return tr;
 }
 
@@ -859,11 +896,7 @@ void bpf_trampoline_put(struct bpf_trampoline *tr)
 	 * multiple rcu callbacks.
 	 */
 	hlist_del(&tr->hlist);
-	if (tr->fops) {
-		ftrace_free_filter(tr->fops);
-		kfree(tr->fops);
-	}
-	kfree(tr);
+	bpf_trampoline_free(tr);
 out:
 	mutex_unlock(&trampoline_mutex);
 }
@@ -18741,11 +18741,12 @@ static bool states_equal(struct bpf_verifier_env *env,
 	u32 insn_idx;
 	int i;
 
-	if (old->curframe != cur->curframe)
+	/* for states to be equal callsites have to be the same
+	 * and all frame states need to be equivalent
+	 */
+	if (!same_callsites(old, cur))
 		return false;
 
-	reset_idmap_scratch(env);
-
 	/* Verification state from speculative execution simulation
 	 * must never prune a non-speculative execution one.
 	 */
@@ -18755,18 +18756,18 @@ static bool states_equal(struct bpf_verifier_env *env,
 	if (old->in_sleepable != cur->in_sleepable)
 		return false;
 
+	/* the idmap is large, don't clear it for states that fail the
+	 * cheap checks above
+	 */
+	reset_idmap_scratch(env);
+
 	if (!refsafe(old, cur, &env->idmap_scratch))
 		return false;
 
-	/* for states to be equal callsites have to be the same
-	 * and all frame states need to be equivalent
-	 */
 	for (i = 0; i <= old->curframe; i++) {
 		insn_idx = i == old->curframe
 			   ? env->insn_idx
 			   : old->frame[i + 1]->callsite;
-		if (old->frame[i]->callsite != cur->frame[i]->callsite)
-			return false;
 		if (!func_states_equal(env, old->frame[i], cur->frame[i], insn_idx, exact))
 			return false;
 	}
@@ -2988,6 +2988,8 @@ static int update_prstate(struct cpuset *cs, int new_prs)
 }
 
 static struct cpuset *cpuset_attach_old_cs;
+/* Whether all tasks come from cpusets with the effective cpus of the above */
+static bool cpuset_attach_old_cpus_same;
 
 /*
  * Check to see if a cpuset can accept a new task
@@ -3032,12 +3034,18 @@ static int cpuset_can_attach(struct cgroup_taskset *tset)
 
 	cpus_updated = !cpumask_equal(cs->effective_cpus, oldcs->effective_cpus);
 	mems_updated = !nodes_equal(cs->effective_mems, oldcs->effective_mems);
+	cpuset_attach_old_cpus_same = true;
 
 	cgroup_taskset_for_each(task, css, tset) {
 		ret = task_can_attach(task);
 		if (ret)
 			goto out_unlock;
 
+		if (task_cs(task) != oldcs &&
+		    !cpumask_equal(task_cs(task)->effective_cpus,
+				   oldcs->effective_cpus))
+			cpuset_attach_old_cpus_same = false;
+
 		/*
 		 * Skip rights over task check in v2 when nothing changes,
 		 * migration permission derives from hierarchy ownership in
@@ -3164,8 +3172,18 @@ static void cpuset_attach(struct cgroup_taskset *tset)
 
 	guarantee_online_mems(cs, &cpuset_attach_nodemask_to);
 
-	cgroup_taskset_for_each(task, css, tset)
-		cpuset_attach_task(cs, task);
+	cgroup_taskset_for_each(task, css, tset) {
+		/*
+		 * Same as above, with only the mems changed there is no need
+		 * to go through set_cpus_allowed_ptr() and the rq locks. The
+		 * tasks may come from several cpusets though, and
+		 * cpus_updated only compares against the first one.
+		 */
+		if (cpuset_v2() && !cpus_updated && cpuset_attach_old_cpus_same)
+			cpuset_change_task_nodemask(task, &cpuset_attach_nodemask_to);
+		else
+			cpuset_attach_task(cs, task);
+	}
 
 	/*
 	 * Change mm for all threadgroup leaders. This is expensive and may
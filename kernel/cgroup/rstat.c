@@ -11,6 +11,7 @@
 
 static DEFINE_SPINLOCK(rstat_base_lock);
 static DEFINE_PER_CPU(raw_spinlock_t, rstat_base_cpu_lock);
+static int rstat_base_flush_cpu = -1;
 
 static void cgroup_base_stat_flush(struct cgroup *cgrp, int cpu);
 
@@ -65,6 +66,14 @@ static raw_spinlock_t *ss_rstat_cpu_lock(struct cgroup_subsys *ss, int cpu)
 	return per_cpu_ptr(&rstat_base_cpu_lock, cpu);
 }
 
+static int *ss_rstat_flush_cpu(struct cgroup_subsys *ss)
+{
+	if (ss)
+		return &ss->rstat_flush_cpu;
+
+	return &rstat_base_flush_cpu;
+}
+
 /*
  * Helper functions for rstat per CPU locks.
  *
@@ -406,7 +415,7 @@ static inline void __css_rstat_unlock(struct cgroup_subsys_state *css,
  */
 __bpf_kfunc void css_rstat_flush(struct cgroup_subsys_state *css)
 {
-	int cpu;
+	int cpu, *flushing;
 	bool is_self = css_is_self(css);
 
 	/*
@@ -416,12 +425,34 @@ __bpf_kfunc void css_rstat_flush(struct cgroup_subsys_state *css)
 	if (!css_uses_rstat(css))
 		return;
 
+	flushing = ss_rstat_flush_cpu(css->ss);
 	might_sleep();
 	for_each_possible_cpu(cpu) {
 		struct cgroup_subsys_state *pos;
 
+		/*
+		 * Speculative not-on-list test, see css_rstat_updated(). An
+		 * update racing with it is no different from one that lands
+		 * right after the flush of this CPU, and skipping here avoids
+		 * the subsystem lock for every CPU @css has nothing on.
+		 *
+		 * @css is also off-list while a concurrent flush of an
+		 * ancestor, which unlinked it, is still propagating its stats.
+		 * Wait for that flush on the lock like before, so that stats
+		 * are up to date when this function returns.
+		 */
+		if (!READ_ONCE(css_rstat_cpu(css, cpu)->updated_next)) {
+			/* Pairs with smp_wmb() and smp_store_release() below */
+			smp_rmb();
+			if (smp_load_acquire(flushing) != cpu)
+				continue;
+		}
+
 		/* Reacquire for each CPU to avoid disabling IRQs too long */
 		__css_rstat_lock(css, cpu);
+		WRITE_ONCE(*flushing, cpu);
+		/* Publish the flush before unlinking the subtree */
+		smp_wmb();
 		pos = css_rstat_updated_list(css, cpu);
 		for (; pos; pos = pos->rstat_flush_next) {
 			if (is_self) {
@@ -431,6 +462,7 @@ __bpf_kfunc void css_rstat_flush(struct cgroup_subsys_state *css)
 			} else
 				pos->ss->css_rstat_flush(pos, cpu);
 		}
+		smp_store_release(flushing, -1);
 		__css_rstat_unlock(css, cpu);
 		if (!cond_resched())
 			cpu_relax();
@@ -533,6 +565,7 @@ int __init ss_rstat_init(struct cgroup_subsys *ss)
 	}
 
 	spin_lock_init(ss_rstat_lock(ss));
+	*ss_rstat_flush_cpu(ss) = -1;
 	for_each_possible_cpu(cpu)
 		raw_spin_lock_init(ss_rstat_cpu_lock(ss, cpu));
 
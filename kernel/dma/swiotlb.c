@@ -1058,6 +1058,13 @@ static int swiotlb_search_pool_area(struct device *dev, struct io_tlb_pool *pool
 	 */
 	stride = get_max_slots(max(alloc_align_mask, iotlb_align_mask));
 
+	/*
+	 * Racy check to move on to the next area without bouncing the lock
+	 * of one that is too full, it is repeated under the lock below.
+	 */
+	if (unlikely(nslots > pool->area_nslabs - READ_ONCE(area->used)))
+		return -1;
+
 	spin_lock_irqsave(&area->lock, flags);
 	if (unlikely(nslots > pool->area_nslabs - area->used))
 		goto not_found;
@@ -1113,7 +1120,7 @@ static int swiotlb_search_pool_area(struct device *dev, struct io_tlb_pool *pool
 	 * Update the indices to avoid searching in the next round.
 	 */
 	area->index = wrap_area_index(pool, index + nslots);
-	area->used += nslots;
+	WRITE_ONCE(area->used, area->used + nslots);
 	spin_unlock_irqrestore(&area->lock, flags);
 
 	inc_used_and_hiwater(dev->dma_io_tlb_mem, nslots);
@@ -1488,7 +1495,7 @@ static void swiotlb_release_slots(struct device *dev, phys_addr_t tlb_addr,
 	     io_tlb_offset(i) != IO_TLB_SEGSIZE - 1 && mem->slots[i].list;
 	     i--)
 		mem->slots[i].list = ++count;
-	area->used -= nslots;
+	WRITE_ONCE(area->used, area->used - nslots);
 	spin_unlock_irqrestore(&area->lock, flags);
 
 	dec_used(dev->dma_io_tlb_mem, nslots);
@@ -5900,6 +5900,20 @@ static u64 __perf_event_read_value(struct perf_event *event, u64 *enabled, u64 *
 	return total;
 }
 
+static u64 perf_event_lost_samples(struct perf_event *event)
+{
+	struct perf_event *child;
+	u64 lost;
+
+	mutex_lock(&event->child_mutex);
+	lost = atomic64_read(&event->lost_samples);
+	list_for_each_entry(child, &event->child_list, child_list)
+		lost += atomic64_read(&child->lost_samples);
+	mutex_unlock(&event->child_mutex);
+
+	return lost;
+}
+
 u64 perf_event_read_value(struct perf_event *event, u64 *enabled, u64 *running)
 {
 	struct perf_event_context *ctx;
@@ -5977,14 +5991,14 @@ static int __perf_read_group_add(struct perf_event *leader,
 	if (read_format & PERF_FORMAT_ID)
 		values[n++] = primary_event_id(leader);
 	if (read_format & PERF_FORMAT_LOST)
-		values[n++] = atomic64_read(&leader->lost_samples);
+		values[n++] += atomic64_read(&leader->lost_samples);
 
 	for_each_sibling_event(sub, leader) {
 		values[n++] += perf_event_count(sub, false);
 		if (read_format & PERF_FORMAT_ID)
 			values[n++] = primary_event_id(sub);
 		if (read_format & PERF_FORMAT_LOST)
-			values[n++] = atomic64_read(&sub->lost_samples);
+			values[n++] += atomic64_read(&sub->lost_samples);
 	}
 
 unlock:
@@ -6049,7 +6063,7 @@ static int perf_read_one(struct perf_event *event,
 	if (read_format & PERF_FORMAT_ID)
 		values[n++] = primary_event_id(event);
 	if (read_format & PERF_FORMAT_LOST)
-		values[n++] = atomic64_read(&event->lost_samples);
+		values[n++] = perf_event_lost_samples(event);
 
 	if (copy_to_user(buf, values, n * sizeof(u64)))
 		return -EFAULT;
@@ -13972,6 +13986,8 @@ static void sync_child_event(struct perf_event *child_event)
 		     &parent_event->child_total_time_enabled);
 	atomic64_add(child_event->total_time_running,
 		     &parent_event->child_total_time_running);
+	atomic64_add(atomic64_read(&child_event->lost_samples),
+		     &parent_event->lost_samples);
 }
 
 static void
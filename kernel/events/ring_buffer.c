@@ -155,6 +155,7 @@ __perf_output_begin(struct perf_output_handle *handle,
 		    struct perf_event *event, unsigned int size,
 		    bool backward)
 {
+	struct perf_event *sampled = event;
 	struct perf_buffer *rb;
 	unsigned long tail, offset, head;
 	int have_lost, page_shift;
@@ -167,6 +168,9 @@ __perf_output_begin(struct perf_output_handle *handle,
 	rcu_read_lock();
 	/*
 	 * For inherited events we send all the output towards the parent.
+	 * Lost samples are still counted on the child, children on other
+	 * CPUs shouldn't all hit the parent's counter when the buffer
+	 * overflows. See perf_event_lost_samples().
 	 */
 	if (event->parent)
 		event = event->parent;
@@ -178,7 +182,7 @@ __perf_output_begin(struct perf_output_handle *handle,
 	if (unlikely(rb->paused)) {
 		if (rb->nr_pages) {
 			local_inc(&rb->lost);
-			atomic64_inc(&event->lost_samples);
+			atomic64_inc(&sampled->lost_samples);
 		}
 		goto out;
 	}
@@ -262,7 +266,7 @@ __perf_output_begin(struct perf_output_handle *handle,
 
 fail:
 	local_inc(&rb->lost);
-	atomic64_inc(&event->lost_samples);
+	atomic64_inc(&sampled->lost_samples);
 	perf_output_put_handle(handle);
 out:
 	rcu_read_unlock();
@@ -1259,6 +1259,17 @@ build_map_info(struct address_space *mapping, loff_t offset, bool is_register)
 	return curr;
 }
 
+static bool file_is_mapped(struct address_space *mapping)
+{
+	bool mapped;
+
+	i_mmap_lock_read(mapping);
+	mapped = mapping_mapped(mapping);
+	i_mmap_unlock_read(mapping);
+
+	return mapped;
+}
+
 static int
 register_for_each_vma(struct uprobe *uprobe, struct uprobe_consumer *new)
 {
@@ -1266,6 +1277,15 @@ register_for_each_vma(struct uprobe *uprobe, struct uprobe_consumer *new)
 	struct map_info *info;
 	int err = 0;
 
+	/*
+	 * The uprobe and its consumers are visible to uprobe_mmap() already,
+	 * so if nothing maps the file there is no breakpoint to handle here:
+	 * a later mmap() installs them, and fork() can't copy a mapping that
+	 * doesn't exist. Don't bother with dup_mmap_sem and the rmap walk.
+	 */
+	if (!file_is_mapped(uprobe->inode->i_mapping))
+		return 0;
+
 	percpu_down_write(&dup_mmap_sem);
 	info = build_map_info(uprobe->inode->i_mapping,
 					uprobe->offset, is_register);
@@ -1162,6 +1162,58 @@ void mmput_async(struct mm_struct *mm)
 	}
 }
 EXPORT_SYMBOL_GPL(mmput_async);
+
+/* Exiting address spaces with at least this much RSS are torn down async */
+static unsigned long sysctl_exit_mmap_async_mb;
+
+/**
+ * mmput_exit - drop an exiting task's reference to its mm
+ * @mm: the mm of the exiting task
+ *
+ * Like mmput(), but when the last reference to an address space of at
+ * least vm.exit_mmap_async_mb is dropped, the teardown is handed to an
+ * unbound kworker of the node the task exits on. The exit, and with it
+ * the parent's wait(), then no longer waits for the memory to be freed.
+ * OOM victims are always torn down synchronously, the OOM killer relies
+ * on their memory being gone once they have exited.
+ */
+void mmput_exit(struct mm_struct *mm)
+{
+	unsigned long min_mb = READ_ONCE(sysctl_exit_mmap_async_mb);
+
+	might_sleep();
+
+	if (!min_mb || tsk_is_oom_victim(current) ||
+	    get_mm_rss(mm) < (min_mb << (20 - PAGE_SHIFT))) {
+		mmput(mm);
+		return;
+	}
+
+	if (atomic_dec_and_test(&mm->mm_users)) {
+		INIT_WORK(&mm->async_put_work, mmput_async_fn);
+		queue_work_node(numa_node_id(), system_unbound_wq,
+				&mm->async_put_work);
+	}
+}
+
+#ifdef CONFIG_SYSCTL
+static const struct ctl_table vm_exit_mmap_table[] = {
+	{
+		.procname	= "exit_mmap_async_mb",
+		.data		= &sysctl_exit_mmap_async_mb,
+		.maxlen		= sizeof(sysctl_exit_mmap_async_mb),
+		.mode		= 0644,
+		.proc_handler	= proc_doulongvec_minmax,
+	},
+};
+
+static int __init exit_mmap_sysctl_init(void)
+{
+	register_sysctl_init("vm", vm_exit_mmap_table);
+	return 0;
+}
+late_initcall(exit_mmap_sysctl_init);
+#endif
 #endif
 
 /**
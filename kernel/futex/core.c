@@ -71,9 +71,15 @@ struct futex_private_hash {
 	void		*mm;
 	bool		custom;
 	bool		immutable;
+	atomic_t	collisions;
+	unsigned long	collision_stamp;
+	unsigned long	flags;
 	struct futex_hash_bucket queues[];
 };
 
+/* futex_private_hash::flags */
+#define FPH_GROW	0
+
 /*
  * Fault injections for futexes.
  */
@@ -127,6 +133,7 @@ late_initcall(fail_futex_debugfs);
 
 static struct futex_hash_bucket *
 __futex_hash(union futex_key *key, struct futex_private_hash *fph);
+static int futex_hash_allocate(unsigned int hash_slots, unsigned int flags);
 
 #ifdef CONFIG_FUTEX_PRIVATE_HASH
 static inline bool futex_key_is_private(union futex_key *key)
@@ -315,6 +322,70 @@ struct futex_hash_bucket *futex_hash(union futex_key *key)
 	goto again;
 }
 
+/*
+ * The default private hash is sized from the number of threads at clone()
+ * time, which says little about how many futexes are actually in use. Count
+ * waiters that get queued behind a different futex in the same bucket; once
+ * a second's worth of those exceeds twice the number of buckets, ask for the
+ * hash to be doubled. Hashes sized through prctl() are left alone.
+ */
+#define FUTEX_COLLISION_FACTOR	2
+
+static void futex_hash_note_collision(struct futex_hash_bucket *hb,
+				      struct futex_q *q)
+{
+	struct futex_private_hash *fph = hb->priv;
+	struct futex_q *first;
+	unsigned long now;
+
+	lockdep_assert_held(&hb->lock);
+
+	if (!fph || fph->custom || plist_head_empty(&hb->chain))
+		return;
+
+	first = plist_first_entry(&hb->chain, struct futex_q, list);
+	if (futex_match(&first->key, &q->key))
+		return;
+
+	now = jiffies;
+	if (time_after(now, READ_ONCE(fph->collision_stamp) + HZ)) {
+		WRITE_ONCE(fph->collision_stamp, now);
+		atomic_set(&fph->collisions, 0);
+	}
+
+	if (atomic_inc_return(&fph->collisions) ==
+	    FUTEX_COLLISION_FACTOR * (fph->hash_mask + 1))
+		set_bit(FPH_GROW, &fph->flags);
+}
+
+/**
+ * futex_private_hash_grow - Double the private hash if it was found too small
+ *
+ * Called by waiters from sleepable context once they are done waiting, see
+ * futex_hash_note_collision().
+ */
+void futex_private_hash_grow(void)
+{
+	unsigned int buckets;
+
+	scoped_guard(rcu) {
+		struct futex_private_hash *fph;
+
+		fph = rcu_dereference(current->mm->futex_phash);
+		if (!fph || !test_bit(FPH_GROW, &fph->flags))
+			return;
+		if (!test_and_clear_bit(FPH_GROW, &fph->flags))
+			return;
+
+		buckets = (fph->hash_mask + 1) * 2;
+	}
+
+	if (buckets > futex_hashmask + 1)
+		return;
+
+	futex_hash_allocate(buckets, 0);
+}
+
 #else /* !CONFIG_FUTEX_PRIVATE_HASH */
 
 static struct futex_hash_bucket *
@@ -323,6 +394,9 @@ __futex_hash_private(union futex_key *key, struct futex_private_hash *fph)
 	return NULL;
 }
 
+static inline void futex_hash_note_collision(struct futex_hash_bucket *hb,
+					     struct futex_q *q) { }
+
 struct futex_hash_bucket *futex_hash(union futex_key *key)
 {
 	return __futex_hash(key, NULL);
@@ -902,6 +976,8 @@ void __futex_queue(struct futex_q *q, struct futex_hash_bucket *hb,
 	 */
 	prio = min(current->normal_prio, MAX_RT_PRIO);
 
+	futex_hash_note_collision(hb, q);
+
 	plist_node_init(&q->list, prio);
 	plist_add(&q->list, &hb->chain);
 	q->task = task;
@@ -230,6 +230,7 @@ extern void futex_hash_put(struct futex_hash_bucket *hb);
 extern struct futex_private_hash *futex_private_hash(void);
 extern bool futex_private_hash_get(struct futex_private_hash *fph);
 extern void futex_private_hash_put(struct futex_private_hash *fph);
+extern void futex_private_hash_grow(void);
 
 #else /* !CONFIG_FUTEX_PRIVATE_HASH */
 static inline void futex_hash_get(struct futex_hash_bucket *hb) { }
@@ -237,6 +238,7 @@ static inline void futex_hash_put(struct futex_hash_bucket *hb) { }
 static inline struct futex_private_hash *futex_private_hash(void) { return NULL; }
 static inline bool futex_private_hash_get(void) { return false; }
 static inline void futex_private_hash_put(struct futex_private_hash *fph) { }
+static inline void futex_private_hash_grow(void) { }
 #endif
 
 DEFINE_CLASS(hb, struct futex_hash_bucket *,
@@ -494,6 +496,12 @@ extern int futex_wait_multiple(struct futex_vector *vs, unsigned int count,
 
 extern int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset);
 
+extern int futex_parse_wakev(struct futex_waitv *futexv,
+			     struct futex_waitv __user *uwakev,
+			     unsigned int nr_futexes);
+
+extern int futex_wake_multiple(struct futex_waitv *vs, unsigned int count);
+
 extern int futex_wake_op(u32 __user *uaddr1, unsigned int flags,
 			 u32 __user *uaddr2, int nr_wake, int nr_wake2, int op);
 
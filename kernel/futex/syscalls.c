@@ -224,6 +224,47 @@ int futex_parse_waitv(struct futex_vector *futexv,
 	return 0;
 }
 
+/**
+ * futex_parse_wakev - Parse a wake list from userspace
+ * @futexv:	Kernel side list of futexes to be filled
+ * @uwakev:	Userspace list to be parsed
+ * @nr_futexes: Length of futexv
+ *
+ * Uses the same layout as futex_waitv, with futex_waitv::val holding the
+ * maximum number of waiters to wake on futex_waitv::uaddr. On success the
+ * flags in @futexv are converted to FLAGS_*.
+ *
+ * Return: Error code on failure, 0 on success
+ */
+int futex_parse_wakev(struct futex_waitv *futexv,
+		      struct futex_waitv __user *uwakev,
+		      unsigned int nr_futexes)
+{
+	unsigned int i;
+
+	if (copy_from_user(futexv, uwakev, nr_futexes * sizeof(*futexv)))
+		return -EFAULT;
+
+	for (i = 0; i < nr_futexes; i++) {
+		unsigned int flags;
+
+		if ((futexv[i].flags & ~FUTEX2_VALID_MASK) ||
+		    futexv[i].__reserved)
+			return -EINVAL;
+
+		flags = futex2_to_flags(futexv[i].flags);
+		if (!futex_flags_valid(flags))
+			return -EINVAL;
+
+		if (futexv[i].val > INT_MAX)
+			return -EINVAL;
+
+		futexv[i].flags = flags;
+	}
+
+	return 0;
+}
+
 static int futex2_setup_timeout(struct __kernel_timespec __user *timeout,
 				clockid_t clockid, struct hrtimer_sleeper *to)
 {
@@ -354,6 +395,47 @@ SYSCALL_DEFINE4(futex_wake,
 	return futex_wake(uaddr, FLAGS_STRICT | flags, nr, mask);
 }
 
+/*
+ * sys_futex_wakev - Wake a number of waiters on a list of futexes
+ * @wakers:	List of futexes to wake
+ * @nr_futexes:	Length of @wakers
+ * @flags:	unused
+ *
+ * Given an array of `struct futex_waitv`, wake up to `val` waiters on each
+ * `uaddr`, using the per-entry FUTEX2 flags. This is the same as calling
+ * futex_wake() with FUTEX_BITSET_MATCH_ANY on every entry, except that all
+ * wakeups are issued together at the end.
+ *
+ * Returns the total number of woken waiters, or the error of the first entry
+ * that failed.
+ */
+
+SYSCALL_DEFINE3(futex_wakev,
+		struct futex_waitv __user *, wakers,
+		unsigned int, nr_futexes,
+		unsigned int, flags)
+{
+	struct futex_waitv *futexv;
+	int ret;
+
+	if (flags)
+		return -EINVAL;
+
+	if (!nr_futexes || nr_futexes > FUTEX_WAITV_MAX || !wakers)
+		return -EINVAL;
+
+	futexv = kcalloc(nr_futexes, sizeof(*futexv), GFP_KERNEL);
+	if (!futexv)
+		return -ENOMEM;
+
+	ret = futex_parse_wakev(futexv, wakers, nr_futexes);
+	if (!ret)
+		ret = futex_wake_multiple(futexv, nr_futexes);
+
+	kfree(futexv);
+	return ret;
+}
+
 /*
  * sys_futex_wait - Wait on a futex
  * @uaddr:	Address of the futex to wait on
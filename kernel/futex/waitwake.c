@@ -150,13 +150,14 @@ void futex_wake_mark(struct wake_q_head *wake_q, struct futex_q *q)
 }
 
 /*
- * Wake up waiters matching bitset queued on this futex (uaddr).
+ * Mark up to @nr_wake waiters matching bitset queued on this futex (uaddr) for
+ * wakeup on @wake_q. The caller issues the wakeups.
  */
-int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
+static int __futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake,
+			u32 bitset, struct wake_q_head *wake_q)
 {
 	struct futex_q *this, *next;
 	union futex_key key = FUTEX_KEY_INIT;
-	DEFINE_WAKE_Q(wake_q);
 	int ret;
 
 	if (!bitset)
@@ -188,17 +189,61 @@ int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
 			if (!(this->bitset & bitset))
 				continue;
 
-			this->wake(&wake_q, this);
+			this->wake(wake_q, this);
 			if (++ret >= nr_wake)
 				break;
 		}
 	}
 
 	spin_unlock(&hb->lock);
+	return ret;
+}
+
+/*
+ * Wake up waiters matching bitset queued on this futex (uaddr).
+ */
+int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
+{
+	DEFINE_WAKE_Q(wake_q);
+	int ret;
+
+	ret = __futex_wake(uaddr, flags, nr_wake, bitset, &wake_q);
 	wake_up_q(&wake_q);
 	return ret;
 }
 
+/**
+ * futex_wake_multiple - Wake waiters on a list of futexes
+ * @vs:		List of futexes to wake, as parsed by futex_parse_wakev()
+ * @count:	Length of @vs
+ *
+ * For each entry wake up to @vs[i].val waiters of @vs[i].uaddr. All wakeups
+ * are collected and issued in one go once every futex has been processed.
+ *
+ * Return: the total number of woken waiters, or the error of the first entry
+ * that failed. Waiters of the entries before a failing one are still woken.
+ */
+int futex_wake_multiple(struct futex_waitv *vs, unsigned int count)
+{
+	DEFINE_WAKE_Q(wake_q);
+	int ret, woken = 0;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		ret = __futex_wake(u64_to_user_ptr(vs[i].uaddr),
+				   FLAGS_STRICT | vs[i].flags, vs[i].val,
+				   FUTEX_BITSET_MATCH_ANY, &wake_q);
+		if (ret < 0) {
+			woken = ret;
+			break;
+		}
+		woken += ret;
+	}
+
+	wake_up_q(&wake_q);
+	return woken;
+}
+
 static int futex_atomic_op_inuser(unsigned int encoded_op, u32 __user *uaddr)
 {
 	unsigned int op =	  (encoded_op & 0x70000000) >> 28;
@@ -714,6 +759,9 @@ int futex_wait(u32 __user *uaddr, unsigned int flags, u32 val, ktime_t *abs_time
 
 	ret = __futex_wait(uaddr, flags, val, to, bitset);
 
+	if (!(flags & FLAGS_SHARED))
+		futex_private_hash_grow();
+
 	/* No timeout, nothing to clean up. */
 	if (!to)
 		return ret;
@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * In-kernel interrupt load balancing.
+ *
+ * A periodic pass samples the interrupt counts of all active interrupts
+ * and accounts them to the CPU each interrupt is currently targeted at.
+ * Within every NUMA node the hottest movable interrupt of the most
+ * loaded CPU is then moved to the least loaded CPU of the same node,
+ * provided the imbalance is large enough and the move actually reduces
+ * the maximum load. Interrupts never leave their node, managed and per
+ * CPU interrupts are never touched and interrupts which were pinned to
+ * a single CPU by somebody else are left alone.
+ */
+#include <linux/cpumask.h>
+#include <linux/interrupt.h>
+#include <linux/irq.h>
+#include <linux/jiffies.h>
+#include <linux/kernel_stat.h>
+#include <linux/moduleparam.h>
+#include <linux/nodemask.h>
+#include <linux/percpu.h>
+#include <linux/workqueue.h>
+
+#include "internals.h"
+
+#ifdef MODULE_PARAM_PREFIX
+#undef MODULE_PARAM_PREFIX
+#endif
+#define MODULE_PARAM_PREFIX "irqbalance."
+
+/* Number of intervals a moved interrupt stays put before it is considered again */
+#define IRQBAL_COOLDOWN		10
+
+struct irqbal_cpu {
+	unsigned long	load;		/* Interrupts in the last interval */
+	unsigned long	cand_delta;	/* Interrupts of the hottest movable irq */
+	unsigned int	cand_irq;	/* The hottest movable irq */
+};
+
+static DEFINE_PER_CPU(struct irqbal_cpu, irqbal_cpus);
+
+static bool irqbal_enable;
+static unsigned int irqbal_interval_ms = 1000;
+module_param_named(interval_ms, irqbal_interval_ms, uint, 0644);
+static unsigned int irqbal_imbalance_pct = 25;
+module_param_named(imbalance_pct, irqbal_imbalance_pct, uint, 0644);
+static unsigned int irqbal_min_rate = 1000;
+module_param_named(min_rate, irqbal_min_rate, uint, 0644);
+static unsigned int irqbal_max_moves = 2;
+module_param_named(max_moves, irqbal_max_moves, uint, 0644);
+
+static bool irqbal_ready;
+static bool irqbal_primed;
+static cpumask_var_t irqbal_mask;
+
+static void irqbal_work_fn(struct work_struct *work);
+static DECLARE_DELAYED_WORK(irqbal_work, irqbal_work_fn);
+
+static unsigned long irqbal_interval(void)
+{
+	return msecs_to_jiffies(max(READ_ONCE(irqbal_interval_ms), 10U));
+}
+
+static bool irqbal_movable(struct irq_desc *desc)
+{
+	const struct cpumask *aff = irq_data_get_affinity_mask(&desc->irq_data);
+
+	if (!desc->action || !irq_can_set_affinity_usr(irq_desc_get_irq(desc)))
+		return false;
+	/* Pinned to a single CPU by user space or the driver */
+	if (cpumask_weight(aff) == 1 && cpumask_first(aff) + 1 != desc->balance_cpu)
+		return false;
+	if (desc->balance_cpu &&
+	    time_before(jiffies, desc->balance_moved + IRQBAL_COOLDOWN * irqbal_interval()))
+		return false;
+	return true;
+}
+
+/*
+ * An interrupt with a multi CPU affinity mask may only be narrowed to a
+ * CPU within that mask. A single CPU mask was installed by a previous
+ * pass (irqbal_movable() rejects all others) and may move anywhere in
+ * the node.
+ */
+static bool irqbal_target_ok(struct irq_desc *desc, unsigned int cpu)
+{
+	const struct cpumask *aff = irq_data_get_affinity_mask(&desc->irq_data);
+
+	return cpumask_weight(aff) == 1 || cpumask_test_cpu(cpu, aff);
+}
+
+static void irqbal_sample(void)
+{
+	struct irqbal_cpu *st;
+	struct irq_desc *desc;
+	unsigned int irq, cpu, cnt, delta;
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(&irqbal_cpus, cpu), 0, sizeof(struct irqbal_cpu));
+
+	for_each_active_irq(irq) {
+		desc = irq_to_desc(irq);
+		if (!desc || !desc->kstat_irqs)
+			continue;
+
+		cnt = kstat_irqs_usr(irq);
+		delta = cnt - desc->balance_count;
+		desc->balance_count = cnt;
+		if (!delta)
+			continue;
+
+		cpu = cpumask_first(irq_data_get_effective_affinity_mask(&desc->irq_data));
+		if (cpu >= nr_cpu_ids)
+			continue;
+
+		st = per_cpu_ptr(&irqbal_cpus, cpu);
+		st->load += delta;
+		if (delta > st->cand_delta && irqbal_movable(desc)) {
+			st->cand_delta = delta;
+			st->cand_irq = irq;
+		}
+	}
+}
+
+static unsigned int irqbal_balance_node(int nid, unsigned long min_load)
+{
+	struct irqbal_cpu *st, *hot = NULL, *cold = NULL;
+	unsigned int cpu, hot_cpu = 0, cold_cpu = 0;
+	struct irq_desc *desc;
+
+	cpumask_and(irqbal_mask, cpumask_of_node(nid), cpu_online_mask);
+	for_each_cpu(cpu, irqbal_mask) {
+		st = per_cpu_ptr(&irqbal_cpus, cpu);
+		if (!hot || st->load > hot->load) {
+			hot = st;
+			hot_cpu = cpu;
+		}
+	}
+
+	/* Only CPUs in the default affinity mask receive interrupts */
+	cpumask_and(irqbal_mask, irqbal_mask, irq_default_affinity);
+	for_each_cpu(cpu, irqbal_mask) {
+		st = per_cpu_ptr(&irqbal_cpus, cpu);
+		if (!cold || st->load < cold->load) {
+			cold = st;
+			cold_cpu = cpu;
+		}
+	}
+
+	if (!hot || !cold || hot == cold || !hot->cand_delta || hot->load < min_load)
+		return 0;
+	if (hot->load * 100 <= cold->load * (100 + READ_ONCE(irqbal_imbalance_pct)))
+		return 0;
+	/* Moving must lower the maximum, otherwise the irq just ping-pongs */
+	if (cold->load + hot->cand_delta >= hot->load)
+		return 0;
+
+	desc = irq_to_desc(hot->cand_irq);
+	if (!desc || !irqbal_target_ok(desc, cold_cpu))
+		return 0;
+	if (irq_set_affinity(hot->cand_irq, cpumask_of(cold_cpu)))
+		return 0;
+
+	desc->balance_cpu = cold_cpu + 1;
+	desc->balance_moved = jiffies;
+	pr_debug("irqbalance: irq %u CPU%u -> CPU%u (%lu/%lu)\n", hot->cand_irq,
+		 hot_cpu, cold_cpu, hot->load, cold->load);
+	return 1;
+}
+
+static void irqbal_work_fn(struct work_struct *work)
+{
+	unsigned long min_load;
+	unsigned int moves = 0;
+	int nid;
+
+	min_load = (unsigned long)READ_ONCE(irqbal_min_rate) *
+		   jiffies_to_msecs(irqbal_interval()) / MSEC_PER_SEC;
+
+	irq_lock_sparse();
+	irqbal_sample();
+	/* The first pass after enabling only establishes the baseline counts */
+	if (irqbal_primed) {
+		for_each_online_node(nid) {
+			if (moves >= READ_ONCE(irqbal_max_moves))
+				break;
+			moves += irqbal_balance_node(nid, min_load);
+		}
+	}
+	irqbal_primed = true;
+	irq_unlock_sparse();
+
+	if (READ_ONCE(irqbal_enable))
+		queue_delayed_work(system_unbound_wq, &irqbal_work, irqbal_interval());
+}
+
+static int irqbal_set_enable(const char *val, const struct kernel_param *kp)
+{
+	int ret = param_set_bool(val, kp);
+
+	/* Boot time settings are picked up by irqbal_init() */
+	if (ret || !irqbal_ready)
+		return ret;
+
+	cancel_delayed_work_sync(&irqbal_work);
+	if (irqbal_enable) {
+		irqbal_primed = false;
+		queue_delayed_work(system_unbound_wq, &irqbal_work, 0);
+	}
+	return 0;
+}
+
+static const struct kernel_param_ops irqbal_enable_ops = {
+	.set	= irqbal_set_enable,
+	.get	= param_get_bool,
+};
+module_param_cb(enable, &irqbal_enable_ops, &irqbal_enable, 0644);
+
+static int __init irqbal_init(void)
+{
+	if (!zalloc_cpumask_var(&irqbal_mask, GFP_KERNEL))
+		return -ENOMEM;
+
+	irqbal_ready = true;
+	if (irqbal_enable)
+		queue_delayed_work(system_unbound_wq, &irqbal_work, irqbal_interval());
+	return 0;
+}
+late_initcall(irqbal_init);
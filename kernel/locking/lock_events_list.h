@@ -54,6 +54,13 @@ LOCK_EVENT(lock_no_node)	/* # of locking ops w/o using percpu node    */
  */
 LOCK_EVENT(rqspinlock_lock_timeout)	/* # of locking ops that timeout	*/
 
+/*
+ * Locking events for mutex
+ */
+LOCK_EVENT(mutex_opt_lock)	/* # of opt-acquired mutexes		*/
+LOCK_EVENT(mutex_opt_fail)	/* # of failed optspins			*/
+LOCK_EVENT(mutex_opt_skip)	/* # of optspins skipped on history	*/
+
 /*
  * Locking events for rwsem
  */
@@ -64,6 +71,7 @@ LOCK_EVENT(rwsem_wake_writer)	/* # of writer wakeups			*/
 LOCK_EVENT(rwsem_opt_lock)	/* # of opt-acquired write locks	*/
 LOCK_EVENT(rwsem_opt_fail)	/* # of failed optspins			*/
 LOCK_EVENT(rwsem_opt_nospin)	/* # of disabled optspins		*/
+LOCK_EVENT(rwsem_opt_skip)	/* # of optspins skipped on history	*/
 LOCK_EVENT(rwsem_rlock)		/* # of read locks acquired		*/
 LOCK_EVENT(rwsem_rlock_steal)	/* # of read locks by lock stealing	*/
 LOCK_EVENT(rwsem_rlock_fast)	/* # of fast read locks acquired	*/
@@ -69,6 +69,13 @@
 #ifdef CONFIG_PROVE_LOCKING
 static int prove_locking = 1;
 module_param(prove_locking, int, 0644);
+/*
+ * Only validate one in prove_locking_sample acquisitions on each CPU, the
+ * others are tracked as held but neither add dependencies nor mark usage.
+ */
+static unsigned int prove_locking_sample = 1;
+module_param(prove_locking_sample, uint, 0644);
+static DEFINE_PER_CPU(unsigned int, prove_locking_skipped);
 #else
 #define prove_locking 0
 #endif
@@ -90,6 +97,13 @@ static const struct ctl_table kern_lockdep_table[] = {
 		.mode           = 0644,
 		.proc_handler   = proc_dointvec,
 	},
+	{
+		.procname       = "prove_locking_sample",
+		.data           = &prove_locking_sample,
+		.maxlen         = sizeof(unsigned int),
+		.mode           = 0644,
+		.proc_handler   = proc_douintvec,
+	},
 #endif /* CONFIG_PROVE_LOCKING */
 #ifdef CONFIG_LOCK_STAT
 	{
@@ -5069,6 +5083,27 @@ print_lock_nested_lock_not_held(struct task_struct *curr,
 
 static int __lock_is_held(const struct lockdep_map *lock, int read);
 
+#ifdef CONFIG_PROVE_LOCKING
+static bool prove_locking_skip(void)
+{
+	unsigned int sample = READ_ONCE(prove_locking_sample);
+
+	if (likely(sample <= 1))
+		return false;
+
+	if (__this_cpu_inc_return(prove_locking_skipped) < sample)
+		return true;
+
+	__this_cpu_write(prove_locking_skipped, 0);
+	return false;
+}
+#else
+static inline bool prove_locking_skip(void)
+{
+	return false;
+}
+#endif
+
 /*
  * This gets called for every mutex_lock*()/spin_lock*() operation.
  * We maintain the dependency maps and validate the locking attempt:
@@ -5098,7 +5133,8 @@ static int __lock_acquire(struct lockdep_map *lock, unsigned int subclass,
 
 	lockevent_inc(lockdep_acquire);
 
-	if (!prove_locking || lock->key == &__lockdep_no_validate__) {
+	if (!prove_locking || lock->key == &__lockdep_no_validate__ ||
+	    (check && prove_locking_skip())) {
 		check = 0;
 		lockevent_inc(lockdep_nocheck);
 	}
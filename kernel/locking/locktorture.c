@@ -29,6 +29,7 @@
 #include <linux/slab.h>
 #include <linux/torture.h>
 #include <linux/reboot.h>
+#include <linux/topology.h>
 
 MODULE_DESCRIPTION("torture test facility for locking");
 MODULE_LICENSE("GPL");
@@ -115,10 +116,12 @@ static struct task_struct **reader_tasks;
 static bool lock_is_write_held;
 static atomic_t lock_is_read_held;
 static unsigned long last_lock_release;
+static int last_lock_node = NUMA_NO_NODE;
 
 struct lock_stress_stats {
 	long n_lock_fail;
 	long n_lock_acquired;
+	long n_lock_xnode;	/* Acquired after a holder on another node. */
 };
 
 struct call_rcu_chain {
@@ -903,6 +906,7 @@ static int lock_torture_writer(void *arg)
 	DEFINE_TORTURE_RANDOM(rand);
 	bool skip_main_lock;
 	int tid = lwsp - cxt.lwsa;
+	int node;
 
 	VERBOSE_TOROUT_STRING("lock_torture_writer task started");
 	if (!rt_task(current))
@@ -944,6 +948,10 @@ static int lock_torture_writer(void *arg)
 					  __func__, j1 - j);
 			}
 			lwsp->n_lock_acquired++;
+			node = numa_node_id();
+			if (last_lock_node != NUMA_NO_NODE && last_lock_node != node)
+				lwsp->n_lock_xnode++;
+			last_lock_node = node;
 
 			cxt.cur_ops->write_delay(&rand);
 
@@ -1005,7 +1013,7 @@ static void __torture_print_stats(char *page,
 	bool fail = false;
 	int i, n_stress;
 	long max = 0, min = statp ? data_race(statp[0].n_lock_acquired) : 0;
-	long long sum = 0;
+	long long sum = 0, xnode = 0;
 
 	n_stress = write ? cxt.nrealwriters_stress : cxt.nrealreaders_stress;
 	for (i = 0; i < n_stress; i++) {
@@ -1013,17 +1021,23 @@ static void __torture_print_stats(char *page,
 			fail = true;
 		cur = data_race(statp[i].n_lock_acquired);
 		sum += cur;
+		xnode += data_race(statp[i].n_lock_xnode);
 		if (max < cur)
 			max = cur;
 		if (min > cur)
 			min = cur;
 	}
 	page += sprintf(page,
-			"%s:  Total: %lld  Max/Min: %ld/%ld %s  Fail: %d %s\n",
+			"%s:  Total: %lld  Max/Min: %ld/%ld %s  Fail: %d %s",
 			write ? "Writes" : "Reads ",
 			sum, max, min,
 			!onoff_interval && max / 2 > min ? "???" : "",
 			fail, fail ? "!!!" : "");
+	/* Cross-node handoffs are only tracked for exclusive acquisitions. */
+	if (write && num_online_nodes() > 1)
+		page += sprintf(page, "  Xnode: %lld (%lld%%)",
+				xnode, sum ? div64_s64(xnode * 100, sum) : 0);
+	page += sprintf(page, "\n");
 	if (fail)
 		atomic_inc(&cxt.n_lock_torture_errors);
 }
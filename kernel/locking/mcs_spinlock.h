@@ -37,6 +37,16 @@
 	smp_store_release((l), 1)
 #endif
 
+#ifndef arch_mcs_pass_lock
+/*
+ * Like arch_mcs_spin_unlock_contended(), but hands @val over to the next
+ * waiter; the NUMA-aware qspinlock slowpath uses it to pass the encoded
+ * tail of its secondary queue along with the lock.
+ */
+#define arch_mcs_pass_lock(l, val)					\
+	smp_store_release((l), (val))
+#endif
+
 /*
  * Note: the smp_load_acquire/smp_store_release pair is not
  * sufficient to form a full memory barrier across
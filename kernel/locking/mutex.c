@@ -36,6 +36,8 @@
 
 #ifndef CONFIG_PREEMPT_RT
 #include "mutex.h"
+#include "lock_events.h"
+#include "spin_history.h"
 
 #ifdef CONFIG_DEBUG_MUTEXES
 # define MUTEX_WARN_ON(cond) DEBUG_LOCKS_WARN_ON(cond)
@@ -444,6 +446,15 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 		if (!mutex_can_spin_on_owner(lock))
 			goto fail;
 
+		/*
+		 * Recent spins on this lock mostly ended with the owner
+		 * going to sleep; don't bother.
+		 */
+		if (spin_history_skip(lock)) {
+			lockevent_inc(mutex_opt_skip);
+			goto fail;
+		}
+
 		/*
 		 * In order to avoid a stampede of mutex spinners trying to
 		 * acquire the mutex all at once, the spinners need to take a
@@ -480,6 +491,8 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 	if (!waiter)
 		osq_unlock(&lock->osq);
 
+	spin_history_update(lock, true);
+	lockevent_inc(mutex_opt_lock);
 	return true;
 
 
@@ -487,6 +500,11 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 	if (!waiter)
 		osq_unlock(&lock->osq);
 
+	/* a wound/die backoff says nothing about the hold time */
+	if (!ww_ctx && !need_resched())
+		spin_history_update(lock, false);
+	lockevent_inc(mutex_opt_fail);
+
 fail:
 	/*
 	 * If we fell out of the spin path because of need_resched(),
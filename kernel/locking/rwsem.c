@@ -31,6 +31,7 @@
 
 #ifndef CONFIG_PREEMPT_RT
 #include "lock_events.h"
+#include "spin_history.h"
 
 /*
  * The least significant 2 bits of the owner value has the following
@@ -724,6 +725,17 @@ static inline bool rwsem_can_spin_on_owner(struct rw_semaphore *sem)
 		ret = false;
 
 	lockevent_cond_inc(rwsem_opt_fail, !ret);
+
+	/*
+	 * RWSEM_NONSPINNABLE only covers reader-owned spins timing out.
+	 * Also give up early on a lock whose writers recently kept going
+	 * to sleep while we spun.
+	 */
+	if (ret && spin_history_skip(sem)) {
+		lockevent_inc(rwsem_opt_skip);
+		ret = false;
+	}
+
 	return ret;
 }
 
@@ -927,6 +939,9 @@ static bool rwsem_optimistic_spin(struct rw_semaphore *sem)
 		cpu_relax();
 	}
 	osq_unlock(&sem->osq);
+
+	if (taken || !need_resched())
+		spin_history_update(sem, taken);
 done:
 	lockevent_cond_inc(rwsem_opt_fail, !taken);
 	return taken;
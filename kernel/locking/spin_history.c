@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <linux/cache.h>
+#include <linux/compiler.h>
+#include <linux/hash.h>
+#include <linux/init.h>
+#include <linux/jump_label.h>
+#include <linux/kstrtox.h>
+#include <linux/percpu.h>
+
+#include "spin_history.h"
+
+/*
+ * Mutexes and rwsems spin on the owner as long as it is running, which pays
+ * off when hold times are short. Locks that are typically held across long
+ * sections, with the holder still on the CPU much of the time, make every
+ * contender burn cycles only to go to sleep anyway.
+ *
+ * Keep a small score per lock, hashed on its address so that struct mutex and
+ * struct rw_semaphore don't grow. A spin that ended with the owner going off
+ * CPU raises the score by SPIN_HISTORY_FAIL, a spin that got the lock halves
+ * it. Once the score reaches SPIN_HISTORY_SKIP, contenders go straight to the
+ * slowpath. Each skip lowers the score by one, so a persistently failing lock
+ * is still probed once every SPIN_HISTORY_FAIL + 1 attempts and will start to
+ * be spun on again when its behaviour changes.
+ *
+ * The scores are per CPU, so recording an outcome never bounces a cache line
+ * between the CPUs contending on a lock, and a slot is only written when its
+ * score changes. Updates may still race with preemption; the occasional lost
+ * update doesn't matter.
+ *
+ * Skipping spins trades latency for CPU time, so it is off unless enabled
+ * with "spin_history=1" on the command line.
+ */
+#define SPIN_HISTORY_BITS	10
+#define SPIN_HISTORY_FAIL	8
+#define SPIN_HISTORY_SKIP	32
+#define SPIN_HISTORY_MAX	64
+
+static DEFINE_PER_CPU(u8 [1 << SPIN_HISTORY_BITS], spin_history);
+
+DEFINE_STATIC_KEY_FALSE(spin_history_enabled);
+static bool spin_history_param __initdata;
+
+static int __init setup_spin_history(char *str)
+{
+	return kstrtobool(str, &spin_history_param) == 0;
+}
+__setup("spin_history=", setup_spin_history);
+
+static int __init spin_history_init(void)
+{
+	if (spin_history_param)
+		static_branch_enable(&spin_history_enabled);
+	return 0;
+}
+early_initcall(spin_history_init);
+
+static inline u8 *spin_history_slot(const void *lock)
+{
+	return &(*raw_cpu_ptr(&spin_history))[hash_ptr(lock, SPIN_HISTORY_BITS)];
+}
+
+/*
+ * Return true if spinning on @lock has recently not been worth it.
+ */
+bool __spin_history_skip(const void *lock)
+{
+	u8 *slot = spin_history_slot(lock);
+	u8 score = READ_ONCE(*slot);
+
+	if (score < SPIN_HISTORY_SKIP)
+		return false;
+
+	WRITE_ONCE(*slot, score - 1);
+	return true;
+}
+
+/*
+ * Record the outcome of an optimistic spin on @lock. Spins aborted because
+ * the spinner itself needs to reschedule say nothing about the lock and
+ * shouldn't be recorded.
+ */
+void __spin_history_update(const void *lock, bool acquired)
+{
+	u8 *slot = spin_history_slot(lock);
+	u8 score = READ_ONCE(*slot);
+	u8 new;
+
+	if (acquired)
+		new = score / 2;
+	else
+		new = min(score + SPIN_HISTORY_FAIL, SPIN_HISTORY_MAX);
+
+	if (new != score)
+		WRITE_ONCE(*slot, new);
+}
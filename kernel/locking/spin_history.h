@@ -0,0 +1,37 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Optimistic spinning history for sleeping locks, see spin_history.c.
+ */
+#ifndef __LOCKING_SPIN_HISTORY_H
+#define __LOCKING_SPIN_HISTORY_H
+
+#include <linux/jump_label.h>
+#include <linux/types.h>
+
+#ifdef CONFIG_LOCK_SPIN_ON_OWNER
+DECLARE_STATIC_KEY_FALSE(spin_history_enabled);
+
+extern bool __spin_history_skip(const void *lock);
+extern void __spin_history_update(const void *lock, bool acquired);
+
+static inline bool spin_history_skip(const void *lock)
+{
+	if (!static_branch_unlikely(&spin_history_enabled))
+		return false;
+	return __spin_history_skip(lock);
+}
+
+static inline void spin_history_update(const void *lock, bool acquired)
+{
+	if (static_branch_unlikely(&spin_history_enabled))
+		__spin_history_update(lock, acquired);
+}
+#else
+static inline bool spin_history_skip(const void *lock)
+{
+	return false;
+}
+static inline void spin_history_update(const void *lock, bool acquired) { }
+#endif
+
+#endif /* __LOCKING_SPIN_HISTORY_H */
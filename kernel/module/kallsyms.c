@@ -10,6 +10,8 @@
 #include <linux/kallsyms.h>
 #include <linux/buildid.h>
 #include <linux/bsearch.h>
+#include <linux/log2.h>
+#include <linux/stringhash.h>
 #include "internal.h"
 
 /* Lookup exported symbol in given range of kernel_symbols */
@@ -145,6 +147,12 @@ void layout_symtab(struct module *mod, struct load_info *info)
 	/* Note add_kallsyms() computes strtab_size as core_typeoffs - stroffs */
 	info->core_typeoffs = mod_mem_data->size;
 	mod_mem_data->size += ndst * sizeof(char);
+	/* About 8 bits per core symbol for the name filter. */
+	info->filter_bits = max_t(unsigned int, BITS_PER_LONG,
+				  roundup_pow_of_two(ndst * 8));
+	info->filteroffs = ALIGN(mod_mem_data->size, sizeof(long));
+	mod_mem_data->size = info->filteroffs +
+			     BITS_TO_LONGS(info->filter_bits) * sizeof(long);
 
 	/* Put string table section at end of init part of module. */
 	strsect->sh_flags |= SHF_ALLOC;
@@ -162,6 +170,39 @@ void layout_symtab(struct module *mod, struct load_info *info)
 	mod_mem_init_data->size += nsrc * sizeof(char);
 }
 
+/*
+ * The core symbols' names are hashed into a small bloom filter so that
+ * name lookups can skip modules that don't define the symbol without
+ * walking their whole symtab.
+ */
+static u32 symbol_name_hash(const char *name)
+{
+	return full_name_hash(NULL, name, strlen(name));
+}
+
+static void name_filter_add(struct mod_kallsyms *kallsyms, const char *name)
+{
+	u32 mask = kallsyms->name_filter_bits - 1;
+	u32 hash = symbol_name_hash(name);
+
+	__set_bit(hash & mask, kallsyms->name_filter);
+	__set_bit(ror32(hash, 16) & mask, kallsyms->name_filter);
+}
+
+static bool name_filter_test(const struct mod_kallsyms *kallsyms,
+			     const char *name)
+{
+	u32 mask = kallsyms->name_filter_bits - 1;
+	u32 hash;
+
+	if (!kallsyms->name_filter)
+		return true;
+
+	hash = symbol_name_hash(name);
+	return test_bit(hash & mask, kallsyms->name_filter) &&
+	       test_bit(ror32(hash, 16) & mask, kallsyms->name_filter);
+}
+
 /*
  * We use the full symtab and strtab which layout_symtab arranged to
  * be appended to the init section.  Later we switch to the cut-down
@@ -186,6 +227,7 @@ void add_kallsyms(struct module *mod, const struct load_info *info)
 	/* Make sure we get permanent strtab: don't use info->strtab. */
 	kallsyms->strtab = (void *)info->sechdrs[info->index.str].sh_addr;
 	kallsyms->typetab = init_data_base + info->init_typeoffs;
+	kallsyms->name_filter = NULL;
 
 	/*
 	 * Now populate the cut down core kallsyms for after init
@@ -194,6 +236,9 @@ void add_kallsyms(struct module *mod, const struct load_info *info)
 	mod->core_kallsyms.symtab = dst = data_base + info->symoffs;
 	mod->core_kallsyms.strtab = s = data_base + info->stroffs;
 	mod->core_kallsyms.typetab = data_base + info->core_typeoffs;
+	mod->core_kallsyms.name_filter = data_base + info->filteroffs;
+	mod->core_kallsyms.name_filter_bits = info->filter_bits;
+	bitmap_zero(mod->core_kallsyms.name_filter, info->filter_bits);
 	strtab_size = info->core_typeoffs - info->stroffs;
 	src = kallsyms->symtab;
 	for (ndst = i = 0; i < kallsyms->num_symtab; i++) {
@@ -211,6 +256,8 @@ void add_kallsyms(struct module *mod, const struct load_info *info)
 				      strtab_size);
 			if (ret < 0)
 				break;
+			if (src[i].st_shndx != SHN_UNDEF)
+				name_filter_add(&mod->core_kallsyms, s);
 			s += ret + 1;
 			strtab_size -= ret + 1;
 		}
@@ -406,11 +453,15 @@ static unsigned long __find_kallsyms_symbol_value(struct module *mod, const char
 	unsigned int i;
 	struct mod_kallsyms *kallsyms = rcu_dereference(mod->kallsyms);
 
+	/* The init symtab has no filter, only the core one does. */
+	if (!name_filter_test(kallsyms, name))
+		return 0;
+
 	for (i = 0; i < kallsyms->num_symtab; i++) {
 		const Elf_Sym *sym = &kallsyms->symtab[i];
 
-		if (strcmp(name, kallsyms_symbol_name(kallsyms, i)) == 0 &&
-		    sym->st_shndx != SHN_UNDEF)
+		if (sym->st_shndx != SHN_UNDEF &&
+		    strcmp(name, kallsyms_symbol_name(kallsyms, i)) == 0)
 			return kallsyms_symbol_value(sym);
 	}
 	return 0;
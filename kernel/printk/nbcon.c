@@ -14,6 +14,7 @@
 #include <linux/minmax.h>
 #include <linux/percpu.h>
 #include <linux/preempt.h>
+#include <linux/sched/clock.h>
 #include <linux/slab.h>
 #include <linux/smp.h>
 #include <linux/stddef.h>
@@ -1068,12 +1069,14 @@ static bool nbcon_emit_next_record(struct nbcon_write_context *wctxt, bool use_a
 }
 
 /*
- * nbcon_emit_one - Print one record for an nbcon console using the
+ * nbcon_emit_one - Print records for an nbcon console using the
  *			specified callback
  * @wctxt:	An initialized write context struct to use for this context
  * @use_atomic:	True if the write_atomic() callback is to be used
+ * @budget_ns:	Time after which no further record is started under the
+ *		same device lock. 0 to print exactly one record.
  *
- * Return:	True, when a record has been printed and there are still
+ * Return:	True, when records have been printed and there are still
  *		pending records. The caller might want to continue flushing.
  *
  *		False, when there is no pending record, or when the console
@@ -1083,13 +1086,21 @@ static bool nbcon_emit_next_record(struct nbcon_write_context *wctxt, bool use_a
  *
  * This is an internal helper to handle the locking of the console before
  * calling nbcon_emit_next_record().
+ *
+ * The device lock may disable interrupts (e.g. __uart_port_lock_irqsave()),
+ * so the batch is bounded by time rather than by records: a slow serial
+ * console finishes one record past @budget_ns and releases the lock as
+ * before, while a fast console (netconsole, a framebuffer) gets several
+ * records per lock and ownership round trip during a log flood.
  */
-static bool nbcon_emit_one(struct nbcon_write_context *wctxt, bool use_atomic)
+static bool nbcon_emit_one(struct nbcon_write_context *wctxt, bool use_atomic,
+			   u64 budget_ns)
 {
 	struct nbcon_context *ctxt = &ACCESS_PRIVATE(wctxt, ctxt);
 	struct console *con = ctxt->console;
 	unsigned long flags;
 	bool ret = false;
+	u64 start;
 
 	if (!use_atomic) {
 		con->device_lock(con, &flags);
@@ -1112,8 +1123,11 @@ static bool nbcon_emit_one(struct nbcon_write_context *wctxt, bool use_atomic)
 	 * The higher priority printing context takes over responsibility
 	 * to print the pending records.
 	 */
-	if (!nbcon_emit_next_record(wctxt, use_atomic))
-		goto out;
+	start = local_clock();
+	do {
+		if (!nbcon_emit_next_record(wctxt, use_atomic))
+			goto out;
+	} while (ctxt->backlog && local_clock() - start < budget_ns);
 
 	nbcon_context_release(ctxt);
 
@@ -1158,6 +1172,13 @@ static bool nbcon_kthread_should_wakeup(struct console *con, struct nbcon_contex
 	return ret;
 }
 
+/*
+ * How long the printer thread keeps starting new records under one
+ * device_lock(). Shorter than a single record on a 115200 baud UART, so
+ * serial consoles keep dropping the lock after every record.
+ */
+#define NBCON_KTHREAD_BATCH_NS	(50 * NSEC_PER_USEC)
+
 /**
  * nbcon_kthread_func - The printer thread function
  * @__console:	Console to operate on
@@ -1207,7 +1228,7 @@ static int nbcon_kthread_func(void *__console)
 		con_flags = console_srcu_read_flags(con);
 
 		if (console_is_usable(con, con_flags, false))
-			backlog = nbcon_emit_one(&wctxt, false);
+			backlog = nbcon_emit_one(&wctxt, false, NBCON_KTHREAD_BATCH_NS);
 
 		console_srcu_read_unlock(cookie);
 
@@ -1436,7 +1457,7 @@ bool nbcon_legacy_emit_next_record(struct console *con, bool *handover,
 		stop_critical_timings();
 	}
 
-	progress = nbcon_emit_one(&wctxt, use_atomic);
+	progress = nbcon_emit_one(&wctxt, use_atomic, 0);
 
 	if (use_atomic) {
 		start_critical_timings();
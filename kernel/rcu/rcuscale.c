@@ -110,13 +110,23 @@ struct writer_mblock {
 	struct rcu_head wmb_rh;
 	struct llist_node wmb_node;
 	struct writer_freelist *wmb_wfl;
+	u64 wmb_queued;		/* Time of ->async() call. */
+	int wmb_nid;		/* NUMA node of ->async() call. */
 };
 
+/*
+ * The ws_cb_* statistics are updated only by the callbacks of one writer,
+ * which was bound to a single CPU, so they are invoked serially.
+ */
 struct writer_freelist {
 	struct llist_head ws_lhg;
 	atomic_t ws_inflight;
 	struct llist_head ____cacheline_internodealigned_in_smp ws_lhp;
 	struct writer_mblock *ws_mblocks;
+	unsigned long ws_cb_n;		/* Callbacks invoked. */
+	unsigned long ws_cb_xnode;	/* ... on another node than queued. */
+	u64 ws_cb_lat_sum;		/* Sum of queue-to-invoke latencies. */
+	u64 ws_cb_lat_max;		/* Max of queue-to-invoke latencies. */
 };
 
 static int nrealreaders;
@@ -521,7 +531,14 @@ static void rcu_scale_async_cb(struct rcu_head *rhp)
 {
 	struct writer_mblock *wmbp = container_of(rhp, struct writer_mblock, wmb_rh);
 	struct writer_freelist *wflp = wmbp->wmb_wfl;
-
+	u64 lat = ktime_get_mono_fast_ns() - wmbp->wmb_queued;
+
+	wflp->ws_cb_n++;
+	if (wmbp->wmb_nid != numa_node_id())
+		wflp->ws_cb_xnode++;
+	wflp->ws_cb_lat_sum += lat;
+	if (lat > wflp->ws_cb_lat_max)
+		wflp->ws_cb_lat_max = lat;
 	atomic_dec(&wflp->ws_inflight);
 	rcu_scale_free(wmbp);
 }
@@ -588,6 +605,8 @@ rcu_scale_writer(void *arg)
 				wmbp = rcu_scale_alloc(me);
 			if (wmbp && atomic_read(&wflp->ws_inflight) < gp_async_max) {
 				atomic_inc(&wflp->ws_inflight);
+				wmbp->wmb_queued = ktime_get_mono_fast_ns();
+				wmbp->wmb_nid = numa_node_id();
 				cur_ops->async(&wmbp->wmb_rh, rcu_scale_async_cb);
 				wmbp = NULL;
 				gp_succeeded = true;
@@ -1035,6 +1054,11 @@ rcu_scale_cleanup(void)
 				struct writer_freelist *wflp = &writer_freelists[i];
 
 				if (wflp->ws_mblocks) {
+					pr_alert("%s%s %4d writer-callbacks: %lu cross-node: %lu latency avg: %llu max: %llu\n",
+						 scale_type, SCALE_FLAG, i,
+						 wflp->ws_cb_n, wflp->ws_cb_xnode,
+						 wflp->ws_cb_n ? div64_ul(wflp->ws_cb_lat_sum, wflp->ws_cb_n) : 0,
+						 wflp->ws_cb_lat_max);
 					llist_for_each(llnp, wflp->ws_lhg.first)
 						ctr++;
 					llist_for_each(llnp, wflp->ws_lhp.first)
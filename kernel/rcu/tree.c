@@ -64,6 +64,8 @@
 #include <linux/mm.h>
 #include <linux/kasan.h>
 #include <linux/context_tracking.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include "../time/tick-internal.h"
 
 #include "tree.h"
@@ -188,6 +190,14 @@ static int nohz_full_patience_delay;
 module_param(nohz_full_patience_delay, int, 0444);
 static int nohz_full_patience_delay_jiffies;
 
+/*
+ * Window in microseconds over which an expedited grace period that follows
+ * closely on the previous one waits for further requests to join it, zero
+ * to disable.
+ */
+static int rcu_exp_batch_us;
+module_param(rcu_exp_batch_us, int, 0644);
+
 // Add delay to rcu_read_unlock() for strict grace periods.
 static int rcu_unlock_delay;
 #ifdef CONFIG_RCU_STRICT_GRACE_PERIOD
@@ -2480,6 +2490,27 @@ rcu_check_quiescent_state(struct rcu_data *rdp)
 	rcu_report_qs_rdp(rdp);
 }
 
+/*
+ * Return true if the local node is short of free memory.  Callbacks often
+ * free memory, so rcu_do_batch() stops throttling them by ->blimit then.
+ */
+static bool rcu_cb_mem_pressure(void)
+{
+	pg_data_t *pgdat = NODE_DATA(numa_node_id());
+	unsigned long free = 0, low = 0;
+	int i;
+
+	for (i = 0; i < MAX_NR_ZONES; i++) {
+		struct zone *zone = &pgdat->node_zones[i];
+
+		if (!managed_zone(zone))
+			continue;
+		free += zone_page_state(zone, NR_FREE_PAGES);
+		low += low_wmark_pages(zone);
+	}
+	return free < low;
+}
+
 /* Return true if callback-invocation time limit exceeded. */
 static bool rcu_do_batch_check_time(long count, long tlimit,
 				    bool jlimit_check, unsigned long jlimit)
@@ -2538,6 +2569,8 @@ static void rcu_do_batch(struct rcu_data *rdp)
 	div = READ_ONCE(rcu_divisor);
 	div = div < 0 ? 7 : div > sizeof(long) * 8 - 2 ? sizeof(long) * 8 - 2 : div;
 	bl = max(rdp->blimit, pending >> div);
+	if (unlikely(rcu_cb_mem_pressure()))
+		bl = max(bl, pending);
 	if ((in_serving_softirq() || rdp->rcu_cpu_kthread_status == RCU_KTHREAD_RUNNING) &&
 	    (IS_ENABLED(CONFIG_RCU_DOUBLE_CHECK_CB_TIME) || unlikely(bl > 100))) {
 		const long npj = NSEC_PER_SEC / HZ;
@@ -376,6 +376,10 @@ struct rcu_state {
 	struct mutex exp_mutex;			/* Serialize expedited GP. */
 	struct mutex exp_wake_mutex;		/* Serialize wakeup. */
 	unsigned long expedited_sequence;	/* Take a ticket. */
+	u64 exp_end_ns;				/* Time last expedited GP ended. */
+	atomic_long_t n_exp_requests;		/* # synchronize_rcu_expedited(). */
+	atomic_long_t n_exp_ipis;		/* # expedited-QS IPIs sent. */
+	unsigned long n_exp_batched;		/* # GPs delayed for batching. */
 	atomic_t expedited_need_qs;		/* # CPUs left to check in. */
 	struct swait_queue_head expedited_wq;	/* Wait for check-ins. */
 	int ncpus_snap;				/* # CPUs seen last time. */
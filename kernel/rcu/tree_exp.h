@@ -284,6 +284,40 @@ static bool sync_exp_work_done(unsigned long s)
 	return false;
 }
 
+/*
+ * If the previous expedited grace period ended less than rcu_exp_batch_us
+ * ago, requests are arriving back to back.  Hold off starting the next one
+ * for that window so that the requests arriving meanwhile take the same
+ * ticket: their rcu_exp_gp_seq_snap() still maps to the grace period that
+ * has not yet started, so they wait on the rcu_node tree for it instead of
+ * each needing a grace period, and its IPIs, of their own.
+ *
+ * Called with ->exp_mutex held, before the grace period is started.  The
+ * mutex is dropped across the sleep so that unrelated expedited grace
+ * periods are not held up behind the window.  Returns true, with the mutex
+ * released, if a grace period satisfying @s completed in the meantime.
+ */
+static bool rcu_exp_batch_wait(unsigned long s)
+{
+	int us = READ_ONCE(rcu_exp_batch_us);
+
+	if (us <= 0 || rcu_scheduler_active != RCU_SCHEDULER_RUNNING)
+		return false;
+	us = min(us, (int)USEC_PER_MSEC * 10);
+	if (ktime_get_mono_fast_ns() - READ_ONCE(rcu_state.exp_end_ns) >=
+	    (u64)us * NSEC_PER_USEC)
+		return false;
+	rcu_state.n_exp_batched++;
+	mutex_unlock(&rcu_state.exp_mutex);
+	fsleep(us);
+	mutex_lock(&rcu_state.exp_mutex);
+	if (sync_exp_work_done(s)) {
+		mutex_unlock(&rcu_state.exp_mutex);
+		return true;
+	}
+	return false;
+}
+
 /*
  * Funnel-lock acquisition for expedited grace periods.  Returns true
  * if some other task completed an expedited grace period that this task
@@ -339,6 +373,8 @@ static bool exp_funnel_lock(unsigned long s)
 		mutex_unlock(&rcu_state.exp_mutex);
 		return true;
 	}
+	if (rcu_exp_batch_wait(s))
+		return true;
 	rcu_exp_gp_seq_start();
 	trace_rcu_exp_grace_period(rcu_state.name, s, TPS("start"));
 	return false;
@@ -420,8 +456,10 @@ static void __sync_rcu_exp_select_node_cpus(struct rcu_exp_work *rewp)
 		ret = smp_call_function_single(cpu, rcu_exp_handler, NULL, 0);
 		put_cpu();
 		/* The CPU will report the QS in response to the IPI. */
-		if (!ret)
+		if (!ret) {
+			atomic_long_inc(&rcu_state.n_exp_ipis);
 			continue;
+		}
 
 		/* Failed, raced with CPU hotplug operation. */
 		raw_spin_lock_irqsave_rcu_node(rnp, flags);
@@ -691,6 +729,7 @@ static void rcu_exp_wait_wake(unsigned long s)
 	// to ensure that only one GP runs concurrently with wakeups.
 	mutex_lock(&rcu_state.exp_wake_mutex);
 	rcu_exp_gp_seq_end();
+	WRITE_ONCE(rcu_state.exp_end_ns, ktime_get_mono_fast_ns());
 	trace_rcu_exp_grace_period(rcu_state.name, s, TPS("end"));
 
 	rcu_for_each_node_breadth_first(rnp) {
@@ -914,7 +953,8 @@ static void sync_sched_exp_online_cleanup(int cpu)
 	/* Quiescent state needed on some other CPU, send IPI. */
 	ret = smp_call_function_single(cpu, rcu_exp_handler, NULL, 0);
 	put_cpu();
-	WARN_ON_ONCE(ret);
+	if (!WARN_ON_ONCE(ret))
+		atomic_long_inc(&rcu_state.n_exp_ipis);
 }
 
 /*
@@ -993,6 +1033,8 @@ void synchronize_rcu_expedited(void)
 		return;
 	}
 
+	atomic_long_inc(&rcu_state.n_exp_requests);
+
 	/* Take a snapshot of the sequence number.  */
 	s = rcu_exp_gp_seq_snap();
 	if (exp_funnel_lock(s))
@@ -1153,3 +1195,25 @@ void cond_synchronize_rcu_expedited_full(struct rcu_gp_oldstate *rgosp)
 		synchronize_rcu_expedited();
 }
 EXPORT_SYMBOL_GPL(cond_synchronize_rcu_expedited_full);
+
+#ifdef CONFIG_DEBUG_FS
+/* Expedited grace-period statistics in /sys/kernel/debug/rcu/exp_stats. */
+static int rcu_exp_stats_show(struct seq_file *m, void *v)
+{
+	seq_printf(m, "requests: %ld\n", atomic_long_read(&rcu_state.n_exp_requests));
+	seq_printf(m, "gps: %lu\n", rcu_seq_ctr(READ_ONCE(rcu_state.expedited_sequence)));
+	seq_printf(m, "batched: %lu\n", data_race(rcu_state.n_exp_batched));
+	seq_printf(m, "ipis: %ld\n", atomic_long_read(&rcu_state.n_exp_ipis));
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(rcu_exp_stats);
+
+static int __init rcu_exp_debugfs_init(void)
+{
+	struct dentry *dir = debugfs_create_dir("rcu", NULL);
+
+	debugfs_create_file("exp_stats", 0444, dir, NULL, &rcu_exp_stats_fops);
+	return 0;
+}
+late_initcall(rcu_exp_debugfs_init);
+#endif /* #ifdef CONFIG_DEBUG_FS */
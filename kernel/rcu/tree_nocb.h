@@ -1390,12 +1390,14 @@ static void rcu_spawn_cpu_nocb_kthread(int cpu)
 	rdp_gp = rdp->nocb_gp_rdp;
 	mutex_lock(&rdp_gp->nocb_gp_kthread_mutex);
 	if (!rdp_gp->nocb_gp_kthread) {
-		t = kthread_run(rcu_nocb_gp_kthread, rdp_gp,
-				"rcuog/%d", rdp_gp->cpu);
+		t = kthread_create_on_node(rcu_nocb_gp_kthread, rdp_gp,
+					   rcu_nocb_cpu_node(rdp_gp->cpu),
+					   "rcuog/%d", rdp_gp->cpu);
 		if (WARN_ONCE(IS_ERR(t), "%s: Could not start rcuo GP kthread, OOM is now expected behavior\n", __func__)) {
 			mutex_unlock(&rdp_gp->nocb_gp_kthread_mutex);
 			goto err;
 		}
+		wake_up_process(t);
 		WRITE_ONCE(rdp_gp->nocb_gp_kthread, t);
 		if (kthread_prio)
 			sched_setscheduler_nocheck(t, SCHED_FIFO, &sp);
@@ -1403,8 +1405,8 @@ static void rcu_spawn_cpu_nocb_kthread(int cpu)
 	mutex_unlock(&rdp_gp->nocb_gp_kthread_mutex);
 
 	/* Spawn the kthread for this CPU. */
-	t = kthread_create(rcu_nocb_cb_kthread, rdp,
-			   "rcuo%c/%d", rcu_state.abbr, cpu);
+	t = kthread_create_on_node(rcu_nocb_cb_kthread, rdp, rcu_nocb_cpu_node(cpu),
+				   "rcuo%c/%d", rcu_state.abbr, cpu);
 	if (WARN_ONCE(IS_ERR(t), "%s: Could not start rcuo CB kthread, OOM is now expected behavior\n", __func__))
 		goto err;
 
@@ -1440,6 +1442,25 @@ static void rcu_spawn_cpu_nocb_kthread(int cpu)
 static int rcu_nocb_gp_stride = -1;
 module_param(rcu_nocb_gp_stride, int, 0444);
 
+/*
+ * Group CB CPUs by NUMA node instead of by CPU ID, so that no GP kthread
+ * serves CPUs of more than one node, and start the rcuo kthreads on the
+ * node of the CPUs they serve.
+ */
+static bool rcu_nocb_gp_numa;
+module_param(rcu_nocb_gp_numa, bool, 0444);
+
+/* NUMA node used to group and place the rcuo kthreads of @cpu. */
+static int rcu_nocb_cpu_node(int cpu)
+{
+	int nid;
+
+	if (!rcu_nocb_gp_numa)
+		return NUMA_NO_NODE;
+	nid = cpu_to_node(cpu);
+	return nid < 0 || nid >= nr_node_ids ? 0 : nid;
+}
+
 /*
  * Initialize GP-CB relationships for all no-CBs CPU.
  */
@@ -1450,7 +1471,9 @@ static void __init rcu_organize_nocb_kthreads(void)
 	bool gotnocbs = false;
 	bool gotnocbscbs = true;
 	int ls = rcu_nocb_gp_stride;
-	int nl = 0;  /* Next GP kthread. */
+	int nl;  /* Next GP kthread. */
+	int nid, nr_nids;
+	int idx;
 	struct rcu_data *rdp;
 	struct rcu_data *rdp_gp = NULL;  /* Suppress misguided gcc warn. */
 
@@ -1462,36 +1485,53 @@ static void __init rcu_organize_nocb_kthreads(void)
 	}
 
 	/*
-	 * Each pass through this loop sets up one rcu_data structure.
+	 * Each pass through the inner loop sets up one rcu_data structure.
 	 * Should the corresponding CPU come online in the future, then
 	 * we will spawn the needed set of rcu_nocb_kthread() kthreads.
+	 *
+	 * With rcu_nocb_gp_numa, the outer loop takes one node at a time and
+	 * groups of ls CPUs are formed from that node's CPUs only. Otherwise
+	 * there is a single pass and groups are formed by CPU ID.
 	 */
-	for_each_possible_cpu(cpu) {
-		rdp = per_cpu_ptr(&rcu_data, cpu);
-		if (rdp->cpu >= nl) {
-			/* New GP kthread, set up for CBs & next GP. */
-			gotnocbs = true;
-			nl = DIV_ROUND_UP(rdp->cpu + 1, ls) * ls;
-			rdp_gp = rdp;
-			INIT_LIST_HEAD(&rdp->nocb_head_rdp);
-			if (dump_tree) {
-				if (!firsttime)
-					pr_cont("%s\n", gotnocbscbs
-							? "" : " (self only)");
-				gotnocbscbs = false;
-				firsttime = false;
-				pr_alert("%s: No-CB GP kthread CPU %d:",
-					 __func__, cpu);
+	nr_nids = rcu_nocb_gp_numa ? nr_node_ids : 1;
+	for (nid = 0; nid < nr_nids; nid++) {
+		nl = 0;
+		idx = 0;
+		for_each_possible_cpu(cpu) {
+			bool newgp;
+
+			if (rcu_nocb_gp_numa && rcu_nocb_cpu_node(cpu) != nid)
+				continue;
+			rdp = per_cpu_ptr(&rcu_data, cpu);
+			if (rcu_nocb_gp_numa)
+				newgp = !(idx++ % ls);
+			else
+				newgp = rdp->cpu >= nl;
+			if (newgp) {
+				/* New GP kthread, set up for CBs & next GP. */
+				gotnocbs = true;
+				nl = DIV_ROUND_UP(rdp->cpu + 1, ls) * ls;
+				rdp_gp = rdp;
+				INIT_LIST_HEAD(&rdp->nocb_head_rdp);
+				if (dump_tree) {
+					if (!firsttime)
+						pr_cont("%s\n", gotnocbscbs
+								? "" : " (self only)");
+					gotnocbscbs = false;
+					firsttime = false;
+					pr_alert("%s: No-CB GP kthread CPU %d:",
+						 __func__, cpu);
+				}
+			} else {
+				/* Another CB kthread, link to previous GP kthread. */
+				gotnocbscbs = true;
+				if (dump_tree)
+					pr_cont(" %d", cpu);
 			}
-		} else {
-			/* Another CB kthread, link to previous GP kthread. */
-			gotnocbscbs = true;
-			if (dump_tree)
-				pr_cont(" %d", cpu);
+			rdp->nocb_gp_rdp = rdp_gp;
+			if (cpumask_test_cpu(cpu, rcu_nocb_mask))
+				list_add_tail(&rdp->nocb_entry_rdp, &rdp_gp->nocb_head_rdp);
 		}
-		rdp->nocb_gp_rdp = rdp_gp;
-		if (cpumask_test_cpu(cpu, rcu_nocb_mask))
-			list_add_tail(&rdp->nocb_entry_rdp, &rdp_gp->nocb_head_rdp);
 	}
 	if (gotnocbs && dump_tree)
 		pr_cont("%s\n", gotnocbscbs ? "" : " (self only)");
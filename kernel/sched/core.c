@@ -1061,9 +1061,25 @@ void wake_q_add_safe(struct wake_q_head *head, struct task_struct *task)
 		put_task_struct(task);
 }
 
+/*
+ * Upper bound, in microseconds, on how long wake_up_q() may hold back the
+ * IPIs for remote wakeups so that a burst sends one IPI per target CPU.
+ * 0 disables batching.
+ */
+static unsigned int sysctl_sched_wake_batch_us __read_mostly;
+
 void wake_up_q(struct wake_q_head *head)
 {
 	struct wake_q_node *node = head->first;
+	unsigned int batch_us = READ_ONCE(sysctl_sched_wake_batch_us);
+	bool batch = false;
+
+	if (IS_ENABLED(CONFIG_SMP) && batch_us &&
+	    node != WAKE_Q_TAIL && node->next != WAKE_Q_TAIL) {
+		preempt_disable();
+		smp_call_batch_begin((u64)batch_us * NSEC_PER_USEC);
+		batch = true;
+	}
 
 	while (node != WAKE_Q_TAIL) {
 		struct task_struct *task;
@@ -1081,6 +1097,11 @@ void wake_up_q(struct wake_q_head *head)
 		wake_up_process(task);
 		put_task_struct(task);
 	}
+
+	if (batch) {
+		smp_call_batch_end();
+		preempt_enable();
+	}
 }
 
 /*
@@ -3887,7 +3908,8 @@ static void __ttwu_queue_wakelist(struct task_struct *p, int cpu, int wake_flags
 	p->sched_remote_wakeup = !!(wake_flags & WF_MIGRATED);
 
 	WRITE_ONCE(rq->ttwu_pending, 1);
-	__smp_call_single_queue(cpu, &p->wake_entry.llist);
+	if (!smp_call_batch_queue(cpu, &p->wake_entry.llist))
+		__smp_call_single_queue(cpu, &p->wake_entry.llist);
 }
 
 void wake_up_if_idle(int cpu)
@@ -4537,6 +4559,8 @@ static void __sched_fork(unsigned long clone_flags, struct task_struct *p)
 #ifdef CONFIG_SMP
 	p->wake_entry.u_flags = CSD_TYPE_TTWU;
 	p->migration_pending = NULL;
+	p->last_waker = NULL;
+	p->waker_hits = 0;
 #endif
 	init_sched_mm_cid(p);
 }
@@ -4669,6 +4693,16 @@ static int sysctl_schedstats(const struct ctl_table *table, int write, void *buf
 
 #ifdef CONFIG_SYSCTL
 static const struct ctl_table sched_core_sysctls[] = {
+#ifdef CONFIG_SMP
+	{
+		.procname	= "sched_wake_batch_us",
+		.data		= &sysctl_sched_wake_batch_us,
+		.maxlen		= sizeof(unsigned int),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec_minmax,
+		.extra2		= SYSCTL_ONE_THOUSAND,
+	},
+#endif /* CONFIG_SMP */
 #ifdef CONFIG_SCHEDSTATS
 	{
 		.procname       = "sched_schedstats",
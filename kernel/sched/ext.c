@@ -1938,26 +1938,17 @@ static void refill_task_slice_dfl(struct task_struct *p)
 	__scx_add_event(scx_root, SCX_EV_REFILL_SLICE_DFL, 1);
 }
 
-static void dispatch_enqueue(struct scx_sched *sch, struct scx_dispatch_q *dsq,
-			     struct task_struct *p, u64 enq_flags)
+/*
+ * Queue @p on @dsq. Non-local @dsq must be locked by the caller, the local DSQ
+ * is protected by the rq lock.
+ */
+static void __dispatch_enqueue(struct scx_sched *sch, struct scx_dispatch_q *dsq,
+			       struct task_struct *p, u64 enq_flags)
 {
-	bool is_local = dsq->id == SCX_DSQ_LOCAL;
-
 	WARN_ON_ONCE(p->scx.dsq || !list_empty(&p->scx.dsq_list.node));
 	WARN_ON_ONCE((p->scx.dsq_flags & SCX_TASK_DSQ_ON_PRIQ) ||
 		     !RB_EMPTY_NODE(&p->scx.dsq_priq));
 
-	if (!is_local) {
-		raw_spin_lock(&dsq->lock);
-		if (unlikely(dsq->id == SCX_DSQ_INVALID)) {
-			scx_error(sch, "attempting to dispatch to a destroyed dsq");
-			/* fall back to the global dsq */
-			raw_spin_unlock(&dsq->lock);
-			dsq = find_global_dsq(p);
-			raw_spin_lock(&dsq->lock);
-		}
-	}
-
 	if (unlikely((dsq->id & SCX_DSQ_FLAG_BUILTIN) &&
 		     (enq_flags & SCX_ENQ_DSQ_PRIQ))) {
 		/*
@@ -2034,6 +2025,25 @@ static void dispatch_enqueue(struct scx_sched *sch, struct scx_dispatch_q *dsq,
 	 */
 	if (enq_flags & SCX_ENQ_CLEAR_OPSS)
 		atomic_long_set_release(&p->scx.ops_state, SCX_OPSS_NONE);
+}
+
+static void dispatch_enqueue(struct scx_sched *sch, struct scx_dispatch_q *dsq,
+			     struct task_struct *p, u64 enq_flags)
+{
+	bool is_local = dsq->id == SCX_DSQ_LOCAL;
+
+	if (!is_local) {
+		raw_spin_lock(&dsq->lock);
+		if (unlikely(dsq->id == SCX_DSQ_INVALID)) {
+			scx_error(sch, "attempting to dispatch to a destroyed dsq");
+			/* fall back to the global dsq */
+			raw_spin_unlock(&dsq->lock);
+			dsq = find_global_dsq(p);
+			raw_spin_lock(&dsq->lock);
+		}
+	}
+
+	__dispatch_enqueue(sch, dsq, p, enq_flags);
 
 	if (is_local) {
 		struct rq *rq = container_of(dsq, struct rq, scx.local_dsq);
@@ -2862,6 +2872,53 @@ static bool consume_dispatch_q(struct scx_sched *sch, struct rq *rq,
 	return false;
 }
 
+/*
+ * Move up to @nr tasks from @dsq to @rq's local DSQ under a single acquisition
+ * of @dsq->lock. Only tasks which are already on @rq can be moved this way.
+ * If the first task which can run on @rq is on a remote rq, stop and, if
+ * nothing has been moved yet, let consume_dispatch_q() migrate it so that the
+ * consumption order stays the same as repeated consume_dispatch_q() calls.
+ * Returns the number of moved tasks.
+ */
+static u32 consume_dispatch_q_nr(struct scx_sched *sch, struct rq *rq,
+				 struct scx_dispatch_q *dsq, u32 nr)
+{
+	struct task_struct *p, *next;
+	bool remote = false;
+	u32 moved = 0;
+
+	scx_breather(rq);
+
+	if (list_empty(&dsq->list))
+		return 0;
+
+	raw_spin_lock(&dsq->lock);
+
+	for (p = nldsq_next_task(dsq, NULL, false); p && moved < nr; p = next) {
+		/* @p's list node is reused by the local DSQ, look ahead first */
+		next = nldsq_next_task(dsq, p, false);
+
+		if (rq == task_rq(p)) {
+			task_unlink_from_dsq(p, dsq);
+			move_local_task_to_local_dsq(p, 0, dsq, rq);
+			moved++;
+			continue;
+		}
+
+		if (task_can_run_on_remote_rq(sch, p, rq, false)) {
+			remote = true;
+			break;
+		}
+	}
+
+	raw_spin_unlock(&dsq->lock);
+
+	if (!moved && remote)
+		return consume_dispatch_q(sch, rq, dsq);
+
+	return moved;
+}
+
 static bool consume_global_dsq(struct scx_sched *sch, struct rq *rq)
 {
 	int node = cpu_to_node(cpu_of(rq));
@@ -2990,12 +3047,9 @@ static void dispatch_to_local_dsq(struct scx_sched *sch, struct rq *rq,
  * was valid in the first place. Make sure that the task is still owned by the
  * BPF scheduler and claim the ownership before dispatching.
  */
-static void finish_dispatch(struct scx_sched *sch, struct rq *rq,
-			    struct task_struct *p,
-			    unsigned long qseq_at_dispatch,
-			    u64 dsq_id, u64 enq_flags)
+static bool claim_dispatch(struct rq *rq, struct task_struct *p,
+			   unsigned long qseq_at_dispatch)
 {
-	struct scx_dispatch_q *dsq;
 	unsigned long opss;
 
 	touch_core_sched_dispatch(rq, p);
@@ -3010,7 +3064,7 @@ static void finish_dispatch(struct scx_sched *sch, struct rq *rq,
 	case SCX_OPSS_DISPATCHING:
 	case SCX_OPSS_NONE:
 		/* someone else already got to it */
-		return;
+		return false;
 	case SCX_OPSS_QUEUED:
 		/*
 		 * If qseq doesn't match, @p has gone through at least one
@@ -3018,7 +3072,7 @@ static void finish_dispatch(struct scx_sched *sch, struct rq *rq,
 		 * scx_bpf_dsq_insert() and here and we have no claim on it.
 		 */
 		if ((opss & SCX_OPSS_QSEQ_MASK) != qseq_at_dispatch)
-			return;
+			return false;
 
 		/*
 		 * While we know @p is accessible, we don't yet have a claim on
@@ -3043,6 +3097,18 @@ static void finish_dispatch(struct scx_sched *sch, struct rq *rq,
 	}
 
 	BUG_ON(!(p->scx.flags & SCX_TASK_QUEUED));
+	return true;
+}
+
+static void finish_dispatch(struct scx_sched *sch, struct rq *rq,
+			    struct task_struct *p,
+			    unsigned long qseq_at_dispatch,
+			    u64 dsq_id, u64 enq_flags)
+{
+	struct scx_dispatch_q *dsq;
+
+	if (!claim_dispatch(rq, p, qseq_at_dispatch))
+		return;
 
 	dsq = find_dsq_for_dispatch(sch, this_rq(), dsq_id, p);
 
@@ -3052,14 +3118,87 @@ static void finish_dispatch(struct scx_sched *sch, struct rq *rq,
 		dispatch_enqueue(sch, dsq, p, enq_flags | SCX_ENQ_CLEAR_OPSS);
 }
 
+/*
+ * Return the number of consecutive dispatch buffer entries starting at @u
+ * which target the same user DSQ.
+ */
+static u32 dispatch_buf_run(struct scx_dsp_ctx *dspc, u32 u)
+{
+	u64 dsq_id = dspc->buf[u].dsq_id;
+	u32 v;
+
+	if (dsq_id & SCX_DSQ_FLAG_BUILTIN)
+		return 1;
+
+	for (v = u + 1; v < dspc->cursor; v++)
+		if (dspc->buf[v].dsq_id != dsq_id)
+			break;
+
+	return v - u;
+}
+
+/*
+ * Finish @nr dispatches into the same user DSQ. All tasks are claimed first
+ * and then queued under a single acquisition of the DSQ lock. Claiming may
+ * have to wait for a racing enqueue which can need the DSQ lock, so it must
+ * not be done with the lock held.
+ *
+ * Claimed tasks sit in DISPATCHING until queued. That's only safe because
+ * nothing between claiming and queueing takes an rq lock, so runs are limited
+ * to user DSQs; local DSQ dispatches may need to lock remote rqs.
+ */
+static void finish_dispatch_run(struct scx_sched *sch, struct rq *rq,
+				struct scx_dsp_buf_ent *ents, u32 nr)
+{
+	struct scx_dispatch_q *dsq;
+	u32 u;
+
+	dsq = find_user_dsq(sch, ents[0].dsq_id);
+	if (unlikely(!dsq)) {
+		for (u = 0; u < nr; u++)
+			finish_dispatch(sch, rq, ents[u].task, ents[u].qseq,
+					ents[u].dsq_id, ents[u].enq_flags);
+		return;
+	}
+
+	for (u = 0; u < nr; u++)
+		if (!claim_dispatch(rq, ents[u].task, ents[u].qseq))
+			ents[u].task = NULL;
+
+	raw_spin_lock(&dsq->lock);
+
+	if (unlikely(dsq->id == SCX_DSQ_INVALID)) {
+		/* dispatch_enqueue() handles the fallback */
+		raw_spin_unlock(&dsq->lock);
+		for (u = 0; u < nr; u++)
+			if (ents[u].task)
+				dispatch_enqueue(sch, dsq, ents[u].task,
+						 ents[u].enq_flags | SCX_ENQ_CLEAR_OPSS);
+		return;
+	}
+
+	for (u = 0; u < nr; u++)
+		if (ents[u].task)
+			__dispatch_enqueue(sch, dsq, ents[u].task,
+					   ents[u].enq_flags | SCX_ENQ_CLEAR_OPSS);
+
+	raw_spin_unlock(&dsq->lock);
+}
+
 static void flush_dispatch_buf(struct scx_sched *sch, struct rq *rq)
 {
 	struct scx_dsp_ctx *dspc = this_cpu_ptr(scx_dsp_ctx);
-	u32 u;
+	u32 u, nr;
 
-	for (u = 0; u < dspc->cursor; u++) {
+	for (u = 0; u < dspc->cursor; u += nr) {
 		struct scx_dsp_buf_ent *ent = &dspc->buf[u];
 
+		nr = dispatch_buf_run(dspc, u);
+		if (nr > 1) {
+			finish_dispatch_run(sch, rq, ent, nr);
+			continue;
+		}
+
 		finish_dispatch(sch, rq, ent->task, ent->qseq, ent->dsq_id,
 				ent->enq_flags);
 	}
@@ -6594,6 +6733,43 @@ __bpf_kfunc bool scx_bpf_dsq_move_to_local(u64 dsq_id)
 	}
 }
 
+/**
+ * scx_bpf_dsq_move_to_local_nr - move multiple tasks from a DSQ to the local DSQ
+ * @dsq_id: DSQ to move tasks from
+ * @nr: maximum number of tasks to move
+ *
+ * Like scx_bpf_dsq_move_to_local() but moves up to @nr tasks which are already
+ * on the current CPU under a single acquisition of the DSQ lock. If the first
+ * eligible task is on another CPU, only that task is migrated. Can only be
+ * called from ops.dispatch().
+ *
+ * Returns the number of moved tasks.
+ */
+__bpf_kfunc u32 scx_bpf_dsq_move_to_local_nr(u64 dsq_id, u32 nr)
+{
+	struct scx_sched *sch = scx_root;
+	struct scx_dsp_ctx *dspc = this_cpu_ptr(scx_dsp_ctx);
+	struct scx_dispatch_q *dsq;
+	u32 moved;
+
+	if (!scx_kf_allowed(SCX_KF_DISPATCH))
+		return 0;
+
+	flush_dispatch_buf(sch, dspc->rq);
+
+	dsq = find_user_dsq(sch, dsq_id);
+	if (unlikely(!dsq)) {
+		scx_error(sch, "invalid DSQ ID 0x%016llx", dsq_id);
+		return 0;
+	}
+
+	moved = consume_dispatch_q_nr(sch, dspc->rq, dsq, nr);
+
+	/* see scx_bpf_dsq_move_to_local() */
+	dspc->nr_tasks += moved;
+	return moved;
+}
+
 /* for backward compatibility, will be removed in v6.15 */
 __bpf_kfunc bool scx_bpf_consume(u64 dsq_id)
 {
@@ -6735,6 +6911,7 @@ BTF_KFUNCS_START(scx_kfunc_ids_dispatch)
 BTF_ID_FLAGS(func, scx_bpf_dispatch_nr_slots)
 BTF_ID_FLAGS(func, scx_bpf_dispatch_cancel)
 BTF_ID_FLAGS(func, scx_bpf_dsq_move_to_local)
+BTF_ID_FLAGS(func, scx_bpf_dsq_move_to_local_nr)
 BTF_ID_FLAGS(func, scx_bpf_consume)
 BTF_ID_FLAGS(func, scx_bpf_dsq_move_set_slice)
 BTF_ID_FLAGS(func, scx_bpf_dsq_move_set_vtime)
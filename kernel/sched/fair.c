@@ -43,6 +43,7 @@
 #include <linux/interrupt.h>
 #include <linux/memory-tiers.h>
 #include <linux/mempolicy.h>
+#include <linux/migrate.h>
 #include <linux/mutex_api.h>
 #include <linux/profile.h>
 #include <linux/psi.h>
@@ -756,11 +757,13 @@ static u64 __update_min_vruntime(struct cfs_rq *cfs_rq, u64 vruntime)
 	return min_vruntime;
 }
 
+static bool __pick_min_slice(struct cfs_rq *cfs_rq, u64 *slice);
+
 static void update_min_vruntime(struct cfs_rq *cfs_rq)
 {
-	struct sched_entity *se = __pick_root_entity(cfs_rq);
 	struct sched_entity *curr = cfs_rq->curr;
 	u64 vruntime = cfs_rq->min_vruntime;
+	u64 queued;
 
 	if (curr) {
 		if (curr->on_rq)
@@ -769,11 +772,11 @@ static void update_min_vruntime(struct cfs_rq *cfs_rq)
 			curr = NULL;
 	}
 
-	if (se) {
+	if (__pick_min_vruntime(cfs_rq, &queued)) {
 		if (!curr)
-			vruntime = se->min_vruntime;
+			vruntime = queued;
 		else
-			vruntime = min_vruntime(vruntime, se->min_vruntime);
+			vruntime = min_vruntime(vruntime, queued);
 	}
 
 	/* ensure we never gain time by being placed backwards. */
@@ -782,15 +785,15 @@ static void update_min_vruntime(struct cfs_rq *cfs_rq)
 
 static inline u64 cfs_rq_min_slice(struct cfs_rq *cfs_rq)
 {
-	struct sched_entity *root = __pick_root_entity(cfs_rq);
 	struct sched_entity *curr = cfs_rq->curr;
 	u64 min_slice = ~0ULL;
+	u64 queued;
 
 	if (curr && curr->on_rq)
 		min_slice = curr->slice;
 
-	if (root)
-		min_slice = min(min_slice, root->min_slice);
+	if (__pick_min_slice(cfs_rq, &queued))
+		min_slice = min(min_slice, queued);
 
 	return min_slice;
 }
@@ -844,25 +847,318 @@ static inline bool min_vruntime_update(struct sched_entity *se, bool exit)
 RB_DECLARE_CALLBACKS(static, min_vruntime_cb, struct sched_entity,
 		     run_node, min_vruntime, min_vruntime_update);
 
+#ifdef CONFIG_SCHED_EEVDF_BUCKETS
+/*
+ * Bucketed deadline index, see struct cfs_buckets.
+ *
+ * Buckets are addressed logically relative to @head; logical bucket i
+ * holds deadlines in [base + i*W, base + (i+1)*W), with the first bucket
+ * also taking anything before @base and the last one anything past the
+ * wheel. Every entity in a bucket thus has an earlier deadline than those in
+ * any later bucket, and buckets are kept sorted on deadline, so the index
+ * reads in deadline order like the rb-tree does. The head bucket is kept
+ * occupied while the index is not empty, rotating the wheel forward when it
+ * drains.
+ *
+ * Cost is proportional to bucket occupancy rather than to log(n), so this
+ * only wins while nr_queued / CFS_NR_BUCKETS stays small; perf bench sched
+ * rq-index replays both indexes.
+ */
+static DEFINE_STATIC_KEY_FALSE(sched_eevdf_buckets);
+
+static int __init setup_sched_rq_index(char *str)
+{
+	if (!strcmp(str, "buckets")) {
+		static_branch_enable(&sched_eevdf_buckets);
+	} else if (strcmp(str, "rbtree")) {
+		pr_warn("Unable to parse sched_rq_index=\n");
+		return 0;
+	}
+	return 1;
+}
+__setup("sched_rq_index=", setup_sched_rq_index);
+
+static __always_inline bool cfs_buckets_enabled(void)
+{
+	return static_branch_unlikely(&sched_eevdf_buckets);
+}
+
+#define CFS_BUCKET_MASK		(CFS_NR_BUCKETS - 1)
+
+static inline struct cfs_bucket *
+__logical_bucket(struct cfs_buckets *cb, unsigned int pos)
+{
+	return &cb->bucket[(cb->head + pos) & CFS_BUCKET_MASK];
+}
+
+/* Find the first occupied logical bucket at or after @pos. */
+static unsigned int __next_bucket(struct cfs_buckets *cb, unsigned int pos)
+{
+	unsigned int tail = CFS_NR_BUCKETS - cb->head;
+	unsigned int n;
+
+	if (pos < tail) {
+		n = find_next_bit(cb->occupied, CFS_NR_BUCKETS, cb->head + pos);
+		if (n < CFS_NR_BUCKETS)
+			return n - cb->head;
+		pos = tail;
+	}
+
+	n = find_next_bit(cb->occupied, cb->head, pos - tail);
+	if (n < cb->head)
+		return n + tail;
+
+	return CFS_NR_BUCKETS;
+}
+
+#define for_each_occupied_bucket(cb, pos)				\
+	for (pos = __next_bucket(cb, 0); pos < CFS_NR_BUCKETS;		\
+	     pos = __next_bucket(cb, pos + 1))
+
+static void __bucket_update(struct cfs_bucket *b)
+{
+	struct sched_entity *se;
+
+	se = list_first_entry(&b->entities, struct sched_entity, bucket_node);
+	b->min_vruntime = se->vruntime;
+	b->min_slice = se->slice;
+
+	list_for_each_entry_continue(se, &b->entities, bucket_node) {
+		b->min_vruntime = min_vruntime(b->min_vruntime, se->vruntime);
+		b->min_slice = min(b->min_slice, se->slice);
+	}
+}
+
+static void __buckets_update(struct cfs_buckets *cb)
+{
+	unsigned int pos;
+	bool first = true;
+
+	for_each_occupied_bucket(cb, pos) {
+		struct cfs_bucket *b = __logical_bucket(cb, pos);
+
+		if (first) {
+			cb->min_vruntime = b->min_vruntime;
+			cb->min_slice = b->min_slice;
+			first = false;
+			continue;
+		}
+		cb->min_vruntime = min_vruntime(cb->min_vruntime, b->min_vruntime);
+		cb->min_slice = min(cb->min_slice, b->min_slice);
+	}
+}
+
+static void __bucket_insert(struct cfs_buckets *cb, struct sched_entity *se)
+{
+	s64 delta = (s64)(se->deadline - cb->base);
+	struct list_head *link;
+	unsigned int pos = 0, idx;
+	struct sched_entity *prev;
+	struct cfs_bucket *b;
+
+	if (delta > 0)
+		pos = min_t(u64, delta >> CFS_BUCKET_SHIFT, CFS_NR_BUCKETS - 1);
+
+	idx = (cb->head + pos) & CFS_BUCKET_MASK;
+	b = &cb->bucket[idx];
+	if (list_empty(&b->entities)) {
+		b->min_vruntime = se->vruntime;
+		b->min_slice = se->slice;
+		__set_bit(idx, cb->occupied);
+	} else {
+		b->min_vruntime = min_vruntime(b->min_vruntime, se->vruntime);
+		b->min_slice = min(b->min_slice, se->slice);
+	}
+
+	/*
+	 * Keep the bucket sorted on deadline; requeued entities tend to have
+	 * the latest deadlines around, so search from the tail.
+	 */
+	link = &b->entities;
+	list_for_each_entry_reverse(prev, &b->entities, bucket_node) {
+		if (!entity_before(se, prev))
+			break;
+		link = &prev->bucket_node;
+	}
+	list_add_tail(&se->bucket_node, link);
+	se->bucket = idx;
+}
+
+/*
+ * The head bucket drained: advance the wheel to the first occupied bucket.
+ * The old last bucket may hold deadlines that now fall inside the wheel, so
+ * spread it out again.
+ */
+static void __buckets_rotate(struct cfs_buckets *cb)
+{
+	while (!test_bit(cb->head, cb->occupied)) {
+		unsigned int last = (cb->head + CFS_BUCKET_MASK) & CFS_BUCKET_MASK;
+		unsigned int pos = __next_bucket(cb, 0);
+		struct sched_entity *se, *next;
+		LIST_HEAD(overflow);
+
+		cb->head = (cb->head + pos) & CFS_BUCKET_MASK;
+		cb->base += (u64)pos << CFS_BUCKET_SHIFT;
+
+		if (!test_bit(last, cb->occupied))
+			continue;
+
+		list_splice_init(&cb->bucket[last].entities, &overflow);
+		__clear_bit(last, cb->occupied);
+		list_for_each_entry_safe(se, next, &overflow, bucket_node)
+			__bucket_insert(cb, se);
+	}
+}
+
+static void cfs_buckets_add(struct cfs_rq *cfs_rq, struct sched_entity *se)
+{
+	struct cfs_buckets *cb = &cfs_rq->buckets;
+
+	if (!cb->nr++) {
+		cb->base = se->deadline & ~((1ULL << CFS_BUCKET_SHIFT) - 1);
+		cb->head = 0;
+		cb->min_vruntime = se->vruntime;
+		cb->min_slice = se->slice;
+	} else {
+		cb->min_vruntime = min_vruntime(cb->min_vruntime, se->vruntime);
+		cb->min_slice = min(cb->min_slice, se->slice);
+	}
+	__bucket_insert(cb, se);
+}
+
+static void cfs_buckets_del(struct cfs_rq *cfs_rq, struct sched_entity *se)
+{
+	struct cfs_buckets *cb = &cfs_rq->buckets;
+	struct cfs_bucket *b = &cb->bucket[se->bucket];
+
+	list_del(&se->bucket_node);
+	if (list_empty(&b->entities))
+		__clear_bit(se->bucket, cb->occupied);
+	else if (se->vruntime == b->min_vruntime || se->slice == b->min_slice)
+		__bucket_update(b);
+
+	if (!--cb->nr)
+		return;
+
+	__buckets_rotate(cb);
+	if (se->vruntime == cb->min_vruntime || se->slice == cb->min_slice)
+		__buckets_update(cb);
+}
+
+/* @se's slice changed while it was queued. */
+static void cfs_buckets_propagate(struct cfs_rq *cfs_rq, struct sched_entity *se)
+{
+	struct cfs_buckets *cb = &cfs_rq->buckets;
+
+	__bucket_update(&cb->bucket[se->bucket]);
+	__buckets_update(cb);
+}
+
+static struct sched_entity *cfs_buckets_first(struct cfs_rq *cfs_rq)
+{
+	struct cfs_buckets *cb = &cfs_rq->buckets;
+
+	if (!cb->nr)
+		return NULL;
+
+	return list_first_entry(&__logical_bucket(cb, 0)->entities,
+				struct sched_entity, bucket_node);
+}
+
+static struct sched_entity *cfs_buckets_last(struct cfs_rq *cfs_rq)
+{
+	struct cfs_buckets *cb = &cfs_rq->buckets;
+	unsigned int pos, found = CFS_NR_BUCKETS;
+
+	for_each_occupied_bucket(cb, pos)
+		found = pos;
+	if (found == CFS_NR_BUCKETS)
+		return NULL;
+
+	return list_last_entry(&__logical_bucket(cb, found)->entities,
+			       struct sched_entity, bucket_node);
+}
+
 /*
- * Enqueue an entity into the rb-tree:
+ * Buckets are sorted on deadline and every later bucket only holds later
+ * deadlines, so the first eligible entity found is the EEVD entity.
+ */
+static struct sched_entity *cfs_buckets_pick(struct cfs_rq *cfs_rq)
+{
+	struct cfs_buckets *cb = &cfs_rq->buckets;
+	struct sched_entity *se;
+	unsigned int pos;
+
+	for_each_occupied_bucket(cb, pos) {
+		struct cfs_bucket *b = __logical_bucket(cb, pos);
+
+		if (!vruntime_eligible(cfs_rq, b->min_vruntime))
+			continue;
+
+		list_for_each_entry(se, &b->entities, bucket_node) {
+			if (entity_eligible(cfs_rq, se))
+				return se;
+		}
+	}
+	return NULL;
+}
+
+static void init_cfs_buckets(struct cfs_rq *cfs_rq)
+{
+	struct cfs_buckets *cb = &cfs_rq->buckets;
+	int i;
+
+	for (i = 0; i < CFS_NR_BUCKETS; i++)
+		INIT_LIST_HEAD(&cb->bucket[i].entities);
+}
+#else /* !CONFIG_SCHED_EEVDF_BUCKETS */
+static __always_inline bool cfs_buckets_enabled(void) { return false; }
+static inline void cfs_buckets_add(struct cfs_rq *cfs_rq, struct sched_entity *se) { }
+static inline void cfs_buckets_del(struct cfs_rq *cfs_rq, struct sched_entity *se) { }
+static inline void cfs_buckets_propagate(struct cfs_rq *cfs_rq, struct sched_entity *se) { }
+static inline struct sched_entity *cfs_buckets_first(struct cfs_rq *cfs_rq) { return NULL; }
+static inline struct sched_entity *cfs_buckets_last(struct cfs_rq *cfs_rq) { return NULL; }
+static inline struct sched_entity *cfs_buckets_pick(struct cfs_rq *cfs_rq) { return NULL; }
+static inline void init_cfs_buckets(struct cfs_rq *cfs_rq) { }
+#endif /* CONFIG_SCHED_EEVDF_BUCKETS */
+
+/*
+ * Enqueue an entity into the runqueue index:
  */
 static void __enqueue_entity(struct cfs_rq *cfs_rq, struct sched_entity *se)
 {
 	avg_vruntime_add(cfs_rq, se);
 	se->min_vruntime = se->vruntime;
 	se->min_slice = se->slice;
+	if (cfs_buckets_enabled()) {
+		cfs_buckets_add(cfs_rq, se);
+		return;
+	}
 	rb_add_augmented_cached(&se->run_node, &cfs_rq->tasks_timeline,
 				__entity_less, &min_vruntime_cb);
 }
 
 static void __dequeue_entity(struct cfs_rq *cfs_rq, struct sched_entity *se)
 {
-	rb_erase_augmented_cached(&se->run_node, &cfs_rq->tasks_timeline,
-				  &min_vruntime_cb);
+	if (cfs_buckets_enabled())
+		cfs_buckets_del(cfs_rq, se);
+	else
+		rb_erase_augmented_cached(&se->run_node, &cfs_rq->tasks_timeline,
+					  &min_vruntime_cb);
 	avg_vruntime_sub(cfs_rq, se);
 }
 
+/*
+ * Update the index after the slice of a queued, not running, entity changed.
+ */
+static void __propagate_entity(struct cfs_rq *cfs_rq, struct sched_entity *se)
+{
+	if (cfs_buckets_enabled())
+		cfs_buckets_propagate(cfs_rq, se);
+	else
+		min_vruntime_cb_propagate(&se->run_node, NULL);
+}
+
 struct sched_entity *__pick_root_entity(struct cfs_rq *cfs_rq)
 {
 	struct rb_node *root = cfs_rq->tasks_timeline.rb_root.rb_node;
@@ -873,10 +1169,55 @@ struct sched_entity *__pick_root_entity(struct cfs_rq *cfs_rq)
 	return __node_2_se(root);
 }
 
+/*
+ * Minimum vruntime and slice of the queued entities, false if there are none.
+ */
+bool __pick_min_vruntime(struct cfs_rq *cfs_rq, u64 *vruntime)
+{
+	struct sched_entity *root;
+
+#ifdef CONFIG_SCHED_EEVDF_BUCKETS
+	if (cfs_buckets_enabled()) {
+		if (!cfs_rq->buckets.nr)
+			return false;
+		*vruntime = cfs_rq->buckets.min_vruntime;
+		return true;
+	}
+#endif
+	root = __pick_root_entity(cfs_rq);
+	if (!root)
+		return false;
+	*vruntime = root->min_vruntime;
+	return true;
+}
+
+static bool __pick_min_slice(struct cfs_rq *cfs_rq, u64 *slice)
+{
+	struct sched_entity *root;
+
+#ifdef CONFIG_SCHED_EEVDF_BUCKETS
+	if (cfs_buckets_enabled()) {
+		if (!cfs_rq->buckets.nr)
+			return false;
+		*slice = cfs_rq->buckets.min_slice;
+		return true;
+	}
+#endif
+	root = __pick_root_entity(cfs_rq);
+	if (!root)
+		return false;
+	*slice = root->min_slice;
+	return true;
+}
+
 struct sched_entity *__pick_first_entity(struct cfs_rq *cfs_rq)
 {
-	struct rb_node *left = rb_first_cached(&cfs_rq->tasks_timeline);
+	struct rb_node *left;
 
+	if (cfs_buckets_enabled())
+		return cfs_buckets_first(cfs_rq);
+
+	left = rb_first_cached(&cfs_rq->tasks_timeline);
 	if (!left)
 		return NULL;
 
@@ -948,6 +1289,11 @@ static struct sched_entity *pick_eevdf(struct cfs_rq *cfs_rq)
 		goto found;
 	}
 
+	if (cfs_buckets_enabled()) {
+		best = cfs_buckets_pick(cfs_rq);
+		goto found;
+	}
+
 	/* Heap search for the EEVD entity */
 	while (node) {
 		struct rb_node *left = node->rb_left;
@@ -985,7 +1331,12 @@ static struct sched_entity *pick_eevdf(struct cfs_rq *cfs_rq)
 
 struct sched_entity *__pick_last_entity(struct cfs_rq *cfs_rq)
 {
-	struct rb_node *last = rb_last(&cfs_rq->tasks_timeline.rb_root);
+	struct rb_node *last;
+
+	if (cfs_buckets_enabled())
+		return cfs_buckets_last(cfs_rq);
+
+	last = rb_last(&cfs_rq->tasks_timeline.rb_root);
 
 	if (!last)
 		return NULL;
@@ -1463,6 +1814,9 @@ unsigned int sysctl_numa_balancing_scan_delay = 1000;
 /* The page with hint page fault latency < threshold in ms is considered hot */
 unsigned int sysctl_numa_balancing_hot_threshold = MSEC_PER_SEC;
 
+/* Misplaced folios migrated together by hinting faults, <= 1 disables batching */
+unsigned int sysctl_numa_balancing_migrate_batch = 32;
+
 struct numa_group {
 	refcount_t refcount;
 
@@ -3579,12 +3933,17 @@ void init_numa_balancing(unsigned long clone_flags, struct task_struct *p)
 	p->numa_work.next		= &p->numa_work;
 	p->numa_faults			= NULL;
 	p->numa_pages_migrated		= 0;
+	INIT_LIST_HEAD(&p->numa_migrate_list);
+	p->numa_migrate_nr		= 0;
+	/* Protect against double add, see migrate_misplaced_folio_queue */
+	p->numa_migrate_work.next	= &p->numa_migrate_work;
 	p->total_numa_faults		= 0;
 	RCU_INIT_POINTER(p->numa_group, NULL);
 	p->last_task_numa_placement	= 0;
 	p->last_sum_exec_runtime	= 0;
 
 	init_task_work(&p->numa_work, task_numa_work);
+	init_task_work(&p->numa_migrate_work, migrate_misplaced_flush);
 
 	/* New address space, reset the preferred nid */
 	if (!(clone_flags & CLONE_VM)) {
@@ -3614,6 +3973,8 @@ static void task_tick_numa(struct rq *rq, struct task_struct *curr)
 	struct callback_head *work = &curr->numa_work;
 	u64 period, now;
 
+	migrate_misplaced_tick(curr);
+
 	/*
 	 * We don't care about NUMA placement if we don't have memory.
 	 */
@@ -7008,7 +7369,7 @@ enqueue_task_fair(struct rq *rq, struct task_struct *p, int flags)
 
 		se->slice = slice;
 		if (se != cfs_rq->curr)
-			min_vruntime_cb_propagate(&se->run_node, NULL);
+			__propagate_entity(cfs_rq, se);
 		slice = cfs_rq_min_slice(cfs_rq);
 
 		cfs_rq->h_nr_runnable += h_nr_runnable;
@@ -7137,7 +7498,7 @@ static int dequeue_entities(struct rq *rq, struct sched_entity *se, int flags)
 
 		se->slice = slice;
 		if (se != cfs_rq->curr)
-			min_vruntime_cb_propagate(&se->run_node, NULL);
+			__propagate_entity(cfs_rq, se);
 		slice = cfs_rq_min_slice(cfs_rq);
 
 		cfs_rq->h_nr_runnable -= h_nr_runnable;
@@ -7290,6 +7651,9 @@ static unsigned long capacity_of(int cpu)
 	return cpu_rq(cpu)->cpu_capacity;
 }
 
+#define WAKER_HITS_HOT		8
+#define WAKER_HITS_MAX		64
+
 static void record_wakee(struct task_struct *p)
 {
 	/*
@@ -7305,6 +7669,28 @@ static void record_wakee(struct task_struct *p)
 		current->last_wakee = p;
 		current->wakee_flips++;
 	}
+
+	if (p->last_waker != current) {
+		p->last_waker = current;
+		p->waker_hits = 0;
+	} else if (p->waker_hits < WAKER_HITS_MAX) {
+		p->waker_hits++;
+	}
+}
+
+/*
+ * A wakee that was woken WAKER_HITS_HOT times in a row by the current task,
+ * which in turn doesn't wake many others, is taken to be one half of a
+ * communicating pair (request/response, producer/consumer) that benefits
+ * from sharing an LLC with its partner.
+ */
+static bool wake_cache_affine(struct task_struct *p)
+{
+	if (!sched_feat(WA_CACHE))
+		return false;
+	if (p->last_waker != current || p->waker_hits < WAKER_HITS_HOT)
+		return false;
+	return current->wakee_flips < __this_cpu_read(sd_llc_size);
 }
 
 /*
@@ -7863,6 +8249,31 @@ static int select_idle_sibling(struct task_struct *p, int prev, int target)
 	 */
 	lockdep_assert_irqs_disabled();
 
+	/*
+	 * A cache affine pair got split across LLCs, e.g. because the waker
+	 * was busy and wake_affine() kept the wakee on prev. Look for an idle
+	 * CPU next to the waker before settling for the remote LLC.
+	 */
+	if (!sched_asym_cpucap_active() && wake_cache_affine(p)) {
+		int this_cpu = smp_processor_id();
+
+		if (!cpus_share_cache(this_cpu, target) &&
+		    cpumask_test_cpu(this_cpu, p->cpus_ptr)) {
+			sd = rcu_dereference(per_cpu(sd_llc, this_cpu));
+			if (sd) {
+				schedstat_inc(p->stats.nr_wakeups_cache_affine_attempts);
+				has_idle_core = sched_smt_active() &&
+						test_idle_cores(this_cpu);
+				i = select_idle_cpu(p, sd, has_idle_core, this_cpu);
+				if ((unsigned int)i < nr_cpumask_bits) {
+					schedstat_inc(p->stats.nr_wakeups_cache_affine);
+					return i;
+				}
+				has_idle_core = false;
+			}
+		}
+	}
+
 	if ((available_idle_cpu(target) || sched_idle_cpu(target)) &&
 	    asym_fits_cpu(task_util, util_min, util_max, target))
 		return target;
@@ -12192,6 +12603,50 @@ static inline bool update_newidle_cost(struct sched_domain *sd, u64 cost)
 	return false;
 }
 
+/*
+ * A newidle balance succeeds when it pulls a task. The counts are halved
+ * every NEWIDLE_HISTORY calls, newidle_ratio is the success rate at that
+ * point in units of 1/NEWIDLE_HISTORY.
+ */
+#define NEWIDLE_HISTORY		1024
+#define NEWIDLE_PROBE		16
+
+static inline void update_newidle_history(struct sched_domain *sd, bool success)
+{
+	sd->newidle_call++;
+	sd->newidle_success += success;
+	sd->nr_newidle_skipped = 0;
+
+	if (sd->newidle_call >= NEWIDLE_HISTORY) {
+		sd->newidle_ratio = sd->newidle_success;
+		sd->newidle_call /= 2;
+		sd->newidle_success /= 2;
+	}
+}
+
+/*
+ * avg_idle scaled by newidle_ratio estimates what balancing @sd buys us.
+ * Skip @sd when that is below its cost, except for every NEWIDLE_PROBE'th
+ * attempt, which keeps newidle_ratio up to date.
+ */
+static inline bool newidle_history_skip(struct rq *this_rq, struct sched_domain *sd)
+{
+	u64 benefit;
+
+	if (!sched_feat(NI_HISTORY))
+		return false;
+
+	benefit = (this_rq->avg_idle * sd->newidle_ratio) / NEWIDLE_HISTORY;
+	if (benefit >= sd->max_newidle_lb_cost)
+		return false;
+
+	if (++sd->nr_newidle_skipped >= NEWIDLE_PROBE)
+		return false;
+
+	schedstat_inc(sd->lb_newidle_skipped);
+	return true;
+}
+
 /*
  * It checks each scheduling domain to see if it is due to be balanced,
  * and initiates a balancing operation if so.
@@ -12861,6 +13316,9 @@ static int sched_balance_newidle(struct rq *this_rq, struct rq_flags *rf)
 
 		if (sd->flags & SD_BALANCE_NEWIDLE) {
 
+			if (newidle_history_skip(this_rq, sd))
+				continue;
+
 			pulled_task = sched_balance_rq(this_cpu, this_rq,
 						   sd, CPU_NEWLY_IDLE,
 						   &continue_balancing);
@@ -12868,6 +13326,7 @@ static int sched_balance_newidle(struct rq *this_rq, struct rq_flags *rf)
 			t1 = sched_clock_cpu(this_cpu);
 			domain_cost = t1 - t0;
 			update_newidle_cost(sd, domain_cost);
+			update_newidle_history(sd, pulled_task);
 
 			curr_cost += domain_cost;
 			t0 = t1;
@@ -13325,6 +13784,7 @@ static void set_next_task_fair(struct rq *rq, struct task_struct *p, bool first)
 void init_cfs_rq(struct cfs_rq *cfs_rq)
 {
 	cfs_rq->tasks_timeline = RB_ROOT_CACHED;
+	init_cfs_buckets(cfs_rq);
 	cfs_rq->min_vruntime = (u64)(-(1LL << 20));
 #ifdef CONFIG_SMP
 	raw_spin_lock_init(&cfs_rq->removed.lock);
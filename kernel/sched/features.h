@@ -114,6 +114,16 @@ SCHED_FEAT(ATTACH_AGE_LOAD, true)
 SCHED_FEAT(WA_IDLE, true)
 SCHED_FEAT(WA_WEIGHT, true)
 SCHED_FEAT(WA_BIAS, true)
+/*
+ * Keep a wakee that is repeatedly woken by the same waker inside the
+ * waker's LLC, where the data they exchange is likely to be cached.
+ */
+SCHED_FEAT(WA_CACHE, false)
+
+/*
+ * Skip newidle balance of domains that rarely had a task to pull.
+ */
+SCHED_FEAT(NI_HISTORY, true)
 
 /*
  * UtilEstimation. Use estimated CPU utilization.
@@ -162,6 +162,7 @@ __setup("psi=", setup_psi);
 /* PSI trigger definitions */
 #define WINDOW_MAX_US 10000000	/* Max window size is 10s */
 #define UPDATES_PER_WINDOW 10	/* 10 updates per window */
+#define RTPOLL_MIN_PERIOD_NS (10 * NSEC_PER_USEC) /* Poll at most every 10us */
 
 /* Sampling frequency in nanoseconds */
 static u64 psi_period __read_mostly;
@@ -174,15 +175,39 @@ struct psi_group psi_system = {
 
 static void psi_avgs_work(struct work_struct *work);
 
-static void poll_timer_fn(struct timer_list *t);
+static enum hrtimer_restart poll_timer_fn(struct hrtimer *t);
 
-static void group_init(struct psi_group *group)
+/*
+ * A task state change updates every level of the task's cgroup ancestry on
+ * its CPU. Rather than sampling the clock and bumping a seqcount for every
+ * level, the whole walk is covered by a single per-CPU seqcount and uses one
+ * timestamp. This also keeps the levels consistent with each other.
+ */
+static DEFINE_PER_CPU(seqcount_t, psi_seq) = SEQCNT_ZERO(psi_seq);
+
+static inline void psi_write_begin(int cpu)
 {
-	int cpu;
+	write_seqcount_begin(per_cpu_ptr(&psi_seq, cpu));
+}
 
+static inline void psi_write_end(int cpu)
+{
+	write_seqcount_end(per_cpu_ptr(&psi_seq, cpu));
+}
+
+static inline u32 psi_read_begin(int cpu)
+{
+	return read_seqcount_begin(per_cpu_ptr(&psi_seq, cpu));
+}
+
+static inline bool psi_read_retry(int cpu, u32 seq)
+{
+	return read_seqcount_retry(per_cpu_ptr(&psi_seq, cpu), seq);
+}
+
+static void group_init(struct psi_group *group)
+{
 	group->enabled = true;
-	for_each_possible_cpu(cpu)
-		seqcount_init(&per_cpu_ptr(group->pcpu, cpu)->seq);
 	group->avg_last_update = sched_clock();
 	group->avg_next_update = group->avg_last_update + psi_period;
 	mutex_init(&group->avgs_lock);
@@ -199,7 +224,8 @@ static void group_init(struct psi_group *group)
 	group->rtpoll_min_period = U32_MAX;
 	group->rtpoll_next_update = ULLONG_MAX;
 	init_waitqueue_head(&group->rtpoll_wait);
-	timer_setup(&group->rtpoll_timer, poll_timer_fn, 0);
+	hrtimer_setup(&group->rtpoll_timer, poll_timer_fn, CLOCK_MONOTONIC,
+		      HRTIMER_MODE_REL);
 	rcu_assign_pointer(group->rtpoll_task, NULL);
 }
 
@@ -262,14 +288,14 @@ static void get_recent_times(struct psi_group *group, int cpu,
 
 	/* Snapshot a coherent view of the CPU state */
 	do {
-		seq = read_seqcount_begin(&groupc->seq);
+		seq = psi_read_begin(cpu);
 		now = cpu_clock(cpu);
 		memcpy(times, groupc->times, sizeof(groupc->times));
 		state_mask = groupc->state_mask;
 		state_start = groupc->state_start;
 		if (cpu == current_cpu)
 			memcpy(tasks, groupc->tasks, sizeof(groupc->tasks));
-	} while (read_seqcount_retry(&groupc->seq, seq));
+	} while (psi_read_retry(cpu, seq));
 
 	/* Calculate state time deltas against the previous snapshot */
 	for (s = 0; s < NR_PSI_STATES; s++) {
@@ -600,8 +626,12 @@ static void init_rtpoll_triggers(struct psi_group *group, u64 now)
 	group->rtpoll_next_update = now + group->rtpoll_min_period;
 }
 
-/* Schedule rtpolling if it's not already scheduled or forced. */
-static void psi_schedule_rtpoll_work(struct psi_group *group, unsigned long delay,
+/*
+ * Schedule rtpolling in @delay nsecs if it's not already scheduled or forced.
+ * An hrtimer is used so that trigger windows shorter than a few ticks are
+ * still polled at their requested resolution.
+ */
+static void psi_schedule_rtpoll_work(struct psi_group *group, u64 delay,
 				   bool force)
 {
 	struct task_struct *task;
@@ -621,7 +651,8 @@ static void psi_schedule_rtpoll_work(struct psi_group *group, unsigned long dela
 	 * psi_task_change (hotpath) which can't use locks
 	 */
 	if (likely(task))
-		mod_timer(&group->rtpoll_timer, jiffies + delay);
+		hrtimer_start(&group->rtpoll_timer, ns_to_ktime(delay),
+			      HRTIMER_MODE_REL);
 	else
 		atomic_set(&group->rtpoll_scheduled, 0);
 
@@ -705,9 +736,8 @@ static void psi_rtpoll_work(struct psi_group *group)
 		group->rtpoll_next_update = now + group->rtpoll_min_period;
 	}
 
-	psi_schedule_rtpoll_work(group,
-		nsecs_to_jiffies(group->rtpoll_next_update - now) + 1,
-		force_reschedule);
+	psi_schedule_rtpoll_work(group, group->rtpoll_next_update - now,
+				 force_reschedule);
 
 out:
 	mutex_unlock(&group->rtpoll_trigger_lock);
@@ -731,12 +761,23 @@ static int psi_rtpoll_worker(void *data)
 	return 0;
 }
 
-static void poll_timer_fn(struct timer_list *t)
+static enum hrtimer_restart poll_timer_fn(struct hrtimer *t)
 {
-	struct psi_group *group = timer_container_of(group, t, rtpoll_timer);
+	struct psi_group *group = container_of(t, struct psi_group, rtpoll_timer);
 
 	atomic_set(&group->rtpoll_wakeup, 1);
 	wake_up_interruptible(&group->rtpoll_wait);
+
+	return HRTIMER_NORESTART;
+}
+
+/*
+ * Delay before the rtpoll worker looks at a state change seen by the
+ * scheduler: one tick, as before, unless a trigger asked for finer updates.
+ */
+static inline u64 psi_rtpoll_delay(struct psi_group *group)
+{
+	return min_t(u64, TICK_NSEC, group->rtpoll_min_period);
 }
 
 static void record_times(struct psi_group_cpu *groupc, u64 now)
@@ -770,12 +811,11 @@ static void record_times(struct psi_group_cpu *groupc, u64 now)
 
 static void psi_group_change(struct psi_group *group, int cpu,
 			     unsigned int clear, unsigned int set,
-			     bool wake_clock)
+			     u64 now, bool wake_clock)
 {
 	struct psi_group_cpu *groupc;
 	unsigned int t, m;
 	u32 state_mask;
-	u64 now;
 
 	lockdep_assert_rq_held(cpu_rq(cpu));
 	groupc = per_cpu_ptr(group->pcpu, cpu);
@@ -788,9 +828,9 @@ static void psi_group_change(struct psi_group *group, int cpu,
 	 * assess the aggregate resource states this CPU's tasks
 	 * have been in since the last change, and account any
 	 * SOME and FULL time these may have resulted in.
+	 *
+	 * The caller holds psi_seq and provides @now.
 	 */
-	write_seqcount_begin(&groupc->seq);
-	now = cpu_clock(cpu);
 
 	/*
 	 * Start with TSK_ONCPU, which doesn't have a corresponding
@@ -842,8 +882,6 @@ static void psi_group_change(struct psi_group *group, int cpu,
 			record_times(groupc, now);
 
 		groupc->state_mask = state_mask;
-
-		write_seqcount_end(&groupc->seq);
 		return;
 	}
 
@@ -864,10 +902,8 @@ static void psi_group_change(struct psi_group *group, int cpu,
 
 	groupc->state_mask = state_mask;
 
-	write_seqcount_end(&groupc->seq);
-
 	if (state_mask & group->rtpoll_states)
-		psi_schedule_rtpoll_work(group, 1, false);
+		psi_schedule_rtpoll_work(group, psi_rtpoll_delay(group), false);
 
 	if (wake_clock && !delayed_work_pending(&group->avgs_work))
 		schedule_delayed_work(&group->avgs_work, PSI_FREQ);
@@ -901,16 +937,20 @@ void psi_task_change(struct task_struct *task, int clear, int set)
 {
 	int cpu = task_cpu(task);
 	struct psi_group *group;
+	u64 now;
 
 	if (!task->pid)
 		return;
 
 	psi_flags_change(task, clear, set);
 
+	psi_write_begin(cpu);
+	now = cpu_clock(cpu);
 	group = task_psi_group(task);
 	do {
-		psi_group_change(group, cpu, clear, set, true);
+		psi_group_change(group, cpu, clear, set, now, true);
 	} while ((group = group->parent));
+	psi_write_end(cpu);
 }
 
 void psi_task_switch(struct task_struct *prev, struct task_struct *next,
@@ -918,6 +958,10 @@ void psi_task_switch(struct task_struct *prev, struct task_struct *next,
 {
 	struct psi_group *group, *common = NULL;
 	int cpu = task_cpu(prev);
+	u64 now;
+
+	psi_write_begin(cpu);
+	now = cpu_clock(cpu);
 
 	if (next->pid) {
 		psi_flags_change(next, 0, TSK_ONCPU);
@@ -934,7 +978,7 @@ void psi_task_switch(struct task_struct *prev, struct task_struct *next,
 				break;
 			}
 
-			psi_group_change(group, cpu, 0, TSK_ONCPU, true);
+			psi_group_change(group, cpu, 0, TSK_ONCPU, now, true);
 		} while ((group = group->parent));
 	}
 
@@ -972,7 +1016,7 @@ void psi_task_switch(struct task_struct *prev, struct task_struct *next,
 		do {
 			if (group == common)
 				break;
-			psi_group_change(group, cpu, clear, set, wake_clock);
+			psi_group_change(group, cpu, clear, set, now, wake_clock);
 		} while ((group = group->parent));
 
 		/*
@@ -984,9 +1028,11 @@ void psi_task_switch(struct task_struct *prev, struct task_struct *next,
 		if ((prev->psi_flags ^ next->psi_flags) & ~TSK_ONCPU) {
 			clear &= ~TSK_ONCPU;
 			for (; group; group = group->parent)
-				psi_group_change(group, cpu, clear, set, wake_clock);
+				psi_group_change(group, cpu, clear, set, now, wake_clock);
 		}
 	}
+
+	psi_write_end(cpu);
 }
 
 #ifdef CONFIG_IRQ_TIME_ACCOUNTING
@@ -997,6 +1043,7 @@ void psi_account_irqtime(struct rq *rq, struct task_struct *curr, struct task_st
 	struct psi_group_cpu *groupc;
 	s64 delta;
 	u64 irq;
+	u64 now;
 
 	if (static_branch_likely(&psi_disabled) || !irqtime_enabled())
 		return;
@@ -1015,25 +1062,24 @@ void psi_account_irqtime(struct rq *rq, struct task_struct *curr, struct task_st
 		return;
 	rq->psi_irq_time = irq;
 
-	do {
-		u64 now;
+	psi_write_begin(cpu);
+	now = cpu_clock(cpu);
 
+	do {
 		if (!group->enabled)
 			continue;
 
 		groupc = per_cpu_ptr(group->pcpu, cpu);
 
-		write_seqcount_begin(&groupc->seq);
-		now = cpu_clock(cpu);
-
 		record_times(groupc, now);
 		groupc->times[PSI_IRQ_FULL] += delta;
 
-		write_seqcount_end(&groupc->seq);
-
 		if (group->rtpoll_states & (1 << PSI_IRQ_FULL))
-			psi_schedule_rtpoll_work(group, 1, false);
+			psi_schedule_rtpoll_work(group, psi_rtpoll_delay(group),
+						 false);
 	} while ((group = group->parent));
+
+	psi_write_end(cpu);
 }
 #endif
 
@@ -1225,7 +1271,9 @@ void psi_cgroup_restart(struct psi_group *group)
 		struct rq_flags rf;
 
 		rq_lock_irq(rq, &rf);
-		psi_group_change(group, cpu, 0, 0, true);
+		psi_write_begin(cpu);
+		psi_group_change(group, cpu, 0, 0, cpu_clock(cpu), true);
+		psi_write_end(cpu);
 		rq_unlock_irq(rq, &rf);
 	}
 }
@@ -1281,6 +1329,16 @@ int psi_show(struct seq_file *m, struct psi_group *group, enum psi_res res)
 	return 0;
 }
 
+/*
+ * Triggers are updated UPDATES_PER_WINDOW times per window. Sub-millisecond
+ * windows are fine, but don't let tiny ones turn psimon into a busy loop.
+ */
+static u32 trigger_rtpoll_period(struct psi_trigger *t)
+{
+	return max_t(u64, div_u64(t->win.size, UPDATES_PER_WINDOW),
+		     RTPOLL_MIN_PERIOD_NS);
+}
+
 struct psi_trigger *psi_trigger_create(struct psi_group *group, char *buf,
 				       enum psi_res res, struct file *file,
 				       struct kernfs_open_file *of)
@@ -1367,7 +1425,7 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group, char *buf,
 
 		list_add(&t->node, &group->rtpoll_triggers);
 		group->rtpoll_min_period = min(group->rtpoll_min_period,
-			div_u64(t->win.size, UPDATES_PER_WINDOW));
+					       trigger_rtpoll_period(t));
 		group->rtpoll_nr_triggers[t->state]++;
 		group->rtpoll_states |= (1 << t->state);
 
@@ -1427,10 +1485,9 @@ void psi_trigger_destroy(struct psi_trigger *t)
 			 * Reset min update period for the remaining triggers
 			 * iff the destroying trigger had the min window size.
 			 */
-			if (group->rtpoll_min_period == div_u64(t->win.size, UPDATES_PER_WINDOW)) {
+			if (group->rtpoll_min_period == trigger_rtpoll_period(t)) {
 				list_for_each_entry(tmp, &group->rtpoll_triggers, node)
-					period = min(period, div_u64(tmp->win.size,
-							UPDATES_PER_WINDOW));
+					period = min(period, trigger_rtpoll_period(tmp));
 				group->rtpoll_min_period = period;
 			}
 			/* Destroy rtpoll_task when the last trigger is destroyed */
@@ -1440,7 +1497,7 @@ void psi_trigger_destroy(struct psi_trigger *t)
 						group->rtpoll_task,
 						lockdep_is_held(&group->rtpoll_trigger_lock));
 				rcu_assign_pointer(group->rtpoll_task, NULL);
-				timer_delete(&group->rtpoll_timer);
+				hrtimer_cancel(&group->rtpoll_timer);
 			}
 		}
 		mutex_unlock(&group->rtpoll_trigger_lock);
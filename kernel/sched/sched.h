@@ -641,6 +641,35 @@ struct balance_callback {
 	void (*func)(struct rq *rq);
 };
 
+#ifdef CONFIG_SCHED_EEVDF_BUCKETS
+/*
+ * Alternative to the augmented rb-tree for indexing runnable entities,
+ * selected with sched_rq_index=buckets. Entities are hashed on deadline
+ * into a wheel of CFS_NR_BUCKETS buckets, 1 << CFS_BUCKET_SHIFT wide, that
+ * starts at @base; deadlines past the wheel land in the last bucket. Each
+ * bucket keeps the minimum vruntime and slice of its entities so that
+ * pick_eevdf() can skip buckets without eligible entities.
+ */
+#define CFS_NR_BUCKETS		64
+#define CFS_BUCKET_SHIFT	18
+
+struct cfs_bucket {
+	struct list_head	entities;
+	u64			min_vruntime;
+	u64			min_slice;
+};
+
+struct cfs_buckets {
+	u64			base;
+	u64			min_vruntime;
+	u64			min_slice;
+	unsigned int		head;
+	unsigned int		nr;
+	DECLARE_BITMAP(occupied, CFS_NR_BUCKETS);
+	struct cfs_bucket	bucket[CFS_NR_BUCKETS];
+};
+#endif
+
 /* CFS-related fields in a runqueue */
 struct cfs_rq {
 	struct load_weight	load;
@@ -659,6 +688,9 @@ struct cfs_rq {
 #endif
 
 	struct rb_root_cached	tasks_timeline;
+#ifdef CONFIG_SCHED_EEVDF_BUCKETS
+	struct cfs_buckets	buckets;
+#endif
 
 	/*
 	 * 'curr' points to currently running entity on this cfs_rq.
@@ -3132,6 +3164,7 @@ DEFINE_LOCK_GUARD_2(double_rq_lock, struct rq,
 		    double_rq_unlock(_T->lock, _T->lock2))
 
 extern struct sched_entity *__pick_root_entity(struct cfs_rq *cfs_rq);
+extern bool __pick_min_vruntime(struct cfs_rq *cfs_rq, u64 *vruntime);
 extern struct sched_entity *__pick_first_entity(struct cfs_rq *cfs_rq);
 extern struct sched_entity *__pick_last_entity(struct cfs_rq *cfs_rq);
 
@@ -10,6 +10,11 @@ extern bool call_function_single_prep_ipi(int cpu);
 
 #ifdef CONFIG_SMP
 extern void flush_smp_call_function_queue(void);
+extern void smp_call_batch_begin(u64 max_delay);
+extern bool smp_call_batch_queue(int cpu, struct llist_node *node);
+extern void smp_call_batch_end(void);
 #else
 static inline void flush_smp_call_function_queue(void) { }
+static inline void smp_call_batch_begin(u64 max_delay) { }
+static inline void smp_call_batch_end(void) { }
 #endif
@@ -1674,6 +1674,7 @@ sd_init(struct sched_domain_topology_level *tl,
 		.balance_interval	= sd_weight,
 		.max_newidle_lb_cost	= 0,
 		.last_decay_max_lb_cost	= jiffies,
+		.newidle_ratio		= 1024,
 		.child			= child,
 		.name			= tl->name,
 	};
@@ -26,6 +26,9 @@
 #include <linux/sched/debug.h>
 #include <linux/jump_label.h>
 #include <linux/string_choices.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/hash.h>
 
 #include <trace/events/ipi.h>
 #define CREATE_TRACE_POINTS
@@ -41,8 +44,23 @@ struct call_function_data {
 	call_single_data_t	__percpu *csd;
 	cpumask_var_t		cpumask;
 	cpumask_var_t		cpumask_ipi;
+	cpumask_var_t		cpumask_batch;
 };
 
+/*
+ * Remote wakeups queued between smp_call_batch_begin() and
+ * smp_call_batch_end() only mark their target in cfd->cpumask_batch; the
+ * IPIs go out together when the batch ends or is older than @max_delay.
+ */
+struct smp_call_batch {
+	bool			active;
+	unsigned int		nr;
+	u64			start;
+	u64			max_delay;
+};
+
+static DEFINE_PER_CPU(struct smp_call_batch, call_batch);
+
 static DEFINE_PER_CPU_ALIGNED(struct call_function_data, cfd_data);
 
 static DEFINE_PER_CPU_SHARED_ALIGNED(struct llist_head, call_single_queue);
@@ -63,10 +81,17 @@ int smpcfd_prepare_cpu(unsigned int cpu)
 		free_cpumask_var(cfd->cpumask);
 		return -ENOMEM;
 	}
+	if (!zalloc_cpumask_var_node(&cfd->cpumask_batch, GFP_KERNEL,
+				     cpu_to_node(cpu))) {
+		free_cpumask_var(cfd->cpumask);
+		free_cpumask_var(cfd->cpumask_ipi);
+		return -ENOMEM;
+	}
 	cfd->csd = alloc_percpu(call_single_data_t);
 	if (!cfd->csd) {
 		free_cpumask_var(cfd->cpumask);
 		free_cpumask_var(cfd->cpumask_ipi);
+		free_cpumask_var(cfd->cpumask_batch);
 		return -ENOMEM;
 	}
 
@@ -79,6 +104,7 @@ int smpcfd_dead_cpu(unsigned int cpu)
 
 	free_cpumask_var(cfd->cpumask);
 	free_cpumask_var(cfd->cpumask_ipi);
+	free_cpumask_var(cfd->cpumask_batch);
 	free_percpu(cfd->csd);
 	return 0;
 }
@@ -373,6 +399,227 @@ static __always_inline void csd_unlock(call_single_data_t *csd)
 	smp_store_release(&csd->node.u_flags, 0);
 }
 
+/*
+ * Coalescing of smp_call_function_many() requests: when an asynchronous
+ * request with the same func/info pair sent by this CPU is still queued
+ * on a target, that pending csd will run after the new request was made
+ * and the target does not need to be IPIed again.
+ */
+static DEFINE_STATIC_KEY_FALSE(csd_coalesce_enabled);
+
+static int __init csd_coalesce(char *str)
+{
+	bool val;
+
+	if (!kstrtobool(str, &val) && val)
+		static_branch_enable(&csd_coalesce_enabled);
+	return 1;
+}
+__setup("csd_coalesce=", csd_coalesce);
+
+static __always_inline bool csd_coalesce_pending(call_single_data_t *csd,
+						 smp_call_func_t func, void *info)
+{
+	unsigned int flags;
+
+	if (!static_branch_unlikely(&csd_coalesce_enabled))
+		return false;
+
+	/*
+	 * Order the caller's stores before the check of the lock bit. Pairs
+	 * with the smp_mb() between csd_unlock() and the callback in
+	 * __flush_smp_call_function_queue(): either the target still sees
+	 * the lock bit clear after our stores, or it reads them in @func.
+	 */
+	smp_mb();
+	flags = READ_ONCE(csd->node.u_flags);
+	return (flags & CSD_FLAG_LOCK) &&
+	       (flags & CSD_FLAG_TYPE_MASK) == CSD_TYPE_ASYNC &&
+	       csd->func == func && csd->info == info;
+}
+
+#ifdef CONFIG_CSD_STATS
+
+#define CSD_STATS_BITS		8
+#define CSD_STATS_PROBES	8
+#define CSD_STATS_LAT_BUCKETS	16	/* log2 microseconds */
+#define CSD_STATS_FAN_BUCKETS	12	/* log2 targets */
+
+/*
+ * Cross-CPU call statistics keyed by calling site and callback. Entries
+ * are looked up locklessly and only inserted under csd_stats_lock; the
+ * table is reset whenever statistics are (re)enabled.
+ */
+struct csd_callsite {
+	unsigned long	caller;
+	smp_call_func_t	func;
+	int		used;
+	atomic_long_t	nr_calls;
+	atomic_long_t	nr_targets;
+	atomic_long_t	nr_coalesced;
+	atomic_long_t	fanout[CSD_STATS_FAN_BUCKETS];
+	atomic_long_t	wait_us[CSD_STATS_LAT_BUCKETS];
+};
+
+static DEFINE_STATIC_KEY_FALSE(csd_stats_enabled);
+static DEFINE_RAW_SPINLOCK(csd_stats_lock);
+static struct csd_callsite csd_stats[1 << CSD_STATS_BITS];
+static atomic_long_t csd_stats_dropped;
+
+static struct csd_callsite *csd_stats_get(unsigned long caller, smp_call_func_t func)
+{
+	unsigned long flags, h;
+	struct csd_callsite *cs;
+	int i;
+
+	h = hash_long(caller ^ (unsigned long)func, CSD_STATS_BITS);
+	for (i = 0; i < CSD_STATS_PROBES; i++) {
+		cs = &csd_stats[(h + i) & ((1 << CSD_STATS_BITS) - 1)];
+		if (!smp_load_acquire(&cs->used))
+			break;
+		if (cs->caller == caller && cs->func == func)
+			return cs;
+	}
+
+	raw_spin_lock_irqsave(&csd_stats_lock, flags);
+	for (i = 0; i < CSD_STATS_PROBES; i++) {
+		cs = &csd_stats[(h + i) & ((1 << CSD_STATS_BITS) - 1)];
+		if (!cs->used) {
+			cs->caller = caller;
+			cs->func = func;
+			smp_store_release(&cs->used, 1);
+			break;
+		}
+		if (cs->caller == caller && cs->func == func)
+			break;
+	}
+	raw_spin_unlock_irqrestore(&csd_stats_lock, flags);
+
+	return i < CSD_STATS_PROBES ? cs : NULL;
+}
+
+static __always_inline bool csd_stats_active(void)
+{
+	return static_branch_unlikely(&csd_stats_enabled);
+}
+
+static void csd_stats_record(unsigned long caller, smp_call_func_t func,
+			     unsigned int nr_targets, unsigned int nr_coalesced,
+			     u64 wait_ns)
+{
+	struct csd_callsite *cs = csd_stats_get(caller, func);
+
+	if (!cs) {
+		atomic_long_inc(&csd_stats_dropped);
+		return;
+	}
+
+	atomic_long_inc(&cs->nr_calls);
+	atomic_long_add(nr_targets, &cs->nr_targets);
+	if (nr_coalesced)
+		atomic_long_add(nr_coalesced, &cs->nr_coalesced);
+	if (nr_targets)
+		atomic_long_inc(&cs->fanout[min(ilog2(nr_targets),
+						 CSD_STATS_FAN_BUCKETS - 1)]);
+	if (wait_ns) {
+		u64 us = div_u64(wait_ns, NSEC_PER_USEC);
+
+		atomic_long_inc(&cs->wait_us[us ? min(ilog2(us) + 1,
+						      CSD_STATS_LAT_BUCKETS - 1) : 0]);
+	}
+}
+
+static int csd_stats_show(struct seq_file *m, void *v)
+{
+	struct csd_callsite *cs;
+	int i, b;
+
+	seq_printf(m, "enabled: %d dropped: %ld\n", csd_stats_active(),
+		   atomic_long_read(&csd_stats_dropped));
+
+	for (i = 0; i < ARRAY_SIZE(csd_stats); i++) {
+		cs = &csd_stats[i];
+		if (!smp_load_acquire(&cs->used))
+			continue;
+
+		seq_printf(m, "%pS %ps calls: %ld targets: %ld coalesced: %ld\n",
+			   (void *)cs->caller, cs->func,
+			   atomic_long_read(&cs->nr_calls),
+			   atomic_long_read(&cs->nr_targets),
+			   atomic_long_read(&cs->nr_coalesced));
+		seq_puts(m, "  fanout:");
+		for (b = 0; b < CSD_STATS_FAN_BUCKETS; b++)
+			seq_printf(m, " %ld", atomic_long_read(&cs->fanout[b]));
+		seq_puts(m, "\n  wait_us:");
+		for (b = 0; b < CSD_STATS_LAT_BUCKETS; b++)
+			seq_printf(m, " %ld", atomic_long_read(&cs->wait_us[b]));
+		seq_putc(m, '\n');
+	}
+	return 0;
+}
+
+static int csd_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, csd_stats_show, NULL);
+}
+
+/*
+ * Writing 1 clears the table and starts collecting, writing 0 stops.
+ * Recording runs with preemption disabled, so synchronize_rcu() waits
+ * out any recorder which still saw the key enabled.
+ */
+static ssize_t csd_stats_write(struct file *file, const char __user *ubuf,
+			       size_t count, loff_t *ppos)
+{
+	static DEFINE_MUTEX(csd_stats_mutex);
+	bool val;
+	int ret;
+
+	ret = kstrtobool_from_user(ubuf, count, &val);
+	if (ret)
+		return ret;
+
+	mutex_lock(&csd_stats_mutex);
+	static_branch_disable(&csd_stats_enabled);
+	if (val) {
+		synchronize_rcu();
+		memset(csd_stats, 0, sizeof(csd_stats));
+		atomic_long_set(&csd_stats_dropped, 0);
+		static_branch_enable(&csd_stats_enabled);
+	}
+	mutex_unlock(&csd_stats_mutex);
+
+	return count;
+}
+
+static const struct file_operations csd_stats_fops = {
+	.open		= csd_stats_open,
+	.read		= seq_read,
+	.write		= csd_stats_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init csd_stats_init(void)
+{
+	debugfs_create_file("csd_stats", 0644, NULL, NULL, &csd_stats_fops);
+	return 0;
+}
+late_initcall(csd_stats_init);
+
+#else /* !CONFIG_CSD_STATS */
+
+static __always_inline bool csd_stats_active(void)
+{
+	return false;
+}
+
+static inline void csd_stats_record(unsigned long caller, smp_call_func_t func,
+				    unsigned int nr_targets, unsigned int nr_coalesced,
+				    u64 wait_ns) { }
+
+#endif /* CONFIG_CSD_STATS */
+
 static DEFINE_PER_CPU_SHARED_ALIGNED(call_single_data_t, csd_data);
 
 void __smp_call_single_queue(int cpu, struct llist_node *node)
@@ -411,6 +658,98 @@ void __smp_call_single_queue(int cpu, struct llist_node *node)
 		send_call_function_single_ipi(cpu);
 }
 
+/**
+ * smp_call_batch_begin - start deferring wakeup IPIs from this CPU
+ * @max_delay: upper bound in nanoseconds on how long an IPI is held back
+ *
+ * Must be called with preemption disabled and paired with
+ * smp_call_batch_end() before preemption is enabled again.
+ */
+void smp_call_batch_begin(u64 max_delay)
+{
+	struct smp_call_batch *batch = this_cpu_ptr(&call_batch);
+
+	lockdep_assert_preemption_disabled();
+	WARN_ON_ONCE(batch->active);
+
+	batch->nr = 0;
+	batch->start = local_clock();
+	batch->max_delay = max_delay;
+	batch->active = true;
+}
+
+static void smp_call_batch_flush(struct smp_call_batch *batch)
+{
+	struct cpumask *mask = this_cpu_ptr(&cfd_data)->cpumask_batch;
+	unsigned int cpu, last_cpu = nr_cpu_ids, nr_cpus = 0;
+
+	if (!batch->nr)
+		return;
+
+	for_each_cpu(cpu, mask) {
+		if (!call_function_single_prep_ipi(cpu)) {
+			cpumask_clear_cpu(cpu, mask);
+			continue;
+		}
+		last_cpu = cpu;
+		nr_cpus++;
+	}
+
+	if (nr_cpus == 1)
+		send_call_function_single_ipi(last_cpu);
+	else if (nr_cpus > 1)
+		send_call_function_ipi_mask(mask);
+
+	cpumask_clear(mask);
+	batch->nr = 0;
+	batch->start = local_clock();
+}
+
+/**
+ * smp_call_batch_queue - queue a wakeup in the current batch, if any
+ * @cpu: the target CPU
+ * @node: the wakeup's llist node
+ *
+ * Like __smp_call_single_queue(), but leaves the IPI to the end of the
+ * batch. Returns false without queueing when no batch is active, or when
+ * called from interrupt context, which never joins the task's batch.
+ */
+bool smp_call_batch_queue(int cpu, struct llist_node *node)
+{
+	struct smp_call_batch *batch = this_cpu_ptr(&call_batch);
+
+	if (!batch->active || !in_task())
+		return false;
+
+	if (trace_csd_queue_cpu_enabled()) {
+		call_single_data_t *csd;
+
+		csd = container_of(node, call_single_data_t, node.llist);
+		trace_csd_queue_cpu(cpu, _RET_IP_, sched_ttwu_pending, csd);
+	}
+
+	if (llist_add(node, &per_cpu(call_single_queue, cpu))) {
+		cpumask_set_cpu(cpu, this_cpu_ptr(&cfd_data)->cpumask_batch);
+		batch->nr++;
+	}
+
+	if (batch->nr && local_clock() - batch->start >= batch->max_delay)
+		smp_call_batch_flush(batch);
+
+	return true;
+}
+
+/**
+ * smp_call_batch_end - send the IPIs deferred since smp_call_batch_begin()
+ */
+void smp_call_batch_end(void)
+{
+	struct smp_call_batch *batch = this_cpu_ptr(&call_batch);
+
+	smp_call_batch_flush(batch);
+	batch->active = false;
+}
+
 /*
  * Insert a previously allocated call_single_data_t element
  * for execution on the given CPU. data must already have
@@ -568,6 +907,9 @@ static void __flush_smp_call_function_queue(bool warn_cpu_offline)
 
 				csd_lock_record(csd);
 				csd_unlock(csd);
+				/* Pairs with csd_coalesce_pending() */
+				if (static_branch_unlikely(&csd_coalesce_enabled))
+					smp_mb();
 				csd_do_func(func, info, csd);
 				csd_lock_record(NULL);
 			} else if (type == CSD_TYPE_IRQ_WORK) {
@@ -634,6 +976,7 @@ int smp_call_function_single(int cpu, smp_call_func_t func, void *info,
 	call_single_data_t csd_stack = {
 		.node = { .u_flags = CSD_FLAG_LOCK | CSD_TYPE_SYNC, },
 	};
+	u64 start = 0;
 	int this_cpu;
 	int err;
 
@@ -673,11 +1016,18 @@ int smp_call_function_single(int cpu, smp_call_func_t func, void *info,
 	csd->node.dst = cpu;
 #endif
 
+	if (csd_stats_active())
+		start = local_clock();
+
 	err = generic_exec_single(cpu, csd);
 
 	if (wait)
 		csd_lock_wait(csd);
 
+	if (csd_stats_active() && start && !err && cpu != this_cpu)
+		csd_stats_record(_RET_IP_, func, 1, 0,
+				 wait ? local_clock() - start : 0);
+
 	put_cpu();
 
 	return err;
@@ -785,11 +1135,14 @@ EXPORT_SYMBOL_GPL(smp_call_function_any);
 static void smp_call_function_many_cond(const struct cpumask *mask,
 					smp_call_func_t func, void *info,
 					unsigned int scf_flags,
-					smp_cond_func_t cond_func)
+					smp_cond_func_t cond_func,
+					unsigned long caller)
 {
 	int cpu, last_cpu, this_cpu = smp_processor_id();
 	struct call_function_data *cfd;
 	bool wait = scf_flags & SCF_WAIT;
+	unsigned int nr_targets = 0, nr_coalesced = 0;
+	u64 start = 0;
 	int nr_cpus = 0;
 	bool run_remote = false;
 	bool run_local = false;
@@ -827,6 +1180,9 @@ static void smp_call_function_many_cond(const struct cpumask *mask,
 		run_remote = true;
 
 	if (run_remote) {
+		if (csd_stats_active())
+			start = local_clock();
+
 		cfd = this_cpu_ptr(&cfd_data);
 		cpumask_and(cfd->cpumask, mask, cpu_online_mask);
 		__cpumask_clear_cpu(this_cpu, cfd->cpumask);
@@ -840,6 +1196,13 @@ static void smp_call_function_many_cond(const struct cpumask *mask,
 				continue;
 			}
 
+			nr_targets++;
+			if (!wait && csd_coalesce_pending(csd, func, info)) {
+				__cpumask_clear_cpu(cpu, cfd->cpumask);
+				nr_coalesced++;
+				continue;
+			}
+
 			csd_lock(csd);
 			if (wait)
 				csd->node.u_flags |= CSD_TYPE_SYNC;
@@ -885,6 +1248,10 @@ static void smp_call_function_many_cond(const struct cpumask *mask,
 			csd_lock_wait(csd);
 		}
 	}
+
+	if (run_remote && csd_stats_active() && start)
+		csd_stats_record(caller, func, nr_targets, nr_coalesced,
+				 wait ? local_clock() - start : 0);
 }
 
 /**
@@ -906,7 +1273,8 @@ static void smp_call_function_many_cond(const struct cpumask *mask,
 void smp_call_function_many(const struct cpumask *mask,
 			    smp_call_func_t func, void *info, bool wait)
 {
-	smp_call_function_many_cond(mask, func, info, wait * SCF_WAIT, NULL);
+	smp_call_function_many_cond(mask, func, info, wait * SCF_WAIT, NULL,
+				    _RET_IP_);
 }
 EXPORT_SYMBOL(smp_call_function_many);
 
@@ -928,7 +1296,8 @@ EXPORT_SYMBOL(smp_call_function_many);
 void smp_call_function(smp_call_func_t func, void *info, int wait)
 {
 	preempt_disable();
-	smp_call_function_many(cpu_online_mask, func, info, wait);
+	smp_call_function_many_cond(cpu_online_mask, func, info,
+				    wait ? SCF_WAIT : 0, NULL, _RET_IP_);
 	preempt_enable();
 }
 EXPORT_SYMBOL(smp_call_function);
@@ -1049,7 +1418,8 @@ void on_each_cpu_cond_mask(smp_cond_func_t cond_func, smp_call_func_t func,
 		scf_flags |= SCF_WAIT;
 
 	preempt_disable();
-	smp_call_function_many_cond(mask, func, info, scf_flags, cond_func);
+	smp_call_function_many_cond(mask, func, info, scf_flags, cond_func,
+				    _RET_IP_);
 	preempt_enable();
 }
 EXPORT_SYMBOL(on_each_cpu_cond_mask);
@@ -2824,6 +2824,30 @@ SYSCALL_DEFINE5(prctl, int, option, unsigned long, arg2, unsigned long, arg3,
 	case PR_FUTEX_HASH:
 		error = futex_hash_prctl(arg2, arg3, arg4);
 		break;
+	case PR_SET_ANON_FAULT_AROUND:
+		if (arg3 || arg4 || arg5)
+			return -EINVAL;
+		if (arg2 > PTRS_PER_PTE || (arg2 && !is_power_of_2(arg2)))
+			return -EINVAL;
+		WRITE_ONCE(me->mm->anon_fault_around_pages, arg2);
+		break;
+	case PR_GET_ANON_FAULT_AROUND:
+		if (arg2 || arg3 || arg4 || arg5)
+			return -EINVAL;
+		error = READ_ONCE(me->mm->anon_fault_around_pages);
+		break;
+	case PR_SET_FORK_COPY_THREADS:
+		if (arg3 || arg4 || arg5)
+			return -EINVAL;
+		if (arg2 > nr_cpu_ids)
+			return -EINVAL;
+		WRITE_ONCE(me->mm->fork_copy_threads, arg2);
+		break;
+	case PR_GET_FORK_COPY_THREADS:
+		if (arg2 || arg3 || arg4 || arg5)
+			return -EINVAL;
+		error = READ_ONCE(me->mm->fork_copy_threads);
+		break;
 	default:
 		trace_task_prctl_unknown(option, arg2, arg3, arg4, arg5);
 		error = -EINVAL;
@@ -1333,6 +1333,48 @@ void hrtimer_start_range_ns(struct hrtimer *timer, ktime_t tim,
 }
 EXPORT_SYMBOL_GPL(hrtimer_start_range_ns);
 
+/**
+ * hrtimer_start_coalesced - (re)start an hrtimer in a shared slack bucket
+ * @timer:	the timer to be added
+ * @tim:	expiry time
+ * @slack_ns:	slack the caller accepts past @tim
+ * @mode:	timer mode, as for hrtimer_start_range_ns()
+ *
+ * Like hrtimer_start_range_ns(), but the hard expiry is not simply
+ * @tim + @slack_ns: it is rounded down to a multiple of the largest power
+ * of two not above @slack_ns. Timers armed with nearby expiry times and
+ * similar slack thereby share their hard expiry time, so that one clock
+ * event expires all of them in __hrtimer_run_queues() instead of each
+ * programming its own interrupt. The timer never expires before @tim.
+ */
+void hrtimer_start_coalesced(struct hrtimer *timer, ktime_t tim,
+			     u64 slack_ns, const enum hrtimer_mode mode)
+{
+	enum hrtimer_mode amode = mode;
+	ktime_t hard;
+	u64 gran;
+
+	if (!slack_ns) {
+		hrtimer_start_range_ns(timer, tim, 0, mode);
+		return;
+	}
+
+	/* Bucket boundaries are absolute times. */
+	if (mode & HRTIMER_MODE_REL) {
+		tim = ktime_add_safe(tim, hrtimer_cb_get_time(timer));
+		amode = mode & ~HRTIMER_MODE_REL;
+	}
+
+	hard = ktime_add_safe(tim, ns_to_ktime(min_t(u64, slack_ns, KTIME_MAX)));
+	if (hard != KTIME_MAX) {
+		gran = 1ULL << (fls64(slack_ns) - 1);
+		hard = round_down(hard, (ktime_t)gran);
+	}
+
+	hrtimer_start_range_ns(timer, tim, hard - tim, amode);
+}
+EXPORT_SYMBOL_GPL(hrtimer_start_coalesced);
+
 /**
  * hrtimer_try_to_cancel - try to deactivate a timer
  * @timer:	hrtimer to stop
@@ -8034,6 +8034,7 @@ __ftrace_ops_list_func(unsigned long ip, unsigned long parent_ip,
 {
 	struct pt_regs *regs = ftrace_get_regs(fregs);
 	struct ftrace_ops *op;
+	bool rcu_watching;
 	int bit;
 
 	/*
@@ -8045,6 +8046,9 @@ __ftrace_ops_list_func(unsigned long ip, unsigned long parent_ip,
 	if (bit < 0)
 		return;
 
+	/* This can't change while walking the list, test it only once */
+	rcu_watching = rcu_is_watching();
+
 	do_for_each_ftrace_op(op, ftrace_ops_list) {
 		/* Stub functions don't need to be called nor tested */
 		if (op->flags & FTRACE_OPS_FL_STUB)
@@ -8056,7 +8060,7 @@ __ftrace_ops_list_func(unsigned long ip, unsigned long parent_ip,
 		 *
 		 * If any of the above fails then the op->func() is not executed.
 		 */
-		if ((!(op->flags & FTRACE_OPS_FL_RCU) || rcu_is_watching()) &&
+		if ((!(op->flags & FTRACE_OPS_FL_RCU) || rcu_watching) &&
 		    ftrace_ops_test(op, ip, regs)) {
 			if (FTRACE_WARN_ON(!op->func)) {
 				pr_warn("op=%p %pS\n", op, op);
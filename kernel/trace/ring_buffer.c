@@ -3642,6 +3642,17 @@ static void rb_add_timestamp(struct ring_buffer_per_cpu *cpu_buffer,
 	*delta = 0;
 }
 
+/* Encode the size @length of a data @event, header included, in its header */
+static void rb_event_set_length(struct ring_buffer_event *event, unsigned length)
+{
+	length -= RB_EVNT_HDR_SIZE;
+	if (length > RB_MAX_SMALL_DATA || RB_FORCE_8BYTE_ALIGNMENT) {
+		event->type_len = 0;
+		event->array[0] = length;
+	} else
+		event->type_len = DIV_ROUND_UP(length, RB_ALIGNMENT);
+}
+
 /**
  * rb_update_event - update event type and data
  * @cpu_buffer: The per cpu buffer of the @event
@@ -3673,12 +3684,7 @@ rb_update_event(struct ring_buffer_per_cpu *cpu_buffer,
 		rb_add_timestamp(cpu_buffer, &event, info, &delta, &length);
 
 	event->time_delta = delta;
-	length -= RB_EVNT_HDR_SIZE;
-	if (length > RB_MAX_SMALL_DATA || RB_FORCE_8BYTE_ALIGNMENT) {
-		event->type_len = 0;
-		event->array[0] = length;
-	} else
-		event->type_len = DIV_ROUND_UP(length, RB_ALIGNMENT);
+	rb_event_set_length(event, length);
 }
 
 static unsigned rb_calculate_event_length(unsigned length)
@@ -4603,14 +4609,14 @@ ring_buffer_lock_reserve(struct trace_buffer *buffer, unsigned long length)
 EXPORT_SYMBOL_GPL(ring_buffer_lock_reserve);
 
 /*
- * Decrement the entries to the page that an event is on.
+ * Add @nr to the entries of the page that an event is on.
  * The event does not even need to exist, only the pointer
  * to the page it is on. This may only be called before the commit
  * takes place.
  */
-static inline void
-rb_decrement_entry(struct ring_buffer_per_cpu *cpu_buffer,
-		   struct ring_buffer_event *event)
+static void
+rb_add_page_entries(struct ring_buffer_per_cpu *cpu_buffer,
+		    struct ring_buffer_event *event, long nr)
 {
 	unsigned long addr = (unsigned long)event;
 	struct buffer_page *bpage = cpu_buffer->commit_page;
@@ -4620,7 +4626,7 @@ rb_decrement_entry(struct ring_buffer_per_cpu *cpu_buffer,
 
 	/* Do the likely case first */
 	if (likely(bpage->page == (void *)addr)) {
-		local_dec(&bpage->entries);
+		local_add(nr, &bpage->entries);
 		return;
 	}
 
@@ -4632,7 +4638,7 @@ rb_decrement_entry(struct ring_buffer_per_cpu *cpu_buffer,
 	start = bpage;
 	do {
 		if (bpage->page == (void *)addr) {
-			local_dec(&bpage->entries);
+			local_add(nr, &bpage->entries);
 			return;
 		}
 		rb_inc_page(&bpage);
@@ -4642,6 +4648,13 @@ rb_decrement_entry(struct ring_buffer_per_cpu *cpu_buffer,
 	RB_WARN_ON(cpu_buffer, 1);
 }
 
+static inline void
+rb_decrement_entry(struct ring_buffer_per_cpu *cpu_buffer,
+		   struct ring_buffer_event *event)
+{
+	rb_add_page_entries(cpu_buffer, event, -1);
+}
+
 /**
  * ring_buffer_discard_commit - discard an event that has not been committed
  * @buffer: the ring buffer
@@ -4707,10 +4720,86 @@ EXPORT_SYMBOL_GPL(ring_buffer_discard_commit);
 int ring_buffer_write(struct trace_buffer *buffer,
 		      unsigned long length,
 		      void *data)
+{
+	return ring_buffer_write_batch(buffer, 1, length, data) == 1 ? 0 : -EBUSY;
+}
+EXPORT_SYMBOL_GPL(ring_buffer_write);
+
+/*
+ * How many of @nr events of @length data bytes ring_buffer_write_batch()
+ * reserves at once, and the data length @chunk of the single event that
+ * holds them. Bounded to an eighth of a sub-buffer, so that a chunk that
+ * does not fit the tail page wastes little of it as padding.
+ */
+static unsigned int rb_batch_events(struct trace_buffer *buffer,
+				    unsigned int nr, unsigned long length,
+				    unsigned long *chunk)
+{
+	unsigned int size = rb_calculate_event_length(length);
+	unsigned int n, total;
+
+	n = min3(nr, (buffer->subbuf_size / 8) / size,
+		 (unsigned int)(buffer->max_data_size / size));
+	if (n > 1) {
+		total = n * size;
+		*chunk = total - RB_EVNT_HDR_SIZE;
+		if (*chunk > RB_MAX_SMALL_DATA || RB_FORCE_8BYTE_ALIGNMENT)
+			*chunk -= sizeof(u32);
+		/* The chunk must be exactly n slots, or readers get lost */
+		if (rb_calculate_event_length(*chunk) == total)
+			return n;
+	}
+
+	*chunk = length;
+	return 1;
+}
+
+/*
+ * Carve the freshly reserved @event into @nr events of @length data bytes.
+ * The first keeps the reserved event's time delta, the others get zero.
+ */
+static void rb_batch_split(struct ring_buffer_event *event, unsigned int nr,
+			   unsigned long length, const void *data)
+{
+	unsigned int size = rb_calculate_event_length(length);
+	unsigned int i;
+
+	if (extended_time(event))
+		event = skip_time_extend(event);
+
+	for (i = 0; i < nr; i++) {
+		if (i)
+			event->time_delta = 0;
+		rb_event_set_length(event, size);
+		memcpy(rb_event_data(event), data + i * length, length);
+		event = (void *)event + size;
+	}
+}
+
+/**
+ * ring_buffer_write_batch - write several events to the buffer in one go
+ * @buffer: The ring buffer to write to.
+ * @nr: The number of events to write.
+ * @length: The length of the data of each event (excluding the event header)
+ * @data: @nr times @length bytes of event data, back to back.
+ *
+ * Like calling ring_buffer_write() @nr times, except that preemption,
+ * the recording checks, the recursion protection and the reader wakeup
+ * are only dealt with once for the whole batch. The events are reserved
+ * in chunks of up to an eighth of a sub-buffer: each chunk takes a single
+ * reservation and timestamp, and all but its first event are encoded with
+ * a zero time delta, so they share the first event's timestamp.
+ *
+ * Returns the number of events written, which is less than @nr if the
+ * buffer filled up, or -EBUSY if none could be written.
+ */
+int ring_buffer_write_batch(struct trace_buffer *buffer, unsigned int nr,
+			    unsigned long length, const void *data)
 {
 	struct ring_buffer_per_cpu *cpu_buffer;
 	struct ring_buffer_event *event;
-	void *body;
+	unsigned long chunk;
+	unsigned int i, n;
 	int ret = -EBUSY;
 	int cpu;
 
@@ -4735,21 +4824,28 @@ int ring_buffer_write(struct trace_buffer *buffer,
 	if (unlikely(trace_recursive_lock(cpu_buffer)))
 		goto out;
 
-	event = rb_reserve_next_event(buffer, cpu_buffer, length);
-	if (!event)
-		goto out_unlock;
-
-	body = rb_event_data(event);
-
-	memcpy(body, data, length);
+	for (i = 0; i < nr; i += n) {
+		n = rb_batch_events(buffer, nr - i, length, &chunk);
+		event = rb_reserve_next_event(buffer, cpu_buffer, chunk);
+		if (!event)
+			break;
 
-	rb_commit(cpu_buffer);
+		if (n > 1) {
+			rb_batch_split(event, n, length, data + i * length);
+			rb_add_page_entries(cpu_buffer, event, n - 1);
+			local_add(n - 1, &cpu_buffer->entries);
+		} else {
+			memcpy(rb_event_data(event), data + i * length, length);
+		}
 
-	rb_wakeups(buffer, cpu_buffer);
+		rb_commit(cpu_buffer);
+	}
 
-	ret = 0;
+	if (i) {
+		rb_wakeups(buffer, cpu_buffer);
+		ret = i;
+	}
 
- out_unlock:
 	trace_recursive_unlock(cpu_buffer);
 
  out:
@@ -4757,7 +4853,7 @@ int ring_buffer_write(struct trace_buffer *buffer,
 
 	return ret;
 }
-EXPORT_SYMBOL_GPL(ring_buffer_write);
+EXPORT_SYMBOL_GPL(ring_buffer_write_batch);
 
 /*
  * The total entries in the ring buffer is the running counter
@@ -10,6 +10,7 @@
 #include <uapi/linux/sched/types.h>
 #include <linux/module.h>
 #include <linux/ktime.h>
+#include <linux/unaligned.h>
 #include <asm/local.h>
 
 struct rb_page {
@@ -42,6 +43,14 @@ static unsigned int write_iteration = 50;
 module_param(write_iteration, uint, 0644);
 MODULE_PARM_DESC(write_iteration, "# of writes between timestamp readings");
 
+/* size of the events written by the producer */
+#define EVENT_SIZE	10
+#define MAX_WRITE_BATCH	64
+
+static unsigned int write_batch;
+module_param(write_batch, uint, 0644);
+MODULE_PARM_DESC(write_batch, "# of events per ring_buffer_write_batch() call, 0 to reserve them one by one");
+
 static int producer_nice = MAX_NICE;
 static int consumer_nice = MAX_NICE;
 
@@ -229,6 +238,23 @@ static void ring_buffer_consumer(void)
 	complete(&read_done);
 }
 
+/* Write @nr events with ring_buffer_write_batch(), returns how many made it */
+static unsigned int ring_buffer_producer_batch(unsigned int nr)
+{
+	static char data[MAX_WRITE_BATCH][EVENT_SIZE];
+	unsigned int i;
+	int ret;
+
+	/* the consumer checks that each event was written on its CPU */
+	preempt_disable();
+	for (i = 0; i < nr; i++)
+		put_unaligned(smp_processor_id(), (int *)data[i]);
+	ret = ring_buffer_write_batch(buffer, nr, EVENT_SIZE, data);
+	preempt_enable();
+
+	return ret < 0 ? 0 : ret;
+}
+
 static void ring_buffer_producer(void)
 {
 	ktime_t start_time, end_time, timeout;
@@ -238,12 +264,14 @@ static void ring_buffer_producer(void)
 	unsigned long missed = 0;
 	unsigned long hit = 0;
 	unsigned long avg;
+	unsigned int batch;
 	int cnt = 0;
 
 	/*
 	 * Hammer the buffer for 10 secs (this may
 	 * make the system stall)
 	 */
+	batch = min(write_batch, MAX_WRITE_BATCH);
 	trace_printk("Starting ring buffer hammer\n");
 	start_time = ktime_get();
 	timeout = ktime_add_ns(start_time, RUN_TIME * NSEC_PER_SEC);
@@ -252,8 +280,17 @@ static void ring_buffer_producer(void)
 		int *entry;
 		int i;
 
-		for (i = 0; i < write_iteration; i++) {
-			event = ring_buffer_lock_reserve(buffer, 10);
+		for (i = 0; batch && i < write_iteration; i += batch) {
+			unsigned int nr = min(write_iteration - i, batch);
+			unsigned int written;
+
+			written = ring_buffer_producer_batch(nr);
+			hit += written;
+			missed += nr - written;
+		}
+
+		for (i = 0; !batch && i < write_iteration; i++) {
+			event = ring_buffer_lock_reserve(buffer, EVENT_SIZE);
 			if (!event) {
 				missed++;
 			} else {
@@ -324,6 +361,9 @@ static void ring_buffer_producer(void)
 	    producer_nice == MAX_NICE && consumer_nice == MAX_NICE)
 		trace_printk("WARNING!!! This test is running at lowest priority.\n");
 
+	if (batch)
+		trace_printk("Writing in batches of %u events\n", batch);
+
 	trace_printk("Time:     %lld (usecs)\n", time);
 	trace_printk("Overruns: %lld\n", overruns);
 	if (disable_reader)
@@ -16,6 +16,8 @@
 #include <linux/slab.h>
 #include <linux/sort.h>
 #include <linux/kmemleak.h>
+#include <linux/percpu.h>
+#include <asm/local64.h>
 
 #include "tracing_map.h"
 #include "trace.h"
@@ -535,7 +537,7 @@ __tracing_map_insert(struct tracing_map *map, void *key, bool lookup_only)
 			if (val &&
 			    keys_match(key, val->key, map->key_size)) {
 				if (!lookup_only)
-					atomic64_inc(&map->hits);
+					local64_inc(this_cpu_ptr(map->hits));
 				return val;
 			} else if (unlikely(!val)) {
 				/*
@@ -552,7 +554,7 @@ __tracing_map_insert(struct tracing_map *map, void *key, bool lookup_only)
 
 				dup_try++;
 				if (dup_try > map->map_size) {
-					atomic64_inc(&map->drops);
+					local64_inc(this_cpu_ptr(map->drops));
 					break;
 				}
 				continue;
@@ -568,7 +570,7 @@ __tracing_map_insert(struct tracing_map *map, void *key, bool lookup_only)
 
 				elt = get_free_elt(map);
 				if (!elt) {
-					atomic64_inc(&map->drops);
+					local64_inc(this_cpu_ptr(map->drops));
 					entry->key = 0;
 					break;
 				}
@@ -580,7 +582,7 @@ __tracing_map_insert(struct tracing_map *map, void *key, bool lookup_only)
 				 */
 				smp_wmb();
 				WRITE_ONCE(entry->val, elt);
-				atomic64_inc(&map->hits);
+				local64_inc(this_cpu_ptr(map->hits));
 
 				return entry->val;
 			} else {
@@ -681,9 +683,51 @@ void tracing_map_destroy(struct tracing_map *map)
 	tracing_map_free_elts(map);
 
 	tracing_map_array_free(map->map);
+	free_percpu(map->hits);
+	free_percpu(map->drops);
 	kfree(map);
 }
 
+/**
+ * tracing_map_read_hits - Return the number of hits of a tracing_map
+ * @map: The tracing_map to read
+ *
+ * Hits are counted per CPU so that concurrent inserts on different
+ * CPUs don't bounce a shared counter; sum them up for the reader.
+ *
+ * Return: The total number of hits recorded since the last clear.
+ */
+u64 tracing_map_read_hits(struct tracing_map *map)
+{
+	u64 hits = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		hits += local64_read(per_cpu_ptr(map->hits, cpu));
+
+	return hits;
+}
+
+/**
+ * tracing_map_read_drops - Return the number of drops of a tracing_map
+ * @map: The tracing_map to read
+ *
+ * Once the map is full every insert drops, so drops are counted per CPU
+ * like hits.
+ *
+ * Return: The total number of drops recorded since the last clear.
+ */
+u64 tracing_map_read_drops(struct tracing_map *map)
+{
+	u64 drops = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		drops += local64_read(per_cpu_ptr(map->drops, cpu));
+
+	return drops;
+}
+
 /**
  * tracing_map_clear - Clear a tracing_map
  * @map: The tracing_map to clear
@@ -698,10 +742,13 @@ void tracing_map_destroy(struct tracing_map *map)
 void tracing_map_clear(struct tracing_map *map)
 {
 	unsigned int i;
+	int cpu;
 
 	atomic_set(&map->next_elt, 0);
-	atomic64_set(&map->hits, 0);
-	atomic64_set(&map->drops, 0);
+	for_each_possible_cpu(cpu) {
+		local64_set(per_cpu_ptr(map->hits, cpu), 0);
+		local64_set(per_cpu_ptr(map->drops, cpu), 0);
+	}
 
 	tracing_map_array_clear(map->map);
 
@@ -790,6 +837,11 @@ struct tracing_map *tracing_map_create(unsigned int map_bits,
 
 	map->private_data = private_data;
 
+	map->hits = alloc_percpu(local64_t);
+	map->drops = alloc_percpu(local64_t);
+	if (!map->hits || !map->drops)
+		goto free;
+
 	map->map = tracing_map_array_alloc(map->map_size,
 					   sizeof(struct tracing_map_entry));
 	if (!map->map)
@@ -55,6 +55,8 @@
 #include <linux/kvm_para.h>
 #include <linux/delay.h>
 #include <linux/irq_work.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 #include "workqueue_internal.h"
 
@@ -223,6 +225,8 @@ struct worker_pool {
 	struct hlist_node	hash_node;	/* PL: unbound_pool_hash node */
 	int			refcnt;		/* PL: refcnt for unbound pools */
 
+	u64			nr_stolen;	/* L: works taken from sibling pods */
+
 	/*
 	 * Destruction of pool is RCU protected to allow dereferences
 	 * from get_work_pool().
@@ -426,6 +430,13 @@ module_param_named(cpu_intensive_warning_thresh, wq_cpu_intensive_warning_thresh
 static bool wq_power_efficient = IS_ENABLED(CONFIG_WQ_POWER_EFFICIENT_DEFAULT);
 module_param_named(power_efficient, wq_power_efficient, bool, 0444);
 
+/*
+ * Let unbound work items spill over to a sibling pod's pool when the pool of
+ * the local pod is saturated. See unbound_steal_pwq().
+ */
+static bool wq_unbound_steal;
+module_param_named(unbound_steal, wq_unbound_steal, bool, 0644);
+
 static bool wq_online;			/* can kworkers be created yet? */
 static bool wq_topo_initialized __read_mostly = false;
 
@@ -2232,10 +2243,100 @@ static int wq_select_unbound_cpu(int cpu)
 	return new_cpu;
 }
 
+/*
+ * Does @pool have fewer busy workers than online CPUs in its pod? Busy
+ * workers include the ones blocked inside a work item, so this is an upper
+ * bound on the CPU demand. Called without @pool->lock; the result is only a
+ * hint.
+ */
+static bool pool_has_capacity(struct worker_pool *pool)
+{
+	int busy = data_race(pool->nr_workers - pool->nr_idle);
+
+	return busy < (int)cpumask_weight_and(pool->attrs->__pod_cpumask,
+					      cpu_online_mask);
+}
+
+/**
+ * unbound_steal_pwq - pick a sibling pwq for an unbound work item
+ * @wq: the target unbound workqueue
+ * @pwq: the pwq of the pod @cpu belongs to
+ * @cpu: the CPU the work item is being queued for
+ *
+ * Unbound work items are queued to the pool of the pod the queueing CPU
+ * belongs to. If that pool already has as many busy workers as its pod has
+ * CPUs while other pods sit idle, burst of work items from e.g. a storage
+ * stack's completion path serialize behind each other on one LLC. When
+ * workqueue.unbound_steal is set, let an idle sibling pod take such work
+ * items over, preferring pods which share the cache, then the NUMA node,
+ * with @cpu.
+ *
+ * The pod type and @wq's attrs are read without wq_pool_mutex. The pod
+ * tables are never freed once initialized and a stale scope only makes the
+ * choice less accurate; the returned pwq is still one of @wq's and is
+ * validated by the caller like any other.
+ *
+ * Return: the pwq to queue to, @pwq if no sibling pod should take over.
+ */
+static struct pool_workqueue *unbound_steal_pwq(struct workqueue_struct *wq,
+						struct pool_workqueue *pwq,
+						int cpu)
+{
+	struct pool_workqueue *best = pwq;
+	const struct wq_pod_type *pt;
+	enum wq_affn_scope scope;
+	int i, cur_pod, best_dist = INT_MAX;
+
+	if (pool_has_capacity(pwq->pool))
+		return pwq;
+
+	scope = READ_ONCE(wq->unbound_attrs->affn_scope);
+	if (scope == WQ_AFFN_DFL)
+		scope = READ_ONCE(wq_affn_dfl);
+	pt = &wq_pod_types[scope];
+	if (pt->nr_pods <= 1)
+		return pwq;
+
+	cur_pod = pt->cpu_pod[cpu];
+
+	/* start from the next pod so that spilled work is spread out */
+	for (i = 1; i < pt->nr_pods; i++) {
+		int pod = (cur_pod + i) % pt->nr_pods;
+		struct pool_workqueue *sib;
+		int sib_cpu, dist;
+
+		sib_cpu = cpumask_first_and(pt->pod_cpus[pod], wq_unbound_cpumask);
+		if (sib_cpu >= nr_cpu_ids || !cpu_online(sib_cpu))
+			continue;
+
+		sib = rcu_dereference(*per_cpu_ptr(wq->cpu_pwq, sib_cpu));
+		if (sib->pool == pwq->pool ||
+		    !list_empty(&sib->pool->worklist) ||
+		    !pool_has_capacity(sib->pool))
+			continue;
+
+		if (cpus_share_cache(cpu, sib_cpu))
+			dist = 0;
+		else if (cpu_to_node(cpu) == cpu_to_node(sib_cpu))
+			dist = 1;
+		else
+			dist = 2;
+
+		if (dist < best_dist) {
+			best = sib;
+			best_dist = dist;
+			if (!dist)
+				break;
+		}
+	}
+
+	return best;
+}
+
 static void __queue_work(int cpu, struct workqueue_struct *wq,
 			 struct work_struct *work)
 {
-	struct pool_workqueue *pwq;
+	struct pool_workqueue *pwq, *stolen_pwq;
 	struct worker_pool *last_pool, *pool;
 	unsigned int work_flags;
 	unsigned int req_cpu = cpu;
@@ -2269,6 +2370,15 @@ static void __queue_work(int cpu, struct workqueue_struct *wq,
 	}
 
 	pwq = rcu_dereference(*per_cpu_ptr(wq->cpu_pwq, cpu));
+
+	stolen_pwq = NULL;
+	if (wq_unbound_steal && req_cpu == WORK_CPU_UNBOUND &&
+	    (wq->flags & (WQ_UNBOUND | __WQ_ORDERED)) == WQ_UNBOUND) {
+		struct pool_workqueue *sib = unbound_steal_pwq(wq, pwq, cpu);
+
+		if (sib != pwq)
+			pwq = stolen_pwq = sib;
+	}
 	pool = pwq->pool;
 
 	/*
@@ -2339,6 +2449,8 @@ static void __queue_work(int cpu, struct workqueue_struct *wq,
 
 		trace_workqueue_activate_work(work);
 		insert_work(pwq, work, &pool->worklist, work_flags);
+		if (pwq == stolen_pwq)
+			pool->nr_stolen++;
 		kick_pool(pool);
 	} else {
 		work_flags |= WORK_STRUCT_INACTIVE;
@@ -7463,6 +7575,45 @@ static void workqueue_sysfs_unregister(struct workqueue_struct *wq)
 static void workqueue_sysfs_unregister(struct workqueue_struct *wq)	{ }
 #endif	/* CONFIG_SYSFS */
 
+#ifdef CONFIG_DEBUG_FS
+/*
+ * /sys/kernel/debug/workqueue/pools lists the unbound pools along with the
+ * number of work items each took over from a saturated sibling pod.
+ */
+static int wq_debugfs_pools_show(struct seq_file *m, void *v)
+{
+	struct worker_pool *pool;
+	int pi;
+
+	mutex_lock(&wq_pool_mutex);
+	for_each_pool(pool, pi) {
+		if (pool->cpu >= 0)
+			continue;
+
+		raw_spin_lock_irq(&pool->lock);
+		seq_printf(m, "pool %d: cpus=%*pbl pod_cpus=%*pbl nice=%d workers=%d idle=%d stolen=%llu\n",
+			   pool->id, nr_cpumask_bits, pool->attrs->cpumask,
+			   nr_cpumask_bits, pool->attrs->__pod_cpumask,
+			   pool->attrs->nice, pool->nr_workers, pool->nr_idle,
+			   pool->nr_stolen);
+		raw_spin_unlock_irq(&pool->lock);
+	}
+	mutex_unlock(&wq_pool_mutex);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(wq_debugfs_pools);
+
+static int __init wq_debugfs_init(void)
+{
+	struct dentry *dir = debugfs_create_dir("workqueue", NULL);
+
+	debugfs_create_file("pools", 0444, dir, NULL, &wq_debugfs_pools_fops);
+	return 0;
+}
+late_initcall(wq_debugfs_init);
+#endif	/* CONFIG_DEBUG_FS */
+
 /*
  * Workqueue watchdog.
  *
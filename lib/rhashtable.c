@@ -411,6 +411,26 @@ static int rhashtable_shrink(struct rhashtable *ht)
 	return rhashtable_rehash_alloc(ht, old_tbl, size);
 }
 
+/*
+ * Normally double the table, but a burst of insertions may have pushed it
+ * well past 75% before the worker ran: grow it to fit in one rehash rather
+ * than doubling it over several.
+ */
+static unsigned int rhashtable_grow_size(struct rhashtable *ht,
+					 struct bucket_table *tbl)
+{
+	unsigned int nelems = atomic_read(&ht->nelems);
+	unsigned int size = tbl->size * 2;
+
+	if (nelems < 1U << 30)
+		size = max_t(unsigned int, size,
+			     roundup_pow_of_two(nelems + nelems / 2));
+	if (ht->p.max_size)
+		size = min(size, ht->p.max_size);
+
+	return size;
+}
+
 static void rht_deferred_worker(struct work_struct *work)
 {
 	struct rhashtable *ht;
@@ -424,7 +444,8 @@ static void rht_deferred_worker(struct work_struct *work)
 	tbl = rhashtable_last_table(ht, tbl);
 
 	if (rht_grow_above_75(ht, tbl))
-		err = rhashtable_rehash_alloc(ht, tbl, tbl->size * 2);
+		err = rhashtable_rehash_alloc(ht, tbl,
+					      rhashtable_grow_size(ht, tbl));
 	else if (ht->p.automatic_shrinking && rht_shrink_below_30(ht, tbl))
 		err = rhashtable_shrink(ht);
 	else if (tbl->nest)
@@ -134,6 +134,7 @@ struct damon_region *damon_new_region(unsigned long start, unsigned long end)
 
 	region->age = 0;
 	region->last_nr_accesses = 0;
+	memset(region->access_hist, 0, sizeof(region->access_hist));
 
 	return region;
 }
@@ -701,6 +702,8 @@ int damon_set_attrs(struct damon_ctx *ctx, struct damon_attrs *attrs)
 		return -EINVAL;
 	if (attrs->sample_interval > attrs->aggr_interval)
 		return -EINVAL;
+	if (attrs->nr_sample_workers > DAMON_MAX_SAMPLE_WORKERS)
+		return -EINVAL;
 
 	/* calls from core-external doesn't set this. */
 	if (!attrs->aggr_samples)
@@ -1427,6 +1430,22 @@ static void damon_warn_fix_nr_accesses_corruption(struct damon_region *r)
 	r->nr_accesses_bp = r->nr_accesses * 10000;
 }
 
+/* Account the aggregation interval that just ended in the region histogram */
+static void damon_update_access_hist(struct damon_region *r,
+		unsigned long aggr_samples)
+{
+	unsigned int bucket;
+	int i;
+
+	bucket = min_t(unsigned long, DAMON_ACCESS_HIST_BUCKETS - 1,
+			(unsigned long)r->nr_accesses *
+			DAMON_ACCESS_HIST_BUCKETS / (aggr_samples + 1));
+	if (++r->access_hist[bucket] < DAMON_ACCESS_HIST_MAX)
+		return;
+	for (i = 0; i < DAMON_ACCESS_HIST_BUCKETS; i++)
+		r->access_hist[i] /= 2;
+}
+
 /*
  * Reset the aggregated monitoring results ('nr_accesses' of each region).
  */
@@ -1441,6 +1460,7 @@ static void kdamond_reset_aggregated(struct damon_ctx *c)
 		damon_for_each_region(r, t) {
 			trace_damon_aggregated(ti, r, damon_nr_regions(t));
 			damon_warn_fix_nr_accesses_corruption(r);
+			damon_update_access_hist(r, c->attrs.aggr_samples);
 			r->last_nr_accesses = r->nr_accesses;
 			r->nr_accesses = 0;
 		}
@@ -2124,11 +2144,15 @@ static void damon_merge_two_regions(struct damon_target *t,
 		struct damon_region *l, struct damon_region *r)
 {
 	unsigned long sz_l = damon_sz_region(l), sz_r = damon_sz_region(r);
+	int i;
 
 	l->nr_accesses = (l->nr_accesses * sz_l + r->nr_accesses * sz_r) /
 			(sz_l + sz_r);
 	l->nr_accesses_bp = l->nr_accesses * 10000;
 	l->age = (l->age * sz_l + r->age * sz_r) / (sz_l + sz_r);
+	for (i = 0; i < DAMON_ACCESS_HIST_BUCKETS; i++)
+		l->access_hist[i] = (l->access_hist[i] * sz_l +
+				r->access_hist[i] * sz_r) / (sz_l + sz_r);
 	l->ar.end = r->ar.end;
 	damon_destroy_region(r, t);
 }
@@ -2218,6 +2242,7 @@ static void damon_split_region_at(struct damon_target *t,
 	new->last_nr_accesses = r->last_nr_accesses;
 	new->nr_accesses_bp = r->nr_accesses_bp;
 	new->nr_accesses = r->nr_accesses;
+	memcpy(new->access_hist, r->access_hist, sizeof(new->access_hist));
 
 	damon_insert_region(new, r, damon_next_region(r), t);
 }
@@ -2575,6 +2600,8 @@ static int kdamond_fn(void *data)
 	if (ctx->ops.cleanup)
 		ctx->ops.cleanup(ctx);
 	kfree(ctx->regions_score_histogram);
+	kfree(ctx->sample_workers);
+	ctx->sample_workers = NULL;
 
 	pr_debug("kdamond (%d) finishes\n", current->pid);
 	mutex_lock(&ctx->kdamond_lock);
@@ -15,6 +15,8 @@
 #include <linux/memory-tiers.h>
 #include <linux/migrate.h>
 #include <linux/mm_inline.h>
+#include <linux/memory_hotplug.h>
+#include <linux/workqueue.h>
 
 #include "../internal.h"
 #include "ops-common.h"
@@ -76,10 +78,126 @@ static void __damon_pa_prepare_access_check(struct damon_region *r)
 	damon_pa_mkold(r->sampling_addr);
 }
 
+/*
+ * Access sampling fan-out.  With &damon_attrs->nr_sample_workers larger than
+ * one, worker i samples the regions starting on the NUMA nodes of id i modulo
+ * the number of workers.  The kdamond is worker zero, the others are run from
+ * the unbound workqueue on their first node.
+ */
+struct damon_pa_sampler {
+	struct work_struct work;
+	struct damon_ctx *ctx;
+	unsigned int id;
+	unsigned int nr;
+	bool check;
+	unsigned int max_nr_accesses;
+};
+
+/* Result of the last folio access check, reused for samples in the folio */
+struct damon_pa_access_cache {
+	unsigned long addr;
+	unsigned long folio_sz;
+	bool accessed;
+};
+
+static void __damon_pa_check_access(struct damon_region *r,
+		struct damon_attrs *attrs, struct damon_pa_access_cache *cache);
+
+static bool damon_pa_sampler_owns(struct damon_pa_sampler *sampler,
+		struct damon_region *r)
+{
+	struct page *page = pfn_to_online_page(PHYS_PFN(r->ar.start));
+	int nid = page ? page_to_nid(page) : 0;
+
+	return nid % sampler->nr == sampler->id;
+}
+
+static void damon_pa_sample(struct damon_pa_sampler *sampler)
+{
+	struct damon_pa_access_cache cache = { .folio_sz = PAGE_SIZE };
+	struct damon_ctx *ctx = sampler->ctx;
+	struct damon_target *t;
+	struct damon_region *r;
+
+	damon_for_each_target(t, ctx) {
+		damon_for_each_region(r, t) {
+			if (!damon_pa_sampler_owns(sampler, r))
+				continue;
+			if (!sampler->check) {
+				__damon_pa_prepare_access_check(r);
+				continue;
+			}
+			__damon_pa_check_access(r, &ctx->attrs, &cache);
+			sampler->max_nr_accesses = max(r->nr_accesses,
+					sampler->max_nr_accesses);
+		}
+		cond_resched();
+	}
+}
+
+static void damon_pa_sample_workfn(struct work_struct *work)
+{
+	damon_pa_sample(container_of(work, struct damon_pa_sampler, work));
+}
+
+/*
+ * Fan the access sampling out over the sample workers.  Returns false if
+ * the context has no more than one, or the workers couldn't be allocated.
+ * The workers are allocated for the maximum number on first use and kept in
+ * &damon_ctx->sample_workers until the kdamond stops.
+ */
+static bool damon_pa_sample_parallel(struct damon_ctx *ctx, bool check,
+		unsigned int *max_nr_accesses)
+{
+	unsigned int nr = min_t(unsigned int, ctx->attrs.nr_sample_workers,
+			nr_node_ids);
+	struct damon_pa_sampler *samplers;
+	unsigned int i;
+
+	if (nr <= 1)
+		return false;
+
+	samplers = ctx->sample_workers;
+	if (!samplers) {
+		samplers = kcalloc(DAMON_MAX_SAMPLE_WORKERS, sizeof(*samplers),
+				GFP_KERNEL | __GFP_NOWARN);
+		if (!samplers)
+			return false;
+		ctx->sample_workers = samplers;
+	}
+
+	for (i = 0; i < nr; i++) {
+		samplers[i].ctx = ctx;
+		samplers[i].id = i;
+		samplers[i].nr = nr;
+		samplers[i].check = check;
+		samplers[i].max_nr_accesses = 0;
+		if (!i)
+			continue;
+		INIT_WORK(&samplers[i].work, damon_pa_sample_workfn);
+		queue_work_node(node_state(i, N_MEMORY) ? i : NUMA_NO_NODE,
+				system_unbound_wq, &samplers[i].work);
+	}
+
+	damon_pa_sample(&samplers[0]);
+	*max_nr_accesses = samplers[0].max_nr_accesses;
+	for (i = 1; i < nr; i++) {
+		flush_work(&samplers[i].work);
+		*max_nr_accesses = max(samplers[i].max_nr_accesses,
+				*max_nr_accesses);
+	}
+
+	return true;
+}
+
 static void damon_pa_prepare_access_checks(struct damon_ctx *ctx)
 {
 	struct damon_target *t;
 	struct damon_region *r;
+	unsigned int max_nr_accesses;
+
+	if (damon_pa_sample_parallel(ctx, false, &max_nr_accesses))
+		return;
 
 	damon_for_each_target(t, ctx) {
 		damon_for_each_region(r, t)
@@ -171,34 +289,34 @@ static bool damon_pa_young(unsigned long paddr, unsigned long *folio_sz)
 }
 
 static void __damon_pa_check_access(struct damon_region *r,
-		struct damon_attrs *attrs)
+		struct damon_attrs *attrs, struct damon_pa_access_cache *cache)
 {
-	static unsigned long last_addr;
-	static unsigned long last_folio_sz = PAGE_SIZE;
-	static bool last_accessed;
-
 	/* If the region is in the last checked page, reuse the result */
-	if (ALIGN_DOWN(last_addr, last_folio_sz) ==
-				ALIGN_DOWN(r->sampling_addr, last_folio_sz)) {
-		damon_update_region_access_rate(r, last_accessed, attrs);
+	if (ALIGN_DOWN(cache->addr, cache->folio_sz) ==
+				ALIGN_DOWN(r->sampling_addr, cache->folio_sz)) {
+		damon_update_region_access_rate(r, cache->accessed, attrs);
 		return;
 	}
 
-	last_accessed = damon_pa_young(r->sampling_addr, &last_folio_sz);
-	damon_update_region_access_rate(r, last_accessed, attrs);
+	cache->accessed = damon_pa_young(r->sampling_addr, &cache->folio_sz);
+	damon_update_region_access_rate(r, cache->accessed, attrs);
 
-	last_addr = r->sampling_addr;
+	cache->addr = r->sampling_addr;
 }
 
 static unsigned int damon_pa_check_accesses(struct damon_ctx *ctx)
 {
+	static struct damon_pa_access_cache cache = { .folio_sz = PAGE_SIZE };
 	struct damon_target *t;
 	struct damon_region *r;
 	unsigned int max_nr_accesses = 0;
 
+	if (damon_pa_sample_parallel(ctx, true, &max_nr_accesses))
+		return max_nr_accesses;
+
 	damon_for_each_target(t, ctx) {
 		damon_for_each_region(r, t) {
-			__damon_pa_check_access(r, &ctx->attrs);
+			__damon_pa_check_access(r, &ctx->attrs, &cache);
 			max_nr_accesses = max(r->nr_accesses, max_nr_accesses);
 		}
 	}
@@ -529,7 +647,11 @@ static unsigned long damon_pa_migrate(struct damon_region *r, struct damos *s,
 		addr += folio_size(folio);
 		folio_put(folio);
 	}
-	applied = damon_pa_migrate_pages(&folio_list, s->target_nid);
+	applied = 0;
+	/* Leave the promotion of hot folios to kpromoted, in batches */
+	if (s->action == DAMOS_MIGRATE_HOT)
+		applied = migrate_promote_folio_list(&folio_list, s->target_nid);
+	applied += damon_pa_migrate_pages(&folio_list, s->target_nid);
 	cond_resched();
 	s->last_applied = folio;
 	return applied * PAGE_SIZE;
@@ -19,6 +19,7 @@ struct damon_sysfs_scheme_region {
 	struct damon_addr_range ar;
 	unsigned int nr_accesses;
 	unsigned int age;
+	unsigned int access_hist[DAMON_ACCESS_HIST_BUCKETS];
 	unsigned long sz_filter_passed;
 	struct list_head list;
 };
@@ -35,6 +36,8 @@ static struct damon_sysfs_scheme_region *damon_sysfs_scheme_region_alloc(
 	sysfs_region->ar = region->ar;
 	sysfs_region->nr_accesses = region->nr_accesses_bp / 10000;
 	sysfs_region->age = region->age;
+	memcpy(sysfs_region->access_hist, region->access_hist,
+			sizeof(sysfs_region->access_hist));
 	INIT_LIST_HEAD(&sysfs_region->list);
 	return sysfs_region;
 }
@@ -75,6 +78,20 @@ static ssize_t age_show(struct kobject *kobj, struct kobj_attribute *attr,
 	return sysfs_emit(buf, "%u\n", region->age);
 }
 
+static ssize_t access_histogram_show(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	struct damon_sysfs_scheme_region *region = container_of(kobj,
+			struct damon_sysfs_scheme_region, kobj);
+	int i, len = 0;
+
+	for (i = 0; i < DAMON_ACCESS_HIST_BUCKETS; i++)
+		len += sysfs_emit_at(buf, len, "%s%u", i ? " " : "",
+				region->access_hist[i]);
+	len += sysfs_emit_at(buf, len, "\n");
+	return len;
+}
+
 static ssize_t sz_filter_passed_show(struct kobject *kobj,
 		struct kobj_attribute *attr, char *buf)
 {
@@ -105,6 +122,9 @@ static struct kobj_attribute damon_sysfs_scheme_region_nr_accesses_attr =
 static struct kobj_attribute damon_sysfs_scheme_region_age_attr =
 		__ATTR_RO_MODE(age, 0400);
 
+static struct kobj_attribute damon_sysfs_scheme_region_access_histogram_attr =
+		__ATTR_RO_MODE(access_histogram, 0400);
+
 static struct kobj_attribute damon_sysfs_scheme_region_sz_filter_passed_attr =
 		__ATTR_RO_MODE(sz_filter_passed, 0400);
 
@@ -113,6 +133,7 @@ static struct attribute *damon_sysfs_scheme_region_attrs[] = {
 	&damon_sysfs_scheme_region_end_attr.attr,
 	&damon_sysfs_scheme_region_nr_accesses_attr.attr,
 	&damon_sysfs_scheme_region_age_attr.attr,
+	&damon_sysfs_scheme_region_access_histogram_attr.attr,
 	&damon_sysfs_scheme_region_sz_filter_passed_attr.attr,
 	NULL,
 };
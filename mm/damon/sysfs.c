@@ -729,6 +729,7 @@ struct damon_sysfs_attrs {
 	struct kobject kobj;
 	struct damon_sysfs_intervals *intervals;
 	struct damon_sysfs_ul_range *nr_regions_range;
+	unsigned int nr_sample_workers;
 };
 
 static struct damon_sysfs_attrs *damon_sysfs_attrs_alloc(void)
@@ -738,6 +739,7 @@ static struct damon_sysfs_attrs *damon_sysfs_attrs_alloc(void)
 	if (!attrs)
 		return NULL;
 	attrs->kobj = (struct kobject){};
+	attrs->nr_sample_workers = 1;
 	return attrs;
 }
 
@@ -796,7 +798,37 @@ static void damon_sysfs_attrs_release(struct kobject *kobj)
 	kfree(container_of(kobj, struct damon_sysfs_attrs, kobj));
 }
 
+static ssize_t nr_sample_workers_show(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	struct damon_sysfs_attrs *attrs = container_of(kobj,
+			struct damon_sysfs_attrs, kobj);
+
+	return sysfs_emit(buf, "%u\n", attrs->nr_sample_workers);
+}
+
+static ssize_t nr_sample_workers_store(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	struct damon_sysfs_attrs *attrs = container_of(kobj,
+			struct damon_sysfs_attrs, kobj);
+	unsigned int nr;
+	int err = kstrtouint(buf, 0, &nr);
+
+	if (err)
+		return err;
+	if (!nr || nr > DAMON_MAX_SAMPLE_WORKERS)
+		return -EINVAL;
+
+	attrs->nr_sample_workers = nr;
+	return count;
+}
+
+static struct kobj_attribute damon_sysfs_attrs_nr_sample_workers_attr =
+		__ATTR_RW_MODE(nr_sample_workers, 0600);
+
 static struct attribute *damon_sysfs_attrs_attrs[] = {
+	&damon_sysfs_attrs_nr_sample_workers_attr.attr,
 	NULL,
 };
 ATTRIBUTE_GROUPS(damon_sysfs_attrs);
@@ -1275,6 +1307,7 @@ static int damon_sysfs_set_attrs(struct damon_ctx *ctx,
 		.ops_update_interval = sys_intervals->update_us,
 		.min_nr_regions = sys_nr_regions->min,
 		.max_nr_regions = sys_nr_regions->max,
+		.nr_sample_workers = sys_attrs->nr_sample_workers,
 	};
 	return damon_set_attrs(ctx, &attrs);
 }
@@ -927,14 +927,6 @@ noinline int __filemap_add_folio(struct address_space *mapping,
 
 		mapping->nrpages += nr;
 
-		/* hugetlb pages do not participate in page cache accounting */
-		if (!huge) {
-			__lruvec_stat_mod_folio(folio, NR_FILE_PAGES, nr);
-			if (folio_test_pmd_mappable(folio))
-				__lruvec_stat_mod_folio(folio,
-						NR_FILE_THPS, nr);
-		}
-
 unlock:
 		xas_unlock_irq(&xas);
 
@@ -945,6 +937,17 @@ noinline int __filemap_add_folio(struct address_space *mapping,
 	if (xas_error(&xas))
 		goto error;
 
+	/*
+	 * Keep the memcg stat updates out from under the i_pages lock.  The
+	 * folio is locked, so it can't be removed before it is accounted.
+	 * hugetlb pages do not participate in page cache accounting.
+	 */
+	if (!huge) {
+		lruvec_stat_mod_folio(folio, NR_FILE_PAGES, nr);
+		if (folio_test_pmd_mappable(folio))
+			lruvec_stat_mod_folio(folio, NR_FILE_THPS, nr);
+	}
+
 	trace_mm_filemap_add_to_page_cache(folio);
 	return 0;
 error:
@@ -955,16 +958,12 @@ noinline int __filemap_add_folio(struct address_space *mapping,
 }
 ALLOW_ERROR_INJECTION(__filemap_add_folio, ERRNO);
 
-int filemap_add_folio(struct address_space *mapping, struct folio *folio,
-				pgoff_t index, gfp_t gfp)
+static int filemap_add_charged_folio(struct address_space *mapping,
+		struct folio *folio, pgoff_t index, gfp_t gfp)
 {
 	void *shadow = NULL;
 	int ret;
 
-	ret = mem_cgroup_charge(folio, NULL, gfp);
-	if (ret)
-		return ret;
-
 	__folio_set_locked(folio);
 	ret = __filemap_add_folio(mapping, folio, index, gfp, &shadow);
 	if (unlikely(ret)) {
@@ -986,8 +985,36 @@ int filemap_add_folio(struct address_space *mapping, struct folio *folio,
 	}
 	return ret;
 }
+
+int filemap_add_folio(struct address_space *mapping, struct folio *folio,
+				pgoff_t index, gfp_t gfp)
+{
+	int ret;
+
+	ret = mem_cgroup_charge(folio, NULL, gfp);
+	if (ret)
+		return ret;
+
+	return filemap_add_charged_folio(mapping, folio, index, gfp);
+}
 EXPORT_SYMBOL_GPL(filemap_add_folio);
 
+/*
+ * As filemap_add_folio(), but charge the folio against a batch started with
+ * mem_cgroup_charge_batch_start(), for callers inserting many folios at once.
+ */
+int filemap_add_folio_batch(struct address_space *mapping, struct folio *folio,
+		pgoff_t index, gfp_t gfp, struct mem_cgroup_charge_batch *batch)
+{
+	int ret;
+
+	ret = mem_cgroup_charge_batch(batch, folio, gfp);
+	if (ret)
+		return ret;
+
+	return filemap_add_charged_folio(mapping, folio, index, gfp);
+}
+
 #ifdef CONFIG_NUMA
 struct folio *filemap_alloc_folio_noprof(gfp_t gfp, unsigned int order)
 {
@@ -1007,6 +1034,30 @@ struct folio *filemap_alloc_folio_noprof(gfp_t gfp, unsigned int order)
 	return folio_alloc_noprof(gfp, order);
 }
 EXPORT_SYMBOL(filemap_alloc_folio_noprof);
+
+unsigned long filemap_alloc_folios_bulk_noprof(gfp_t gfp, unsigned int order,
+		unsigned long nr_folios, struct folio **folio_array)
+{
+	unsigned long nr_populated = 0;
+
+	/* Spreading picks a node per folio, so do it one at a time */
+	if (cpuset_do_page_mem_spread()) {
+		for (; nr_populated < nr_folios; nr_populated++) {
+			struct folio *folio;
+
+			if (folio_array[nr_populated])
+				continue;
+			folio = filemap_alloc_folio_noprof(gfp, order);
+			if (!folio)
+				break;
+			folio_array[nr_populated] = folio;
+		}
+		return nr_populated;
+	}
+	return alloc_folios_bulk_mempolicy_noprof(gfp, order, nr_folios,
+						  folio_array);
+}
+EXPORT_SYMBOL(filemap_alloc_folios_bulk_noprof);
 #endif
 
 /*
@@ -2921,6 +2972,10 @@ size_t splice_folio_into_pipe(struct pipe_inode_info *pipe,
 		struct pipe_buffer *buf = pipe_head_buf(pipe);
 		size_t part = min_t(size_t, PAGE_SIZE - offset, size - spliced);
 
+		/* One buffer for the whole range if the consumer copes */
+		if (pipe->large_bufs)
+			part = size - spliced;
+
 		*buf = (struct pipe_buffer) {
 			.ops	= &page_cache_pipe_buf_ops,
 			.page	= page,
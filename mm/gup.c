@@ -21,6 +21,9 @@
 #include <linux/pagevec.h>
 #include <linux/sched/mm.h>
 #include <linux/shmem_fs.h>
+#include <linux/cpuset.h>
+#include <linux/padata.h>
+#include <linux/sysctl.h>
 
 #include <asm/mmu_context.h>
 #include <asm/tlbflush.h>
@@ -1856,28 +1859,13 @@ static __always_inline long __get_user_pages_locked(struct mm_struct *mm,
 	return pages_done;
 }
 
-/**
- * populate_vma_page_range() -  populate a range of pages in the vma.
- * @vma:   target vma
- * @start: start address
- * @end:   end address
- * @locked: whether the mmap_lock is still held
- *
- * This takes care of mlocking the pages too if VM_LOCKED is set.
- *
- * Return either number of pages pinned in the vma, or a negative error
- * code on error.
- *
- * vma->vm_mm->mmap_lock must be held.
- *
- * If @locked is NULL, it may be held for read or write and will
- * be unperturbed.
- *
- * If @locked is non-NULL, it must held for read only and may be
- * released.  If it's released, *@locked will be set to 0.
+/*
+ * As populate_vma_page_range(), with extra @foll_flags.  Callers faulting in
+ * another task's mm pass FOLL_REMOTE.
  */
-long populate_vma_page_range(struct vm_area_struct *vma,
-		unsigned long start, unsigned long end, int *locked)
+static long __populate_vma_page_range(struct vm_area_struct *vma,
+		unsigned long start, unsigned long end, int *locked,
+		unsigned int foll_flags)
 {
 	struct mm_struct *mm = vma->vm_mm;
 	unsigned long nr_pages = (end - start) / PAGE_SIZE;
@@ -1902,7 +1890,7 @@ long populate_vma_page_range(struct vm_area_struct *vma,
 	if (!vma_is_accessible(vma))
 		return -EFAULT;
 
-	gup_flags = FOLL_TOUCH;
+	gup_flags = FOLL_TOUCH | foll_flags;
 	/*
 	 * We want to touch writable mappings with a write fault in order
 	 * to break COW, except for shared mappings because these don't COW
@@ -1929,6 +1917,32 @@ long populate_vma_page_range(struct vm_area_struct *vma,
 	return ret;
 }
 
+/**
+ * populate_vma_page_range() -  populate a range of pages in the vma.
+ * @vma:   target vma
+ * @start: start address
+ * @end:   end address
+ * @locked: whether the mmap_lock is still held
+ *
+ * This takes care of mlocking the pages too if VM_LOCKED is set.
+ *
+ * Return either number of pages pinned in the vma, or a negative error
+ * code on error.
+ *
+ * vma->vm_mm->mmap_lock must be held.
+ *
+ * If @locked is NULL, it may be held for read or write and will
+ * be unperturbed.
+ *
+ * If @locked is non-NULL, it must held for read only and may be
+ * released.  If it's released, *@locked will be set to 0.
+ */
+long populate_vma_page_range(struct vm_area_struct *vma,
+		unsigned long start, unsigned long end, int *locked)
+{
+	return __populate_vma_page_range(vma, start, end, locked, 0);
+}
+
 /*
  * faultin_page_range() - populate (prefault) page tables inside the
  *			  given range readable/writable
@@ -1981,23 +1995,143 @@ long faultin_page_range(struct mm_struct *mm, unsigned long start,
 	return ret;
 }
 
+static long populate_range(struct mm_struct *mm, unsigned long start,
+		unsigned long end, int ignore_errors, bool remote);
+
+#ifdef CONFIG_PADATA
 /*
- * __mm_populate - populate and/or mlock pages within a range of address space.
- *
- * This is used to implement mlock() and the MAP_POPULATE / MAP_LOCKED mmap
- * flags. VMAs must be already marked with the desired vm_flags, and
- * mmap_lock must not be held.
+ * Large MAP_POPULATE / mlock ranges may be faulted in by several kworkers at
+ * once.  0 or 1 keeps the traditional single threaded behaviour.
  */
-int __mm_populate(unsigned long start, unsigned long len, int ignore_errors)
+static unsigned int sysctl_populate_parallel_threads __read_mostly;
+
+/* Minimum amount of address space a populate helper is handed at once. */
+#define POPULATE_PARALLEL_CHUNK		SZ_128M
+
+struct populate_parallel_arg {
+	struct mm_struct	*mm;
+	struct task_struct	*task;
+	int			ignore_errors;
+	atomic_t		err;
+};
+
+static void populate_parallel_chunk(unsigned long start, unsigned long end,
+				    void *data)
 {
-	struct mm_struct *mm = current->mm;
-	unsigned long end, nstart, nend;
+	struct populate_parallel_arg *arg = data;
+	long ret;
+
+	/*
+	 * Helpers don't see the caller's signals, so stop handing out work
+	 * once it was killed or another chunk failed.
+	 */
+	if (atomic_read(&arg->err))
+		return;
+	if (fatal_signal_pending(arg->task)) {
+		atomic_cmpxchg(&arg->err, 0, -EINTR);
+		return;
+	}
+
+	/* The caller waits for us and holds its mm, the helper fault is remote */
+	ret = populate_range(arg->mm, start, end, arg->ignore_errors, true);
+	if (ret < 0)
+		atomic_cmpxchg(&arg->err, 0, ret);
+}
+
+static bool populate_parallel_allowed(unsigned long len)
+{
+	if (sysctl_populate_parallel_threads < 2 ||
+	    len < 2 * POPULATE_PARALLEL_CHUNK)
+		return false;
+#ifdef CONFIG_NUMA
+	/*
+	 * Helpers allocate under their own task mempolicy and cpuset, which
+	 * only matches the caller when it runs with the defaults.
+	 */
+	if (current->mempolicy)
+		return false;
+#endif
+	if (!nodes_equal(cpuset_current_mems_allowed, node_states[N_MEMORY]))
+		return false;
+	return true;
+}
+
+/*
+ * Fault in [start, end) of a single VMA using padata helpers.  Helpers are
+ * queued on the unbound workqueue from the calling CPU, so they run close to
+ * it and pages land where a single threaded populate would place them.  Each
+ * helper takes mmap_lock for read on its own and revalidates the VMAs, like
+ * the serial path does after the lock was dropped.
+ */
+static long populate_parallel(struct mm_struct *mm, unsigned long start,
+		unsigned long end, int ignore_errors)
+{
+	struct populate_parallel_arg arg = {
+		.mm		= mm,
+		.task		= current,
+		.ignore_errors	= ignore_errors,
+		.err		= ATOMIC_INIT(0),
+	};
+	struct padata_mt_job job = {
+		.thread_fn	= populate_parallel_chunk,
+		.fn_arg		= &arg,
+		.start		= start,
+		.size		= end - start,
+		.align		= PMD_SIZE,
+		.min_chunk	= POPULATE_PARALLEL_CHUNK,
+		.max_threads	= min_t(unsigned int,
+					sysctl_populate_parallel_threads,
+					num_online_cpus()),
+		.numa_aware	= false,
+	};
+
+	padata_do_multithreaded(&job);
+	return atomic_read(&arg.err);
+}
+
+static const struct ctl_table populate_sysctl_table[] = {
+	{
+		.procname	= "populate_parallel_threads",
+		.data		= &sysctl_populate_parallel_threads,
+		.maxlen		= sizeof(sysctl_populate_parallel_threads),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec,
+	},
+};
+
+static int __init populate_sysctl_init(void)
+{
+	register_sysctl_init("vm", populate_sysctl_table);
+	return 0;
+}
+subsys_initcall(populate_sysctl_init);
+#else
+static inline bool populate_parallel_allowed(unsigned long len)
+{
+	return false;
+}
+
+static inline long populate_parallel(struct mm_struct *mm,
+		unsigned long start, unsigned long end, int ignore_errors)
+{
+	return 0;
+}
+#endif /* CONFIG_PADATA */
+
+/*
+ * Populate [start, end) of @mm.  @remote is set by padata helpers, which fault
+ * in the caller's mm from a kworker: their faults go through FOLL_REMOTE, so
+ * neither the kworker's protection keys nor its fault accounting apply, and
+ * they never split their chunk further.
+ */
+static long populate_range(struct mm_struct *mm, unsigned long start,
+		unsigned long end, int ignore_errors, bool remote)
+{
+	unsigned long nstart, nend;
 	struct vm_area_struct *vma = NULL;
 	int locked = 0;
 	long ret = 0;
 
-	end = start + len;
-
 	for (nstart = start; nstart < end; nstart = nend) {
 		/*
 		 * We want to fault in pages for [nstart; end) address range.
@@ -2021,12 +2155,26 @@ int __mm_populate(unsigned long start, unsigned long len, int ignore_errors)
 			continue;
 		if (nstart < vma->vm_start)
 			nstart = vma->vm_start;
+		/*
+		 * Hand large VMAs to helpers.  They look the VMAs up again
+		 * under their own mmap_lock, so drop ours meanwhile.
+		 */
+		if (!remote && populate_parallel_allowed(nend - nstart)) {
+			mmap_read_unlock(mm);
+			locked = 0;
+			ret = populate_parallel(mm, nstart, nend, ignore_errors);
+			if (ret < 0 && !ignore_errors)
+				break;
+			ret = 0;
+			continue;
+		}
 		/*
 		 * Now fault in a range of pages. populate_vma_page_range()
 		 * double checks the vma flags, so that it won't mlock pages
 		 * if the vma was already munlocked.
 		 */
-		ret = populate_vma_page_range(vma, nstart, nend, &locked);
+		ret = __populate_vma_page_range(vma, nstart, nend, &locked,
+						remote ? FOLL_REMOTE : 0);
 		if (ret < 0) {
 			if (ignore_errors) {
 				ret = 0;
@@ -2041,6 +2189,22 @@ int __mm_populate(unsigned long start, unsigned long len, int ignore_errors)
 		mmap_read_unlock(mm);
 	return ret;	/* 0 or negative error code */
 }
+
+/*
+ * __mm_populate - populate and/or mlock pages within a range of address space.
+ *
+ * This is used to implement mlock() and the MAP_POPULATE / MAP_LOCKED mmap
+ * flags. VMAs must be already marked with the desired vm_flags, and
+ * mmap_lock must not be held.
+ *
+ * VMAs larger than twice POPULATE_PARALLEL_CHUNK are split across up to
+ * vm.populate_parallel_threads helpers when that sysctl is set.
+ */
+int __mm_populate(unsigned long start, unsigned long len, int ignore_errors)
+{
+	return populate_range(current->mm, start, start + len, ignore_errors,
+			      false);
+}
 #else /* CONFIG_MMU */
 static long __get_user_pages_locked(struct mm_struct *mm, unsigned long start,
 		unsigned long nr_pages, struct page **pages,
@@ -2051,7 +2051,7 @@ vm_fault_t do_huge_pmd_numa_page(struct vm_fault *vmf)
 	int nid = NUMA_NO_NODE;
 	int target_nid, last_cpupid;
 	pmd_t pmd, old_pmd;
-	bool writable = false;
+	bool writable = false, queued = false;
 	int flags = 0;
 
 	vmf->ptl = pmd_lock(vma->vm_mm, vmf->pmd);
@@ -2087,7 +2087,15 @@ vm_fault_t do_huge_pmd_numa_page(struct vm_fault *vmf)
 		flags |= TNF_MIGRATE_FAIL;
 		goto out_map;
 	}
-	/* The folio is isolated and isolation code holds a folio reference. */
+	/*
+	 * The folio is isolated and isolation code holds a folio reference.
+	 * When promoting asynchronously, map it again and leave the migration
+	 * to kpromoted.
+	 */
+	if (migrate_promote_can_queue(folio, target_nid)) {
+		queued = true;
+		goto out_map;
+	}
 	spin_unlock(vmf->ptl);
 	writable = false;
 
@@ -2114,6 +2122,9 @@ vm_fault_t do_huge_pmd_numa_page(struct vm_fault *vmf)
 	update_mmu_cache_pmd(vma, vmf->address, vmf->pmd);
 	spin_unlock(vmf->ptl);
 
+	if (queued)
+		migrate_misplaced_folio_queue(folio, target_nid);
+
 	if (nid != NUMA_NO_NODE)
 		task_numa_fault(last_cpupid, nid, HPAGE_PMD_NR, flags);
 	return 0;
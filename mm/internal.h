@@ -425,6 +425,14 @@ void free_pgtables(struct mmu_gather *tlb, struct ma_state *mas,
 		   unsigned long ceiling, bool mm_wr_locked);
 void pmd_install(struct mm_struct *mm, pmd_t *pmd, pgtable_t *pte);
 
+/* A VMA whose page tables dup_mmap() copies after the VMA walk */
+struct vma_copy_pair {
+	struct vm_area_struct *dst;
+	struct vm_area_struct *src;
+};
+int copy_page_range_parallel(struct vma_copy_pair *pairs, unsigned int nr,
+			     unsigned int nr_threads);
+
 struct zap_details;
 void unmap_page_range(struct mmu_gather *tlb,
 			     struct vm_area_struct *vma,
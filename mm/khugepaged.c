@@ -21,6 +21,7 @@
 #include <linux/shmem_fs.h>
 #include <linux/dax.h>
 #include <linux/ksm.h>
+#include <linux/memory.h>
 
 #include <asm/tlb.h>
 #include <asm/pgalloc.h>
@@ -65,17 +66,13 @@ enum scan_result {
 #define CREATE_TRACE_POINTS
 #include <trace/events/huge_memory.h>
 
-static struct task_struct *khugepaged_thread __read_mostly;
 static DEFINE_MUTEX(khugepaged_mutex);
 
-/* default scan 8*512 pte (or vmas) every 30 second */
+/* default scan 8*512 pte (or vmas) every 30 second, per node */
 static unsigned int khugepaged_pages_to_scan __read_mostly;
-static unsigned int khugepaged_pages_collapsed;
-static unsigned int khugepaged_full_scans;
 static unsigned int khugepaged_scan_sleep_millisecs __read_mostly = 10000;
 /* during fragmentation poll the hugepage allocator once every minute */
 static unsigned int khugepaged_alloc_sleep_millisecs __read_mostly = 60000;
-static unsigned long khugepaged_sleep_expire;
 static DEFINE_SPINLOCK(khugepaged_mm_lock);
 static DECLARE_WAIT_QUEUE_HEAD(khugepaged_wait);
 /*
@@ -107,9 +104,11 @@ struct collapse_control {
 /**
  * struct khugepaged_mm_slot - khugepaged information per mm that is being scanned
  * @slot: hash lookup from mm to mm_slot
+ * @nid: the node whose cursor this mm is queued on
  */
 struct khugepaged_mm_slot {
 	struct mm_slot slot;
+	int nid;
 };
 
 /**
@@ -117,20 +116,40 @@ struct khugepaged_mm_slot {
  * @mm_head: the head of the mm list to scan
  * @mm_slot: the current mm_slot we are scanning
  * @address: the next address inside that to be scanned
+ * @nid: the node this cursor belongs to
+ * @thread: the khugepaged thread scanning this cursor
+ * @sleep_expire: when the thread's current scan sleep ends
+ * @pages_collapsed: pages collapsed by the thread
+ * @full_scans: full scans of @mm_head by the thread
+ * @cc: collapse control of the thread
  *
- * There is only the one khugepaged_scan instance of this cursor structure.
+ * There is one khugepaged_scan instance of this cursor structure per node,
+ * the mm lists are protected by khugepaged_mm_lock.
  */
 struct khugepaged_scan {
 	struct list_head mm_head;
 	struct khugepaged_mm_slot *mm_slot;
 	unsigned long address;
+	int nid;
+	struct task_struct *thread;
+	unsigned long sleep_expire;
+	unsigned int pages_collapsed;
+	unsigned int full_scans;
+	struct collapse_control cc;
 };
 
-static struct khugepaged_scan khugepaged_scan = {
-	.mm_head = LIST_HEAD_INIT(khugepaged_scan.mm_head),
-};
+static struct khugepaged_scan *khugepaged_scans[MAX_NUMNODES] __read_mostly;
 
 #ifdef CONFIG_SYSFS
+static void khugepaged_reset_sleep(void)
+{
+	int nid;
+
+	for_each_node(nid)
+		WRITE_ONCE(khugepaged_scans[nid]->sleep_expire, 0);
+	wake_up_interruptible(&khugepaged_wait);
+}
+
 static ssize_t scan_sleep_millisecs_show(struct kobject *kobj,
 					 struct kobj_attribute *attr,
 					 char *buf)
@@ -150,8 +169,7 @@ static ssize_t scan_sleep_millisecs_store(struct kobject *kobj,
 		return -EINVAL;
 
 	khugepaged_scan_sleep_millisecs = msecs;
-	khugepaged_sleep_expire = 0;
-	wake_up_interruptible(&khugepaged_wait);
+	khugepaged_reset_sleep();
 
 	return count;
 }
@@ -177,8 +195,7 @@ static ssize_t alloc_sleep_millisecs_store(struct kobject *kobj,
 		return -EINVAL;
 
 	khugepaged_alloc_sleep_millisecs = msecs;
-	khugepaged_sleep_expire = 0;
-	wake_up_interruptible(&khugepaged_wait);
+	khugepaged_reset_sleep();
 
 	return count;
 }
@@ -213,7 +230,13 @@ static ssize_t pages_collapsed_show(struct kobject *kobj,
 				    struct kobj_attribute *attr,
 				    char *buf)
 {
-	return sysfs_emit(buf, "%u\n", khugepaged_pages_collapsed);
+	unsigned int pages_collapsed = 0;
+	int nid;
+
+	for_each_node(nid)
+		pages_collapsed += READ_ONCE(khugepaged_scans[nid]->pages_collapsed);
+
+	return sysfs_emit(buf, "%u\n", pages_collapsed);
 }
 static struct kobj_attribute pages_collapsed_attr =
 	__ATTR_RO(pages_collapsed);
@@ -222,7 +245,13 @@ static ssize_t full_scans_show(struct kobject *kobj,
 			       struct kobj_attribute *attr,
 			       char *buf)
 {
-	return sysfs_emit(buf, "%u\n", khugepaged_full_scans);
+	unsigned int full_scans = 0;
+	int nid;
+
+	for_each_node(nid)
+		full_scans += READ_ONCE(khugepaged_scans[nid]->full_scans);
+
+	return sysfs_emit(buf, "%u\n", full_scans);
 }
 static struct kobj_attribute full_scans_attr =
 	__ATTR_RO(full_scans);
@@ -383,22 +412,62 @@ int hugepage_madvise(struct vm_area_struct *vma,
 	return 0;
 }
 
+static void khugepaged_free_scans(void)
+{
+	int nid;
+
+	for_each_node(nid) {
+		kfree(khugepaged_scans[nid]);
+		khugepaged_scans[nid] = NULL;
+	}
+}
+
+static int khugepaged_memory_callback(struct notifier_block *self,
+				      unsigned long action, void *arg)
+{
+	struct memory_notify *mn = arg;
+
+	/* Start khugepaged on a node that just got its first memory */
+	if (action == MEM_ONLINE && mn->status_change_nid != NUMA_NO_NODE &&
+	    hugepage_pmd_enabled())
+		start_stop_khugepaged();
+	return NOTIFY_OK;
+}
+
 int __init khugepaged_init(void)
 {
+	struct khugepaged_scan *scan;
+	int nid;
+
 	mm_slot_cache = KMEM_CACHE(khugepaged_mm_slot, 0);
 	if (!mm_slot_cache)
 		return -ENOMEM;
 
+	for_each_node(nid) {
+		scan = kzalloc_node(sizeof(*scan), GFP_KERNEL, nid);
+		if (!scan) {
+			khugepaged_free_scans();
+			kmem_cache_destroy(mm_slot_cache);
+			return -ENOMEM;
+		}
+		INIT_LIST_HEAD(&scan->mm_head);
+		scan->nid = nid;
+		scan->cc.is_khugepaged = true;
+		khugepaged_scans[nid] = scan;
+	}
+
 	khugepaged_pages_to_scan = HPAGE_PMD_NR * 8;
 	khugepaged_max_ptes_none = HPAGE_PMD_NR - 1;
 	khugepaged_max_ptes_swap = HPAGE_PMD_NR / 8;
 	khugepaged_max_ptes_shared = HPAGE_PMD_NR / 2;
 
+	hotplug_memory_notifier(khugepaged_memory_callback, DEFAULT_CALLBACK_PRI);
 	return 0;
 }
 
 void __init khugepaged_destroy(void)
 {
+	khugepaged_free_scans();
 	kmem_cache_destroy(mm_slot_cache);
 }
 
@@ -437,9 +506,23 @@ static bool hugepage_pmd_enabled(void)
 	return false;
 }
 
+/*
+ * Pick the cursor for an mm registering from @nid: its own, unless that node
+ * has no khugepaged thread yet, then the first online node's.
+ */
+static int khugepaged_scan_nid(int nid)
+{
+	struct khugepaged_scan *scan = khugepaged_scans[nid];
+
+	if (likely(scan && READ_ONCE(scan->thread)))
+		return nid;
+	return first_online_node;
+}
+
 void __khugepaged_enter(struct mm_struct *mm)
 {
 	struct khugepaged_mm_slot *mm_slot;
+	struct khugepaged_scan *scan;
 	struct mm_slot *slot;
 	int wakeup;
 
@@ -453,6 +536,8 @@ void __khugepaged_enter(struct mm_struct *mm)
 		return;
 
 	slot = &mm_slot->slot;
+	mm_slot->nid = khugepaged_scan_nid(numa_node_id());
+	scan = khugepaged_scans[mm_slot->nid];
 
 	spin_lock(&khugepaged_mm_lock);
 	mm_slot_insert(mm_slots_hash, mm, slot);
@@ -460,8 +545,8 @@ void __khugepaged_enter(struct mm_struct *mm)
 	 * Insert just behind the scanning cursor, to let the area settle
 	 * down a little.
 	 */
-	wakeup = list_empty(&khugepaged_scan.mm_head);
-	list_add_tail(&slot->mm_node, &khugepaged_scan.mm_head);
+	wakeup = list_empty(&scan->mm_head);
+	list_add_tail(&slot->mm_node, &scan->mm_head);
 	spin_unlock(&khugepaged_mm_lock);
 
 	mmgrab(mm);
@@ -489,7 +574,7 @@ void __khugepaged_exit(struct mm_struct *mm)
 	spin_lock(&khugepaged_mm_lock);
 	slot = mm_slot_lookup(mm_slots_hash, mm);
 	mm_slot = mm_slot_entry(slot, struct khugepaged_mm_slot, slot);
-	if (mm_slot && khugepaged_scan.mm_slot != mm_slot) {
+	if (mm_slot && khugepaged_scans[mm_slot->nid]->mm_slot != mm_slot) {
 		hash_del(&slot->hash);
 		list_del(&slot->mm_node);
 		free = 1;
@@ -834,10 +919,6 @@ static void khugepaged_alloc_sleep(void)
 	remove_wait_queue(&khugepaged_wait, &wait);
 }
 
-struct collapse_control khugepaged_collapse_control = {
-	.is_khugepaged = true,
-};
-
 static bool hpage_collapse_scan_abort(int nid, struct collapse_control *cc)
 {
 	int i;
@@ -2356,8 +2437,8 @@ static int hpage_collapse_scan_file(struct mm_struct *mm, unsigned long addr,
 	return result;
 }
 
-static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
-					    struct collapse_control *cc)
+static unsigned int khugepaged_scan_mm_slot(struct khugepaged_scan *scan,
+					    unsigned int pages, int *result)
 	__releases(&khugepaged_mm_lock)
 	__acquires(&khugepaged_mm_lock)
 {
@@ -2366,21 +2447,22 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 	struct mm_slot *slot;
 	struct mm_struct *mm;
 	struct vm_area_struct *vma;
+	struct collapse_control *cc = &scan->cc;
 	int progress = 0;
 
 	VM_BUG_ON(!pages);
 	lockdep_assert_held(&khugepaged_mm_lock);
 	*result = SCAN_FAIL;
 
-	if (khugepaged_scan.mm_slot) {
-		mm_slot = khugepaged_scan.mm_slot;
+	if (scan->mm_slot) {
+		mm_slot = scan->mm_slot;
 		slot = &mm_slot->slot;
 	} else {
-		slot = list_entry(khugepaged_scan.mm_head.next,
+		slot = list_entry(scan->mm_head.next,
 				     struct mm_slot, mm_node);
 		mm_slot = mm_slot_entry(slot, struct khugepaged_mm_slot, slot);
-		khugepaged_scan.address = 0;
-		khugepaged_scan.mm_slot = mm_slot;
+		scan->address = 0;
+		scan->mm_slot = mm_slot;
 	}
 	spin_unlock(&khugepaged_mm_lock);
 
@@ -2397,7 +2479,7 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 	if (unlikely(hpage_collapse_test_exit_or_disable(mm)))
 		goto breakouterloop;
 
-	vma_iter_init(&vmi, mm, khugepaged_scan.address);
+	vma_iter_init(&vmi, mm, scan->address);
 	for_each_vma(vmi, vma) {
 		unsigned long hstart, hend;
 
@@ -2414,52 +2496,56 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 		}
 		hstart = round_up(vma->vm_start, HPAGE_PMD_SIZE);
 		hend = round_down(vma->vm_end, HPAGE_PMD_SIZE);
-		if (khugepaged_scan.address > hend)
+		if (scan->address > hend)
 			goto skip;
-		if (khugepaged_scan.address < hstart)
-			khugepaged_scan.address = hstart;
-		VM_BUG_ON(khugepaged_scan.address & ~HPAGE_PMD_MASK);
+		if (scan->address < hstart)
+			scan->address = hstart;
+		VM_BUG_ON(scan->address & ~HPAGE_PMD_MASK);
 
-		while (khugepaged_scan.address < hend) {
+		while (scan->address < hend) {
 			bool mmap_locked = true;
 
 			cond_resched();
 			if (unlikely(hpage_collapse_test_exit_or_disable(mm)))
 				goto breakouterloop;
 
-			VM_BUG_ON(khugepaged_scan.address < hstart ||
-				  khugepaged_scan.address + HPAGE_PMD_SIZE >
+			VM_BUG_ON(scan->address < hstart ||
+				  scan->address + HPAGE_PMD_SIZE >
 				  hend);
 			if (!vma_is_anonymous(vma)) {
 				struct file *file = get_file(vma->vm_file);
 				pgoff_t pgoff = linear_page_index(vma,
-						khugepaged_scan.address);
+						scan->address);
 
 				mmap_read_unlock(mm);
 				mmap_locked = false;
 				*result = hpage_collapse_scan_file(mm,
-					khugepaged_scan.address, file, pgoff, cc);
+					scan->address, file, pgoff, cc);
 				fput(file);
 				if (*result == SCAN_PTE_MAPPED_HUGEPAGE) {
 					mmap_read_lock(mm);
 					if (hpage_collapse_test_exit_or_disable(mm))
 						goto breakouterloop;
 					*result = collapse_pte_mapped_thp(mm,
-						khugepaged_scan.address, false);
+						scan->address, false);
 					if (*result == SCAN_PMD_MAPPED)
 						*result = SCAN_SUCCEED;
 					mmap_read_unlock(mm);
 				}
 			} else {
 				*result = hpage_collapse_scan_pmd(mm, vma,
-					khugepaged_scan.address, &mmap_locked, cc);
+					scan->address, &mmap_locked, cc);
 			}
 
-			if (*result == SCAN_SUCCEED)
-				++khugepaged_pages_collapsed;
+			if (*result == SCAN_SUCCEED) {
+				WRITE_ONCE(scan->pages_collapsed,
+					   scan->pages_collapsed + 1);
+				mod_node_page_state(NODE_DATA(scan->nid),
+						    KHUGEPAGED_COLLAPSED, 1);
+			}
 
 			/* move to next address */
-			khugepaged_scan.address += HPAGE_PMD_SIZE;
+			scan->address += HPAGE_PMD_SIZE;
 			progress += HPAGE_PMD_NR;
 			if (!mmap_locked)
 				/*
@@ -2479,7 +2565,7 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 breakouterloop_mmap_lock:
 
 	spin_lock(&khugepaged_mm_lock);
-	VM_BUG_ON(khugepaged_scan.mm_slot != mm_slot);
+	VM_BUG_ON(scan->mm_slot != mm_slot);
 	/*
 	 * Release the current mm_slot if this mm is about to die, or
 	 * if we scanned all vmas of this mm.
@@ -2490,15 +2576,17 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 		 * khugepaged runs here, khugepaged_exit will find
 		 * mm_slot not pointing to the exiting mm.
 		 */
-		if (slot->mm_node.next != &khugepaged_scan.mm_head) {
+		if (slot->mm_node.next != &scan->mm_head) {
 			slot = list_entry(slot->mm_node.next,
 					  struct mm_slot, mm_node);
-			khugepaged_scan.mm_slot =
+			scan->mm_slot =
 				mm_slot_entry(slot, struct khugepaged_mm_slot, slot);
-			khugepaged_scan.address = 0;
+			scan->address = 0;
 		} else {
-			khugepaged_scan.mm_slot = NULL;
-			khugepaged_full_scans++;
+			scan->mm_slot = NULL;
+			WRITE_ONCE(scan->full_scans, scan->full_scans + 1);
+			mod_node_page_state(NODE_DATA(scan->nid),
+					    KHUGEPAGED_FULL_SCANS, 1);
 		}
 
 		collect_mm_slot(mm_slot);
@@ -2507,18 +2595,18 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 	return progress;
 }
 
-static int khugepaged_has_work(void)
+static int khugepaged_has_work(struct khugepaged_scan *scan)
 {
-	return !list_empty(&khugepaged_scan.mm_head) && hugepage_pmd_enabled();
+	return !list_empty(&scan->mm_head) && hugepage_pmd_enabled();
 }
 
-static int khugepaged_wait_event(void)
+static int khugepaged_wait_event(struct khugepaged_scan *scan)
 {
-	return !list_empty(&khugepaged_scan.mm_head) ||
+	return !list_empty(&scan->mm_head) ||
 		kthread_should_stop();
 }
 
-static void khugepaged_do_scan(struct collapse_control *cc)
+static void khugepaged_do_scan(struct khugepaged_scan *scan)
 {
 	unsigned int progress = 0, pass_through_head = 0;
 	unsigned int pages = READ_ONCE(khugepaged_pages_to_scan);
@@ -2534,12 +2622,12 @@ static void khugepaged_do_scan(struct collapse_control *cc)
 			break;
 
 		spin_lock(&khugepaged_mm_lock);
-		if (!khugepaged_scan.mm_slot)
+		if (!scan->mm_slot)
 			pass_through_head++;
-		if (khugepaged_has_work() &&
+		if (khugepaged_has_work(scan) &&
 		    pass_through_head < 2)
-			progress += khugepaged_scan_mm_slot(pages - progress,
-							    &result, cc);
+			progress += khugepaged_scan_mm_slot(scan, pages - progress,
+							    &result);
 		else
 			progress = pages;
 		spin_unlock(&khugepaged_mm_lock);
@@ -2560,53 +2648,83 @@ static void khugepaged_do_scan(struct collapse_control *cc)
 	}
 }
 
-static bool khugepaged_should_wakeup(void)
+static bool khugepaged_should_wakeup(struct khugepaged_scan *scan)
 {
 	return kthread_should_stop() ||
-	       time_after_eq(jiffies, khugepaged_sleep_expire);
+	       time_after_eq(jiffies, READ_ONCE(scan->sleep_expire));
 }
 
-static void khugepaged_wait_work(void)
+static void khugepaged_wait_work(struct khugepaged_scan *scan)
 {
-	if (khugepaged_has_work()) {
+	if (khugepaged_has_work(scan)) {
 		const unsigned long scan_sleep_jiffies =
 			msecs_to_jiffies(khugepaged_scan_sleep_millisecs);
 
 		if (!scan_sleep_jiffies)
 			return;
 
-		khugepaged_sleep_expire = jiffies + scan_sleep_jiffies;
+		WRITE_ONCE(scan->sleep_expire, jiffies + scan_sleep_jiffies);
 		wait_event_freezable_timeout(khugepaged_wait,
-					     khugepaged_should_wakeup(),
+					     khugepaged_should_wakeup(scan),
 					     scan_sleep_jiffies);
 		return;
 	}
 
 	if (hugepage_pmd_enabled())
-		wait_event_freezable(khugepaged_wait, khugepaged_wait_event());
+		wait_event_freezable(khugepaged_wait,
+				     khugepaged_wait_event(scan));
 }
 
-static int khugepaged(void *none)
+static int khugepaged(void *data)
 {
+	struct khugepaged_scan *scan = data;
+	const struct cpumask *cpumask = cpumask_of_node(scan->nid);
 	struct khugepaged_mm_slot *mm_slot;
 
+	if (!cpumask_empty(cpumask))
+		set_cpus_allowed_ptr(current, cpumask);
+
 	set_freezable();
 	set_user_nice(current, MAX_NICE);
 
 	while (!kthread_should_stop()) {
-		khugepaged_do_scan(&khugepaged_collapse_control);
-		khugepaged_wait_work();
+		khugepaged_do_scan(scan);
+		khugepaged_wait_work(scan);
 	}
 
 	spin_lock(&khugepaged_mm_lock);
-	mm_slot = khugepaged_scan.mm_slot;
-	khugepaged_scan.mm_slot = NULL;
+	mm_slot = scan->mm_slot;
+	scan->mm_slot = NULL;
 	if (mm_slot)
 		collect_mm_slot(mm_slot);
 	spin_unlock(&khugepaged_mm_lock);
 	return 0;
 }
 
+static bool khugepaged_running(void)
+{
+	int nid;
+
+	for_each_node(nid)
+		if (khugepaged_scans[nid]->thread)
+			return true;
+	return false;
+}
+
+static void khugepaged_stop_all(void)
+{
+	struct khugepaged_scan *scan;
+	int nid;
+
+	for_each_node(nid) {
+		scan = khugepaged_scans[nid];
+		if (scan->thread) {
+			kthread_stop(scan->thread);
+			WRITE_ONCE(scan->thread, NULL);
+		}
+	}
+}
+
 static void set_recommended_min_free_kbytes(void)
 {
 	struct zone *zone;
@@ -2660,25 +2778,32 @@ static void set_recommended_min_free_kbytes(void)
 
 int start_stop_khugepaged(void)
 {
-	int err = 0;
+	struct khugepaged_scan *scan;
+	struct task_struct *thread;
+	int nid, err = 0;
 
 	mutex_lock(&khugepaged_mutex);
 	if (hugepage_pmd_enabled()) {
-		if (!khugepaged_thread)
-			khugepaged_thread = kthread_run(khugepaged, NULL,
-							"khugepaged");
-		if (IS_ERR(khugepaged_thread)) {
-			pr_err("khugepaged: kthread_run(khugepaged) failed\n");
-			err = PTR_ERR(khugepaged_thread);
-			khugepaged_thread = NULL;
-			goto fail;
-		}
-
-		if (!list_empty(&khugepaged_scan.mm_head))
-			wake_up_interruptible(&khugepaged_wait);
-	} else if (khugepaged_thread) {
-		kthread_stop(khugepaged_thread);
-		khugepaged_thread = NULL;
+		for_each_online_node(nid) {
+			scan = khugepaged_scans[nid];
+			if (scan->thread)
+				continue;
+			thread = kthread_create_on_node(khugepaged, scan, nid,
+							"khugepaged%d", nid);
+			if (IS_ERR(thread)) {
+				pr_err("khugepaged: kthread_create(khugepaged%d) failed\n",
+				       nid);
+				err = PTR_ERR(thread);
+				khugepaged_stop_all();
+				goto fail;
+			}
+			WRITE_ONCE(scan->thread, thread);
+			wake_up_process(thread);
+		}
+
+		wake_up_interruptible(&khugepaged_wait);
+	} else {
+		khugepaged_stop_all();
 	}
 	set_recommended_min_free_kbytes();
 fail:
@@ -2689,7 +2814,7 @@ int start_stop_khugepaged(void)
 void khugepaged_min_free_kbytes_update(void)
 {
 	mutex_lock(&khugepaged_mutex);
-	if (hugepage_pmd_enabled() && khugepaged_thread)
+	if (hugepage_pmd_enabled() && khugepaged_running())
 		set_recommended_min_free_kbytes();
 	mutex_unlock(&khugepaged_mutex);
 }
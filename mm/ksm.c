@@ -122,10 +122,12 @@ typedef u8 rmap_age_t;
  * struct ksm_mm_slot - ksm information per mm that is being scanned
  * @slot: hash lookup from mm to mm_slot
  * @rmap_list: head for this mm_slot's singly-linked list of rmap_items
+ * @id: sequence number used to pick the scan worker owning this mm_slot
  */
 struct ksm_mm_slot {
 	struct mm_slot slot;
 	struct ksm_rmap_item *rmap_list;
+	unsigned int id;
 };
 
 /**
@@ -133,15 +135,28 @@ struct ksm_mm_slot {
  * @mm_slot: the current mm_slot we are scanning
  * @address: the next address inside that to be scanned
  * @rmap_list: link to the next rmap to be scanned in the rmap_list
- * @seqnr: count of completed full scans (needed when removing unstable node)
+ * @id: index of the scan worker owning this cursor
+ * @pass_done: this worker has finished the current full scan
+ * @thread: the scan worker
+ * @pages_scanned: number of pages scanned by this worker
+ * @pages_merged: number of pages merged by this worker
+ * @pass_merged: number of pages merged in the current full scan
+ * @last_pass_merged: number of pages merged in the previous full scan
  *
- * There is only the one ksm_scan instance of this cursor structure.
+ * There is one ksm_scan cursor per scan worker. Each worker only scans the
+ * mm_slots it owns, and all workers complete a full scan together.
  */
 struct ksm_scan {
 	struct ksm_mm_slot *mm_slot;
 	unsigned long address;
 	struct ksm_rmap_item **rmap_list;
-	unsigned long seqnr;
+	unsigned int id;
+	bool pass_done;
+	struct task_struct *thread;
+	unsigned long pages_scanned;
+	unsigned long pages_merged;
+	unsigned long pass_merged;
+	unsigned long last_pass_merged;
 };
 
 /**
@@ -154,6 +169,7 @@ struct ksm_scan {
  * @kpfn: page frame number of this ksm page (perhaps temporarily on wrong nid)
  * @chain_prune_time: time of the last full garbage collection
  * @rmap_hlist_len: number of rmap_item entries in hlist or STABLE_NODE_CHAIN
+ * @checksum: checksum of the ksm page contents, first key of the stable tree
  * @nid: NUMA node id of stable tree in which linked (may not match kpfn)
  */
 struct ksm_stable_node {
@@ -179,6 +195,7 @@ struct ksm_stable_node {
 	 */
 #define STABLE_NODE_CHAIN -1024
 	int rmap_hlist_len;
+	unsigned int checksum;
 #ifdef CONFIG_NUMA
 	int nid;
 #endif
@@ -240,10 +257,36 @@ static DEFINE_HASHTABLE(mm_slots_hash, MM_SLOTS_HASH_BITS);
 static struct ksm_mm_slot ksm_mm_head = {
 	.slot.mm_node = LIST_HEAD_INIT(ksm_mm_head.slot.mm_node),
 };
-static struct ksm_scan ksm_scan = {
-	.mm_slot = &ksm_mm_head,
+
+/* Maximum number of scan workers */
+#define KSM_MAX_SCAN_WORKERS	16
+
+static struct ksm_scan ksm_scans[KSM_MAX_SCAN_WORKERS] = {
+	[0 ... KSM_MAX_SCAN_WORKERS - 1] = { .mm_slot = &ksm_mm_head },
 };
 
+/*
+ * Number of workers taking part in the current full scan. Written with both
+ * ksm_tree_mutex and ksm_mmlist_lock held, so holding either is enough to
+ * read it; lockless readers use READ_ONCE().
+ */
+static unsigned int ksm_nr_scan_workers = 1;
+
+/* Number of workers requested, applied when the next full scan starts */
+static unsigned int ksm_scan_workers = 1;
+
+/* Workers which have not finished the current full scan yet */
+static unsigned int ksm_scans_running;
+
+/* Whether the current full scan has been started */
+static bool ksm_scan_started;
+
+/* Count of completed full scans (needed when removing unstable node) */
+static unsigned long ksm_scan_seqnr;
+
+/* Next mm_slot id, spreads mm_slots over the scan workers */
+static unsigned int ksm_mm_slot_id;
+
 static struct kmem_cache *rmap_item_cache;
 static struct kmem_cache *stable_node_cache;
 static struct kmem_cache *mm_slot_cache;
@@ -251,8 +294,6 @@ static struct kmem_cache *mm_slot_cache;
 /* Default number of pages to scan per batch */
 #define DEFAULT_PAGES_TO_SCAN 100
 
-/* The number of pages scanned */
-static unsigned long ksm_pages_scanned;
 
 /* The number of nodes in the stable tree */
 static unsigned long ksm_pages_shared;
@@ -264,7 +305,7 @@ static unsigned long ksm_pages_sharing;
 static unsigned long ksm_pages_unshared;
 
 /* The number of rmap_items in use: to calculate pages_volatile */
-static unsigned long ksm_rmap_items;
+static atomic_long_t ksm_rmap_items = ATOMIC_LONG_INIT(0);
 
 /* The number of stable_node chains */
 static unsigned long ksm_stable_node_chains;
@@ -378,6 +419,19 @@ static unsigned long ewma(unsigned long prev, unsigned long curr)
 	return ((100 - EWMA_WEIGHT) * prev + EWMA_WEIGHT * curr) / 100;
 }
 
+/* CPU time consumed by the scan workers */
+static unsigned long long ksm_scan_workers_runtime(void)
+{
+	unsigned long long runtime = 0;
+	unsigned int i;
+
+	for (i = 0; i < READ_ONCE(ksm_nr_scan_workers); i++)
+		if (ksm_scans[i].thread)
+			runtime += task_sched_runtime(ksm_scans[i].thread);
+
+	return runtime;
+}
+
 /*
  * The scan time advisor is based on the current scan rate and the target
  * scan rate.
@@ -417,8 +471,8 @@ static void scan_time_advisor(void)
 			    MSEC_PER_SEC);
 	scan_time = scan_time ? scan_time : 1;
 
-	/* Calculate CPU consumption of ksmd background thread */
-	cpu_time = task_sched_runtime(current);
+	/* Calculate CPU consumption of the ksmd background threads */
+	cpu_time = ksm_scan_workers_runtime();
 	cpu_time_diff = cpu_time - advisor_ctx.cpu_time;
 	cpu_time_diff_ms = cpu_time_diff / 1000 / 1000;
 
@@ -484,7 +538,10 @@ static void wait_while_offlining(void);
 
 static DECLARE_WAIT_QUEUE_HEAD(ksm_thread_wait);
 static DECLARE_WAIT_QUEUE_HEAD(ksm_iter_wait);
-static DEFINE_MUTEX(ksm_thread_mutex);
+/* Held for read by the scan workers, for write by the control paths */
+static DECLARE_RWSEM(ksm_thread_sem);
+/* Serializes the scan workers on the stable and unstable trees */
+static DEFINE_MUTEX(ksm_tree_mutex);
 static DEFINE_SPINLOCK(ksm_mmlist_lock);
 
 static int __init ksm_slab_init(void)
@@ -565,13 +622,13 @@ static inline struct ksm_rmap_item *alloc_rmap_item(void)
 	rmap_item = kmem_cache_zalloc(rmap_item_cache, GFP_KERNEL |
 						__GFP_NORETRY | __GFP_NOWARN);
 	if (rmap_item)
-		ksm_rmap_items++;
+		atomic_long_inc(&ksm_rmap_items);
 	return rmap_item;
 }
 
 static inline void free_rmap_item(struct ksm_rmap_item *rmap_item)
 {
-	ksm_rmap_items--;
+	atomic_long_dec(&ksm_rmap_items);
 	rmap_item->mm->ksm_rmap_items--;
 	rmap_item->mm = NULL;	/* debug safety */
 	kmem_cache_free(rmap_item_cache, rmap_item);
@@ -782,6 +839,7 @@ static struct ksm_stable_node *alloc_stable_node_chain(struct ksm_stable_node *d
 		INIT_HLIST_HEAD(&chain->hlist);
 		chain->chain_prune_time = jiffies;
 		chain->rmap_hlist_len = STABLE_NODE_CHAIN;
+		chain->checksum = dup->checksum;
 #if defined (CONFIG_DEBUG_VM) && defined(CONFIG_NUMA)
 		chain->nid = NUMA_NO_NODE; /* debug */
 #endif
@@ -999,7 +1057,7 @@ static void remove_rmap_item_from_tree(struct ksm_rmap_item *rmap_item)
 		 * if this rmap_item was inserted by this scan, rather
 		 * than left over from before.
 		 */
-		age = (unsigned char)(ksm_scan.seqnr - rmap_item->address);
+		age = (unsigned char)(ksm_scan_seqnr - rmap_item->address);
 		BUG_ON(age > 1);
 		if (!age)
 			rb_erase(&rmap_item->node,
@@ -1013,12 +1071,17 @@ static void remove_rmap_item_from_tree(struct ksm_rmap_item *rmap_item)
 
 static void remove_trailing_rmap_items(struct ksm_rmap_item **rmap_list)
 {
+	if (!*rmap_list)
+		return;
+
+	mutex_lock(&ksm_tree_mutex);
 	while (*rmap_list) {
 		struct ksm_rmap_item *rmap_item = *rmap_list;
 		*rmap_list = rmap_item->rmap_list;
 		remove_rmap_item_from_tree(rmap_item);
 		free_rmap_item(rmap_item);
 	}
+	mutex_unlock(&ksm_tree_mutex);
 }
 
 /*
@@ -1162,22 +1225,49 @@ static int remove_all_stable_nodes(void)
 	return err;
 }
 
+/*
+ * Restart all scan workers from the head of the mm list, with a new full
+ * scan. Until that starts, all mm_slots belong to the first worker, whose
+ * cursor unmerge_and_remove_all_rmap_items() uses. Called with
+ * ksm_thread_sem held for write.
+ */
+static void reset_scan_workers(void)
+{
+	unsigned int i;
+
+	mutex_lock(&ksm_tree_mutex);
+	spin_lock(&ksm_mmlist_lock);
+	WRITE_ONCE(ksm_nr_scan_workers, 1);
+	for (i = 0; i < KSM_MAX_SCAN_WORKERS; i++) {
+		ksm_scans[i].mm_slot = &ksm_mm_head;
+		ksm_scans[i].pass_done = false;
+	}
+	spin_unlock(&ksm_mmlist_lock);
+
+	ksm_scans_running = 0;
+	ksm_scan_started = false;
+	mutex_unlock(&ksm_tree_mutex);
+}
+
 static int unmerge_and_remove_all_rmap_items(void)
 {
+	struct ksm_scan *scan = &ksm_scans[0];
 	struct ksm_mm_slot *mm_slot;
 	struct mm_slot *slot;
 	struct mm_struct *mm;
 	struct vm_area_struct *vma;
 	int err = 0;
 
+	/* The first cursor protects the mm_slot being unmerged from exit */
+	reset_scan_workers();
 	spin_lock(&ksm_mmlist_lock);
 	slot = list_entry(ksm_mm_head.slot.mm_node.next,
 			  struct mm_slot, mm_node);
-	ksm_scan.mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
+	scan->mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
 	spin_unlock(&ksm_mmlist_lock);
 
-	for (mm_slot = ksm_scan.mm_slot; mm_slot != &ksm_mm_head;
-	     mm_slot = ksm_scan.mm_slot) {
+	for (mm_slot = scan->mm_slot; mm_slot != &ksm_mm_head;
+	     mm_slot = scan->mm_slot) {
 		VMA_ITERATOR(vmi, mm_slot->slot.mm, 0);
 
 		mm = mm_slot->slot.mm;
@@ -1206,7 +1296,7 @@ static int unmerge_and_remove_all_rmap_items(void)
 		spin_lock(&ksm_mmlist_lock);
 		slot = list_entry(mm_slot->slot.mm_node.next,
 				  struct mm_slot, mm_node);
-		ksm_scan.mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
+		scan->mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
 		if (ksm_test_exit(mm)) {
 			hash_del(&mm_slot->slot.hash);
 			list_del(&mm_slot->slot.mm_node);
@@ -1222,14 +1312,12 @@ static int unmerge_and_remove_all_rmap_items(void)
 
 	/* Clean up stable nodes, but don't worry if some are still busy */
 	remove_all_stable_nodes();
-	ksm_scan.seqnr = 0;
+	ksm_scan_seqnr = 0;
 	return 0;
 
 error:
 	mmap_read_unlock(mm);
-	spin_lock(&ksm_mmlist_lock);
-	ksm_scan.mm_slot = &ksm_mm_head;
-	spin_unlock(&ksm_mmlist_lock);
+	reset_scan_workers();
 	return err;
 }
 #endif /* CONFIG_SYSFS */
@@ -1787,16 +1875,30 @@ static __always_inline struct folio *chain(struct ksm_stable_node **s_n_d,
 	return __stable_node_chain(s_n_d, s_n, root, false);
 }
 
+/*
+ * The stable and unstable trees are ordered by page checksum first and by
+ * page contents second: a tree walk only needs to look up and compare the
+ * pages of nodes with a matching checksum.
+ */
+static inline int cmp_checksum(unsigned int checksum, unsigned int tree_checksum)
+{
+	if (checksum < tree_checksum)
+		return -1;
+	return checksum > tree_checksum;
+}
+
 /*
  * stable_tree_search - search for page inside the stable tree
  *
  * This function checks if there is a page inside the stable tree
  * with identical content to the page that we are scanning right now.
+ * @checksum is the checksum of the page contents.
  *
  * This function returns the stable tree node of identical content if found,
  * -EBUSY if the stable node's page is being migrated, NULL otherwise.
  */
-static struct folio *stable_tree_search(struct page *page)
+static struct folio *stable_tree_search(struct page *page,
+					unsigned int checksum)
 {
 	int nid;
 	struct rb_root *root;
@@ -1826,6 +1928,13 @@ static struct folio *stable_tree_search(struct page *page)
 
 		cond_resched();
 		stable_node = rb_entry(*new, struct ksm_stable_node, node);
+		ret = cmp_checksum(checksum, stable_node->checksum);
+		if (ret) {
+			parent = *new;
+			new = ret < 0 ? &parent->rb_left : &parent->rb_right;
+			continue;
+		}
+
 		tree_folio = chain_prune(&stable_node_dup, &stable_node, root);
 		if (!tree_folio) {
 			/*
@@ -2019,10 +2128,13 @@ static struct ksm_stable_node *stable_tree_insert(struct folio *kfolio)
 	struct rb_node *parent;
 	struct ksm_stable_node *stable_node, *stable_node_dup;
 	bool need_chain = false;
+	unsigned int checksum;
 
 	kpfn = folio_pfn(kfolio);
 	nid = get_kpfn_nid(kpfn);
 	root = root_stable_tree + nid;
+	/* The ksm page is write protected, its contents can't change anymore */
+	checksum = calc_checksum(&kfolio->page);
 again:
 	parent = NULL;
 	new = &root->rb_node;
@@ -2033,6 +2145,13 @@ static struct ksm_stable_node *stable_tree_insert(struct folio *kfolio)
 
 		cond_resched();
 		stable_node = rb_entry(*new, struct ksm_stable_node, node);
+		ret = cmp_checksum(checksum, stable_node->checksum);
+		if (ret) {
+			parent = *new;
+			new = ret < 0 ? &parent->rb_left : &parent->rb_right;
+			continue;
+		}
+
 		tree_folio = chain(&stable_node_dup, &stable_node, root);
 		if (!tree_folio) {
 			/*
@@ -2068,6 +2187,7 @@ static struct ksm_stable_node *stable_tree_insert(struct folio *kfolio)
 	INIT_HLIST_HEAD(&stable_node_dup->hlist);
 	stable_node_dup->kpfn = kpfn;
 	stable_node_dup->rmap_hlist_len = 0;
+	stable_node_dup->checksum = checksum;
 	DO_NUMA(stable_node_dup->nid = nid);
 	if (!need_chain) {
 		rb_link_node(&stable_node_dup->node, parent, new);
@@ -2102,11 +2222,13 @@ static struct ksm_stable_node *stable_tree_insert(struct folio *kfolio)
  * to the currently scanned page, NULL otherwise.
  *
  * This function does both searching and inserting, because they share
- * the same walking algorithm in an rbtree.
+ * the same walking algorithm in an rbtree. @checksum is the checksum of
+ * the page contents, and becomes the key of @rmap_item when inserted.
  */
 static
 struct ksm_rmap_item *unstable_tree_search_insert(struct ksm_rmap_item *rmap_item,
 					      struct page *page,
+					      unsigned int checksum,
 					      struct page **tree_pagep)
 {
 	struct rb_node **new;
@@ -2125,6 +2247,13 @@ struct ksm_rmap_item *unstable_tree_search_insert(struct ksm_rmap_item *rmap_ite
 
 		cond_resched();
 		tree_rmap_item = rb_entry(*new, struct ksm_rmap_item, node);
+		ret = cmp_checksum(checksum, tree_rmap_item->oldchecksum);
+		if (ret) {
+			parent = *new;
+			new = ret < 0 ? &parent->rb_left : &parent->rb_right;
+			continue;
+		}
+
 		tree_page = get_mergeable_page(tree_rmap_item);
 		if (!tree_page)
 			return NULL;
@@ -2161,8 +2290,9 @@ struct ksm_rmap_item *unstable_tree_search_insert(struct ksm_rmap_item *rmap_ite
 		}
 	}
 
+	rmap_item->oldchecksum = checksum;
 	rmap_item->address |= UNSTABLE_FLAG;
-	rmap_item->address |= (ksm_scan.seqnr & SEQNR_MASK);
+	rmap_item->address |= (ksm_scan_seqnr & SEQNR_MASK);
 	DO_NUMA(rmap_item->nid = nid);
 	rb_link_node(&rmap_item->node, parent, new);
 	rb_insert_color(&rmap_item->node, root);
@@ -2210,27 +2340,40 @@ static void stable_tree_append(struct ksm_rmap_item *rmap_item,
 	rmap_item->mm->ksm_merging_pages++;
 }
 
+static inline void ksm_scan_merged(struct ksm_scan *scan)
+{
+	scan->pages_merged++;
+	scan->pass_merged++;
+}
+
 /*
- * cmp_and_merge_page - first see if page can be merged into the stable tree;
+ * __cmp_and_merge_page - first see if page can be merged into the stable tree;
  * if not, compare checksum to previous and if it's the same, see if page can
  * be inserted into the unstable tree, or merged with a page already there and
  * both transferred to the stable tree.
  *
+ * @scan: the scan worker
  * @page: the page that we are searching identical page to.
  * @rmap_item: the reverse mapping into the virtual address of this page
+ * @checksum: checksum of @page, when @hashed
+ * @hashed: whether @checksum has been calculated
+ *
+ * Called with ksm_tree_mutex held.
  */
-static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_item)
+static void __cmp_and_merge_page(struct ksm_scan *scan, struct page *page,
+				 struct ksm_rmap_item *rmap_item,
+				 unsigned int checksum, bool hashed)
 {
 	struct ksm_rmap_item *tree_rmap_item;
 	struct page *tree_page = NULL;
 	struct ksm_stable_node *stable_node;
 	struct folio *kfolio;
-	unsigned int checksum;
 	int err;
 	bool max_page_sharing_bypass = false;
 
 	stable_node = page_stable_node(page);
 	if (stable_node) {
+		checksum = stable_node->checksum;
 		if (stable_node->head != &migrate_nodes &&
 		    get_kpfn_nid(READ_ONCE(stable_node->kpfn)) !=
 		    NUMA(stable_node->nid)) {
@@ -2256,7 +2399,8 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 		 * don't want to insert it in the unstable tree, and we don't want
 		 * to waste our time searching for something identical to it there.
 		 */
-		checksum = calc_checksum(page);
+		if (unlikely(!hashed))
+			checksum = calc_checksum(page);
 		if (rmap_item->oldchecksum != checksum) {
 			rmap_item->oldchecksum = checksum;
 			return;
@@ -2267,7 +2411,7 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 	}
 
 	/* Start by searching for the folio in the stable tree */
-	kfolio = stable_tree_search(page);
+	kfolio = stable_tree_search(page, checksum);
 	if (&kfolio->page == page && rmap_item->head == stable_node) {
 		folio_put(kfolio);
 		return;
@@ -2289,13 +2433,15 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 			stable_tree_append(rmap_item, folio_stable_node(kfolio),
 					   max_page_sharing_bypass);
 			folio_unlock(kfolio);
+			ksm_scan_merged(scan);
 		}
 		folio_put(kfolio);
 		return;
 	}
 
 	tree_rmap_item =
-		unstable_tree_search_insert(rmap_item, page, &tree_page);
+		unstable_tree_search_insert(rmap_item, page, checksum,
+					    &tree_page);
 	if (tree_rmap_item) {
 		bool split;
 
@@ -2326,6 +2472,7 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 						   false);
 				stable_tree_append(rmap_item, stable_node,
 						   false);
+				ksm_scan_merged(scan);
 			}
 			folio_unlock(kfolio);
 
@@ -2357,6 +2504,28 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 	}
 }
 
+/*
+ * cmp_and_merge_page - merge @page through the stable or unstable tree
+ *
+ * The page is hashed before taking ksm_tree_mutex, so that the workers only
+ * serialize on the tree walks and merges.
+ */
+static void cmp_and_merge_page(struct ksm_scan *scan, struct page *page,
+			       struct ksm_rmap_item *rmap_item)
+{
+	unsigned int checksum = 0;
+	bool hashed = false;
+
+	if (!page_stable_node(page)) {
+		checksum = calc_checksum(page);
+		hashed = true;
+	}
+
+	mutex_lock(&ksm_tree_mutex);
+	__cmp_and_merge_page(scan, page, rmap_item, checksum, hashed);
+	mutex_unlock(&ksm_tree_mutex);
+}
+
 static struct ksm_rmap_item *get_next_rmap_item(struct ksm_mm_slot *mm_slot,
 					    struct ksm_rmap_item **rmap_list,
 					    unsigned long addr)
@@ -2370,7 +2539,9 @@ static struct ksm_rmap_item *get_next_rmap_item(struct ksm_mm_slot *mm_slot,
 		if (rmap_item->address > addr)
 			break;
 		*rmap_list = rmap_item->rmap_list;
+		mutex_lock(&ksm_tree_mutex);
 		remove_rmap_item_from_tree(rmap_item);
+		mutex_unlock(&ksm_tree_mutex);
 		free_rmap_item(rmap_item);
 	}
 
@@ -2448,13 +2619,147 @@ static bool should_skip_rmap_item(struct folio *folio,
 	}
 
 	/* Skip this page */
-	ksm_pages_skipped++;
 	rmap_item->remaining_skips--;
+	mutex_lock(&ksm_tree_mutex);
+	ksm_pages_skipped++;
 	remove_rmap_item_from_tree(rmap_item);
+	mutex_unlock(&ksm_tree_mutex);
 	return true;
 }
 
-static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
+static inline struct ksm_scan *mm_slot_scan(struct ksm_mm_slot *mm_slot)
+{
+	return &ksm_scans[mm_slot->id % ksm_nr_scan_workers];
+}
+
+/*
+ * Return the next mm_slot after @mm_slot that is owned by @scan, or
+ * &ksm_mm_head at the end of the list. Called with ksm_mmlist_lock held.
+ */
+static struct ksm_mm_slot *next_scan_mm_slot(struct ksm_scan *scan,
+					     struct ksm_mm_slot *mm_slot)
+{
+	struct mm_slot *slot;
+
+	do {
+		slot = list_entry(mm_slot->slot.mm_node.next,
+				  struct mm_slot, mm_node);
+		mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
+	} while (mm_slot != &ksm_mm_head && mm_slot_scan(mm_slot) != scan);
+
+	return mm_slot;
+}
+
+/* Whether any scan worker is at @mm_slot. Called with ksm_mmlist_lock held. */
+static bool mm_slot_is_scanned(struct ksm_mm_slot *mm_slot)
+{
+	unsigned int i;
+
+	for (i = 0; i < KSM_MAX_SCAN_WORKERS; i++)
+		if (ksm_scans[i].mm_slot == mm_slot)
+			return true;
+
+	return false;
+}
+
+/*
+ * Start a full scan for all scan workers, by the first worker to get there.
+ * Called with ksm_tree_mutex held.
+ */
+static void start_full_scan(void)
+{
+	unsigned int i, nr_workers = ksm_nr_scan_workers;
+	int nid;
+
+	/*
+	 * The previous full scan is complete, so every worker's cursor is at
+	 * the head of the mm list: changing the number of workers, and with
+	 * it mm_slot_scan(), can't move an mm_slot away from a worker that is
+	 * scanning it. Workers dropped from the scan stop in ksmd_should_run().
+	 */
+	spin_lock(&ksm_mmlist_lock);
+	WRITE_ONCE(ksm_nr_scan_workers, READ_ONCE(ksm_scan_workers));
+	spin_unlock(&ksm_mmlist_lock);
+
+	advisor_start_scan();
+	trace_ksm_start_scan(ksm_scan_seqnr,
+			     atomic_long_read(&ksm_rmap_items));
+
+	/*
+	 * A number of pages can hang around indefinitely in per-cpu
+	 * LRU cache, raised page count preventing write_protect_page
+	 * from merging them.  Though it doesn't really matter much,
+	 * it is puzzling to see some stuck in pages_volatile until
+	 * other activity jostles them out, and they also prevented
+	 * LTP's KSM test from succeeding deterministically; so drain
+	 * them here (here rather than on entry to ksm_do_scan(),
+	 * so we don't IPI too often when pages_to_scan is set low).
+	 */
+	lru_add_drain_all();
+
+	/*
+	 * Whereas stale stable_nodes on the stable_tree itself
+	 * get pruned in the regular course of stable_tree_search(),
+	 * those moved out to the migrate_nodes list can accumulate:
+	 * so prune them once before each full scan.
+	 */
+	if (!ksm_merge_across_nodes) {
+		struct ksm_stable_node *stable_node, *next;
+		struct folio *folio;
+
+		list_for_each_entry_safe(stable_node, next,
+					 &migrate_nodes, list) {
+			folio = ksm_get_folio(stable_node,
+					      KSM_GET_FOLIO_NOLOCK);
+			if (folio)
+				folio_put(folio);
+			cond_resched();
+		}
+	}
+
+	for (nid = 0; nid < ksm_nr_node_ids; nid++)
+		root_unstable_tree[nid] = RB_ROOT;
+
+	for (i = 0; i < ksm_nr_scan_workers; i++)
+		ksm_scans[i].pass_merged = 0;
+	ksm_scans_running = ksm_nr_scan_workers;
+	ksm_scan_started = true;
+
+	/* Wake up the workers which just became part of the scan */
+	if (ksm_nr_scan_workers > nr_workers)
+		wake_up_interruptible(&ksm_thread_wait);
+}
+
+/*
+ * Called by each scan worker when it reaches the end of the mm list. The
+ * last worker to finish the full scan completes it for everybody: nobody
+ * starts the next one before that, as rmap_items in the unstable tree must
+ * not be more than one full scan old.
+ */
+static void finish_full_scan(struct ksm_scan *scan)
+{
+	unsigned int i;
+
+	mutex_lock(&ksm_tree_mutex);
+	WRITE_ONCE(scan->pass_done, true);
+	if (!--ksm_scans_running) {
+		advisor_stop_scan();
+		trace_ksm_stop_scan(ksm_scan_seqnr,
+				    atomic_long_read(&ksm_rmap_items));
+		ksm_scan_seqnr++;
+
+		for (i = 0; i < ksm_nr_scan_workers; i++) {
+			ksm_scans[i].last_pass_merged = ksm_scans[i].pass_merged;
+			WRITE_ONCE(ksm_scans[i].pass_done, false);
+		}
+		ksm_scan_started = false;
+		wake_up_interruptible(&ksm_thread_wait);
+	}
+	mutex_unlock(&ksm_tree_mutex);
+}
+
+static struct ksm_rmap_item *scan_get_next_rmap_item(struct ksm_scan *scan,
+						     struct page **page)
 {
 	struct mm_struct *mm;
 	struct ksm_mm_slot *mm_slot;
@@ -2462,71 +2767,36 @@ static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
 	struct vm_area_struct *vma;
 	struct ksm_rmap_item *rmap_item;
 	struct vma_iterator vmi;
-	int nid;
 
 	if (list_empty(&ksm_mm_head.slot.mm_node))
 		return NULL;
 
-	mm_slot = ksm_scan.mm_slot;
+	mm_slot = scan->mm_slot;
 	if (mm_slot == &ksm_mm_head) {
-		advisor_start_scan();
-		trace_ksm_start_scan(ksm_scan.seqnr, ksm_rmap_items);
-
-		/*
-		 * A number of pages can hang around indefinitely in per-cpu
-		 * LRU cache, raised page count preventing write_protect_page
-		 * from merging them.  Though it doesn't really matter much,
-		 * it is puzzling to see some stuck in pages_volatile until
-		 * other activity jostles them out, and they also prevented
-		 * LTP's KSM test from succeeding deterministically; so drain
-		 * them here (here rather than on entry to ksm_do_scan(),
-		 * so we don't IPI too often when pages_to_scan is set low).
-		 */
-		lru_add_drain_all();
-
-		/*
-		 * Whereas stale stable_nodes on the stable_tree itself
-		 * get pruned in the regular course of stable_tree_search(),
-		 * those moved out to the migrate_nodes list can accumulate:
-		 * so prune them once before each full scan.
-		 */
-		if (!ksm_merge_across_nodes) {
-			struct ksm_stable_node *stable_node, *next;
-			struct folio *folio;
-
-			list_for_each_entry_safe(stable_node, next,
-						 &migrate_nodes, list) {
-				folio = ksm_get_folio(stable_node,
-						      KSM_GET_FOLIO_NOLOCK);
-				if (folio)
-					folio_put(folio);
-				cond_resched();
-			}
-		}
-
-		for (nid = 0; nid < ksm_nr_node_ids; nid++)
-			root_unstable_tree[nid] = RB_ROOT;
+		mutex_lock(&ksm_tree_mutex);
+		if (!ksm_scan_started)
+			start_full_scan();
+		mutex_unlock(&ksm_tree_mutex);
 
 		spin_lock(&ksm_mmlist_lock);
-		slot = list_entry(mm_slot->slot.mm_node.next,
-				  struct mm_slot, mm_node);
-		mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
-		ksm_scan.mm_slot = mm_slot;
+		mm_slot = next_scan_mm_slot(scan, mm_slot);
+		scan->mm_slot = mm_slot;
 		spin_unlock(&ksm_mmlist_lock);
 		/*
-		 * Although we tested list_empty() above, a racing __ksm_exit
-		 * of the last mm on the list may have removed it since then.
+		 * This worker may not own any mm_slot; also, although we
+		 * tested list_empty() above, a racing __ksm_exit of the last
+		 * mm on the list may have removed it since then.
 		 */
 		if (mm_slot == &ksm_mm_head)
-			return NULL;
+			goto done;
 next_mm:
-		ksm_scan.address = 0;
-		ksm_scan.rmap_list = &mm_slot->rmap_list;
+		scan->address = 0;
+		scan->rmap_list = &mm_slot->rmap_list;
 	}
 
 	slot = &mm_slot->slot;
 	mm = slot->mm;
-	vma_iter_init(&vmi, mm, ksm_scan.address);
+	vma_iter_init(&vmi, mm, scan->address);
 
 	mmap_read_lock(mm);
 	if (ksm_test_exit(mm))
@@ -2535,12 +2805,12 @@ static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
 	for_each_vma(vmi, vma) {
 		if (!(vma->vm_flags & VM_MERGEABLE))
 			continue;
-		if (ksm_scan.address < vma->vm_start)
-			ksm_scan.address = vma->vm_start;
+		if (scan->address < vma->vm_start)
+			scan->address = vma->vm_start;
 		if (!vma->anon_vma)
-			ksm_scan.address = vma->vm_end;
+			scan->address = vma->vm_end;
 
-		while (ksm_scan.address < vma->vm_end) {
+		while (scan->address < vma->vm_end) {
 			struct page *tmp_page = NULL;
 			struct folio_walk fw;
 			struct folio *folio;
@@ -2548,7 +2818,7 @@ static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
 			if (ksm_test_exit(mm))
 				break;
 
-			folio = folio_walk_start(&fw, vma, ksm_scan.address, 0);
+			folio = folio_walk_start(&fw, vma, scan->address, 0);
 			if (folio) {
 				if (!folio_is_zone_device(folio) &&
 				     folio_test_anon(folio)) {
@@ -2559,12 +2829,12 @@ static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
 			}
 
 			if (tmp_page) {
-				flush_anon_page(vma, tmp_page, ksm_scan.address);
+				flush_anon_page(vma, tmp_page, scan->address);
 				flush_dcache_page(tmp_page);
 				rmap_item = get_next_rmap_item(mm_slot,
-					ksm_scan.rmap_list, ksm_scan.address);
+					scan->rmap_list, scan->address);
 				if (rmap_item) {
-					ksm_scan.rmap_list =
+					scan->rmap_list =
 							&rmap_item->rmap_list;
 
 					if (should_skip_rmap_item(folio, rmap_item)) {
@@ -2572,7 +2842,7 @@ static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
 						goto next_page;
 					}
 
-					ksm_scan.address += PAGE_SIZE;
+					scan->address += PAGE_SIZE;
 					*page = tmp_page;
 				} else {
 					folio_put(folio);
@@ -2581,27 +2851,25 @@ static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
 				return rmap_item;
 			}
 next_page:
-			ksm_scan.address += PAGE_SIZE;
+			scan->address += PAGE_SIZE;
 			cond_resched();
 		}
 	}
 
 	if (ksm_test_exit(mm)) {
 no_vmas:
-		ksm_scan.address = 0;
-		ksm_scan.rmap_list = &mm_slot->rmap_list;
+		scan->address = 0;
+		scan->rmap_list = &mm_slot->rmap_list;
 	}
 	/*
 	 * Nuke all the rmap_items that are above this current rmap:
 	 * because there were no VM_MERGEABLE vmas with such addresses.
 	 */
-	remove_trailing_rmap_items(ksm_scan.rmap_list);
+	remove_trailing_rmap_items(scan->rmap_list);
 
 	spin_lock(&ksm_mmlist_lock);
-	slot = list_entry(mm_slot->slot.mm_node.next,
-			  struct mm_slot, mm_node);
-	ksm_scan.mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
-	if (ksm_scan.address == 0) {
+	scan->mm_slot = next_scan_mm_slot(scan, mm_slot);
+	if (scan->address == 0) {
 		/*
 		 * We've completed a full scan of all vmas, holding mmap_lock
 		 * throughout, and found no VM_MERGEABLE: so do the same as
@@ -2627,70 +2895,72 @@ static struct ksm_rmap_item *scan_get_next_rmap_item(struct page **page)
 		 * spin_unlock(&ksm_mmlist_lock) run, the "mm" may
 		 * already have been freed under us by __ksm_exit()
 		 * because the "mm_slot" is still hashed and
-		 * ksm_scan.mm_slot doesn't point to it anymore.
+		 * scan->mm_slot doesn't point to it anymore.
 		 */
 		spin_unlock(&ksm_mmlist_lock);
 	}
 
 	/* Repeat until we've completed scanning the whole list */
-	mm_slot = ksm_scan.mm_slot;
+	mm_slot = scan->mm_slot;
 	if (mm_slot != &ksm_mm_head)
 		goto next_mm;
-
-	advisor_stop_scan();
-
-	trace_ksm_stop_scan(ksm_scan.seqnr, ksm_rmap_items);
-	ksm_scan.seqnr++;
+done:
+	finish_full_scan(scan);
 	return NULL;
 }
 
 /**
  * ksm_do_scan  - the ksm scanner main worker function.
+ * @scan:  the scan worker
  * @scan_npages:  number of pages we want to scan before we return.
  */
-static void ksm_do_scan(unsigned int scan_npages)
+static void ksm_do_scan(struct ksm_scan *scan, unsigned int scan_npages)
 {
 	struct ksm_rmap_item *rmap_item;
 	struct page *page;
 
 	while (scan_npages-- && likely(!freezing(current))) {
 		cond_resched();
-		rmap_item = scan_get_next_rmap_item(&page);
+		rmap_item = scan_get_next_rmap_item(scan, &page);
 		if (!rmap_item)
 			return;
-		cmp_and_merge_page(page, rmap_item);
+		cmp_and_merge_page(scan, page, rmap_item);
 		put_page(page);
-		ksm_pages_scanned++;
+		scan->pages_scanned++;
 	}
 }
 
-static int ksmd_should_run(void)
+static int ksmd_should_run(struct ksm_scan *scan)
 {
-	return (ksm_run & KSM_RUN_MERGE) && !list_empty(&ksm_mm_head.slot.mm_node);
+	return (ksm_run & KSM_RUN_MERGE) &&
+		!list_empty(&ksm_mm_head.slot.mm_node) &&
+		scan->id < READ_ONCE(ksm_nr_scan_workers) &&
+		!READ_ONCE(scan->pass_done);
 }
 
-static int ksm_scan_thread(void *nothing)
+static int ksm_scan_thread(void *arg)
 {
+	struct ksm_scan *scan = arg;
 	unsigned int sleep_ms;
 
 	set_freezable();
 	set_user_nice(current, 5);
 
 	while (!kthread_should_stop()) {
-		mutex_lock(&ksm_thread_mutex);
+		down_read(&ksm_thread_sem);
 		wait_while_offlining();
-		if (ksmd_should_run())
-			ksm_do_scan(ksm_thread_pages_to_scan);
-		mutex_unlock(&ksm_thread_mutex);
+		if (ksmd_should_run(scan))
+			ksm_do_scan(scan, ksm_thread_pages_to_scan);
+		up_read(&ksm_thread_sem);
 
-		if (ksmd_should_run()) {
+		if (ksmd_should_run(scan)) {
 			sleep_ms = READ_ONCE(ksm_thread_sleep_millisecs);
 			wait_event_freezable_timeout(ksm_iter_wait,
 				sleep_ms != READ_ONCE(ksm_thread_sleep_millisecs),
 				msecs_to_jiffies(sleep_ms));
 		} else {
 			wait_event_freezable(ksm_thread_wait,
-				ksmd_should_run() || kthread_should_stop());
+				ksmd_should_run(scan) || kthread_should_stop());
 		}
 	}
 	return 0;
@@ -2882,6 +3152,7 @@ int __ksm_enter(struct mm_struct *mm)
 	needs_wakeup = list_empty(&ksm_mm_head.slot.mm_node);
 
 	spin_lock(&ksm_mmlist_lock);
+	mm_slot->id = ksm_mm_slot_id++;
 	mm_slot_insert(mm_slots_hash, mm, slot);
 	/*
 	 * When KSM_RUN_MERGE (or KSM_RUN_STOP),
@@ -2896,7 +3167,8 @@ int __ksm_enter(struct mm_struct *mm)
 	if (ksm_run & KSM_RUN_UNMERGE)
 		list_add_tail(&slot->mm_node, &ksm_mm_head.slot.mm_node);
 	else
-		list_add_tail(&slot->mm_node, &ksm_scan.mm_slot->slot.mm_node);
+		list_add_tail(&slot->mm_node,
+			      &mm_slot_scan(mm_slot)->mm_slot->slot.mm_node);
 	spin_unlock(&ksm_mmlist_lock);
 
 	set_bit(MMF_VM_MERGEABLE, &mm->flags);
@@ -2927,14 +3199,14 @@ void __ksm_exit(struct mm_struct *mm)
 	spin_lock(&ksm_mmlist_lock);
 	slot = mm_slot_lookup(mm_slots_hash, mm);
 	mm_slot = mm_slot_entry(slot, struct ksm_mm_slot, slot);
-	if (mm_slot && ksm_scan.mm_slot != mm_slot) {
+	if (mm_slot && !mm_slot_is_scanned(mm_slot)) {
 		if (!mm_slot->rmap_list) {
 			hash_del(&slot->hash);
 			list_del(&slot->mm_node);
 			easy_to_free = 1;
 		} else {
 			list_move(&slot->mm_node,
-				  &ksm_scan.mm_slot->slot.mm_node);
+				  &mm_slot_scan(mm_slot)->mm_slot->slot.mm_node);
 		}
 	}
 	spin_unlock(&ksm_mmlist_lock);
@@ -3143,10 +3415,10 @@ void folio_migrate_ksm(struct folio *newfolio, struct folio *folio)
 static void wait_while_offlining(void)
 {
 	while (ksm_run & KSM_RUN_OFFLINE) {
-		mutex_unlock(&ksm_thread_mutex);
+		up_read(&ksm_thread_sem);
 		wait_on_bit(&ksm_run, ilog2(KSM_RUN_OFFLINE),
 			    TASK_UNINTERRUPTIBLE);
-		mutex_lock(&ksm_thread_mutex);
+		down_read(&ksm_thread_sem);
 	}
 }
 
@@ -3233,11 +3505,11 @@ static int ksm_memory_callback(struct notifier_block *self,
 		 * and remove_all_stable_nodes() while memory is going offline:
 		 * it is unsafe for them to touch the stable tree at this time.
 		 * But unmerge_ksm_pages(), rmap lookups and other entry points
-		 * which do not need the ksm_thread_mutex are all safe.
+		 * which do not need the ksm_thread_sem are all safe.
 		 */
-		mutex_lock(&ksm_thread_mutex);
+		down_write(&ksm_thread_sem);
 		ksm_run |= KSM_RUN_OFFLINE;
-		mutex_unlock(&ksm_thread_mutex);
+		up_write(&ksm_thread_sem);
 		break;
 
 	case MEM_OFFLINE:
@@ -3252,9 +3524,9 @@ static int ksm_memory_callback(struct notifier_block *self,
 				      mn->start_pfn + mn->nr_pages);
 		fallthrough;
 	case MEM_CANCEL_OFFLINE:
-		mutex_lock(&ksm_thread_mutex);
+		down_write(&ksm_thread_sem);
 		ksm_run &= ~KSM_RUN_OFFLINE;
-		mutex_unlock(&ksm_thread_mutex);
+		up_write(&ksm_thread_sem);
 
 		smp_mb();	/* wake_up_bit advises this */
 		wake_up_bit(&ksm_run, ilog2(KSM_RUN_OFFLINE));
@@ -3380,7 +3652,7 @@ static ssize_t run_store(struct kobject *kobj, struct kobj_attribute *attr,
 	 * on the list for when ksmd may be set running again).
 	 */
 
-	mutex_lock(&ksm_thread_mutex);
+	down_write(&ksm_thread_sem);
 	wait_while_offlining();
 	if (ksm_run != flags) {
 		ksm_run = flags;
@@ -3394,7 +3666,7 @@ static ssize_t run_store(struct kobject *kobj, struct kobj_attribute *attr,
 			}
 		}
 	}
-	mutex_unlock(&ksm_thread_mutex);
+	up_write(&ksm_thread_sem);
 
 	if (flags & KSM_RUN_MERGE)
 		wake_up_interruptible(&ksm_thread_wait);
@@ -3423,7 +3695,7 @@ static ssize_t merge_across_nodes_store(struct kobject *kobj,
 	if (knob > 1)
 		return -EINVAL;
 
-	mutex_lock(&ksm_thread_mutex);
+	down_write(&ksm_thread_sem);
 	wait_while_offlining();
 	if (ksm_merge_across_nodes != knob) {
 		if (ksm_pages_shared || remove_all_stable_nodes())
@@ -3454,7 +3726,7 @@ static ssize_t merge_across_nodes_store(struct kobject *kobj,
 			ksm_nr_node_ids = knob ? 1 : nr_node_ids;
 		}
 	}
-	mutex_unlock(&ksm_thread_mutex);
+	up_write(&ksm_thread_sem);
 
 	return err ? err : count;
 }
@@ -3510,7 +3782,7 @@ static ssize_t max_page_sharing_store(struct kobject *kobj,
 	if (READ_ONCE(ksm_max_page_sharing) == knob)
 		return count;
 
-	mutex_lock(&ksm_thread_mutex);
+	down_write(&ksm_thread_sem);
 	wait_while_offlining();
 	if (ksm_max_page_sharing != knob) {
 		if (ksm_pages_shared || remove_all_stable_nodes())
@@ -3518,7 +3790,7 @@ static ssize_t max_page_sharing_store(struct kobject *kobj,
 		else
 			ksm_max_page_sharing = knob;
 	}
-	mutex_unlock(&ksm_thread_mutex);
+	up_write(&ksm_thread_sem);
 
 	return err ? err : count;
 }
@@ -3527,7 +3799,13 @@ KSM_ATTR(max_page_sharing);
 static ssize_t pages_scanned_show(struct kobject *kobj,
 				  struct kobj_attribute *attr, char *buf)
 {
-	return sysfs_emit(buf, "%lu\n", ksm_pages_scanned);
+	unsigned long pages_scanned = 0;
+	unsigned int i;
+
+	for (i = 0; i < KSM_MAX_SCAN_WORKERS; i++)
+		pages_scanned += READ_ONCE(ksm_scans[i].pages_scanned);
+
+	return sysfs_emit(buf, "%lu\n", pages_scanned);
 }
 KSM_ATTR_RO(pages_scanned);
 
@@ -3557,7 +3835,7 @@ static ssize_t pages_volatile_show(struct kobject *kobj,
 {
 	long ksm_pages_volatile;
 
-	ksm_pages_volatile = ksm_rmap_items - ksm_pages_shared
+	ksm_pages_volatile = atomic_long_read(&ksm_rmap_items) - ksm_pages_shared
 				- ksm_pages_sharing - ksm_pages_unshared;
 	/*
 	 * It was not worth any locking to calculate that statistic,
@@ -3589,7 +3867,7 @@ static ssize_t general_profit_show(struct kobject *kobj,
 	long general_profit;
 
 	general_profit = (ksm_pages_sharing + atomic_long_read(&ksm_zero_pages)) * PAGE_SIZE -
-				ksm_rmap_items * sizeof(struct ksm_rmap_item);
+				atomic_long_read(&ksm_rmap_items) * sizeof(struct ksm_rmap_item);
 
 	return sysfs_emit(buf, "%ld\n", general_profit);
 }
@@ -3638,7 +3916,7 @@ KSM_ATTR(stable_node_chains_prune_millisecs);
 static ssize_t full_scans_show(struct kobject *kobj,
 			       struct kobj_attribute *attr, char *buf)
 {
-	return sysfs_emit(buf, "%lu\n", ksm_scan.seqnr);
+	return sysfs_emit(buf, "%lu\n", ksm_scan_seqnr);
 }
 KSM_ATTR_RO(full_scans);
 
@@ -3788,6 +4066,64 @@ static ssize_t advisor_target_scan_time_store(struct kobject *kobj,
 }
 KSM_ATTR(advisor_target_scan_time);
 
+static ssize_t scan_workers_show(struct kobject *kobj,
+				 struct kobj_attribute *attr, char *buf)
+{
+	return sysfs_emit(buf, "%u\n", READ_ONCE(ksm_scan_workers));
+}
+
+static ssize_t scan_workers_store(struct kobject *kobj,
+				  struct kobj_attribute *attr,
+				  const char *buf, size_t count)
+{
+	struct task_struct *thread;
+	unsigned int nr, i;
+	int err;
+
+	err = kstrtouint(buf, 10, &nr);
+	if (err)
+		return -EINVAL;
+	if (nr < 1 || nr > KSM_MAX_SCAN_WORKERS)
+		return -EINVAL;
+
+	down_write(&ksm_thread_sem);
+	for (i = 1; i < nr; i++) {
+		if (ksm_scans[i].thread)
+			continue;
+		thread = kthread_run(ksm_scan_thread, &ksm_scans[i],
+				     "ksmd/%u", i);
+		if (IS_ERR(thread)) {
+			err = PTR_ERR(thread);
+			break;
+		}
+		ksm_scans[i].thread = thread;
+	}
+	/* The new number of workers is picked up by the next full scan */
+	if (!err)
+		WRITE_ONCE(ksm_scan_workers, nr);
+	up_write(&ksm_thread_sem);
+
+	return err ? err : count;
+}
+KSM_ATTR(scan_workers);
+
+static ssize_t scan_worker_stats_show(struct kobject *kobj,
+				      struct kobj_attribute *attr, char *buf)
+{
+	unsigned int nr = READ_ONCE(ksm_nr_scan_workers);
+	unsigned int i;
+	int len = 0;
+
+	for (i = 0; i < nr; i++)
+		len += sysfs_emit_at(buf, len, "%u %lu %lu %lu\n", i,
+				     READ_ONCE(ksm_scans[i].pages_scanned),
+				     READ_ONCE(ksm_scans[i].pages_merged),
+				     READ_ONCE(ksm_scans[i].last_pass_merged));
+
+	return len;
+}
+KSM_ATTR_RO(scan_worker_stats);
+
 static struct attribute *ksm_attrs[] = {
 	&sleep_millisecs_attr.attr,
 	&pages_to_scan_attr.attr,
@@ -3815,6 +4151,8 @@ static struct attribute *ksm_attrs[] = {
 	&advisor_min_pages_to_scan_attr.attr,
 	&advisor_max_pages_to_scan_attr.attr,
 	&advisor_target_scan_time_attr.attr,
+	&scan_workers_attr.attr,
+	&scan_worker_stats_attr.attr,
 	NULL,
 };
 
@@ -3827,6 +4165,7 @@ static const struct attribute_group ksm_attr_group = {
 static int __init ksm_init(void)
 {
 	struct task_struct *ksm_thread;
+	unsigned int i;
 	int err;
 
 	/* The correct value depends on page size and endianness */
@@ -3838,12 +4177,16 @@ static int __init ksm_init(void)
 	if (err)
 		goto out;
 
-	ksm_thread = kthread_run(ksm_scan_thread, NULL, "ksmd");
+	for (i = 0; i < KSM_MAX_SCAN_WORKERS; i++)
+		ksm_scans[i].id = i;
+
+	ksm_thread = kthread_run(ksm_scan_thread, &ksm_scans[0], "ksmd");
 	if (IS_ERR(ksm_thread)) {
 		pr_err("ksm: creating kthread failed\n");
 		err = PTR_ERR(ksm_thread);
 		goto out_free;
 	}
+	ksm_scans[0].thread = ksm_thread;
 
 #ifdef CONFIG_SYSFS
 	err = sysfs_create_group(mm_kobj, &ksm_attr_group);
@@ -904,6 +904,8 @@ static long madvise_dontneed_free(struct vm_area_struct *vma,
 {
 	int behavior = madv_behavior->behavior;
 	struct mm_struct *mm = vma->vm_mm;
+	bool armed = userfaultfd_armed(vma);
+	bool dropped;
 
 	*prev = vma;
 	if (!madvise_dontneed_free_valid_vma(vma, start, &end, behavior))
@@ -912,10 +914,22 @@ static long madvise_dontneed_free(struct vm_area_struct *vma,
 	if (start == end)
 		return 0;
 
-	if (!userfaultfd_remove(vma, start, end)) {
+	/*
+	 * userfaultfd_remove() may drop mmap_lock. Flush what the caller has
+	 * gathered so far rather than carry the gather across the unlocked
+	 * window, and start a fresh one once the lock is held again.
+	 */
+	if (armed)
+		tlb_finish_mmu(madv_behavior->tlb);
+	dropped = !userfaultfd_remove(vma, start, end);
+	if (dropped)
+		mmap_read_lock(mm);
+	if (armed)
+		tlb_gather_mmu(madv_behavior->tlb, mm);
+
+	if (dropped) {
 		*prev = NULL; /* mmap_lock has been dropped, prev is stale */
 
-		mmap_read_lock(mm);
 		vma = vma_lookup(mm, start);
 		if (!vma)
 			return -ENOMEM;
@@ -1712,6 +1726,28 @@ static bool is_madvise_populate(int behavior)
 	}
 }
 
+/*
+ * Advices which may drop and retake mmap_lock while they run. DONTNEED and
+ * FREE only do so through userfaultfd_remove() and manage the TLB gather
+ * around it themselves.
+ */
+static bool madvise_may_drop_lock(int behavior)
+{
+	switch (behavior) {
+	case MADV_WILLNEED:
+	case MADV_REMOVE:
+	case MADV_POPULATE_READ:
+	case MADV_POPULATE_WRITE:
+	case MADV_COLLAPSE:
+	case MADV_DONTNEED:
+	case MADV_DONTNEED_LOCKED:
+	case MADV_FREE:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static int madvise_do_behavior(struct mm_struct *mm,
 		unsigned long start, size_t len_in,
 		struct madvise_behavior *madv_behavior)
@@ -1902,25 +1938,137 @@ static ssize_t vector_madvise(struct mm_struct *mm, struct iov_iter *iter,
 	return ret;
 }
 
+/*
+ * Perform madvise operations over a vector of ranges, each with its own
+ * advice. The whole vector is handled under a single mmap lock, taken for
+ * writing if any of the advices needs it, and with a single TLB gather for
+ * the advices that batch their flushes. The advices which may drop the mmap
+ * lock are only allowed when it is held for reading, and the gather is
+ * finished before any of them runs so it never spans an unlocked window.
+ */
+static ssize_t vector_madvise_ranges(struct mm_struct *mm,
+				     const struct madvise_range *ranges,
+				     size_t nr)
+{
+	bool write_lock = false, batch_tlb = false;
+	struct mmu_gather tlb;
+	struct madvise_behavior madv_behavior = {
+		.tlb = &tlb,
+	};
+	size_t i, total_len = 0;
+	int lock_behavior;
+	ssize_t ret = 0;
+
+	for (i = 0; i < nr; i++) {
+		int behavior = ranges[i].advice;
+
+		if (ranges[i].__reserved || is_memory_failure(behavior))
+			return -EINVAL;
+		if (mm != current->mm && !process_madvise_remote_valid(behavior))
+			return -EINVAL;
+		write_lock |= madvise_need_mmap_write(behavior);
+		batch_tlb |= madvise_batch_tlb_flush(behavior);
+	}
+	for (i = 0; write_lock && i < nr; i++) {
+		if (madvise_may_drop_lock(ranges[i].advice))
+			return -EINVAL;
+	}
+
+	/* Lock as for any advice taking the mmap lock in the same mode */
+	lock_behavior = write_lock ? MADV_NORMAL : MADV_COLD;
+	ret = madvise_lock(mm, lock_behavior);
+	if (ret)
+		return ret;
+	if (batch_tlb)
+		tlb_gather_mmu(&tlb, mm);
+
+	for (i = 0; i < nr; ) {
+		int advice = ranges[i].advice;
+		bool flush;
+		int error;
+
+		/* Batching advices handle a lock drop themselves */
+		flush = batch_tlb && madvise_may_drop_lock(advice) &&
+			!madvise_batch_tlb_flush(advice);
+
+		madv_behavior.behavior = advice;
+		if (flush)
+			tlb_finish_mmu(&tlb);
+		if (ranges[i].start > ULONG_MAX || ranges[i].len > SIZE_MAX)
+			ret = -EINVAL;
+		else if (madvise_should_skip(ranges[i].start, ranges[i].len,
+					     advice, &error))
+			ret = error;
+		else
+			ret = madvise_do_behavior(mm, ranges[i].start,
+						  ranges[i].len, &madv_behavior);
+		if (flush)
+			tlb_gather_mmu(&tlb, mm);
+		/* See vector_madvise() */
+		if (ret == -ERESTARTNOINTR) {
+			if (fatal_signal_pending(current)) {
+				ret = -EINTR;
+				break;
+			}
+
+			if (batch_tlb)
+				tlb_finish_mmu(&tlb);
+			madvise_unlock(mm, lock_behavior);
+			ret = madvise_lock(mm, lock_behavior);
+			if (ret)
+				goto out;
+			if (batch_tlb)
+				tlb_gather_mmu(&tlb, mm);
+			continue;
+		}
+		if (ret < 0)
+			break;
+		total_len += ranges[i].len;
+		i++;
+	}
+	if (batch_tlb)
+		tlb_finish_mmu(&tlb);
+	madvise_unlock(mm, lock_behavior);
+
+out:
+	return total_len ? : ret;
+}
+
 SYSCALL_DEFINE5(process_madvise, int, pidfd, const struct iovec __user *, vec,
 		size_t, vlen, int, behavior, unsigned int, flags)
 {
 	ssize_t ret;
 	struct iovec iovstack[UIO_FASTIOV];
 	struct iovec *iov = iovstack;
+	struct madvise_range *ranges = NULL;
 	struct iov_iter iter;
 	struct task_struct *task;
 	struct mm_struct *mm;
 	unsigned int f_flags;
 
-	if (flags != 0) {
+	if (flags & ~PMADV_RANGES) {
 		ret = -EINVAL;
 		goto out;
 	}
 
-	ret = import_iovec(ITER_DEST, vec, vlen, ARRAY_SIZE(iovstack), &iov, &iter);
-	if (ret < 0)
-		goto out;
+	if (flags & PMADV_RANGES) {
+		/* The advice comes with each range */
+		if (behavior || vlen > UIO_MAXIOV) {
+			ret = -EINVAL;
+			goto out;
+		}
+		ranges = vmemdup_array_user(vec, vlen, sizeof(*ranges));
+		if (IS_ERR(ranges)) {
+			ret = PTR_ERR(ranges);
+			goto out;
+		}
+		iov = NULL;
+	} else {
+		ret = import_iovec(ITER_DEST, vec, vlen, ARRAY_SIZE(iovstack),
+				   &iov, &iter);
+		if (ret < 0)
+			goto out;
+	}
 
 	task = pidfd_get_task(pidfd, &f_flags);
 	if (IS_ERR(task)) {
@@ -1937,9 +2085,10 @@ SYSCALL_DEFINE5(process_madvise, int, pidfd, const struct iovec __user *, vec,
 
 	/*
 	 * We need only perform this check if we are attempting to manipulate a
-	 * remote process's address space.
+	 * remote process's address space. Ranges are checked one by one.
 	 */
-	if (mm != current->mm && !process_madvise_remote_valid(behavior)) {
+	if (mm != current->mm && !ranges &&
+	    !process_madvise_remote_valid(behavior)) {
 		ret = -EINVAL;
 		goto release_mm;
 	}
@@ -1954,7 +2103,10 @@ SYSCALL_DEFINE5(process_madvise, int, pidfd, const struct iovec __user *, vec,
 		goto release_mm;
 	}
 
-	ret = vector_madvise(mm, &iter, behavior);
+	if (ranges)
+		ret = vector_madvise_ranges(mm, ranges, vlen);
+	else
+		ret = vector_madvise(mm, &iter, behavior);
 
 release_mm:
 	mmput(mm);
@@ -1962,6 +2114,7 @@ SYSCALL_DEFINE5(process_madvise, int, pidfd, const struct iovec __user *, vec,
 	put_task_struct(task);
 free_iov:
 	kfree(iov);
+	kvfree(ranges);
 out:
 	return ret;
 }
@@ -63,6 +63,7 @@
 #include <linux/psi.h>
 #include <linux/seq_buf.h>
 #include <linux/sched/isolation.h>
+#include <linux/sched/cputime.h>
 #include <linux/kmemleak.h>
 #include "internal.h"
 #include <net/sock.h>
@@ -3755,6 +3756,7 @@ static struct mem_cgroup *mem_cgroup_alloc(struct mem_cgroup *parent)
 	INIT_LIST_HEAD(&memcg->memory_peaks);
 	INIT_LIST_HEAD(&memcg->swap_peaks);
 	spin_lock_init(&memcg->peaks_lock);
+	spin_lock_init(&memcg->reclaim_report_lock);
 	memcg->socket_pressure = jiffies;
 	memcg1_memcg_init(memcg);
 	memcg->kmemcg_id = -1;
@@ -4567,12 +4569,16 @@ static ssize_t memory_oom_group_write(struct kernfs_open_file *of,
 enum {
 	MEMORY_RECLAIM_SWAPPINESS = 0,
 	MEMORY_RECLAIM_SWAPPINESS_MAX,
+	MEMORY_RECLAIM_MIN_AGE,
+	MEMORY_RECLAIM_BUDGET,
 	MEMORY_RECLAIM_NULL,
 };
 
 static const match_table_t tokens = {
 	{ MEMORY_RECLAIM_SWAPPINESS, "swappiness=%d"},
 	{ MEMORY_RECLAIM_SWAPPINESS_MAX, "swappiness=max"},
+	{ MEMORY_RECLAIM_MIN_AGE, "min_age=%u"},
+	{ MEMORY_RECLAIM_BUDGET, "budget=%u"},
 	{ MEMORY_RECLAIM_NULL, NULL },
 };
 
@@ -4584,6 +4590,10 @@ static ssize_t memory_reclaim(struct kernfs_open_file *of, char *buf,
 	unsigned long nr_to_reclaim, nr_reclaimed = 0;
 	int swappiness = -1;
 	unsigned int reclaim_options;
+	unsigned int min_age = 0, budget = 0;
+	struct lru_gen_reclaim_ctl ctl = {};
+	u64 start_ns;
+	ssize_t ret = nbytes;
 	char *old_buf, *start;
 	substring_t args[MAX_OPT_ARGS];
 
@@ -4609,19 +4619,44 @@ static ssize_t memory_reclaim(struct kernfs_open_file *of, char *buf,
 		case MEMORY_RECLAIM_SWAPPINESS_MAX:
 			swappiness = SWAPPINESS_ANON_ONLY;
 			break;
+		case MEMORY_RECLAIM_MIN_AGE:
+			/* in milliseconds, only honored by MGLRU */
+			if (match_uint(&args[0], &min_age))
+				return -EINVAL;
+			break;
+		case MEMORY_RECLAIM_BUDGET:
+			/* in microseconds of CPU time */
+			if (match_uint(&args[0], &budget))
+				return -EINVAL;
+			break;
 		default:
 			return -EINVAL;
 		}
 	}
 
+	ctl.min_age = msecs_to_jiffies(min_age);
+	start_ns = task_sched_runtime(current);
+
 	reclaim_options	= MEMCG_RECLAIM_MAY_SWAP | MEMCG_RECLAIM_PROACTIVE;
 	while (nr_reclaimed < nr_to_reclaim) {
 		/* Will converge on zero, but reclaim enforces a minimum */
 		unsigned long batch_size = (nr_to_reclaim - nr_reclaimed) / 4;
 		unsigned long reclaimed;
 
-		if (signal_pending(current))
-			return -EINTR;
+		if (signal_pending(current)) {
+			ret = -EINTR;
+			break;
+		}
+
+		ctl.cpu_ns = task_sched_runtime(current) - start_ns;
+		if (budget) {
+			if (ctl.cpu_ns >= (u64)budget * NSEC_PER_USEC) {
+				ret = -EAGAIN;
+				break;
+			}
+			/* small batches so that the budget is not overshot */
+			batch_size = min(batch_size, SWAP_CLUSTER_MAX);
+		}
 
 		/*
 		 * This is the final attempt, drain percpu lru caches in the
@@ -4631,18 +4666,48 @@ static ssize_t memory_reclaim(struct kernfs_open_file *of, char *buf,
 		if (!nr_retries)
 			lru_add_drain_all();
 
-		reclaimed = try_to_free_mem_cgroup_pages(memcg,
+		reclaimed = try_to_free_mem_cgroup_pages_gen(memcg,
 					batch_size, GFP_KERNEL,
 					reclaim_options,
-					swappiness == -1 ? NULL : &swappiness);
+					swappiness == -1 ? NULL : &swappiness,
+					&ctl);
 
-		if (!reclaimed && !nr_retries--)
-			return -EAGAIN;
+		if (!reclaimed && !nr_retries--) {
+			ret = -EAGAIN;
+			break;
+		}
 
 		nr_reclaimed += reclaimed;
 	}
 
-	return nbytes;
+	ctl.nr_total = nr_reclaimed;
+	ctl.cpu_ns = task_sched_runtime(current) - start_ns;
+	spin_lock(&memcg->reclaim_report_lock);
+	memcg->reclaim_report = ctl;
+	spin_unlock(&memcg->reclaim_report_lock);
+
+	return ret;
+}
+
+static int memory_reclaim_show(struct seq_file *m, void *v)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_seq(m);
+	struct lru_gen_reclaim_ctl ctl;
+	int i;
+
+	/* a concurrent request may be storing its report */
+	spin_lock(&memcg->reclaim_report_lock);
+	ctl = memcg->reclaim_report;
+	spin_unlock(&memcg->reclaim_report_lock);
+
+	seq_printf(m, "reclaimed %lu\n", ctl.nr_total << PAGE_SHIFT);
+	seq_printf(m, "cpu_usec %llu\n", div_u64(ctl.cpu_ns, NSEC_PER_USEC));
+	seq_puts(m, "gen_reclaimed");
+	for (i = 0; i < MAX_NR_GENS; i++)
+		seq_printf(m, " %lu", ctl.nr_reclaimed[i] << PAGE_SHIFT);
+	seq_putc(m, '\n');
+
+	return 0;
 }
 
 static struct cftype memory_files[] = {
@@ -4715,6 +4780,7 @@ static struct cftype memory_files[] = {
 		.name = "reclaim",
 		.flags = CFTYPE_NS_DELEGATABLE,
 		.write = memory_reclaim,
+		.seq_show = memory_reclaim_show,
 	},
 	{ }	/* terminate */
 };
@@ -4788,6 +4854,64 @@ int __mem_cgroup_charge(struct folio *folio, struct mm_struct *mm, gfp_t gfp)
 	return ret;
 }
 
+/**
+ * mem_cgroup_charge_batch_start - Pre-charge pages for a run of folios.
+ * @batch: Batch to initialise.
+ * @mm: mm context of the allocating task, or NULL for the active memcg.
+ * @nr_pages: Number of pages the run is expected to need.
+ *
+ * Charge @nr_pages to the memcg of @mm in one go, without entering
+ * reclaim. If the memcg is too close to its limit, nothing is pre-charged
+ * and mem_cgroup_charge_batch() charges (and reclaims) per folio instead.
+ * Must be paired with mem_cgroup_charge_batch_end().
+ */
+void mem_cgroup_charge_batch_start(struct mem_cgroup_charge_batch *batch,
+				   struct mm_struct *mm, unsigned int nr_pages)
+{
+	batch->nr_pages = 0;
+	if (mem_cgroup_disabled()) {
+		batch->memcg = NULL;
+		return;
+	}
+
+	batch->memcg = get_mem_cgroup_from_mm(mm);
+	if (!nr_pages || mem_cgroup_is_root(batch->memcg))
+		return;
+	if (!try_charge_memcg(batch->memcg, GFP_NOWAIT | __GFP_NOWARN,
+			      nr_pages))
+		batch->nr_pages = nr_pages;
+}
+
+int __mem_cgroup_charge_batch(struct mem_cgroup_charge_batch *batch,
+			      struct folio *folio, gfp_t gfp)
+{
+	unsigned int nr_pages = folio_nr_pages(folio);
+
+	if (batch->nr_pages < nr_pages)
+		return charge_memcg(folio, batch->memcg, gfp);
+
+	batch->nr_pages -= nr_pages;
+	css_get(&batch->memcg->css);
+	commit_charge(folio, batch->memcg);
+	memcg1_commit_charge(folio, batch->memcg);
+	return 0;
+}
+
+/**
+ * mem_cgroup_charge_batch_end - Refund the unused part of a charge batch.
+ * @batch: Batch started with mem_cgroup_charge_batch_start().
+ */
+void mem_cgroup_charge_batch_end(struct mem_cgroup_charge_batch *batch)
+{
+	if (!batch->memcg)
+		return;
+
+	if (batch->nr_pages)
+		refill_stock(batch->memcg, batch->nr_pages);
+	css_put(&batch->memcg->css);
+	batch->memcg = NULL;
+}
+
 /**
  * mem_cgroup_charge_hugetlb - charge the memcg for a hugetlb folio
  * @folio: folio being charged
@@ -935,6 +935,10 @@ static int __init memory_tier_init(void)
 subsys_initcall(memory_tier_init);
 
 bool numa_demotion_enabled = false;
+/* Promote from slower tiers through kpromoted rather than from the fault */
+bool numa_promotion_async = false;
+/* kpromoted bandwidth budget per node, in MB/s, 0 for no limit */
+unsigned int numa_promotion_async_rate_limit;
 
 #ifdef CONFIG_MIGRATION
 #ifdef CONFIG_SYSFS
@@ -960,8 +964,57 @@ static ssize_t demotion_enabled_store(struct kobject *kobj,
 static struct kobj_attribute numa_demotion_enabled_attr =
 	__ATTR_RW(demotion_enabled);
 
+static ssize_t promotion_async_show(struct kobject *kobj,
+				    struct kobj_attribute *attr, char *buf)
+{
+	return sysfs_emit(buf, "%s\n", str_true_false(numa_promotion_async));
+}
+
+static ssize_t promotion_async_store(struct kobject *kobj,
+				     struct kobj_attribute *attr,
+				     const char *buf, size_t count)
+{
+	ssize_t ret;
+
+	ret = kstrtobool(buf, &numa_promotion_async);
+	if (ret)
+		return ret;
+
+	return count;
+}
+
+static struct kobj_attribute numa_promotion_async_attr =
+	__ATTR_RW(promotion_async);
+
+static ssize_t promotion_async_rate_limit_MBps_show(struct kobject *kobj,
+						    struct kobj_attribute *attr,
+						    char *buf)
+{
+	return sysfs_emit(buf, "%u\n", READ_ONCE(numa_promotion_async_rate_limit));
+}
+
+static ssize_t promotion_async_rate_limit_MBps_store(struct kobject *kobj,
+						     struct kobj_attribute *attr,
+						     const char *buf, size_t count)
+{
+	unsigned int rate_limit;
+	ssize_t ret;
+
+	ret = kstrtouint(buf, 10, &rate_limit);
+	if (ret)
+		return ret;
+
+	WRITE_ONCE(numa_promotion_async_rate_limit, rate_limit);
+	return count;
+}
+
+static struct kobj_attribute numa_promotion_async_rate_limit_attr =
+	__ATTR_RW(promotion_async_rate_limit_MBps);
+
 static struct attribute *numa_attrs[] = {
 	&numa_demotion_enabled_attr.attr,
+	&numa_promotion_async_attr.attr,
+	&numa_promotion_async_rate_limit_attr.attr,
 	NULL,
 };
 
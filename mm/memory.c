@@ -1364,16 +1364,34 @@ vma_needs_copy(struct vm_area_struct *dst_vma, struct vm_area_struct *src_vma)
 	return false;
 }
 
+static int __copy_page_range(struct vm_area_struct *dst_vma,
+			     struct vm_area_struct *src_vma,
+			     unsigned long addr, unsigned long end)
+{
+	pgd_t *dst_pgd = pgd_offset(dst_vma->vm_mm, addr);
+	pgd_t *src_pgd = pgd_offset(src_vma->vm_mm, addr);
+	unsigned long next;
+
+	do {
+		next = pgd_addr_end(addr, end);
+		if (pgd_none_or_clear_bad(src_pgd))
+			continue;
+		if (unlikely(copy_p4d_range(dst_vma, src_vma, dst_pgd, src_pgd,
+					    addr, next)))
+			return -ENOMEM;
+	} while (dst_pgd++, src_pgd++, addr = next, addr != end);
+
+	return 0;
+}
+
 int
 copy_page_range(struct vm_area_struct *dst_vma, struct vm_area_struct *src_vma)
 {
-	pgd_t *src_pgd, *dst_pgd;
 	unsigned long addr = src_vma->vm_start;
 	unsigned long end = src_vma->vm_end;
 	struct mm_struct *dst_mm = dst_vma->vm_mm;
 	struct mm_struct *src_mm = src_vma->vm_mm;
 	struct mmu_notifier_range range;
-	unsigned long next;
 	bool is_cow;
 	int ret;
 
@@ -1406,19 +1424,7 @@ copy_page_range(struct vm_area_struct *dst_vma, struct vm_area_struct *src_vma)
 		raw_write_seqcount_begin(&src_mm->write_protect_seq);
 	}
 
-	ret = 0;
-	dst_pgd = pgd_offset(dst_mm, addr);
-	src_pgd = pgd_offset(src_mm, addr);
-	do {
-		next = pgd_addr_end(addr, end);
-		if (pgd_none_or_clear_bad(src_pgd))
-			continue;
-		if (unlikely(copy_p4d_range(dst_vma, src_vma, dst_pgd, src_pgd,
-					    addr, next))) {
-			ret = -ENOMEM;
-			break;
-		}
-	} while (dst_pgd++, src_pgd++, addr = next, addr != end);
+	ret = __copy_page_range(dst_vma, src_vma, addr, end);
 
 	if (is_cow) {
 		raw_write_seqcount_end(&src_mm->write_protect_seq);
@@ -1427,6 +1433,174 @@ copy_page_range(struct vm_area_struct *dst_vma, struct vm_area_struct *src_vma)
 	return ret;
 }
 
+/*
+ * Parallel page table copying for fork(), see PR_SET_FORK_COPY_THREADS.
+ *
+ * The deferred VMAs are cut into PUD-sized chunks which the forking task
+ * and up to nr_threads - 1 unbound kworkers pull from a shared cursor.
+ * Chunks of different VMAs may share upper level or PTE tables; those
+ * are populated and filled under their page table locks exactly as for
+ * two adjacent VMAs copied one after the other.
+ */
+struct fork_copy_ctl {
+	struct vma_copy_pair	*pairs;
+	unsigned int		nr;
+	spinlock_t		lock;
+	unsigned int		idx;	/* Next pair to hand out */
+	unsigned long		addr;	/* Next address within pairs[idx] */
+	struct mem_cgroup	*memcg;
+	int			err;
+};
+
+struct fork_copy_work {
+	struct work_struct	work;
+	struct fork_copy_ctl	*ctl;
+};
+
+static bool fork_copy_next(struct fork_copy_ctl *ctl, struct vma_copy_pair **pair,
+			   unsigned long *start, unsigned long *end)
+{
+	bool found = false;
+
+	spin_lock(&ctl->lock);
+	while (ctl->idx < ctl->nr && !ctl->err) {
+		struct vma_copy_pair *p = &ctl->pairs[ctl->idx];
+
+		if (ctl->addr < p->src->vm_start)
+			ctl->addr = p->src->vm_start;
+		if (ctl->addr < p->src->vm_end) {
+			*pair = p;
+			*start = ctl->addr;
+			*end = pud_addr_end(ctl->addr, p->src->vm_end);
+			ctl->addr = *end;
+			found = true;
+			break;
+		}
+		ctl->idx++;
+		ctl->addr = 0;
+	}
+	spin_unlock(&ctl->lock);
+
+	return found;
+}
+
+static void fork_copy_run(struct fork_copy_ctl *ctl)
+{
+	struct vma_copy_pair *p;
+	unsigned long start, end;
+
+	while (fork_copy_next(ctl, &p, &start, &end)) {
+		if (__copy_page_range(p->dst, p->src, start, end)) {
+			spin_lock(&ctl->lock);
+			ctl->err = -ENOMEM;
+			spin_unlock(&ctl->lock);
+			break;
+		}
+		cond_resched();
+	}
+}
+
+static void fork_copy_workfn(struct work_struct *work)
+{
+	struct fork_copy_work *fw = container_of(work, struct fork_copy_work, work);
+	struct mem_cgroup *old_memcg;
+
+	/* Page tables are charged to the forking task, not to the kworker */
+	old_memcg = set_active_memcg(fw->ctl->memcg);
+	fork_copy_run(fw->ctl);
+	set_active_memcg(old_memcg);
+}
+
+/**
+ * copy_page_range_parallel - copy the page tables of several VMAs at once
+ * @pairs: destination/source VMA pairs, sorted by address
+ * @nr: number of entries in @pairs
+ * @nr_threads: number of threads to use, including the caller
+ *
+ * Called by dup_mmap() with both mmap locks held for writing, after all
+ * VMAs have been duplicated. hugetlb VMAs are copied by the caller
+ * serially, everything else is copied by @nr_threads threads.
+ *
+ * Return: 0 on success, -ENOMEM if any chunk failed to copy.
+ */
+int copy_page_range_parallel(struct vma_copy_pair *pairs, unsigned int nr,
+			     unsigned int nr_threads)
+{
+	struct fork_copy_ctl ctl = {
+		.pairs	= pairs,
+		.lock	= __SPIN_LOCK_UNLOCKED(ctl.lock),
+	};
+	unsigned long cow_start = ULONG_MAX, cow_end = 0;
+	struct mmu_notifier_range range;
+	struct fork_copy_work *works;
+	struct mm_struct *src_mm;
+	unsigned int i, nr_works;
+	int ret;
+
+	if (!nr)
+		return 0;
+	src_mm = pairs[0].src->vm_mm;
+
+	for (i = 0; i < nr; i++) {
+		struct vm_area_struct *dst_vma = pairs[i].dst;
+		struct vm_area_struct *src_vma = pairs[i].src;
+
+		if (!vma_needs_copy(dst_vma, src_vma))
+			continue;
+
+		if (is_vm_hugetlb_page(src_vma)) {
+			ret = copy_hugetlb_page_range(dst_vma->vm_mm, src_mm,
+						      dst_vma, src_vma);
+			if (ret)
+				return ret;
+			continue;
+		}
+
+		if (is_cow_mapping(src_vma->vm_flags)) {
+			vma_assert_write_locked(src_vma);
+			cow_start = min(cow_start, src_vma->vm_start);
+			cow_end = max(cow_end, src_vma->vm_end);
+		}
+		pairs[ctl.nr++] = pairs[i];
+	}
+
+	if (!ctl.nr)
+		return 0;
+
+	/* One notifier range and write_protect_seq section for all chunks */
+	if (cow_end) {
+		mmu_notifier_range_init(&range, MMU_NOTIFY_PROTECTION_PAGE,
+					0, src_mm, cow_start, cow_end);
+		mmu_notifier_invalidate_range_start(&range);
+		raw_write_seqcount_begin(&src_mm->write_protect_seq);
+	}
+
+	nr_works = 0;
+	works = kmalloc_array(nr_threads - 1, sizeof(*works), GFP_KERNEL);
+	if (works) {
+		ctl.memcg = get_mem_cgroup_from_current();
+		for (nr_works = 0; nr_works < nr_threads - 1; nr_works++) {
+			INIT_WORK(&works[nr_works].work, fork_copy_workfn);
+			works[nr_works].ctl = &ctl;
+			queue_work(system_unbound_wq, &works[nr_works].work);
+		}
+	}
+
+	fork_copy_run(&ctl);
+
+	for (i = 0; i < nr_works; i++)
+		flush_work(&works[i].work);
+	if (works)
+		mem_cgroup_put(ctl.memcg);
+	kfree(works);
+
+	if (cow_end) {
+		raw_write_seqcount_end(&src_mm->write_protect_seq);
+		mmu_notifier_invalidate_range_end(&range);
+	}
+	return ctl.err;
+}
+
 /* Whether we should zap all COWed (private) pages too */
 static inline bool should_zap_cows(struct zap_details *details)
 {
@@ -4338,13 +4512,16 @@ static bool can_swapin_thp(struct vm_fault *vmf, pte_t *ptep, int nr_pages)
 
 	/*
 	 * swap_read_folio() can't handle the case a large folio is hybridly
-	 * from different backends. And they are likely corner cases. Similar
-	 * things might be added once zswap support large folios.
+	 * from different backends. And they are likely corner cases. Zswap
+	 * does not load large folios, so the range must not be in zswap at
+	 * all; a folio wholly on the backing device bypasses it.
 	 */
 	if (unlikely(swap_zeromap_batch(entry, nr_pages, NULL) != nr_pages))
 		return false;
 	if (unlikely(non_swapcache_batch(entry, nr_pages) != nr_pages))
 		return false;
+	if (unlikely(zswap_present_test(entry, nr_pages)))
+		return false;
 
 	return true;
 }
@@ -4391,14 +4568,6 @@ static struct folio *alloc_swap_folio(struct vm_fault *vmf)
 	if (unlikely(userfaultfd_armed(vma)))
 		goto fallback;
 
-	/*
-	 * A large swapped out folio could be partially or fully in zswap. We
-	 * lack handling for such cases, so fallback to swapping in order-0
-	 * folio.
-	 */
-	if (!zswap_never_enabled())
-		goto fallback;
-
 	entry = pte_to_swp_entry(vmf->orig_pte);
 	/*
 	 * Get a list of all the (large) orders below PMD_ORDER that are enabled
@@ -5014,6 +5183,102 @@ static struct folio *alloc_anon_folio(struct vm_fault *vmf)
 	return folio_prealloc(vma->vm_mm, vma, vmf->address, true);
 }
 
+/* Number of pages allocated per PT lock hold during anon fault-around */
+#define ANON_FAULT_AROUND_BATCH	16
+
+/*
+ * Map zeroed pages into the pte_none() slots of the fault-around window
+ * around an order-0 anonymous write fault, see PR_SET_ANON_FAULT_AROUND.
+ * This is purely opportunistic: pages are allocated and charged without
+ * direct reclaim, so the first failure, at the memcg limit or under memory
+ * pressure, ends it.
+ */
+static void do_anon_fault_around(struct vm_fault *vmf)
+{
+	struct vm_area_struct *vma = vmf->vma;
+	struct mm_struct *mm = vma->vm_mm;
+	unsigned int nr_pages = READ_ONCE(mm->anon_fault_around_pages);
+	gfp_t gfp = (GFP_HIGHUSER_MOVABLE & ~__GFP_DIRECT_RECLAIM) |
+		    __GFP_NORETRY | __GFP_NOWARN;
+	struct folio *folios[ANON_FAULT_AROUND_BATCH];
+	unsigned long addrs[ANON_FAULT_AROUND_BATCH];
+	unsigned long start, end, addr;
+	bool stop = false;
+
+	if (nr_pages <= 1 || userfaultfd_armed(vma))
+		return;
+
+	start = ALIGN_DOWN(vmf->address, (unsigned long)nr_pages << PAGE_SHIFT);
+	end = start + ((unsigned long)nr_pages << PAGE_SHIFT);
+	start = max(start, vma->vm_start);
+	end = min(end, vma->vm_end);
+
+	for (addr = start; addr < end && !stop; ) {
+		unsigned long base = addr;
+		spinlock_t *ptl;
+		int nr = 0, i;
+		pte_t *pte;
+
+		/* Find the empty slots locklessly, then allocate outside the PT lock */
+		pte = pte_offset_map(vmf->pmd, base);
+		if (!pte)
+			return;
+		for (; addr < end && nr < ANON_FAULT_AROUND_BATCH;
+		     addr += PAGE_SIZE) {
+			if (pte_none(ptep_get_lockless(pte + pte_index(addr) -
+						       pte_index(base))))
+				addrs[nr++] = addr;
+		}
+		pte_unmap(pte);
+
+		for (i = 0; i < nr; i++) {
+			folios[i] = vma_alloc_folio(gfp, 0, vma, addrs[i]);
+			if (folios[i] && mem_cgroup_charge(folios[i], mm, gfp)) {
+				folio_put(folios[i]);
+				folios[i] = NULL;
+			}
+			if (!folios[i]) {
+				stop = true;
+				break;
+			}
+			if (user_alloc_needs_zeroing())
+				clear_user_highpage(&folios[i]->page, addrs[i]);
+			__folio_mark_uptodate(folios[i]);
+		}
+		nr = i;
+		if (!nr)
+			continue;
+
+		pte = pte_offset_map_lock(mm, vmf->pmd, addrs[0], &ptl);
+		if (!pte) {
+			while (nr)
+				folio_put(folios[--nr]);
+			return;
+		}
+		for (i = 0; i < nr; i++) {
+			pte_t *ptep = pte + pte_index(addrs[i]) - pte_index(addrs[0]);
+			pte_t entry;
+
+			if (!pte_none(ptep_get(ptep))) {
+				folio_put(folios[i]);
+				continue;
+			}
+
+			entry = folio_mk_pte(folios[i], vma->vm_page_prot);
+			if (vma->vm_flags & VM_WRITE)
+				entry = pte_mkwrite(pte_mkdirty(entry), vma);
+
+			add_mm_counter(mm, MM_ANONPAGES, 1);
+			folio_add_new_anon_rmap(folios[i], vma, addrs[i],
+						RMAP_EXCLUSIVE);
+			folio_add_lru_vma(folios[i], vma);
+			set_pte_at(mm, addrs[i], ptep, entry);
+			update_mmu_cache(vma, addrs[i], ptep);
+		}
+		pte_unmap_unlock(pte, ptl);
+	}
+}
+
 /*
  * We enter with non-exclusive mmap_lock (to exclude vma changes,
  * but allow concurrent faults), and pte mapped but not yet locked.
@@ -5024,6 +5289,7 @@ static vm_fault_t do_anonymous_page(struct vm_fault *vmf)
 	struct vm_area_struct *vma = vmf->vma;
 	unsigned long addr = vmf->address;
 	struct folio *folio;
+	bool fault_around = false;
 	vm_fault_t ret = 0;
 	int nr_pages = 1;
 	pte_t entry;
@@ -5116,6 +5382,7 @@ static vm_fault_t do_anonymous_page(struct vm_fault *vmf)
 	count_mthp_stat(folio_order(folio), MTHP_STAT_ANON_FAULT_ALLOC);
 	folio_add_new_anon_rmap(folio, vma, addr, RMAP_EXCLUSIVE);
 	folio_add_lru_vma(folio, vma);
+	fault_around = nr_pages == 1;
 setpte:
 	if (vmf_orig_pte_uffd_wp(vmf))
 		entry = pte_mkuffd_wp(entry);
@@ -5126,6 +5393,8 @@ static vm_fault_t do_anonymous_page(struct vm_fault *vmf)
 unlock:
 	if (vmf->pte)
 		pte_unmap_unlock(vmf->pte, vmf->ptl);
+	if (fault_around)
+		do_anon_fault_around(vmf);
 	return ret;
 release:
 	folio_put(folio);
@@ -5843,6 +6112,7 @@ static vm_fault_t do_numa_page(struct vm_fault *vmf)
 	int nid = NUMA_NO_NODE;
 	bool writable = false, ignore_writable = false;
 	bool pte_write_upgrade = vma_wants_manual_pte_write_upgrade(vma);
+	bool queued = false;
 	int last_cpupid;
 	int target_nid;
 	pte_t pte, old_pte;
@@ -5887,7 +6157,15 @@ static vm_fault_t do_numa_page(struct vm_fault *vmf)
 		flags |= TNF_MIGRATE_FAIL;
 		goto out_map;
 	}
-	/* The folio is isolated and isolation code holds a folio reference. */
+	/*
+	 * The folio is isolated and isolation code holds a folio reference.
+	 * When batching, map it again and leave the migration to the batch.
+	 */
+	if (migrate_promote_can_queue(folio, target_nid) ||
+	    migrate_misplaced_can_batch(folio)) {
+		queued = true;
+		goto out_map;
+	}
 	pte_unmap_unlock(vmf->pte, vmf->ptl);
 	writable = false;
 	ignore_writable = true;
@@ -5922,6 +6200,9 @@ static vm_fault_t do_numa_page(struct vm_fault *vmf)
 					    writable);
 	pte_unmap_unlock(vmf->pte, vmf->ptl);
 
+	if (queued)
+		migrate_misplaced_folio_queue(folio, target_nid);
+
 	if (nid != NUMA_NO_NODE)
 		task_numa_fault(last_cpupid, nid, nr_pages, flags);
 	return 0;
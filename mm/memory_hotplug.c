@@ -1244,6 +1244,7 @@ int online_pages(unsigned long pfn, unsigned long nr_pages,
 
 	kswapd_run(nid);
 	kcompactd_run(nid);
+	kpromoted_run(nid);
 
 	writeback_set_ratelimit();
 
@@ -2103,6 +2104,7 @@ int offline_pages(unsigned long start_pfn, unsigned long nr_pages,
 	}
 
 	if (arg.status_change_nid >= 0) {
+		kpromoted_stop(node);
 		kcompactd_stop(node);
 		kswapd_stop(node);
 	}
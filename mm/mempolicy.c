@@ -2728,6 +2728,44 @@ unsigned long alloc_pages_bulk_mempolicy_noprof(gfp_t gfp,
 				       nr_pages, page_array);
 }
 
+/*
+ * The folio sibling of alloc_pages_bulk_mempolicy(). Interleaving policies
+ * need a placement decision per folio, so they fall back to allocating
+ * one folio at a time.
+ */
+unsigned long alloc_folios_bulk_mempolicy_noprof(gfp_t gfp, unsigned int order,
+		unsigned long nr_folios, struct folio **folio_array)
+{
+	struct mempolicy *pol = &default_policy;
+	unsigned long nr_populated = 0;
+	nodemask_t *nodemask;
+	int nid;
+
+	if (!in_interrupt() && !(gfp & __GFP_THISNODE))
+		pol = get_task_policy(current);
+
+	if (pol->mode == MPOL_INTERLEAVE ||
+	    pol->mode == MPOL_WEIGHTED_INTERLEAVE ||
+	    pol->mode == MPOL_PREFERRED_MANY) {
+		for (; nr_populated < nr_folios; nr_populated++) {
+			struct folio *folio;
+
+			if (folio_array[nr_populated])
+				continue;
+			folio = folio_alloc_noprof(gfp, order);
+			if (!folio)
+				break;
+			folio_array[nr_populated] = folio;
+		}
+		return nr_populated;
+	}
+
+	nid = numa_node_id();
+	nodemask = policy_nodemask(gfp, pol, NO_INTERLEAVE_INDEX, &nid);
+	return alloc_folios_bulk_noprof(gfp, order, nid, nodemask,
+					nr_folios, folio_array);
+}
+
 int vma_dup_policy(struct vm_area_struct *src, struct vm_area_struct *dst)
 {
 	struct mempolicy *pol = mpol_dup(src->vm_policy);
@@ -42,8 +42,12 @@
 #include <linux/ptrace.h>
 #include <linux/memory.h>
 #include <linux/sched/sysctl.h>
+#include <linux/task_work.h>
+#include <linux/resume_user_mode.h>
 #include <linux/memory-tiers.h>
 #include <linux/pagewalk.h>
+#include <linux/kthread.h>
+#include <linux/freezer.h>
 
 #include <asm/tlbflush.h>
 
@@ -2676,5 +2680,383 @@ int migrate_misplaced_folio(struct folio *folio, int node)
 	BUG_ON(!list_empty(&migratepages));
 	return nr_remaining ? -EAGAIN : 0;
 }
+
+/*
+ * Whether a misplaced folio isolated by a hinting fault of the current task
+ * should be queued with migrate_misplaced_folio_queue() rather than migrated
+ * right away. Promotions from slower memory tiers are rate limited already
+ * and keep being migrated one at a time.
+ */
+bool migrate_misplaced_can_batch(struct folio *folio)
+{
+	if (READ_ONCE(sysctl_numa_balancing_migrate_batch) <= 1)
+		return false;
+	/* the batch is flushed from task_work */
+	if (current->flags & PF_KTHREAD)
+		return false;
+	return node_is_toptier(folio_nid(folio));
+}
+
+static void migrate_misplaced_flush_batch(struct task_struct *p)
+{
+	LIST_HEAD(migratepages);
+	unsigned int nr_succeeded;
+	int nr_remaining;
+
+	if (list_empty(&p->numa_migrate_list))
+		return;
+
+	list_splice_init(&p->numa_migrate_list, &migratepages);
+	p->numa_migrate_nr = 0;
+
+	/* Who cares about NUMA placement when they're dying */
+	if (p->flags & PF_EXITING) {
+		putback_movable_pages(&migratepages);
+		return;
+	}
+
+	/*
+	 * Unmapping the whole batch in one go lets migrate_pages_batch()
+	 * cover it with a single TLB flush. Memcg NUMA_PAGE_MIGRATE events
+	 * are not accounted for batches as the folios may span memcgs.
+	 */
+	nr_remaining = migrate_pages(&migratepages, alloc_misplaced_dst_folio,
+				     NULL, p->numa_migrate_nid, MIGRATE_ASYNC,
+				     MR_NUMA_MISPLACED, &nr_succeeded);
+	if (nr_remaining && !list_empty(&migratepages))
+		putback_movable_pages(&migratepages);
+	if (nr_succeeded) {
+		count_vm_numa_events(NUMA_PAGE_MIGRATE, nr_succeeded);
+		p->numa_pages_migrated += nr_succeeded;
+	}
+	BUG_ON(!list_empty(&migratepages));
+}
+
+static void migrate_promote_folio_queue(struct folio *folio, int node);
+
+/* Longest time a batch keeps its folios isolated while the task runs */
+#define NUMA_MIGRATE_BATCH_AGE	msecs_to_jiffies(10)
+
+static bool migrate_misplaced_batch_expired(struct task_struct *p)
+{
+	return p->numa_migrate_nr &&
+	       time_after(jiffies, p->numa_migrate_stamp + NUMA_MIGRATE_BATCH_AGE);
+}
+
+/*
+ * Queue a folio isolated by migrate_misplaced_folio_prepare() for migration
+ * to @node. The PTL must have been dropped, and the folio is expected to be
+ * mapped again. The batch is migrated once it is full, when a fault asks for
+ * a different node, on the next return to user space once it is older than
+ * NUMA_MIGRATE_BATCH_AGE, or when the task next runs task_work, whichever
+ * comes first. Promotions from slower memory tiers are queued to kpromoted
+ * instead.
+ */
+void migrate_misplaced_folio_queue(struct folio *folio, int node)
+{
+	struct task_struct *p = current;
+	struct callback_head *work = &p->numa_migrate_work;
+
+	if (!node_is_toptier(folio_nid(folio))) {
+		migrate_promote_folio_queue(folio, node);
+		return;
+	}
+
+	if (p->numa_migrate_nr && p->numa_migrate_nid != node)
+		migrate_misplaced_flush_batch(p);
+
+	if (!p->numa_migrate_nr)
+		p->numa_migrate_stamp = jiffies;
+	list_add_tail(&folio->lru, &p->numa_migrate_list);
+	p->numa_migrate_nid = node;
+	if (++p->numa_migrate_nr >=
+	    READ_ONCE(sysctl_numa_balancing_migrate_batch) ||
+	    migrate_misplaced_batch_expired(p)) {
+		migrate_misplaced_flush_batch(p);
+		return;
+	}
+
+	/* TWA_NONE: piggyback on the next task_work run, at the latest exit */
+	if (work->next == work && task_work_add(p, work, TWA_NONE))
+		migrate_misplaced_flush_batch(p);
+}
+
+void migrate_misplaced_flush(struct callback_head *work)
+{
+	struct task_struct *p = current;
+
+	WARN_ON_ONCE(p != container_of(work, struct task_struct,
+				       numa_migrate_work));
+
+	work->next = work;
+	migrate_misplaced_flush_batch(p);
+}
+
+/*
+ * Called from the scheduler tick for the running task. The isolated folios
+ * count against too_many_isolated(), so a task that keeps running without
+ * faulting again must not hold on to them: once the batch has aged, have
+ * the already queued task_work run on the next return to user space.
+ */
+void migrate_misplaced_tick(struct task_struct *p)
+{
+	if (migrate_misplaced_batch_expired(p))
+		set_notify_resume(p);
+}
+
+/*
+ * Asynchronous promotion: rather than migrating them one at a time from the
+ * hinting fault, folios isolated for promotion from a slower memory tier are
+ * queued to the kpromoted thread of the target node. kpromoted migrates them
+ * in batches of up to NR_MAX_BATCHED_MIGRATION pages, within a per node
+ * bandwidth budget of numa_promotion_async_rate_limit MB/s.
+ */
+
+/* Beyond this, folios are put back instead, a later access will retry */
+#define KPROMOTED_MAX_QUEUED	(16 * NR_MAX_BATCHED_MIGRATION)
+
+/* How long kpromoted waits for a partial batch to fill up */
+#define KPROMOTED_BATCH_DELAY_MS	10
+
+/*
+ * Whether a folio isolated for migration to @node should be queued with
+ * migrate_misplaced_folio_queue() for kpromoted, rather than migrated right
+ * away.
+ */
+bool migrate_promote_can_queue(struct folio *folio, int node)
+{
+	if (!READ_ONCE(numa_promotion_async))
+		return false;
+	if (node_is_toptier(folio_nid(folio)) || !node_is_toptier(node))
+		return false;
+	return READ_ONCE(NODE_DATA(node)->kpromoted);
+}
+
+/* The folio must be isolated and accounted in NR_ISOLATED_* */
+static bool kpromoted_queue(pg_data_t *pgdat, struct folio *folio)
+{
+	long nr_pages = folio_nr_pages(folio);
+	bool queued = false, wake = false;
+
+	spin_lock(&pgdat->kpromoted_lock);
+	if (pgdat->kpromoted &&
+	    pgdat->kpromoted_nr + nr_pages <= KPROMOTED_MAX_QUEUED) {
+		list_add_tail(&folio->lru, &pgdat->kpromoted_list);
+		/* Wake up on the first folio and on each full batch */
+		wake = !pgdat->kpromoted_nr ||
+		       pgdat->kpromoted_nr / NR_MAX_BATCHED_MIGRATION !=
+		       (pgdat->kpromoted_nr + nr_pages) / NR_MAX_BATCHED_MIGRATION;
+		pgdat->kpromoted_nr += nr_pages;
+		queued = true;
+	}
+	spin_unlock(&pgdat->kpromoted_lock);
+
+	if (wake)
+		wake_up_interruptible(&pgdat->kpromoted_wait);
+	return queued;
+}
+
+static void migrate_promote_folio_queue(struct folio *folio, int node)
+{
+	if (kpromoted_queue(NODE_DATA(node), folio))
+		return;
+
+	node_stat_mod_folio(folio, NR_ISOLATED_ANON + folio_is_file_lru(folio),
+			    -folio_nr_pages(folio));
+	folio_putback_lru(folio);
+}
+
+/**
+ * migrate_promote_folio_list - queue folios for asynchronous promotion
+ * @folios: list of folios isolated from the LRU
+ * @node: the promotion target node
+ *
+ * Queue the folios of @folios which are on a slower memory tier than @node
+ * to the kpromoted thread of @node, until its queue is full. The folios of
+ * @folios must not be accounted in NR_ISOLATED_* yet. The folios which are
+ * not queued are left on @folios.
+ *
+ * Return: the number of pages queued.
+ */
+unsigned long migrate_promote_folio_list(struct list_head *folios, int node)
+{
+	pg_data_t *pgdat = NODE_DATA(node);
+	struct folio *folio, *next;
+	unsigned long nr_queued = 0;
+
+	if (!READ_ONCE(numa_promotion_async) || !node_is_toptier(node))
+		return 0;
+
+	list_for_each_entry_safe(folio, next, folios, lru) {
+		long nr_pages = folio_nr_pages(folio);
+		int lru = NR_ISOLATED_ANON + folio_is_file_lru(folio);
+
+		if (node_is_toptier(folio_nid(folio)))
+			continue;
+
+		list_del(&folio->lru);
+		node_stat_mod_folio(folio, lru, nr_pages);
+		if (!kpromoted_queue(pgdat, folio)) {
+			node_stat_mod_folio(folio, lru, -nr_pages);
+			list_add(&folio->lru, folios);
+			break;
+		}
+		nr_queued += nr_pages;
+	}
+
+	return nr_queued;
+}
+
+/*
+ * Migrate up to @nr_to_migrate pages off the kpromoted queue of @pgdat, at
+ * least one folio. Returns the number of pages promoted.
+ */
+static unsigned long kpromoted_migrate(pg_data_t *pgdat,
+				       unsigned long nr_to_migrate)
+{
+	unsigned long nr_pages = 0;
+	unsigned int nr_succeeded = 0;
+	struct folio *folio;
+	LIST_HEAD(folios);
+	int nr_remaining;
+
+	spin_lock(&pgdat->kpromoted_lock);
+	while (nr_pages < nr_to_migrate &&
+	       !list_empty(&pgdat->kpromoted_list)) {
+		folio = list_first_entry(&pgdat->kpromoted_list,
+					 struct folio, lru);
+		list_move_tail(&folio->lru, &folios);
+		nr_pages += folio_nr_pages(folio);
+	}
+	pgdat->kpromoted_nr -= nr_pages;
+	spin_unlock(&pgdat->kpromoted_lock);
+
+	if (!nr_pages)
+		return 0;
+
+	/* The target may have filled up while the folios were queued */
+	if (!migrate_balanced_pgdat(pgdat, nr_pages)) {
+		putback_movable_pages(&folios);
+		return 0;
+	}
+
+	nr_remaining = migrate_pages(&folios, alloc_misplaced_dst_folio, NULL,
+				     pgdat->node_id, MIGRATE_ASYNC,
+				     MR_NUMA_MISPLACED, &nr_succeeded);
+	if (nr_remaining && !list_empty(&folios))
+		putback_movable_pages(&folios);
+	if (nr_succeeded) {
+		count_vm_numa_events(NUMA_PAGE_MIGRATE, nr_succeeded);
+		mod_node_page_state(pgdat, PGPROMOTE_SUCCESS, nr_succeeded);
+	}
+
+	return nr_succeeded;
+}
+
+static int kpromoted(void *p)
+{
+	pg_data_t *pgdat = p;
+	unsigned long window_start = jiffies, window_pages = 0;
+	LIST_HEAD(folios);
+
+	set_freezable();
+
+	while (!kthread_should_stop()) {
+		unsigned long budget, nr_to_migrate = NR_MAX_BATCHED_MIGRATION;
+
+		wait_event_freezable(pgdat->kpromoted_wait,
+				     READ_ONCE(pgdat->kpromoted_nr) ||
+				     kthread_should_stop());
+		wait_event_freezable_timeout(pgdat->kpromoted_wait,
+				READ_ONCE(pgdat->kpromoted_nr) >=
+				NR_MAX_BATCHED_MIGRATION || kthread_should_stop(),
+				msecs_to_jiffies(KPROMOTED_BATCH_DELAY_MS));
+		if (kthread_should_stop())
+			break;
+
+		if (time_after_eq(jiffies, window_start + HZ)) {
+			window_start = jiffies;
+			window_pages = 0;
+		}
+
+		/* Pages per second, 0 for no limit */
+		budget = (unsigned long)READ_ONCE(numa_promotion_async_rate_limit) <<
+			 (20 - PAGE_SHIFT);
+		if (budget) {
+			if (window_pages >= budget) {
+				/* The window may have ended since the check above */
+				long timeout = max_t(long, window_start + HZ - jiffies, 1);
+
+				wait_event_freezable_timeout(pgdat->kpromoted_wait,
+						kthread_should_stop(), timeout);
+				continue;
+			}
+			nr_to_migrate = min(nr_to_migrate, budget - window_pages);
+		}
+
+		window_pages += kpromoted_migrate(pgdat, nr_to_migrate);
+		cond_resched();
+	}
+
+	/* kpromoted_stop() cleared pgdat->kpromoted, nothing gets queued */
+	spin_lock(&pgdat->kpromoted_lock);
+	list_splice_init(&pgdat->kpromoted_list, &folios);
+	pgdat->kpromoted_nr = 0;
+	spin_unlock(&pgdat->kpromoted_lock);
+	putback_movable_pages(&folios);
+
+	return 0;
+}
+
+/*
+ * This kpromoted start function will be called by init and node-hot-add.
+ */
+void __meminit kpromoted_run(int nid)
+{
+	pg_data_t *pgdat = NODE_DATA(nid);
+	struct task_struct *t;
+
+	if (pgdat->kpromoted)
+		return;
+
+	t = kthread_create_on_node(kpromoted, pgdat, nid, "kpromoted%d", nid);
+	if (IS_ERR(t)) {
+		pr_err("Failed to start kpromoted on node %d\n", nid);
+		return;
+	}
+
+	spin_lock(&pgdat->kpromoted_lock);
+	pgdat->kpromoted = t;
+	spin_unlock(&pgdat->kpromoted_lock);
+	wake_up_process(t);
+}
+
+/*
+ * Called by memory hotplug when all memory in a node is offlined. Caller must
+ * be holding mem_hotplug_begin/done().
+ */
+void __meminit kpromoted_stop(int nid)
+{
+	pg_data_t *pgdat = NODE_DATA(nid);
+	struct task_struct *t;
+
+	spin_lock(&pgdat->kpromoted_lock);
+	t = pgdat->kpromoted;
+	pgdat->kpromoted = NULL;
+	spin_unlock(&pgdat->kpromoted_lock);
+
+	if (t)
+		kthread_stop(t);
+}
+
+static int __init kpromoted_init(void)
+{
+	int nid;
+
+	for_each_node_state(nid, N_MEMORY)
+		kpromoted_run(nid);
+	return 0;
+}
+subsys_initcall(kpromoted_init);
 #endif /* CONFIG_NUMA_BALANCING */
 #endif /* CONFIG_NUMA */
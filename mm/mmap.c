@@ -1720,9 +1720,23 @@ bool mmap_read_lock_maybe_expand(struct mm_struct *mm,
 	return true;
 }
 
+/* Address spaces with less RSS than this are always copied serially */
+#define FORK_COPY_MIN_PAGES	(SZ_1G >> PAGE_SHIFT)
+
+static unsigned int fork_copy_threads(struct mm_struct *oldmm)
+{
+	unsigned int threads = READ_ONCE(oldmm->fork_copy_threads);
+
+	if (threads < 2 || get_mm_rss(oldmm) < FORK_COPY_MIN_PAGES)
+		return 0;
+	return min(threads, num_online_cpus());
+}
+
 __latent_entropy int dup_mmap(struct mm_struct *mm, struct mm_struct *oldmm)
 {
 	struct vm_area_struct *mpnt, *tmp;
+	struct vma_copy_pair *deferred = NULL;
+	unsigned int nr_deferred = 0, copy_threads;
 	int retval;
 	unsigned long charge = 0;
 	LIST_HEAD(uf);
@@ -1750,6 +1764,12 @@ __latent_entropy int dup_mmap(struct mm_struct *mm, struct mm_struct *oldmm)
 	if (unlikely(retval))
 		goto out;
 
+	/* Page tables are copied after the VMA walk, see copy_page_range_parallel() */
+	copy_threads = fork_copy_threads(oldmm);
+	if (copy_threads > 1)
+		deferred = kvmalloc_array(oldmm->map_count, sizeof(*deferred),
+					  GFP_KERNEL);
+
 	mt_clear_in_rcu(vmi.mas.tree);
 	for_each_vma(vmi, mpnt) {
 		struct file *file;
@@ -1834,17 +1854,33 @@ __latent_entropy int dup_mmap(struct mm_struct *mm, struct mm_struct *oldmm)
 			i_mmap_unlock_write(mapping);
 		}
 
-		if (!(tmp->vm_flags & VM_WIPEONFORK))
-			retval = copy_page_range(tmp, mpnt);
+		if (!(tmp->vm_flags & VM_WIPEONFORK)) {
+			if (deferred) {
+				deferred[nr_deferred].dst = tmp;
+				deferred[nr_deferred].src = mpnt;
+				nr_deferred++;
+			} else {
+				retval = copy_page_range(tmp, mpnt);
+			}
+		}
 
 		if (retval) {
 			mpnt = vma_next(&vmi);
 			goto loop_out;
 		}
 	}
+	/*
+	 * All VMAs are in the tree now, so a failed copy needs no failure
+	 * marker: exit_mmap() tears down whatever was copied.
+	 */
+	if (nr_deferred)
+		retval = copy_page_range_parallel(deferred, nr_deferred,
+						  copy_threads);
 	/* a new mm has just been created */
-	retval = arch_dup_mmap(oldmm, mm);
+	if (!retval)
+		retval = arch_dup_mmap(oldmm, mm);
 loop_out:
+	kvfree(deferred);
 	vma_iter_free(&vmi);
 	if (!retval) {
 		mt_set_in_rcu(vmi.mas.tree);
@@ -38,6 +38,7 @@
 #include <linux/sched/rt.h>
 #include <linux/sched/signal.h>
 #include <linux/mm_inline.h>
+#include <linux/blk-cgroup.h>
 #include <trace/events/writeback.h>
 
 #include "internal.h"
@@ -1331,6 +1332,34 @@ static void domain_update_dirty_limit(struct dirty_throttle_control *dtc,
 	spin_unlock(&dom->lock);
 }
 
+/*
+ * The write bandwidth blk-iocost allows @wb's cgroup on the device: the
+ * bandwidth the device is currently delivering to all wbs, scaled by the
+ * cgroup's hierarchical share of the device vtime. 0 if unknown, which
+ * includes the root wb and devices without iocost.
+ */
+static unsigned long wb_iocost_bandwidth(struct bdi_writeback *wb)
+{
+#ifdef CONFIG_CGROUP_WRITEBACK
+	struct backing_dev_info *bdi = wb->bdi;
+	struct device *owner = READ_ONCE(bdi->owner);
+	unsigned long bw;
+	u32 share;
+
+	if (wb == &bdi->wb || !owner)
+		return 0;
+	share = blkcg_iocost_share(dev_to_disk(owner), wb->blkcg_css);
+	if (!share)
+		return 0;
+
+	bw = max_t(unsigned long, atomic_long_read(&bdi->tot_write_bandwidth),
+		   READ_ONCE(bdi->wb.avg_write_bandwidth));
+	return max_t(unsigned long, (u64)bw * share >> 16, 1);
+#else
+	return 0;
+#endif
+}
+
 /*
  * Maintain wb->dirty_ratelimit, the base dirty throttle rate.
  *
@@ -1347,6 +1376,7 @@ static void wb_update_dirty_ratelimit(struct dirty_throttle_control *dtc,
 	unsigned long limit = hard_dirty_limit(dtc_dom(dtc), dtc->thresh);
 	unsigned long setpoint = (freerun + limit) / 2;
 	unsigned long write_bw = wb->avg_write_bandwidth;
+	unsigned long iocost_bw = wb_iocost_bandwidth(wb);
 	unsigned long dirty_ratelimit = wb->dirty_ratelimit;
 	unsigned long dirty_rate;
 	unsigned long task_ratelimit;
@@ -1361,6 +1391,14 @@ static void wb_update_dirty_ratelimit(struct dirty_throttle_control *dtc,
 	 */
 	dirty_rate = (dirtied - wb->dirtied_stamp) * HZ / elapsed;
 
+	/*
+	 * A cgroup wb cannot write out faster than iocost lets it issue IO,
+	 * even if its own bandwidth estimate is still from a time when it
+	 * had the device to itself.
+	 */
+	if (iocost_bw && iocost_bw < write_bw)
+		write_bw = iocost_bw;
+
 	/*
 	 * task_ratelimit reflects each dd's dirty rate for the past 200ms.
 	 */
@@ -1482,6 +1520,9 @@ static void wb_update_dirty_ratelimit(struct dirty_throttle_control *dtc,
 	else
 		dirty_ratelimit -= step;
 
+	if (iocost_bw)
+		dirty_ratelimit = min(dirty_ratelimit, iocost_bw);
+
 	WRITE_ONCE(wb->dirty_ratelimit, max(dirty_ratelimit, 1UL));
 	wb->balanced_dirty_ratelimit = balanced_dirty_ratelimit;
 
@@ -1548,7 +1589,20 @@ static void wb_bandwidth_estimate_start(struct bdi_writeback *wb)
 
 	if (elapsed > WB_BANDWIDTH_IDLE_JIF &&
 	    !atomic_read(&wb->writeback_inodes)) {
+		unsigned long iocost_bw = wb_iocost_bandwidth(wb);
+
 		spin_lock(&wb->list_lock);
+		/*
+		 * The bandwidth measured before the wb went idle is stale,
+		 * start again from what iocost currently grants the cgroup.
+		 */
+		if (iocost_bw) {
+			if (wb_has_dirty_io(wb))
+				atomic_long_add(iocost_bw - wb->avg_write_bandwidth,
+						&wb->bdi->tot_write_bandwidth);
+			wb->write_bandwidth = iocost_bw;
+			WRITE_ONCE(wb->avg_write_bandwidth, iocost_bw);
+		}
 		wb->dirtied_stamp = wb_stat(wb, WB_DIRTIED);
 		wb->written_stamp = wb_stat(wb, WB_WRITTEN);
 		WRITE_ONCE(wb->bw_time_stamp, now);
@@ -277,6 +277,10 @@ int user_min_free_kbytes = -1;
 static int watermark_boost_factor __read_mostly = 15000;
 static int watermark_scale_factor = 10;
 int defrag_mode;
+#ifdef CONFIG_NUMA
+/* Refill empty pcplists from other CPUs on the same node first */
+static int percpu_pagelist_steal __read_mostly;
+#endif
 
 /* movable_zone is the "real" zone pages in ZONE_MOVABLE are taken from */
 int movable_zone;
@@ -3049,6 +3053,69 @@ static int nr_pcp_alloc(struct per_cpu_pages *pcp, struct zone *zone, int order)
 	return batch;
 }
 
+#ifdef CONFIG_NUMA
+/*
+ * Refill an empty pcplist with up to @batch pages taken from the pcplists
+ * of other CPUs on the zone's node, avoiding a trip to zone->lock. Remote
+ * pcps are only trylocked: a busy sibling or a parallel drain makes us
+ * fall back to the buddy lists instead of spinning. The coldest pages,
+ * from the tail of the remote list, are taken. Returns the number of
+ * pages moved to @list.
+ */
+static int rmqueue_pcplist_steal(struct zone *zone, unsigned int order,
+				 int migratetype, int batch,
+				 struct per_cpu_pages *pcp,
+				 struct list_head *list)
+{
+	int pindex = order_to_pindex(migratetype, order);
+	int cpu, moved = 0;
+
+	if (!READ_ONCE(percpu_pagelist_steal))
+		return 0;
+
+	for_each_cpu(cpu, cpumask_of_node(zone_to_nid(zone))) {
+		struct per_cpu_pages *remote;
+		struct list_head *rlist;
+
+		remote = per_cpu_ptr(zone->per_cpu_pageset, cpu);
+		if (remote == pcp)
+			continue;
+
+		/* Racy check to avoid bouncing the lock of an empty list */
+		rlist = &remote->lists[pindex];
+		if (list_empty(rlist))
+			continue;
+
+		if (!spin_trylock(&remote->lock))
+			continue;
+
+		while (moved < batch && !list_empty(rlist)) {
+			struct page *page;
+
+			page = list_last_entry(rlist, struct page, pcp_list);
+			list_move_tail(&page->pcp_list, list);
+			remote->count -= 1 << order;
+			moved++;
+		}
+		spin_unlock(&remote->lock);
+
+		if (moved >= batch)
+			break;
+	}
+
+	__count_vm_event(moved ? PCP_STEAL_HIT : PCP_STEAL_MISS);
+	return moved;
+}
+#else
+static inline int rmqueue_pcplist_steal(struct zone *zone, unsigned int order,
+					int migratetype, int batch,
+					struct per_cpu_pages *pcp,
+					struct list_head *list)
+{
+	return 0;
+}
+#endif
+
 /* Remove page from the per-cpu list, caller must protect the list */
 static inline
 struct page *__rmqueue_pcplist(struct zone *zone, unsigned int order,
@@ -3062,11 +3129,16 @@ struct page *__rmqueue_pcplist(struct zone *zone, unsigned int order,
 	do {
 		if (list_empty(list)) {
 			int batch = nr_pcp_alloc(pcp, zone, order);
-			int alloced;
+			int alloced = 0;
 
-			alloced = rmqueue_bulk(zone, order,
-					batch, list,
-					migratetype, alloc_flags);
+			/* Boot pagesets (batch == 1) never hold free pages */
+			if (batch > 1)
+				alloced = rmqueue_pcplist_steal(zone, order,
+						migratetype, batch, pcp, list);
+			if (!alloced)
+				alloced = rmqueue_bulk(zone, order,
+						batch, list,
+						migratetype, alloc_flags);
 
 			pcp->count += alloced << order;
 			if (unlikely(list_empty(list)))
@@ -4751,23 +4823,11 @@ static inline bool prepare_alloc_pages(gfp_t gfp_mask, unsigned int order,
 }
 
 /*
- * __alloc_pages_bulk - Allocate a number of order-0 pages to an array
- * @gfp: GFP flags for the allocation
- * @preferred_nid: The preferred NUMA node ID to allocate from
- * @nodemask: Set of nodes to allocate from, may be NULL
- * @nr_pages: The number of pages desired in the array
- * @page_array: Array to store the pages
- *
- * This is a batched version of the page allocator that attempts to
- * allocate nr_pages quickly. Pages are added to the page_array.
- *
- * Note that only NULL elements are populated with pages and nr_pages
- * is the maximum number of pages that will be stored in the array.
- *
- * Returns the number of pages in the array.
+ * Batched allocation of @nr_pages pages of @order into @page_array. See
+ * alloc_pages_bulk() for the semantics of the array.
  */
-unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
-			nodemask_t *nodemask, int nr_pages,
+static unsigned long alloc_pages_bulk_order(gfp_t gfp, unsigned int order,
+			int preferred_nid, nodemask_t *nodemask, int nr_pages,
 			struct page **page_array)
 {
 	struct page *page;
@@ -4804,6 +4864,10 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 	if (nr_pages - nr_populated == 1)
 		goto failed;
 
+	/* Only orders cached on the pcplists can be batched. */
+	if (!pcp_allowed_order(order))
+		goto failed;
+
 #ifdef CONFIG_PAGE_OWNER
 	/*
 	 * PAGE_OWNER may recurse into the allocator to allocate space to
@@ -4819,7 +4883,7 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 	/* May set ALLOC_NOFRAGMENT, fragmentation will return 1 page. */
 	gfp &= gfp_allowed_mask;
 	alloc_gfp = gfp;
-	if (!prepare_alloc_pages(gfp, 0, preferred_nid, nodemask, &ac, &alloc_gfp, &alloc_flags))
+	if (!prepare_alloc_pages(gfp, order, preferred_nid, nodemask, &ac, &alloc_gfp, &alloc_flags))
 		goto out;
 	gfp = alloc_gfp;
 
@@ -4838,21 +4902,22 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 			goto failed;
 		}
 
-		cond_accept_memory(zone, 0, alloc_flags);
+		cond_accept_memory(zone, order, alloc_flags);
 retry_this_zone:
-		mark = wmark_pages(zone, alloc_flags & ALLOC_WMARK_MASK) + nr_pages;
-		if (zone_watermark_fast(zone, 0,  mark,
+		mark = wmark_pages(zone, alloc_flags & ALLOC_WMARK_MASK) +
+			((unsigned long)nr_pages << order);
+		if (zone_watermark_fast(zone, order,  mark,
 				zonelist_zone_idx(ac.preferred_zoneref),
 				alloc_flags, gfp)) {
 			break;
 		}
 
-		if (cond_accept_memory(zone, 0, alloc_flags))
+		if (cond_accept_memory(zone, order, alloc_flags))
 			goto retry_this_zone;
 
 		/* Try again if zone has deferred pages */
 		if (deferred_pages_enabled()) {
-			if (_deferred_grow_zone(zone, 0))
+			if (_deferred_grow_zone(zone, order))
 				goto retry_this_zone;
 		}
 	}
@@ -4871,7 +4936,7 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 		goto failed_irq;
 
 	/* Attempt the batch allocation */
-	pcp_list = &pcp->lists[order_to_pindex(ac.migratetype, 0)];
+	pcp_list = &pcp->lists[order_to_pindex(ac.migratetype, order)];
 	while (nr_populated < nr_pages) {
 
 		/* Skip existing pages */
@@ -4880,7 +4945,7 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 			continue;
 		}
 
-		page = __rmqueue_pcplist(zone, 0, ac.migratetype, alloc_flags,
+		page = __rmqueue_pcplist(zone, order, ac.migratetype, alloc_flags,
 								pcp, pcp_list);
 		if (unlikely(!page)) {
 			/* Try and allocate at least one page */
@@ -4892,7 +4957,7 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 		}
 		nr_account++;
 
-		prep_new_page(page, 0, gfp, 0);
+		prep_new_page(page, order, gfp, 0);
 		set_page_refcounted(page);
 		page_array[nr_populated++] = page;
 	}
@@ -4900,7 +4965,7 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 	pcp_spin_unlock(pcp);
 	pcp_trylock_finish(UP_flags);
 
-	__count_zid_vm_events(PGALLOC, zone_idx(zone), nr_account);
+	__count_zid_vm_events(PGALLOC, zone_idx(zone), nr_account << order);
 	zone_statistics(zonelist_zone(ac.preferred_zoneref), zone, nr_account);
 
 out:
@@ -4910,13 +4975,73 @@ unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
 	pcp_trylock_finish(UP_flags);
 
 failed:
-	page = __alloc_pages_noprof(gfp, 0, preferred_nid, nodemask);
+	page = __alloc_pages_noprof(gfp, order, preferred_nid, nodemask);
 	if (page)
 		page_array[nr_populated++] = page;
 	goto out;
 }
+
+/*
+ * __alloc_pages_bulk - Allocate a number of order-0 pages to an array
+ * @gfp: GFP flags for the allocation
+ * @preferred_nid: The preferred NUMA node ID to allocate from
+ * @nodemask: Set of nodes to allocate from, may be NULL
+ * @nr_pages: The number of pages desired in the array
+ * @page_array: Array to store the pages
+ *
+ * This is a batched version of the page allocator that attempts to
+ * allocate nr_pages quickly. Pages are added to the page_array.
+ *
+ * Note that only NULL elements are populated with pages and nr_pages
+ * is the maximum number of pages that will be stored in the array.
+ *
+ * Returns the number of pages in the array.
+ */
+unsigned long alloc_pages_bulk_noprof(gfp_t gfp, int preferred_nid,
+			nodemask_t *nodemask, int nr_pages,
+			struct page **page_array)
+{
+	return alloc_pages_bulk_order(gfp, 0, preferred_nid, nodemask,
+				      nr_pages, page_array);
+}
 EXPORT_SYMBOL_GPL(alloc_pages_bulk_noprof);
 
+/*
+ * alloc_folios_bulk - Allocate a number of folios of one order to an array
+ * @gfp: GFP flags for the allocation
+ * @order: The order of each folio
+ * @preferred_nid: The preferred NUMA node ID to allocate from
+ * @nodemask: Set of nodes to allocate from, may be NULL
+ * @nr_folios: The number of folios desired in the array
+ * @folio_array: Array to store the folios
+ *
+ * The folio sibling of alloc_pages_bulk(). Orders that are cached on the
+ * pcplists are served under a single pcp lock hold; other orders fall
+ * back to allocating one folio per call.
+ *
+ * Note that only NULL elements are populated with folios and nr_folios
+ * is the maximum number of folios that will be stored in the array.
+ *
+ * Returns the number of folios in the array.
+ */
+unsigned long alloc_folios_bulk_noprof(gfp_t gfp, unsigned int order,
+			int preferred_nid, nodemask_t *nodemask, int nr_folios,
+			struct folio **folio_array)
+{
+	struct page **page_array = (struct page **)folio_array;
+	unsigned long nr_populated;
+	int i;
+
+	nr_populated = alloc_pages_bulk_order(gfp | __GFP_COMP, order,
+					      preferred_nid, nodemask,
+					      nr_folios, page_array);
+	for (i = 0; i < nr_populated; i++)
+		page_rmappable_folio(page_array[i]);
+
+	return nr_populated;
+}
+EXPORT_SYMBOL_GPL(alloc_folios_bulk_noprof);
+
 /*
  * This is the 'heart' of the zoned buddy allocator.
  */
@@ -6464,6 +6589,15 @@ static const struct ctl_table page_alloc_sysctl_table[] = {
 		.mode		= 0644,
 		.proc_handler	= numa_zonelist_order_handler,
 	},
+	{
+		.procname	= "percpu_pagelist_steal",
+		.data		= &percpu_pagelist_steal,
+		.maxlen		= sizeof(percpu_pagelist_steal),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= SYSCTL_ZERO,
+		.extra2		= SYSCTL_ONE,
+	},
 	{
 		.procname	= "min_unmapped_ratio",
 		.data		= &sysctl_min_unmapped_ratio,
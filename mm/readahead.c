@@ -125,6 +125,7 @@
 #include <linux/syscalls.h>
 #include <linux/file.h>
 #include <linux/mm_inline.h>
+#include <linux/memcontrol.h>
 #include <linux/blk-cgroup.h>
 #include <linux/fadvise.h>
 #include <linux/sched/mm.h>
@@ -190,6 +191,72 @@ static struct folio *ractl_alloc_folio(struct readahead_control *ractl,
 	return folio;
 }
 
+/* Maximum number of folios allocated at once for a readahead window */
+#define RA_FOLIO_BATCH	16
+
+/*
+ * Folios preallocated for a readahead window with filemap_alloc_folios_bulk(),
+ * so that a window costs one allocator round trip per RA_FOLIO_BATCH folios
+ * rather than one per folio. The memcg charge for the whole window is also
+ * taken up front.
+ */
+struct ra_folio_batch {
+	unsigned int order;
+	unsigned int nr;	/* preallocated folios left in @folios */
+	unsigned long want;	/* folios the window may still need */
+	struct mem_cgroup_charge_batch charge;
+	struct folio *folios[RA_FOLIO_BATCH];
+};
+
+static void ra_folio_batch_init(struct ra_folio_batch *rfb,
+				unsigned int order, unsigned long want)
+{
+	rfb->order = order;
+	rfb->nr = 0;
+	rfb->want = want;
+	mem_cgroup_charge_batch_start(&rfb->charge, NULL,
+				      min_t(unsigned long, want << order,
+					    UINT_MAX));
+}
+
+static struct folio *ra_batch_alloc_folio(struct readahead_control *ractl,
+		struct ra_folio_batch *rfb, gfp_t gfp_mask, unsigned int order)
+{
+	struct folio *folio;
+
+	if (order != rfb->order || !rfb->want)
+		return ractl_alloc_folio(ractl, gfp_mask, order);
+
+	if (!rfb->nr) {
+		unsigned long nr = min_t(unsigned long, rfb->want,
+					 RA_FOLIO_BATCH);
+
+		memset(rfb->folios, 0, nr * sizeof(rfb->folios[0]));
+		rfb->nr = filemap_alloc_folios_bulk(gfp_mask, order, nr,
+						    rfb->folios);
+		if (!rfb->nr)
+			return NULL;
+	}
+
+	folio = rfb->folios[--rfb->nr];
+	rfb->want--;
+	if (ractl->dropbehind)
+		__folio_set_dropbehind(folio);
+
+	return folio;
+}
+
+/*
+ * Free the folios, and refund the charge, left over when the window needed
+ * less than expected.
+ */
+static void ra_folio_batch_release(struct ra_folio_batch *rfb)
+{
+	while (rfb->nr)
+		folio_put(rfb->folios[--rfb->nr]);
+	mem_cgroup_charge_batch_end(&rfb->charge);
+}
+
 /**
  * page_cache_ra_unbounded - Start unchecked readahead.
  * @ractl: Readahead control.
@@ -212,6 +279,7 @@ void page_cache_ra_unbounded(struct readahead_control *ractl,
 	gfp_t gfp_mask = readahead_gfp_mask(mapping);
 	unsigned long mark = ULONG_MAX, i = 0;
 	unsigned int min_nrpages = mapping_min_folio_nrpages(mapping);
+	struct ra_folio_batch rfb;
 
 	/*
 	 * Partway through the readahead operation, we will have added
@@ -244,6 +312,8 @@ void page_cache_ra_unbounded(struct readahead_control *ractl,
 	}
 	nr_to_read += readahead_index(ractl) - index;
 	ractl->_index = index;
+	ra_folio_batch_init(&rfb, mapping_min_folio_order(mapping),
+			    DIV_ROUND_UP(nr_to_read, min_nrpages));
 
 	/*
 	 * Preallocate as many pages as we will need.
@@ -267,12 +337,13 @@ void page_cache_ra_unbounded(struct readahead_control *ractl,
 			continue;
 		}
 
-		folio = ractl_alloc_folio(ractl, gfp_mask,
+		folio = ra_batch_alloc_folio(ractl, &rfb, gfp_mask,
 					mapping_min_folio_order(mapping));
 		if (!folio)
 			break;
 
-		ret = filemap_add_folio(mapping, folio, index + i, gfp_mask);
+		ret = filemap_add_folio_batch(mapping, folio, index + i,
+					      gfp_mask, &rfb.charge);
 		if (ret < 0) {
 			folio_put(folio);
 			if (ret == -ENOMEM)
@@ -297,6 +368,7 @@ void page_cache_ra_unbounded(struct readahead_control *ractl,
 	read_pages(ractl);
 	filemap_invalidate_unlock_shared(mapping);
 	memalloc_nofs_restore(nofs);
+	ra_folio_batch_release(&rfb);
 }
 EXPORT_SYMBOL_GPL(page_cache_ra_unbounded);
 
@@ -434,18 +506,20 @@ static unsigned long get_next_ra_size(struct file_ra_state *ra,
  * it approaches max_readhead.
  */
 
-static inline int ra_alloc_folio(struct readahead_control *ractl, pgoff_t index,
-		pgoff_t mark, unsigned int order, gfp_t gfp)
+static inline int ra_alloc_folio(struct readahead_control *ractl,
+		struct ra_folio_batch *rfb, pgoff_t index, pgoff_t mark,
+		unsigned int order, gfp_t gfp)
 {
 	int err;
-	struct folio *folio = ractl_alloc_folio(ractl, gfp, order);
+	struct folio *folio = ra_batch_alloc_folio(ractl, rfb, gfp, order);
 
 	if (!folio)
 		return -ENOMEM;
 	mark = round_down(mark, 1UL << order);
 	if (index == mark)
 		folio_set_readahead(folio);
-	err = filemap_add_folio(ractl->mapping, folio, index, gfp);
+	err = filemap_add_folio_batch(ractl->mapping, folio, index, gfp,
+				      &rfb->charge);
 	if (err) {
 		folio_put(folio);
 		return err;
@@ -469,6 +543,7 @@ void page_cache_ra_order(struct readahead_control *ractl,
 	int err = 0;
 	gfp_t gfp = readahead_gfp_mask(mapping);
 	unsigned int min_ra_size = max(4, mapping_min_folio_nrpages(mapping));
+	struct ra_folio_batch rfb;
 
 	/*
 	 * Fallback when size < min_nrpages as each folio should be
@@ -496,6 +571,8 @@ void page_cache_ra_order(struct readahead_control *ractl,
 	 */
 	ractl->_index = mapping_align_index(mapping, index);
 	index = readahead_index(ractl);
+	ra_folio_batch_init(&rfb, new_order, index <= limit ?
+			    ((limit - index) >> new_order) + 1 : 0);
 
 	while (index <= limit) {
 		unsigned int order = new_order;
@@ -506,7 +583,7 @@ void page_cache_ra_order(struct readahead_control *ractl,
 		/* Don't allocate pages past EOF */
 		while (order > min_order && index + (1UL << order) - 1 > limit)
 			order--;
-		err = ra_alloc_folio(ractl, index, mark, order, gfp);
+		err = ra_alloc_folio(ractl, &rfb, index, mark, order, gfp);
 		if (err)
 			break;
 		index += 1UL << order;
@@ -515,6 +592,7 @@ void page_cache_ra_order(struct readahead_control *ractl,
 	read_pages(ractl);
 	filemap_invalidate_unlock_shared(mapping);
 	memalloc_nofs_restore(nofs);
+	ra_folio_batch_release(&rfb);
 
 	/*
 	 * If there were already pages in the page cache, then we may have
@@ -2272,12 +2272,13 @@ static int shmem_swapin_folio(struct inode *inode, pgoff_t index,
 		/*
 		 * If uffd is active for the vma, we need per-page fault
 		 * fidelity to maintain the uffd semantics, then fallback
-		 * to swapin order-0 folio, as well as for zswap case.
+		 * to swapin order-0 folio, as well as when any entry of the
+		 * range is in zswap, which does not load large folios.
 		 * Any existing sub folio in the swap cache also blocks
 		 * mTHP swapin.
 		 */
 		if (order > 0 && ((vma && unlikely(userfaultfd_armed(vma))) ||
-				  !zswap_never_enabled() ||
+				  zswap_present_test(swap, nr_pages) ||
 				  non_swapcache_batch(swap, nr_pages) != nr_pages))
 			fallback_order0 = true;
 
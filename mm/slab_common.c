@@ -2182,3 +2182,180 @@ void __init kvfree_rcu_init(void)
 
 #endif /* CONFIG_KVFREE_RCU_BATCHED */
 
+
+/*
+ * Deferred-free arenas batch RCU-deferred frees of objects that all belong
+ * to one kmem_cache. Objects are collected per CPU into page-sized blocks.
+ * A block waits for a grace period as a whole, with a single RCU callback,
+ * and its objects then go straight back to the cache in one bulk free.
+ */
+
+/* Maximum number of jiffies a partially filled block waits to be queued. */
+#define KMEM_RCU_ARENA_DRAIN_JIFFIES	HZ
+
+struct kmem_rcu_arena_block {
+	struct rcu_head rcu;
+	struct kmem_cache *s;
+	unsigned long nr;
+	void *objs[];
+};
+
+#define KMEM_RCU_ARENA_BLOCK_ENTR \
+	((PAGE_SIZE - sizeof(struct kmem_rcu_arena_block)) / sizeof(void *))
+
+struct kmem_rcu_arena_cpu {
+	spinlock_t lock;
+	struct kmem_rcu_arena_block *block;
+};
+
+struct kmem_rcu_arena {
+	struct kmem_cache *s;
+	struct kmem_rcu_arena_cpu __percpu *cpu;
+	struct delayed_work drain_work;
+};
+
+static void kmem_rcu_arena_block_free(struct rcu_head *rcu)
+{
+	struct kmem_rcu_arena_block *block;
+
+	block = container_of(rcu, struct kmem_rcu_arena_block, rcu);
+	kmem_cache_free_bulk(block->s, block->nr, block->objs);
+	free_page((unsigned long)block);
+}
+
+static void kmem_rcu_arena_drain_work(struct work_struct *work)
+{
+	struct kmem_rcu_arena *arena = container_of(to_delayed_work(work),
+					struct kmem_rcu_arena, drain_work);
+
+	kmem_rcu_arena_flush(arena);
+}
+
+/**
+ * kmem_rcu_arena_create - Create a deferred-free arena for a cache
+ * @s: The cache that all objects freed through the arena belong to
+ *
+ * Return: the new arena, or NULL if memory could not be allocated.
+ */
+struct kmem_rcu_arena *kmem_rcu_arena_create(struct kmem_cache *s)
+{
+	struct kmem_rcu_arena *arena;
+	int cpu;
+
+	arena = kzalloc(sizeof(*arena), GFP_KERNEL);
+	if (!arena)
+		return NULL;
+
+	arena->cpu = alloc_percpu(struct kmem_rcu_arena_cpu);
+	if (!arena->cpu) {
+		kfree(arena);
+		return NULL;
+	}
+
+	for_each_possible_cpu(cpu)
+		spin_lock_init(&per_cpu_ptr(arena->cpu, cpu)->lock);
+
+	arena->s = s;
+	INIT_DELAYED_WORK(&arena->drain_work, kmem_rcu_arena_drain_work);
+
+	return arena;
+}
+
+/**
+ * kmem_rcu_arena_free - Free an object after an RCU grace period
+ * @arena: The arena the object is freed through
+ * @obj: The object, allocated from the arena's cache
+ * @head: An rcu_head embedded in @obj
+ *
+ * The object is added to the current CPU's block and freed back to the
+ * arena's cache once a grace period has elapsed after the block is queued.
+ * @head is only used if no block can be allocated, in which case the free
+ * falls back to kvfree_rcu().
+ *
+ * Context: Any context.
+ */
+void kmem_rcu_arena_free(struct kmem_rcu_arena *arena, void *obj,
+			 struct rcu_head *head)
+{
+	struct kmem_rcu_arena_block *block, *full = NULL;
+	struct kmem_rcu_arena_cpu *ac;
+	unsigned long flags;
+	bool first = false;
+
+	ac = raw_cpu_ptr(arena->cpu);
+	spin_lock_irqsave(&ac->lock, flags);
+	block = ac->block;
+	if (!block) {
+		block = (void *)__get_free_page(GFP_NOWAIT | __GFP_NOWARN);
+		if (!block) {
+			spin_unlock_irqrestore(&ac->lock, flags);
+			kvfree_call_rcu(head, obj);
+			return;
+		}
+		block->s = arena->s;
+		block->nr = 0;
+		ac->block = block;
+		first = true;
+	}
+
+	block->objs[block->nr++] = obj;
+	if (block->nr == KMEM_RCU_ARENA_BLOCK_ENTR) {
+		ac->block = NULL;
+		full = block;
+	}
+	spin_unlock_irqrestore(&ac->lock, flags);
+
+	if (full)
+		call_rcu(&full->rcu, kmem_rcu_arena_block_free);
+	else if (first)
+		schedule_delayed_work(&arena->drain_work,
+				      KMEM_RCU_ARENA_DRAIN_JIFFIES);
+}
+
+/**
+ * kmem_rcu_arena_flush - Queue all partially filled blocks of an arena
+ * @arena: The arena to flush
+ *
+ * Start the grace period for every object freed through @arena so far
+ * instead of waiting for the blocks to fill up or for the drain timeout.
+ */
+void kmem_rcu_arena_flush(struct kmem_rcu_arena *arena)
+{
+	struct kmem_rcu_arena_block *block;
+	struct kmem_rcu_arena_cpu *ac;
+	unsigned long flags;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		ac = per_cpu_ptr(arena->cpu, cpu);
+		spin_lock_irqsave(&ac->lock, flags);
+		block = ac->block;
+		ac->block = NULL;
+		spin_unlock_irqrestore(&ac->lock, flags);
+
+		if (block)
+			call_rcu(&block->rcu, kmem_rcu_arena_block_free);
+	}
+}
+
+/**
+ * kmem_rcu_arena_destroy - Destroy a deferred-free arena
+ * @arena: The arena to destroy
+ *
+ * Waits until every object freed through @arena is back in its cache.
+ * Objects that fell back to kvfree_rcu() are waited for by
+ * kmem_cache_destroy(). The caller must ensure nothing is freed through
+ * @arena concurrently.
+ */
+void kmem_rcu_arena_destroy(struct kmem_rcu_arena *arena)
+{
+	if (!arena)
+		return;
+
+	cancel_delayed_work_sync(&arena->drain_work);
+	kmem_rcu_arena_flush(arena);
+	rcu_barrier();
+
+	free_percpu(arena->cpu);
+	kfree(arena);
+}
@@ -372,6 +372,8 @@ enum stat_item {
 	CPU_PARTIAL_FREE,	/* Refill cpu partial on free */
 	CPU_PARTIAL_NODE,	/* Refill cpu partial from node partial */
 	CPU_PARTIAL_DRAIN,	/* Drain cpu partial to node partial */
+	ALLOC_BULK_REFILL,	/* Bulk alloc refilled cpu freelist in place */
+	ALLOC_BULK_SLOWPATH,	/* Bulk alloc fell back to ___slab_alloc() */
 	NR_SLUB_STAT_ITEMS
 };
 
@@ -5250,6 +5252,56 @@ void kmem_cache_free_bulk(struct kmem_cache *s, size_t size, void **p)
 EXPORT_SYMBOL(kmem_cache_free_bulk);
 
 #ifndef CONFIG_SLUB_TINY
+/*
+ * Refill an empty c->freelist for kmem_cache_alloc_bulk() without dropping
+ * the local lock, which is a sleeping lock on PREEMPT_RT. The objects freed
+ * remotely to the cpu slab, or the whole freelist of the next cpu partial
+ * slab, are taken with a single cmpxchg on the slab freelist. Returns NULL
+ * if the caller has to go through ___slab_alloc().
+ */
+static void *bulk_refill_cpu_freelist(struct kmem_cache *s,
+				      struct kmem_cache_cpu *c, gfp_t gfpflags)
+{
+	struct slab *slab = c->slab;
+	void *freelist;
+
+	lockdep_assert_held(this_cpu_ptr(&s->cpu_slab->lock));
+
+	if (slab) {
+		/* Let ___slab_alloc() deactivate a mismatching slab */
+		if (unlikely(!pfmemalloc_match(slab, gfpflags)))
+			return NULL;
+
+		freelist = get_freelist(s, slab);
+		if (freelist)
+			goto load_freelist;
+
+		/* get_freelist() unfroze the now full slab */
+		c->slab = NULL;
+		stat(s, DEACTIVATE_BYPASS);
+	}
+
+#ifdef CONFIG_SLUB_CPU_PARTIAL
+	slab = slub_percpu_partial(c);
+	if (slab && likely(pfmemalloc_match(slab, gfpflags))) {
+		slub_set_percpu_partial(c, slab);
+		c->slab = slab;
+		freelist = get_freelist(s, slab);
+		VM_BUG_ON(!freelist);
+		stat(s, CPU_PARTIAL_ALLOC);
+		goto load_freelist;
+	}
+#endif
+	return NULL;
+
+load_freelist:
+	VM_BUG_ON(!c->slab->frozen);
+	c->freelist = freelist;
+	c->tid = next_tid(c->tid);
+	stat(s, ALLOC_BULK_REFILL);
+	return freelist;
+}
+
 static inline
 int __kmem_cache_alloc_bulk(struct kmem_cache *s, gfp_t flags, size_t size,
 			    void **p)
@@ -5275,6 +5327,8 @@ int __kmem_cache_alloc_bulk(struct kmem_cache *s, gfp_t flags, size_t size,
 		}
 
 		object = c->freelist;
+		if (unlikely(!object))
+			object = bulk_refill_cpu_freelist(s, c, flags);
 		if (unlikely(!object)) {
 			/*
 			 * We may have removed an object from c->freelist using
@@ -5286,6 +5340,7 @@ int __kmem_cache_alloc_bulk(struct kmem_cache *s, gfp_t flags, size_t size,
 			c->tid = next_tid(c->tid);
 
 			local_unlock_irqrestore(&s->cpu_slab->lock, irqflags);
+			stat(s, ALLOC_BULK_SLOWPATH);
 
 			/*
 			 * Invoking slow path likely have side-effect
@@ -7285,6 +7340,8 @@ STAT_ATTR(CPU_PARTIAL_ALLOC, cpu_partial_alloc);
 STAT_ATTR(CPU_PARTIAL_FREE, cpu_partial_free);
 STAT_ATTR(CPU_PARTIAL_NODE, cpu_partial_node);
 STAT_ATTR(CPU_PARTIAL_DRAIN, cpu_partial_drain);
+STAT_ATTR(ALLOC_BULK_REFILL, alloc_bulk_refill);
+STAT_ATTR(ALLOC_BULK_SLOWPATH, alloc_bulk_slowpath);
 #endif	/* CONFIG_SLUB_STATS */
 
 #ifdef CONFIG_KFENCE
@@ -7372,6 +7429,8 @@ static struct attribute *slab_attrs[] = {
 	&cpu_partial_free_attr.attr,
 	&cpu_partial_node_attr.attr,
 	&cpu_partial_drain_attr.attr,
+	&alloc_bulk_refill_attr.attr,
+	&alloc_bulk_slowpath_attr.attr,
 #endif
 #ifdef CONFIG_FAILSLAB
 	&failslab_attr.attr,
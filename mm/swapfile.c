@@ -533,6 +533,130 @@ static struct swap_cluster_info *isolate_lock_cluster(
 	return ret;
 }
 
+#define SWAP_CLUSTER_CACHE_EMPTY	UINT_MAX
+
+/*
+ * Lock a cluster claimed from a cluster cache. An allocation through a stale
+ * per-CPU offset may have put it back on a list meanwhile, skip it then.
+ */
+static struct swap_cluster_info *swap_cluster_cache_lock(
+		struct swap_info_struct *si, unsigned int idx, int order)
+{
+	struct swap_cluster_info *ci = &si->cluster_info[idx];
+
+	spin_lock(&ci->lock);
+	if (ci->flags != CLUSTER_FLAG_NONE) {
+		spin_unlock(&ci->lock);
+		return NULL;
+	}
+	if (!cluster_is_usable(ci, order)) {
+		relocate_cluster(si, ci);
+		spin_unlock(&ci->lock);
+		return NULL;
+	}
+	return ci;
+}
+
+static struct swap_cluster_info *swap_cluster_cache_pop(
+		struct swap_info_struct *si, struct swap_cluster_cache *cache,
+		int order)
+{
+	struct swap_cluster_info *ci;
+	unsigned int i, idx;
+
+	for (i = 0; i < SWAP_CLUSTER_CACHE_NR; i++) {
+		if (READ_ONCE(cache->idx[i]) == SWAP_CLUSTER_CACHE_EMPTY)
+			continue;
+		idx = xchg(&cache->idx[i], SWAP_CLUSTER_CACHE_EMPTY);
+		if (idx == SWAP_CLUSTER_CACHE_EMPTY)
+			continue;
+		ci = swap_cluster_cache_lock(si, idx, order);
+		if (ci)
+			return ci;
+	}
+	return NULL;
+}
+
+/*
+ * Like isolate_lock_cluster() on si->free_clusters, but refill the cluster
+ * cache of this CPU while holding si->lock, and fall back to the caches of
+ * other CPUs when the free list is empty.
+ *
+ * Can be called preemptible from get_swap_page_of_type(), the cache is only
+ * accessed with xchg() and cmpxchg().
+ */
+static struct swap_cluster_info *isolate_lock_free_cluster(
+		struct swap_info_struct *si, int order)
+{
+	struct swap_cluster_cache *cache;
+	struct swap_cluster_info *ci, *tmp, *ret = NULL;
+	unsigned int nr = 0;
+	int cpu;
+
+	if (!si->cluster_cache)
+		return isolate_lock_cluster(si, &si->free_clusters);
+
+	cache = raw_cpu_ptr(si->cluster_cache);
+	ret = swap_cluster_cache_pop(si, cache, order);
+	if (ret)
+		return ret;
+
+	spin_lock(&si->lock);
+	if (unlikely(!(si->flags & SWP_WRITEOK)))
+		goto out;
+
+	list_for_each_entry_safe(ci, tmp, &si->free_clusters, list) {
+		if (!spin_trylock(&ci->lock))
+			continue;
+		VM_BUG_ON(ci->flags != CLUSTER_FLAG_FREE);
+		if (ret && cmpxchg(&cache->idx[nr], SWAP_CLUSTER_CACHE_EMPTY,
+				   cluster_index(si, ci)) != SWAP_CLUSTER_CACHE_EMPTY) {
+			spin_unlock(&ci->lock);
+			break;
+		}
+		list_del(&ci->list);
+		ci->flags = CLUSTER_FLAG_NONE;
+		if (!ret) {
+			/* The first one is returned locked */
+			ret = ci;
+			continue;
+		}
+		spin_unlock(&ci->lock);
+		if (++nr == SWAP_CLUSTER_CACHE_NR)
+			break;
+	}
+out:
+	spin_unlock(&si->lock);
+	if (ret)
+		return ret;
+
+	for_each_possible_cpu(cpu) {
+		ret = swap_cluster_cache_pop(si, per_cpu_ptr(si->cluster_cache, cpu),
+					     order);
+		if (ret)
+			break;
+	}
+	return ret;
+}
+
+static int swap_cluster_cache_alloc(struct swap_info_struct *si)
+{
+	int cpu, i;
+
+	si->cluster_cache = alloc_percpu(struct swap_cluster_cache);
+	if (!si->cluster_cache)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu) {
+		struct swap_cluster_cache *cache;
+
+		cache = per_cpu_ptr(si->cluster_cache, cpu);
+		for (i = 0; i < SWAP_CLUSTER_CACHE_NR; i++)
+			cache->idx[i] = SWAP_CLUSTER_CACHE_EMPTY;
+	}
+	return 0;
+}
+
 /*
  * Doing discard actually. After a cluster discard is finished, the cluster
  * will be added to free cluster list. Discard cluster is a bit special as
@@ -913,7 +1037,7 @@ static unsigned long cluster_alloc_swap_entry(struct swap_info_struct *si, int o
 	}
 
 new_cluster:
-	ci = isolate_lock_cluster(si, &si->free_clusters);
+	ci = isolate_lock_free_cluster(si, order);
 	if (ci) {
 		found = alloc_swap_scan_cluster(si, ci, cluster_offset(si, ci),
 						order, usage);
@@ -2798,6 +2922,8 @@ SYSCALL_DEFINE1(swapoff, const char __user *, specialfile)
 	mutex_unlock(&swapon_mutex);
 	kfree(p->global_cluster);
 	p->global_cluster = NULL;
+	free_percpu(p->cluster_cache);
+	p->cluster_cache = NULL;
 	vfree(swap_map);
 	kvfree(zeromap);
 	kvfree(cluster_info);
@@ -3211,6 +3337,8 @@ static struct swap_cluster_info *setup_clusters(struct swap_info_struct *si,
 		for (i = 0; i < SWAP_NR_ORDERS; i++)
 			si->global_cluster->next[i] = SWAP_ENTRY_INVALID;
 		spin_lock_init(&si->global_cluster_lock);
+	} else if (swap_cluster_cache_alloc(si)) {
+		goto err_free;
 	}
 
 	/*
@@ -3491,6 +3619,8 @@ SYSCALL_DEFINE2(swapon, const char __user *, specialfile, int, swap_flags)
 bad_swap:
 	kfree(si->global_cluster);
 	si->global_cluster = NULL;
+	free_percpu(si->cluster_cache);
+	si->cluster_cache = NULL;
 	inode = NULL;
 	destroy_swap_extents(si);
 	swap_cgroup_swapoff(si->type);
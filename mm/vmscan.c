@@ -96,6 +96,9 @@ struct scan_control {
 #ifdef CONFIG_MEMCG
 	/* Swappiness value for proactive reclaim. Always use sc_swappiness()! */
 	int *proactive_swappiness;
+
+	/* Generation constraints and results of proactive reclaim */
+	struct lru_gen_reclaim_ctl *gen_ctl;
 #endif
 
 	/* Can active folios be deactivated as part of reclaim? */
@@ -4683,6 +4686,43 @@ static int get_type_to_scan(struct lruvec *lruvec, int swappiness)
 	return positive_ctrl_err(&sp, &pv);
 }
 
+static unsigned long sc_min_age(struct scan_control *sc)
+{
+#ifdef CONFIG_MEMCG
+	if (sc->gen_ctl)
+		return sc->gen_ctl->min_age;
+#endif
+	return 0;
+}
+
+/* whether the oldest generation of this type is too young for proactive reclaim */
+static bool oldest_gen_too_young(struct lruvec *lruvec, struct scan_control *sc, int type)
+{
+	struct lru_gen_folio *lrugen = &lruvec->lrugen;
+	unsigned long min_age = sc_min_age(sc);
+	int gen;
+
+	if (!min_age)
+		return false;
+
+	gen = lru_gen_from_seq(READ_ONCE(lrugen->min_seq[type]));
+	return time_is_after_jiffies(READ_ONCE(lrugen->timestamps[gen]) + min_age);
+}
+
+static void account_gen_reclaimed(struct lruvec *lruvec, struct scan_control *sc,
+				  unsigned long seq, int reclaimed)
+{
+#ifdef CONFIG_MEMCG
+	unsigned long dist;
+
+	if (!sc->gen_ctl)
+		return;
+
+	dist = READ_ONCE(lruvec->lrugen.max_seq) - seq;
+	sc->gen_ctl->nr_reclaimed[min(dist, MAX_NR_GENS - 1UL)] += reclaimed;
+#endif
+}
+
 static int isolate_folios(struct lruvec *lruvec, struct scan_control *sc, int swappiness,
 			  int *type_scanned, struct list_head *list)
 {
@@ -4695,6 +4735,11 @@ static int isolate_folios(struct lruvec *lruvec, struct scan_control *sc, int sw
 
 		*type_scanned = type;
 
+		if (oldest_gen_too_young(lruvec, sc, type)) {
+			type = !type;
+			continue;
+		}
+
 		scanned = scan_folios(lruvec, sc, type, tier, list);
 		if (scanned)
 			return scanned;
@@ -4721,10 +4766,12 @@ static int evict_folios(struct lruvec *lruvec, struct scan_control *sc, int swap
 	struct lru_gen_folio *lrugen = &lruvec->lrugen;
 	struct mem_cgroup *memcg = lruvec_memcg(lruvec);
 	struct pglist_data *pgdat = lruvec_pgdat(lruvec);
+	unsigned long seq;
 
 	spin_lock_irq(&lruvec->lru_lock);
 
 	scanned = isolate_folios(lruvec, sc, swappiness, &type, &list);
+	seq = lrugen->min_seq[type];
 
 	scanned += try_to_inc_min_seq(lruvec, swappiness);
 
@@ -4739,6 +4786,7 @@ static int evict_folios(struct lruvec *lruvec, struct scan_control *sc, int swap
 	reclaimed = shrink_folio_list(&list, pgdat, sc, &stat, false, memcg);
 	sc->nr.unqueued_dirty += stat.nr_unqueued_dirty;
 	sc->nr_reclaimed += reclaimed;
+	account_gen_reclaimed(lruvec, sc, seq, reclaimed);
 	trace_mm_vmscan_lru_shrink_inactive(pgdat->node_id,
 			scanned, reclaimed, &stat, sc->priority,
 			type ? LRU_INACTIVE_FILE : LRU_INACTIVE_ANON);
@@ -4849,6 +4897,10 @@ static long get_nr_to_scan(struct lruvec *lruvec, struct scan_control *sc, int s
 	if (!success || sc->priority == DEF_PRIORITY)
 		return nr_to_scan >> sc->priority;
 
+	/* aging only makes younger generations, which an age limit excludes */
+	if (sc_min_age(sc))
+		return nr_to_scan >> sc->priority;
+
 	/* stop scanning this lruvec as it's low on cold folios */
 	return try_to_inc_max_seq(lruvec, max_seq, swappiness, false) ? -1 : 0;
 }
@@ -6681,17 +6733,19 @@ unsigned long mem_cgroup_shrink_node(struct mem_cgroup *memcg,
 	return sc.nr_reclaimed;
 }
 
-unsigned long try_to_free_mem_cgroup_pages(struct mem_cgroup *memcg,
+unsigned long try_to_free_mem_cgroup_pages_gen(struct mem_cgroup *memcg,
 					   unsigned long nr_pages,
 					   gfp_t gfp_mask,
 					   unsigned int reclaim_options,
-					   int *swappiness)
+					   int *swappiness,
+					   struct lru_gen_reclaim_ctl *ctl)
 {
 	unsigned long nr_reclaimed;
 	unsigned int noreclaim_flag;
 	struct scan_control sc = {
 		.nr_to_reclaim = max(nr_pages, SWAP_CLUSTER_MAX),
 		.proactive_swappiness = swappiness,
+		.gen_ctl = ctl,
 		.gfp_mask = (current_gfp_context(gfp_mask) & GFP_RECLAIM_MASK) |
 				(GFP_HIGHUSER_MOVABLE & ~GFP_RECLAIM_MASK),
 		.reclaim_idx = MAX_NR_ZONES - 1,
@@ -6721,6 +6775,17 @@ unsigned long try_to_free_mem_cgroup_pages(struct mem_cgroup *memcg,
 
 	return nr_reclaimed;
 }
+
+unsigned long try_to_free_mem_cgroup_pages(struct mem_cgroup *memcg,
+					   unsigned long nr_pages,
+					   gfp_t gfp_mask,
+					   unsigned int reclaim_options,
+					   int *swappiness)
+{
+	return try_to_free_mem_cgroup_pages_gen(memcg, nr_pages, gfp_mask,
+						reclaim_options, swappiness,
+						NULL);
+}
 #endif
 
 static void kswapd_age_node(struct pglist_data *pgdat, struct scan_control *sc)
@@ -1281,6 +1281,10 @@ const char * const vmstat_text[] = {
 	"nr_hugetlb",
 #endif
 	"nr_balloon_pages",
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+	"khugepaged_collapsed",
+	"khugepaged_full_scans",
+#endif
 	/* system-wide enum vm_stat_item counters */
 	"nr_dirty_threshold",
 	"nr_dirty_background_threshold",
@@ -1326,6 +1330,8 @@ const char * const vmstat_text[] = {
 #ifdef CONFIG_NUMA
 	"zone_reclaim_success",
 	"zone_reclaim_failed",
+	"pcp_steal_hit",
+	"pcp_steal_miss",
 #endif
 	"pginodesteal",
 	"slabs_scanned",
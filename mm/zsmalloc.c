@@ -18,9 +18,14 @@
 /*
  * lock ordering:
  *	page_lock
- *	pool->lock
+ *	handle lock (read)
  *	class->lock
  *	zspage->lock
+ *	handle lock (write, trylock only)
+ *
+ * Handle locks are hashed per pool and pin the handle -> object mapping.
+ * Compaction and page migration move objects with class->lock held, so
+ * they can only trylock the handle locks and back off on contention.
  */
 
 #include <linux/module.h>
@@ -38,6 +43,9 @@
 #include <linux/zsmalloc.h>
 #include <linux/zpool.h>
 #include <linux/fs.h>
+#include <linux/bitmap.h>
+#include <linux/hash.h>
+#include <linux/sched/clock.h>
 #include <linux/workqueue.h>
 #include "zpdesc.h"
 
@@ -53,6 +61,9 @@
 
 #define ZS_HANDLE_SIZE (sizeof(unsigned long))
 
+#define ZS_HANDLE_LOCK_BITS	6
+#define ZS_HANDLE_LOCKS		(1 << ZS_HANDLE_LOCK_BITS)
+
 /*
  * Object location (<PFN>, <obj_idx>) is encoded as
  * a single (unsigned long) handle value.
@@ -171,6 +182,15 @@ struct size_class {
 
 	unsigned int index;
 	struct zs_size_stat stats;
+	/* only one compactor per class, other classes proceed in parallel */
+	atomic_t compaction_in_progress;
+#ifdef CONFIG_ZSMALLOC_STAT
+	/* contended class->lock acquisitions and time spent waiting */
+	unsigned long lock_waits;
+	u64 lock_wait_ns;
+	/* compaction passes cut short by a busy handle lock */
+	unsigned long compact_busy;
+#endif
 };
 
 /*
@@ -213,9 +233,8 @@ struct zs_pool {
 #ifdef CONFIG_COMPACTION
 	struct work_struct free_work;
 #endif
-	/* protect zspage migration/compaction */
-	rwlock_t lock;
-	atomic_t compaction_in_progress;
+	/* protect handle -> object lookups against migration/compaction */
+	rwlock_t handle_locks[ZS_HANDLE_LOCKS];
 };
 
 static inline void zpdesc_set_first(struct zpdesc *zpdesc)
@@ -597,6 +616,46 @@ static inline unsigned long class_stat_read(struct size_class *class, int type)
 	return class->stats.objs[type];
 }
 
+#ifdef CONFIG_ZSMALLOC_STAT
+static inline void class_lock(struct size_class *class)
+{
+	u64 start;
+
+	if (spin_trylock(&class->lock))
+		return;
+
+	start = local_clock();
+	spin_lock(&class->lock);
+	class->lock_waits++;
+	class->lock_wait_ns += local_clock() - start;
+}
+
+/* Must be called with class->lock held */
+static inline void class_stat_compact_busy(struct size_class *class)
+{
+	class->compact_busy++;
+}
+#else
+static inline void class_lock(struct size_class *class)
+{
+	spin_lock(&class->lock);
+}
+
+static inline void class_stat_compact_busy(struct size_class *class)
+{
+}
+#endif
+
+static inline void class_unlock(struct size_class *class)
+{
+	spin_unlock(&class->lock);
+}
+
+static inline rwlock_t *handle_lock(struct zs_pool *pool, unsigned long handle)
+{
+	return &pool->handle_locks[hash_long(handle, ZS_HANDLE_LOCK_BITS)];
+}
+
 #ifdef CONFIG_ZSMALLOC_STAT
 
 static void __init zs_stat_init(void)
@@ -640,7 +699,7 @@ static int zs_stats_size_show(struct seq_file *s, void *v)
 		if (class->index != i)
 			continue;
 
-		spin_lock(&class->lock);
+		class_lock(class);
 
 		seq_printf(s, " %5u %5u ", i, class->size);
 		for (fg = ZS_INUSE_RATIO_10; fg < NR_FULLNESS_GROUPS; fg++) {
@@ -651,7 +710,7 @@ static int zs_stats_size_show(struct seq_file *s, void *v)
 		obj_allocated = class_stat_read(class, ZS_OBJS_ALLOCATED);
 		obj_used = class_stat_read(class, ZS_OBJS_INUSE);
 		freeable = zs_can_compact(class);
-		spin_unlock(&class->lock);
+		class_unlock(class);
 
 		objs_per_zspage = class->objs_per_zspage;
 		pages_used = obj_allocated / objs_per_zspage *
@@ -681,6 +740,45 @@ static int zs_stats_size_show(struct seq_file *s, void *v)
 }
 DEFINE_SHOW_ATTRIBUTE(zs_stats_size);
 
+static int zs_stats_locks_show(struct seq_file *s, void *v)
+{
+	int i;
+	struct zs_pool *pool = s->private;
+	struct size_class *class;
+	unsigned long obj_allocated, obj_used, lock_waits, compact_busy;
+	unsigned int frag;
+	u64 lock_wait_ns;
+
+	seq_printf(s, " %5s %5s %6s %8s %12s %14s %12s\n",
+			"class", "size", "frag%", "freeable", "lock_waits",
+			"lock_wait_us", "compact_busy");
+
+	for (i = 0; i < ZS_SIZE_CLASSES; i++) {
+		class = pool->size_class[i];
+
+		if (class->index != i)
+			continue;
+
+		spin_lock(&class->lock);
+		obj_allocated = class_stat_read(class, ZS_OBJS_ALLOCATED);
+		obj_used = class_stat_read(class, ZS_OBJS_INUSE);
+		frag = obj_allocated ? (obj_allocated - obj_used) * 100 /
+					obj_allocated : 0;
+		seq_printf(s, " %5u %5u %6u %8lu ", i, class->size, frag,
+			   zs_can_compact(class));
+		lock_waits = class->lock_waits;
+		lock_wait_ns = class->lock_wait_ns;
+		compact_busy = class->compact_busy;
+		spin_unlock(&class->lock);
+
+		seq_printf(s, "%12lu %14llu %12lu\n", lock_waits,
+			   div_u64(lock_wait_ns, NSEC_PER_USEC), compact_busy);
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(zs_stats_locks);
+
 static void zs_pool_stat_create(struct zs_pool *pool, const char *name)
 {
 	if (!zs_stat_root) {
@@ -692,6 +790,8 @@ static void zs_pool_stat_create(struct zs_pool *pool, const char *name)
 
 	debugfs_create_file("classes", S_IFREG | 0444, pool->stat_dentry, pool,
 			    &zs_stats_size_fops);
+	debugfs_create_file("locks", S_IFREG | 0444, pool->stat_dentry, pool,
+			    &zs_stats_locks_fops);
 }
 
 static void zs_pool_stat_destroy(struct zs_pool *pool)
@@ -1141,6 +1241,7 @@ EXPORT_SYMBOL_GPL(zs_get_total_pages);
 void *zs_obj_read_begin(struct zs_pool *pool, unsigned long handle,
 			void *local_copy)
 {
+	rwlock_t *lock;
 	struct zspage *zspage;
 	struct zpdesc *zpdesc;
 	unsigned long obj, off;
@@ -1149,14 +1250,15 @@ void *zs_obj_read_begin(struct zs_pool *pool, unsigned long handle,
 	void *addr;
 
 	/* Guarantee we can get zspage from handle safely */
-	read_lock(&pool->lock);
+	lock = handle_lock(pool, handle);
+	read_lock(lock);
 	obj = handle_to_obj(handle);
 	obj_to_location(obj, &zpdesc, &obj_idx);
 	zspage = get_zspage(zpdesc);
 
 	/* Make sure migration doesn't move any pages in this zspage */
 	zspage_read_lock(zspage);
-	read_unlock(&pool->lock);
+	read_unlock(lock);
 
 	class = zspage_class(pool, zspage);
 	off = offset_in_page(class->size * obj_idx);
@@ -1217,6 +1319,7 @@ EXPORT_SYMBOL_GPL(zs_obj_read_end);
 void zs_obj_write(struct zs_pool *pool, unsigned long handle,
 		  void *handle_mem, size_t mem_len)
 {
+	rwlock_t *lock;
 	struct zspage *zspage;
 	struct zpdesc *zpdesc;
 	unsigned long obj, off;
@@ -1224,14 +1327,15 @@ void zs_obj_write(struct zs_pool *pool, unsigned long handle,
 	struct size_class *class;
 
 	/* Guarantee we can get zspage from handle safely */
-	read_lock(&pool->lock);
+	lock = handle_lock(pool, handle);
+	read_lock(lock);
 	obj = handle_to_obj(handle);
 	obj_to_location(obj, &zpdesc, &obj_idx);
 	zspage = get_zspage(zpdesc);
 
 	/* Make sure migration doesn't move any pages in this zspage */
 	zspage_read_lock(zspage);
-	read_unlock(&pool->lock);
+	read_unlock(lock);
 
 	class = zspage_class(pool, zspage);
 	off = offset_in_page(class->size * obj_idx);
@@ -1358,7 +1462,7 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t gfp,
 	class = pool->size_class[get_size_class_index(size)];
 
 	/* class->lock effectively protects the zpage migration */
-	spin_lock(&class->lock);
+	class_lock(class);
 	zspage = find_get_zspage(class);
 	if (likely(zspage)) {
 		obj_malloc(pool, zspage, handle);
@@ -1369,7 +1473,7 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t gfp,
 		goto out;
 	}
 
-	spin_unlock(&class->lock);
+	class_unlock(class);
 
 	zspage = alloc_zspage(pool, class, gfp, nid);
 	if (!zspage) {
@@ -1377,7 +1481,7 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t gfp,
 		return (unsigned long)ERR_PTR(-ENOMEM);
 	}
 
-	spin_lock(&class->lock);
+	class_lock(class);
 	obj_malloc(pool, zspage, handle);
 	newfg = get_fullness_group(class, zspage);
 	insert_zspage(class, zspage, newfg);
@@ -1388,7 +1492,7 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t gfp,
 	/* We completely set up zspage so mark them as movable */
 	SetZsPageMovable(pool, zspage);
 out:
-	spin_unlock(&class->lock);
+	class_unlock(class);
 
 	return handle;
 }
@@ -1428,22 +1532,24 @@ void zs_free(struct zs_pool *pool, unsigned long handle)
 	struct zpdesc *f_zpdesc;
 	unsigned long obj;
 	struct size_class *class;
+	rwlock_t *lock;
 	int fullness;
 
 	if (IS_ERR_OR_NULL((void *)handle))
 		return;
 
 	/*
-	 * The pool->lock protects the race with zpage's migration
+	 * The handle lock protects the race with zpage's migration
 	 * so it's safe to get the page from handle.
 	 */
-	read_lock(&pool->lock);
+	lock = handle_lock(pool, handle);
+	read_lock(lock);
 	obj = handle_to_obj(handle);
 	obj_to_zpdesc(obj, &f_zpdesc);
 	zspage = get_zspage(f_zpdesc);
 	class = zspage_class(pool, zspage);
-	spin_lock(&class->lock);
-	read_unlock(&pool->lock);
+	class_lock(class);
+	read_unlock(lock);
 
 	class_stat_sub(class, ZS_OBJS_INUSE, 1);
 	obj_free(class->size, obj);
@@ -1452,7 +1558,7 @@ void zs_free(struct zs_pool *pool, unsigned long handle)
 	if (fullness == ZS_INUSE_RATIO_0)
 		free_zspage(pool, class, zspage);
 
-	spin_unlock(&class->lock);
+	class_unlock(class);
 	cache_free_handle(pool, handle);
 }
 EXPORT_SYMBOL_GPL(zs_free);
@@ -1557,11 +1663,16 @@ static unsigned long find_alloced_obj(struct size_class *class,
 	return handle;
 }
 
-static void migrate_zspage(struct zs_pool *pool, struct zspage *src_zspage,
+/*
+ * Returns false if a reader held the handle lock of one of the objects,
+ * in which case @src_zspage is left partially migrated.
+ */
+static bool migrate_zspage(struct zs_pool *pool, struct zspage *src_zspage,
 			   struct zspage *dst_zspage)
 {
 	unsigned long used_obj, free_obj;
 	unsigned long handle;
+	rwlock_t *lock;
 	int obj_idx = 0;
 	struct zpdesc *s_zpdesc = get_first_zpdesc(src_zspage);
 	struct size_class *class = pool->size_class[src_zspage->class];
@@ -1576,9 +1687,14 @@ static void migrate_zspage(struct zs_pool *pool, struct zspage *src_zspage,
 			continue;
 		}
 
+		lock = handle_lock(pool, handle);
+		if (!write_trylock(lock))
+			return false;
+
 		used_obj = handle_to_obj(handle);
 		free_obj = obj_malloc(pool, dst_zspage, handle);
 		zs_object_copy(class, free_obj, used_obj);
+		write_unlock(lock);
 		obj_idx++;
 		obj_free(class->size, used_obj);
 
@@ -1590,6 +1706,8 @@ static void migrate_zspage(struct zs_pool *pool, struct zspage *src_zspage,
 		if (zspage_empty(src_zspage))
 			break;
 	}
+
+	return true;
 }
 
 static struct zspage *isolate_src_zspage(struct size_class *class)
@@ -1727,9 +1845,51 @@ static bool zs_page_isolate(struct page *page, isolate_mode_t mode)
 	return true;
 }
 
+/*
+ * Write-lock the handle locks of all objects starting in @zpdesc. They
+ * are trylocked because class->lock and the zspage lock are held; on
+ * failure nothing is left locked.
+ */
+static bool trylock_zpdesc_handles(struct zs_pool *pool,
+				   struct size_class *class,
+				   struct zpdesc *zpdesc, unsigned long *locks)
+{
+	unsigned int bit, i;
+	unsigned long handle;
+	void *s_addr, *addr;
+
+	bitmap_zero(locks, ZS_HANDLE_LOCKS);
+	s_addr = kmap_local_zpdesc(zpdesc);
+	for (addr = s_addr + get_first_obj_offset(zpdesc);
+	     addr < s_addr + PAGE_SIZE; addr += class->size) {
+		if (obj_allocated(zpdesc, addr, &handle))
+			__set_bit(hash_long(handle, ZS_HANDLE_LOCK_BITS), locks);
+	}
+	kunmap_local(s_addr);
+
+	for_each_set_bit(bit, locks, ZS_HANDLE_LOCKS) {
+		if (write_trylock(&pool->handle_locks[bit]))
+			continue;
+		for_each_set_bit(i, locks, bit)
+			write_unlock(&pool->handle_locks[i]);
+		return false;
+	}
+
+	return true;
+}
+
+static void unlock_zpdesc_handles(struct zs_pool *pool, unsigned long *locks)
+{
+	unsigned int bit;
+
+	for_each_set_bit(bit, locks, ZS_HANDLE_LOCKS)
+		write_unlock(&pool->handle_locks[bit]);
+}
+
 static int zs_page_migrate(struct page *newpage, struct page *page,
 		enum migrate_mode mode)
 {
+	DECLARE_BITMAP(locks, ZS_HANDLE_LOCKS);
 	struct zs_pool *pool;
 	struct size_class *class;
 	struct zspage *zspage;
@@ -1748,21 +1908,25 @@ static int zs_page_migrate(struct page *newpage, struct page *page,
 	zspage = get_zspage(zpdesc);
 	pool = zspage->pool;
 
-	/*
-	 * The pool migrate_lock protects the race between zpage migration
-	 * and zs_free.
-	 */
-	write_lock(&pool->lock);
 	class = zspage_class(pool, zspage);
 
 	/*
 	 * the class lock protects zpage alloc/free in the zspage.
 	 */
-	spin_lock(&class->lock);
+	class_lock(class);
 	/* the zspage write_lock protects zpage access via zs_obj_read/write() */
 	if (!zspage_write_trylock(zspage)) {
-		spin_unlock(&class->lock);
-		write_unlock(&pool->lock);
+		class_unlock(class);
+		return -EINVAL;
+	}
+
+	/*
+	 * The handle locks protect the race between zpage migration
+	 * and handle lookups in zs_free() and zs_obj_read/write().
+	 */
+	if (!trylock_zpdesc_handles(pool, class, zpdesc, locks)) {
+		zspage_write_unlock(zspage);
+		class_unlock(class);
 		return -EINVAL;
 	}
 
@@ -1794,10 +1958,10 @@ static int zs_page_migrate(struct page *newpage, struct page *page,
 	replace_sub_page(class, zspage, newzpdesc, zpdesc);
 	/*
 	 * Since we complete the data copy and set up new zspage structure,
-	 * it's okay to release migration_lock.
+	 * it's okay to release the handle locks.
 	 */
-	write_unlock(&pool->lock);
-	spin_unlock(&class->lock);
+	unlock_zpdesc_handles(pool, locks);
+	class_unlock(class);
 	zspage_write_unlock(zspage);
 
 	zpdesc_get(newzpdesc);
@@ -1841,10 +2005,10 @@ static void async_free_zspage(struct work_struct *work)
 		if (class->index != i)
 			continue;
 
-		spin_lock(&class->lock);
+		class_lock(class);
 		list_splice_init(&class->fullness_list[ZS_INUSE_RATIO_0],
 				 &free_pages);
-		spin_unlock(&class->lock);
+		class_unlock(class);
 	}
 
 	list_for_each_entry_safe(zspage, tmp, &free_pages, list) {
@@ -1852,10 +2016,10 @@ static void async_free_zspage(struct work_struct *work)
 		lock_zspage(zspage);
 
 		class = zspage_class(pool, zspage);
-		spin_lock(&class->lock);
+		class_lock(class);
 		class_stat_sub(class, ZS_INUSE_RATIO_0, 1);
 		__free_zspage(pool, class, zspage);
-		spin_unlock(&class->lock);
+		class_unlock(class);
 	}
 };
 
@@ -1916,12 +2080,12 @@ static unsigned long __zs_compact(struct zs_pool *pool,
 	unsigned long pages_freed = 0;
 
 	/*
-	 * protect the race between zpage migration and zs_free
-	 * as well as zpage allocation/free
+	 * protect the race between zpage migration and zpage allocation/free,
+	 * handle lookups are fenced off per object in migrate_zspage()
 	 */
-	write_lock(&pool->lock);
-	spin_lock(&class->lock);
+	class_lock(class);
 	while (zs_can_compact(class)) {
+		bool busy;
 		int fg;
 
 		if (!dst_zspage) {
@@ -1937,7 +2101,7 @@ static unsigned long __zs_compact(struct zs_pool *pool,
 		if (!zspage_write_trylock(src_zspage))
 			break;
 
-		migrate_zspage(pool, src_zspage, dst_zspage);
+		busy = !migrate_zspage(pool, src_zspage, dst_zspage);
 		zspage_write_unlock(src_zspage);
 
 		fg = putback_zspage(class, src_zspage);
@@ -1947,16 +2111,19 @@ static unsigned long __zs_compact(struct zs_pool *pool,
 		}
 		src_zspage = NULL;
 
+		if (busy) {
+			class_stat_compact_busy(class);
+			break;
+		}
+
 		if (get_fullness_group(class, dst_zspage) == ZS_INUSE_RATIO_100
-		    || rwlock_is_contended(&pool->lock)) {
+		    || spin_is_contended(&class->lock)) {
 			putback_zspage(class, dst_zspage);
 			dst_zspage = NULL;
 
-			spin_unlock(&class->lock);
-			write_unlock(&pool->lock);
+			class_unlock(class);
 			cond_resched();
-			write_lock(&pool->lock);
-			spin_lock(&class->lock);
+			class_lock(class);
 		}
 	}
 
@@ -1966,8 +2133,7 @@ static unsigned long __zs_compact(struct zs_pool *pool,
 	if (dst_zspage)
 		putback_zspage(class, dst_zspage);
 
-	spin_unlock(&class->lock);
-	write_unlock(&pool->lock);
+	class_unlock(class);
 
 	return pages_freed;
 }
@@ -1979,22 +2145,21 @@ unsigned long zs_compact(struct zs_pool *pool)
 	unsigned long pages_freed = 0;
 
 	/*
-	 * Pool compaction is performed under pool->lock so it is basically
-	 * single-threaded. Having more than one thread in __zs_compact()
-	 * will increase pool->lock contention, which will impact other
-	 * zsmalloc operations that need pool->lock.
+	 * Compaction only serializes on class->lock, so concurrent callers
+	 * can work on different classes. Having more than one thread in
+	 * __zs_compact() for the same class would only add class->lock
+	 * contention for zs_malloc()/zs_free(), so skip busy classes.
 	 */
-	if (atomic_xchg(&pool->compaction_in_progress, 1))
-		return 0;
-
 	for (i = ZS_SIZE_CLASSES - 1; i >= 0; i--) {
 		class = pool->size_class[i];
 		if (class->index != i)
 			continue;
+		if (atomic_xchg(&class->compaction_in_progress, 1))
+			continue;
 		pages_freed += __zs_compact(pool, class);
+		atomic_set(&class->compaction_in_progress, 0);
 	}
 	atomic_long_add(pages_freed, &pool->stats.pages_compacted);
-	atomic_set(&pool->compaction_in_progress, 0);
 
 	return pages_freed;
 }
@@ -2104,8 +2269,8 @@ struct zs_pool *zs_create_pool(const char *name)
 		return NULL;
 
 	init_deferred_free(pool);
-	rwlock_init(&pool->lock);
-	atomic_set(&pool->compaction_in_progress, 0);
+	for (i = 0; i < ZS_HANDLE_LOCKS; i++)
+		rwlock_init(&pool->handle_locks[i]);
 
 	pool->name = kstrdup(name, GFP_KERNEL);
 	if (!pool->name)
@@ -143,11 +143,19 @@ bool zswap_never_enabled(void)
 * data structures
 **********************************/
 
+/*
+ * Subpages of a large folio compressed with concurrently outstanding
+ * requests. Only asynchronous compressors get more than one request, a
+ * synchronous one would just process the batch sequentially.
+ */
+#define ZSWAP_MAX_BATCH_SIZE	8
+
 struct crypto_acomp_ctx {
 	struct crypto_acomp *acomp;
-	struct acomp_req *req;
-	struct crypto_wait wait;
-	u8 *buffer;
+	struct acomp_req *reqs[ZSWAP_MAX_BATCH_SIZE];
+	struct crypto_wait waits[ZSWAP_MAX_BATCH_SIZE];
+	u8 *buffers[ZSWAP_MAX_BATCH_SIZE];
+	unsigned int nr_reqs;
 	struct mutex mutex;
 	bool is_sleepable;
 };
@@ -818,21 +826,31 @@ static void zswap_entry_free(struct zswap_entry *entry)
 /*********************************
 * compressed storage functions
 **********************************/
+static void zswap_cpu_comp_free(struct crypto_acomp *acomp,
+				struct acomp_req **reqs, u8 **buffers,
+				unsigned int nr)
+{
+	unsigned int i;
+
+	for (i = 0; i < nr; i++) {
+		if (!IS_ERR_OR_NULL(reqs[i]))
+			acomp_request_free(reqs[i]);
+		kfree(buffers[i]);
+	}
+	if (!IS_ERR_OR_NULL(acomp))
+		crypto_free_acomp(acomp);
+}
+
 static int zswap_cpu_comp_prepare(unsigned int cpu, struct hlist_node *node)
 {
 	struct zswap_pool *pool = hlist_entry(node, struct zswap_pool, node);
 	struct crypto_acomp_ctx *acomp_ctx = per_cpu_ptr(pool->acomp_ctx, cpu);
+	struct acomp_req *reqs[ZSWAP_MAX_BATCH_SIZE] = {};
+	u8 *buffers[ZSWAP_MAX_BATCH_SIZE] = {};
 	struct crypto_acomp *acomp = NULL;
-	struct acomp_req *req = NULL;
-	u8 *buffer = NULL;
+	unsigned int i, nr_reqs;
 	int ret;
 
-	buffer = kmalloc_node(PAGE_SIZE * 2, GFP_KERNEL, cpu_to_node(cpu));
-	if (!buffer) {
-		ret = -ENOMEM;
-		goto fail;
-	}
-
 	acomp = crypto_alloc_acomp_node(pool->tfm_name, 0, 0, cpu_to_node(cpu));
 	if (IS_ERR(acomp)) {
 		pr_err("could not alloc crypto acomp %s : %ld\n",
@@ -841,12 +859,22 @@ static int zswap_cpu_comp_prepare(unsigned int cpu, struct hlist_node *node)
 		goto fail;
 	}
 
-	req = acomp_request_alloc(acomp);
-	if (!req) {
-		pr_err("could not alloc crypto acomp_request %s\n",
-		       pool->tfm_name);
-		ret = -ENOMEM;
-		goto fail;
+	nr_reqs = acomp_is_async(acomp) ? ZSWAP_MAX_BATCH_SIZE : 1;
+	for (i = 0; i < nr_reqs; i++) {
+		buffers[i] = kmalloc_node(PAGE_SIZE * 2, GFP_KERNEL,
+					  cpu_to_node(cpu));
+		if (!buffers[i]) {
+			ret = -ENOMEM;
+			goto fail;
+		}
+
+		reqs[i] = acomp_request_alloc(acomp);
+		if (!reqs[i]) {
+			pr_err("could not alloc crypto acomp_request %s\n",
+			       pool->tfm_name);
+			ret = -ENOMEM;
+			goto fail;
+		}
 	}
 
 	/*
@@ -855,27 +883,29 @@ static int zswap_cpu_comp_prepare(unsigned int cpu, struct hlist_node *node)
 	 * again resulting in a deadlock.
 	 */
 	mutex_lock(&acomp_ctx->mutex);
-	crypto_init_wait(&acomp_ctx->wait);
+	for (i = 0; i < nr_reqs; i++) {
+		crypto_init_wait(&acomp_ctx->waits[i]);
 
-	/*
-	 * if the backend of acomp is async zip, crypto_req_done() will wakeup
-	 * crypto_wait_req(); if the backend of acomp is scomp, the callback
-	 * won't be called, crypto_wait_req() will return without blocking.
-	 */
-	acomp_request_set_callback(req, CRYPTO_TFM_REQ_MAY_BACKLOG,
-				   crypto_req_done, &acomp_ctx->wait);
+		/*
+		 * if the backend of acomp is async zip, crypto_req_done() will
+		 * wakeup crypto_wait_req(); if the backend of acomp is scomp,
+		 * the callback won't be called, crypto_wait_req() will return
+		 * without blocking.
+		 */
+		acomp_request_set_callback(reqs[i], CRYPTO_TFM_REQ_MAY_BACKLOG,
+					   crypto_req_done, &acomp_ctx->waits[i]);
 
-	acomp_ctx->buffer = buffer;
+		acomp_ctx->buffers[i] = buffers[i];
+		acomp_ctx->reqs[i] = reqs[i];
+	}
 	acomp_ctx->acomp = acomp;
 	acomp_ctx->is_sleepable = acomp_is_async(acomp);
-	acomp_ctx->req = req;
+	acomp_ctx->nr_reqs = nr_reqs;
 	mutex_unlock(&acomp_ctx->mutex);
 	return 0;
 
 fail:
-	if (acomp)
-		crypto_free_acomp(acomp);
-	kfree(buffer);
+	zswap_cpu_comp_free(acomp, reqs, buffers, ZSWAP_MAX_BATCH_SIZE);
 	return ret;
 }
 
@@ -883,31 +913,32 @@ static int zswap_cpu_comp_dead(unsigned int cpu, struct hlist_node *node)
 {
 	struct zswap_pool *pool = hlist_entry(node, struct zswap_pool, node);
 	struct crypto_acomp_ctx *acomp_ctx = per_cpu_ptr(pool->acomp_ctx, cpu);
-	struct acomp_req *req;
+	struct acomp_req *reqs[ZSWAP_MAX_BATCH_SIZE];
+	u8 *buffers[ZSWAP_MAX_BATCH_SIZE];
 	struct crypto_acomp *acomp;
-	u8 *buffer;
+	unsigned int i, nr_reqs;
 
 	if (IS_ERR_OR_NULL(acomp_ctx))
 		return 0;
 
 	mutex_lock(&acomp_ctx->mutex);
-	req = acomp_ctx->req;
+	nr_reqs = acomp_ctx->nr_reqs;
+	for (i = 0; i < nr_reqs; i++) {
+		reqs[i] = acomp_ctx->reqs[i];
+		buffers[i] = acomp_ctx->buffers[i];
+		acomp_ctx->reqs[i] = NULL;
+		acomp_ctx->buffers[i] = NULL;
+	}
 	acomp = acomp_ctx->acomp;
-	buffer = acomp_ctx->buffer;
-	acomp_ctx->req = NULL;
 	acomp_ctx->acomp = NULL;
-	acomp_ctx->buffer = NULL;
+	acomp_ctx->nr_reqs = 0;
 	mutex_unlock(&acomp_ctx->mutex);
 
 	/*
 	 * Do the actual freeing after releasing the mutex to avoid subtle
 	 * locking dependencies causing deadlocks.
 	 */
-	if (!IS_ERR_OR_NULL(req))
-		acomp_request_free(req);
-	if (!IS_ERR_OR_NULL(acomp))
-		crypto_free_acomp(acomp);
-	kfree(buffer);
+	zswap_cpu_comp_free(acomp, reqs, buffers, nr_reqs);
 
 	return 0;
 }
@@ -919,7 +950,7 @@ static struct crypto_acomp_ctx *acomp_ctx_get_cpu_lock(struct zswap_pool *pool)
 	for (;;) {
 		acomp_ctx = raw_cpu_ptr(pool->acomp_ctx);
 		mutex_lock(&acomp_ctx->mutex);
-		if (likely(acomp_ctx->req))
+		if (likely(acomp_ctx->reqs[0]))
 			return acomp_ctx;
 		/*
 		 * It is possible that we were migrated to a different CPU after
@@ -937,68 +968,94 @@ static void acomp_ctx_put_unlock(struct crypto_acomp_ctx *acomp_ctx)
 	mutex_unlock(&acomp_ctx->mutex);
 }
 
-static bool zswap_compress(struct page *page, struct zswap_entry *entry,
-			   struct zswap_pool *pool)
+/*
+ * Compress @nr subpages of @folio starting at @start into newly allocated
+ * zpool objects, recorded in @entries. Up to acomp_ctx->nr_reqs subpages
+ * are submitted before the first completion is waited for, so that an
+ * offload engine can work on all of them at once. The zpool objects of a
+ * batch are allocated together once it has completed.
+ */
+static bool zswap_compress(struct folio *folio, long start, unsigned int nr,
+			   struct zswap_entry **entries, struct zswap_pool *pool)
 {
+	struct scatterlist inputs[ZSWAP_MAX_BATCH_SIZE];
+	struct scatterlist outputs[ZSWAP_MAX_BATCH_SIZE];
+	int comp_ret[ZSWAP_MAX_BATCH_SIZE];
 	struct crypto_acomp_ctx *acomp_ctx;
-	struct scatterlist input, output;
-	int comp_ret = 0, alloc_ret = 0;
-	unsigned int dlen = PAGE_SIZE;
+	unsigned int i, j, batch, done = 0;
+	struct zpool *zpool = pool->zpool;
 	unsigned long handle;
-	struct zpool *zpool;
+	int alloc_ret = 0;
+	unsigned int dlen;
 	gfp_t gfp;
-	u8 *dst;
+
+	gfp = GFP_NOWAIT | __GFP_NORETRY | __GFP_HIGHMEM | __GFP_MOVABLE;
 
 	acomp_ctx = acomp_ctx_get_cpu_lock(pool);
-	dst = acomp_ctx->buffer;
-	sg_init_table(&input, 1);
-	sg_set_page(&input, page, PAGE_SIZE, 0);
+	for (i = 0; i < nr; i += batch) {
+		batch = min(nr - i, acomp_ctx->nr_reqs);
 
-	/*
-	 * We need PAGE_SIZE * 2 here since there maybe over-compression case,
-	 * and hardware-accelerators may won't check the dst buffer size, so
-	 * giving the dst buffer with enough length to avoid buffer overflow.
-	 */
-	sg_init_one(&output, dst, PAGE_SIZE * 2);
-	acomp_request_set_params(acomp_ctx->req, &input, &output, PAGE_SIZE, dlen);
+		for (j = 0; j < batch; j++) {
+			struct acomp_req *req = acomp_ctx->reqs[j];
 
-	/*
-	 * it maybe looks a little bit silly that we send an asynchronous request,
-	 * then wait for its completion synchronously. This makes the process look
-	 * synchronous in fact.
-	 * Theoretically, acomp supports users send multiple acomp requests in one
-	 * acomp instance, then get those requests done simultaneously. but in this
-	 * case, zswap actually does store and load page by page, there is no
-	 * existing method to send the second page before the first page is done
-	 * in one thread doing zwap.
-	 * but in different threads running on different cpu, we have different
-	 * acomp instance, so multiple threads can do (de)compression in parallel.
-	 */
-	comp_ret = crypto_wait_req(crypto_acomp_compress(acomp_ctx->req), &acomp_ctx->wait);
-	dlen = acomp_ctx->req->dlen;
-	if (comp_ret)
-		goto unlock;
+			sg_init_table(&inputs[j], 1);
+			sg_set_page(&inputs[j], folio_page(folio, start + i + j),
+				    PAGE_SIZE, 0);
 
-	zpool = pool->zpool;
-	gfp = GFP_NOWAIT | __GFP_NORETRY | __GFP_HIGHMEM | __GFP_MOVABLE;
-	alloc_ret = zpool_malloc(zpool, dlen, gfp, &handle, page_to_nid(page));
-	if (alloc_ret)
-		goto unlock;
+			/*
+			 * We need PAGE_SIZE * 2 here since there maybe
+			 * over-compression case, and hardware-accelerators may
+			 * won't check the dst buffer size, so giving the dst
+			 * buffer with enough length to avoid buffer overflow.
+			 */
+			sg_init_one(&outputs[j], acomp_ctx->buffers[j],
+				    PAGE_SIZE * 2);
+			acomp_request_set_params(req, &inputs[j], &outputs[j],
+						 PAGE_SIZE, PAGE_SIZE);
+			comp_ret[j] = crypto_acomp_compress(req);
+		}
 
-	zpool_obj_write(zpool, handle, dst, dlen);
-	entry->handle = handle;
-	entry->length = dlen;
+		/*
+		 * For a synchronous compressor the batch has a single request
+		 * which is done already, crypto_wait_req() won't block.
+		 */
+		for (j = 0; j < batch; j++)
+			comp_ret[j] = crypto_wait_req(comp_ret[j],
+						      &acomp_ctx->waits[j]);
+
+		for (j = 0; j < batch; j++) {
+			if (comp_ret[j])
+				goto unlock;
+
+			dlen = acomp_ctx->reqs[j]->dlen;
+			alloc_ret = zpool_malloc(zpool, dlen, gfp, &handle,
+						 folio_nid(folio));
+			if (alloc_ret)
+				goto unlock;
+
+			zpool_obj_write(zpool, handle, acomp_ctx->buffers[j], dlen);
+			entries[done]->handle = handle;
+			entries[done]->length = dlen;
+			done++;
+		}
+	}
 
 unlock:
-	if (comp_ret == -ENOSPC || alloc_ret == -ENOSPC)
-		zswap_reject_compress_poor++;
-	else if (comp_ret)
-		zswap_reject_compress_fail++;
-	else if (alloc_ret)
-		zswap_reject_alloc_fail++;
+	if (done < nr) {
+		j = done % acomp_ctx->nr_reqs;
+		if (comp_ret[j] == -ENOSPC || alloc_ret == -ENOSPC)
+			zswap_reject_compress_poor++;
+		else if (comp_ret[j])
+			zswap_reject_compress_fail++;
+		else if (alloc_ret)
+			zswap_reject_alloc_fail++;
+
+		while (done--)
+			zpool_free(zpool, entries[done]->handle);
+	}
 
 	acomp_ctx_put_unlock(acomp_ctx);
-	return comp_ret == 0 && alloc_ret == 0;
+	return done == nr;
 }
 
 static bool zswap_decompress(struct zswap_entry *entry, struct folio *folio)
@@ -1010,27 +1067,28 @@ static bool zswap_decompress(struct zswap_entry *entry, struct folio *folio)
 	u8 *src, *obj;
 
 	acomp_ctx = acomp_ctx_get_cpu_lock(entry->pool);
-	obj = zpool_obj_read_begin(zpool, entry->handle, acomp_ctx->buffer);
+	obj = zpool_obj_read_begin(zpool, entry->handle, acomp_ctx->buffers[0]);
 
 	/*
 	 * zpool_obj_read_begin() might return a kmap address of highmem when
-	 * acomp_ctx->buffer is not used.  However, sg_init_one() does not
-	 * handle highmem addresses, so copy the object to acomp_ctx->buffer.
+	 * acomp_ctx->buffers[0] is not used.  However, sg_init_one() does not
+	 * handle highmem addresses, so copy the object to acomp_ctx->buffers[0].
 	 */
 	if (virt_addr_valid(obj)) {
 		src = obj;
 	} else {
-		WARN_ON_ONCE(obj == acomp_ctx->buffer);
-		memcpy(acomp_ctx->buffer, obj, entry->length);
-		src = acomp_ctx->buffer;
+		WARN_ON_ONCE(obj == acomp_ctx->buffers[0]);
+		memcpy(acomp_ctx->buffers[0], obj, entry->length);
+		src = acomp_ctx->buffers[0];
 	}
 
 	sg_init_one(&input, src, entry->length);
 	sg_init_table(&output, 1);
 	sg_set_folio(&output, folio, PAGE_SIZE, 0);
-	acomp_request_set_params(acomp_ctx->req, &input, &output, entry->length, PAGE_SIZE);
-	decomp_ret = crypto_wait_req(crypto_acomp_decompress(acomp_ctx->req), &acomp_ctx->wait);
-	dlen = acomp_ctx->req->dlen;
+	acomp_request_set_params(acomp_ctx->reqs[0], &input, &output, entry->length, PAGE_SIZE);
+	decomp_ret = crypto_wait_req(crypto_acomp_decompress(acomp_ctx->reqs[0]),
+				     &acomp_ctx->waits[0]);
+	dlen = acomp_ctx->reqs[0]->dlen;
 
 	zpool_obj_read_end(zpool, entry->handle, obj);
 	acomp_ctx_put_unlock(acomp_ctx);
@@ -1478,22 +1536,12 @@ static void shrink_worker(struct work_struct *w)
 * main API
 **********************************/
 
-static bool zswap_store_page(struct page *page,
+static bool zswap_store_page(struct page *page, struct zswap_entry *entry,
 			     struct obj_cgroup *objcg,
 			     struct zswap_pool *pool)
 {
 	swp_entry_t page_swpentry = page_swap_entry(page);
-	struct zswap_entry *entry, *old;
-
-	/* allocate entry */
-	entry = zswap_entry_cache_alloc(GFP_KERNEL, page_to_nid(page));
-	if (!entry) {
-		zswap_reject_kmemcache_fail++;
-		return false;
-	}
-
-	if (!zswap_compress(page, entry, pool))
-		goto compress_failed;
+	struct zswap_entry *old;
 
 	old = xa_store(swap_zswap_tree(page_swpentry),
 		       swp_offset(page_swpentry),
@@ -1503,7 +1551,7 @@ static bool zswap_store_page(struct page *page,
 
 		WARN_ONCE(err != -ENOMEM, "unexpected xarray error: %d\n", err);
 		zswap_reject_alloc_fail++;
-		goto store_failed;
+		return false;
 	}
 
 	/*
@@ -1548,11 +1596,45 @@ static bool zswap_store_page(struct page *page,
 	}
 
 	return true;
+}
 
-store_failed:
-	zpool_free(pool->zpool, entry->handle);
-compress_failed:
-	zswap_entry_cache_free(entry);
+/*
+ * Compress and store @nr subpages of @folio starting at @start. On failure,
+ * the subpages stored already are left in the tree for zswap_store() to
+ * clean up.
+ */
+static bool zswap_store_pages(struct folio *folio, long start, unsigned int nr,
+			      struct obj_cgroup *objcg,
+			      struct zswap_pool *pool)
+{
+	struct zswap_entry *entries[ZSWAP_MAX_BATCH_SIZE];
+	unsigned int i, stored = 0;
+
+	for (i = 0; i < nr; i++) {
+		entries[i] = zswap_entry_cache_alloc(GFP_KERNEL, folio_nid(folio));
+		if (!entries[i]) {
+			zswap_reject_kmemcache_fail++;
+			goto free_entries;
+		}
+	}
+
+	if (!zswap_compress(folio, start, nr, entries, pool))
+		goto free_entries;
+
+	for (stored = 0; stored < nr; stored++) {
+		if (!zswap_store_page(folio_page(folio, start + stored),
+				      entries[stored], objcg, pool))
+			goto free_handles;
+	}
+
+	return true;
+
+free_handles:
+	for (i = stored; i < nr; i++)
+		zpool_free(pool->zpool, entries[i]->handle);
+free_entries:
+	while (i-- > stored)
+		zswap_entry_cache_free(entries[i]);
 	return false;
 }
 
@@ -1598,10 +1680,10 @@ bool zswap_store(struct folio *folio)
 		mem_cgroup_put(memcg);
 	}
 
-	for (index = 0; index < nr_pages; ++index) {
-		struct page *page = folio_page(folio, index);
+	for (index = 0; index < nr_pages; index += ZSWAP_MAX_BATCH_SIZE) {
+		unsigned int nr = min_t(long, nr_pages - index, ZSWAP_MAX_BATCH_SIZE);
 
-		if (!zswap_store_page(page, objcg, pool))
+		if (!zswap_store_pages(folio, index, nr, objcg, pool))
 			goto put_pool;
 	}
 
@@ -1642,6 +1724,34 @@ bool zswap_store(struct folio *folio)
 	return ret;
 }
 
+/**
+ * zswap_present_test() - check whether a range of swap entries is in zswap
+ * @swp: first swap entry of the range
+ * @nr_pages: number of contiguous swap entries
+ *
+ * Return: true if at least one of the entries is stored in zswap.
+ */
+bool zswap_present_test(swp_entry_t swp, int nr_pages)
+{
+	pgoff_t offset = swp_offset(swp);
+	pgoff_t last = offset + nr_pages - 1;
+
+	if (zswap_never_enabled())
+		return false;
+
+	while (offset <= last) {
+		struct xarray *tree = swap_zswap_tree(swp_entry(swp_type(swp), offset));
+		pgoff_t end = min(last, ALIGN(offset + 1, SWAP_ADDRESS_SPACE_PAGES) - 1);
+		unsigned long index = offset;
+
+		if (xa_find(tree, &index, end, XA_PRESENT))
+			return true;
+		offset = end + 1;
+	}
+
+	return false;
+}
+
 /**
  * zswap_load() - load a folio from zswap
  * @folio: folio to load
@@ -1676,11 +1786,15 @@ int zswap_load(struct folio *folio)
 		return -ENOENT;
 
 	/*
-	 * Large folios should not be swapped in while zswap is being used, as
-	 * they are not properly handled. Zswap does not properly load large
-	 * folios, and a large folio may only be partially in zswap.
+	 * Zswap does not load large folios. They are only swapped in when
+	 * none of their entries is in zswap, see can_swapin_thp(), so the
+	 * whole folio is read from the backing device. A large folio that
+	 * is partially or fully in zswap here is a bug.
 	 */
-	if (WARN_ON_ONCE(folio_test_large(folio))) {
+	if (folio_test_large(folio)) {
+		if (!zswap_present_test(swp, folio_nr_pages(folio)))
+			return -ENOENT;
+		WARN_ON_ONCE(1);
 		folio_unlock(folio);
 		return -EINVAL;
 	}
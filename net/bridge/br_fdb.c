@@ -65,6 +65,12 @@ static inline unsigned long hold_time(const struct net_bridge *br)
 	return br->topology_change ? br->forward_delay : br->ageing_time;
 }
 
+/* Learning refreshes an entry at most once per 1/256th of the hold time,
+ * so that a MAC seen on several CPUs doesn't bounce its cache line every
+ * jiffy. With the default ageing time that is about once a second.
+ */
+#define BR_FDB_REFRESH_SHIFT	8
+
 static inline int has_expired(const struct net_bridge *br,
 				  const struct net_bridge_fdb_entry *fdb)
 {
@@ -900,8 +906,9 @@ void br_fdb_update(struct net_bridge *br, struct net_bridge_port *source,
 			unsigned long now = jiffies;
 			bool fdb_modified = false;
 
-			if (now != fdb->updated) {
-				fdb->updated = now;
+			if (time_after(now, READ_ONCE(fdb->updated) +
+				       (hold_time(br) >> BR_FDB_REFRESH_SHIFT))) {
+				WRITE_ONCE(fdb->updated, now);
 				fdb_modified = __fdb_mark_active(fdb);
 			}
 
@@ -2337,6 +2337,25 @@ void net_dec_egress_queue(void)
 EXPORT_SYMBOL_GPL(net_dec_egress_queue);
 #endif
 
+/*
+ * Enabled while a classifier or action that may look at current is
+ * installed on any qdisc. Such skbs must be classified by the CPU that
+ * sent them, so __dev_xmit_skb() stops parking them on q->defer_list.
+ */
+static DEFINE_STATIC_KEY_FALSE(qdisc_defer_blocked_key);
+
+void qdisc_defer_block(void)
+{
+	static_branch_inc(&qdisc_defer_blocked_key);
+}
+EXPORT_SYMBOL_GPL(qdisc_defer_block);
+
+void qdisc_defer_unblock(void)
+{
+	static_branch_dec(&qdisc_defer_blocked_key);
+}
+EXPORT_SYMBOL_GPL(qdisc_defer_unblock);
+
 #ifdef CONFIG_NET_CLS_ACT
 DEFINE_STATIC_KEY_FALSE(tcf_sw_enabled_key);
 EXPORT_SYMBOL(tcf_sw_enabled_key);
@@ -4071,13 +4090,26 @@ static int dev_qdisc_enqueue(struct sk_buff *skb, struct Qdisc *q,
 	return rc;
 }
 
+/*
+ * Bound on skbs parked on q->defer_list. Classful and shaping qdiscs such as
+ * HTB, prio or tbf leave sch->limit at zero, use the device queue length for
+ * those, and a default for devices without one.
+ */
+static unsigned long qdisc_defer_limit(const struct Qdisc *q)
+{
+	return READ_ONCE(q->limit) ?:
+	       READ_ONCE(qdisc_dev(q)->tx_queue_len) ?: DEFAULT_TX_QUEUE_LEN;
+}
+
 static inline int __dev_xmit_skb(struct sk_buff *skb, struct Qdisc *q,
 				 struct net_device *dev,
 				 struct netdev_queue *txq)
 {
 	spinlock_t *root_lock = qdisc_lock(q);
-	struct sk_buff *to_free = NULL;
-	bool contended;
+	struct sk_buff *to_free = NULL, *next;
+	struct llist_node *ll_list, *first_n, **tail;
+	unsigned long defer_count = 0;
+	bool contended, deferred;
 	int rc;
 
 	qdisc_calculate_pkt_len(skb, q);
@@ -4121,6 +4153,42 @@ static inline int __dev_xmit_skb(struct sk_buff *skb, struct Qdisc *q,
 		kfree_skb_reason(skb, SKB_DROP_REASON_TC_RECLASSIFY_LOOP);
 		return NET_XMIT_DROP;
 	}
+
+	/* Deferred skbs are classified on the CPU that drains defer_list, so
+	 * classifiers looking at current (cls_cgroup, BPF) need their own
+	 * CPU to enqueue.
+	 */
+	deferred = !static_branch_unlikely(&qdisc_defer_blocked_key);
+	if (likely(deferred)) {
+		/* Open coded llist_add() bounded by qdisc_defer_limit(). Only a
+		 * producer which finds defer_list non-empty bumps defer_count,
+		 * and at most once, so the common uncontended case avoids the
+		 * atomic.
+		 */
+		first_n = READ_ONCE(q->defer_list.first);
+		do {
+			if (first_n && !defer_count) {
+				defer_count = atomic_long_inc_return(&q->defer_count);
+				if (unlikely(defer_count > qdisc_defer_limit(q))) {
+					kfree_skb_reason(skb, SKB_DROP_REASON_QDISC_DROP);
+					return NET_XMIT_DROP;
+				}
+			}
+			skb->ll_node.next = first_n;
+		} while (!try_cmpxchg(&q->defer_list.first, &first_n,
+				      &skb->ll_node));
+
+		/* The producer which found the list empty enqueues it all for
+		 * us. Its verdict is not ours: a skb it drops, or a congestion
+		 * notification for it, still reports NET_XMIT_SUCCESS here and
+		 * is only visible in the qdisc's drop and overlimit stats. The
+		 * sender trades per-packet feedback for not spinning on the
+		 * root lock while another CPU holds it.
+		 */
+		if (first_n)
+			return NET_XMIT_SUCCESS;
+	}
+
 	/*
 	 * Heuristic to force contended enqueues to serialize on a
 	 * separate lock before trying to get qdisc main lock.
@@ -4136,17 +4204,43 @@ static inline int __dev_xmit_skb(struct sk_buff *skb, struct Qdisc *q,
 		spin_lock(&q->busylock);
 
 	spin_lock(root_lock);
+
+	ll_list = llist_del_all(&q->defer_list);
+	/* Not atomic with the llist_del_all(), the list may briefly exceed
+	 * qdisc_defer_limit() by a few skbs.
+	 */
+	atomic_long_set(&q->defer_count, 0);
+	ll_list = llist_reverse_order(ll_list);
+	if (unlikely(deferred && !ll_list)) {
+		/* A producer which could no longer defer already enqueued it */
+		spin_unlock(root_lock);
+		if (unlikely(contended))
+			spin_unlock(&q->busylock);
+		return NET_XMIT_SUCCESS;
+	} else if (unlikely(!deferred)) {
+		/* Flush what was parked before deferral was blocked, then
+		 * enqueue our skb last so that rc is its verdict.
+		 */
+		for (tail = &ll_list; *tail; tail = &(*tail)->next)
+			;
+		skb->ll_node.next = NULL;
+		*tail = &skb->ll_node;
+	}
+
 	if (unlikely(test_bit(__QDISC_STATE_DEACTIVATED, &q->state))) {
-		__qdisc_drop(skb, &to_free);
+		llist_for_each_entry_safe(skb, next, ll_list, ll_node)
+			__qdisc_drop(skb, &to_free);
 		rc = NET_XMIT_DROP;
 	} else if ((q->flags & TCQ_F_CAN_BYPASS) && !qdisc_qlen(q) &&
-		   qdisc_run_begin(q)) {
+		   !llist_next(ll_list) && qdisc_run_begin(q)) {
 		/*
 		 * This is a work-conserving queue; there are no old skbs
 		 * waiting to be sent out; and the qdisc is not running -
 		 * xmit the skb directly.
 		 */
 
+		skb = llist_entry(ll_list, struct sk_buff, ll_node);
+		skb_mark_not_on_list(skb);
 		qdisc_bstats_update(q, skb);
 
 		if (sch_direct_xmit(skb, q, dev, txq, root_lock, true)) {
@@ -4160,9 +4254,19 @@ static inline int __dev_xmit_skb(struct sk_buff *skb, struct Qdisc *q,
 		qdisc_run_end(q);
 		rc = NET_XMIT_SUCCESS;
 	} else {
+		int count = 0;
+
 		WRITE_ONCE(q->owner, smp_processor_id());
-		rc = dev_qdisc_enqueue(skb, q, &to_free, txq);
+		llist_for_each_entry_safe(skb, next, ll_list, ll_node) {
+			prefetch(next);
+			skb_mark_not_on_list(skb);
+			rc = dev_qdisc_enqueue(skb, q, &to_free, txq);
+			count++;
+		}
 		WRITE_ONCE(q->owner, -1);
+		/* Only our own skb's verdict can be returned to the caller */
+		if (count != 1 && deferred)
+			rc = NET_XMIT_SUCCESS;
 		if (qdisc_run_begin(q)) {
 			if (unlikely(contended)) {
 				spin_unlock(&q->busylock);
@@ -4879,10 +4983,29 @@ set_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 		rps_input_queue_tail_save(&rflow->last_qtail, head);
 	}
 
+	WRITE_ONCE(rflow->last_switch, (u32)jiffies);
 	WRITE_ONCE(rflow->cpu, next_cpu);
 	return rflow;
 }
 
+/*
+ * A flow following its consumer to another NUMA node moves its backlog
+ * processing away from where the packets were allocated. Don't let a
+ * frequently migrating thread drag the flow back and forth: within
+ * rps_sticky_ms of the last move, the flow stays on its current CPU
+ * unless the new one is on the same node.
+ */
+static bool rps_flow_sticky(const struct rps_dev_flow *rflow, u32 tcpu,
+			    u32 next_cpu)
+{
+	int window = READ_ONCE(net_hotdata.rps_sticky_jiffies);
+
+	if (window <= 0 || next_cpu >= nr_cpu_ids ||
+	    cpu_to_node(tcpu) == cpu_to_node(next_cpu))
+		return false;
+	return (s32)((u32)jiffies - READ_ONCE(rflow->last_switch)) < window;
+}
+
 /*
  * get_rps_cpu is called from netif_receive_skb and returns the target
  * CPU from the RPS map of the receiving queue for a given skb.
@@ -4934,8 +5057,10 @@ static int get_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 		 * This READ_ONCE() pairs with WRITE_ONCE() from rps_record_sock_flow().
 		 */
 		ident = READ_ONCE(sock_flow_table->ents[hash & sock_flow_table->mask]);
-		if ((ident ^ hash) & ~net_hotdata.rps_cpu_mask)
+		if ((ident ^ hash) & ~net_hotdata.rps_cpu_mask) {
+			this_cpu_inc(softnet_data.rfs_miss);
 			goto try_rps;
+		}
 
 		next_cpu = ident & net_hotdata.rps_cpu_mask;
 
@@ -4954,17 +5079,27 @@ static int get_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 		 *   - The current CPU's queue tail has advanced beyond the
 		 *     last packet that was enqueued using this table entry.
 		 *     This guarantees that all previous packets for the flow
-		 *     have been dequeued, thus preserving in order delivery.
+		 *     have been dequeued, thus preserving in order delivery,
+		 *     and the move isn't held back by rps_flow_sticky().
 		 */
-		if (unlikely(tcpu != next_cpu) &&
-		    (tcpu >= nr_cpu_ids || !cpu_online(tcpu) ||
-		     ((int)(READ_ONCE(per_cpu(softnet_data, tcpu).input_queue_head) -
-		      rflow->last_qtail)) >= 0)) {
-			tcpu = next_cpu;
-			rflow = set_rps_cpu(dev, skb, rflow, next_cpu);
+		if (unlikely(tcpu != next_cpu)) {
+			if (tcpu >= nr_cpu_ids || !cpu_online(tcpu)) {
+				tcpu = next_cpu;
+				rflow = set_rps_cpu(dev, skb, rflow, next_cpu);
+			} else if ((int)(READ_ONCE(per_cpu(softnet_data, tcpu).input_queue_head) -
+				   rflow->last_qtail) >= 0) {
+				if (rps_flow_sticky(rflow, tcpu, next_cpu)) {
+					this_cpu_inc(softnet_data.rfs_held);
+				} else {
+					tcpu = next_cpu;
+					rflow = set_rps_cpu(dev, skb, rflow, next_cpu);
+					this_cpu_inc(softnet_data.rfs_migrated);
+				}
+			}
 		}
 
 		if (tcpu < nr_cpu_ids && cpu_online(tcpu)) {
+			this_cpu_inc(softnet_data.rfs_hit);
 			*rflowp = rflow;
 			cpu = tcpu;
 			goto done;
@@ -7168,6 +7303,7 @@ static void napi_restore_config(struct napi_struct *n)
 	n->defer_hard_irqs = n->config->defer_hard_irqs;
 	n->gro_flush_timeout = n->config->gro_flush_timeout;
 	n->irq_suspend_timeout = n->config->irq_suspend_timeout;
+	n->threaded_poll_timeout = n->config->threaded_poll_timeout;
 
 	if (n->dev->irq_affinity_auto &&
 	    test_bit(NAPI_STATE_HAS_NOTIFIER, &n->state))
@@ -7189,6 +7325,7 @@ static void napi_save_config(struct napi_struct *n)
 	n->config->defer_hard_irqs = n->defer_hard_irqs;
 	n->config->gro_flush_timeout = n->gro_flush_timeout;
 	n->config->irq_suspend_timeout = n->irq_suspend_timeout;
+	n->config->threaded_poll_timeout = n->threaded_poll_timeout;
 	napi_hash_del(n);
 }
 
@@ -7514,15 +7651,38 @@ static int napi_thread_wait(struct napi_struct *napi)
 	return -1;
 }
 
+/* Exit threaded busy polling, the next poll completes the NAPI normally */
+static bool napi_threaded_busy_stop(struct napi_struct *napi, u64 busy_until)
+{
+	return napi_disable_pending(napi) || kthread_should_stop() ||
+	       !test_bit(NAPI_STATE_THREADED, &napi->state) ||
+	       ktime_get_ns() > busy_until;
+}
+
+/*
+ * With a threaded_poll_timeout set, a NAPI whose poll used up its whole
+ * budget switches to busy polling: NAPI_STATE_IN_BUSY_POLL makes
+ * napi_complete_done() fail, so the driver leaves its IRQ masked and the
+ * thread keeps polling. Once no packet arrived for threaded_poll_timeout
+ * nanoseconds the bit is cleared and the next poll re-arms the IRQ.
+ */
 static void napi_threaded_poll_loop(struct napi_struct *napi)
 {
 	struct bpf_net_context __bpf_net_ctx, *bpf_net_ctx;
 	struct softnet_data *sd;
 	unsigned long last_qs = jiffies;
+	unsigned long timeout;
+	u64 busy_until = 0;
 
 	for (;;) {
 		bool repoll = false;
 		void *have;
+		int work;
+
+		if (busy_until && napi_threaded_busy_stop(napi, busy_until)) {
+			clear_bit(NAPI_STATE_IN_BUSY_POLL, &napi->state);
+			busy_until = 0;
+		}
 
 		local_bh_disable();
 		bpf_net_ctx = bpf_net_ctx_set(&__bpf_net_ctx);
@@ -7531,7 +7691,12 @@ static void napi_threaded_poll_loop(struct napi_struct *napi)
 		sd->in_napi_threaded_poll = true;
 
 		have = netpoll_poll_lock(napi);
-		__napi_poll(napi, &repoll);
+		work = __napi_poll(napi, &repoll);
+		if (busy_until) {
+			/* napi_complete_done() did not flush GRO */
+			gro_flush(&napi->gro, false);
+			gro_normal_list(&napi->gro);
+		}
 		netpoll_poll_unlock(have);
 
 		sd->in_napi_threaded_poll = false;
@@ -7545,6 +7710,16 @@ static void napi_threaded_poll_loop(struct napi_struct *napi)
 		bpf_net_ctx_clear(bpf_net_ctx);
 		local_bh_enable();
 
+		timeout = napi_get_threaded_poll_timeout(napi);
+		if (busy_until) {
+			if (work)
+				busy_until = ktime_get_ns() + timeout;
+			repoll = true;
+		} else if (repoll && timeout) {
+			set_bit(NAPI_STATE_IN_BUSY_POLL, &napi->state);
+			busy_until = ktime_get_ns() + timeout;
+		}
+
 		if (!repoll)
 			break;
 
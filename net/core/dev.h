@@ -315,6 +315,31 @@ static inline void napi_set_irq_suspend_timeout(struct napi_struct *n,
 	WRITE_ONCE(n->irq_suspend_timeout, timeout);
 }
 
+/**
+ * napi_get_threaded_poll_timeout - get the threaded_poll_timeout
+ * @n: napi struct to get the threaded_poll_timeout from
+ *
+ * Return: the per-NAPI value of the threaded_poll_timeout field.
+ */
+static inline unsigned long
+napi_get_threaded_poll_timeout(const struct napi_struct *n)
+{
+	return READ_ONCE(n->threaded_poll_timeout);
+}
+
+/**
+ * napi_set_threaded_poll_timeout - set the threaded_poll_timeout for a napi
+ * @n: napi struct to set the threaded_poll_timeout
+ * @timeout: timeout value to set
+ *
+ * napi_set_threaded_poll_timeout sets the per-NAPI threaded_poll_timeout
+ */
+static inline void napi_set_threaded_poll_timeout(struct napi_struct *n,
+						  unsigned long timeout)
+{
+	WRITE_ONCE(n->threaded_poll_timeout, timeout);
+}
+
 int rps_cpumask_housekeeping(struct cpumask *mask);
 
 #if defined(CONFIG_DEBUG_NET) && defined(CONFIG_BPF_SYSCALL)
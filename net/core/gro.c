@@ -5,8 +5,6 @@
 #include <trace/events/net.h>
 #include <linux/skbuff_ref.h>
 
-#define MAX_GRO_SKBS 8
-
 static DEFINE_SPINLOCK(offload_lock);
 
 /**
@@ -444,8 +442,8 @@ static void gro_flush_oldest(struct gro_node *gro, struct list_head *head)
 
 	oldest = list_last_entry(head, struct sk_buff, list);
 
-	/* We are called with head length >= MAX_GRO_SKBS, so this is
-	 * impossible.
+	/* We are called with head length >= net_hotdata.gro_bucket_skbs,
+	 * so this is impossible.
 	 */
 	if (WARN_ON_ONCE(!oldest))
 		return;
@@ -455,6 +453,7 @@ static void gro_flush_oldest(struct gro_node *gro, struct list_head *head)
 	 */
 	skb_list_del_init(oldest);
 	gro_complete(gro, oldest);
+	gro->evicted++;
 }
 
 static enum gro_result dev_gro_receive(struct gro_node *gro,
@@ -530,13 +529,15 @@ static enum gro_result dev_gro_receive(struct gro_node *gro,
 		gro_list->count--;
 	}
 
-	if (same_flow)
+	if (same_flow) {
+		gro->merged++;
 		goto ok;
+	}
 
 	if (NAPI_GRO_CB(skb)->flush)
 		goto normal;
 
-	if (unlikely(gro_list->count >= MAX_GRO_SKBS))
+	if (unlikely(gro_list->count >= READ_ONCE(net_hotdata.gro_bucket_skbs)))
 		gro_flush_oldest(gro, &gro_list->list);
 	else
 		gro_list->count++;
@@ -548,6 +549,7 @@ static enum gro_result dev_gro_receive(struct gro_node *gro,
 	if (!skb_is_gso(skb))
 		skb_shinfo(skb)->gso_size = skb_gro_len(skb);
 	list_add(&skb->list, &gro_list->list);
+	gro->held++;
 	ret = GRO_HELD;
 ok:
 	if (gro_list->count) {
@@ -804,6 +806,10 @@ void gro_init(struct gro_node *gro)
 
 	INIT_LIST_HEAD(&gro->rx_list);
 	gro->rx_count = 0;
+
+	gro->held = 0;
+	gro->merged = 0;
+	gro->evicted = 0;
 }
 
 void gro_cleanup(struct gro_node *gro)
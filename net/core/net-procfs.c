@@ -126,6 +126,7 @@ static int softnet_seq_show(struct seq_file *seq, void *v)
 	u32 input_qlen = softnet_input_pkt_queue_len(sd);
 	u32 process_qlen = softnet_process_queue_len(sd);
 	unsigned int flow_limit_count = 0;
+	unsigned int rfs_hit = 0, rfs_miss = 0, rfs_migrated = 0, rfs_held = 0;
 
 #ifdef CONFIG_NET_FLOW_LIMIT
 	struct sd_flow_limit *fl;
@@ -137,6 +138,12 @@ static int softnet_seq_show(struct seq_file *seq, void *v)
 		flow_limit_count = READ_ONCE(fl->count);
 	rcu_read_unlock();
 #endif
+#ifdef CONFIG_RPS
+	rfs_hit = READ_ONCE(sd->rfs_hit);
+	rfs_miss = READ_ONCE(sd->rfs_miss);
+	rfs_migrated = READ_ONCE(sd->rfs_migrated);
+	rfs_held = READ_ONCE(sd->rfs_held);
+#endif
 
 	/* the index is the CPU id owing this sd. Since offline CPUs are not
 	 * displayed, it would be othrwise not trivial for the user-space
@@ -144,14 +151,15 @@ static int softnet_seq_show(struct seq_file *seq, void *v)
 	 */
 	seq_printf(seq,
 		   "%08x %08x %08x %08x %08x %08x %08x %08x %08x %08x %08x %08x %08x "
-		   "%08x %08x\n",
+		   "%08x %08x %08x %08x %08x %08x\n",
 		   READ_ONCE(sd->processed), atomic_read(&sd->dropped),
 		   READ_ONCE(sd->time_squeeze), 0,
 		   0, 0, 0, 0, /* was fastroute */
 		   0,	/* was cpu_collision */
 		   READ_ONCE(sd->received_rps), flow_limit_count,
 		   input_qlen + process_qlen, (int)seq->index,
-		   input_qlen, process_qlen);
+		   input_qlen, process_qlen, rfs_hit, rfs_miss,
+		   rfs_migrated, rfs_held);
 	return 0;
 }
 
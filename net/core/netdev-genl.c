@@ -162,6 +162,7 @@ static int
 netdev_nl_napi_fill_one(struct sk_buff *rsp, struct napi_struct *napi,
 			const struct genl_info *info)
 {
+	unsigned long threaded_poll_timeout;
 	unsigned long irq_suspend_timeout;
 	unsigned long gro_flush_timeout;
 	u32 napi_defer_hard_irqs;
@@ -205,6 +206,20 @@ netdev_nl_napi_fill_one(struct sk_buff *rsp, struct napi_struct *napi,
 			 gro_flush_timeout))
 		goto nla_put_failure;
 
+	threaded_poll_timeout = napi_get_threaded_poll_timeout(napi);
+	if (nla_put_uint(rsp, NETDEV_A_NAPI_THREADED_POLL_TIMEOUT,
+			 threaded_poll_timeout))
+		goto nla_put_failure;
+
+	/* Updated locklessly by the NAPI owner */
+	if (nla_put_uint(rsp, NETDEV_A_NAPI_GRO_HELD,
+			 data_race(napi->gro.held)) ||
+	    nla_put_uint(rsp, NETDEV_A_NAPI_GRO_MERGED,
+			 data_race(napi->gro.merged)) ||
+	    nla_put_uint(rsp, NETDEV_A_NAPI_GRO_EVICTED,
+			 data_race(napi->gro.evicted)))
+		goto nla_put_failure;
+
 	genlmsg_end(rsp, hdr);
 
 	return 0;
@@ -320,6 +335,7 @@ int netdev_nl_napi_get_dumpit(struct sk_buff *skb, struct netlink_callback *cb)
 static int
 netdev_nl_napi_set_config(struct napi_struct *napi, struct genl_info *info)
 {
+	u64 threaded_poll_timeout = 0;
 	u64 irq_suspend_timeout = 0;
 	u64 gro_flush_timeout = 0;
 	u32 defer = 0;
@@ -339,6 +355,11 @@ netdev_nl_napi_set_config(struct napi_struct *napi, struct genl_info *info)
 		napi_set_gro_flush_timeout(napi, gro_flush_timeout);
 	}
 
+	if (info->attrs[NETDEV_A_NAPI_THREADED_POLL_TIMEOUT]) {
+		threaded_poll_timeout = nla_get_uint(info->attrs[NETDEV_A_NAPI_THREADED_POLL_TIMEOUT]);
+		napi_set_threaded_poll_timeout(napi, threaded_poll_timeout);
+	}
+
 	return 0;
 }
 
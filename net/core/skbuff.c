@@ -79,6 +79,7 @@
 #include <net/mptcp.h>
 #include <net/mctp.h>
 #include <net/page_pool/helpers.h>
+#include <net/xdp.h>
 #include <net/dropreason.h>
 
 #include <linux/uaccess.h>
@@ -1061,6 +1062,42 @@ static void skb_free_head(struct sk_buff *skb)
 	}
 }
 
+/* Return the page pool frags of an skb with one ring producer lock per
+ * pool rather than one per frag, which matters when the skb is freed on
+ * a CPU other than the one running the pool's NAPI instance.
+ */
+static void skb_pp_frags_unref(struct skb_shared_info *shinfo)
+{
+#if IS_ENABLED(CONFIG_PAGE_POOL)
+	netmem_ref bulk[XDP_BULK_QUEUE_SIZE];
+	u32 count = 0;
+	int i;
+
+	for (i = 0; i < shinfo->nr_frags; i++) {
+		netmem_ref netmem = skb_frag_netmem(&shinfo->frags[i]);
+
+		if (unlikely(!netmem_is_pp(netmem_compound_head(netmem)))) {
+			put_netmem(netmem);
+			continue;
+		}
+
+		bulk[count++] = netmem;
+		if (count == XDP_BULK_QUEUE_SIZE) {
+			page_pool_put_netmem_bulk(bulk, count);
+			count = 0;
+		}
+	}
+
+	if (count)
+		page_pool_put_netmem_bulk(bulk, count);
+#else
+	int i;
+
+	for (i = 0; i < shinfo->nr_frags; i++)
+		__skb_frag_unref(&shinfo->frags[i], true);
+#endif
+}
+
 static void skb_release_data(struct sk_buff *skb, enum skb_drop_reason reason)
 {
 	struct skb_shared_info *shinfo = skb_shinfo(skb);
@@ -1077,8 +1114,11 @@ static void skb_release_data(struct sk_buff *skb, enum skb_drop_reason reason)
 			goto free_head;
 	}
 
-	for (i = 0; i < shinfo->nr_frags; i++)
-		__skb_frag_unref(&shinfo->frags[i], skb->pp_recycle);
+	if (skb->pp_recycle)
+		skb_pp_frags_unref(shinfo);
+	else
+		for (i = 0; i < shinfo->nr_frags; i++)
+			__skb_frag_unref(&shinfo->frags[i], false);
 
 free_head:
 	if (shinfo->frag_list)
@@ -527,7 +527,7 @@ static struct sock *run_bpf_filter(struct sock_reuseport *reuse, u16 socks,
 static struct sock *reuseport_select_sock_by_hash(struct sock_reuseport *reuse,
 						  u32 hash, u16 num_socks)
 {
-	struct sock *first_valid_sk = NULL;
+	struct sock *first_valid_sk = NULL, *full_sk = NULL;
 	int i, j;
 
 	i = j = reciprocal_scale(hash, num_socks);
@@ -535,6 +535,16 @@ static struct sock *reuseport_select_sock_by_hash(struct sock_reuseport *reuse,
 		struct sock *sk = reuse->socks[i];
 
 		if (sk->sk_state != TCP_ESTABLISHED) {
+			/* A listener whose accept queue is full would drop the
+			 * connection while its siblings may have room, which
+			 * also keeps a stalled worker from being fed.
+			 */
+			if (sk->sk_state == TCP_LISTEN && sk_acceptq_is_full(sk)) {
+				if (!full_sk)
+					full_sk = sk;
+				goto next;
+			}
+
 			/* Paired with WRITE_ONCE() in __reuseport_(get|put)_incoming_cpu(). */
 			if (!READ_ONCE(reuse->incoming_cpu))
 				return sk;
@@ -546,13 +556,13 @@ static struct sock *reuseport_select_sock_by_hash(struct sock_reuseport *reuse,
 			if (!first_valid_sk)
 				first_valid_sk = sk;
 		}
-
+next:
 		i++;
 		if (i >= num_socks)
 			i = 0;
 	} while (i != j);
 
-	return first_valid_sk;
+	return first_valid_sk ?: full_sk;
 }
 
 /**
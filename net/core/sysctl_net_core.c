@@ -35,6 +35,7 @@ static int min_rcvbuf = SOCK_MIN_RCVBUF;
 static int max_skb_frags = MAX_SKB_FRAGS;
 static int min_mem_pcpu_rsv = SK_MEMORY_PCPU_RESERVE;
 static int netdev_budget_usecs_min = 2 * USEC_PER_SEC / HZ;
+static int gro_bucket_skbs_max = 64;
 
 static int net_msg_warn;	/* Unused, but still a sysctl */
 
@@ -518,6 +519,13 @@ static struct ctl_table net_core_table[] = {
 		.mode		= 0644,
 		.proc_handler	= rps_sock_flow_sysctl
 	},
+	{
+		.procname	= "rps_sticky_ms",
+		.data		= &net_hotdata.rps_sticky_jiffies,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_ms_jiffies,
+	},
 #endif
 #ifdef CONFIG_NET_FLOW_LIMIT
 	{
@@ -623,6 +631,15 @@ static struct ctl_table net_core_table[] = {
 		.proc_handler	= proc_dointvec_minmax,
 		.extra1		= SYSCTL_ONE,
 	},
+	{
+		.procname	= "gro_bucket_skbs",
+		.data		= &net_hotdata.gro_bucket_skbs,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= SYSCTL_ONE,
+		.extra2		= &gro_bucket_skbs_max,
+	},
 	{
 		.procname	= "netdev_unregister_timeout_secs",
 		.data		= &netdev_unregister_timeout_secs,
@@ -313,6 +313,7 @@ static bool ip_can_use_hint(const struct sk_buff *skb, const struct iphdr *iph,
 }
 
 int tcp_v4_early_demux(struct sk_buff *skb);
+void tcp_v4_early_demux_prefetch(const struct sk_buff *skb);
 int udp_v4_early_demux(struct sk_buff *skb);
 static int ip_rcv_finish_core(struct net *net,
 			      struct sk_buff *skb, struct net_device *dev,
@@ -590,6 +591,18 @@ static struct sk_buff *ip_extract_route_hint(const struct net *net,
 	return skb;
 }
 
+/* Start the established socket lookup of the next skb of a list early */
+static void ip_list_prefetch_demux(struct net *net, const struct sk_buff *skb)
+{
+	const struct iphdr *iph = ip_hdr(skb);
+
+	if (iph->protocol == IPPROTO_TCP && !skb_dst(skb) && !skb->sk &&
+	    !ip_is_fragment(iph) &&
+	    READ_ONCE(net->ipv4.sysctl_ip_early_demux) &&
+	    READ_ONCE(net->ipv4.sysctl_tcp_early_demux))
+		tcp_v4_early_demux_prefetch(skb);
+}
+
 static void ip_list_rcv_finish(struct net *net, struct list_head *head)
 {
 	struct sk_buff *skb, *next, *hint = NULL;
@@ -607,6 +620,8 @@ static void ip_list_rcv_finish(struct net *net, struct list_head *head)
 		skb = l3mdev_ip_rcv(skb);
 		if (!skb)
 			continue;
+		if (&next->list != head)
+			ip_list_prefetch_demux(net, next);
 		if (ip_rcv_finish_core(net, skb, dev, hint) == NET_RX_DROP)
 			continue;
 
@@ -2216,7 +2216,9 @@ static int tcp_zerocopy_receive(struct sock *sk,
 				if (zc->recv_skip_hint > 0)
 					break;
 				skb = skb->next;
-				offset = seq - TCP_SKB_CB(skb)->seq;
+				/* seq lags by the pages still pending in the batch */
+				offset = seq + pages_to_map * PAGE_SIZE -
+					 TCP_SKB_CB(skb)->seq;
 			} else {
 				skb = tcp_recv_skb(sk, seq, &offset);
 			}
@@ -2249,11 +2251,12 @@ static int tcp_zerocopy_receive(struct sock *sk,
 		length += PAGE_SIZE;
 		zc->recv_skip_hint -= PAGE_SIZE;
 		frags++;
-		if (pages_to_map == TCP_ZEROCOPY_PAGE_BATCH_SIZE ||
-		    zc->recv_skip_hint < PAGE_SIZE) {
-			/* Either full batch, or we're about to go to next skb
-			 * (and we cannot unroll failed ops across skbs).
-			 */
+		/* A batch may span skbs: the walk above accounts for the pending
+		 * pages, and a failed insert ends the call before any straggler
+		 * copy, leaving the unmapped bytes in recv_skip_hint for the
+		 * caller to read with a regular copy.
+		 */
+		if (pages_to_map == TCP_ZEROCOPY_PAGE_BATCH_SIZE) {
 			ret = tcp_zerocopy_vm_insert_batch(vma, pages,
 							   pages_to_map,
 							   &address, &length,
@@ -1972,6 +1972,27 @@ int tcp_v4_do_rcv(struct sock *sk, struct sk_buff *skb)
 }
 EXPORT_SYMBOL(tcp_v4_do_rcv);
 
+/* Warm the ehash bucket tcp_v4_early_demux() is going to read for @skb,
+ * so that on a list of skbs its cache miss overlaps the previous skb.
+ */
+void tcp_v4_early_demux_prefetch(const struct sk_buff *skb)
+{
+	struct net *net = dev_net_rcu(skb->dev);
+	const struct iphdr *iph;
+	const struct tcphdr *th;
+	unsigned int hash;
+
+	if (skb->pkt_type != PACKET_HOST ||
+	    skb_headlen(skb) < skb_transport_offset(skb) + sizeof(struct tcphdr))
+		return;
+
+	iph = ip_hdr(skb);
+	th = tcp_hdr(skb);
+	hash = inet_ehashfn(net, iph->daddr, ntohs(th->dest),
+			    iph->saddr, th->source);
+	prefetch(inet_ehash_bucket(net->ipv4.tcp_death_row.hashinfo, hash));
+}
+
 int tcp_v4_early_demux(struct sk_buff *skb)
 {
 	struct net *net = dev_net_rcu(skb->dev);
@@ -2011,6 +2032,31 @@ int tcp_v4_early_demux(struct sk_buff *skb)
 	return 0;
 }
 
+/* Two pure ACKs whose options only differ in an aligned timestamp option
+ * can be merged by keeping the timestamp of the most recent ACK. This is
+ * what lets a burst of ACKs sitting in the backlog, which almost always
+ * carry distinct TSval/TSecr, be processed by a single tcp_ack().
+ */
+static bool tcp_backlog_ts_mergeable(const struct sk_buff *tail,
+				     const struct tcphdr *thtail,
+				     const struct sk_buff *skb,
+				     const struct tcphdr *th,
+				     unsigned int hdrlen)
+{
+	const __be32 *topt = (const __be32 *)(thtail + 1);
+	const __be32 *opt = (const __be32 *)(th + 1);
+
+	if (tail->len != hdrlen || skb->len != hdrlen ||
+	    hdrlen < sizeof(*th) + TCPOLEN_TSTAMP_ALIGNED)
+		return false;
+	if (opt[0] != htonl((TCPOPT_NOP << 24) | (TCPOPT_NOP << 16) |
+			    (TCPOPT_TIMESTAMP << 8) | TCPOLEN_TIMESTAMP) ||
+	    topt[0] != opt[0])
+		return false;
+	return !memcmp(topt + 3, opt + 3,
+		       hdrlen - sizeof(*th) - TCPOLEN_TSTAMP_ALIGNED);
+}
+
 bool tcp_add_backlog(struct sock *sk, struct sk_buff *skb,
 		     enum skb_drop_reason *reason)
 {
@@ -2020,6 +2066,7 @@ bool tcp_add_backlog(struct sock *sk, struct sk_buff *skb,
 	struct tcphdr *thtail;
 	struct sk_buff *tail;
 	unsigned int hdrlen;
+	bool ts_merge = false;
 	bool fragstolen;
 	u32 gso_segs;
 	u32 gso_size;
@@ -2068,7 +2115,9 @@ bool tcp_add_backlog(struct sock *sk, struct sk_buff *skb,
 	     (TCPHDR_ECE | TCPHDR_CWR | TCPHDR_AE)) ||
 	    !tcp_skb_can_collapse_rx(tail, skb) ||
 	    thtail->doff != th->doff ||
-	    memcmp(thtail + 1, th + 1, hdrlen - sizeof(*th)))
+	    (memcmp(thtail + 1, th + 1, hdrlen - sizeof(*th)) &&
+	     !(ts_merge = tcp_backlog_ts_mergeable(tail, thtail, skb, th,
+						   hdrlen))))
 		goto no_coalesce;
 
 	__skb_pull(skb, hdrlen);
@@ -2087,6 +2136,11 @@ bool tcp_add_backlog(struct sock *sk, struct sk_buff *skb,
 		if (likely(!before(TCP_SKB_CB(skb)->ack_seq, TCP_SKB_CB(tail)->ack_seq))) {
 			TCP_SKB_CB(tail)->ack_seq = TCP_SKB_CB(skb)->ack_seq;
 			thtail->window = th->window;
+			/* TSval and TSecr words of the aligned option */
+			if (ts_merge)
+				memcpy((__be32 *)(thtail + 1) + 1,
+				       (const __be32 *)(th + 1) + 1,
+				       TCPOLEN_TSTAMP_ALIGNED - 4);
 		}
 
 		/* We have to update both TCP_SKB_CB(tail)->tcp_flags and
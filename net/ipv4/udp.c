@@ -1835,9 +1835,19 @@ void skb_consume_udp(struct sock *sk, struct sk_buff *skb, int len)
 	/* In the more common cases we cleared the head states previously,
 	 * see __udp_queue_rcv_skb().
 	 */
-	if (unlikely(udp_skb_has_head_state(skb)))
+	if (unlikely(udp_skb_has_head_state(skb))) {
 		skb_release_head_state(skb);
-	__consume_stateless_skb(skb);
+		__consume_stateless_skb(skb);
+		return;
+	}
+
+	/* Let the allocating CPU free it in bulk, or recycle the head into
+	 * this CPU's NAPI cache, instead of going through slab per packet.
+	 * With CONFIG_DEBUG_NET skb_unref() dropped the last reference, but
+	 * the deferred free path expects to drop it itself.
+	 */
+	refcount_set(&skb->users, 1);
+	skb_attempt_defer_free(skb);
 }
 EXPORT_IPV6_MOD_GPL(skb_consume_udp);
 
@@ -115,6 +115,7 @@ static int rt6_fill_node(struct net *net, struct sk_buff *skb,
 static struct rt6_info *rt6_find_cached_rt(const struct fib6_result *res,
 					   const struct in6_addr *daddr,
 					   const struct in6_addr *saddr);
+static bool rt6_net_has_exceptions(const struct net *net);
 
 #ifdef CONFIG_IPV6_ROUTE_INFO
 static struct fib6_info *rt6_add_route_info(struct net *net,
@@ -1284,7 +1285,9 @@ INDIRECT_CALLABLE_SCOPE struct rt6_info *ip6_pol_route_lookup(struct net *net,
 			 fl6->flowi6_oif != 0, skb, flags);
 
 	/* Search through exception table */
-	rt = rt6_find_cached_rt(&res, &fl6->daddr, &fl6->saddr);
+	rt = NULL;
+	if (rt6_net_has_exceptions(net))
+		rt = rt6_find_cached_rt(&res, &fl6->daddr, &fl6->saddr);
 	if (rt) {
 		if (ip6_hold_safe(net, &rt))
 			dst_use_noref(&rt->dst, jiffies);
@@ -1499,6 +1502,9 @@ static void rt6_remove_exception(struct rt6_exception_bucket *bucket,
 
 	net = dev_net(rt6_ex->rt6i->dst.dev);
 	net->ipv6.rt6_stats->fib_rt_cache--;
+	if (!WARN_ON_ONCE(!net->ipv6.rt6_nr_exceptions))
+		WRITE_ONCE(net->ipv6.rt6_nr_exceptions,
+			   net->ipv6.rt6_nr_exceptions - 1);
 
 	/* purge completely the exception to allow releasing the held resources:
 	 * some [sk] cache may keep the dst around for unlimited time
@@ -1758,6 +1764,8 @@ static int rt6_insert_exception(struct rt6_info *nrt,
 	hlist_add_head_rcu(&rt6_ex->hlist, &bucket->chain);
 	bucket->depth++;
 	net->ipv6.rt6_stats->fib_rt_cache++;
+	WRITE_ONCE(net->ipv6.rt6_nr_exceptions,
+		   net->ipv6.rt6_nr_exceptions + 1);
 
 	/* Randomize max depth to avoid some side channels attacks. */
 	max_depth = FIB6_MAX_DEPTH + get_random_u32_below(FIB6_MAX_DEPTH);
@@ -1829,6 +1837,15 @@ void rt6_flush_exceptions(struct fib6_info *f6i)
 	}
 }
 
+/* Lets the lookup fast paths skip hashing into exception tables that
+ * are allocated but empty, which they stay once a PMTU or redirect
+ * exception has expired.
+ */
+static bool rt6_net_has_exceptions(const struct net *net)
+{
+	return READ_ONCE(net->ipv6.rt6_nr_exceptions);
+}
+
 /* Find cached rt in the hash table inside passed in rt
  * Caller has to hold rcu_read_lock()
  */
@@ -2272,7 +2289,8 @@ struct rt6_info *ip6_pol_route(struct net *net, struct fib6_table *table,
 	fib6_select_path(net, &res, fl6, oif, false, skb, strict);
 
 	/*Search through exception table */
-	rt = rt6_find_cached_rt(&res, &fl6->daddr, &fl6->saddr);
+	if (rt6_net_has_exceptions(net))
+		rt = rt6_find_cached_rt(&res, &fl6->daddr, &fl6->saddr);
 	if (rt) {
 		goto out;
 	} else if (unlikely((fl6->flowi6_flags & FLOWI_FLAG_KNOWN_NH) &&
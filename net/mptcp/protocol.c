@@ -1298,6 +1298,12 @@ static int mptcp_sendmsg_frag(struct sock *sk, struct sock *ssk,
 					 sizeof(struct ipv6hdr) - \
 					 sizeof(struct frag_hdr))
 
+/* A subflow is handed about this much of its pacing rate worth of data
+ * per scheduling decision, so that fast subflows are not relocked and
+ * pushed every MPTCP_SEND_BURST_SIZE bytes.
+ */
+#define MPTCP_SEND_BURST_USEC		1000
+
 struct subflow_send_info {
 	struct sock *ssk;
 	u64 linger_time;
@@ -1325,6 +1331,16 @@ bool mptcp_subflow_active(struct mptcp_subflow_context *subflow)
 	return __mptcp_subflow_active(subflow);
 }
 
+static u32 mptcp_subflow_send_burst(const struct sock *ssk)
+{
+	u64 burst = READ_ONCE(ssk->sk_pacing_rate) /
+		    (USEC_PER_SEC / MPTCP_SEND_BURST_USEC);
+
+	/* Never queue more than half the subflow sndbuf in one go */
+	burst = min_t(u64, burst, READ_ONCE(ssk->sk_sndbuf) >> 1);
+	return max_t(u64, burst, MPTCP_SEND_BURST_SIZE);
+}
+
 #define SSK_MODE_ACTIVE	0
 #define SSK_MODE_BACKUP	1
 #define SSK_MODE_MAX	2
@@ -1396,7 +1412,8 @@ struct sock *mptcp_subflow_get_send(struct mptcp_sock *msk)
 	if (!ssk || !sk_stream_memory_free(ssk))
 		return NULL;
 
-	burst = min_t(int, MPTCP_SEND_BURST_SIZE, mptcp_wnd_end(msk) - msk->snd_nxt);
+	burst = min_t(int, mptcp_subflow_send_burst(ssk),
+		      mptcp_wnd_end(msk) - msk->snd_nxt);
 	wmem = READ_ONCE(ssk->sk_wmem_queued);
 	if (!burst)
 		return ssk;
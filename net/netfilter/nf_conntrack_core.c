@@ -95,6 +95,8 @@ static DEFINE_MUTEX(nf_conntrack_mutex);
 
 #define GC_SCAN_MAX_DURATION	msecs_to_jiffies(10)
 #define GC_SCAN_EXPIRED_MAX	(64000u / HZ)
+/* Buckets ahead of the scan whose first entry is prefetched */
+#define GC_SCAN_PREFETCH	4
 
 #define MIN_CHAINLEN	50u
 #define MAX_CHAINLEN	(80u - MIN_CHAINLEN)
@@ -1513,6 +1515,17 @@ static bool gc_worker_can_early_drop(const struct nf_conn *ct)
 	return false;
 }
 
+/* The scan is bound by a cache miss on every entry it looks at, most
+ * chains hold a single one. Start loading it a few buckets early.
+ */
+static void gc_prefetch_bucket(const struct hlist_nulls_head *head)
+{
+	struct hlist_nulls_node *n = READ_ONCE(head->first);
+
+	if (!is_a_nulls(n))
+		prefetch(n);
+}
+
 static void gc_worker(struct work_struct *work)
 {
 	unsigned int i, hashsz, nf_conntrack_max95 = 0;
@@ -1554,6 +1567,9 @@ static void gc_worker(struct work_struct *work)
 			break;
 		}
 
+		if (i + GC_SCAN_PREFETCH < hashsz)
+			gc_prefetch_bucket(&ct_hash[i + GC_SCAN_PREFETCH]);
+
 		hlist_nulls_for_each_entry_rcu(h, n, &ct_hash[i], hnnode) {
 			struct nf_conntrack_net *cnet;
 			struct net *net;
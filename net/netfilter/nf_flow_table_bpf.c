@@ -50,6 +50,18 @@ bpf_xdp_flow_tuple_lookup(struct net_device *dev,
 
 	nf_flow = container_of(tuplehash, struct flow_offload,
 			       tuplehash[tuplehash->tuple.dir]);
+
+	/* Flows in teardown only wait for the GC to remove them. Leave
+	 * their packets to the stack, as the ingress hook does, so that
+	 * conntrack sees them instead of XDP forwarding on a dying flow.
+	 */
+	if (unlikely(test_bit(NF_FLOW_TEARDOWN, &nf_flow->flags)))
+		return ERR_PTR(-ENOENT);
+	if (unlikely(!nf_flow_dst_check(&tuplehash->tuple))) {
+		flow_offload_teardown(nf_flow);
+		return ERR_PTR(-ENOENT);
+	}
+
 	flow_offload_refresh(nf_flow_table, nf_flow, false);
 
 	return tuplehash;
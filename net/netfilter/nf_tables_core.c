@@ -173,6 +173,21 @@ static bool nft_payload_fast_eval(const struct nft_expr *expr,
 	return true;
 }
 
+/* Long chains of "payload; cmp" rules reload the same header field into
+ * the same register rule after rule. The fast compares never write a
+ * register, so as long as only they ran since @loaded was evaluated its
+ * destination register still holds the value @expr would load.
+ */
+static bool nft_payload_fast_reuse(const struct nft_expr *expr,
+				   const struct nft_payload *loaded)
+{
+	const struct nft_payload *priv = nft_expr_priv(expr);
+
+	return loaded && priv->dreg == loaded->dreg &&
+	       priv->base == loaded->base && priv->offset == loaded->offset &&
+	       priv->len == loaded->len;
+}
+
 DEFINE_STATIC_KEY_FALSE(nft_counters_enabled);
 
 static noinline void nft_update_chain_stats(const struct nft_chain *chain,
@@ -250,6 +265,7 @@ unsigned int
 nft_do_chain(struct nft_pktinfo *pkt, void *priv)
 {
 	const struct nft_chain *chain = priv, *basechain = chain;
+	const struct nft_payload *loaded = NULL;
 	const struct net *net = nft_net(pkt);
 	const struct nft_expr *expr, *last;
 	const struct nft_rule_dp *rule;
@@ -274,15 +290,23 @@ nft_do_chain(struct nft_pktinfo *pkt, void *priv)
 	regs.verdict.code = NFT_CONTINUE;
 	for (; !rule->is_last ; rule = nft_rule_next(rule)) {
 		nft_rule_dp_for_each_expr(expr, last, rule) {
-			if (expr->ops == &nft_cmp_fast_ops)
+			if (expr->ops == &nft_cmp_fast_ops) {
 				nft_cmp_fast_eval(expr, &regs);
-			else if (expr->ops == &nft_cmp16_fast_ops)
+			} else if (expr->ops == &nft_cmp16_fast_ops) {
 				nft_cmp16_fast_eval(expr, &regs);
-			else if (expr->ops == &nft_bitwise_fast_ops)
-				nft_bitwise_fast_eval(expr, &regs);
-			else if (expr->ops != &nft_payload_fast_ops ||
-				 !nft_payload_fast_eval(expr, &regs, pkt))
-				expr_call_ops_eval(expr, &regs, pkt);
+			} else if (expr->ops == &nft_payload_fast_ops &&
+				   nft_payload_fast_reuse(expr, loaded)) {
+				/* register already holds this payload */
+			} else {
+				loaded = NULL;
+				if (expr->ops == &nft_bitwise_fast_ops)
+					nft_bitwise_fast_eval(expr, &regs);
+				else if (expr->ops != &nft_payload_fast_ops ||
+					 !nft_payload_fast_eval(expr, &regs, pkt))
+					expr_call_ops_eval(expr, &regs, pkt);
+				else
+					loaded = nft_expr_priv(expr);
+			}
 
 			if (regs.verdict.code != NFT_CONTINUE)
 				break;
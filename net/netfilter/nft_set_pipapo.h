@@ -185,6 +185,8 @@ int pipapo_refill(unsigned long *map, unsigned int len, unsigned int rules,
  * @f:		Field including lookup table
  * @dst:	Area to store result
  * @data:	Input data selecting table buckets
+ *
+ * Stops as soon as @dst has no bit left, as further groups can't set any.
  */
 static inline void pipapo_and_field_buckets_4bit(const struct nft_pipapo_field *f,
 						 unsigned long *dst,
@@ -197,13 +199,15 @@ static inline void pipapo_and_field_buckets_4bit(const struct nft_pipapo_field *
 		u8 v;
 
 		v = *data >> 4;
-		__bitmap_and(dst, dst, lt + v * f->bsize,
-			     f->bsize * BITS_PER_LONG);
+		if (!__bitmap_and(dst, dst, lt + v * f->bsize,
+				  f->bsize * BITS_PER_LONG))
+			return;
 		lt += f->bsize * NFT_PIPAPO_BUCKETS(4);
 
 		v = *data & 0x0f;
-		__bitmap_and(dst, dst, lt + v * f->bsize,
-			     f->bsize * BITS_PER_LONG);
+		if (!__bitmap_and(dst, dst, lt + v * f->bsize,
+				  f->bsize * BITS_PER_LONG))
+			return;
 		lt += f->bsize * NFT_PIPAPO_BUCKETS(4);
 	}
 }
@@ -213,6 +217,8 @@ static inline void pipapo_and_field_buckets_4bit(const struct nft_pipapo_field *
  * @f:		Field including lookup table
  * @dst:	Area to store result
  * @data:	Input data selecting table buckets
+ *
+ * Stops as soon as @dst has no bit left, as further groups can't set any.
  */
 static inline void pipapo_and_field_buckets_8bit(const struct nft_pipapo_field *f,
 						 unsigned long *dst,
@@ -222,8 +228,9 @@ static inline void pipapo_and_field_buckets_8bit(const struct nft_pipapo_field *
 	int group;
 
 	for (group = 0; group < f->groups; group++, data++) {
-		__bitmap_and(dst, dst, lt + *data * f->bsize,
-			     f->bsize * BITS_PER_LONG);
+		if (!__bitmap_and(dst, dst, lt + *data * f->bsize,
+				  f->bsize * BITS_PER_LONG))
+			return;
 		lt += f->bsize * NFT_PIPAPO_BUCKETS(8);
 	}
 }
@@ -760,6 +760,12 @@ static struct sw_flow *flow_lookup(struct flow_table *tbl,
 		if (unlikely(!mask))
 			break;
 
+		/* With hundreds of masks they no longer stay cache hot, load
+		 * the next one's range while hashing with this one.
+		 */
+		if (i + 1 < ma->max)
+			prefetch(rcu_dereference_ovsl(ma->masks[i + 1]));
+
 		flow = masked_flow_lookup(ti, key, mask, n_mask_hit);
 		if (flow) { /* Found */
 			*index = i;
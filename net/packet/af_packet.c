@@ -1319,6 +1319,14 @@ static bool __tpacket_v3_has_room(const struct packet_sock *po, int pow_off)
 	return prb_lookup_block(po, &po->rx_ring, idx, TP_STATUS_KERNEL);
 }
 
+/* tpacket_rcv() only needs the slot the next packet is written to */
+static bool __tpacket_rcv_has_room(const struct packet_sock *po)
+{
+	if (po->tp_version == TPACKET_V3)
+		return __tpacket_v3_has_room(po, 0);
+	return __tpacket_has_room(po, 0);
+}
+
 static int __packet_rcv_has_room(const struct packet_sock *po,
 				 const struct sk_buff *skb)
 {
@@ -2330,7 +2338,7 @@ static int tpacket_rcv(struct sk_buff *skb, struct net_device *dev,
 		goto drop_n_restore;
 
 	/* If we are flooded, just give up */
-	if (__packet_rcv_has_room(po, skb) == ROOM_NONE) {
+	if (!__tpacket_rcv_has_room(po)) {
 		atomic_inc(&po->tp_drops);
 		goto drop_n_restore;
 	}
@@ -314,6 +314,8 @@ static int tcf_bpf_init(struct net *net, struct nlattr *nla,
 			return ret;
 		}
 
+		/* Undone in tcf_bpf_cleanup(), programs may read current */
+		qdisc_defer_block();
 		res = ACT_P_CREATED;
 	} else if (ret > 0) {
 		/* Don't override defaults. */
@@ -389,6 +391,7 @@ static void tcf_bpf_cleanup(struct tc_action *act)
 
 	tcf_bpf_prog_fill_cfg(to_bpf(act), &tmp);
 	tcf_bpf_cfg_cleanup(&tmp);
+	qdisc_defer_unblock();
 }
 
 static struct tc_action_ops act_bpf_ops __read_mostly = {
@@ -251,6 +251,8 @@ static int cls_bpf_init(struct tcf_proto *tp)
 	INIT_LIST_HEAD_RCU(&head->plist);
 	idr_init(&head->handle_idr);
 	rcu_assign_pointer(tp->root, head);
+	/* Programs may read current, e.g. bpf_get_cgroup_classid() */
+	qdisc_defer_block();
 
 	return 0;
 }
@@ -321,6 +323,7 @@ static void cls_bpf_destroy(struct tcf_proto *tp, bool rtnl_held,
 
 	idr_destroy(&head->handle_idr);
 	kfree_rcu(head, rcu);
+	qdisc_defer_unblock();
 }
 
 static void *cls_bpf_get(struct tcf_proto *tp, u32 handle)
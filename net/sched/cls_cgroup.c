@@ -50,6 +50,8 @@ static void *cls_cgroup_get(struct tcf_proto *tp, u32 handle)
 
 static int cls_cgroup_init(struct tcf_proto *tp)
 {
+	/* task_get_classid() reads current, which must be the sender */
+	qdisc_defer_block();
 	return 0;
 }
 
@@ -136,6 +138,8 @@ static void cls_cgroup_destroy(struct tcf_proto *tp, bool rtnl_held,
 {
 	struct cls_cgroup_head *head = rtnl_dereference(tp->root);
 
+	qdisc_defer_unblock();
+
 	/* Head can still be NULL due to cls_cgroup_init(). */
 	if (head) {
 		if (tcf_exts_get_net(&head->exts))
@@ -969,6 +969,9 @@ struct Qdisc *qdisc_alloc(struct netdev_queue *dev_queue,
 		}
 	}
 
+	init_llist_head(&sch->defer_list);
+	atomic_long_set(&sch->defer_count, 0);
+
 	spin_lock_init(&sch->busylock);
 	lockdep_set_class(&sch->busylock,
 			  dev->qdisc_tx_busylock ?: &qdisc_tx_busylock);
@@ -921,6 +921,48 @@ bool svc_rqst_replace_page(struct svc_rqst *rqstp, struct page *page)
 }
 EXPORT_SYMBOL_GPL(svc_rqst_replace_page);
 
+/**
+ * svc_rqst_replace_pages - Replace pages in rq_pages[] with part of a folio
+ * @rqstp: svc_rqst with pages to replace
+ * @page: first replacement page
+ * @nr: number of consecutive pages of @page's folio to insert
+ *
+ * Like svc_rqst_replace_page(), but takes all references on the folio
+ * with a single atomic operation. Splicing a large folio otherwise
+ * bumps the same refcount once per page, which bounces when many
+ * threads read the same file.
+ *
+ * Return values:
+ *   %true: pages replaced
+ *   %false: array bounds checking failed
+ */
+bool svc_rqst_replace_pages(struct svc_rqst *rqstp, struct page *page,
+			    unsigned int nr)
+{
+	struct page **begin = rqstp->rq_pages;
+	struct page **end = &rqstp->rq_pages[rqstp->rq_maxpages];
+	unsigned int i;
+
+	if (unlikely(rqstp->rq_next_page < begin ||
+		     rqstp->rq_next_page + nr - 1 > end)) {
+		trace_svc_replace_page_err(rqstp);
+		return false;
+	}
+
+	for (i = 0; i < nr; i++) {
+		struct page *old = rqstp->rq_next_page[i];
+
+		if (old && !folio_batch_add(&rqstp->rq_fbatch, page_folio(old)))
+			__folio_batch_release(&rqstp->rq_fbatch);
+		rqstp->rq_next_page[i] = page + i;
+	}
+
+	folio_ref_add(page_folio(page), nr);
+	rqstp->rq_next_page += nr;
+	return true;
+}
+EXPORT_SYMBOL_GPL(svc_rqst_replace_pages);
+
 /**
  * svc_rqst_release_pages - Release Reply buffer pages
  * @rqstp: RPC transaction context
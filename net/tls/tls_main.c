@@ -174,9 +174,7 @@ int tls_push_sg(struct sock *sk,
 		int flags)
 {
 	struct bio_vec bvec;
-	struct msghdr msg = {
-		.msg_flags = MSG_SPLICE_PAGES | flags,
-	};
+	struct msghdr msg = {};
 	int ret = 0;
 	struct page *p;
 	size_t size;
@@ -190,6 +188,9 @@ int tls_push_sg(struct sock *sk,
 		/* is sending application-limited? */
 		tcp_rate_check_app_limited(sk);
 		p = sg_page(sg);
+		/* Only the last fragment of a record may push the socket */
+		msg.msg_flags = MSG_SPLICE_PAGES | flags |
+				(sg_is_last(sg) ? 0 : MSG_MORE);
 retry:
 		bvec_set_page(&bvec, p, size, offset);
 		iov_iter_bvec(&msg.msg_iter, ITER_SOURCE, &bvec, 1, size);
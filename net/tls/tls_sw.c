@@ -440,6 +440,10 @@ int tls_tx_records(struct sock *sk, int flags)
 				tx_flags = rec->tx_flags;
 			else
 				tx_flags = flags;
+			/* More ready records follow, let them fill segments */
+			if (!list_is_last(&rec->list, &ctx->tx_list) &&
+			    READ_ONCE(tmp->tx_ready))
+				tx_flags |= MSG_MORE;
 
 			msg_en = &rec->msg_encrypted;
 			rc = tls_push_sg(sk, tls_ctx,
@@ -2251,11 +2251,16 @@ static int unix_dgram_sendmsg(struct socket *sock, struct msghdr *msg,
 	return err;
 }
 
-/* We use paged skbs for stream sockets, and limit occupancy to 32768
+/* We use paged skbs for stream sockets, allocated in chunks of 32768
  * bytes, and a minimum of a full page.
  */
 #define UNIX_SKB_FRAGS_SZ (PAGE_SIZE << get_order(32768))
 
+/* Largest paged part of an skb that still fits when every chunk falls
+ * back to an order-0 page, see alloc_skb_with_frags().
+ */
+#define UNIX_SKB_DATA_MAX ((MAX_SKB_FRAGS - 1) * PAGE_SIZE)
+
 #if IS_ENABLED(CONFIG_AF_UNIX_OOB)
 static int queue_oob(struct sock *sk, struct msghdr *msg, struct sock *other,
 		     struct scm_cookie *scm, bool fds_sent)
@@ -2366,7 +2371,7 @@ static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 			size = min_t(int, size, (READ_ONCE(sk->sk_sndbuf) >> 1) - 64);
 
 			/* allow fallback to order-0 allocations */
-			size = min_t(int, size, SKB_MAX_HEAD(0) + UNIX_SKB_FRAGS_SZ);
+			size = min_t(int, size, SKB_MAX_HEAD(0) + UNIX_SKB_DATA_MAX);
 
 			data_len = max_t(int, 0, size - SKB_MAX_HEAD(0));
 
@@ -35,6 +35,7 @@
 
 #define TX_BATCH_SIZE 32
 #define MAX_PER_SOCKET_BUDGET (TX_BATCH_SIZE)
+#define RX_COPY_BATCH_SIZE 16
 
 void xsk_set_rx_need_wakeup(struct xsk_buff_pool *pool)
 {
@@ -228,7 +229,9 @@ static int __xsk_rcv(struct xdp_sock *xs, struct xdp_buff *xdp, u32 len)
 {
 	u32 frame_size = xsk_pool_get_rx_frame_size(xs->pool);
 	void *copy_from = xsk_copy_xdp_start(xdp), *copy_to;
+	struct xdp_buff *bufs[RX_COPY_BATCH_SIZE];
 	u32 from_len, meta_len, rem, num_desc;
+	u32 i = 0, nb_bufs, nb_alloc;
 	struct xdp_buff_xsk *xskb;
 	struct xdp_buff *xsk_xdp;
 	skb_frag_t *frag;
@@ -274,11 +277,26 @@ static int __xsk_rcv(struct xdp_sock *xs, struct xdp_buff *xdp, u32 len)
 		frag =  &sinfo->frags[0];
 	}
 
+	/* Take the buffers for the packet off the fill ring in one go */
+	nb_bufs = min_t(u32, num_desc, RX_COPY_BATCH_SIZE);
+	nb_alloc = xsk_buff_alloc_batch(xs->pool, bufs, nb_bufs);
+	if (unlikely(nb_alloc < nb_bufs)) {
+		while (nb_alloc--)
+			xp_free(container_of(bufs[nb_alloc], struct xdp_buff_xsk, xdp));
+		xs->rx_dropped++;
+		return -ENOMEM;
+	}
+
 	do {
 		u32 to_len = frame_size + meta_len;
 		u32 copied;
 
-		xsk_xdp = xsk_buff_alloc(xs->pool);
+		if (i < nb_bufs) {
+			xsk_xdp = bufs[i++];
+			xsk_buff_set_size(xsk_xdp, 0);
+		} else {
+			xsk_xdp = xsk_buff_alloc(xs->pool);
+		}
 		copy_to = xsk_xdp->data - meta_len;
 
 		copied = xsk_copy_xdp(copy_to, &copy_from, to_len, &from_len, &frag, rem);
@@ -377,7 +377,8 @@ find_rule(const struct landlock_ruleset *const domain,
 	inode = d_backing_inode(dentry);
 	rcu_read_lock();
 	id.key.object = rcu_dereference(landlock_inode(inode)->object);
-	rule = landlock_find_rule(domain, id);
+	/* Inodes no ruleset ever tied a rule to don't need a tree walk. */
+	rule = id.key.object ? landlock_find_rule(domain, id) : NULL;
 	rcu_read_unlock();
 	return rule;
 }
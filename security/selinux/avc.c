@@ -37,6 +37,7 @@
 #define AVC_CACHE_SLOTS			512
 #define AVC_DEF_CACHE_THRESHOLD		512
 #define AVC_CACHE_RECLAIM		16
+#define AVC_PCPU_SLOTS			64
 
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 #define avc_cache_stats_incr(field)	this_cpu_inc(avc_cache_stats.field)
@@ -76,6 +77,24 @@ struct avc_cache {
 	u32			latest_notif;	/* latest revocation notification */
 };
 
+/*
+ * A small direct-mapped copy of recently granted decisions, per CPU, that
+ * is looked up before the global cache.  Only used from task context, so
+ * that disabling preemption is enough to keep its entries consistent.
+ */
+struct avc_pcpu_entry {
+	u32			ssid;
+	u32			tsid;
+	u16			tclass;
+	struct av_decision	avd;
+};
+
+struct avc_pcpu_cache {
+	struct avc_pcpu_entry	slots[AVC_PCPU_SLOTS];
+};
+
+static DEFINE_PER_CPU(struct avc_pcpu_cache, avc_pcpu_cache);
+
 struct avc_callback_node {
 	int (*callback) (u32 event);
 	u32 events;
@@ -564,6 +583,54 @@ static struct avc_node *avc_lookup(u32 ssid, u32 tsid, u16 tclass)
 	return NULL;
 }
 
+/*
+ * Only decisions granting all of @requested are served from the per-CPU
+ * cache, denials go to the global cache where avc_denied() may update them.
+ * Entries from an older policy are ignored, as the global cache was flushed.
+ */
+static inline bool avc_pcpu_lookup(u32 ssid, u32 tsid, u16 tclass,
+				   u32 requested, struct av_decision *avd)
+{
+	struct avc_pcpu_cache *cache;
+	struct avc_pcpu_entry *entry;
+	bool hit = false;
+
+	if (!in_task())
+		return false;
+
+	cache = get_cpu_ptr(&avc_pcpu_cache);
+	entry = &cache->slots[avc_hash(ssid, tsid, tclass) & (AVC_PCPU_SLOTS - 1)];
+	if (entry->ssid == ssid && entry->tsid == tsid &&
+	    entry->tclass == tclass && !(requested & ~entry->avd.allowed) &&
+	    entry->avd.seqno == avc_policy_seqno()) {
+		memcpy(avd, &entry->avd, sizeof(*avd));
+		hit = true;
+	}
+	put_cpu_ptr(&avc_pcpu_cache);
+
+	if (hit)
+		avc_cache_stats_incr(lookups);
+	return hit;
+}
+
+static inline void avc_pcpu_insert(u32 ssid, u32 tsid, u16 tclass,
+				   struct av_decision *avd)
+{
+	struct avc_pcpu_cache *cache;
+	struct avc_pcpu_entry *entry;
+
+	if (!in_task())
+		return;
+
+	cache = get_cpu_ptr(&avc_pcpu_cache);
+	entry = &cache->slots[avc_hash(ssid, tsid, tclass) & (AVC_PCPU_SLOTS - 1)];
+	entry->ssid = ssid;
+	entry->tsid = tsid;
+	entry->tclass = tclass;
+	memcpy(&entry->avd, avd, sizeof(entry->avd));
+	put_cpu_ptr(&avc_pcpu_cache);
+}
+
 static int avc_latest_notif_update(u32 seqno, int is_insert)
 {
 	int ret = 0;
@@ -1153,6 +1220,9 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 	if (WARN_ON(!requested))
 		return -EACCES;
 
+	if (avc_pcpu_lookup(ssid, tsid, tclass, requested, avd))
+		return 0;
+
 	rcu_read_lock();
 	node = avc_lookup(ssid, tsid, tclass);
 	if (unlikely(!node)) {
@@ -1167,6 +1237,7 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 	if (unlikely(denied))
 		return avc_denied(ssid, tsid, tclass, requested, 0, 0, 0,
 				  flags, avd);
+	avc_pcpu_insert(ssid, tsid, tclass, avd);
 	return 0;
 }
 
@@ -134,6 +134,10 @@ enum {
 	NETDEV_A_NAPI_DEFER_HARD_IRQS,
 	NETDEV_A_NAPI_GRO_FLUSH_TIMEOUT,
 	NETDEV_A_NAPI_IRQ_SUSPEND_TIMEOUT,
+	NETDEV_A_NAPI_THREADED_POLL_TIMEOUT,
+	NETDEV_A_NAPI_GRO_HELD,
+	NETDEV_A_NAPI_GRO_MERGED,
+	NETDEV_A_NAPI_GRO_EVICTED,
 
 	__NETDEV_A_NAPI_MAX,
 	NETDEV_A_NAPI_MAX = (__NETDEV_A_NAPI_MAX - 1)
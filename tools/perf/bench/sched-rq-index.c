@@ -0,0 +1,499 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * sched-rq-index.c
+ *
+ * rq-index: Compare the runqueue indexes of the fair scheduler
+ *
+ * Replays the EEVDF pick/requeue cycle of a single, deeply loaded runqueue
+ * in user space, once against the augmented rb-tree and once against the
+ * bucketed deadline wheel (CONFIG_SCHED_EEVDF_BUCKETS), and reports the
+ * cost of each cycle.  Both indexes mirror kernel/sched/fair.c.
+ */
+#include <subcmd/parse-options.h>
+#include "bench.h"
+#include "../util/stat.h"
+
+#include <linux/bitmap.h>
+#include <linux/bitops.h>
+#include <linux/compiler.h>
+#include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/rbtree_augmented.h>
+#include <linux/time64.h>
+#include <linux/types.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define RQ_NR_BUCKETS		64
+#define RQ_BUCKET_MASK		(RQ_NR_BUCKETS - 1)
+#define RQ_BUCKET_SHIFT		18
+#define RQ_SLICE_NS		3000000ULL
+#define NICE_0_WEIGHT		1024
+
+static unsigned int nr_tasks = 5000;
+static unsigned int loops = 1000000;
+static unsigned int outer_iterations = 5;
+
+static const struct option options[] = {
+	OPT_UINTEGER('n', "nr-tasks", &nr_tasks,
+		"Number of runnable tasks on the runqueue"),
+	OPT_UINTEGER('l', "loops", &loops,
+		"Number of pick/requeue cycles per iteration"),
+	OPT_UINTEGER('i', "iterations", &outer_iterations,
+		"Number of iterations used"),
+	OPT_END()
+};
+
+static const char * const bench_usage[] = {
+	"perf bench sched rq-index <options>",
+	NULL
+};
+
+/* Weights of nice -5..5, see sched_prio_to_weight[]. */
+static const unsigned long weights[] = {
+	3121, 2501, 1991, 1586, 1277, 1024, 820, 655, 526, 423, 335,
+};
+
+struct bench_se {
+	struct rb_node		run_node;
+	struct list_head	bucket_node;
+	unsigned int		bucket;
+	unsigned long		weight;
+	u64			vruntime;
+	u64			deadline;
+	u64			min_vruntime;
+};
+
+struct bench_bucket {
+	struct list_head	entities;
+	u64			min_vruntime;
+};
+
+struct bench_rq {
+	/* Same bookkeeping as cfs_rq::avg_vruntime and friends. */
+	s64			avg_vruntime;
+	u64			avg_load;
+	u64			min_vruntime;
+
+	struct rb_root_cached	tasks_timeline;
+
+	u64			base;
+	u64			buckets_min_vruntime;
+	unsigned int		head;
+	unsigned int		nr;
+	DECLARE_BITMAP(occupied, RQ_NR_BUCKETS);
+	struct bench_bucket	bucket[RQ_NR_BUCKETS];
+};
+
+struct rq_index {
+	const char		*name;
+	void			(*add)(struct bench_rq *rq, struct bench_se *se);
+	void			(*del)(struct bench_rq *rq, struct bench_se *se);
+	struct bench_se		*(*pick)(struct bench_rq *rq);
+	u64			(*min_vruntime)(struct bench_rq *rq);
+};
+
+static inline bool vruntime_before(u64 a, u64 b)
+{
+	return (s64)(a - b) < 0;
+}
+
+static inline u64 min_vruntime(u64 a, u64 b)
+{
+	return vruntime_before(a, b) ? a : b;
+}
+
+static inline bool entity_before(struct bench_se *a, struct bench_se *b)
+{
+	return vruntime_before(a->deadline, b->deadline);
+}
+
+static bool vruntime_eligible(struct bench_rq *rq, u64 vruntime)
+{
+	return rq->avg_vruntime >= (s64)(vruntime - rq->min_vruntime) * (s64)rq->avg_load;
+}
+
+static void avg_vruntime_add(struct bench_rq *rq, struct bench_se *se)
+{
+	rq->avg_vruntime += (s64)(se->vruntime - rq->min_vruntime) * se->weight;
+	rq->avg_load += se->weight;
+}
+
+static void avg_vruntime_sub(struct bench_rq *rq, struct bench_se *se)
+{
+	rq->avg_vruntime -= (s64)(se->vruntime - rq->min_vruntime) * se->weight;
+	rq->avg_load -= se->weight;
+}
+
+static void update_min_vruntime(struct bench_rq *rq, u64 vruntime)
+{
+	s64 delta = (s64)(vruntime - rq->min_vruntime);
+
+	if (delta > 0) {
+		rq->avg_vruntime -= rq->avg_load * delta;
+		rq->min_vruntime = vruntime;
+	}
+}
+
+/* Augmented rb-tree, as in the default kernel configuration. */
+
+#define __node_2_se(node) rb_entry((node), struct bench_se, run_node)
+
+static inline bool min_vruntime_update(struct bench_se *se, bool exit __maybe_unused)
+{
+	u64 old = se->min_vruntime;
+	struct rb_node *node = &se->run_node;
+
+	se->min_vruntime = se->vruntime;
+	if (node->rb_right)
+		se->min_vruntime = min_vruntime(se->min_vruntime,
+				__node_2_se(node->rb_right)->min_vruntime);
+	if (node->rb_left)
+		se->min_vruntime = min_vruntime(se->min_vruntime,
+				__node_2_se(node->rb_left)->min_vruntime);
+
+	return se->min_vruntime == old;
+}
+
+RB_DECLARE_CALLBACKS(static, min_vruntime_cb, struct bench_se,
+		     run_node, min_vruntime, min_vruntime_update);
+
+static void rbtree_add(struct bench_rq *rq, struct bench_se *se)
+{
+	struct rb_node **link = &rq->tasks_timeline.rb_root.rb_node;
+	struct rb_node *parent = NULL;
+	bool leftmost = true;
+
+	se->min_vruntime = se->vruntime;
+	while (*link) {
+		struct bench_se *entry = __node_2_se(*link);
+
+		parent = *link;
+		entry->min_vruntime = min_vruntime(entry->min_vruntime, se->vruntime);
+		if (entity_before(se, entry)) {
+			link = &parent->rb_left;
+		} else {
+			link = &parent->rb_right;
+			leftmost = false;
+		}
+	}
+	rb_link_node(&se->run_node, parent, link);
+	rb_insert_augmented_cached(&se->run_node, &rq->tasks_timeline,
+				   leftmost, &min_vruntime_cb);
+}
+
+static void rbtree_del(struct bench_rq *rq, struct bench_se *se)
+{
+	rb_erase_augmented_cached(&se->run_node, &rq->tasks_timeline,
+				  &min_vruntime_cb);
+}
+
+static struct bench_se *rbtree_pick(struct bench_rq *rq)
+{
+	struct rb_node *node = rq->tasks_timeline.rb_root.rb_node;
+	struct rb_node *first = rb_first_cached(&rq->tasks_timeline);
+
+	if (first && vruntime_eligible(rq, __node_2_se(first)->vruntime))
+		return __node_2_se(first);
+
+	while (node) {
+		struct rb_node *left = node->rb_left;
+		struct bench_se *se;
+
+		if (left && vruntime_eligible(rq, __node_2_se(left)->min_vruntime)) {
+			node = left;
+			continue;
+		}
+
+		se = __node_2_se(node);
+		if (vruntime_eligible(rq, se->vruntime))
+			return se;
+
+		node = node->rb_right;
+	}
+	return NULL;
+}
+
+static u64 rbtree_min_vruntime(struct bench_rq *rq)
+{
+	return __node_2_se(rq->tasks_timeline.rb_root.rb_node)->min_vruntime;
+}
+
+/* Bucketed deadline wheel, as with sched_rq_index=buckets. */
+
+static inline struct bench_bucket *logical_bucket(struct bench_rq *rq, unsigned int pos)
+{
+	return &rq->bucket[(rq->head + pos) & RQ_BUCKET_MASK];
+}
+
+static unsigned int next_bucket(struct bench_rq *rq, unsigned int pos)
+{
+	unsigned int tail = RQ_NR_BUCKETS - rq->head;
+	unsigned int n;
+
+	if (pos < tail) {
+		n = find_next_bit(rq->occupied, RQ_NR_BUCKETS, rq->head + pos);
+		if (n < RQ_NR_BUCKETS)
+			return n - rq->head;
+		pos = tail;
+	}
+
+	n = find_next_bit(rq->occupied, rq->head, pos - tail);
+	if (n < rq->head)
+		return n + tail;
+
+	return RQ_NR_BUCKETS;
+}
+
+#define for_each_occupied_bucket(rq, pos)				\
+	for (pos = next_bucket(rq, 0); pos < RQ_NR_BUCKETS;		\
+	     pos = next_bucket(rq, pos + 1))
+
+static void bucket_update(struct bench_bucket *b)
+{
+	struct bench_se *se;
+
+	se = list_first_entry(&b->entities, struct bench_se, bucket_node);
+	b->min_vruntime = se->vruntime;
+	list_for_each_entry_continue(se, &b->entities, bucket_node)
+		b->min_vruntime = min_vruntime(b->min_vruntime, se->vruntime);
+}
+
+static void buckets_update(struct bench_rq *rq)
+{
+	unsigned int pos;
+	bool first = true;
+
+	for_each_occupied_bucket(rq, pos) {
+		u64 vruntime = logical_bucket(rq, pos)->min_vruntime;
+
+		rq->buckets_min_vruntime = first ? vruntime :
+			min_vruntime(rq->buckets_min_vruntime, vruntime);
+		first = false;
+	}
+}
+
+static void bucket_insert(struct bench_rq *rq, struct bench_se *se)
+{
+	s64 delta = (s64)(se->deadline - rq->base);
+	struct list_head *link;
+	unsigned int pos = 0, idx;
+	struct bench_se *prev;
+	struct bench_bucket *b;
+
+	if (delta > 0)
+		pos = min_t(u64, delta >> RQ_BUCKET_SHIFT, RQ_NR_BUCKETS - 1);
+
+	idx = (rq->head + pos) & RQ_BUCKET_MASK;
+	b = &rq->bucket[idx];
+	if (list_empty(&b->entities)) {
+		b->min_vruntime = se->vruntime;
+		__set_bit(idx, rq->occupied);
+	} else {
+		b->min_vruntime = min_vruntime(b->min_vruntime, se->vruntime);
+	}
+
+	link = &b->entities;
+	list_for_each_entry_reverse(prev, &b->entities, bucket_node) {
+		if (!entity_before(se, prev))
+			break;
+		link = &prev->bucket_node;
+	}
+	list_add_tail(&se->bucket_node, link);
+	se->bucket = idx;
+}
+
+static void buckets_rotate(struct bench_rq *rq)
+{
+	while (!test_bit(rq->head, rq->occupied)) {
+		unsigned int last = (rq->head + RQ_BUCKET_MASK) & RQ_BUCKET_MASK;
+		unsigned int pos = next_bucket(rq, 0);
+		struct bench_se *se, *next;
+		LIST_HEAD(overflow);
+
+		rq->head = (rq->head + pos) & RQ_BUCKET_MASK;
+		rq->base += (u64)pos << RQ_BUCKET_SHIFT;
+
+		if (!test_bit(last, rq->occupied))
+			continue;
+
+		list_splice_init(&rq->bucket[last].entities, &overflow);
+		__clear_bit(last, rq->occupied);
+		list_for_each_entry_safe(se, next, &overflow, bucket_node)
+			bucket_insert(rq, se);
+	}
+}
+
+static void buckets_add(struct bench_rq *rq, struct bench_se *se)
+{
+	if (!rq->nr++) {
+		rq->base = se->deadline & ~((1ULL << RQ_BUCKET_SHIFT) - 1);
+		rq->head = 0;
+		rq->buckets_min_vruntime = se->vruntime;
+	} else {
+		rq->buckets_min_vruntime = min_vruntime(rq->buckets_min_vruntime,
+							se->vruntime);
+	}
+	bucket_insert(rq, se);
+}
+
+static void buckets_del(struct bench_rq *rq, struct bench_se *se)
+{
+	struct bench_bucket *b = &rq->bucket[se->bucket];
+
+	list_del(&se->bucket_node);
+	if (list_empty(&b->entities))
+		__clear_bit(se->bucket, rq->occupied);
+	else if (se->vruntime == b->min_vruntime)
+		bucket_update(b);
+
+	if (!--rq->nr)
+		return;
+
+	buckets_rotate(rq);
+	if (se->vruntime == rq->buckets_min_vruntime)
+		buckets_update(rq);
+}
+
+static struct bench_se *buckets_pick(struct bench_rq *rq)
+{
+	struct bench_se *se;
+	unsigned int pos;
+
+	for_each_occupied_bucket(rq, pos) {
+		struct bench_bucket *b = logical_bucket(rq, pos);
+
+		if (!vruntime_eligible(rq, b->min_vruntime))
+			continue;
+
+		list_for_each_entry(se, &b->entities, bucket_node) {
+			if (vruntime_eligible(rq, se->vruntime))
+				return se;
+		}
+	}
+	return NULL;
+}
+
+static u64 buckets_min_vruntime(struct bench_rq *rq)
+{
+	return rq->buckets_min_vruntime;
+}
+
+static const struct rq_index rq_indexes[] = {
+	{
+		.name		= "rbtree",
+		.add		= rbtree_add,
+		.del		= rbtree_del,
+		.pick		= rbtree_pick,
+		.min_vruntime	= rbtree_min_vruntime,
+	},
+	{
+		.name		= "buckets",
+		.add		= buckets_add,
+		.del		= buckets_del,
+		.pick		= buckets_pick,
+		.min_vruntime	= buckets_min_vruntime,
+	},
+};
+
+static void rq_init(struct bench_rq *rq, struct bench_se *ses,
+		    const struct rq_index *idx)
+{
+	unsigned int i;
+
+	memset(rq, 0, sizeof(*rq));
+	rq->tasks_timeline = RB_ROOT_CACHED;
+	for (i = 0; i < RQ_NR_BUCKETS; i++)
+		INIT_LIST_HEAD(&rq->bucket[i].entities);
+
+	/* Same seed for both indexes, so they replay the same schedule. */
+	srand(nr_tasks);
+	for (i = 0; i < nr_tasks; i++) {
+		struct bench_se *se = &ses[i];
+
+		se->weight = weights[rand() % ARRAY_SIZE(weights)];
+		se->vruntime = rand() % RQ_SLICE_NS;
+		se->deadline = se->vruntime + RQ_SLICE_NS * NICE_0_WEIGHT / se->weight;
+		avg_vruntime_add(rq, se);
+		idx->add(rq, se);
+	}
+}
+
+/*
+ * One scheduling cycle: pick the EEVD entity, charge it a full slice and
+ * requeue it with its new deadline.
+ */
+static void rq_cycle(struct bench_rq *rq, const struct rq_index *idx)
+{
+	struct bench_se *se = idx->pick(rq);
+
+	if (!se) {
+		fprintf(stderr, "%s: no eligible entity\n", idx->name);
+		exit(EXIT_FAILURE);
+	}
+
+	idx->del(rq, se);
+	avg_vruntime_sub(rq, se);
+	se->vruntime += RQ_SLICE_NS * NICE_0_WEIGHT / se->weight;
+	se->deadline = se->vruntime + RQ_SLICE_NS * NICE_0_WEIGHT / se->weight;
+	avg_vruntime_add(rq, se);
+	idx->add(rq, se);
+
+	update_min_vruntime(rq, idx->min_vruntime(rq));
+}
+
+int bench_sched_rq_index(int argc, const char **argv)
+{
+	struct bench_se *ses;
+	struct bench_rq *rq;
+	unsigned int i, j, k;
+
+	argc = parse_options(argc, argv, options, bench_usage, 0);
+	if (argc || !nr_tasks) {
+		usage_with_options(bench_usage, options);
+		exit(EXIT_FAILURE);
+	}
+
+	ses = calloc(nr_tasks, sizeof(*ses));
+	rq = malloc(sizeof(*rq));
+	if (!ses || !rq) {
+		fprintf(stderr, "memory allocation failure\n");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("# %u pick/requeue cycles on a runqueue of %u tasks\n",
+	       loops, nr_tasks);
+
+	for (k = 0; k < ARRAY_SIZE(rq_indexes); k++) {
+		const struct rq_index *idx = &rq_indexes[k];
+		struct timeval start, end, diff;
+		struct stats time_stats;
+		u64 runtime_us;
+
+		init_stats(&time_stats);
+		for (i = 0; i < outer_iterations; i++) {
+			rq_init(rq, ses, idx);
+
+			gettimeofday(&start, NULL);
+			for (j = 0; j < loops; j++)
+				rq_cycle(rq, idx);
+			gettimeofday(&end, NULL);
+
+			timersub(&end, &start, &diff);
+			runtime_us = diff.tv_sec * USEC_PER_SEC + diff.tv_usec;
+			update_stats(&time_stats, runtime_us);
+		}
+
+		printf("  %-8s: %.3f usec (+- %.3f usec), %.1f nsec/cycle\n",
+		       idx->name, avg_stats(&time_stats),
+		       stddev_stats(&time_stats),
+		       avg_stats(&time_stats) * NSEC_PER_USEC / loops);
+	}
+
+	free(rq);
+	free(ses);
+	return 0;
+}
@@ -23,9 +23,12 @@
 #endif
 
 static	int loops;
+static const char *exec_path = "/bin/true";
 
 static const struct option options[] = {
 	OPT_INTEGER('l', "loop",	&loops,		"Specify number of loops"),
+	OPT_STRING('p', "path",	&exec_path,	"path",
+		   "Binary to run in the execve benchmark (default: /bin/true)"),
 	OPT_END()
 };
 
@@ -53,7 +56,7 @@ static void test_fork(void)
 
 static void test_execve(void)
 {
-	const char *pathname = "/bin/true";
+	const char *pathname = exec_path;
 	char *const argv[] = { (char *)pathname, NULL };
 	pid_t pid = fork();
 
@@ -62,7 +65,7 @@ static void test_execve(void)
 		exit(1);
 	} else if (pid == 0) {
 		execve(pathname, argv, NULL);
-		fprintf(stderr, "execve /bin/true failed\n");
+		fprintf(stderr, "execve %s failed\n", pathname);
 		exit(1);
 	} else {
 		if (waitpid(pid, NULL, 0) < 0) {
@@ -108,6 +111,7 @@ static int bench_syscall_common(int argc, const char **argv, int syscall)
 			break;
 		case __NR_execve:
 			test_execve();
+			break;
 		default:
 			break;
 		}
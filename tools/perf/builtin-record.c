@@ -1956,6 +1956,7 @@ static void record__read_lost_samples(struct record *rec)
 	struct perf_session *session = rec->session;
 	struct perf_record_lost_samples_and_ids lost;
 	struct evsel *evsel;
+	u64 ring_lost = 0;
 
 	/* there was an error during record__open */
 	if (session->evlist == NULL)
@@ -1987,6 +1988,7 @@ static void record__read_lost_samples(struct record *rec)
 					lost.lost.header.type = PERF_RECORD_LOST_SAMPLES;
 					__record__save_lost_samples(rec, evsel, &lost.lost,
 								    x, y, count.lost, 0);
+					ring_lost += count.lost;
 				}
 			}
 		}
@@ -1999,6 +2001,15 @@ static void record__read_lost_samples(struct record *rec)
 						    PERF_RECORD_MISC_LOST_SAMPLES_BPF);
 		}
 	}
+
+	/*
+	 * A single reader draining every CPU's buffer may not keep up on a big
+	 * machine, point at the parallel readers.
+	 */
+	if (ring_lost && !record__threads_enabled(rec))
+		pr_warning("%" PRIu64 " samples lost to full ring buffers, consider --threads=numa "
+			   "to read them with one thread per node, or a larger --mmap-pages\n",
+			   ring_lost);
 }
 
 static volatile sig_atomic_t workload_exec_errno;
@@ -0,0 +1,106 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-2.0
+#
+# Contended enqueues on a locked root qdisc are parked on the qdisc's
+# defer_list and enqueued by whichever CPU takes the root lock. Senders of
+# deferred skbs always see NET_XMIT_SUCCESS, so drops must still show up in
+# the qdisc statistics. Flood a slow HTB from every CPU and check that every
+# packet IP handed to the device is accounted as sent, dropped or backlog,
+# first with deferral and then with a cls_cgroup filter blocking it.
+
+ksft_skip=4
+ret=0
+ns="qdisc-defer-$$"
+
+cleanup()
+{
+	ip netns del "$ns" 2>/dev/null
+}
+
+if [ "$(id -u)" -ne 0 ]; then
+	echo "SKIP: need root privileges"
+	exit $ksft_skip
+fi
+
+for tool in ip tc nstat ping; do
+	if ! command -v $tool >/dev/null; then
+		echo "SKIP: $tool not found"
+		exit $ksft_skip
+	fi
+done
+
+trap cleanup EXIT
+
+ip netns add "$ns" || exit $ksft_skip
+ip netns exec "$ns" sysctl -qw net.ipv6.conf.all.disable_ipv6=1
+ip netns exec "$ns" sysctl -qw net.ipv6.conf.default.disable_ipv6=1
+ip -n "$ns" link add dummy0 type dummy
+ip -n "$ns" link set dummy0 up
+ip -n "$ns" addr add 198.51.100.1/24 dev dummy0
+# HTB leaves sch->limit at 0, the defer_list is bounded by txqueuelen
+ip netns exec "$ns" tc qdisc add dev dummy0 root handle 1: htb default 1
+ip netns exec "$ns" tc class add dev dummy0 parent 1: classid 1:1 \
+	htb rate 1mbit burst 1500
+ip netns exec "$ns" tc qdisc add dev dummy0 parent 1:1 pfifo limit 10
+
+qdisc_pkts()
+{
+	# sent + dropped + backlog, in packets
+	ip netns exec "$ns" tc -s qdisc show dev dummy0 root |
+		awk '/Sent/ { gsub(/[,)]/, ""); s = $4; d = $7 }
+		     /backlog/ { b = $3 }
+		     END { print s + d + b }'
+}
+
+qdisc_drops()
+{
+	ip netns exec "$ns" tc -s qdisc show dev dummy0 root |
+		awk '/Sent/ { gsub(/[,)]/, ""); print $7 }'
+}
+
+run_flood()
+{
+	local desc=$1
+	local out before after acct drops
+
+	acct=$(qdisc_pkts)
+	drops=$(qdisc_drops)
+	before=$(ip netns exec "$ns" nstat -az IpOutRequests |
+		 awk '/IpOutRequests/ { print $2 }')
+
+	for cpu in $(seq 1 "$(nproc)"); do
+		ip netns exec "$ns" ping -q -f -c 2000 -s 1000 \
+			198.51.100.2 >/dev/null 2>&1 &
+	done
+	wait
+
+	# Let HTB drain its backlog into the dummy device
+	sleep 1
+
+	after=$(ip netns exec "$ns" nstat -az IpOutRequests |
+		awk '/IpOutRequests/ { print $2 }')
+	out=$((after - before))
+	acct=$(($(qdisc_pkts) - acct))
+	drops=$(($(qdisc_drops) - drops))
+
+	if [ "$acct" -ne "$out" ]; then
+		echo "FAIL: $desc: IP sent $out packets, qdisc accounted $acct"
+		ret=1
+	elif [ "$drops" -eq 0 ]; then
+		echo "FAIL: $desc: no drops reported on an oversubscribed HTB"
+		ret=1
+	else
+		echo "PASS: $desc: $out packets, $drops dropped"
+	fi
+}
+
+run_flood "deferred enqueue"
+
+if ip netns exec "$ns" tc filter add dev dummy0 parent 1: protocol ip \
+	prio 1 cgroup 2>/dev/null; then
+	run_flood "enqueue with cls_cgroup attached"
+else
+	echo "SKIP: cls_cgroup not available"
+fi
+
+exit $ret